@@ -150,16 +150,15 @@ STextureData getTextureData(core::vector<commit_t>& _out_commits, const asset::I
     auto img = _vt->createUpscaledImage(_img);
     const auto& extent = img->getCreationParameters().extent;
 
-    auto imgAndOrigSz = asset::ICPUVirtualTexture::createPoTPaddedSquareImageWithMipLevels(img.get(), _uwrap, _vwrap, _borderColor);
-
     asset::IImage::SSubresourceRange subres;
     subres.baseMipLevel = 0u;
     subres.levelCount = core::findLSB(core::roundDownToPoT<uint32_t>(std::max(extent.width, extent.height))) + 1;
     subres.baseArrayLayer = 0u;
     subres.layerCount = 1u;
 
-    auto addr = _vt->alloc(img->getCreationParameters().format, imgAndOrigSz.second, subres, _uwrap, _vwrap);
-    commit_t cm{ addr, std::move(imgAndOrigSz.first), subres, _uwrap, _vwrap, _borderColor };
+    auto addr = _vt->alloc(img->getCreationParameters().format, extent, subres, _uwrap, _vwrap);
+    // padding and mip-mapping is left to the batched commit
+    commit_t cm{ addr, std::move(img), subres, _uwrap, _vwrap, _borderColor };
 
     _out_commits.push_back(cm);
 
@@ -555,9 +554,12 @@ APP_CONSTRUCTOR(MegaTextureApp)
         }
 
         vt->shrink();
-        for (const auto& cm : vt_commits)
         {
-            vt->commit(cm.addr, cm.texture.get(), cm.subresource, cm.uwrap, cm.vwrap, cm.border);
+            core::vector<asset::ICPUVirtualTexture::SPendingCommit> pendingCommits;
+            pendingCommits.reserve(vt_commits.size());
+            for (const auto& cm : vt_commits)
+                pendingCommits.push_back({ cm.addr, cm.texture.get(), cm.subresource, cm.uwrap, cm.vwrap, cm.border });
+            vt->commit(core::execution::par_unseq, pendingCommits.data(), pendingCommits.data()+pendingCommits.size());
         }
 
         auto gpuvt = core::make_smart_refctd_ptr<video::IGPUVirtualTexture>(logicalDevice.get(), gpuTransferFence.get(), queues[CommonAPI::InitOutput::EQT_TRANSFER_UP], vt.get());
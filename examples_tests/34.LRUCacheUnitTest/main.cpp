@@ -59,6 +59,21 @@ int main()
 	auto peekedNullptr = cache.peek(5);
 	assert(peekedNullptr == nullptr);
 
+	// using the least recently used entry must protect it from the next eviction
+	core::vector<int> evicted;
+	core::LRUCache<int, char> cache3(3u, [&evicted](std::pair<int,char>& e) { evicted.push_back(e.first); });
+	cache3.insert(1, 'a');
+	cache3.insert(2, 'b');
+	cache3.insert(3, 'c');
+	cache3.get(1);
+	cache3.insert(4, 'd');
+	assert(evicted.size() == 1u && evicted.back() == 2);
+	cache3.erase(3);
+	cache3.insert(5, 'e');
+	cache3.insert(6, 'f');
+	assert(evicted.size() == 3u && evicted.back() == 1);
+	assert(cache3.peek(4) && cache3.peek(5) && cache3.peek(6));
+
 
 
 	core::LRUCache<int, std::string> cache2(5u);
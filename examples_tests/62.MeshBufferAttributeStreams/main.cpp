@@ -0,0 +1,104 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/asset/utils/IMeshManipulator.h"
+
+using namespace nbl;
+using namespace asset;
+
+constexpr uint32_t VertexCount = 10000000u;
+
+static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBuffer(E_FORMAT posFormat, bool indexed)
+{
+	SVertexInputParams vtxParams;
+	vtxParams.enabledAttribFlags = 0x1u;
+	vtxParams.enabledBindingFlags = 0x1u;
+	vtxParams.attributes[0].binding = 0u;
+	vtxParams.attributes[0].format = posFormat;
+	vtxParams.attributes[0].relativeOffset = 0u;
+	vtxParams.bindings[0].stride = getTexelOrBlockBytesize(posFormat);
+	vtxParams.bindings[0].inputRate = EVIR_PER_VERTEX;
+
+	auto pipeline = core::make_smart_refctd_ptr<ICPURenderpassIndependentPipeline>(nullptr,nullptr,nullptr,vtxParams,SBlendParams{},SPrimitiveAssemblyParams{},SRasterizationParams{});
+	auto mb = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+	mb->setPipeline(std::move(pipeline));
+
+	auto vertices = core::make_smart_refctd_ptr<ICPUBuffer>(size_t(VertexCount)*vtxParams.bindings[0].stride);
+	std::mt19937 mt(0x45u);
+	std::uniform_real_distribution<float> dist(-1.f,1.f);
+	for (uint32_t i=0u; i<VertexCount; i++)
+	{
+		const double in[4] = {dist(mt),dist(mt),dist(mt),1.0};
+		encodePixels<double>(posFormat,reinterpret_cast<uint8_t*>(vertices->getPointer())+size_t(i)*vtxParams.bindings[0].stride,in);
+	}
+	mb->setVertexBufferBinding({0ull,std::move(vertices)},0u);
+
+	if (indexed)
+	{
+		auto indices = core::make_smart_refctd_ptr<ICPUBuffer>(sizeof(uint32_t)*VertexCount);
+		auto* ix = reinterpret_cast<uint32_t*>(indices->getPointer());
+		for (uint32_t i=0u; i<VertexCount; i++)
+			ix[i] = i;
+		std::shuffle(ix,ix+VertexCount,mt);
+		mb->setIndexBufferBinding({0ull,std::move(indices)});
+		mb->setIndexType(EIT_32BIT);
+	}
+	else
+		mb->setIndexType(EIT_UNKNOWN);
+	mb->setIndexCount(VertexCount);
+	return mb;
+}
+
+int main()
+{
+	const E_FORMAT formats[] = {EF_R32G32B32_SFLOAT,EF_R16G16B16A16_SFLOAT,EF_R8G8B8A8_SNORM,EF_A2B10G10R10_SNORM_PACK32};
+	const char* formatNames[] = {"R32G32B32_SFLOAT","R16G16B16A16_SFLOAT","R8G8B8A8_SNORM","A2B10G10R10_SNORM_PACK32"};
+
+	core::vector<float> soa(size_t(VertexCount)*4u);
+	float* const channels[4] = {soa.data(),soa.data()+VertexCount,soa.data()+2u*VertexCount,soa.data()+3u*VertexCount};
+	bool passed = true;
+	for (uint32_t f=0u; f<sizeof(formats)/sizeof(E_FORMAT); f++)
+	for (bool indexed : {false,true})
+	{
+		auto mb = createMeshBuffer(formats[f],indexed);
+
+		core::vectorSIMDf scalarSum;
+		const double scalarMs = timeMs([&]() -> void
+		{
+			for (uint32_t i=0u; i<VertexCount; i++)
+				scalarSum += mb->getPosition(indexed ? mb->getIndexValue(i):i);
+		});
+		core::vectorSIMDf streamSum;
+		const double streamMs = timeMs([&]() -> void
+		{
+			if (!mb->getAttributeStream(channels,mb->getPositionAttributeIx(),VertexCount,mb->getIndices(),mb->getIndexType()))
+			{
+				std::cout << "getAttributeStream failed for " << formatNames[f] << (indexed ? " indexed":" unindexed") << "!\n";
+				passed = false;
+				return;
+			}
+			for (uint32_t i=0u; i<VertexCount; i++)
+				streamSum += core::vectorSIMDf(channels[0][i],channels[1][i],channels[2][i]);
+		});
+		core::aabbox3df aabb;
+		const double aabbMs = timeMs([&]() -> void {aabb = IMeshManipulator::calculateBoundingBox(mb.get());});
+
+		std::cout << formatNames[f] << (indexed ? " indexed":" unindexed") << ": per-vertex " << scalarMs << "ms, stream " << streamMs << "ms, calculateBoundingBox " << aabbMs << "ms\n";
+		const auto diff = core::abs(scalarSum-streamSum);
+		if (core::max(core::max(diff.x,diff.y),diff.z)>1.f)
+		{
+			std::cout << "\tMISMATCH between per-vertex and stream decode!\n";
+			passed = false;
+		}
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,172 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/system/CStdoutLogger.h"
+
+// Everything here runs against the null backend, so the timings are purely the CPU cost of the engine:
+// asset conversion, staging buffer management and command recording, without any driver or GPU in the way.
+
+using namespace nbl;
+
+constexpr uint32_t BufferCount = 16384u;
+constexpr uint32_t MaxBufferSize = 64u*1024u;
+constexpr uint32_t UploadCount = 4096u;
+constexpr uint32_t DrawCount = 1000000u;
+
+int main()
+{
+	auto system = createSystem();
+	auto logger = core::make_smart_refctd_ptr<system::CStdoutLogger>();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+
+	auto api = video::CNullConnection::create(core::smart_refctd_ptr(system),0u,"NullBackendBenchmark",core::smart_refctd_ptr<system::ILogger>(logger));
+	if (!api)
+		return 1;
+	auto* physicalDevice = *api->getPhysicalDevices().begin();
+
+	constexpr uint32_t QueueFamily = 0u;
+	const float priorities[2] = {1.f,1.f};
+	video::ILogicalDevice::SQueueCreationParams queueParams;
+	queueParams.flags = static_cast<video::IGPUQueue::E_CREATE_FLAGS>(0);
+	queueParams.familyIndex = QueueFamily;
+	queueParams.count = 2u;
+	queueParams.priorities = priorities;
+	video::ILogicalDevice::SCreationParams deviceParams = {};
+	deviceParams.queueParamsCount = 1u;
+	deviceParams.queueParams = &queueParams;
+	auto logicalDevice = physicalDevice->createLogicalDevice(deviceParams);
+	if (!logicalDevice)
+		return 2;
+	auto* transferQueue = logicalDevice->getQueue(QueueFamily,0u);
+	auto* computeQueue = logicalDevice->getQueue(QueueFamily,1u);
+
+	core::smart_refctd_ptr<video::IUtilities> utilities;
+	const double utilitiesMs = timeMs([&]() -> void {utilities = core::make_smart_refctd_ptr<video::IUtilities>(core::smart_refctd_ptr(logicalDevice));});
+	std::cout << "IUtilities creation (builtin pipelines) " << utilitiesMs << "ms\n";
+
+	auto pool = logicalDevice->createCommandPool(QueueFamily,video::IGPUCommandPool::ECF_RESET_COMMAND_BUFFER_BIT);
+	core::smart_refctd_ptr<video::IGPUCommandBuffer> cmdbufs[3];
+	logicalDevice->createCommandBuffers(pool.get(),video::IGPUCommandBuffer::EL_PRIMARY,3u,cmdbufs);
+
+	// CPU assets
+	std::mt19937 mt(0x45u);
+	core::vector<core::smart_refctd_ptr<asset::ICPUBuffer>> cpuBuffers(BufferCount);
+	size_t totalBytes = 0ull;
+	for (auto& buffer : cpuBuffers)
+	{
+		const size_t size = std::uniform_int_distribution<uint32_t>(16u,MaxBufferSize)(mt)&(~0x3u);
+		buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(size);
+		buffer->addUsageFlags(asset::IBuffer::EUF_VERTEX_BUFFER_BIT);
+		std::generate_n(reinterpret_cast<uint32_t*>(buffer->getPointer()),size/sizeof(uint32_t),mt);
+		totalBytes += size;
+	}
+
+	// Asset conversion
+	{
+		video::IGPUObjectFromAssetConverter cpu2gpu;
+		video::IGPUObjectFromAssetConverter::SParams cpu2gpuParams;
+		cpu2gpuParams.assetManager = assetManager.get();
+		cpu2gpuParams.device = logicalDevice.get();
+		cpu2gpuParams.finalQueueFamIx = QueueFamily;
+		cpu2gpuParams.limits = physicalDevice->getLimits();
+		cpu2gpuParams.pipelineCache = nullptr;
+		cpu2gpuParams.sharingMode = asset::ESM_EXCLUSIVE;
+		cpu2gpuParams.utilities = utilities.get();
+		cpu2gpuParams.perQueue[video::IGPUObjectFromAssetConverter::EQU_TRANSFER].queue = transferQueue;
+		cpu2gpuParams.perQueue[video::IGPUObjectFromAssetConverter::EQU_TRANSFER].cmdbuf = cmdbufs[0];
+		cpu2gpuParams.perQueue[video::IGPUObjectFromAssetConverter::EQU_COMPUTE].queue = computeQueue;
+		cpu2gpuParams.perQueue[video::IGPUObjectFromAssetConverter::EQU_COMPUTE].cmdbuf = cmdbufs[1];
+
+		size_t converted = 0ull;
+		const double conversionMs = timeMs([&]() -> void
+		{
+			cpu2gpuParams.beginCommandBuffers();
+			auto gpuBuffers = cpu2gpu.getGPUObjectsFromAssets(cpuBuffers.data(),cpuBuffers.data()+cpuBuffers.size(),cpu2gpuParams);
+			cpu2gpuParams.waitForCreationToComplete(false);
+			if (gpuBuffers)
+			for (const auto& buffer : *gpuBuffers)
+				converted += buffer ? 1ull:0ull;
+		});
+		std::cout << "Converted " << converted << "/" << BufferCount << " buffers (" << (totalBytes>>20ull) << "MB) in " << conversionMs << "ms\n";
+	}
+
+	// Staging buffer uploads
+	{
+		video::IGPUBuffer::SCreationParams params = {};
+		params.usage = core::bitflag(video::IGPUBuffer::EUF_TRANSFER_DST_BIT)|video::IGPUBuffer::EUF_STORAGE_BUFFER_BIT;
+		auto dst = logicalDevice->createDeviceLocalGPUBufferOnDedMem(params,MaxBufferSize);
+		auto fence = logicalDevice->createFence(static_cast<video::IGPUFence::E_CREATE_FLAGS>(0));
+		const double uploadMs = timeMs([&]() -> void
+		{
+			auto* cmdbuf = cmdbufs[2].get();
+			for (uint32_t i=0u; i<UploadCount; i++)
+			{
+				cmdbuf->begin(video::IGPUCommandBuffer::EU_ONE_TIME_SUBMIT_BIT);
+				const auto& data = cpuBuffers[i%BufferCount];
+				asset::SBufferRange<video::IGPUBuffer> range = {0ull,data->getSize(),dst};
+				uint32_t waitSemaphoreCount = 0u;
+				video::IGPUSemaphore* const* waitSemaphores = nullptr;
+				const asset::E_PIPELINE_STAGE_FLAGS* waitStages = nullptr;
+				utilities->updateBufferRangeViaStagingBuffer(cmdbuf,fence.get(),transferQueue,range,data->getPointer(),waitSemaphoreCount,waitSemaphores,waitStages);
+				cmdbuf->end();
+
+				video::IGPUQueue::SSubmitInfo submit = {};
+				submit.commandBufferCount = 1u;
+				submit.commandBuffers = &cmdbuf;
+				transferQueue->submit(1u,&submit,fence.get());
+				auto* fenceptr = fence.get();
+				logicalDevice->blockForFences(1u,&fenceptr);
+				logicalDevice->resetFences(1u,&fenceptr);
+				cmdbuf->reset(video::IGPUCommandBuffer::ERF_RELEASE_RESOURCES_BIT);
+			}
+		});
+		std::cout << UploadCount << " staged uploads and submits in " << uploadMs << "ms (" << uploadMs*1000.0/double(UploadCount) << "us each)\n";
+	}
+
+	// Command recording
+	{
+		video::IGPUBuffer::SCreationParams params = {};
+		params.usage = core::bitflag(video::IGPUBuffer::EUF_VERTEX_BUFFER_BIT)|video::IGPUBuffer::EUF_INDEX_BUFFER_BIT|video::IGPUBuffer::EUF_TRANSFER_DST_BIT;
+		auto vertices = logicalDevice->createDeviceLocalGPUBufferOnDedMem(params,MaxBufferSize);
+		auto indices = logicalDevice->createDeviceLocalGPUBufferOnDedMem(params,MaxBufferSize);
+
+		auto* cmdbuf = cmdbufs[2].get();
+		const double recordMs = timeMs([&]() -> void
+		{
+			cmdbuf->begin(video::IGPUCommandBuffer::EU_ONE_TIME_SUBMIT_BIT);
+			const video::IGPUBuffer* vertexBuffers[] = {vertices.get()};
+			const size_t offsets[] = {0ull};
+			for (uint32_t i=0u; i<DrawCount; i++)
+			{
+				cmdbuf->bindVertexBuffers(0u,1u,vertexBuffers,offsets);
+				cmdbuf->bindIndexBuffer(indices.get(),0ull,asset::EIT_32BIT);
+				cmdbuf->drawIndexed(3u*(i%1024u+1u),1u,0u,0,0u);
+			}
+			cmdbuf->end();
+		});
+		std::cout << DrawCount << " indexed draws recorded in " << recordMs << "ms (" << recordMs*1000000.0/double(DrawCount) << "ns each)\n";
+
+		const double dispatchMs = timeMs([&]() -> void
+		{
+			cmdbuf->reset(video::IGPUCommandBuffer::ERF_RELEASE_RESOURCES_BIT);
+			cmdbuf->begin(video::IGPUCommandBuffer::EU_ONE_TIME_SUBMIT_BIT);
+			for (uint32_t i=0u; i<DrawCount; i++)
+			{
+				cmdbuf->fillBuffer(vertices.get(),0ull,MaxBufferSize,i);
+				cmdbuf->dispatch(i%256u+1u,1u,1u);
+			}
+			cmdbuf->end();
+		});
+		std::cout << DrawCount << " fills and dispatches recorded in " << dispatchMs << "ms\n";
+	}
+
+	return 0;
+}
@@ -0,0 +1,218 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <future>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Stress test for the single-flight loading in IAssetManager:
+// many threads request the same set of files at the same time, every file must be decoded exactly once
+// and every thread must get the same cached asset back.
+// Then two threads load two files referencing each other from opposite ends, which must not wait on each other forever.
+
+using namespace nbl;
+
+constexpr uint32_t FileCount = 64u;
+constexpr uint32_t ThreadCount = 16u;
+constexpr uint32_t Rounds = 8u;
+
+//! Loads any `*.sfl` file into an ICPUBuffer, slowly, and counts how many times each file got decoded
+class CCountingLoader final : public asset::IAssetLoader
+{
+	public:
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override { return true; }
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "sfl", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_BUFFER; }
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override
+		{
+			{
+				std::unique_lock lock(m_mutex);
+				m_decodes[_file->getFileName().filename().string()]++;
+			}
+			// pretend to be a PNG decoder, widens the window in which other threads can ask for the same file
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+			auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(_file->getSize());
+			system::IFile::success_t success;
+			_file->read(success, buffer->getPointer(), 0u, buffer->getSize());
+			if (!success)
+				return {};
+			return asset::SAssetBundle(nullptr,{std::move(buffer)});
+		}
+
+		inline core::map<std::string,uint32_t> getDecodes()
+		{
+			std::unique_lock lock(m_mutex);
+			return m_decodes;
+		}
+
+	private:
+		std::mutex m_mutex;
+		core::map<std::string,uint32_t> m_decodes;
+};
+
+//! Loads a `*.ref` file holding the path of another file, which gets loaded as its dependency unless the `*.ref` itself is a dependency
+class CReferenceLoader final : public asset::IAssetLoader
+{
+	public:
+		CReferenceLoader(asset::IAssetManager* _manager) : m_manager(_manager) {}
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const override { return true; }
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* extensions[]{ "ref", nullptr };
+			return extensions;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_BUFFER; }
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override
+		{
+			std::string reference(_file->getSize(),'\0');
+			system::IFile::success_t success;
+			_file->read(success, reference.data(), 0u, reference.size());
+			if (!success)
+				return {};
+			if (_hierarchyLevel==0u)
+			{
+				// makes sure the other thread holds its own file by the time this one asks for it
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+				if (interm_getAssetInHierarchy(m_manager, reference, _params, _hierarchyLevel+1u).getContents().empty())
+					return {};
+			}
+			auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(reference.size());
+			memcpy(buffer->getPointer(), reference.data(), reference.size());
+			return asset::SAssetBundle(nullptr,{std::move(buffer)});
+		}
+
+	private:
+		asset::IAssetManager* const m_manager;
+};
+
+int main()
+{
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+	auto loader = core::make_smart_refctd_ptr<CCountingLoader>();
+	assetManager->addAssetLoader(core::smart_refctd_ptr(loader));
+	assetManager->addAssetLoader(core::make_smart_refctd_ptr<CReferenceLoader>(assetManager.get()));
+
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_concurrent_asset_load";
+	std::filesystem::create_directories(directory);
+	core::vector<std::string> paths(FileCount);
+	for (uint32_t i=0u; i<FileCount; i++)
+	{
+		paths[i] = (directory/("file"+std::to_string(i)+".sfl")).string();
+		std::ofstream(paths[i],std::ios::binary) << "contents of file " << i;
+	}
+
+	// results[thread][round*FileCount+file]
+	core::vector<core::vector<const asset::IAsset*>> results(ThreadCount);
+	const auto start = std::chrono::high_resolution_clock::now();
+	{
+		core::vector<std::thread> threads;
+		for (uint32_t t=0u; t<ThreadCount; t++)
+		threads.emplace_back([&,t]() -> void
+		{
+			std::mt19937 mt(t);
+			core::vector<uint32_t> order(FileCount);
+			std::iota(order.begin(),order.end(),0u);
+			auto& out = results[t];
+			out.resize(Rounds*FileCount);
+			for (uint32_t r=0u; r<Rounds; r++)
+			{
+				// half the threads go through the files in the same order to maximize contention, the rest shuffle
+				if (t&0x1u)
+					std::shuffle(order.begin(),order.end(),mt);
+				for (const auto i : order)
+				{
+					const auto bundle = assetManager->getAsset(paths[i],{});
+					out[r*FileCount+i] = bundle.getContents().empty() ? nullptr:bundle.getContents().begin()->get();
+				}
+			}
+		});
+		for (auto& thread : threads)
+			thread.join();
+	}
+	const double ms = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+
+	bool passed = true;
+	const auto decodes = loader->getDecodes();
+	for (uint32_t i=0u; i<FileCount; i++)
+	{
+		const auto found = decodes.find("file"+std::to_string(i)+".sfl");
+		const uint32_t count = found!=decodes.end() ? found->second:0u;
+		if (count!=1u)
+		{
+			std::cout << paths[i] << " was decoded " << count << " times!\n";
+			passed = false;
+		}
+		const asset::IAsset* first = results[0][i];
+		for (uint32_t t=0u; t<ThreadCount; t++)
+		for (uint32_t r=0u; r<Rounds; r++)
+		if (!first || results[t][r*FileCount+i]!=first)
+		{
+			std::cout << "Thread " << t << " got a different asset for " << paths[i] << " in round " << r << "\n";
+			passed = false;
+		}
+	}
+	std::cout << ThreadCount << " threads x " << Rounds << " rounds x " << FileCount << " files loaded in " << ms << "ms, " << decodes.size() << " decodes\n";
+
+	// explicitly asking for a private copy must still load every time
+	const asset::IAssetLoader::SAssetLoadParams duplicateParams(0u,nullptr,asset::IAssetLoader::ECF_DUPLICATE_TOP_LEVEL);
+	assetManager->getAsset(paths[0],duplicateParams);
+	if (loader->getDecodes()["file0.sfl"]!=2u)
+	{
+		std::cout << "ECF_DUPLICATE_TOP_LEVEL load was served from the cache!\n";
+		passed = false;
+	}
+
+	// X references Y and Y references X, the thread loading X waits on Y's load which waits on X's
+	{
+		const auto x = (directory/"x.ref").string();
+		const auto y = (directory/"y.ref").string();
+		std::ofstream(x,std::ios::binary) << y;
+		std::ofstream(y,std::ios::binary) << x;
+
+		std::promise<bool> done;
+		auto future = done.get_future();
+		std::thread([&]() -> void
+		{
+			bool loaded = true;
+			std::thread other([&]() -> void {loaded = !assetManager->getAsset(y,{}).getContents().empty() && loaded;});
+			loaded = !assetManager->getAsset(x,{}).getContents().empty() && loaded;
+			other.join();
+			done.set_value(loaded);
+		}).detach();
+		if (future.wait_for(std::chrono::seconds(10))!=std::future_status::ready)
+		{
+			std::cout << "Loading files referencing each other from two threads deadlocked!\nFAILED" << std::endl;
+			std::_Exit(1);
+		}
+		if (!future.get())
+		{
+			std::cout << "Loading files referencing each other failed!\n";
+			passed = false;
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+	return reportResult(passed);
+}
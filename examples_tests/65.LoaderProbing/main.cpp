@@ -0,0 +1,144 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Loads a directory of mixed assets twice, once with their proper extensions and once all renamed to `*.asset`.
+// With a misleading extension the IAssetManager has to probe every registered loader, thanks to the shared file header
+// and the per-loader signatures this should cost about as much as loading with the right extension.
+
+using namespace nbl;
+
+constexpr uint32_t Repetitions = 8u;
+constexpr uint32_t VertexCount = 100000u;
+
+static void writeFiles(const std::filesystem::path& dir, const std::string& ext, const std::string& misleadingExt, core::vector<std::pair<std::string,std::string>>& outNames, std::function<void(std::ostream&)> write)
+{
+	const auto name = "file"+std::to_string(outNames.size());
+	const auto proper = (dir/(name+"."+ext)).string();
+	const auto misleading = (dir/(name+"."+misleadingExt)).string();
+	for (const auto& path : {proper,misleading})
+	{
+		std::ofstream file(path,std::ios::binary);
+		write(file);
+	}
+	outNames.emplace_back(proper,misleading);
+}
+
+int main()
+{
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_loader_probing";
+	std::filesystem::create_directories(directory);
+
+	std::mt19937 mt(0x45u);
+	std::uniform_real_distribution<float> dist(-1.f,1.f);
+	core::vector<std::pair<std::string,std::string>> files;
+	// ASCII PLY
+	writeFiles(directory,"ply","asset",files,[&](std::ostream& out)
+	{
+		out << "ply\nformat ascii 1.0\nelement vertex " << VertexCount << "\nproperty float x\nproperty float y\nproperty float z\nelement face " << VertexCount/3u << "\nproperty list uchar int vertex_indices\nend_header\n";
+		for (uint32_t i=0u; i<VertexCount; i++)
+			out << dist(mt) << " " << dist(mt) << " " << dist(mt) << "\n";
+		for (uint32_t i=0u; i<VertexCount/3u; i++)
+			out << "3 " << i*3u << " " << i*3u+1u << " " << i*3u+2u << "\n";
+	});
+	// binary STL
+	writeFiles(directory,"stl","asset",files,[&](std::ostream& out)
+	{
+		char header[80] = "binary STL written by the loader probing benchmark";
+		out.write(header,sizeof(header));
+		const uint32_t triangleCount = VertexCount/3u;
+		out.write(reinterpret_cast<const char*>(&triangleCount),sizeof(triangleCount));
+		for (uint32_t i=0u; i<triangleCount; i++)
+		{
+			float data[12];
+			for (auto& f : data)
+				f = dist(mt);
+			const uint16_t attributes = 0u;
+			out.write(reinterpret_cast<const char*>(data),sizeof(data));
+			out.write(reinterpret_cast<const char*>(&attributes),sizeof(attributes));
+		}
+	});
+	// OBJ
+	writeFiles(directory,"obj","asset",files,[&](std::ostream& out)
+	{
+		out << "# OBJ written by the loader probing benchmark\n";
+		for (uint32_t i=0u; i<VertexCount; i++)
+			out << "v " << dist(mt) << " " << dist(mt) << " " << dist(mt) << "\n";
+		for (uint32_t i=0u; i<VertexCount/3u; i++)
+			out << "f " << i*3u+1u << " " << i*3u+2u << " " << i*3u+3u << "\n";
+	});
+	// glTF which is mostly a huge `extras` blob, the kind of file the old probe would fully parse just to say yes
+	{
+		std::ofstream bin((directory/"triangle.bin").string(),std::ios::binary);
+		const float positions[9] = {0.f,0.f,0.f, 1.f,0.f,0.f, 0.f,1.f,0.f};
+		bin.write(reinterpret_cast<const char*>(positions),sizeof(positions));
+	}
+	writeFiles(directory,"gltf","asset",files,[&](std::ostream& out)
+	{
+		out << "{\n\"asset\":{\"version\":\"2.0\"},\n\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":[{\"mesh\":0}],\n";
+		out << "\"meshes\":[{\"primitives\":[{\"attributes\":{\"POSITION\":0}}]}],\n";
+		out << "\"buffers\":[{\"uri\":\"triangle.bin\",\"byteLength\":36}],\n";
+		out << "\"bufferViews\":[{\"buffer\":0,\"byteOffset\":0,\"byteLength\":36}],\n";
+		out << "\"accessors\":[{\"bufferView\":0,\"byteOffset\":0,\"componentType\":5126,\"count\":3,\"type\":\"VEC3\",\"max\":[1,1,0],\"min\":[0,0,0]}],\n";
+		out << "\"extras\":[";
+		for (uint32_t i=0u; i<VertexCount*3u; i++)
+			out << (i ? ",":"") << dist(mt);
+		out << "]\n}\n";
+	});
+	// random bytes, nothing but the BIN loader should want these
+	writeFiles(directory,"bin","asset",files,[&](std::ostream& out)
+	{
+		core::vector<uint32_t> noise(VertexCount);
+		std::generate(noise.begin(),noise.end(),mt);
+		out.write(reinterpret_cast<const char*>(noise.data()),noise.size()*sizeof(uint32_t));
+	});
+
+	// never hit the cache, we want to measure loading every time
+	const asset::IAssetLoader::SAssetLoadParams params(0u,nullptr,asset::IAssetLoader::ECF_DUPLICATE_TOP_LEVEL,asset::IAssetLoader::ELPF_NONE,nullptr,directory);
+	double properTotal = 0.0, misleadingTotal = 0.0;
+	for (const auto& [proper,misleading] : files)
+	{
+		asset::IAsset::E_TYPE properType = asset::IAsset::ET_BUFFER, misleadingType = asset::IAsset::ET_BUFFER;
+		auto load = [&](const std::string& path, asset::IAsset::E_TYPE& type) -> double
+		{
+			bool loaded = false;
+			const double ms = timeMs([&]() -> void
+			{
+				for (uint32_t r=0u; r<Repetitions; r++)
+				{
+					const auto bundle = assetManager->getAsset(path,params);
+					if (!bundle.getContents().empty())
+					{
+						type = bundle.getAssetType();
+						loaded = true;
+					}
+				}
+			})/double(Repetitions);
+			return loaded ? ms:-1.0;
+		};
+		const double properMs = load(proper,properType);
+		const double misleadingMs = load(misleading,misleadingType);
+		properTotal += properMs;
+		misleadingTotal += misleadingMs;
+
+		std::cout << std::filesystem::path(proper).filename().string() << ": " << properMs << "ms, as *.asset " << misleadingMs << "ms";
+		if (properType!=misleadingType)
+			std::cout << " (loaded as asset type " << misleadingType << " instead of " << properType << ")";
+		std::cout << "\n";
+	}
+	std::cout << "Total per pass: " << properTotal << "ms with proper extensions, " << misleadingTotal << "ms with misleading extensions\n";
+
+	std::filesystem::remove_all(directory);
+	return 0;
+}
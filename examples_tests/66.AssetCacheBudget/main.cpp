@@ -0,0 +1,80 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Keeps inserting and looking up buffers in an asset cache with a byte budget, the cache must never hold more than the budget
+// (except for the single most recently used asset), must evict the least recently used buffers first and must never evict builtins.
+
+using namespace nbl;
+
+constexpr uint32_t BufferCount = 4096u;
+constexpr uint32_t BufferSize = 256u*1024u;
+constexpr size_t Budget = 64ull*BufferSize;
+constexpr uint32_t HotSetSize = 16u;
+
+int main()
+{
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+
+	const auto builtinsBefore = assetManager->getAssetCacheStatistics(asset::IAsset::ET_SPECIALIZED_SHADER).entries;
+	// also squeeze a cache holding builtins, as hard as possible
+	assetManager->setAssetCacheBudget(asset::IAsset::ET_SPECIALIZED_SHADER,0ull);
+	assetManager->setAssetCacheBudget(asset::IAsset::ET_BUFFER,Budget);
+
+	bool passed = true;
+	std::mt19937 mt(0x45u);
+	core::vector<uint32_t> hotSet(HotSetSize);
+	std::iota(hotSet.begin(),hotSet.end(),0u);
+	const double ms = timeMs([&]() -> void
+	{
+		for (uint32_t i=0u; i<BufferCount; i++)
+		{
+			asset::SAssetBundle bundle(nullptr,{core::make_smart_refctd_ptr<asset::ICPUBuffer>(BufferSize)});
+			assetManager->changeAssetKey(bundle,"buffer"+std::to_string(i));
+			assetManager->insertAssetIntoCache(bundle);
+
+			// keep touching a small hot set in random order, it should never get evicted
+			std::shuffle(hotSet.begin(),hotSet.end(),mt);
+			for (const auto hot : hotSet)
+			if (hot<=i && assetManager->findAssets("buffer"+std::to_string(hot))->size()!=1u)
+			{
+				std::cout << "Recently used buffer" << hot << " got evicted after inserting buffer" << i << "\n";
+				passed = false;
+			}
+
+			const auto stats = assetManager->getAssetCacheStatistics(asset::IAsset::ET_BUFFER);
+			if (stats.bytes>Budget+BufferSize)
+			{
+				std::cout << "Cache holds " << stats.bytes << " bytes, over the budget of " << Budget << "\n";
+				passed = false;
+			}
+		}
+	});
+
+	const auto stats = assetManager->getAssetCacheStatistics(asset::IAsset::ET_BUFFER);
+	std::cout << BufferCount << " insertions in " << ms << "ms, " << stats.entries << " buffers (" << (stats.bytes>>10ull) << "KB) cached, "
+		<< stats.evictions << " evictions (" << (stats.evictedBytes>>20ull) << "MB), hit rate " << assetManager->getAssetCacheHitRate()*100.0 << "%\n";
+	if (stats.evictions+stats.entries!=stats.insertions)
+	{
+		std::cout << "Evictions and entries don't add up to insertions\n";
+		passed = false;
+	}
+
+	const auto builtinsAfter = assetManager->getAssetCacheStatistics(asset::IAsset::ET_SPECIALIZED_SHADER).entries;
+	if (builtinsAfter!=builtinsBefore)
+	{
+		std::cout << "Builtins got evicted, " << builtinsBefore << " before and " << builtinsAfter << " after\n";
+		passed = false;
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,147 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Compares `system::SReadWriteSpinLock` with and without writer preference against `std::shared_mutex`
+// on read-heavy and write-heavy workloads, checks that no update gets lost and reports the worst writer latency.
+
+using namespace nbl;
+
+constexpr uint32_t OpsPerThread = 200000u;
+constexpr uint32_t ProtectedValues = 64u;
+
+struct SResult
+{
+	double ms;
+	double worstWriteUs;
+	bool consistent;
+};
+
+template<typename LockRead, typename LockWrite>
+static SResult run(const uint32_t threadCount, const uint32_t writePercent, LockRead&& lockRead, LockWrite&& lockWrite)
+{
+	// the writers keep all values equal, readers check they never see them differ
+	uint64_t values[ProtectedValues] = {};
+	std::atomic_bool consistent = true;
+	std::atomic_uint64_t worstWriteNs = 0u;
+	uint64_t writes = 0u;
+	std::atomic_uint64_t writesDone = 0u;
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	{
+		core::vector<std::thread> threads;
+		for (uint32_t t=0u; t<threadCount; t++)
+		threads.emplace_back([&,t]() -> void
+		{
+			std::mt19937 mt(t);
+			uint64_t localWrites = 0u, localWorst = 0u;
+			for (uint32_t i=0u; i<OpsPerThread; i++)
+			{
+				if (mt()%100u<writePercent)
+				{
+					const auto waitStart = std::chrono::high_resolution_clock::now();
+					lockWrite([&]() -> void
+					{
+						localWorst = core::max<uint64_t>(localWorst,std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now()-waitStart).count());
+						for (auto& value : values)
+							value++;
+					});
+					localWrites++;
+				}
+				else
+				lockRead([&]() -> void
+				{
+					for (uint32_t j=1u; j<ProtectedValues; j++)
+					if (values[j]!=values[0])
+						consistent = false;
+				});
+			}
+			writesDone += localWrites;
+			uint64_t worst = worstWriteNs.load();
+			while (worst<localWorst && !worstWriteNs.compare_exchange_weak(worst,localWorst)) {}
+		});
+		for (auto& thread : threads)
+			thread.join();
+	}
+	SResult retval;
+	retval.ms = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+	retval.worstWriteUs = double(worstWriteNs.load())/1000.0;
+	retval.consistent = consistent && values[0]==writesDone.load();
+	return retval;
+}
+
+static bool report(const char* name, const SResult& result, const system::SReadWriteSpinLock::SStatistics* stats=nullptr)
+{
+	std::cout << "\t" << name << ": " << result.ms << "ms, worst writer wait " << result.worstWriteUs << "us";
+	if (stats)
+		std::cout << ", contended reads " << stats->contendedReads << ", contended writes " << stats->contendedWrites << ", sleeps " << stats->sleeps;
+	if (!result.consistent)
+		std::cout << " INCONSISTENT!";
+	std::cout << "\n";
+	return result.consistent;
+}
+
+int main()
+{
+	const uint32_t threadCount = core::max(std::thread::hardware_concurrency(),2u);
+
+	bool passed = true;
+	for (const uint32_t writePercent : {1u,10u,50u,90u})
+	{
+		std::cout << threadCount << " threads, " << writePercent << "% writes\n";
+		for (const auto preference : {system::SReadWriteSpinLock::EP_READERS,system::SReadWriteSpinLock::EP_WRITERS})
+		{
+			system::SReadWriteSpinLock lock(preference);
+			const auto result = run(threadCount,writePercent,
+				[&](auto&& f) -> void {system::read_lock_guard<> lk(lock); f();},
+				[&](auto&& f) -> void {system::write_lock_guard<> lk(lock); f();}
+			);
+			const auto stats = lock.getStatistics();
+			passed = report(preference==system::SReadWriteSpinLock::EP_WRITERS ? "SReadWriteSpinLock (writer preference)":"SReadWriteSpinLock",result,&stats) && passed;
+		}
+		{
+			std::shared_mutex mutex;
+			const auto result = run(threadCount,writePercent,
+				[&](auto&& f) -> void {std::shared_lock lk(mutex); f();},
+				[&](auto&& f) -> void {std::unique_lock lk(mutex); f();}
+			);
+			passed = report("std::shared_mutex",result) && passed;
+		}
+	}
+
+	// read to write upgrades and back
+	{
+		system::SReadWriteSpinLock lock(system::SReadWriteSpinLock::EP_WRITERS);
+		uint64_t counter = 0u;
+		core::vector<std::thread> threads;
+		for (uint32_t t=0u; t<threadCount; t++)
+		threads.emplace_back([&]() -> void
+		{
+			for (uint32_t i=0u; i<OpsPerThread/16u; i++)
+			{
+				system::write_lock_guard<> wl(lock);
+				counter++;
+				system::read_lock_guard<> rl(std::move(wl));
+			}
+		});
+		for (auto& thread : threads)
+			thread.join();
+		if (counter!=uint64_t(threadCount)*(OpsPerThread/16u))
+		{
+			std::cout << "Lost updates across write to read downgrades\n";
+			passed = false;
+		}
+	}
+
+	return reportResult(passed);
+}
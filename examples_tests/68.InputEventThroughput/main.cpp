@@ -0,0 +1,139 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Headless throughput test of the input event channels: a synthetic "window thread" pushes mouse events as fast as it can
+// while the "main thread" drains them, no window or OS event loop involved.
+// Checks that nothing gets lost or reordered with a big enough buffer, that coalescing preserves the total mouse movement
+// and that overwriting the oldest events (the default) always delivers the last one.
+
+using namespace nbl;
+
+constexpr uint32_t EventCount = 4000000u;
+
+class CSyntheticMouseEventChannel final : public ui::IMouseEventChannel
+{
+	public:
+		using ui::IMouseEventChannel::IMouseEventChannel;
+};
+
+static std::chrono::microseconds now()
+{
+	return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch());
+}
+
+struct SResult
+{
+	double ms;
+	double worstLatencyUs;
+	uint64_t received;
+	int64_t totalMovement;
+	bool ordered;
+	bool lastArrived;
+};
+
+static SResult run(CSyntheticMouseEventChannel* channel)
+{
+	SResult result = {0.0,0.0,0ull,0ll,true,false};
+	std::atomic_bool producing = true;
+	std::chrono::microseconds lastPushed(0);
+
+	const auto start = std::chrono::high_resolution_clock::now();
+	std::thread producer([&]() -> void
+	{
+		for (uint32_t i=0u; i<EventCount; i++)
+		{
+			ui::SMouseEvent event(now());
+			event.type = ui::SMouseEvent::EET_MOVEMENT;
+			event.movementEvent.relativeMovementX = 1;
+			event.movementEvent.relativeMovementY = 0;
+			event.window = nullptr;
+			lastPushed = event.timeStamp;
+			channel->pushIntoBackground(std::move(event));
+		}
+		producing = false;
+	});
+
+	uint64_t consumed = 0ull;
+	std::chrono::microseconds lastTimeStamp(0);
+	auto consume = [&]() -> void
+	{
+		auto events = channel->getEvents();
+		if (events.size()>consumed+channel->getFrontBufferCapacity())
+			consumed = events.size()-channel->getFrontBufferCapacity();
+		const auto timeNow = now();
+		for (auto it=events.begin()+consumed; it!=events.end(); it++)
+		{
+			const auto& event = *it;
+			result.worstLatencyUs = core::max<double>(result.worstLatencyUs,double((timeNow-event.timeStamp).count()));
+			result.totalMovement += event.movementEvent.relativeMovementX;
+			// coalesced events carry the timestamp of the last event merged in, so timestamps never go backwards either way
+			if (event.timeStamp<lastTimeStamp || event.movementEvent.relativeMovementX<1)
+				result.ordered = false;
+			lastTimeStamp = event.timeStamp;
+			result.received++;
+		}
+		consumed = events.size();
+	};
+	while (producing)
+	{
+		consume();
+		std::this_thread::yield();
+	}
+	producer.join();
+	consume();
+	result.lastArrived = lastTimeStamp==lastPushed;
+	result.ms = std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count();
+	return result;
+}
+
+int main()
+{
+	bool passed = true;
+	constexpr const char* PolicyNames[] = {"overwrite oldest","drop","coalesce"};
+	for (const auto policy : {CSyntheticMouseEventChannel::EOP_OVERWRITE_OLDEST,CSyntheticMouseEventChannel::EOP_DROP,CSyntheticMouseEventChannel::EOP_COALESCE})
+	for (const uint32_t capacityLog2 : {6u,10u,16u})
+	{
+		auto channel = core::make_smart_refctd_ptr<CSyntheticMouseEventChannel>(0x1ull<<capacityLog2);
+		channel->setOverflowPolicy(policy);
+		const auto result = run(channel.get());
+		const auto stats = channel->getStatistics();
+
+		std::cout << PolicyNames[policy] << ", capacity " << (0x1u<<capacityLog2) << ": "
+			<< double(EventCount)/result.ms/1000.0 << "M events/s, worst latency " << result.worstLatencyUs << "us, "
+			<< stats.pushed << " pushed, " << stats.dropped << " dropped, " << stats.coalesced << " coalesced\n";
+
+		if (!result.ordered)
+		{
+			std::cout << "\tEvents arrived out of order!\n";
+			passed = false;
+		}
+		if (policy==CSyntheticMouseEventChannel::EOP_OVERWRITE_OLDEST && !result.lastArrived)
+		{
+			std::cout << "\tThe last event got lost!\n";
+			passed = false;
+		}
+		// the last getEvents publishes the events held back on overflow
+		if (stats.pushed+stats.dropped+stats.coalesced!=EventCount || !channel->empty())
+		{
+			std::cout << "\tStatistics don't add up to the number of events pushed\n";
+			passed = false;
+		}
+		// every event moves by one, coalescing must not make up movement (it can lose some to saturation)
+		if (result.totalMovement>int64_t(EventCount) || (policy==CSyntheticMouseEventChannel::EOP_DROP && result.totalMovement>int64_t(stats.pushed)))
+		{
+			std::cout << "\tReceived " << result.totalMovement << " total movement from " << EventCount << " events\n";
+			passed = false;
+		}
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,146 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Region count x region size matrix for the copy and fill filters, sequential against parallel.
+// The images are atlases of square tiles with one region per tile and layer, so the total texel count grows
+// with both axes of the matrix, many small regions used to run one after the other even with a parallel policy.
+// The copy gathers the tiles into an image with a single region, the fill writes across the tiles.
+// The parallel results must match the sequential ones bit for bit.
+
+using namespace nbl;
+
+constexpr uint32_t RegionSizes[] = {8u,32u,128u};
+constexpr uint32_t TilesPerSide[] = {1u,4u,16u};
+constexpr uint32_t LayerCount = 6u;
+constexpr uint32_t Repetitions = 4u;
+constexpr asset::E_FORMAT Format = asset::EF_R8G8B8A8_UINT;
+
+static core::smart_refctd_ptr<asset::ICPUImage> createAtlas(const uint32_t regionSize, const uint32_t tilesPerSide, const bool singleRegion=false)
+{
+	const uint32_t size = regionSize*tilesPerSide;
+	if (singleRegion)
+		return createAtlas(size,1u);
+
+	asset::IImage::SCreationParams params;
+	params.flags = static_cast<asset::IImage::E_CREATE_FLAGS>(0u);
+	params.type = asset::IImage::ET_2D;
+	params.format = Format;
+	params.extent = {size,size,1u};
+	params.mipLevels = 1u;
+	params.arrayLayers = LayerCount;
+	params.samples = asset::ICPUImage::ESCF_1_BIT;
+
+	const size_t texelSize = asset::getTexelOrBlockBytesize(Format);
+	const size_t layerSize = size_t(size)*size*texelSize;
+	// a single tile covers all layers with one region
+	const uint32_t regionLayers = tilesPerSide>1u ? LayerCount:1u;
+	const uint32_t layersPerRegion = LayerCount/regionLayers;
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<asset::ICPUImage::SBufferCopy>>(tilesPerSide*tilesPerSide*regionLayers);
+	auto region = regions->begin();
+	for (uint32_t layer=0u; layer<LayerCount; layer+=layersPerRegion)
+	for (uint32_t y=0u; y<tilesPerSide; y++)
+	for (uint32_t x=0u; x<tilesPerSide; x++)
+	{
+		region->bufferOffset = layer*layerSize+(size_t(y)*regionSize*size+size_t(x)*regionSize)*texelSize;
+		region->bufferRowLength = size;
+		region->bufferImageHeight = size;
+		region->imageSubresource.aspectMask = static_cast<asset::IImage::E_ASPECT_FLAGS>(0u);
+		region->imageSubresource.mipLevel = 0u;
+		region->imageSubresource.baseArrayLayer = layer;
+		region->imageSubresource.layerCount = layersPerRegion;
+		region->imageOffset = {int32_t(x*regionSize),int32_t(y*regionSize),0};
+		region->imageExtent = {regionSize,regionSize,1u};
+		region++;
+	}
+
+	auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(layerSize*LayerCount);
+	memset(buffer->getPointer(),0,buffer->getSize());
+	auto image = asset::ICPUImage::create(std::move(params));
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+static bool equal(const asset::ICPUImage* a, const asset::ICPUImage* b)
+{
+	return memcmp(a->getBuffer()->getPointer(),b->getBuffer()->getPointer(),a->getBuffer()->getSize())==0;
+}
+
+int main()
+{
+	std::mt19937 mt(0x45u);
+	bool passed = true;
+
+	std::cout << "region size, regions, copy seq, copy par, fill seq, fill par (ms)\n";
+	for (const auto regionSize : RegionSizes)
+	for (const auto tilesPerSide : TilesPerSide)
+	{
+		auto input = createAtlas(regionSize,tilesPerSide);
+		std::generate_n(reinterpret_cast<uint32_t*>(input->getBuffer()->getPointer()),input->getBuffer()->getSize()/sizeof(uint32_t),mt);
+		const uint32_t regionCount = input->getRegions().size();
+		auto seqOutput = createAtlas(regionSize,tilesPerSide,true);
+		auto parOutput = createAtlas(regionSize,tilesPerSide,true);
+		const auto& extent = input->getCreationParameters().extent;
+
+		using copy_filter_t = asset::CCopyImageFilter;
+		copy_filter_t::state_type copyState;
+		copyState.extent = extent;
+		copyState.layerCount = LayerCount;
+		copyState.inImage = input.get();
+		const double copySeqMs = timeMs([&]() -> void
+		{
+			copyState.outImage = seqOutput.get();
+			if (!copy_filter_t::execute(core::execution::seq,&copyState))
+				passed = false;
+		},Repetitions);
+		const double copyParMs = timeMs([&]() -> void
+		{
+			copyState.outImage = parOutput.get();
+			if (!copy_filter_t::execute(core::execution::par_unseq,&copyState))
+				passed = false;
+		},Repetitions);
+		if (!equal(seqOutput.get(),parOutput.get()) || !equal(input.get(),parOutput.get()))
+		{
+			std::cout << "Copy mismatch for " << regionCount << " regions of " << regionSize << "^2\n";
+			passed = false;
+		}
+
+		// fill only part of the image so that clipping matters too
+		seqOutput = createAtlas(regionSize,tilesPerSide);
+		parOutput = createAtlas(regionSize,tilesPerSide);
+		using fill_filter_t = asset::CFillImageFilter;
+		fill_filter_t::state_type fillState;
+		fillState.subresource = {static_cast<asset::IImage::E_ASPECT_FLAGS>(0u),0u,1u,LayerCount-2u};
+		fillState.outRange.offset = {int32_t(regionSize/2u),int32_t(regionSize/3u),0};
+		fillState.outRange.extent = {extent.width-regionSize/2u-regionSize/4u,extent.height-regionSize/3u,1u};
+		fillState.fillValue.asUint = core::vectorSIMDu32(0xdeadu,0xbeefu,0x45u,0xffu);
+		const double fillSeqMs = timeMs([&]() -> void
+		{
+			fillState.outImage = seqOutput.get();
+			if (!fill_filter_t::execute(core::execution::seq,&fillState))
+				passed = false;
+		},Repetitions);
+		const double fillParMs = timeMs([&]() -> void
+		{
+			fillState.outImage = parOutput.get();
+			if (!fill_filter_t::execute(core::execution::par_unseq,&fillState))
+				passed = false;
+		},Repetitions);
+		if (!equal(seqOutput.get(),parOutput.get()))
+		{
+			std::cout << "Fill mismatch for " << regionCount << " regions of " << regionSize << "^2\n";
+			passed = false;
+		}
+
+		std::cout << regionSize << ", " << regionCount << ", " << copySeqMs << ", " << copyParMs << ", " << fillSeqMs << ", " << fillParMs << "\n";
+	}
+
+	return reportResult(passed);
+}
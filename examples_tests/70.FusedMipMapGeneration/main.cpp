@@ -0,0 +1,192 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Generates full mip chains of a big RGBA8 texture with box kernels, once with a blit per level and once in the fused mode.
+// On power of two extents both compute the same averages, the only difference being that the per level blit
+// re-quantizes every level before computing the next one, so the results must agree to within a few LSBs.
+// The fused mode also has to give identical results for identical layers.
+// Then checks that the fused alpha coverage preservation keeps the alpha tested coverage of every level close to the base level.
+
+using namespace nbl;
+
+constexpr uint32_t Extent = 4096u;
+constexpr uint32_t LayerCount = 2u;
+constexpr uint32_t MaxLSBDifference = 4u;
+constexpr double AlphaRefValue = 0.75;
+constexpr uint32_t AlphaPeriod = 256u;
+constexpr double MaxCoverageDifference = 0.05;
+
+using mip_gen_filter_t = asset::CMipMapGenerationImageFilter<
+	asset::VoidSwizzle,asset::IdentityDither,void,true,
+	asset::CBoxImageFilterKernel,asset::CBoxImageFilterKernel,
+	asset::CBoxImageFilterKernel,asset::CBoxImageFilterKernel,
+	asset::CBoxImageFilterKernel,asset::CBoxImageFilterKernel
+>;
+
+static core::smart_refctd_ptr<asset::ICPUImage> createImage(const uint32_t extent, const uint32_t mipLevels, const uint32_t layerCount)
+{
+	asset::IImage::SCreationParams params;
+	params.flags = static_cast<asset::IImage::E_CREATE_FLAGS>(0u);
+	params.type = asset::IImage::ET_2D;
+	params.format = asset::EF_R8G8B8A8_UNORM;
+	params.extent = {extent,extent,1u};
+	params.mipLevels = mipLevels;
+	params.arrayLayers = layerCount;
+	params.samples = asset::ICPUImage::ESCF_1_BIT;
+	auto image = asset::ICPUImage::create(std::move(params));
+
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<asset::ICPUImage::SBufferCopy>>(mipLevels);
+	size_t offset = 0ull;
+	for (uint32_t level=0u; level<mipLevels; level++)
+	{
+		const auto mipSize = image->getMipSize(level);
+		auto& region = (*regions)[level];
+		region.bufferOffset = offset;
+		region.bufferRowLength = 0u;
+		region.bufferImageHeight = 0u;
+		region.imageSubresource.aspectMask = static_cast<asset::IImage::E_ASPECT_FLAGS>(0u);
+		region.imageSubresource.mipLevel = level;
+		region.imageSubresource.baseArrayLayer = 0u;
+		region.imageSubresource.layerCount = layerCount;
+		region.imageOffset = {0,0,0};
+		region.imageExtent = {mipSize.x,mipSize.y,mipSize.z};
+		offset += size_t(mipSize.x)*mipSize.y*mipSize.z*layerCount*4ull;
+	}
+	auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(offset);
+	memset(buffer->getPointer(),0,offset);
+	image->setBufferAndRegions(std::move(buffer),regions);
+	return image;
+}
+
+static bool generate(asset::ICPUImage* image, const mip_gen_filter_t::E_MODE mode, const bool preserveCoverage=false)
+{
+	mip_gen_filter_t::state_type state;
+	state.baseLayer = 0u;
+	state.layerCount = image->getCreationParameters().arrayLayers;
+	state.startMipLevel = 1u;
+	state.endMipLevel = image->getCreationParameters().mipLevels;
+	state.inOutImage = image;
+	state.mode = mode;
+	state.axisWraps[0] = state.axisWraps[1] = state.axisWraps[2] = asset::ISampler::ETC_CLAMP_TO_EDGE;
+	if (preserveCoverage)
+	{
+		state.alphaSemantic = mip_gen_filter_t::state_type::EAS_REFERENCE_OR_COVERAGE;
+		state.alphaRefValue = AlphaRefValue;
+	}
+	state.scratchMemoryByteSize = mip_gen_filter_t::getRequiredScratchByteSize(&state);
+	// the blit's validation wants scratch even for zero bytes
+	core::vector<uint8_t> scratch(core::max(state.scratchMemoryByteSize,1u));
+	state.scratchMemory = scratch.data();
+	return mip_gen_filter_t::execute(core::execution::par_unseq,&state);
+}
+
+static const uint8_t* getLevel(const asset::ICPUImage* image, const uint32_t level)
+{
+	return reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer())+image->getRegions(level).begin()->bufferOffset;
+}
+
+int main()
+{
+	bool passed = true;
+	const uint32_t mipLevels = core::findMSB(Extent)+1u;
+
+	// the blit only gets compared on the first layer, the fused mode gets a copy of it as the second layer
+	auto blitted = createImage(Extent,mipLevels,1u);
+	auto fused = createImage(Extent,mipLevels,LayerCount);
+	{
+		// smooth gradients plus noise, so that averaging errors would show
+		std::mt19937 mt(0x45u);
+		std::uniform_int_distribution<uint32_t> noise(0u,31u);
+		auto* texels = reinterpret_cast<uint8_t*>(blitted->getBuffer()->getPointer());
+		for (uint32_t y=0u; y<Extent; y++)
+		for (uint32_t x=0u; x<Extent; x++)
+		{
+			auto* texel = texels+(size_t(y)*Extent+x)*4ull;
+			texel[0] = (x*224u/Extent)+noise(mt);
+			texel[1] = (y*224u/Extent)+noise(mt);
+			texel[2] = (x^y)&0xffu;
+			texel[3] = noise(mt)*8u;
+		}
+		const size_t layerSize = size_t(Extent)*Extent*4ull;
+		for (uint32_t layer=0u; layer<LayerCount; layer++)
+			memcpy(reinterpret_cast<uint8_t*>(fused->getBuffer()->getPointer())+layer*layerSize,texels,layerSize);
+	}
+
+	const double blitMs = timeMs([&]() -> void {passed = generate(blitted.get(),mip_gen_filter_t::EM_PER_LEVEL_BLIT) && passed;});
+	const double fusedMs = timeMs([&]() -> void {passed = generate(fused.get(),mip_gen_filter_t::EM_FUSED) && passed;});
+	std::cout << mipLevels << " levels of " << Extent << "^2 RGBA8: per level blit " << blitMs << "ms, fused " << fusedMs << "ms for " << LayerCount << " layers\n";
+
+	for (uint32_t level=1u; level<mipLevels; level++)
+	{
+		const auto mipSize = blitted->getMipSize(level);
+		const size_t layerSize = size_t(mipSize.x)*mipSize.y*4ull;
+		const uint8_t* a = getLevel(blitted.get(),level);
+		const uint8_t* b = getLevel(fused.get(),level);
+		uint32_t maxDifference = 0u;
+		for (size_t i=0ull; i<layerSize; i++)
+			maxDifference = core::max<uint32_t>(maxDifference,std::abs(int32_t(a[i])-int32_t(b[i])));
+		if (maxDifference>MaxLSBDifference)
+		{
+			std::cout << "Level " << level << " differs by up to " << maxDifference << " LSBs\n";
+			passed = false;
+		}
+		for (uint32_t layer=1u; layer<LayerCount; layer++)
+		if (memcmp(b,b+layer*layerSize,layerSize)!=0)
+		{
+			std::cout << "Level " << level << " layer " << layer << " differs from layer 0\n";
+			passed = false;
+		}
+	}
+
+	// alpha tested blobs with soft noisy edges and a high reference value, averaging pulls alpha towards the mean so a naively filtered chain loses coverage quickly
+	auto naive = createImage(Extent,mipLevels,LayerCount);
+	auto covered = createImage(Extent,mipLevels,LayerCount);
+	{
+		std::mt19937 mt(0x46u);
+		std::uniform_real_distribution<double> noise(-0.25,0.25);
+		auto* texels = reinterpret_cast<uint8_t*>(covered->getBuffer()->getPointer());
+		for (size_t i=0ull; i<size_t(Extent)*Extent*LayerCount; i++)
+		{
+			const double x = double(i%Extent)*core::PI<double>()*2.0/double(AlphaPeriod);
+			const double y = double((i/Extent)%Extent)*core::PI<double>()*2.0/double(AlphaPeriod);
+			const double alpha = 0.5+0.5*std::sin(x)*std::sin(y)+noise(mt);
+			texels[i*4ull+0ull] = texels[i*4ull+1ull] = texels[i*4ull+2ull] = 0xffu;
+			texels[i*4ull+3ull] = core::clamp(alpha,0.0,1.0)*255.0+0.5;
+		}
+		memcpy(naive->getBuffer()->getPointer(),texels,size_t(Extent)*Extent*LayerCount*4ull);
+	}
+	auto coverage = [&](const asset::ICPUImage* image, const uint32_t level) -> double
+	{
+		const auto mipSize = image->getMipSize(level);
+		const size_t texelCount = size_t(mipSize.x)*mipSize.y*LayerCount;
+		const uint8_t* texels = getLevel(image,level);
+		size_t count = 0ull;
+		for (size_t i=0ull; i<texelCount; i++)
+			count += double(texels[i*4ull+3ull])/255.0>AlphaRefValue ? 1ull:0ull;
+		return double(count)/double(texelCount);
+	};
+	passed = generate(naive.get(),mip_gen_filter_t::EM_FUSED) && passed;
+	const double coverageMs = timeMs([&]() -> void {passed = generate(covered.get(),mip_gen_filter_t::EM_FUSED,true) && passed;});
+	const double baseCoverage = coverage(covered.get(),0u);
+	std::cout << "Fused with coverage preservation " << coverageMs << "ms, base coverage " << baseCoverage << "\n";
+	for (uint32_t level=1u; level<mipLevels; level++)
+	{
+		// once the blobs are only a few texels big there's not much coverage left to preserve
+		if ((0x1u<<level)>AlphaPeriod/8u)
+			break;
+		const double levelCoverage = coverage(covered.get(),level);
+		std::cout << "\tlevel " << level << " coverage " << levelCoverage << ", without preservation " << coverage(naive.get(),level) << "\n";
+		if (std::abs(levelCoverage-baseCoverage)>MaxCoverageDifference)
+			passed = false;
+	}
+
+	return reportResult(passed);
+}
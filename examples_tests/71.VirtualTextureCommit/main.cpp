@@ -0,0 +1,235 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Builds the same CPU virtual texture twice out of a few hundred random images, once the way 20.Megatexture used to
+// (pad one image, commit it, next image) and once with a single batched commit which does everything in parallel.
+// Physical pages get allocated in a different order by the batch, so the textures are compared through their page tables,
+// every tile (padding included) of every texture must match.
+// Then the batch gets recommitted incrementally, first unchanged, then with a single image modified,
+// only that one may be recommitted and its old physical pages must be freed.
+
+using namespace nbl;
+
+constexpr uint32_t TextureCount = 192u;
+constexpr uint32_t MinExtent = 64u;
+constexpr uint32_t MaxExtent = 512u;
+constexpr uint32_t PageSizeLog2 = 7u;
+constexpr uint32_t TilesPerDimLog2 = 4u;
+constexpr uint32_t TilePadding = 8u;
+constexpr uint32_t MaxAllocatableTexSizeLog2 = 12u;
+constexpr asset::E_FORMAT Format = asset::EF_R8G8B8A8_UNORM;
+
+using vt_t = asset::ICPUVirtualTexture;
+using texture_data_t = vt_t::SMasterTextureData;
+
+static core::smart_refctd_ptr<asset::ICPUImage> createImage(const asset::VkExtent3D& extent, std::mt19937& mt)
+{
+	asset::ICPUImage::SCreationParams params;
+	params.flags = static_cast<asset::IImage::E_CREATE_FLAGS>(0u);
+	params.type = asset::IImage::ET_2D;
+	params.format = Format;
+	params.extent = extent;
+	params.mipLevels = 1u;
+	params.arrayLayers = 1u;
+	params.samples = asset::IImage::ESCF_1_BIT;
+	auto image = asset::ICPUImage::create(std::move(params));
+
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<asset::IImage::SBufferCopy>>(1u);
+	auto& region = regions->front();
+	region.bufferOffset = 0u;
+	region.bufferRowLength = extent.width;
+	region.bufferImageHeight = 0u;
+	region.imageSubresource.aspectMask = static_cast<asset::IImage::E_ASPECT_FLAGS>(0u);
+	region.imageSubresource.mipLevel = 0u;
+	region.imageSubresource.baseArrayLayer = 0u;
+	region.imageSubresource.layerCount = 1u;
+	region.imageOffset = {0u,0u,0u};
+	region.imageExtent = extent;
+	auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(extent.width*extent.height*sizeof(uint32_t));
+	std::generate_n(reinterpret_cast<uint32_t*>(buffer->getPointer()),extent.width*extent.height,mt);
+	image->setBufferAndRegions(std::move(buffer),std::move(regions));
+	return image;
+}
+
+static core::smart_refctd_ptr<vt_t> createVirtualTexture()
+{
+	return core::make_smart_refctd_ptr<vt_t>([](asset::E_FORMAT_CLASS) -> uint32_t {return TilesPerDimLog2;},PageSizeLog2,TilePadding,MaxAllocatableTexSizeLog2);
+}
+
+static asset::IImage::SSubresourceRange getSubresource(const asset::ICPUImage* image)
+{
+	const auto& extent = image->getCreationParameters().extent;
+	asset::IImage::SSubresourceRange subres;
+	subres.aspectMask = static_cast<asset::IImage::E_ASPECT_FLAGS>(0u);
+	subres.baseMipLevel = 0u;
+	subres.levelCount = core::findLSB(core::roundDownToPoT<uint32_t>(std::max(extent.width,extent.height)))+1u;
+	subres.baseArrayLayer = 0u;
+	subres.layerCount = 1u;
+	return subres;
+}
+
+static uint32_t getPageTableEntry(const vt_t* vt, const texture_data_t& addr, uint32_t level, uint32_t x, uint32_t y)
+{
+	const auto* pageTable = vt->getPageTable();
+	const auto texelPos = core::vectorSIMDu32((addr.pgTab_x>>level)+x,(addr.pgTab_y>>level)+y,0u,addr.pgTab_layer);
+	const auto* region = pageTable->getRegion(level,texelPos);
+	const uint64_t byteoffset = region->getByteOffset(texelPos,region->getByteStrides(pageTable->getTexelBlockInfo()));
+	return *reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(pageTable->getBuffer()->getPointer())+byteoffset);
+}
+
+//! compares the padded tile the 16bit physical page address `pageA` points to in `a` against the one `pageB` points to in `b`
+static bool compareTiles(const vt_t* a, uint32_t pageA, const vt_t* b, uint32_t pageB)
+{
+	constexpr uint32_t InvalidAddr = 0xffffu;
+	if ((pageA==InvalidAddr)!=(pageB==InvalidAddr))
+		return false;
+	if (pageA==InvalidAddr)
+		return true;
+
+	auto getTile = [](const vt_t* vt, uint32_t page) -> const uint8_t*
+	{
+		// page address layout is 4 bits of x, 4 bits of y and 8 bits of layer
+		const auto* storage = vt->getResidentStorages().begin()->second->image.get();
+		const uint32_t tileExtent = vt->getPageExtent()+2u*vt->getTilePadding();
+		const auto texelPos = core::vectorSIMDu32((page&0xfu)*tileExtent,((page>>4u)&0xfu)*tileExtent,0u,page>>8u);
+		const auto* region = storage->getRegion(0u,texelPos);
+		return reinterpret_cast<const uint8_t*>(storage->getBuffer()->getPointer())+region->getByteOffset(texelPos,region->getByteStrides(storage->getTexelBlockInfo()));
+	};
+	const uint32_t tileExtent = a->getPageExtent()+2u*a->getTilePadding();
+	const size_t rowPitch = a->getResidentStorages().begin()->second->image->getRegions().begin()->bufferRowLength*sizeof(uint32_t);
+	const uint8_t* tileA = getTile(a,pageA);
+	const uint8_t* tileB = getTile(b,pageB);
+	for (uint32_t y=0u; y<tileExtent; y++)
+	if (memcmp(tileA+y*rowPitch,tileB+y*rowPitch,tileExtent*sizeof(uint32_t)))
+		return false;
+	return true;
+}
+
+static bool compareTextures(const vt_t* a, const texture_data_t& addrA, const vt_t* b, const texture_data_t& addrB)
+{
+	const uint32_t pageExtent = a->getPageExtent();
+	// levels which take at least one page, the last one also points to the miptail
+	const uint32_t maxExtent = core::roundUpToPoT<uint32_t>(core::max<uint32_t>(addrA.origsize_x,addrA.origsize_y));
+	const uint32_t levelCount = core::max<int32_t>(int32_t(core::findMSB(maxExtent))-int32_t(core::findMSB(pageExtent))+1,1);
+	for (uint32_t i=0u; i<levelCount; i++)
+	{
+		const uint32_t w = ((core::max<uint32_t>(addrA.origsize_x>>i,1u))+pageExtent-1u)/pageExtent;
+		const uint32_t h = ((core::max<uint32_t>(addrA.origsize_y>>i,1u))+pageExtent-1u)/pageExtent;
+		for (uint32_t y=0u; y<h; y++)
+		for (uint32_t x=0u; x<w; x++)
+		{
+			const uint32_t entryA = getPageTableEntry(a,addrA,i,x,y);
+			const uint32_t entryB = getPageTableEntry(b,addrB,i,x,y);
+			// low half is the page itself, high half the miptail page
+			if (!compareTiles(a,entryA&0xffffu,b,entryB&0xffffu) || !compareTiles(a,entryA>>16u,b,entryB>>16u))
+				return false;
+		}
+	}
+	return true;
+}
+
+static uint32_t getFreePages(const vt_t* vt)
+{
+	return vt->getResidentStorages().begin()->second->tileAlctr.get_free_size();
+}
+
+int main()
+{
+	std::mt19937 mt(0x45u);
+	std::uniform_int_distribution<uint32_t> extentDist(MinExtent,MaxExtent);
+	const asset::ISampler::E_TEXTURE_CLAMP wraps[] = {asset::ISampler::ETC_REPEAT,asset::ISampler::ETC_CLAMP_TO_EDGE,asset::ISampler::ETC_MIRROR};
+
+	core::vector<core::smart_refctd_ptr<asset::ICPUImage>> images(TextureCount);
+	core::vector<vt_t::SPendingCommit> commits;
+	commits.reserve(TextureCount);
+	auto serialVT = createVirtualTexture();
+	auto batchedVT = createVirtualTexture();
+	core::vector<texture_data_t> serialAddrs;
+	serialAddrs.reserve(TextureCount);
+	for (uint32_t i=0u; i<TextureCount; i++)
+	{
+		images[i] = createImage({extentDist(mt),extentDist(mt),1u},mt);
+		const auto uwrap = wraps[i%3u];
+		const auto vwrap = wraps[(i/3u)%3u];
+		const auto border = asset::ISampler::ETBC_FLOAT_OPAQUE_BLACK;
+		const auto subres = getSubresource(images[i].get());
+		const auto& extent = images[i]->getCreationParameters().extent;
+
+		serialAddrs.push_back(serialVT->alloc(Format,extent,subres,uwrap,vwrap));
+		commits.push_back({batchedVT->alloc(Format,extent,subres,uwrap,vwrap),images[i].get(),subres,uwrap,vwrap,border});
+		if (texture_data_t::is_invalid(serialAddrs.back()) || texture_data_t::is_invalid(commits.back().addr))
+		{
+			std::cout << "Could not allocate texture " << i << "\n";
+			return 1;
+		}
+	}
+	serialVT->shrink();
+	batchedVT->shrink();
+
+	auto commitSerially = [&](const uint32_t i) -> void
+	{
+		const auto& cm = commits[i];
+		auto padded = vt_t::createPoTPaddedSquareImageWithMipLevels(cm.image,cm.uwrap,cm.vwrap,cm.border).first;
+		serialVT->commit(serialAddrs[i],padded.get(),cm.subresource,cm.uwrap,cm.vwrap,cm.border);
+	};
+	const double serialMs = timeMs([&]() -> void
+	{
+		for (uint32_t i=0u; i<TextureCount; i++)
+			commitSerially(i);
+	});
+	vt_t::SCommitStatistics stats;
+	// incremental so the hashes get recorded, there's nothing to skip yet
+	const double batchedMs = timeMs([&]() -> void {stats = batchedVT->commit(core::execution::par_unseq,commits.data(),commits.data()+commits.size(),true);});
+	std::cout << TextureCount << " textures committed one by one in " << serialMs << "ms, batched in " << batchedMs << "ms\n";
+
+	bool passed = stats.committed==TextureCount && stats.failed==0u;
+	auto compareAll = [&]() -> void
+	{
+		for (uint32_t i=0u; i<TextureCount; i++)
+		if (!compareTextures(serialVT.get(),serialAddrs[i],batchedVT.get(),commits[i].addr))
+		{
+			std::cout << "Texture " << i << " differs between the serial and batched commits!\n";
+			passed = false;
+		}
+	};
+	compareAll();
+	if (getFreePages(serialVT.get())!=getFreePages(batchedVT.get()))
+	{
+		std::cout << "Serial commits left " << getFreePages(serialVT.get()) << " free pages, batched " << getFreePages(batchedVT.get()) << "\n";
+		passed = false;
+	}
+
+	const uint32_t freePages = getFreePages(batchedVT.get());
+	const double unchangedMs = timeMs([&]() -> void {stats = batchedVT->commit(core::execution::par_unseq,commits.data(),commits.data()+commits.size(),true);});
+	std::cout << "Incremental commit without changes in " << unchangedMs << "ms, " << stats.unchanged << " unchanged\n";
+	passed = passed && stats.unchanged==TextureCount && stats.committed==0u;
+
+	constexpr uint32_t Modified = TextureCount/2u;
+	reinterpret_cast<uint32_t*>(images[Modified]->getBuffer()->getPointer())[0] ^= 0xdeadbeefu;
+	const double modifiedMs = timeMs([&]() -> void {stats = batchedVT->commit(core::execution::par_unseq,commits.data(),commits.data()+commits.size(),true);});
+	std::cout << "Incremental commit with one image changed in " << modifiedMs << "ms, " << stats.committed << " recommitted\n";
+	passed = passed && stats.unchanged==TextureCount-1u && stats.committed==1u;
+	if (getFreePages(batchedVT.get())!=freePages)
+	{
+		std::cout << "Recommitting leaked " << int64_t(freePages)-int64_t(getFreePages(batchedVT.get())) << " physical pages\n";
+		passed = false;
+	}
+	// the serial VT has no idea about hashes, free its pages by hand so it can be compared again
+	{
+		serialVT->free(serialAddrs[Modified]);
+		const auto& cm = commits[Modified];
+		serialAddrs[Modified] = serialVT->alloc(Format,cm.image->getCreationParameters().extent,cm.subresource,cm.uwrap,cm.vwrap);
+		commitSerially(Modified);
+	}
+	compareAll();
+
+	return reportResult(passed);
+}
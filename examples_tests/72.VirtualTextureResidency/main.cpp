@@ -0,0 +1,266 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/asset/utils/CVirtualTextureResidencyManager.h"
+
+// Replays a trace of page requests (what a renderer would read back from its feedback buffer every frame)
+// against CVirtualTextureResidencyManager with a few different page budgets and reports the hit rates.
+// Without arguments a trace gets recorded first: a camera flies back and forth over a row of textures which are only allocated
+// in the virtual texture, the closer a texture the finer the mip level it wants, plus a few random requests for coarse pages.
+// A trace file recorded elsewhere can be passed as the first argument, it has to address the same page table layout.
+// After every frame the patches get applied and the page table must agree with the manager, no physical page may be used twice.
+// Textures handed over to a manager must not be freeable, once the managers are gone freeing them must not free any of their pages again.
+
+using namespace nbl;
+
+constexpr uint32_t TextureCount = 48u;
+constexpr uint32_t TextureExtent = 1024u;
+constexpr uint32_t PageSizeLog2 = 7u;
+constexpr uint32_t TilesPerDimLog2 = 4u;
+constexpr uint32_t StorageLayers = 2u;
+constexpr uint32_t TilePadding = 8u;
+constexpr uint32_t MaxAllocatableTexSizeLog2 = 12u;
+constexpr uint32_t FrameCount = 960u;
+constexpr float ViewDistance = 6.f;
+constexpr uint32_t RandomRequestsPerFrame = 8u;
+constexpr asset::E_FORMAT Format = asset::EF_R8G8B8A8_UNORM;
+constexpr uint32_t PageBudgets[] = {96u,192u,384u,512u};
+
+using vt_t = asset::ICPUVirtualTexture;
+using texture_data_t = vt_t::SMasterTextureData;
+using residency_manager_t = asset::CVirtualTextureResidencyManager<vt_t>;
+using page_request_t = residency_manager_t::SPageRequest;
+using frame_t = core::vector<page_request_t>;
+
+static core::smart_refctd_ptr<vt_t> createVirtualTexture()
+{
+	const asset::E_FORMAT formats[] = {Format};
+	vt_t::ICPUVTResidentStorage::SCreationParams storage;
+	storage.formatClass = asset::getFormatClass(Format);
+	storage.formats = formats;
+	storage.formatCount = 1u;
+	storage.tilesPerDim_log2 = TilesPerDimLog2;
+	storage.layerCount = StorageLayers;
+	return core::make_smart_refctd_ptr<vt_t>([](asset::E_FORMAT_CLASS) -> uint32_t {return TilesPerDimLog2;},&storage,1u,PageSizeLog2,4u,TilePadding,MaxAllocatableTexSizeLog2);
+}
+
+static core::vector<texture_data_t> allocTextures(vt_t* vt)
+{
+	asset::IImage::SSubresourceRange subres;
+	subres.aspectMask = static_cast<asset::IImage::E_ASPECT_FLAGS>(0u);
+	subres.baseMipLevel = 0u;
+	subres.levelCount = core::findLSB(TextureExtent)+1u;
+	subres.baseArrayLayer = 0u;
+	subres.layerCount = 1u;
+
+	core::vector<texture_data_t> textures;
+	for (uint32_t i=0u; i<TextureCount; i++)
+		textures.push_back(vt->alloc(Format,{TextureExtent,TextureExtent,1u},subres,asset::ISampler::ETC_REPEAT,asset::ISampler::ETC_REPEAT));
+	return textures;
+}
+
+static frame_t::value_type getRequest(const texture_data_t& addr, uint32_t level, uint32_t x, uint32_t y)
+{
+	return {static_cast<uint8_t>(addr.pgTab_layer),static_cast<uint8_t>(level),static_cast<uint16_t>((addr.pgTab_x>>level)+x),static_cast<uint16_t>((addr.pgTab_y>>level)+y)};
+}
+
+static core::vector<frame_t> recordTrace(const core::vector<texture_data_t>& textures)
+{
+	const uint32_t levelCount = core::findLSB(TextureExtent>>PageSizeLog2)+1u;
+	std::mt19937 mt(0x72u);
+	std::uniform_int_distribution<uint32_t> textureDist(0u,TextureCount-1u);
+
+	core::vector<frame_t> trace(FrameCount);
+	for (uint32_t f=0u; f<FrameCount; f++)
+	{
+		// there and back again
+		const float t = float(f)/float(FrameCount-1u);
+		const float camera = (t<0.5f ? t*2.f:(1.f-t)*2.f)*float(TextureCount-1u);
+		auto& frame = trace[f];
+		for (uint32_t i=0u; i<TextureCount; i++)
+		{
+			const float distance = std::abs(float(i)-camera);
+			if (distance>ViewDistance)
+				continue;
+			const uint32_t level = core::min<uint32_t>(core::findMSB(uint32_t(distance)+1u),levelCount-1u);
+			const uint32_t pages = (TextureExtent>>PageSizeLog2)>>level;
+			for (uint32_t y=0u; y<pages; y++)
+			for (uint32_t x=0u; x<pages; x++)
+				frame.push_back(getRequest(textures[i],level,x,y));
+		}
+		for (uint32_t r=0u; r<RandomRequestsPerFrame; r++)
+			frame.push_back(getRequest(textures[textureDist(mt)],levelCount-1u,0u,0u));
+		std::shuffle(frame.begin(),frame.end(),mt);
+	}
+	return trace;
+}
+
+static void writeTrace(const std::string& path, const core::vector<frame_t>& trace)
+{
+	std::ofstream file(path,std::ios::binary);
+	const uint32_t frameCount = trace.size();
+	file.write(reinterpret_cast<const char*>(&frameCount),sizeof(frameCount));
+	for (const auto& frame : trace)
+	{
+		const uint32_t requestCount = frame.size();
+		file.write(reinterpret_cast<const char*>(&requestCount),sizeof(requestCount));
+		file.write(reinterpret_cast<const char*>(frame.data()),frame.size()*sizeof(page_request_t));
+	}
+}
+
+static bool readTrace(const std::string& path, core::vector<frame_t>& outTrace)
+{
+	std::ifstream file(path,std::ios::binary);
+	uint32_t frameCount = 0u;
+	if (!file.read(reinterpret_cast<char*>(&frameCount),sizeof(frameCount)))
+		return false;
+	outTrace.resize(frameCount);
+	for (auto& frame : outTrace)
+	{
+		uint32_t requestCount = 0u;
+		if (!file.read(reinterpret_cast<char*>(&requestCount),sizeof(requestCount)))
+			return false;
+		frame.resize(requestCount);
+		if (!file.read(reinterpret_cast<char*>(frame.data()),frame.size()*sizeof(page_request_t)))
+			return false;
+	}
+	return true;
+}
+
+static uint32_t getPageTableEntry(const vt_t* vt, const page_request_t& page)
+{
+	const auto* pageTable = vt->getPageTable();
+	const auto texelPos = core::vectorSIMDu32(page.x,page.y,0u,page.pgTabLayer);
+	const auto* region = pageTable->getRegion(page.mip,texelPos);
+	const uint64_t byteoffset = region->getByteOffset(texelPos,region->getByteStrides(pageTable->getTexelBlockInfo()));
+	return *reinterpret_cast<const uint32_t*>(reinterpret_cast<const uint8_t*>(pageTable->getBuffer()->getPointer())+byteoffset);
+}
+
+int main(int argc, char** argv)
+{
+	constexpr uint32_t InvalidAddr = 0xffffu;
+
+	auto vt = createVirtualTexture();
+	const auto textures = allocTextures(vt.get());
+	for (const auto& addr : textures)
+	if (texture_data_t::is_invalid(addr))
+	{
+		std::cout << "Could not allocate the textures!\n";
+		return 1;
+	}
+
+	std::string tracePath;
+	if (argc>1)
+		tracePath = argv[1];
+	else
+	{
+		tracePath = (std::filesystem::temp_directory_path()/"nbl_vt_residency.trace").string();
+		writeTrace(tracePath,recordTrace(textures));
+	}
+	core::vector<frame_t> trace;
+	if (!readTrace(tracePath,trace))
+	{
+		std::cout << "Could not read the trace from " << tracePath << "\n";
+		return 1;
+	}
+	size_t requestCount = 0ull;
+	for (const auto& frame : trace)
+		requestCount += frame.size();
+	std::cout << "Replaying " << trace.size() << " frames, " << requestCount << " page requests from " << tracePath << "\n";
+
+	auto* storage = vt->getResidentStorages().begin()->second.get();
+	const uint32_t initialFreePages = storage->tileAlctr.get_free_size();
+
+	bool passed = true;
+	for (const uint32_t budget : PageBudgets)
+	{
+		auto manager = residency_manager_t::create(core::smart_refctd_ptr(vt),asset::getFormatClass(Format),budget);
+		if (!manager)
+		{
+			std::cout << "Could not reserve " << budget << " pages!\n";
+			passed = false;
+			continue;
+		}
+		for (const auto& addr : textures)
+			manager->addTexture(addr);
+
+		residency_manager_t::SUpdateBatch batch;
+		size_t uploads = 0ull;
+		double ms = 0.0;
+		for (uint32_t f=0u; f<trace.size(); f++)
+		{
+			const auto& frame = trace[f];
+			batch.clear();
+			ms += timeMs([&]() -> void {manager->processFeedback(frame.data(),frame.data()+frame.size(),batch);});
+			uploads += batch.uploads.size();
+			residency_manager_t::applyPageTablePatches(vt->getPageTable(),batch.patches.data(),batch.patches.data()+batch.patches.size());
+
+			core::unordered_set<uint32_t> usedPages;
+			for (const auto& upload : batch.uploads)
+			if (!usedPages.insert(upload.physPgAddr).second || upload.physPgAddr==InvalidAddr)
+			{
+				std::cout << "Budget " << budget << ", frame " << f << ": physical page " << upload.physPgAddr << " uploaded twice!\n";
+				passed = false;
+			}
+			usedPages.clear();
+			for (const auto& page : frame)
+			{
+				const uint32_t resident = manager->getResidentPage(page);
+				if (resident==InvalidAddr)
+					continue;
+				if ((getPageTableEntry(vt.get(),page)&0xffffu)!=resident)
+				{
+					std::cout << "Budget " << budget << ", frame " << f << ": page table doesn't point at the resident page!\n";
+					passed = false;
+				}
+				// duplicate requests share the physical page, so only compare against the other pages
+				usedPages.insert(resident);
+			}
+			if (usedPages.size()>manager->getResidentPageCount())
+			{
+				std::cout << "Budget " << budget << ", frame " << f << ": more physical pages in use than resident!\n";
+				passed = false;
+			}
+		}
+
+		const auto& stats = manager->getStatistics();
+		std::cout << "Budget " << manager->getPageBudget() << " pages: hit rate " << stats.getHitRate()*100.0 << "%, "
+			<< stats.misses << " misses, " << stats.evictions << " evictions, " << stats.dropped << " dropped, "
+			<< double(uploads)/double(trace.size()) << " uploads/frame, " << ms << "ms total\n";
+		if (stats.requests!=stats.hits+stats.misses+stats.dropped)
+		{
+			std::cout << "Statistics don't add up!\n";
+			passed = false;
+		}
+		if (vt->free(textures.front()))
+		{
+			std::cout << "A texture handed over to the residency manager got freed!\n";
+			passed = false;
+		}
+	}
+	// the managers handed the textures back without any pages
+	for (const auto& addr : textures)
+	if (!vt->free(addr))
+	{
+		std::cout << "Could not free a texture handed back by the residency managers!\n";
+		passed = false;
+	}
+	if (storage->tileAlctr.get_free_size()!=initialFreePages)
+	{
+		std::cout << "Residency managers leaked " << initialFreePages-storage->tileAlctr.get_free_size() << " physical pages!\n";
+		passed = false;
+	}
+
+	if (argc<=1)
+		std::filesystem::remove(tracePath);
+	return reportResult(passed);
+}
@@ -0,0 +1,174 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <fstream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/system/CBufferedFileWriter.h"
+
+// Throughput of the mesh writers, which go through a CBufferedFileWriter instead of one IFile::write per vertex component.
+// A tesselated sphere gets written as binary and ASCII STL and PLY through the IAssetManager, the binary STL must have the exact size.
+// Then the same stream of small STL-like records is written with one IFile::write per field (what the writers used to do)
+// and through a CBufferedFileWriter, both files must be identical.
+
+using namespace nbl;
+
+constexpr uint32_t SphereTesselation = 512u;
+constexpr uint32_t RecordCount = 100000u;
+
+static core::smart_refctd_ptr<asset::ICPUMesh> createMesh(asset::IAssetManager* assetManager, uint32_t& outTriangleCount)
+{
+	auto geometry = assetManager->getGeometryCreator()->createSphereMesh(1.f,SphereTesselation,SphereTesselation);
+	// the writers only need the vertex input and primitive assembly parameters
+	auto pipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(
+		nullptr,nullptr,nullptr,geometry.inputParams,asset::SBlendParams(),geometry.assemblyParams,asset::SRasterizationParams()
+	);
+	auto meshbuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>(std::move(pipeline),nullptr,geometry.bindings,std::move(geometry.indexBuffer));
+	meshbuffer->setIndexCount(geometry.indexCount);
+	meshbuffer->setIndexType(geometry.indexType);
+	meshbuffer->setBoundingBox(geometry.bbox);
+	outTriangleCount = geometry.indexCount/3u;
+
+	auto mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
+	mesh->getMeshBufferVector().push_back(std::move(meshbuffer));
+	return mesh;
+}
+
+static core::smart_refctd_ptr<system::IFile> createFile(system::ISystem* system, const std::filesystem::path& path)
+{
+	std::filesystem::remove(path);
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	system->createFile(future,path,system::IFile::ECF_WRITE);
+	return future.get();
+}
+
+static std::string readWholeFile(const std::filesystem::path& path)
+{
+	std::ifstream file(path,std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(file),std::istreambuf_iterator<char>());
+}
+
+int main()
+{
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_writer_throughput";
+	std::filesystem::create_directories(directory);
+
+	bool passed = true;
+	uint32_t triangleCount;
+	const auto mesh = createMesh(assetManager.get(),triangleCount);
+	std::cout << "Writing a sphere of " << triangleCount << " triangles\n";
+
+	struct SCase
+	{
+		const char* name;
+		const char* extension;
+		asset::E_WRITER_FLAGS flags;
+	};
+	const SCase cases[] = {
+		{"binary STL","stl",asset::EWF_BINARY},
+		{"ASCII STL","stl",asset::EWF_NONE},
+		{"binary PLY","ply",asset::EWF_BINARY},
+		{"ASCII PLY","ply",asset::EWF_NONE}
+	};
+	for (const auto& testCase : cases)
+	{
+		const auto path = directory/(std::string("sphere_")+(testCase.flags&asset::EWF_BINARY ? "binary.":"ascii.")+testCase.extension);
+		std::filesystem::remove(path);
+
+		bool success;
+		const double ms = timeMs([&]() -> void {success = assetManager->writeAsset(path.string(),asset::IAssetWriter::SAssetWriteParams(mesh.get(),testCase.flags));});
+		const size_t size = std::filesystem::exists(path) ? std::filesystem::file_size(path):0ull;
+		if (!success || !size)
+		{
+			std::cout << "Writing " << testCase.name << " failed!\n";
+			passed = false;
+			continue;
+		}
+		// 80 byte header, triangle count, and 50 bytes per triangle
+		if (testCase.flags==asset::EWF_BINARY && !strcmp(testCase.extension,"stl") && size!=84ull+50ull*triangleCount)
+		{
+			std::cout << "Binary STL is " << size << " bytes instead of " << 84ull+50ull*triangleCount << "!\n";
+			passed = false;
+		}
+		std::cout << testCase.name << ": " << size/1024ull << "KiB in " << ms << "ms, " << double(size)/(ms*1000.0) << "MB/s, "
+			<< double(triangleCount)/(ms*1000.0) << "M triangles/s\n";
+	}
+
+	// same bytes, written per field and combined
+	std::mt19937 mt(0x73u);
+	std::uniform_real_distribution<float> dist(-1.f,1.f);
+	core::vector<float> fields(RecordCount*12u);
+	for (auto& field : fields)
+		field = dist(mt);
+	const uint16_t attribute = 0u;
+
+	const auto naivePath = directory/"records_naive.bin";
+	const auto combinedPath = directory/"records_combined.bin";
+	auto naiveFile = createFile(system.get(),naivePath);
+	auto combinedFile = createFile(system.get(),combinedPath);
+	if (!naiveFile || !combinedFile)
+	{
+		std::cout << "Could not create the files in " << directory << "\n";
+		return 1;
+	}
+
+	bool naiveSuccess = true;
+	const double naiveMs = timeMs([&]() -> void
+	{
+		size_t offset = 0ull;
+		auto write = [&](const void* data, size_t size) -> void
+		{
+			system::IFile::success_t success;
+			naiveFile->write(success,data,offset,size);
+			naiveSuccess = naiveSuccess && bool(success);
+			offset += size;
+		};
+		for (uint32_t i=0u; i<RecordCount; i++)
+		{
+			for (uint32_t v=0u; v<4u; v++)
+				write(fields.data()+i*12u+v*3u,sizeof(float)*3u);
+			write(&attribute,sizeof(attribute));
+		}
+	});
+	bool combinedSuccess;
+	const double combinedMs = timeMs([&]() -> void
+	{
+		system::CBufferedFileWriter writer(combinedFile.get());
+		for (uint32_t i=0u; i<RecordCount; i++)
+		{
+			for (uint32_t v=0u; v<4u; v++)
+				writer.write(fields.data()+i*12u+v*3u,sizeof(float)*3u);
+			writer.writeValue(attribute);
+		}
+		combinedSuccess = writer.flush();
+	});
+	naiveFile = nullptr;
+	combinedFile = nullptr;
+
+	const double recordBytes = double(RecordCount)*50.0;
+	std::cout << RecordCount << " records of 5 fields, one IFile::write per field: " << naiveMs << "ms, " << recordBytes/(naiveMs*1000.0) << "MB/s\n";
+	std::cout << RecordCount << " records of 5 fields, CBufferedFileWriter: " << combinedMs << "ms, " << recordBytes/(combinedMs*1000.0) << "MB/s, "
+		<< naiveMs/combinedMs << "x faster\n";
+	if (!naiveSuccess || !combinedSuccess)
+	{
+		std::cout << "Writing the records failed!\n";
+		passed = false;
+	}
+	else if (readWholeFile(naivePath)!=readWholeFile(combinedPath))
+	{
+		std::cout << "Combined writes produced a different file!\n";
+		passed = false;
+	}
+
+	std::filesystem::remove_all(directory);
+	return reportResult(passed);
+}
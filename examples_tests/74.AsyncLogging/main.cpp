@@ -0,0 +1,128 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Many threads log debug lines the way a loader does, first through a logger which formats and writes every line
+// under a mutex and waits for the write (what CFileLogger used to do), then through CFileLogger which batches them on a flusher thread.
+// With the blocking policy every line must end up in the file, with the dropping policy the lines and the notes about the dropped
+// ones must add up. An error has to be in the file as soon as `log` returns, without destroying the logger.
+
+using namespace nbl;
+
+constexpr uint32_t ThreadCount = 8u;
+constexpr uint32_t LinesPerThread = 20000u;
+
+static core::smart_refctd_ptr<system::IFile> createFile(system::ISystem* system, const std::filesystem::path& path)
+{
+	std::filesystem::remove(path);
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	system->createFile(future,path,system::IFile::ECF_WRITE);
+	return future.get();
+}
+
+//! One write per line, waited for under the lock
+class CSynchronousFileLogger final : public system::IThreadsafeLogger
+{
+	public:
+		CSynchronousFileLogger(core::smart_refctd_ptr<system::IFile>&& _file) : IThreadsafeLogger(core::bitflag(ELL_DEBUG)|ELL_INFO|ELL_WARNING|ELL_PERFORMANCE|ELL_ERROR), m_file(std::move(_file)) {}
+
+	private:
+		void threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel) override
+		{
+			system::ISystem::future_t<size_t> future;
+			m_file->write(future,line.data(),m_pos,line.size());
+			m_pos += future.get();
+		}
+
+		core::smart_refctd_ptr<system::IFile> m_file;
+		size_t m_pos = 0ull;
+};
+
+static void logFromThreads(system::ILogger* logger)
+{
+	core::vector<std::thread> threads;
+	for (uint32_t t=0u; t<ThreadCount; t++)
+	threads.emplace_back([logger,t]() -> void
+	{
+		for (uint32_t i=0u; i<LinesPerThread; i++)
+			logger->log("Thread %d: parsed element %d of \"%s\", %f ms",system::ILogger::ELL_DEBUG,t,i,"some/asset/path.ply",double(i)*0.001);
+	});
+	for (auto& thread : threads)
+		thread.join();
+}
+
+static size_t countLines(const std::filesystem::path& path, const char* substring=nullptr)
+{
+	std::ifstream file(path);
+	size_t count = 0ull;
+	for (std::string line; std::getline(file,line);)
+	if (!substring || line.find(substring)!=std::string::npos)
+		count++;
+	return count;
+}
+
+int main()
+{
+	auto system = createSystem();
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_async_logging";
+	std::filesystem::create_directories(directory);
+	const auto allLevels = core::bitflag(system::ILogger::ELL_DEBUG)|system::ILogger::ELL_INFO|system::ILogger::ELL_WARNING|system::ILogger::ELL_PERFORMANCE|system::ILogger::ELL_ERROR;
+	constexpr size_t TotalLines = ThreadCount*LinesPerThread;
+
+	bool passed = true;
+	double syncMs;
+	{
+		const auto path = directory/"synchronous.log";
+		auto logger = core::make_smart_refctd_ptr<CSynchronousFileLogger>(createFile(system.get(),path));
+		syncMs = timeMs([&]() -> void {logFromThreads(logger.get());});
+		logger = nullptr;
+		if (countLines(path)!=TotalLines)
+		{
+			std::cout << "Synchronous logger wrote " << countLines(path) << " lines instead of " << TotalLines << "!\n";
+			passed = false;
+		}
+	}
+	std::cout << ThreadCount << " threads x " << LinesPerThread << " lines, synchronous: " << syncMs << "ms, " << double(TotalLines)/syncMs << " lines/ms\n";
+
+	for (const auto policy : {system::IAsyncLogger::EOP_BLOCK,system::IAsyncLogger::EOP_DROP})
+	{
+		const bool drop = policy==system::IAsyncLogger::EOP_DROP;
+		const auto path = directory/(drop ? "dropping.log":"blocking.log");
+		system::IAsyncLogger::SCreationParams params;
+		params.overflowPolicy = policy;
+		auto logger = core::make_smart_refctd_ptr<system::CFileLogger>(createFile(system.get(),path),false,allLevels,params);
+
+		double ms = timeMs([&]() -> void {logFromThreads(logger.get());});
+		// has to be on disk as soon as `log` returns
+		logger->log("Fatal error in thread %d",system::ILogger::ELL_ERROR,0);
+		if (countLines(path,"Fatal error in thread 0")!=1ull)
+		{
+			std::cout << "The error was not written before `log` returned!\n";
+			passed = false;
+		}
+		const auto stats = logger->getStatistics();
+		ms += timeMs([&]() -> void {logger = nullptr;});
+
+		const size_t lines = countLines(path);
+		const size_t dropNotes = countLines(path,"log messages were dropped");
+		if (stats.lines+stats.dropped!=TotalLines+1ull || lines!=stats.lines+dropNotes || (!drop && stats.dropped))
+		{
+			std::cout << "Lines don't add up, " << lines << " in the file, " << stats.lines << " logged, " << stats.dropped << " dropped!\n";
+			passed = false;
+		}
+		std::cout << ThreadCount << " threads x " << LinesPerThread << " lines, " << (drop ? "dropping":"blocking") << " CFileLogger: "
+			<< ms << "ms including the final flush, " << double(TotalLines)/ms << " lines/ms, " << syncMs/ms << "x faster, "
+			<< stats.batches << " writes, " << stats.stalls << " stalls, " << stats.dropped << " dropped\n";
+	}
+
+	std::filesystem::remove_all(directory);
+	return reportResult(passed);
+}
@@ -0,0 +1,154 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Compares core::radix_sort against std::sort, sequential and parallel, for key counts from a thousand up to the first argument
+// (ten million by default, a billion needs around 16 GB). Every sort is checked against std::sort.
+// Unsigned keys go through the serial, parallel and in-place radix sorts, floats through the parallel one,
+// key-value pairs through radix_sort_pairs against std::stable_sort of (key,value) structs.
+
+using namespace nbl;
+
+constexpr size_t MinKeyCount = 1000ull;
+constexpr size_t DefaultMaxKeyCount = 10000000ull;
+//! small sizes get repeated to measure something
+constexpr size_t KeysPerMeasurement = 10000000ull;
+
+struct SKeyValue
+{
+	uint32_t key;
+	uint32_t value;
+};
+
+static bool passed = true;
+
+//! runs `sort(out)` on a fresh copy of `keys` enough times, checks the result against `reference`, returns milliseconds per sort
+template<typename T, typename F>
+static double measure(const char* name, const core::vector<T>& keys, const core::vector<T>& reference, F&& sort)
+{
+	const size_t repeats = core::max<size_t>(KeysPerMeasurement/keys.size(),1ull);
+	core::vector<T> data;
+	double ms = 0.0;
+	const T* sorted = nullptr;
+	for (size_t r=0ull; r<repeats; r++)
+	{
+		data = keys;
+		ms += timeMs([&]() -> void {sorted = sort(data.data());});
+	}
+	if (!std::equal(reference.begin(),reference.end(),sorted))
+	{
+		std::cout << name << " sorted " << keys.size() << " keys wrong!\n";
+		passed = false;
+	}
+	return ms/double(repeats);
+}
+
+//! speedup is relative to the first, std:: sort of the group
+int main(int argc, char** argv)
+{
+	const size_t maxKeyCount = argc>1 ? std::stoull(argv[1]):DefaultMaxKeyCount;
+	std::mt19937 mt(0x75u);
+
+	for (size_t keyCount=MinKeyCount; keyCount<=maxKeyCount; keyCount*=10ull)
+	{
+		std::cout << keyCount << " keys\n";
+		// the scratch is shared by all the radix sorts
+		core::vector<uint32_t> scratch(keyCount);
+		{
+			core::vector<uint32_t> keys(keyCount);
+			std::uniform_int_distribution<uint32_t> dist;
+			for (auto& key : keys)
+				key = dist(mt);
+			core::vector<uint32_t> reference = keys;
+			std::sort(reference.begin(),reference.end());
+
+			const double stdMs = measure("std::sort",keys,reference,[&](uint32_t* data) -> const uint32_t* {std::sort(data,data+keyCount); return data;});
+			printRow(keyCount,"M keys","uint32_t std::sort",stdMs,stdMs);
+			printRow(keyCount,"M keys","uint32_t std::sort(par)",measure("std::sort(par)",keys,reference,[&](uint32_t* data) -> const uint32_t*
+			{
+				std::sort(core::execution::par,data,data+keyCount);
+				return data;
+			}),stdMs);
+			printRow(keyCount,"M keys","uint32_t radix_sort",measure("radix_sort",keys,reference,[&](uint32_t* data) -> const uint32_t*
+			{
+				return core::radix_sort(data,scratch.data(),keyCount);
+			}),stdMs);
+			printRow(keyCount,"M keys","uint32_t radix_sort(par)",measure("radix_sort(par)",keys,reference,[&](uint32_t* data) -> const uint32_t*
+			{
+				return core::radix_sort(core::execution::par,data,scratch.data(),keyCount);
+			}),stdMs);
+			printRow(keyCount,"M keys","uint32_t radix_sort_in_place",measure("radix_sort_in_place",keys,reference,[&](uint32_t* data) -> const uint32_t*
+			{
+				core::radix_sort_in_place(data,keyCount);
+				return data;
+			}),stdMs);
+		}
+		{
+			core::vector<float> keys(keyCount);
+			std::normal_distribution<float> dist(0.f,1000.f);
+			for (auto& key : keys)
+				key = dist(mt);
+			core::vector<float> reference = keys;
+			std::sort(reference.begin(),reference.end());
+
+			const double stdMs = measure("std::sort",keys,reference,[&](float* data) -> const float* {std::sort(data,data+keyCount); return data;});
+			printRow(keyCount,"M keys","float std::sort",stdMs,stdMs);
+			core::vector<float> floatScratch(keyCount);
+			printRow(keyCount,"M keys","float radix_sort(par)",measure("radix_sort(par)",keys,reference,[&](float* data) -> const float*
+			{
+				return core::radix_sort(core::execution::par,data,floatScratch.data(),keyCount);
+			}),stdMs);
+		}
+		{
+			// few distinct keys, so the stability gets tested too
+			core::vector<SKeyValue> pairs(keyCount);
+			std::uniform_int_distribution<uint32_t> dist(0u,0xffffu);
+			for (uint32_t i=0u; i<keyCount; i++)
+				pairs[i] = {dist(mt),i};
+			auto byKey = [](const SKeyValue& lhs, const SKeyValue& rhs) -> bool {return lhs.key<rhs.key;};
+			core::vector<SKeyValue> reference = pairs;
+			std::stable_sort(reference.begin(),reference.end(),byKey);
+
+			const size_t repeats = core::max<size_t>(KeysPerMeasurement/keyCount,1ull);
+			double stableMs = 0.0;
+			for (size_t r=0ull; r<repeats; r++)
+			{
+				auto data = pairs;
+				stableMs += timeMs([&]() -> void {std::stable_sort(data.begin(),data.end(),byKey);});
+			}
+			stableMs /= double(repeats);
+
+			core::vector<uint32_t> keys(keyCount), values(keyCount), valueScratch(keyCount);
+			double radixMs = 0.0;
+			std::pair<uint32_t*,uint32_t*> sorted;
+			for (size_t r=0ull; r<repeats; r++)
+			{
+				for (uint32_t i=0u; i<keyCount; i++)
+				{
+					keys[i] = pairs[i].key;
+					values[i] = pairs[i].value;
+				}
+				radixMs += timeMs([&]() -> void {sorted = core::radix_sort_pairs(core::execution::par,keys.data(),scratch.data(),values.data(),valueScratch.data(),keyCount,core::impl::KeyAdaptor<uint32_t>());});
+			}
+			radixMs /= double(repeats);
+			for (uint32_t i=0u; i<keyCount; i++)
+			if (sorted.first[i]!=reference[i].key || sorted.second[i]!=reference[i].value)
+			{
+				std::cout << "radix_sort_pairs(par) sorted " << keyCount << " pairs wrong!\n";
+				passed = false;
+				break;
+			}
+			std::cout << "\tkey-value std::stable_sort: " << stableMs << "ms\n";
+			printRow(keyCount,"M keys","key-value radix_sort_pairs(par)",radixMs,stableMs);
+		}
+	}
+
+	return reportResult(passed);
+}
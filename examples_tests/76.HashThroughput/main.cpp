@@ -0,0 +1,105 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/core/xxHash256Tree.h"
+
+// Checks that core::CXXHash256 fed in random pieces gives exactly core::XXHash_256 of the whole, for every length around the loop
+// boundaries, then hashes a buffer of the first argument's megabytes (256 by default) with XXHash_256, with CXXHash256 in
+// file-read sized chunks and with core::CXXHash256Tree, and finally changes a few bytes and compares rehashing the whole tree
+// against `update`, whose result must match a tree built from scratch.
+
+using namespace nbl;
+
+constexpr size_t DefaultMegabytes = 256ull;
+constexpr size_t MaxCheckedLength = 2048ull;
+constexpr size_t ReadChunkSize = 64ull<<10;
+
+int main(int argc, char** argv)
+{
+	const size_t size = (argc>1 ? std::stoull(argv[1]):DefaultMegabytes)<<20;
+	std::mt19937_64 mt(0x76u);
+	core::vector<uint64_t> storage(size/sizeof(uint64_t)+1ull);
+	for (auto& word : storage)
+		word = mt();
+	const uint8_t* const data = reinterpret_cast<const uint8_t*>(storage.data());
+
+	bool passed = true;
+	// odd offsets so the streaming hasher can't rely on the input being aligned either
+	for (size_t offset=0ull; offset<3ull; offset++)
+	for (size_t len=0ull; len<=MaxCheckedLength; len++)
+	{
+		uint64_t expected[4], streamed[4];
+		core::XXHash_256(data+offset,len,expected);
+		core::CXXHash256 hasher(len);
+		for (size_t fed=0ull; fed<len;)
+		{
+			const size_t piece = std::min<size_t>(mt()%300ull,len-fed);
+			hasher.update(data+offset+fed,piece);
+			fed += piece;
+		}
+		if (!hasher.finalize(streamed) || memcmp(expected,streamed,sizeof(expected))!=0)
+		{
+			std::cout << "CXXHash256 differs from XXHash_256 for " << len << " bytes at offset " << offset << "!\n";
+			passed = false;
+			break;
+		}
+	}
+
+	std::cout << (size>>20) << " MB\n";
+	uint64_t oneShot[4], streamed[4];
+	const double oneShotMs = timeMs([&]() -> void {core::XXHash_256(data,size,oneShot);});
+	printRow(size,"MB","XXHash_256",oneShotMs,oneShotMs);
+	printRow(size,"MB","CXXHash256 in 64 KB chunks",timeMs([&]() -> void
+	{
+		core::CXXHash256 hasher(size);
+		for (size_t offset=0ull; offset<size; offset+=ReadChunkSize)
+			hasher.update(data+offset,std::min(ReadChunkSize,size-offset));
+		hasher.finalize(streamed);
+	}),oneShotMs);
+	if (memcmp(oneShot,streamed,sizeof(oneShot))!=0)
+	{
+		std::cout << "Streamed hash of the whole buffer differs!\n";
+		passed = false;
+	}
+	core::CXXHash256Tree tree;
+	printRow(size,"MB","CXXHash256Tree(seq)",timeMs([&]() -> void {tree.hash(core::execution::seq,data,size);}),oneShotMs);
+	const auto treeHash = tree.getHash();
+	printRow(size,"MB","CXXHash256Tree(par)",timeMs([&]() -> void {tree.hash(data,size);}),oneShotMs);
+	if (tree.getHash()!=treeHash)
+	{
+		std::cout << "Sequential and parallel tree hashes differ!\n";
+		passed = false;
+	}
+
+	// touch a few bytes in the middle
+	const size_t dirtyOffset = size/2ull+12345ull;
+	const size_t dirtySize = 100ull;
+	for (size_t i=0ull; i<dirtySize; i++)
+		reinterpret_cast<uint8_t*>(storage.data())[dirtyOffset+i]++;
+	core::CXXHash256Tree fresh;
+	const double rehashMs = timeMs([&]() -> void {fresh.hash(data,size);});
+	printRow(size,"MB","CXXHash256Tree rehash after an edit",rehashMs,rehashMs);
+	printRow(size,"MB","CXXHash256Tree::update after an edit",timeMs([&]() -> void {tree.update(data,size,dirtyOffset,dirtySize);}),rehashMs);
+	if (tree.getHash()!=fresh.getHash() || tree.getHash()==treeHash)
+	{
+		std::cout << "Incremental tree hash differs from a fresh one!\n";
+		passed = false;
+	}
+	// and shrink it
+	tree.update(data,size-dirtyOffset,0ull,0ull);
+	if (tree.getHash()!=fresh.hash(data,size-dirtyOffset))
+	{
+		std::cout << "Tree hash after shrinking the input differs from a fresh one!\n";
+		passed = false;
+	}
+
+	return reportResult(passed);
+}
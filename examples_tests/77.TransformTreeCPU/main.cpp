@@ -0,0 +1,241 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Runs scene::CTransformTreeCPUExecutor on random forests of a thousand up to the first argument's nodes (ten million by default,
+// which needs around 2.5 GB), and checks every relative transform, global transform, timestamp and normal matrix bit for bit against
+// a straight port of the relative and global transform update shaders, where every node walks up to its root on its own.
+// The global recompute gets timed for that port, sequentially and in parallel, the one-off schedule separately.
+
+using namespace nbl;
+using executor_t = scene::CTransformTreeCPUExecutor;
+using node_t = executor_t::node_t;
+
+constexpr size_t MinNodeCount = 1000ull;
+constexpr size_t DefaultMaxNodeCount = 10000000ull;
+//! the shader gives up after this many ancestors
+constexpr uint32_t MaxDepth = executor_t::MaxGPUDepth-1u;
+//! one in this many nodes starts a new tree, one in this many gets modified
+constexpr uint32_t RootFrequency = 64u;
+constexpr uint32_t ModificationFrequency = 8u;
+
+struct SNodeStorage
+{
+	SNodeStorage(const uint32_t capacity) : parents(capacity), relativeTransforms(capacity), modifiedTimestamps(capacity),
+		globalTransforms(capacity), recomputedTimestamps(capacity), normalMatrices(capacity) {}
+
+	executor_t::SNodeProperties getProperties()
+	{
+		return {parents.data(),relativeTransforms.data(),modifiedTimestamps.data(),globalTransforms.data(),recomputedTimestamps.data(),normalMatrices.data(),static_cast<uint32_t>(parents.size())};
+	}
+
+	core::vector<scene::ITransformTree::parent_t> parents;
+	core::vector<scene::ITransformTree::relative_transform_t> relativeTransforms;
+	core::vector<scene::ITransformTree::modified_stamp_t> modifiedTimestamps;
+	core::vector<scene::ITransformTree::global_transform_t> globalTransforms;
+	core::vector<scene::ITransformTree::recomputed_stamp_t> recomputedTimestamps;
+	core::vector<executor_t::normal_matrix_t> normalMatrices;
+};
+
+//! `nbl_glsl_pseudoMul4x3with4x3` one component at a time
+static core::matrix3x4SIMD referenceConcatenate(const core::matrix3x4SIMD& lhs, const core::matrix3x4SIMD& rhs)
+{
+	core::matrix3x4SIMD result;
+	for (uint32_t r=0u; r<3u; r++)
+	for (uint32_t c=0u; c<4u; c++)
+	{
+		float value = lhs.rows[r][0]*rhs.rows[0][c];
+		value += lhs.rows[r][1]*rhs.rows[1][c];
+		value += lhs.rows[r][2]*rhs.rows[2][c];
+		if (c==3u)
+			value += lhs.rows[r][3];
+		result.rows[r][c] = value;
+	}
+	return result;
+}
+
+//! `relative_transform_update.comp`
+static void referenceUpdateLocalTransforms(SNodeStorage& nodes, const core::vector<executor_t::ModificationRequestRange>& ranges, const core::vector<executor_t::RelativeTransformModificationRequest>& requests)
+{
+	for (const auto& range : ranges)
+	{
+		auto updated = nodes.relativeTransforms[range.nodeID];
+		for (auto i=range.requestsBegin; i<range.requestsEnd; i++)
+		{
+			const auto& delta = *reinterpret_cast<const core::matrix3x4SIMD*>(requests[i].data);
+			switch (requests[i].getType())
+			{
+				case executor_t::RelativeTransformModificationRequest::ET_CONCATENATE_AFTER:
+					updated = referenceConcatenate(delta,updated);
+					break;
+				case executor_t::RelativeTransformModificationRequest::ET_CONCATENATE_BEFORE:
+					updated = referenceConcatenate(updated,delta);
+					break;
+				case executor_t::RelativeTransformModificationRequest::ET_WEIGHTED_ACCUMULATE:
+					for (uint32_t r=0u; r<3u; r++)
+					for (uint32_t c=0u; c<4u; c++)
+						updated.rows[r][c] += delta.rows[r][c];
+					break;
+				default:
+					updated = delta;
+					break;
+			}
+		}
+		nodes.relativeTransforms[range.nodeID] = updated;
+		nodes.modifiedTimestamps[range.nodeID] = range.newTimestamp;
+	}
+}
+
+//! `global_transform_and_normal_matrix_update.comp` with one invocation after the other
+static void referenceRecomputeGlobalTransforms(SNodeStorage& nodes, const core::vector<node_t>& nodesToUpdate)
+{
+	auto update = [&](const node_t node, const core::matrix3x4SIMD& transform) -> void
+	{
+		nodes.globalTransforms[node] = transform;
+		nodes.recomputedTimestamps[node] = nodes.modifiedTimestamps[node];
+		nodes.normalMatrices[node] = executor_t::encodeNormalMatrix(transform);
+	};
+	for (const auto nodeID : nodesToUpdate)
+	{
+		node_t stack[MaxDepth];
+		uint32_t stackPtr = 0u;
+		node_t root = nodeID;
+		for (node_t parent=nodes.parents[root]; stackPtr<MaxDepth && parent!=scene::ITransformTree::invalid_node; parent=nodes.parents[root])
+		{
+			stack[stackPtr++] = root;
+			root = parent;
+		}
+
+		core::matrix3x4SIMD accumulated = nodes.relativeTransforms[root];
+		if (nodes.recomputedTimestamps[root]!=nodes.modifiedTimestamps[root])
+			update(root,accumulated);
+		while (stackPtr--)
+		{
+			const node_t node = stack[stackPtr];
+			if (nodes.recomputedTimestamps[node]==nodes.modifiedTimestamps[node])
+			{
+				accumulated = nodes.globalTransforms[node];
+				continue;
+			}
+			accumulated = referenceConcatenate(accumulated,nodes.relativeTransforms[node]);
+			update(node,accumulated);
+		}
+	}
+}
+
+template<typename T>
+static bool bitwiseEqual(const core::vector<T>& lhs, const core::vector<T>& rhs)
+{
+	return memcmp(lhs.data(),rhs.data(),lhs.size()*sizeof(T))==0;
+}
+
+int main(int argc, char** argv)
+{
+	const size_t maxNodeCount = argc>1 ? std::stoull(argv[1]):DefaultMaxNodeCount;
+	std::mt19937 mt(0x77u);
+	std::uniform_real_distribution<float> angle(-core::PI<float>(),core::PI<float>());
+	std::uniform_real_distribution<float> offset(-10.f,10.f);
+	std::uniform_real_distribution<float> scale(0.5f,2.f);
+	auto randomTransform = [&]() -> core::matrix3x4SIMD
+	{
+		core::matrix3x4SIMD transform;
+		transform.setRotation(core::quaternion(angle(mt),angle(mt),angle(mt)));
+		// some mirroring, so the normal matrices need the signflip
+		transform.concatenateAfter(core::matrix3x4SIMD().setScale(core::vectorSIMDf(scale(mt),scale(mt),mt()%4u ? scale(mt):-scale(mt))));
+		transform.setTranslation(core::vectorSIMDf(offset(mt),offset(mt),offset(mt)));
+		return transform;
+	};
+
+	bool passed = true;
+	for (size_t nodeCount=MinNodeCount; nodeCount<=maxNodeCount; nodeCount*=10ull)
+	{
+		std::cout << nodeCount << " nodes\n";
+		SNodeStorage initial(nodeCount);
+		{
+			// parents always come before their children, but in random places
+			core::vector<uint32_t> depths(nodeCount);
+			for (node_t node=0u; node<nodeCount; node++)
+			{
+				const node_t parent = node ? mt()%node:0u;
+				const bool isRoot = node==0u || mt()%RootFrequency==0u || depths[parent]==MaxDepth;
+				initial.parents[node] = isRoot ? scene::ITransformTree::invalid_node:parent;
+				depths[node] = isRoot ? 0u:(depths[parent]+1u);
+				initial.relativeTransforms[node] = randomTransform();
+				initial.modifiedTimestamps[node] = 1u;
+				initial.recomputedTimestamps[node] = 0u;
+			}
+		}
+
+		// modify some nodes with every kind of request, stamping them with a newer timestamp
+		core::vector<executor_t::ModificationRequestRange> ranges;
+		core::vector<executor_t::RelativeTransformModificationRequest> requests;
+		for (node_t node=0u; node<nodeCount; node++)
+		if (mt()%ModificationFrequency==0u)
+		{
+			executor_t::ModificationRequestRange range;
+			range.nodeID = node;
+			range.requestsBegin = static_cast<int32_t>(requests.size());
+			for (uint32_t i=mt()%4u; i; i--)
+			{
+				const auto type = static_cast<executor_t::RelativeTransformModificationRequest::E_TYPE>(mt()%executor_t::RelativeTransformModificationRequest::ET_COUNT);
+				requests.emplace_back(type,randomTransform(),type==executor_t::RelativeTransformModificationRequest::ET_WEIGHTED_ACCUMULATE ? 0.25f:1.f);
+			}
+			range.requestsEnd = static_cast<int32_t>(requests.size());
+			range.newTimestamp = 2u;
+			ranges.push_back(range);
+		}
+		SNodeStorage reference = initial;
+		referenceUpdateLocalTransforms(reference,ranges,requests);
+		{
+			SNodeStorage updated = initial;
+			const auto props = updated.getProperties();
+			executor_t::updateLocalTransforms(props,ranges.data(),ranges.data()+ranges.size(),requests.data());
+			if (!bitwiseEqual(updated.relativeTransforms,reference.relativeTransforms) || !bitwiseEqual(updated.modifiedTimestamps,reference.modifiedTimestamps))
+			{
+				std::cout << "Relative transforms differ from the reference!\n";
+				passed = false;
+			}
+		}
+		initial = reference;
+
+		// every node gets recomputed, so the node count is the same for all
+		core::vector<node_t> nodesToUpdate(nodeCount);
+		std::iota(nodesToUpdate.begin(),nodesToUpdate.end(),0u);
+		std::shuffle(nodesToUpdate.begin(),nodesToUpdate.end(),mt);
+		const double referenceMs = timeMs([&]() -> void {referenceRecomputeGlobalTransforms(reference,nodesToUpdate);});
+		printRow(nodeCount,"M nodes","per node walk to the root",referenceMs,referenceMs);
+
+		executor_t executor;
+		SNodeStorage nodes = initial;
+		auto props = nodes.getProperties();
+		std::cout << "\tschedule: " << timeMs([&]() -> void {executor.schedule(props,nodesToUpdate.data(),nodesToUpdate.data()+nodeCount);}) << "ms, "
+			<< executor.getLevelCount() << " levels\n";
+		auto check = [&](const char* name) -> void
+		{
+			if (!bitwiseEqual(nodes.globalTransforms,reference.globalTransforms) || !bitwiseEqual(nodes.recomputedTimestamps,reference.recomputedTimestamps) ||
+				!bitwiseEqual(nodes.normalMatrices,reference.normalMatrices))
+			{
+				std::cout << name << " differs from the reference!\n";
+				passed = false;
+			}
+		};
+		printRow(nodeCount,"M nodes","CTransformTreeCPUExecutor(seq)",timeMs([&]() -> void {executor.recomputeGlobalTransforms(core::execution::seq,props);}),referenceMs);
+		check("CTransformTreeCPUExecutor(seq)");
+		nodes = initial;
+		props = nodes.getProperties();
+		printRow(nodeCount,"M nodes","CTransformTreeCPUExecutor(par)",timeMs([&]() -> void {executor.recomputeGlobalTransforms(props);}),referenceMs);
+		check("CTransformTreeCPUExecutor(par)");
+		// nothing is out of date now
+		printRow(nodeCount,"M nodes","CTransformTreeCPUExecutor(par) again",timeMs([&]() -> void {executor.recomputeGlobalTransforms(props);}),referenceMs);
+		check("CTransformTreeCPUExecutor(par) again");
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,297 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Runs scene::CCullingLoDSelectionCPUExecutor over a thousand up to the first argument's instances (a million by default) scattered
+// around a camera, using a host built LoD library with the distance based LoD choice of example 11, and checks the draw indirect
+// commands, per view per instance data and instance redirects against a scalar port of the culling and LoD selection shaders
+// running one instance and one drawcall after the other. The reference assigns instance IDs in the executor's deterministic order.
+// Lastly the redirect buffer gets only half the room it needs, the draws must be clamped to what fits instead of overrunning it.
+
+using namespace nbl;
+using lod_library_t = scene::CLevelOfDetailLibrary<>;
+
+constexpr size_t MinInstanceCount = 1000ull;
+constexpr size_t DefaultMaxInstanceCount = 1000000ull;
+constexpr uint32_t LoDTableCount = 32u;
+constexpr uint32_t MaxLoDCount = 4u;
+constexpr uint32_t MaxDrawcallsPerLoD = 6u;
+constexpr float SceneExtent = 400.f;
+
+struct PerViewPerInstance
+{
+	core::matrix4SIMD mvp;
+	float distanceSq;
+	uint32_t lod;
+};
+using executor_t = scene::CCullingLoDSelectionCPUExecutor<PerViewPerInstance>;
+
+//! the host side buffers of an `ILevelOfDetailLibrary` and the draw indirect buffer its drawcalls point into
+struct SHostLoDLibrary
+{
+	struct alignas(16) SUvec4
+	{
+		uint32_t data[4];
+	};
+
+	SHostLoDLibrary(std::mt19937& mt)
+	{
+		std::uniform_real_distribution<float> extent(0.1f,1.f);
+		std::uniform_real_distribution<float> center(-1.f,1.f);
+		for (uint32_t t=0u; t<LoDTableCount; t++)
+		{
+			const uint32_t levelCount = mt()%MaxLoDCount+1u;
+			tableOffsets.push_back(static_cast<uint32_t>(tables.size()));
+			tables.resize(tables.size()+lod_library_t::LoDTableInfo::getSizeInAlignmentUnits(levelCount));
+			auto* table = new (&tables[tableOffsets.back()]) lod_library_t::LoDTableInfo(levelCount,core::aabbox3df(-2.f,-2.f,-2.f,2.f,2.f,2.f));
+			for (uint32_t l=0u; l<levelCount; l++)
+			{
+				// every next level is meant for a smaller distance
+				const float distance = SceneExtent*0.5f/float(l+1u);
+				const uint32_t drawcallCount = mt()%MaxDrawcallsPerLoD+1u;
+				table->leveInfoUvec2Offsets[l] = static_cast<uint32_t>(lods.size());
+				lods.resize(lods.size()+lod_library_t::LoDInfo::getSizeInAlignmentUnits(drawcallCount));
+				auto* lod = new (&lods[table->leveInfoUvec2Offsets[l]]) lod_library_t::LoDInfo(drawcallCount,{distance*distance});
+				for (uint32_t d=0u; d<drawcallCount; d++)
+				{
+					core::vectorSIMDf c(center(mt),center(mt),center(mt));
+					core::vectorSIMDf e(extent(mt),extent(mt),extent(mt));
+					const core::aabbox3df aabb(core::vector3df(c.x-e.x,c.y-e.y,c.z-e.z),core::vector3df(c.x+e.x,c.y+e.y,c.z+e.z));
+					// every drawcall gets its own draw, indexed ones are 5 DWORDs long
+					const bool indexed = mt()%2u;
+					const uint32_t dwordOffset = static_cast<uint32_t>(drawCalls.size());
+					drawCalls.resize(dwordOffset+(indexed ? 5u:4u),0u);
+					drawCalls[dwordOffset] = 36u;
+					drawcallsToScan.push_back(indexed ? dwordOffset:(dwordOffset|0x80000000u));
+					new (lod->drawcallInfos+d) lod_library_t::DrawcallInfo(drawcallsToScan.back(),aabb);
+				}
+			}
+		}
+	}
+
+	executor_t::SLoDLibrary get() const
+	{
+		return {tables.data(),lods.data()};
+	}
+
+	core::vector<SUvec4> tables;
+	core::vector<uint64_t> lods;
+	core::vector<uint32_t> tableOffsets;
+	core::vector<uint32_t> drawcallsToScan;
+	core::vector<uint32_t> drawCalls;
+};
+
+//! the overrides of example 11, keeping the distance in the per view per instance data instead of a global
+struct SCallbacks
+{
+	void initializePerViewPerInstanceData(PerViewPerInstance& pvpi, const uint32_t instanceGUID) const
+	{
+		const auto& world = worlds[instanceGUID];
+		const core::vectorSIMDf toCam = camPos-world.getTranslation();
+		pvpi.distanceSq = core::dot(toCam,toCam).x;
+		pvpi.mvp = core::concatenateBFollowedByA(viewProj,core::matrix4SIMD(world));
+	}
+	uint32_t chooseLoD(PerViewPerInstance& pvpi, const uint32_t instanceGUID, const uint32_t lodTableUvec4Offset, const uint32_t lodCount) const
+	{
+		return executor_t::chooseDefaultLoD(library,lodTableUvec4Offset,pvpi.distanceSq,fovDilationFactor,&pvpi.lod);
+	}
+	void finalizePerViewPerInstanceData(PerViewPerInstance& pvpi, const uint32_t instanceGUID, const uint32_t lodInfoUvec2Offset) const
+	{
+	}
+
+	const core::vector<core::matrix3x4SIMD>& worlds;
+	executor_t::SLoDLibrary library;
+	core::vectorSIMDf camPos;
+	core::matrix4SIMD viewProj;
+	float fovDilationFactor;
+};
+
+//! `nbl_glsl_fastestFrustumCullAABB` one plane and component at a time
+static bool referenceCulled(const core::matrix4SIMD& mvp, const core::aabbox3df& aabb)
+{
+	const float ndcMin[3] = {-1.f,-1.f,0.f};
+	for (uint32_t i=0u; i<3u; i++)
+	for (uint32_t side=0u; side<2u; side++)
+	{
+		float plane[4];
+		for (uint32_t c=0u; c<4u; c++)
+			plane[c] = side ? (mvp.rows[3][c]*1.f-mvp.rows[i][c]):(mvp.rows[i][c]-mvp.rows[3][c]*ndcMin[i]);
+		float dp = (plane[0]<0.f ? aabb.MinEdge.X:aabb.MaxEdge.X)*plane[0];
+		dp += (plane[1]<0.f ? aabb.MinEdge.Y:aabb.MaxEdge.Y)*plane[1];
+		dp += (plane[2]<0.f ? aabb.MinEdge.Z:aabb.MaxEdge.Z)*plane[2];
+		if (dp+plane[3]<=0.f)
+			return true;
+	}
+	return false;
+}
+
+//! `instance_cull_and_lod_select.comp`, `instance_draw_cull.comp`, `draw_instance_count_scan_and_scatter.comp` with one invocation after the other
+static uint32_t referenceProcess(const executor_t::SParams& params, SCallbacks& callbacks, core::vector<executor_t::PotentiallyVisibleInstance>& pvsInstances)
+{
+	pvsInstances.clear();
+	for (uint32_t instanceID=0u; instanceID<params.instanceCount; instanceID++)
+	{
+		const auto& instance = params.instances[instanceID];
+		PerViewPerInstance pvpi;
+		callbacks.initializePerViewPerInstanceData(pvpi,instance.instanceGUID);
+		const auto& table = params.lodLibrary.getTable(instance.lodTableUvec4Offset);
+		const core::aabbox3df aabb(table.aabbMin[0],table.aabbMin[1],table.aabbMin[2],table.aabbMax[0],table.aabbMax[1],table.aabbMax[2]);
+		if (referenceCulled(pvpi.mvp,aabb))
+			continue;
+		const uint32_t lodInfoUvec2Offset = callbacks.chooseLoD(pvpi,instance.instanceGUID,instance.lodTableUvec4Offset,table.levelCount);
+		if (lodInfoUvec2Offset==executor_t::invalid)
+			continue;
+		callbacks.finalizePerViewPerInstanceData(pvpi,instance.instanceGUID,lodInfoUvec2Offset);
+		params.perViewPerInstance[pvsInstances.size()] = pvpi;
+		pvsInstances.push_back({instance.instanceGUID,lodInfoUvec2Offset});
+	}
+
+	for (uint32_t i=0u; i<params.drawcallCount; i++)
+		params.drawCalls[(params.drawcallsToScan[i]&0x7fffffffu)+1u] = 0u;
+	core::vector<executor_t::PotentiallyVisibleInstanceDraw> draws;
+	for (uint32_t pvInstanceID=0u; pvInstanceID<pvsInstances.size(); pvInstanceID++)
+	{
+		const auto& lod = params.lodLibrary.getLoD(pvsInstances[pvInstanceID].lodInfoUvec2Offset);
+		for (uint32_t d=0u; d<lod.drawcallInfoCount; d++)
+		{
+			if (referenceCulled(params.perViewPerInstance[pvInstanceID].mvp,lod.drawcallInfos[d].getAABB().decompress()))
+				continue;
+			const uint32_t dwordOffsetAndFlag = lod.drawcallInfos[d].getDrawcallDWORDOffset();
+			const uint32_t dwordOffset = dwordOffsetAndFlag&0x7fffffffu;
+			draws.push_back({pvInstanceID,dwordOffset+4u-(dwordOffsetAndFlag>>31u),params.drawCalls[dwordOffset+1u]++});
+		}
+	}
+
+	uint32_t baseInstance = 0u;
+	for (uint32_t i=0u; i<params.drawcallCount; i++)
+	{
+		const uint32_t dwordOffset = params.drawcallsToScan[i]&0x7fffffffu;
+		params.drawCalls[dwordOffset+4u-(params.drawcallsToScan[i]>>31u)] = baseInstance;
+		baseInstance += params.drawCalls[dwordOffset+1u];
+	}
+	for (const auto& draw : draws)
+		params.perInstanceRedirectAttribs[params.drawCalls[draw.drawBaseInstanceDWORDOffset]+draw.instanceID] = {pvsInstances[draw.perViewPerInstanceID].instanceGUID,draw.perViewPerInstanceID};
+	return static_cast<uint32_t>(draws.size());
+}
+
+struct SOutputs
+{
+	SOutputs(const SHostLoDLibrary& library, const size_t instanceCount) : drawCalls(library.drawCalls), perViewPerInstance(instanceCount),
+		redirects(instanceCount*MaxDrawcallsPerLoD) {}
+
+	void fill(executor_t::SParams& params)
+	{
+		params.drawCalls = drawCalls.data();
+		params.perViewPerInstance = perViewPerInstance.data();
+		params.perInstanceRedirectAttribs = redirects.data();
+		params.maxTotalVisibleDrawcallInstances = static_cast<uint32_t>(redirects.size());
+	}
+
+	core::vector<uint32_t> drawCalls;
+	core::vector<PerViewPerInstance> perViewPerInstance;
+	core::vector<executor_t::InstanceRedirect> redirects;
+};
+
+static bool equal(const SOutputs& lhs, const SOutputs& rhs, const uint32_t pvsInstanceCount, const uint32_t drawInstanceCount)
+{
+	if (lhs.drawCalls!=rhs.drawCalls)
+		return false;
+	for (uint32_t i=0u; i<pvsInstanceCount; i++)
+	{
+		const auto& a = lhs.perViewPerInstance[i];
+		const auto& b = rhs.perViewPerInstance[i];
+		if (memcmp(&a.mvp,&b.mvp,sizeof(a.mvp))!=0 || core::IR(a.distanceSq)!=core::IR(b.distanceSq) || a.lod!=b.lod)
+			return false;
+	}
+	return memcmp(lhs.redirects.data(),rhs.redirects.data(),sizeof(executor_t::InstanceRedirect)*drawInstanceCount)==0;
+}
+
+int main(int argc, char** argv)
+{
+	const size_t maxInstanceCount = argc>1 ? std::stoull(argv[1]):DefaultMaxInstanceCount;
+	std::mt19937 mt(0x78u);
+	const SHostLoDLibrary library(mt);
+
+	const auto proj = core::matrix4SIMD::buildProjectionMatrixPerspectiveFovRH(core::radians(60.f),16.f/9.f,0.1f,SceneExtent);
+	const core::vectorSIMDf camPos(0.f,0.f,0.f);
+	const auto view = core::matrix3x4SIMD::buildCameraLookAtMatrixRH(camPos,core::vectorSIMDf(0.f,0.f,-1.f),core::vectorSIMDf(0.f,1.f,0.f));
+
+	bool passed = true;
+	for (size_t instanceCount=MinInstanceCount; instanceCount<=maxInstanceCount; instanceCount*=10ull)
+	{
+		std::cout << instanceCount << " instances\n";
+		std::uniform_real_distribution<float> position(-SceneExtent,SceneExtent);
+		std::uniform_real_distribution<float> scale(0.5f,4.f);
+		core::vector<core::matrix3x4SIMD> worlds(instanceCount);
+		core::vector<executor_t::InstanceToCull> instances(instanceCount);
+		for (uint32_t i=0u; i<instanceCount; i++)
+		{
+			worlds[i].setScale(core::vectorSIMDf(scale(mt)));
+			worlds[i].setTranslation(core::vectorSIMDf(position(mt),position(mt),position(mt)));
+			instances[i] = {i,library.tableOffsets[mt()%LoDTableCount]};
+		}
+		SCallbacks callbacks = {worlds,library.get(),camPos,core::concatenateBFollowedByA(proj,core::matrix4SIMD(view)),lod_library_t::DefaultLoDChoiceParams::getFoVDilationFactor(proj)};
+
+		executor_t::SParams params;
+		params.lodLibrary = library.get();
+		params.instances = instances.data();
+		params.instanceCount = static_cast<uint32_t>(instanceCount);
+		params.drawcallsToScan = library.drawcallsToScan.data();
+		params.drawcallCount = static_cast<uint32_t>(library.drawcallsToScan.size());
+
+		SOutputs reference(library,instanceCount);
+		reference.fill(params);
+		core::vector<executor_t::PotentiallyVisibleInstance> pvsInstances;
+		uint32_t drawInstanceCount;
+		const double referenceMs = timeMs([&]() -> void {drawInstanceCount=referenceProcess(params,callbacks,pvsInstances);});
+		std::cout << "\t" << pvsInstances.size() << " potentially visible instances, " << drawInstanceCount << " visible drawcall instances\n";
+		printRow(instanceCount,"M instances","one invocation after the other",referenceMs,referenceMs);
+
+		executor_t executor;
+		auto run = [&](const char* name, auto&& policy) -> void
+		{
+			SOutputs outputs(library,instanceCount);
+			outputs.fill(params);
+			uint32_t count;
+			printRow(instanceCount,"M instances",name,timeMs([&]() -> void {count=executor.processInstancesAndFillIndirectDraws(policy,params,callbacks);}),referenceMs);
+			const auto& executorPVS = executor.getPotentiallyVisibleInstances();
+			const bool samePVS = executorPVS.size()==pvsInstances.size() && memcmp(executorPVS.data(),pvsInstances.data(),sizeof(executor_t::PotentiallyVisibleInstance)*pvsInstances.size())==0;
+			if (count!=drawInstanceCount || !samePVS || !equal(outputs,reference,static_cast<uint32_t>(pvsInstances.size()),drawInstanceCount))
+			{
+				std::cout << name << " differs from the reference!\n";
+				passed = false;
+			}
+		};
+		// the first run allocates the scratch memory
+		run("CCullingLoDSelectionCPUExecutor(seq) first",core::execution::seq);
+		run("CCullingLoDSelectionCPUExecutor(seq)",core::execution::seq);
+		run("CCullingLoDSelectionCPUExecutor(par)",core::execution::par_unseq);
+
+		// a redirect buffer too small for all of them must not get written past, the draws get clamped to what fits
+		if (drawInstanceCount>1u)
+		{
+			SOutputs outputs(library,instanceCount);
+			outputs.redirects.resize(drawInstanceCount/2u);
+			outputs.redirects.shrink_to_fit();
+			outputs.fill(params);
+			const uint32_t count = executor.processInstancesAndFillIndirectDraws(params,callbacks);
+			uint32_t drawnInstanceCount = 0u;
+			for (uint32_t i=0u; i<params.drawcallCount; i++)
+				drawnInstanceCount += params.drawCalls[(params.drawcallsToScan[i]&0x7fffffffu)+1u];
+			if (count!=params.maxTotalVisibleDrawcallInstances || drawnInstanceCount!=count)
+			{
+				std::cout << "Overflowing the redirects wrote " << count << " and drew " << drawnInstanceCount << " instead of " << params.maxTotalVisibleDrawcallInstances << "!\n";
+				passed = false;
+			}
+		}
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,223 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <sstream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Encodes a render-like RGBA image of the first two arguments' size (4K by default) with asset::CPNGEncoder, as a single stripe
+// like a single threaded encoder would, then in stripes sequentially and in parallel, the two must give the same bytes.
+// Every filter and a few compression levels get written through the IAssetManager and loaded back, the pixels must survive.
+// Lastly the third argument's number of images (8 by default) get written one after the other and with `writeBatch`.
+
+using namespace nbl;
+
+constexpr uint32_t DefaultWidth = 3840u;
+constexpr uint32_t DefaultHeight = 2160u;
+constexpr uint32_t DefaultBatchSize = 8u;
+
+//! the encoded size next to the raw one, appended to a row
+static std::string encodedSize(const size_t size, const size_t rawSize)
+{
+	std::ostringstream str;
+	str << ", " << size/1024ull << "KiB (" << 100.0*double(size)/double(rawSize) << "%)";
+	return str.str();
+}
+
+static core::smart_refctd_ptr<system::IFile> createFile(system::ISystem* system, const std::filesystem::path& path)
+{
+	std::filesystem::remove(path);
+	system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+	system->createFile(future,path,system::IFile::ECF_WRITE);
+	return future.get();
+}
+
+//! smooth gradients with a bit of noise and some flat areas, roughly what a screenshot compresses like
+static core::smart_refctd_ptr<asset::ICPUImageView> createImage(const uint32_t width, const uint32_t height, const uint32_t seed)
+{
+	const size_t rowSize = size_t(width)*4ull;
+	auto buffer = core::make_smart_refctd_ptr<asset::ICPUBuffer>(rowSize*height);
+	auto* texels = reinterpret_cast<uint8_t*>(buffer->getPointer());
+	std::mt19937 mt(seed);
+	for (uint32_t y=0u; y<height; y++)
+	for (uint32_t x=0u; x<width; x++)
+	{
+		uint8_t* texel = texels+y*rowSize+x*4u;
+		const bool flat = ((x/256u)+(y/256u))%3u==0u;
+		texel[0] = flat ? 32u:uint8_t((x*255u)/width+mt()%4u);
+		texel[1] = flat ? 64u:uint8_t((y*255u)/height+mt()%4u);
+		texel[2] = flat ? 96u:uint8_t(((x+y)*127u)/(width+height)+mt()%8u);
+		texel[3] = 255u;
+	}
+
+	asset::ICPUImage::SCreationParams imageParams = {};
+	imageParams.flags = static_cast<asset::IImage::E_CREATE_FLAGS>(0u);
+	imageParams.type = asset::IImage::ET_2D;
+	imageParams.format = asset::EF_R8G8B8A8_SRGB;
+	imageParams.extent = {width,height,1u};
+	imageParams.mipLevels = 1u;
+	imageParams.arrayLayers = 1u;
+	imageParams.samples = asset::IImage::ESCF_1_BIT;
+	auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<asset::ICPUImage::SBufferCopy>>(1ull);
+	auto& region = regions->front();
+	region.bufferOffset = 0ull;
+	region.bufferRowLength = width;
+	region.bufferImageHeight = 0u;
+	region.imageSubresource = {};
+	region.imageSubresource.layerCount = 1u;
+	region.imageOffset = {0,0,0};
+	region.imageExtent = {width,height,1u};
+	auto image = asset::ICPUImage::create(std::move(imageParams));
+	image->setBufferAndRegions(std::move(buffer),regions);
+
+	asset::ICPUImageView::SCreationParams viewParams = {};
+	viewParams.flags = static_cast<asset::ICPUImageView::E_CREATE_FLAGS>(0u);
+	viewParams.image = std::move(image);
+	viewParams.format = asset::EF_R8G8B8A8_SRGB;
+	viewParams.viewType = asset::IImageView<asset::ICPUImage>::ET_2D;
+	viewParams.subresourceRange.layerCount = 1u;
+	viewParams.subresourceRange.levelCount = 1u;
+	return asset::ICPUImageView::create(std::move(viewParams));
+}
+
+//! compares the texels of the view with the ones of the loaded image, row by row
+static bool sameTexels(const asset::ICPUImageView* original, const asset::ICPUImage* loaded)
+{
+	const auto* image = original->getCreationParameters().image.get();
+	const auto& params = image->getCreationParameters();
+	const auto& loadedParams = loaded->getCreationParameters();
+	if (loadedParams.format!=params.format || loadedParams.extent.width!=params.extent.width || loadedParams.extent.height!=params.extent.height)
+		return false;
+
+	const auto& region = *image->getRegions().begin();
+	const auto& loadedRegion = *loaded->getRegions().begin();
+	const size_t rowSize = size_t(params.extent.width)*4ull;
+	const auto* texels = reinterpret_cast<const uint8_t*>(image->getBuffer()->getPointer())+region.bufferOffset;
+	const auto* loadedTexels = reinterpret_cast<const uint8_t*>(loaded->getBuffer()->getPointer())+loadedRegion.bufferOffset;
+	for (uint32_t y=0u; y<params.extent.height; y++)
+	if (memcmp(texels+y*region.bufferRowLength*4ull,loadedTexels+y*loadedRegion.bufferRowLength*4ull,rowSize)!=0)
+		return false;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t width = argc>1 ? std::stoul(argv[1]):DefaultWidth;
+	const uint32_t height = argc>2 ? std::stoul(argv[2]):DefaultHeight;
+	const uint32_t batchSize = argc>3 ? std::stoul(argv[3]):DefaultBatchSize;
+
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_png_encoder";
+	std::filesystem::create_directories(directory);
+
+	bool passed = true;
+	const auto imageView = createImage(width,height,0x79u);
+	const auto converted = asset::CPNGEncoder::convertForWriting(imageView.get(),nullptr);
+	const auto image = asset::CPNGEncoder::getImage(converted.get());
+	const size_t rawSize = size_t(width)*height*4ull;
+	std::cout << width << "x" << height << " RGBA\n";
+
+	asset::CPNGEncoder encoder;
+	{
+		asset::CPNGEncoder::SParams singleStripe;
+		singleStripe.stripeSize = 0u;
+		core::vector<uint8_t> baseline,striped,parallel;
+		const double baselineMs = timeMs([&]() -> void {passed = encoder.encode(core::execution::seq,image,singleStripe,baseline) && passed;});
+		printRow(rawSize,"MB","one stripe",baselineMs,baselineMs,encodedSize(baseline.size(),rawSize));
+		const asset::CPNGEncoder::SParams defaults;
+		const double stripedMs = timeMs([&]() -> void {passed = encoder.encode(core::execution::seq,image,defaults,striped) && passed;});
+		printRow(rawSize,"MB","stripes(seq)",stripedMs,baselineMs,encodedSize(striped.size(),rawSize));
+		const double parallelMs = timeMs([&]() -> void {passed = encoder.encode(image,defaults,parallel) && passed;});
+		printRow(rawSize,"MB","stripes(par)",parallelMs,baselineMs,encodedSize(parallel.size(),rawSize));
+		if (striped!=parallel)
+		{
+			std::cout << "The parallel encoding differs from the sequential one!\n";
+			passed = false;
+		}
+
+		asset::CPNGEncoder::SParams fastest;
+		fastest.compressionLevel = 1;
+		fastest.filter = asset::CPNGEncoder::EF_UP;
+		fastest.strategy = asset::CPNGEncoder::ES_RLE;
+		core::vector<uint8_t> fast;
+		const double fastMs = timeMs([&]() -> void {passed = encoder.encode(image,fastest,fast) && passed;});
+		printRow(rawSize,"MB","level 1, up filter, RLE(par)",fastMs,baselineMs,encodedSize(fast.size(),rawSize));
+	}
+
+	// round trips through the asset manager, with the level coming from the asset compression level
+	for (uint8_t filter=asset::CPNGEncoder::EF_NONE; filter<=asset::CPNGEncoder::EF_ADAPTIVE; filter++)
+	for (const float compressionLevel : {0.f,0.5f,1.f})
+	{
+		asset::CPNGEncoder::SParams params;
+		params.filter = static_cast<asset::CPNGEncoder::E_FILTER>(filter);
+		const auto path = directory/("filter"+std::to_string(filter)+"_level"+std::to_string(compressionLevel)+".png");
+		std::filesystem::remove(path);
+		const asset::IAssetWriter::SAssetWriteParams writeParams(imageView.get(),asset::EWF_COMPRESSED,compressionLevel,0ull,nullptr,&params);
+		if (!assetManager->writeAsset(path.string(),writeParams))
+		{
+			std::cout << "Writing " << path << " failed!\n";
+			passed = false;
+			continue;
+		}
+		const asset::IAssetLoader::SAssetLoadParams loadParams(0ull,nullptr,asset::IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL);
+		const auto bundle = assetManager->getAsset(path.string(),loadParams);
+		const auto contents = bundle.getContents();
+		if (contents.empty() || !sameTexels(imageView.get(),static_cast<const asset::ICPUImage*>(contents.begin()->get())))
+		{
+			std::cout << path << " did not load back the same!\n";
+			passed = false;
+		}
+	}
+
+	// the batch overlaps the encoding of every image with the write of the previous one
+	{
+		core::vector<core::smart_refctd_ptr<asset::ICPUImageView>> views(batchSize);
+		for (uint32_t i=0u; i<batchSize; i++)
+			views[i] = createImage(width,height,i);
+		auto path = [&](const char* prefix, const uint32_t i) -> std::filesystem::path {return directory/(prefix+std::to_string(i)+".png");};
+
+		const double oneByOneMs = timeMs([&]() -> void
+		{
+			for (uint32_t i=0u; i<batchSize; i++)
+			{
+				const auto file = createFile(system.get(),path("single",i));
+				passed = file && assetManager->writeAsset(file.get(),asset::IAssetWriter::SAssetWriteParams(views[i].get())) && passed;
+			}
+		});
+		std::cout << batchSize << " images\n";
+		printRow(rawSize*batchSize,"MB","IAssetManager::writeAsset one by one",oneByOneMs,oneByOneMs);
+
+		core::vector<core::smart_refctd_ptr<system::IFile>> files(batchSize);
+		core::vector<asset::CPNGEncoder::SBatchItem> items(batchSize);
+		for (uint32_t i=0u; i<batchSize; i++)
+		{
+			files[i] = createFile(system.get(),path("batch",i));
+			items[i].file = files[i].get();
+			items[i].imageView = views[i].get();
+		}
+		uint32_t written;
+		const double batchMs = timeMs([&]() -> void {written = encoder.writeBatch(items.data(),items.data()+batchSize,{});});
+		printRow(rawSize*batchSize,"MB","CPNGEncoder::writeBatch",batchMs,oneByOneMs);
+		files.clear();
+		if (written!=batchSize)
+		{
+			std::cout << "Only " << written << " of the batch got written!\n";
+			passed = false;
+		}
+		for (uint32_t i=0u; i<batchSize; i++)
+		if (std::filesystem::file_size(path("single",i))!=std::filesystem::file_size(path("batch",i)))
+		{
+			std::cout << "Image " << i << " of the batch differs from the one written on its own!\n";
+			passed = false;
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+	return reportResult(passed);
+}
@@ -0,0 +1,189 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Round trip of asset::CGLTFWriter and asset::CGLTFLoader, a mesh of a few IGeometryCreator shapes gets written as .gltf+.bin and as .glb,
+// the sphere is there three times, once more with the same buffers and once more with copies of them, so both must only be written once.
+// Both files get loaded back and every triangle must have the same positions, the loaded mesh then gets written again with the loader's
+// attribute layout. The binary STL and PLY writers of the same mesh are timed next to it for reference.
+
+using namespace nbl;
+
+constexpr uint32_t DefaultTesselation = 512u;
+
+static void printWriteRow(const char* name, const double ms, const size_t size, const size_t rawSize)
+{
+	std::cout << "\t" << name << ": " << ms << "ms, " << size/1024ull << "KiB (" << 100.0*double(size)/double(rawSize) << "% of the bound buffers), "
+		<< double(size)/(ms*1000.0) << "MB/s\n";
+}
+
+static core::smart_refctd_ptr<asset::ICPUMeshBuffer> createMeshBuffer(asset::IGeometryCreator::return_type&& geometry)
+{
+	// the writers only need the vertex input and primitive assembly parameters
+	auto pipeline = core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(
+		nullptr,nullptr,nullptr,geometry.inputParams,asset::SBlendParams(),geometry.assemblyParams,asset::SRasterizationParams()
+	);
+	auto meshbuffer = core::make_smart_refctd_ptr<asset::ICPUMeshBuffer>(std::move(pipeline),nullptr,geometry.bindings,std::move(geometry.indexBuffer));
+	meshbuffer->setIndexCount(geometry.indexCount);
+	meshbuffer->setIndexType(geometry.indexType);
+	meshbuffer->setBoundingBox(geometry.bbox);
+	return meshbuffer;
+}
+
+static core::smart_refctd_ptr<asset::ICPUMesh> createMesh(const asset::IGeometryCreator* creator, const uint32_t tesselation, size_t& outRawSize)
+{
+	auto mesh = core::make_smart_refctd_ptr<asset::ICPUMesh>();
+	auto& meshbuffers = mesh->getMeshBufferVector();
+	auto sphere = creator->createSphereMesh(1.f,tesselation,tesselation);
+	auto sphereCopy = sphere;
+	// same contents, different buffers
+	for (auto* binding : {&sphereCopy.indexBuffer,sphereCopy.bindings+0u})
+	if (binding->buffer)
+		binding->buffer = core::smart_refctd_ptr_static_cast<asset::ICPUBuffer>(binding->buffer->clone(0u));
+	auto sphereAgain = sphere;
+	meshbuffers.push_back(createMeshBuffer(std::move(sphere)));
+	meshbuffers.push_back(createMeshBuffer(std::move(sphereAgain)));
+	meshbuffers.push_back(createMeshBuffer(std::move(sphereCopy)));
+	meshbuffers.push_back(createMeshBuffer(creator->createCubeMesh(core::vector3df(2.f,2.f,2.f))));
+	meshbuffers.push_back(createMeshBuffer(creator->createCylinderMesh(0.5f,2.f,tesselation)));
+
+	outRawSize = 0ull;
+	for (const auto& meshbuffer : meshbuffers)
+	{
+		outRawSize += meshbuffer->getIndexBufferBinding().buffer->getSize();
+		for (uint32_t i=0u; i<asset::ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+		if (meshbuffer->isVertexAttribBufferBindingEnabled(i))
+			outRawSize += meshbuffer->getVertexBufferBindings()[i].buffer->getSize();
+	}
+	return mesh;
+}
+
+//! every triangle of every meshbuffer has to have the same positions
+static bool samePositions(const asset::ICPUMesh* original, const asset::ICPUMesh* loaded)
+{
+	const auto meshbuffers = original->getMeshBuffers();
+	const auto loadedMeshbuffers = loaded->getMeshBuffers();
+	if (meshbuffers.size()!=loadedMeshbuffers.size())
+		return false;
+	for (auto i=0u; i<meshbuffers.size(); i++)
+	{
+		const auto* meshbuffer = meshbuffers.begin()[i];
+		const auto* loadedMeshbuffer = loadedMeshbuffers.begin()[i];
+		if (meshbuffer->getIndexCount()!=loadedMeshbuffer->getIndexCount())
+			return false;
+		for (uint32_t j=0u; j<meshbuffer->getIndexCount(); j++)
+		{
+			const auto difference = meshbuffer->getPosition(meshbuffer->getIndexValue(j))-loadedMeshbuffer->getPosition(loadedMeshbuffer->getIndexValue(j));
+			if (core::length(difference).x>0.0001f)
+				return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t tesselation = argc>1 ? std::stoul(argv[1]):DefaultTesselation;
+
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+	const auto directory = std::filesystem::temp_directory_path()/"nbl_gltf_writer";
+	std::filesystem::create_directories(directory);
+
+	bool passed = true;
+	size_t rawSize;
+	const auto mesh = createMesh(assetManager->getGeometryCreator(),tesselation,rawSize);
+	std::cout << "Writing " << mesh->getMeshBuffers().size() << " meshbuffers with " << rawSize/1024ull << "KiB of bound buffers\n";
+
+	auto write = [&](const asset::ICPUMesh* asset, const char* name, const std::filesystem::path& path, const asset::E_WRITER_FLAGS flags, void* userData=nullptr) -> bool
+	{
+		std::filesystem::remove(path);
+		bool success;
+		const double ms = timeMs([&]() -> void {success = assetManager->writeAsset(path.string(),asset::IAssetWriter::SAssetWriteParams(const_cast<asset::ICPUMesh*>(asset),flags,0.f,0ull,nullptr,userData));});
+		if (!success || !std::filesystem::exists(path))
+		{
+			std::cout << "Writing " << path << " failed!\n";
+			return false;
+		}
+		auto size = std::filesystem::file_size(path);
+		auto binPath = path;
+		binPath.replace_extension(".bin");
+		if (path.extension()==".gltf" && std::filesystem::exists(binPath))
+			size += std::filesystem::file_size(binPath);
+		printWriteRow(name,ms,size,rawSize);
+		return true;
+	};
+	auto load = [&](const char* name, const std::filesystem::path& path) -> core::smart_refctd_ptr<asset::ICPUMesh>
+	{
+		core::smart_refctd_ptr<asset::ICPUMesh> loaded;
+		const double ms = timeMs([&]() -> void
+		{
+			const asset::IAssetLoader::SAssetLoadParams loadParams(0ull,nullptr,asset::IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL);
+			const auto bundle = assetManager->getAsset(path.string(),loadParams);
+			const auto contents = bundle.getContents();
+			if (!contents.empty() && contents.begin()->get()->getAssetType()==asset::IAsset::ET_MESH)
+				loaded = core::smart_refctd_ptr_static_cast<asset::ICPUMesh>(*contents.begin());
+		});
+		if (!loaded)
+			std::cout << "Loading " << path << " failed!\n";
+		else
+			std::cout << "\t" << name << ": " << ms << "ms\n";
+		return loaded;
+	};
+
+	const auto gltfPath = directory/"shapes.gltf";
+	const auto glbPath = directory/"shapes.glb";
+	passed = write(mesh.get(),"glTF+BIN",gltfPath,asset::EWF_NONE) && passed;
+	passed = write(mesh.get(),"GLB",glbPath,asset::EWF_BINARY) && passed;
+	passed = write(mesh.get(),"binary PLY",directory/"shapes.ply",asset::EWF_BINARY) && passed;
+	passed = write(mesh.get(),"binary STL",directory/"shapes.stl",asset::EWF_BINARY) && passed;
+	// the two extra spheres must not have been written again
+	if (std::filesystem::exists(glbPath) && std::filesystem::file_size(glbPath)>=rawSize)
+	{
+		std::cout << "The GLB is not smaller than the bound buffers, the views did not get deduplicated!\n";
+		passed = false;
+	}
+
+	std::cout << "Loading back\n";
+	for (const auto& path : {gltfPath,glbPath})
+	{
+		const auto loaded = load(path.filename().string().c_str(),path);
+		if (!loaded)
+		{
+			passed = false;
+			continue;
+		}
+		if (!samePositions(mesh.get(),loaded.get()))
+		{
+			std::cout << path << " did not load back the same positions!\n";
+			passed = false;
+			continue;
+		}
+
+		// what the loader gives back has UVs and colors where glTF keeps them
+		asset::CGLTFWriter::SParams loaderLayout;
+		loaderLayout.uvAttributeIx = 1u;
+		loaderLayout.colorAttributeIx = 2u;
+		const auto rewrittenPath = directory/("rewritten_"+path.filename().string());
+		if (!write(loaded.get(),"rewritten",rewrittenPath,asset::EWF_NONE,&loaderLayout))
+		{
+			passed = false;
+			continue;
+		}
+		const auto reloaded = load("reloaded",rewrittenPath);
+		if (!reloaded || !samePositions(mesh.get(),reloaded.get()))
+		{
+			std::cout << rewrittenPath << " did not load back the same positions!\n";
+			passed = false;
+		}
+	}
+
+	std::filesystem::remove_all(directory);
+	return reportResult(passed);
+}
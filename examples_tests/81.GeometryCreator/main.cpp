@@ -0,0 +1,175 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <thread>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+// Per call cost of asset::IGeometryCreator, every shape gets created the first argument's number of times (1000 by default)
+// at a low and a high tesselation, then fetched as many times from the cache. A cached result must share the buffers of the first one
+// and have the same contents as a freshly created one, spheres must have all of their vertices on the surface.
+// Lastly a few threads fetch the same sphere at once while another one creates uncached spheres, they all must get the same buffers.
+
+using namespace nbl;
+
+constexpr uint32_t DefaultCallCount = 1000u;
+constexpr uint32_t LowTesselation = 16u;
+constexpr uint32_t HighTesselation = 1024u;
+
+using geometry_t = asset::IGeometryCreator::return_type;
+
+static bool sameContents(const asset::SBufferBinding<asset::ICPUBuffer>& a, const asset::SBufferBinding<asset::ICPUBuffer>& b)
+{
+	if (!a.buffer || !b.buffer)
+		return !a.buffer && !b.buffer;
+	// cached buffers are immutable, only the const `getPointer` may touch them
+	const asset::ICPUBuffer* bufferA = a.buffer.get();
+	const asset::ICPUBuffer* bufferB = b.buffer.get();
+	return a.offset==b.offset && bufferA->getSize()==bufferB->getSize() && memcmp(bufferA->getPointer(),bufferB->getPointer(),bufferA->getSize())==0;
+}
+
+static bool immutableBuffers(const geometry_t& geometry)
+{
+	for (const auto& binding : geometry.bindings)
+	if (binding.buffer && binding.buffer->getMutability()!=asset::IAsset::EM_IMMUTABLE)
+		return false;
+	return geometry.indexBuffer.buffer->getMutability()==asset::IAsset::EM_IMMUTABLE;
+}
+
+static bool sameBuffers(const geometry_t& a, const geometry_t& b)
+{
+	return a.bindings[0].buffer==b.bindings[0].buffer && a.indexBuffer.buffer==b.indexBuffer.buffer;
+}
+
+//! every vertex but the doubled ones has to be at `radius` from the center, with texture coordinates in [0,1]
+static bool validSphere(const geometry_t& sphere, const float radius)
+{
+	const auto stride = sphere.inputParams.bindings[0].stride;
+	const auto& attributes = sphere.inputParams.attributes;
+	const auto* vertices = reinterpret_cast<const uint8_t*>(static_cast<const asset::ICPUBuffer*>(sphere.bindings[0].buffer.get())->getPointer());
+	const size_t vertexCount = sphere.bindings[0].buffer->getSize()/stride;
+	for (size_t i=0ull; i<vertexCount; i++)
+	{
+		const auto* pos = reinterpret_cast<const float*>(vertices+i*stride+attributes[0].relativeOffset);
+		const auto* uv = reinterpret_cast<const float*>(vertices+i*stride+attributes[2].relativeOffset);
+		if (std::abs(std::sqrt(pos[0]*pos[0]+pos[1]*pos[1]+pos[2]*pos[2])-radius)>radius*0.00001f)
+			return false;
+		if (uv[0]<0.f || uv[0]>1.f || uv[1]<0.f || uv[1]>1.f)
+			return false;
+	}
+	const auto* indices = reinterpret_cast<const uint32_t*>(static_cast<const asset::ICPUBuffer*>(sphere.indexBuffer.buffer.get())->getPointer());
+	for (uint32_t i=0u; i<sphere.indexCount; i++)
+	if (indices[i]>=vertexCount)
+		return false;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t callCount = argc>1 ? std::stoul(argv[1]):DefaultCallCount;
+
+	auto system = createSystem();
+	auto assetManager = core::make_smart_refctd_ptr<asset::IAssetManager>(core::smart_refctd_ptr(system));
+	const auto* creator = assetManager->getGeometryCreator();
+
+	bool passed = true;
+	struct SShape
+	{
+		const char* name;
+		std::function<geometry_t(const uint32_t)> create;
+		std::function<geometry_t(const uint32_t)> getCached;
+	};
+	const SShape shapes[] = {
+		{"sphere",[&](const uint32_t t) {return creator->createSphereMesh(1.f,t,t);},[&](const uint32_t t) {return creator->getCachedSphereMesh(1.f,t,t);}},
+		{"cylinder",[&](const uint32_t t) {return creator->createCylinderMesh(1.f,2.f,t);},[&](const uint32_t t) {return creator->getCachedCylinderMesh(1.f,2.f,t);}},
+		{"cone",[&](const uint32_t t) {return creator->createConeMesh(1.f,2.f,t);},[&](const uint32_t t) {return creator->getCachedConeMesh(1.f,2.f,t);}},
+		{"arrow",[&](const uint32_t t) {return creator->createArrowMesh(t,t);},[&](const uint32_t t) {return creator->getCachedArrowMesh(t,t);}},
+		{"disk",[&](const uint32_t t) {return creator->createDiskMesh(1.f,t);},[&](const uint32_t t) {return creator->getCachedDiskMesh(1.f,t);}}
+	};
+	for (const auto tesselation : {LowTesselation,HighTesselation})
+	{
+		std::cout << "Tesselation " << tesselation << ", " << callCount << " calls\n";
+		for (const auto& shape : shapes)
+		{
+			// the big ones would take forever
+			const uint32_t calls = tesselation==HighTesselation ? std::max(callCount/100u,1u):callCount;
+			geometry_t created;
+			const double createMs = timeMs([&]() -> void
+			{
+				for (uint32_t i=0u; i<calls; i++)
+					created = shape.create(tesselation);
+			});
+			geometry_t first,cached;
+			const double firstMs = timeMs([&]() -> void {first = shape.getCached(tesselation);});
+			const double cachedMs = timeMs([&]() -> void
+			{
+				for (uint32_t i=0u; i<callCount; i++)
+					cached = shape.getCached(tesselation);
+			});
+			std::cout << "\t" << shape.name << ": create " << 1000.0*createMs/calls << "us/call, first cached " << 1000.0*firstMs << "us, cached "
+				<< 1000.0*cachedMs/callCount << "us/call (" << (createMs/calls)/(cachedMs/callCount) << "x)\n";
+
+			if (!sameBuffers(first,cached))
+			{
+				std::cout << "The cached " << shape.name << " did not share the buffers!\n";
+				passed = false;
+			}
+			if (!immutableBuffers(cached))
+			{
+				std::cout << "The cached " << shape.name << " has mutable buffers!\n";
+				passed = false;
+			}
+			if (!sameContents(created.bindings[0],cached.bindings[0]) || !sameContents(created.indexBuffer,cached.indexBuffer) || created.indexCount!=cached.indexCount)
+			{
+				std::cout << "The cached " << shape.name << " differs from a created one!\n";
+				passed = false;
+			}
+		}
+		if (!validSphere(creator->getCachedSphereMesh(1.f,tesselation,tesselation),1.f))
+		{
+			std::cout << "The sphere has vertices off its surface!\n";
+			passed = false;
+		}
+	}
+
+	// only one of them generates the sphere, the others wait for it and get its buffers, the uncached one uses the default normal cache meanwhile
+	{
+		creator->clearCache();
+		const uint32_t threadCount = std::max(std::thread::hardware_concurrency(),2u);
+		core::vector<geometry_t> results(threadCount);
+		core::vector<std::thread> threads;
+		for (uint32_t i=0u; i<threadCount; i++)
+			threads.emplace_back([&,i]() -> void {results[i] = creator->getCachedSphereMesh(2.f,HighTesselation,HighTesselation/2u);});
+		geometry_t uncached;
+		threads.emplace_back([&]() -> void
+		{
+			for (uint32_t i=0u; i<threadCount; i++)
+				uncached = creator->createSphereMesh(2.f,HighTesselation,HighTesselation/2u);
+		});
+		for (auto& thread : threads)
+			thread.join();
+		for (const auto& result : results)
+		if (!sameBuffers(result,results.front()))
+		{
+			std::cout << "Threads got different buffers for the same sphere!\n";
+			passed = false;
+			break;
+		}
+		if (!sameContents(uncached.bindings[0],results.front().bindings[0]) || !sameContents(uncached.indexBuffer,results.front().indexBuffer))
+		{
+			std::cout << "The uncached sphere differs from the cached one!\n";
+			passed = false;
+		}
+		if (!validSphere(results.front(),2.f))
+		{
+			std::cout << "The sphere has vertices off its surface!\n";
+			passed = false;
+		}
+	}
+
+	return reportResult(passed);
+}
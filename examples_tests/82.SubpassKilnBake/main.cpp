@@ -0,0 +1,383 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <random>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/system/CStdoutLogger.h"
+
+// Cost of video::CSubpassKiln::bake on the null backend, with the first argument's number of drawcalls (200k by default) spread
+// over two subpasses and random pipelines, descriptor sets, vertex and index buffers. The radix sorted default order gets compared
+// with the old std::sort path (any order other than `DefaultOrder`), both must record every drawcall of a subpass exactly once and
+// keep every combination of state contiguous, so they change state the same number of times. Then it's timed per bake:
+// a full sort on both paths, re-keying 1% of the drawcalls and baking without any changes.
+
+using namespace nbl;
+
+constexpr uint32_t DefaultDrawCount = 200000u;
+constexpr uint32_t BakeCount = 16u;
+constexpr uint32_t SubpassCount = 2u;
+constexpr uint32_t PipelineCount = 64u;
+constexpr uint32_t DescriptorSetCount = 256u;
+constexpr uint32_t VertexBufferCount = 1024u;
+constexpr uint32_t IndexBufferCount = 256u;
+
+using drawcall_t = video::CSubpassKiln::DrawcallInfo;
+
+//! the same comparators as the default order, but `bake` only radix sorts for `DefaultOrder` itself
+struct LegacyOrder : video::CSubpassKiln::DefaultOrder
+{
+	static inline constexpr uint64_t typeID = 0x45u;
+};
+
+//! lets us see the order the last `bake` recorded a subpass in
+class CInspectableKiln : public video::CSubpassKiln
+{
+	public:
+		using video::CSubpassKiln::CSubpassKiln;
+
+		template<typename draw_call_order_t>
+		core::vector<const drawcall_t*> getRecordedOrder(const video::IGPURenderpass* renderpass, const uint32_t subpassIndex) const
+		{
+			core::vector<const drawcall_t*> retval;
+			if constexpr (std::is_same_v<draw_call_order_t,DefaultOrder>)
+			{
+				const auto range = getSortedRange(renderpass,subpassIndex);
+				for (auto i=range.first; i<range.second; i++)
+					retval.push_back(m_drawCallMetadataStorage.data()+m_sortedIndices[i]);
+			}
+			else
+			{
+				const SearchObject searchObj = {renderpass,subpassIndex};
+				const auto range = std::equal_range(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj,typename draw_call_order_t::renderpass_subpass_comp());
+				for (auto it=range.first; it!=range.second; it++)
+					retval.push_back(&*it);
+			}
+			return retval;
+		}
+
+		inline size_t getPendingModificationCount() const {return m_dirtyRanges.size();}
+};
+
+struct SStateChanges
+{
+	uint32_t pipelines = 0u;
+	uint32_t descriptorSets = 0u;
+	uint32_t vertexBindings = 0u;
+	uint32_t indexBindings = 0u;
+
+	inline bool operator==(const SStateChanges& other) const
+	{
+		return pipelines==other.pipelines && descriptorSets==other.descriptorSets && vertexBindings==other.vertexBindings && indexBindings==other.indexBindings;
+	}
+};
+static std::ostream& operator<<(std::ostream& os, const SStateChanges& changes)
+{
+	return os << changes.pipelines << " pipelines, " << changes.descriptorSets << " descriptor sets, " << changes.vertexBindings << " vertex bindings, " << changes.indexBindings << " index bindings";
+}
+
+// every drawcall binds its descriptor set 0 and vertex binding 0, so those are enough to tell the state apart
+using state_t = std::tuple<const void*,const void*,const void*,const void*>;
+static state_t getState(const drawcall_t* draw)
+{
+	return {draw->pipeline.get(),draw->descriptorSets[0].get(),draw->vertexBufferBindings[0].buffer.get(),draw->indexBufferBinding.get()};
+}
+
+//! how many times the recording changes each piece of state, a change of a more expensive piece counts as a change of all the cheaper ones
+static SStateChanges countStateChanges(const core::vector<const drawcall_t*>& order)
+{
+	SStateChanges retval;
+	for (size_t i=0ull; i<order.size(); i++)
+	{
+		const auto state = getState(order[i]);
+		const auto prevState = i ? getState(order[i-1ull]):state_t{};
+		const bool pipeline = std::get<0>(state)!=std::get<0>(prevState);
+		const bool descriptorSets = pipeline || std::get<1>(state)!=std::get<1>(prevState);
+		const bool vertexBindings = descriptorSets || std::get<2>(state)!=std::get<2>(prevState);
+		retval.pipelines += pipeline ? 1u:0u;
+		retval.descriptorSets += descriptorSets ? 1u:0u;
+		retval.vertexBindings += vertexBindings ? 1u:0u;
+		retval.indexBindings += vertexBindings || std::get<3>(state)!=std::get<3>(prevState) ? 1u:0u;
+	}
+	return retval;
+}
+
+//! the least state changes possible, every distinct combination of the state up to and including the piece being counted must be bound once
+static SStateChanges countMinimumStateChanges(const core::vector<const drawcall_t*>& order)
+{
+	core::set<state_t> prefixes[4];
+	for (const auto* draw : order)
+	{
+		const auto state = getState(draw);
+		prefixes[0].insert({std::get<0>(state),nullptr,nullptr,nullptr});
+		prefixes[1].insert({std::get<0>(state),std::get<1>(state),nullptr,nullptr});
+		prefixes[2].insert({std::get<0>(state),std::get<1>(state),std::get<2>(state),nullptr});
+		prefixes[3].insert(state);
+	}
+	return {uint32_t(prefixes[0].size()),uint32_t(prefixes[1].size()),uint32_t(prefixes[2].size()),uint32_t(prefixes[3].size())};
+}
+
+//! the same drawcalls, none of them twice
+static bool sameDrawcalls(core::vector<const drawcall_t*> a, core::vector<const drawcall_t*> b)
+{
+	auto byOffset = [](const drawcall_t* lhs, const drawcall_t* rhs) -> bool {return lhs->drawCallOffset<rhs->drawCallOffset;};
+	std::sort(a.begin(),a.end(),byOffset);
+	std::sort(b.begin(),b.end(),byOffset);
+	if (a.size()!=b.size())
+		return false;
+	for (size_t i=0ull; i<a.size(); i++)
+	if (a[i]->drawCallOffset!=b[i]->drawCallOffset || (i && a[i]->drawCallOffset==a[i-1ull]->drawCallOffset))
+		return false;
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	const uint32_t drawCount = argc>1 ? std::stoul(argv[1]):DefaultDrawCount;
+
+	auto system = createSystem();
+	auto logger = core::make_smart_refctd_ptr<system::CStdoutLogger>();
+	auto api = video::CNullConnection::create(core::smart_refctd_ptr(system),0u,"SubpassKilnBake",core::smart_refctd_ptr<system::ILogger>(logger));
+	if (!api)
+		return 1;
+	auto* physicalDevice = *api->getPhysicalDevices().begin();
+
+	constexpr uint32_t QueueFamily = 0u;
+	const float priority = 1.f;
+	video::ILogicalDevice::SQueueCreationParams queueParams;
+	queueParams.flags = static_cast<video::IGPUQueue::E_CREATE_FLAGS>(0);
+	queueParams.familyIndex = QueueFamily;
+	queueParams.count = 1u;
+	queueParams.priorities = &priority;
+	video::ILogicalDevice::SCreationParams deviceParams = {};
+	deviceParams.queueParamsCount = 1u;
+	deviceParams.queueParams = &queueParams;
+	auto logicalDevice = physicalDevice->createLogicalDevice(deviceParams);
+	if (!logicalDevice)
+		return 2;
+
+	// one color attachment, drawn to by both subpasses
+	core::smart_refctd_ptr<video::IGPURenderpass> renderpass;
+	{
+		video::IGPURenderpass::SCreationParams::SAttachmentDescription attachment = {};
+		attachment.format = asset::EF_R8G8B8A8_SRGB;
+		attachment.loadOp = video::IGPURenderpass::ELO_CLEAR;
+		attachment.storeOp = video::IGPURenderpass::ESO_STORE;
+		attachment.finalLayout = asset::EIL_COLOR_ATTACHMENT_OPTIMAL;
+		video::IGPURenderpass::SCreationParams::SSubpassDescription::SAttachmentRef colorRef = {0u,asset::EIL_COLOR_ATTACHMENT_OPTIMAL};
+		video::IGPURenderpass::SCreationParams::SSubpassDescription subpasses[SubpassCount] = {};
+		for (auto& subpass : subpasses)
+		{
+			subpass.pipelineBindPoint = asset::EPBP_GRAPHICS;
+			subpass.colorAttachmentCount = 1u;
+			subpass.colorAttachments = &colorRef;
+		}
+		video::IGPURenderpass::SCreationParams params = {};
+		params.attachmentCount = 1u;
+		params.attachments = &attachment;
+		params.subpassCount = SubpassCount;
+		params.subpasses = subpasses;
+		renderpass = logicalDevice->createGPURenderpass(params);
+	}
+
+	// two pipeline layouts which aren't compatible for push constants, every pipeline exists in both subpasses
+	core::smart_refctd_ptr<video::IGPUDescriptorSetLayout> dsLayout;
+	core::vector<core::smart_refctd_ptr<const video::IGPUGraphicsPipeline>> pipelines[SubpassCount];
+	{
+		const video::IGPUDescriptorSetLayout::SBinding binding = {0u,asset::EDT_UNIFORM_BUFFER,1u,asset::IShader::ESS_VERTEX,nullptr};
+		dsLayout = logicalDevice->createGPUDescriptorSetLayout(&binding,&binding+1u);
+		const asset::SPushConstantRange pcRange = {asset::IShader::ESS_VERTEX,0u,16u};
+		core::smart_refctd_ptr<video::IGPUPipelineLayout> layouts[2] = {
+			logicalDevice->createGPUPipelineLayout(&pcRange,&pcRange+1u,core::smart_refctd_ptr(dsLayout)),
+			logicalDevice->createGPUPipelineLayout(nullptr,nullptr,core::smart_refctd_ptr(dsLayout))
+		};
+		for (uint32_t i=0u; i<PipelineCount; i++)
+		{
+			auto renderpassIndep = logicalDevice->createGPURenderpassIndependentPipeline(
+				nullptr,core::smart_refctd_ptr(layouts[i&0x1u]),nullptr,nullptr,
+				asset::SVertexInputParams(),asset::SBlendParams(),asset::SPrimitiveAssemblyParams(),asset::SRasterizationParams()
+			);
+			for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+			{
+				video::IGPUGraphicsPipeline::SCreationParams params;
+				params.renderpassIndependent = renderpassIndep;
+				params.renderpass = renderpass;
+				params.subpassIx = subpass;
+				pipelines[subpass].push_back(logicalDevice->createGPUGraphicsPipeline(nullptr,std::move(params)));
+			}
+		}
+	}
+	auto descriptorPool = logicalDevice->createDescriptorPool(static_cast<video::IDescriptorPool::E_CREATE_FLAGS>(0),DescriptorSetCount,0u,nullptr);
+	core::vector<core::smart_refctd_ptr<const video::IGPUDescriptorSet>> descriptorSets(DescriptorSetCount);
+	for (auto& ds : descriptorSets)
+		ds = logicalDevice->createGPUDescriptorSet(descriptorPool.get(),core::smart_refctd_ptr(dsLayout));
+	auto createBuffers = [&](const uint32_t count, const video::IGPUBuffer::E_USAGE_FLAGS usage) -> core::vector<core::smart_refctd_ptr<video::IGPUBuffer>>
+	{
+		video::IGPUBuffer::SCreationParams params = {};
+		params.usage = usage;
+		core::vector<core::smart_refctd_ptr<video::IGPUBuffer>> retval(count);
+		for (auto& buffer : retval)
+			buffer = logicalDevice->createDeviceLocalGPUBufferOnDedMem(params,64u);
+		return retval;
+	};
+	const auto vertexBuffers = createBuffers(VertexBufferCount,video::IGPUBuffer::EUF_VERTEX_BUFFER_BIT);
+	const auto indexBuffers = createBuffers(IndexBufferCount,video::IGPUBuffer::EUF_INDEX_BUFFER_BIT);
+	const auto drawIndirectBuffer = createBuffers(1u,video::IGPUBuffer::EUF_INDIRECT_BUFFER_BIT).front();
+
+	std::mt19937 mt(0x45u);
+	auto randomDescriptorSet = [&]() -> core::smart_refctd_ptr<const video::IGPUDescriptorSet>
+	{
+		return descriptorSets[std::uniform_int_distribution<uint32_t>(0u,DescriptorSetCount-1u)(mt)];
+	};
+	CInspectableKiln kiln{core::smart_refctd_ptr<system::ILogger>(logger)};
+	{
+		auto& drawcalls = kiln.getDrawcallMetadataVector();
+		drawcalls.resize(drawCount);
+		for (uint32_t i=0u; i<drawCount; i++)
+		{
+			auto& draw = drawcalls[i];
+			draw.pipeline = pipelines[i%SubpassCount][std::uniform_int_distribution<uint32_t>(0u,PipelineCount-1u)(mt)];
+			draw.descriptorSets[0] = randomDescriptorSet();
+			draw.vertexBufferBindings[0] = {0ull,vertexBuffers[std::uniform_int_distribution<uint32_t>(0u,VertexBufferCount-1u)(mt)]};
+			draw.indexBufferBinding = indexBuffers[std::uniform_int_distribution<uint32_t>(0u,IndexBufferCount-1u)(mt)];
+			draw.indexType = asset::EIT_32BIT;
+			draw.drawCommandStride = sizeof(asset::DrawElementsIndirectCommand_t);
+			draw.drawCallOffset = i*sizeof(asset::DrawElementsIndirectCommand_t);
+			draw.drawMaxCount = 1u;
+		}
+	}
+
+	// a secondary per subpass, re-recorded by every bake
+	auto pool = logicalDevice->createCommandPool(QueueFamily,video::IGPUCommandPool::ECF_RESET_COMMAND_BUFFER_BIT);
+	core::smart_refctd_ptr<video::IGPUCommandBuffer> cmdbufs[SubpassCount];
+	logicalDevice->createCommandBuffers(pool.get(),video::IGPUCommandBuffer::EL_SECONDARY,SubpassCount,cmdbufs);
+	auto bake = [&](const auto order) -> void
+	{
+		using draw_call_order_t = std::remove_const_t<decltype(order)>;
+		for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+		{
+			auto* cmdbuf = cmdbufs[subpass].get();
+			video::IGPUCommandBuffer::SInheritanceInfo inheritanceInfo = {};
+			inheritanceInfo.renderpass = renderpass;
+			inheritanceInfo.subpass = subpass;
+			cmdbuf->reset(video::IGPUCommandBuffer::ERF_RELEASE_RESOURCES_BIT);
+			cmdbuf->begin(video::IGPUCommandBuffer::EU_RENDER_PASS_CONTINUE_BIT,&inheritanceInfo);
+			kiln.bake<draw_call_order_t>(cmdbuf,renderpass.get(),subpass,drawIndirectBuffer.get(),nullptr);
+			cmdbuf->end();
+		}
+	};
+
+	bool passed = true;
+	// the radix sorted order against the old one
+	{
+		bake(video::CSubpassKiln::DefaultOrder());
+		core::vector<const drawcall_t*> defaultOrders[SubpassCount];
+		for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+			defaultOrders[subpass] = kiln.getRecordedOrder<video::CSubpassKiln::DefaultOrder>(renderpass.get(),subpass);
+		// the old path sorts the drawcalls themselves, so remember them by their offsets
+		core::vector<uint32_t> defaultOffsets[SubpassCount];
+		for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+		for (const auto* draw : defaultOrders[subpass])
+			defaultOffsets[subpass].push_back(draw->drawCallOffset);
+
+		bake(LegacyOrder());
+		for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+		{
+			const auto legacyOrder = kiln.getRecordedOrder<LegacyOrder>(renderpass.get(),subpass);
+			if (legacyOrder.size()!=(drawCount+SubpassCount-1u-subpass)/SubpassCount || !sameDrawcalls(legacyOrder,legacyOrder)) // only checks for duplicates
+			{
+				std::cout << "The old path did not record every drawcall of subpass " << subpass << " once!\n";
+				passed = false;
+			}
+			if (defaultOffsets[subpass].size()!=legacyOrder.size())
+			{
+				std::cout << "The radix sorted path recorded " << defaultOffsets[subpass].size() << " drawcalls of subpass " << subpass << " instead of " << legacyOrder.size() << "!\n";
+				passed = false;
+				continue;
+			}
+			// the drawcalls of the radix sorted order, wherever they are now
+			core::unordered_map<uint32_t,const drawcall_t*> byOffset;
+			for (const auto* draw : legacyOrder)
+				byOffset[draw->drawCallOffset] = draw;
+			core::vector<const drawcall_t*> remappedDefaultOrder;
+			for (const auto offset : defaultOffsets[subpass])
+			{
+				const auto found = byOffset.find(offset);
+				if (found!=byOffset.end())
+					remappedDefaultOrder.push_back(found->second);
+			}
+			if (!sameDrawcalls(remappedDefaultOrder,legacyOrder))
+			{
+				std::cout << "The radix sorted and the old path recorded different drawcalls for subpass " << subpass << "!\n";
+				passed = false;
+				continue;
+			}
+
+			const auto minimumChanges = countMinimumStateChanges(legacyOrder);
+			const auto legacyChanges = countStateChanges(legacyOrder);
+			const auto defaultChanges = countStateChanges(remappedDefaultOrder);
+			std::cout << "Subpass " << subpass << " state changes\n\tradix sorted: " << defaultChanges << "\n\told path: " << legacyChanges << "\n\tminimum: " << minimumChanges << "\n";
+			if (!(legacyChanges==minimumChanges) || !(defaultChanges==minimumChanges))
+			{
+				std::cout << "The state of subpass " << subpass << " did not get grouped!\n";
+				passed = false;
+			}
+		}
+
+		// modifying drawcalls after baking with another order has to make it sort again
+		for (auto& draw : kiln.modifyDrawcalls(0u,std::min(drawCount,1024u)))
+			draw.descriptorSets[0] = randomDescriptorSet();
+		bake(LegacyOrder());
+		const auto& drawcalls = std::as_const(kiln).getDrawcallMetadataVector();
+		if (!std::is_sorted(drawcalls.begin(),drawcalls.end(),LegacyOrder::less()) || kiln.getPendingModificationCount())
+		{
+			std::cout << "Modifications after a bake with another order did not get sorted in!\n";
+			passed = false;
+		}
+	}
+
+	// timings
+	std::cout << drawCount << " drawcalls, " << BakeCount << " bakes each\n";
+	auto timeBakes = [&](const char* name, auto&& prepare, auto&& doBake) -> void
+	{
+		double ms = 0.0;
+		for (uint32_t i=0u; i<BakeCount; i++)
+		{
+			prepare();
+			ms += timeMs(doBake);
+		}
+		std::cout << "\t" << name << ": " << ms/double(BakeCount) << "ms per bake\n";
+	};
+	auto bakeDefault = [&]() -> void {bake(video::CSubpassKiln::DefaultOrder());};
+	auto bakeLegacy = [&]() -> void {bake(LegacyOrder());};
+	// the non-const vector access is what makes the next bake start from scratch
+	auto invalidate = [&]() -> void {kiln.getDrawcallMetadataVector();};
+	timeBakes("old path, full sort",invalidate,bakeLegacy);
+	timeBakes("radix sort, full sort",invalidate,bakeDefault);
+	const uint32_t modifiedCount = std::max(drawCount/100u,1u);
+	timeBakes("radix sort, 1% re-keyed",[&]() -> void
+		{
+			const uint32_t begin = std::uniform_int_distribution<uint32_t>(0u,drawCount-modifiedCount)(mt);
+			for (auto& draw : kiln.modifyDrawcalls(begin,begin+modifiedCount))
+				draw.descriptorSets[0] = randomDescriptorSet();
+		},bakeDefault
+	);
+	timeBakes("radix sort, unchanged",[]() -> void {},bakeDefault);
+	// the incremental bakes must still group the state
+	for (uint32_t subpass=0u; subpass<SubpassCount; subpass++)
+	{
+		const auto order = kiln.getRecordedOrder<video::CSubpassKiln::DefaultOrder>(renderpass.get(),subpass);
+		if (!(countStateChanges(order)==countMinimumStateChanges(order)))
+		{
+			std::cout << "The state of subpass " << subpass << " did not stay grouped after the modifications!\n";
+			passed = false;
+		}
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,120 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#define _NBL_STATIC_LIB_
+#include <iostream>
+#include <new>
+#include <nabla.h>
+
+#include "../common/BenchmarkCommon.h"
+
+#include "nbl/asset/utils/CAssetContentHasher.h"
+
+// Equal assets built separately must get equal content hashes. The pipeline and sampler parameters have bitfields and padding,
+// so every pair here is built over memory filled with different garbage, whatever a constructor leaves unwritten differs between them.
+// A pipeline with one different parameter must hash differently, and deduplicating the equal ones must leave a single instance.
+
+using namespace nbl;
+
+//! default constructs a `T` over bytes set to `pattern`
+template<typename T>
+struct SDirty
+{
+	SDirty(const uint8_t pattern)
+	{
+		memset(storage,pattern,sizeof(T));
+		new (storage) T;
+	}
+
+	inline T& get() {return *std::launder(reinterpret_cast<T*>(storage));}
+
+	alignas(T) uint8_t storage[sizeof(T)];
+};
+
+static core::smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline> createPipeline(const uint8_t pattern, const asset::E_FACE_CULL_MODE cullMode)
+{
+	SDirty<asset::SVertexInputParams> vertexInput(pattern);
+	auto& vertexInputParams = vertexInput.get();
+	vertexInputParams.enabledAttribFlags = 0b11u;
+	vertexInputParams.enabledBindingFlags = 0b1u;
+	vertexInputParams.attributes[0].binding = 0u;
+	vertexInputParams.attributes[0].format = asset::EF_R32G32B32_SFLOAT;
+	vertexInputParams.attributes[0].relativeOffset = 0u;
+	vertexInputParams.attributes[1].binding = 0u;
+	vertexInputParams.attributes[1].format = asset::EF_R32G32_SFLOAT;
+	vertexInputParams.attributes[1].relativeOffset = 12u;
+	vertexInputParams.bindings[0].stride = 20u;
+	vertexInputParams.bindings[0].inputRate = asset::EVIR_PER_VERTEX;
+
+	SDirty<asset::SBlendParams> blend(pattern);
+	blend.get().blendParams[0].blendEnable = true;
+	blend.get().blendParams[0].srcColorFactor = asset::EBF_SRC_ALPHA;
+	blend.get().blendParams[0].dstColorFactor = asset::EBF_ONE_MINUS_SRC_ALPHA;
+
+	SDirty<asset::SPrimitiveAssemblyParams> primitiveAssembly(pattern);
+
+	SDirty<asset::SRasterizationParams> rasterization(pattern);
+	rasterization.get().faceCullingMode = cullMode;
+	rasterization.get().depthWriteEnable = false;
+
+	return core::make_smart_refctd_ptr<asset::ICPURenderpassIndependentPipeline>(
+		nullptr,nullptr,nullptr,vertexInputParams,blend.get(),primitiveAssembly.get(),rasterization.get()
+	);
+}
+
+static core::smart_refctd_ptr<asset::ICPUSampler> createSampler(const uint8_t pattern)
+{
+	SDirty<asset::ICPUSampler::SParams> params(pattern);
+	auto& samplerParams = params.get();
+	samplerParams.TextureWrapU = asset::ISampler::ETC_REPEAT;
+	samplerParams.TextureWrapV = asset::ISampler::ETC_CLAMP_TO_EDGE;
+	samplerParams.TextureWrapW = asset::ISampler::ETC_REPEAT;
+	samplerParams.BorderColor = asset::ISampler::ETBC_FLOAT_OPAQUE_BLACK;
+	samplerParams.MinFilter = asset::ISampler::ETF_LINEAR;
+	samplerParams.MaxFilter = asset::ISampler::ETF_LINEAR;
+	samplerParams.MipmapMode = asset::ISampler::ESMM_LINEAR;
+	samplerParams.AnisotropicFilter = 3u;
+	samplerParams.CompareEnable = false;
+	samplerParams.CompareFunc = asset::ISampler::ECO_ALWAYS;
+	return core::make_smart_refctd_ptr<asset::ICPUSampler>(samplerParams);
+}
+
+int main()
+{
+	bool passed = true;
+	asset::CAssetContentHasher hasher;
+
+	const auto pipelineA = createPipeline(0x00u,asset::EFCM_BACK_BIT);
+	const auto pipelineB = createPipeline(0xffu,asset::EFCM_BACK_BIT);
+	const auto pipelineC = createPipeline(0x5au,asset::EFCM_NONE);
+	if (hasher.hash(pipelineA.get())!=hasher.hash(pipelineB.get()))
+	{
+		std::cout << "Equal pipelines hash differently!\n";
+		passed = false;
+	}
+	if (hasher.hash(pipelineA.get())==hasher.hash(pipelineC.get()))
+	{
+		std::cout << "Pipelines with different culling hash the same!\n";
+		passed = false;
+	}
+
+	const auto samplerA = createSampler(0x00u);
+	const auto samplerB = createSampler(0xffu);
+	if (hasher.hash(samplerA.get())!=hasher.hash(samplerB.get()))
+	{
+		std::cout << "Equal samplers hash differently!\n";
+		passed = false;
+	}
+
+	// what `convert2BAW -dedup` relies on
+	core::smart_refctd_ptr<asset::IAsset> roots[] = {pipelineA,pipelineB,pipelineC};
+	const auto stats = hasher.deduplicate(roots,roots+3);
+	if (roots[0]!=roots[1] || roots[0]==roots[2] || stats.duplicateAssets!=1u)
+	{
+		std::cout << "Deduplication found " << stats.duplicateAssets << " duplicates instead of 1!\n";
+		passed = false;
+	}
+
+	return reportResult(passed);
+}
@@ -0,0 +1,53 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_EXAMPLES_COMMON_BENCHMARK_COMMON_H_INCLUDED_
+#define _NBL_EXAMPLES_COMMON_BENCHMARK_COMMON_H_INCLUDED_
+
+// Helpers of the headless benchmark and test examples, include after `nabla.h`
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+#ifdef _NBL_PLATFORM_WINDOWS_
+#include "nbl/system/CSystemWin32.h"
+#elif defined(_NBL_PLATFORM_LINUX_)
+#include "nbl/system/CSystemLinux.h"
+#endif
+
+//! Milliseconds one call of `f` takes, averaged over `repetitions` calls
+template<typename F>
+inline double timeMs(F&& f, const uint32_t repetitions=1u)
+{
+	const auto start = std::chrono::high_resolution_clock::now();
+	for (uint32_t r=0u; r<repetitions; r++)
+		f();
+	return std::chrono::duration<double,std::milli>(std::chrono::high_resolution_clock::now()-start).count()/double(repetitions);
+}
+
+inline nbl::core::smart_refctd_ptr<nbl::system::ISystem> createSystem()
+{
+#ifdef _NBL_PLATFORM_WINDOWS_
+	return nbl::core::make_smart_refctd_ptr<nbl::system::CSystemWin32>();
+#elif defined(_NBL_PLATFORM_LINUX_)
+	return nbl::core::make_smart_refctd_ptr<nbl::system::CSystemLinux>();
+#endif
+	return nullptr;
+}
+
+//! One row of a results table, `count` is in millions of `unit` (or in bytes with "MB") and the speedup is against `baselineMs`
+inline void printRow(const size_t count, const char* unit, const char* name, const double ms, const double baselineMs, const std::string& suffix="")
+{
+	std::cout << "\t" << name << ": " << ms << "ms, " << double(count)/(ms*1000.0) << unit << "/s, " << baselineMs/ms << "x speedup" << suffix << "\n";
+}
+
+//! Prints the verdict and returns the exit code of `main`
+inline int reportResult(const bool passed)
+{
+	std::cout << (passed ? "PASSED":"FAILED") << std::endl;
+	return passed ? 0:1;
+}
+
+#endif
@@ -22,7 +22,8 @@ namespace impl
         CConcurrentObjectCacheBase& operator=(const CConcurrentObjectCacheBase&) = delete;
         CConcurrentObjectCacheBase& operator=(CConcurrentObjectCacheBase&&) = delete;
 
-        mutable system::SReadWriteSpinLock m_lock;
+        // lookups vastly outnumber insertions, so without writer preference insertions could starve
+        mutable system::SReadWriteSpinLock m_lock{system::SReadWriteSpinLock::EP_WRITERS};
 
     protected:
         auto lock_read() const { return system::read_lock_guard<>(m_lock); }
@@ -64,6 +65,11 @@ namespace impl
             return r;
         }
 
+        inline system::SReadWriteSpinLock::SStatistics getLockStatistics() const
+        {
+            return m_lock.getStatistics();
+        }
+
         inline size_t getSize() const
         {
             auto lk = lock_read();
@@ -6,7 +6,10 @@
 #define __NBL_ASSET_I_ASSET_MANAGER_H_INCLUDED__
 
 #include <array>
+#include <future>
+#include <optional>
 #include <ostream>
+#include <thread>
 
 #include "nbl/core/declarations.h"
 #include "nbl/system/path.h"
@@ -16,13 +19,11 @@
 #include "nbl/system/IFile.h"
 #include "nbl/asset/interchange/IAssetLoader.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
+#include "nbl/asset/interchange/CAssetCache.h"
 
 #include "nbl/asset/utils/IGLSLCompiler.h"
 #include "nbl/asset/utils/IGeometryCreator.h"
 
-
-#define USE_MAPS_FOR_PATH_BASED_CACHE //benchmark and choose, paths can be full system paths
-
 namespace nbl::asset
 {
 
@@ -35,9 +36,9 @@ std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* con
 
 //! Class responsible for handling loading of assets from file system or other resources
 /**
-	It provides a loading, writing and creation functionality that is almost thread-safe.
-	There is one issue with threading, starting loading the same asset at the exact same time 
-	may end up with two copies in the cache.
+	It provides a loading, writing and creation functionality that is thread-safe.
+	Starting loading the same asset from multiple threads at the same time results in only one load,
+	the other requesters wait for it to finish and then get the cached asset.
 
 	IAssetManager performs caching of CPU assets associated with resource handles such as names, 
 	filenames, UUIDs. However there are separate caches for each asset type.
@@ -52,11 +53,7 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         friend std::function<void(SAssetBundle&)> makeAssetDisposeFunc(const IAssetManager* const _mgr);
 
     public:
-#ifdef USE_MAPS_FOR_PATH_BASED_CACHE
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, SAssetBundle, std::multimap>;
-#else
-        using AssetCacheType = core::CConcurrentMultiObjectCache<std::string, IAssetBundle, std::vector>;
-#endif //USE_MAPS_FOR_PATH_BASED_CACHE
+        using AssetCacheType = CAssetCache;
 
         using CpuGpuCacheType = core::CConcurrentObjectCache<const IAsset*, core::smart_refctd_ptr<core::IReferenceCounted> >;
 
@@ -90,6 +87,128 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         std::array<AssetCacheType*, IAsset::ET_STANDARD_TYPES_COUNT> m_assetCache;
         std::array<CpuGpuCacheType*, IAsset::ET_STANDARD_TYPES_COUNT> m_cpuGpuCache;
 
+        //! Single-flight guard around a load which would end up in the cache
+        /**
+            The first thread to ask for a key becomes the leader and performs the load, anyone asking for the same key
+            before the leader calls `finish` (or goes out of scope) gets a future to wait on instead.
+            A thread asking for a key which it is already loading itself (a file referencing itself) never waits on itself,
+            neither does a thread whose wait would close a cycle (A loads X referencing Y while B loads Y referencing X), it loads the asset on its own.
+        */
+        class CInFlightLoad final
+        {
+            public:
+                CInFlightLoad() = default;
+                CInFlightLoad(IAssetManager* _mgr, std::string&& _key) : m_mgr(_mgr), m_key(std::move(_key))
+                {
+                    auto& ownLoads = getThreadsOwnLoads();
+                    if (std::find(ownLoads.begin(),ownLoads.end(),m_key)!=ownLoads.end())
+                    {
+                        m_mgr = nullptr;
+                        return;
+                    }
+
+                    std::unique_lock lock(m_mgr->m_inFlightMutex);
+                    auto found = m_mgr->m_inFlightLoads.find(m_key);
+                    if (found!=m_mgr->m_inFlightLoads.end())
+                    {
+                        if (waitWouldDeadlock(found->second.leader))
+                        {
+                            m_mgr = nullptr;
+                            return;
+                        }
+                        m_result = found->second.result;
+                        m_mgr->m_waitingOn.emplace(std::this_thread::get_id(),m_key);
+                        return;
+                    }
+                    m_leader = true;
+                    m_mgr->m_inFlightLoads.emplace(m_key,SInFlight{m_promise.get_future().share(),std::this_thread::get_id()});
+                    lock.unlock();
+                    ownLoads.push_back(m_key);
+                }
+                CInFlightLoad(const CInFlightLoad&) = delete;
+                CInFlightLoad& operator=(const CInFlightLoad&) = delete;
+                ~CInFlightLoad()
+                {
+                    // don't leave waiters hanging if the load failed or threw
+                    finish({});
+                }
+
+                //! Another thread is loading the asset, call `wait` for the result
+                inline bool isWaiter() const { return m_result.valid(); }
+                inline SAssetBundle wait()
+                {
+                    auto retval = m_result.get();
+                    std::unique_lock lock(m_mgr->m_inFlightMutex);
+                    m_mgr->m_waitingOn.erase(std::this_thread::get_id());
+                    return retval;
+                }
+
+                //! Wakes up the waiters, should be called after the loaded asset was inserted into the cache
+                inline void finish(const SAssetBundle& _bundle)
+                {
+                    if (!m_leader)
+                        return;
+                    m_leader = false;
+
+                    auto& ownLoads = getThreadsOwnLoads();
+                    ownLoads.erase(std::find(ownLoads.begin(),ownLoads.end(),m_key));
+                    {
+                        std::unique_lock lock(m_mgr->m_inFlightMutex);
+                        m_mgr->m_inFlightLoads.erase(m_key);
+                    }
+                    m_promise.set_value(_bundle);
+                }
+
+            private:
+                //! follows the leaders which are themselves waiting, expects `m_inFlightMutex` to be locked
+                inline bool waitWouldDeadlock(std::thread::id leader) const
+                {
+                    const auto self = std::this_thread::get_id();
+                    while (leader!=self)
+                    {
+                        const auto waiting = m_mgr->m_waitingOn.find(leader);
+                        if (waiting==m_mgr->m_waitingOn.end())
+                            return false;
+                        const auto load = m_mgr->m_inFlightLoads.find(waiting->second);
+                        // the load finished, its leader only didn't wake up yet
+                        if (load==m_mgr->m_inFlightLoads.end())
+                            return false;
+                        leader = load->second.leader;
+                    }
+                    return true;
+                }
+
+                static inline core::vector<std::string>& getThreadsOwnLoads()
+                {
+                    thread_local core::vector<std::string> keys;
+                    return keys;
+                }
+
+                IAssetManager* m_mgr = nullptr;
+                std::string m_key;
+                bool m_leader = false;
+                std::promise<SAssetBundle> m_promise;
+                std::shared_future<SAssetBundle> m_result;
+        };
+        //! Everything that can make two loads of the same file produce different assets, except for the override which the cache doesn't tell apart either
+        static inline std::string makeInFlightKey(const system::path& _filename, const IAssetLoader::SAssetLoadParams& _params, uint64_t _levelFlags, uint32_t _restoreLevels)
+        {
+            return _filename.lexically_normal().generic_string()+'|'+std::to_string(_levelFlags)+'|'+std::to_string(_params.loaderFlags)+'|'+std::to_string(_restoreLevels);
+        }
+
+        mutable std::atomic<uint64_t> m_cacheLookups = 0u;
+        mutable std::atomic<uint64_t> m_cacheMisses = 0u;
+
+        struct SInFlight
+        {
+            std::shared_future<SAssetBundle> result;
+            std::thread::id leader;
+        };
+        std::mutex m_inFlightMutex;
+        core::unordered_map<std::string,SInFlight> m_inFlightLoads;
+        //! the key every waiting thread waits on, to find cycles of waits
+        core::unordered_map<std::thread::id,std::string> m_waitingOn;
+
         struct Loaders {
             Loaders() : perFileExt{&refCtdGreet<IAssetLoader>, &refCtdDispose<IAssetLoader>} {}
 
@@ -242,17 +361,45 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
             if (!file)
                 return {};//return empty bundle
 
+            // only loads which would end up in the cache get shared, otherwise the caller explicitly asked for its own copy
+            std::optional<CInFlightLoad> inFlight;
+            if ((levelFlags & IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL) != IAssetLoader::ECF_DONT_CACHE_TOP_LEVEL &&
+                (levelFlags & IAssetLoader::ECF_DUPLICATE_TOP_LEVEL) != IAssetLoader::ECF_DUPLICATE_TOP_LEVEL)
+            {
+                inFlight.emplace(this, makeInFlightKey(filename, params, levelFlags, restoreLevels));
+                if (inFlight->isWaiter())
+                    bundle = inFlight->wait();
+                // either the load we waited on has just cached the asset, or a load finished between our cache lookup and claiming the key
+                auto found = findAssets(filename.string());
+                if (found->size())
+                    return _override->chooseRelevantFromFound(found->begin(), found->end(), ctx, _hierarchyLevel);
+                else if (inFlight->isWaiter())
+                    return bundle;
+            }
+
+            // read once and shared by all loaders, so most of them can turn the file down without touching it
+            const IAssetLoader::SFileHeader header(file.get());
+            auto tryLoader = [&](IAssetLoader* loader) -> bool
+            {
+                if (!loader->matchesFileHeader(header) || !loader->isALoadableFileFormat(file.get()))
+                    return false;
+                bundle = loader->loadAsset(file.get(), params, _override, _hierarchyLevel);
+                return !bundle.getContents().empty();
+            };
+
             auto ext = system::extension_wo_dot(filename);
             auto capableLoadersRng = m_loaders.perFileExt.findRange(ext);
             // loaders associated with the file's extension tryout
             for (auto& loader : capableLoadersRng)
-            {
-                if (loader.second->isALoadableFileFormat(file.get()) && !(bundle = loader.second->loadAsset(file.get(), params, _override, _hierarchyLevel)).getContents().empty())
-                    break;
-            }
+            if (tryLoader(loader.second))
+                break;
             for (auto loaderItr = std::begin(m_loaders.vector); bundle.getContents().empty() && loaderItr != std::end(m_loaders.vector); ++loaderItr) // all loaders tryout
             {
-                if ((*loaderItr)->isALoadableFileFormat(file.get()) && !(bundle = (*loaderItr)->loadAsset(file.get(), params, _override, _hierarchyLevel)).getContents().empty())
+                // don't probe the ones associated with the extension again
+                auto* const loader = loaderItr->get();
+                if (std::find_if(capableLoadersRng.begin(),capableLoadersRng.end(),[loader](const auto& _ext) {return _ext.second==loader;})!=capableLoadersRng.end())
+                    continue;
+                if (tryLoader(loader))
                     break;
             }
 
@@ -269,6 +416,8 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                 if (!bundle.getContents().empty() && addToCache)
                     _override->insertAssetIntoCache(bundle, filename.string(), ctx, _hierarchyLevel);
             }
+            if (inFlight)
+                inFlight->finish(bundle);
 
             auto whole_bundle_not_dummy = [restoreLevels](const SAssetBundle& _b) {
                 auto rng = _b.getContents();
@@ -455,6 +604,7 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
 		*/
         inline bool findAssets(size_t& _inOutStorageSize, SAssetBundle* _out, const std::string& _key, const IAsset::E_TYPE* _types = nullptr) const
         {
+            m_cacheLookups++;
             size_t availableSize = _inOutStorageSize;
             _inOutStorageSize = 0u;
             bool res = true;
@@ -483,6 +633,8 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                     _out += readCnt;
                 }
             }
+            if (_inOutStorageSize==0u)
+                m_cacheMisses++;
             return res;
         }
         
@@ -516,8 +668,8 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
         //TODO change name
         inline void changeAssetKey(SAssetBundle& _asset, const std::string& _newKey)
         {
-            _asset.setNewCacheKey(_newKey);
             m_assetCache[IAsset::typeFlagToIndex(_asset.getAssetType())]->changeObjectKey(_asset, _asset.getCacheKey(), _newKey);
+            _asset.setNewCacheKey(_newKey);
         }
 
         //! Insert an asset into the cache (calls the private methods of IAsset behind the scenes)
@@ -549,6 +701,30 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
                     m_assetCache[i]->clear();
         }
 
+        //! Limits how many bytes of asset data (see CAssetCache::estimateByteSize) the cache for the asset type may hold
+        /** Least recently used assets get evicted from the cache when the budget is exceeded, builtins never get evicted.
+        Pass `AssetCacheType::UnlimitedBudget` (the default) to turn eviction off. */
+        inline void setAssetCacheBudget(const IAsset::E_TYPE _type, const size_t _bytes)
+        {
+            m_assetCache[IAsset::typeFlagToIndex(_type)]->setBudget(_bytes);
+        }
+        inline size_t getAssetCacheBudget(const IAsset::E_TYPE _type) const
+        {
+            return m_assetCache[IAsset::typeFlagToIndex(_type)]->getBudget();
+        }
+
+        //! Size, budget, hit and eviction counts of the cache for the asset type
+        inline AssetCacheType::SStatistics getAssetCacheStatistics(const IAsset::E_TYPE _type) const
+        {
+            return m_assetCache[IAsset::typeFlagToIndex(_type)]->getStatistics();
+        }
+        //! Fraction of `findAssets` calls (including the ones made while loading) which found anything
+        inline double getAssetCacheHitRate() const
+        {
+            const uint64_t lookups = m_cacheLookups.load();
+            return lookups ? 1.0-double(m_cacheMisses.load())/double(lookups):0.0;
+        }
+
 
         //! This function does not free the memory consumed by IAssets, but allows you to cache GPU objects already created from given assets so that no unnecessary GPU-side duplicates get created.
         /** Keeping assets around (by their pointers) helps a lot by making sure that the same asset is not converted to a gpu resource multiple times, or created and deleted multiple times.
@@ -807,7 +983,11 @@ class IAssetManager : public core::IReferenceCounted, public core::QuitSignallin
     protected:
         bool insertBuiltinAssetIntoCache(SAssetBundle& _asset)
         {
-            return insertAssetIntoCache(_asset, IAsset::EM_IMMUTABLE);
+            const uint32_t ix = IAsset::typeFlagToIndex(_asset.getAssetType());
+            for (auto ass : _asset.getContents())
+                setAssetMutability(ass.get(), IAsset::EM_IMMUTABLE);
+            constexpr bool Pinned = true;
+            return m_assetCache[ix]->insert(_asset.getCacheKey(), _asset, Pinned);
         }
 
 
@@ -12,6 +12,7 @@
 #include "nbl/asset/bawformat/BlobSerializable.h"
 #include "nbl/asset/format/decodePixels.h"
 #include "nbl/asset/format/encodePixels.h"
+#include "nbl/asset/format/streamSoA.h"
 
 namespace nbl::asset
 {
@@ -618,6 +619,102 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
             return setAttribute(_input, dst, getAttribFormat(attrId));
         }
 
+        //! Decodes a run of vertices of given vertex attribute into structure-of-arrays float channels. WARNING: SAME FORMAT CONVERSION LIMITATIONS AS getAttribute(core::vectorSIMDf&,uint32_t,size_t)!
+        /** Gives the same results as calling getAttribute(core::vectorSIMDf&,uint32_t,size_t) for every vertex, but the format is only resolved once
+        and formats which have a kernel in `nbl/asset/format/streamSoA.h` are decoded 4 vertices at a time.
+        @param[out] outChannels Up to 4 arrays of at least `count` floats, `nullptr` skips the channel.
+        @param[in] attrId Atrribute id.
+        @param[in] count Number of vertices to decode.
+        @param[in] indices Optional index buffer of `indexType`, if given the i-th output is vertex `indices[i]` instead of vertex `i`.
+        @param[in] firstVertex Added to every vertex number, just like `baseVertex` which is applied as well.
+        @returns true if successful or false if an error occured (e.g. any vertex out of range, no attribute specified/bound or given attribute's format conversion to float unsupported).
+        @see @ref getAttribute() setAttributeStream()
+        */
+        inline bool getAttributeStream(float* const outChannels[4], uint32_t attrId, size_t count, const void* indices=nullptr, E_INDEX_TYPE indexType=EIT_UNKNOWN, size_t firstVertex=0u) const
+        {
+            const uint8_t* src = getAttributeStreamPointer(attrId,count,indices,indexType,firstVertex);
+            if (!src)
+                return false;
+
+            const size_t stride = getAttribStride(attrId);
+            const E_FORMAT format = getAttribFormat(attrId);
+            auto decode = [&](const auto* idx) -> bool
+            {
+                if (decodeStreamSoA(format,src,stride,count,outChannels,idx))
+                    return true;
+                if (!isNormalizedFormat(format) && !isFloatingPointFormat(format) && !isScaledFormat(format))
+                    return false;
+                for (size_t i=0u; i<count; i++)
+                {
+                    core::vectorSIMDf output(0.f,0.f,0.f,1.f);
+                    getAttribute(output,src+impl::getStreamElementOffset(idx,i,stride),format);
+                    for (uint32_t c=0u; c<4u; c++)
+                    if (outChannels[c])
+                        outChannels[c][i] = output[c];
+                }
+                return true;
+            };
+            switch (indices ? indexType:EIT_UNKNOWN)
+            {
+                case EIT_16BIT:
+                    return decode(reinterpret_cast<const uint16_t*>(indices));
+                case EIT_32BIT:
+                    return decode(reinterpret_cast<const uint32_t*>(indices));
+                default:
+                    break;
+            }
+            const void* void_null = nullptr;
+            return decode(void_null);
+        }
+
+        //! Encodes structure-of-arrays float channels into a run of vertices of given vertex attribute. WARNING: SAME FORMAT CONVERSION LIMITATIONS AS setAttribute(core::vectorSIMDf,uint32_t,size_t)!
+        /** Bulk counterpart of setAttribute(core::vectorSIMDf,uint32_t,size_t), formats which have a kernel in `nbl/asset/format/streamSoA.h` are encoded 4 vertices at a time.
+        @param[in] inChannels Up to 4 arrays of at least `count` floats, a `nullptr` channel is written as 0 (or 1 for the 4th channel).
+        @param[in] attrId Atrribute id.
+        @param[in] count Number of vertices to encode.
+        @param[in] indices Optional index buffer of `indexType`, if given the i-th input is written to vertex `indices[i]` instead of vertex `i`.
+        @param[in] firstVertex Added to every vertex number, just like `baseVertex` which is applied as well.
+        @returns true if successful or false if an error occured (e.g. any vertex out of range, no attribute specified/bound or given attribute's format conversion from float unsupported).
+        @see @ref setAttribute() getAttributeStream()
+        */
+        inline bool setAttributeStream(const float* const inChannels[4], uint32_t attrId, size_t count, const void* indices=nullptr, E_INDEX_TYPE indexType=EIT_UNKNOWN, size_t firstVertex=0u)
+        {
+            assert(!isImmutable_debug());
+            uint8_t* dst = const_cast<uint8_t*>(getAttributeStreamPointer(attrId,count,indices,indexType,firstVertex));
+            if (!dst)
+                return false;
+
+            const size_t stride = getAttribStride(attrId);
+            const E_FORMAT format = getAttribFormat(attrId);
+            auto encode = [&](const auto* idx) -> bool
+            {
+                if (encodeStreamSoA(format,dst,stride,count,inChannels,idx))
+                    return true;
+                if (!isNormalizedFormat(format) && !isFloatingPointFormat(format) && !isScaledFormat(format))
+                    return false;
+                for (size_t i=0u; i<count; i++)
+                {
+                    core::vectorSIMDf input(0.f,0.f,0.f,1.f);
+                    for (uint32_t c=0u; c<4u; c++)
+                    if (inChannels[c])
+                        input[c] = inChannels[c][i];
+                    setAttribute(input,dst+impl::getStreamElementOffset(idx,i,stride),format);
+                }
+                return true;
+            };
+            switch (indices ? indexType:EIT_UNKNOWN)
+            {
+                case EIT_16BIT:
+                    return encode(reinterpret_cast<const uint16_t*>(indices));
+                case EIT_32BIT:
+                    return encode(reinterpret_cast<const uint32_t*>(indices));
+                default:
+                    break;
+            }
+            const void* void_null = nullptr;
+            return encode(void_null);
+        }
+
         //!
         inline const core::matrix3x4SIMD* getInverseBindPoses() const
         {
@@ -715,6 +812,41 @@ class ICPUMeshBuffer final : public IMeshBuffer<ICPUBuffer,ICPUDescriptorSet,ICP
         }
 
     protected:
+        //! Validates that all `count` (possibly indexed) vertices of the attribute lie inside the bound buffer and returns the pointer to vertex `firstVertex`
+        inline const uint8_t* getAttributeStreamPointer(uint32_t attrId, size_t count, const void* indices, E_INDEX_TYPE indexType, size_t firstVertex) const
+        {
+            if (!m_pipeline)
+                return nullptr;
+            if (!isAttributeEnabled(attrId))
+                return nullptr;
+
+            const uint8_t* ptr = getAttribPointer(attrId);
+            const ICPUBuffer* buf = base_t::getAttribBoundBuffer(attrId).buffer.get();
+            if (!ptr || !buf)
+                return nullptr;
+            ptr += firstVertex*getAttribStride(attrId);
+            if (count==0u)
+                return ptr;
+
+            size_t maxElement = count-1u;
+            if (indices)
+            switch (indexType)
+            {
+                case EIT_16BIT:
+                    maxElement = *std::max_element(reinterpret_cast<const uint16_t*>(indices),reinterpret_cast<const uint16_t*>(indices)+count);
+                    break;
+                case EIT_32BIT:
+                    maxElement = *std::max_element(reinterpret_cast<const uint32_t*>(indices),reinterpret_cast<const uint32_t*>(indices)+count);
+                    break;
+                default:
+                    break;
+            }
+            const uint8_t* lastByte = ptr+maxElement*getAttribStride(attrId)+getTexelOrBlockBytesize(getAttribFormat(attrId));
+            if (lastByte > reinterpret_cast<const uint8_t*>(buf->getPointer())+buf->getSize())
+                return nullptr;
+            return ptr;
+        }
+
         void restoreFromDummy_impl(IAsset* _other, uint32_t _levelsBelow) override
         {
             auto* other = static_cast<ICPUMeshBuffer*>(_other);
@@ -76,6 +76,8 @@
 #include "nbl/asset/interchange/IRenderpassIndependentPipelineLoader.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
 #include "nbl/asset/interchange/IImageWriter.h"
+#include "nbl/asset/interchange/CPNGEncoder.h"
+#include "nbl/asset/interchange/CGLTFWriter.h"
 #include "nbl/asset/metadata/COpenEXRMetadata.h"
 #include "nbl/asset/metadata/CMTLMetadata.h"
 #include "nbl/asset/metadata/COBJMetadata.h"
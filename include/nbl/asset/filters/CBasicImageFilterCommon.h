@@ -9,6 +9,7 @@
 #include "nbl/core/execution.h"
 
 #include <algorithm>
+#include <thread>
 
 #include "nbl/asset/filters/IImageFilter.h"
 
@@ -158,81 +159,60 @@ class CBasicImageFilterCommon
 				}
 		};
 
+		//! Runs `f(blockByteOffset,blockCoord)` on every texel block of every region
+		/**
+			With a parallel policy all the regions, their layers and rows of blocks get flattened into a single iteration space
+			which is cut into batches of roughly equal block counts, so many small regions (cubemap faces, atlases, flattened images)
+			run just as parallel as one big region. That also means `f` may get called concurrently for blocks of different regions.
+		*/
 		template<class ExecutionPolicy, typename F>
-		static inline void executePerBlock(ExecutionPolicy&& policy, const ICPUImage* image, const IImage::SBufferCopy& region, F& f)
+		static inline void executePerBlock(ExecutionPolicy&& policy, const ICPUImage* image, const IImage::SBufferCopy* _begin, const IImage::SBufferCopy* _end, F& f)
 		{
-			const auto& subresource = region.imageSubresource;
-
-			const auto& params = image->getCreationParameters();
-			TexelBlockInfo blockInfo(params.format);
-
-			core::vectorSIMDu32 trueOffset;
-			trueOffset.x = region.imageOffset.x;
-			trueOffset.y = region.imageOffset.y;
-			trueOffset.z = region.imageOffset.z;
-			trueOffset = blockInfo.convertTexelsToBlocks(trueOffset);
-			trueOffset.w = subresource.baseArrayLayer;
-			
-			core::vectorSIMDu32 trueExtent;
-			trueExtent.x = region.imageExtent.width;
-			trueExtent.y = region.imageExtent.height;
-			trueExtent.z = region.imageExtent.depth;
-			trueExtent  = blockInfo.convertTexelsToBlocks(trueExtent);
-			trueExtent.w = subresource.layerCount;
+			const TexelBlockInfo blockInfo(image->getCreationParameters().format);
 
-			const auto strides = region.getByteStrides(blockInfo);
-			
-			auto batch1D = [&f,&region,trueExtent,strides,trueOffset](const std::array<uint32_t,3u>& batchCoord)
+			core::vector<SBlockRegion> regions;
+			regions.reserve(std::distance(_begin,_end));
+			uint64_t totalBlocks = 0ull;
+			for (auto it=_begin; it!=_end; it++)
 			{
-				for (auto xBlock=0u; xBlock<trueExtent.x; ++xBlock)
+				SBlockRegion& region = regions.emplace_back(*it,blockInfo);
+				if (region.rowCount==0u || region.trueExtent.x==0u)
 				{
-					const core::vectorSIMDu32 localCoord(xBlock,batchCoord[0],batchCoord[1],batchCoord[2]);
-					f(region.getByteOffset(localCoord,strides),localCoord+trueOffset);
+					regions.pop_back();
+					continue;
 				}
-			};
-			auto batch2D = [&f,&region,trueExtent,strides,trueOffset](const std::array<uint32_t,2u>& batchCoord)
+				totalBlocks += uint64_t(region.rowCount)*region.trueExtent.x;
+			}
+
+			if constexpr (!std::is_same_v<std::remove_cv_t<std::remove_reference_t<ExecutionPolicy>>,core::execution::sequenced_policy>)
+			if (totalBlocks>=MinBlocksForParallel)
 			{
-				for (auto yBlock=0u; yBlock<trueExtent.y; ++yBlock)
-				for (auto xBlock=0u; xBlock<trueExtent.x; ++xBlock)
+				// aim for a few batches per hardware thread so uneven progress evens out, but keep batches big enough to amortize scheduling
+				const uint64_t threadCount = core::max(std::thread::hardware_concurrency(),1u);
+				const uint64_t blocksPerBatch = core::clamp<uint64_t>(totalBlocks/(threadCount*BatchesPerThread),MinBlocksPerBatch,MaxBlocksPerBatch);
+
+				core::vector<SRowBatch> batches;
+				for (uint32_t i=0u; i<regions.size(); i++)
 				{
-					const core::vectorSIMDu32 localCoord(xBlock,yBlock,batchCoord[0],batchCoord[1]);
-					f(region.getByteOffset(localCoord,strides),localCoord+trueOffset);
+					const auto& region = regions[i];
+					const uint32_t rowsPerBatch = core::max<uint64_t>(blocksPerBatch/region.trueExtent.x,1ull);
+					for (uint32_t row=0u; row<region.rowCount; row+=rowsPerBatch)
+						batches.push_back({i,row,core::min(rowsPerBatch,region.rowCount-row)});
 				}
-			};
-			auto batch3D = [&f,&region,trueExtent,strides,trueOffset](const std::array<uint32_t,1u>& batchCoord)
-			{
-				for (auto zBlock=0u; zBlock<trueExtent.z; ++zBlock)
-				for (auto yBlock=0u; yBlock<trueExtent.y; ++yBlock)
-				for (auto xBlock=0u; xBlock<trueExtent.x; ++xBlock)
+				std::for_each(std::forward<ExecutionPolicy>(policy),batches.begin(),batches.end(),[&regions,&f](const SRowBatch& batch) -> void
 				{
-					const core::vectorSIMDu32 localCoord(xBlock,yBlock,zBlock,batchCoord[0]);
-					f(region.getByteOffset(localCoord,strides),localCoord+trueOffset);
-				}
-			};
-
-			constexpr uint32_t batchSizeThreshold = 0x80u;
-			const core::vectorSIMDu32 spaceFillingEnd(0u,0u,0u,trueExtent.w);
-			if (std::is_same_v<ExecutionPolicy,core::execution::sequenced_policy> || trueExtent.x*trueExtent.y<batchSizeThreshold)
-			{
-				constexpr uint32_t batch_dims = 1u;
-				BlockIterator<batch_dims> begin(trueExtent.pointer+4u-batch_dims);
-				BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd.pointer+4u-batch_dims);
-				std::for_each(std::forward<ExecutionPolicy>(policy),begin,end,batch3D);
-			}
-			else if (trueExtent.x<batchSizeThreshold)
-			{
-				constexpr uint32_t batch_dims = 2u;
-				BlockIterator<batch_dims> begin(trueExtent.pointer+4u-batch_dims);
-				BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd.pointer+4u-batch_dims);
-				std::for_each(std::forward<ExecutionPolicy>(policy),begin,end,batch2D);
-			}
-			else
-			{
-				constexpr uint32_t batch_dims = 3u;
-				BlockIterator<batch_dims> begin(trueExtent.pointer+4u-batch_dims);
-				BlockIterator<batch_dims> end(begin.getExtentBatches(),spaceFillingEnd.pointer+4u-batch_dims);
-				std::for_each(std::forward<ExecutionPolicy>(policy),begin,end,batch1D);
+					regions[batch.region].execute(f,batch.firstRow,batch.rowCount);
+				});
+				return;
 			}
+
+			for (const auto& region : regions)
+				region.execute(f,0u,region.rowCount);
+		}
+		template<class ExecutionPolicy, typename F>
+		static inline void executePerBlock(ExecutionPolicy&& policy, const ICPUImage* image, const IImage::SBufferCopy& region, F& f)
+		{
+			executePerBlock<ExecutionPolicy,F>(std::forward<ExecutionPolicy>(policy),image,&region,&region+1u,f);
 		}
 		template<typename F>
 		static inline void executePerBlock(const ICPUImage* image, const IImage::SBufferCopy& region, F& f)
@@ -242,12 +222,16 @@ class CBasicImageFilterCommon
 
 		struct default_region_functor_t
 		{
+			_NBL_STATIC_INLINE_CONSTEXPR bool IsStateless = true;
+
 			constexpr default_region_functor_t() = default;
 			inline constexpr bool operator()(IImage::SBufferCopy& newRegion, const IImage::SBufferCopy* referenceRegion) const { return true; }
 		};
 		
 		struct clip_region_functor_t
 		{
+			_NBL_STATIC_INLINE_CONSTEXPR bool IsStateless = true;
+
 			clip_region_functor_t(const ICPUImage::SSubresourceLayers& _subresrouce, const IImageFilter::IState::TexelRange& _range, E_FORMAT format) : 
 				subresource(_subresrouce), range(_range), blockInfo(format) {}
 			clip_region_functor_t(const ICPUImage::SSubresourceLayers& _subresrouce, const IImageFilter::IState::TexelRange& _range, const TexelBlockInfo& _blockInfo, uint32_t _blockByteSize) :
@@ -300,6 +284,14 @@ class CBasicImageFilterCommon
 			}
 		};
 		
+		//! A region functor which declares `IsStateless = true` gives the same result no matter when and how often it gets called,
+		//! only then can all the regions get clipped upfront and processed together
+		template<typename G>
+		static inline constexpr bool is_stateless_region_functor_v = requires { requires std::remove_cv_t<G>::IsStateless; };
+
+		//! `g(newRegion,referenceRegion)` can clip or skip each region before `f` runs on its blocks
+		/** With a parallel policy and a stateless `g` (see `is_stateless_region_functor_v`) all regions get processed together as one parallel job,
+		with a stateful `g` (which `f` may depend on) each region is still processed on its own right after `g` got called for it. */
 		template<class ExecutionPolicy, typename F, typename G>
 		static inline void executePerRegion(ExecutionPolicy&& policy,
 											const ICPUImage* image, F& f,
@@ -307,6 +299,19 @@ class CBasicImageFilterCommon
 											const IImage::SBufferCopy* _end,
 											G& g)
 		{
+			if constexpr (is_stateless_region_functor_v<G>)
+			{
+				core::vector<IImage::SBufferCopy> regions;
+				regions.reserve(std::distance(_begin,_end));
+				for (auto it=_begin; it!=_end; it++)
+				{
+					IImage::SBufferCopy region = *it;
+					if (g(region,it))
+						regions.push_back(region);
+				}
+				executePerBlock<ExecutionPolicy,F>(std::forward<ExecutionPolicy>(policy),image,regions.data(),regions.data()+regions.size(),f);
+			}
+			else
 			for (auto it=_begin; it!=_end; it++)
 			{
 				IImage::SBufferCopy region = *it;
@@ -334,6 +339,67 @@ class CBasicImageFilterCommon
 	protected:
 		virtual ~CBasicImageFilterCommon() =0;
 
+		_NBL_STATIC_INLINE_CONSTEXPR uint64_t MinBlocksForParallel = 0x1000ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint64_t MinBlocksPerBatch = 0x400ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint64_t MaxBlocksPerBatch = 0x10000ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint64_t BatchesPerThread = 4ull;
+
+		//! A region in units of texel blocks, its rows of blocks are numbered across all of its depth slices and layers
+		struct SBlockRegion
+		{
+			SBlockRegion(const IImage::SBufferCopy& _region, const TexelBlockInfo& _blockInfo) : region(_region)
+			{
+				const auto& subresource = region.imageSubresource;
+
+				trueOffset.x = region.imageOffset.x;
+				trueOffset.y = region.imageOffset.y;
+				trueOffset.z = region.imageOffset.z;
+				trueOffset = _blockInfo.convertTexelsToBlocks(trueOffset);
+				trueOffset.w = subresource.baseArrayLayer;
+
+				trueExtent.x = region.imageExtent.width;
+				trueExtent.y = region.imageExtent.height;
+				trueExtent.z = region.imageExtent.depth;
+				trueExtent = _blockInfo.convertTexelsToBlocks(trueExtent);
+				trueExtent.w = subresource.layerCount;
+
+				strides = region.getByteStrides(_blockInfo);
+				rowCount = trueExtent.y*trueExtent.z*trueExtent.w;
+			}
+
+			template<typename F>
+			inline void execute(F& f, const uint32_t firstRow, const uint32_t rows) const
+			{
+				if (rows==0u)
+					return;
+				core::vectorSIMDu32 localCoord(0u,firstRow%trueExtent.y,(firstRow/trueExtent.y)%trueExtent.z,firstRow/(trueExtent.y*trueExtent.z));
+				for (uint32_t row=0u; row<rows; row++)
+				{
+					for (localCoord.x=0u; localCoord.x<trueExtent.x; ++localCoord.x)
+						f(region.getByteOffset(localCoord,strides),localCoord+trueOffset);
+					if (++localCoord.y!=trueExtent.y)
+						continue;
+					localCoord.y = 0u;
+					if (++localCoord.z!=trueExtent.z)
+						continue;
+					localCoord.z = 0u;
+					++localCoord.w;
+				}
+			}
+
+			IImage::SBufferCopy region;
+			core::vectorSIMDu32 trueOffset;
+			core::vectorSIMDu32 trueExtent;
+			core::vectorSIMDu32 strides;
+			uint32_t rowCount;
+		};
+		struct SRowBatch
+		{
+			uint32_t region;
+			uint32_t firstRow;
+			uint32_t rowCount;
+		};
+
 		static inline bool validateSubresourceAndRange(	const ICPUImage::SSubresourceLayers& subresource,
 														const IImageFilter::IState::TexelRange& range,
 														const ICPUImage* image)
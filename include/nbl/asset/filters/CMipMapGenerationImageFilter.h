@@ -7,6 +7,9 @@
 
 #include "nbl/core/declarations.h"
 
+#include <atomic>
+#include <numeric>
+
 #include "nbl/asset/filters/CBlitImageFilter.h"
 
 namespace nbl
@@ -22,6 +25,10 @@ namespace asset
 // but iterative application of the filter will give you 2/originalResolution, 6/originalResolution, 14/originalResolution supports
 // the correct usage is to compute the first mip map with a 100% support kernel, then subsequent iterations with 50% smaller pixel supports
 // (actually in the case of using a Gaussian for both resampling and reconstruction, this is equivalent to using a single kernel of 3,3,5,9,..)
+//
+// With Box kernels the filter can also run in `EM_FUSED` mode, where the previous levels never get decoded from the image again:
+// the texels stay in a float working format, several levels get computed per pass out of one tile of a source level,
+// tiles and layers get processed in parallel and every level gets encoded exactly once.
 
 template<typename Swizzle=VoidSwizzle, typename Dither=IdentityDither/*TODO: WhiteNoiseDither*/, typename Normalization=void, bool Clamp=false, class ResamplingKernelX = CKaiserImageFilterKernel<>, class ReconstructionKernelX = CMitchellImageFilterKernel<>, class ResamplingKernelY = ResamplingKernelX, class ReconstructionKernelY = ReconstructionKernelX, class ResamplingKernelZ = ResamplingKernelY, class ReconstructionKernelZ = ReconstructionKernelY>
 class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageFilter<Swizzle,Dither,Normalization,Clamp, ResamplingKernelX,ReconstructionKernelX, ResamplingKernelY,ReconstructionKernelY, ResamplingKernelZ,ReconstructionKernelZ> >, public CBasicImageFilterCommon
@@ -36,8 +43,18 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 	private:
 		using state_base_t = typename CBlitImageFilterBase<typename KernelX::value_type,Swizzle,Dither,Normalization,Clamp>::CStateBase;
 		using pseudo_base_t = CBlitImageFilter<Swizzle,Dither,Normalization,Clamp,KernelX>;
+		using swizzle_base_t = impl::CSwizzleableAndDitherableFilterBase<Swizzle,Dither,Normalization,Clamp>;
 
 	public:
+		enum E_MODE : uint8_t
+		{
+			EM_PER_LEVEL_BLIT = 0u, // every level is a CBlitImageFilter pass over the previous, already encoded, level
+			EM_FUSED // see `executeFused`, falls back to `EM_PER_LEVEL_BLIT` unless `FusionSupported`
+		};
+		//! Fusing levels relies on the hierarchical computation being exact (Box kernels) and on not needing a global normalization prepass
+		_NBL_STATIC_INLINE_CONSTEXPR bool FusionSupported = std::is_void_v<Normalization> &&
+			std::is_same_v<KernelX,CBoxImageFilterKernel> && std::is_same_v<KernelY,CBoxImageFilterKernel> && std::is_same_v<KernelZ,CBoxImageFilterKernel>;
+
 		class CState : public IImageFilter::IState, public state_base_t
 		{
 			public:
@@ -48,12 +65,18 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 				uint32_t							startMipLevel = 1u;
 				uint32_t							endMipLevel = 0u;
 				ICPUImage*							inOutImage = nullptr;
+				E_MODE								mode = EM_PER_LEVEL_BLIT;
+				//! Only used by `EM_FUSED`, filters the color channels of a non-sRGB format as if they were sRGB encoded (sRGB formats always get filtered in linear space)
+				bool								gammaCorrect = false;
 		};
 		using state_type = CState;
 		
 		// since the only thing the mip map generator does is call the blit filter, the scratch memory amount is the same
+		// the fused mode manages its own memory
 		static inline uint32_t getRequiredScratchByteSize(const state_type* state)
 		{
+			if (usesFusedMode(state))
+				return 0u;
 			auto blit = buildBlitState(state,state->startMipLevel);
 			return pseudo_base_t::getRequiredScratchByteSize(&blit);
 		}
@@ -77,6 +100,15 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 			// TODO: remove this later when we can actually write/encode to block formats
 			if (isBlockCompressionFormat(state->inOutImage->getCreationParameters().format))
 				return false;
+
+			if (usesFusedMode(state))
+			{
+				if (state->alphaSemantic>=state_base_t::EAS_COUNT || state->alphaChannel>=4u)
+					return false;
+				if (state->alphaSemantic!=state_base_t::EAS_NONE_OR_PREMULTIPLIED && getFormatChannelCount(params.format)!=4u)
+					return false;
+				return swizzle_base_t::validate(state);
+			}
 			
 			for (auto inMipLevel=state->startMipLevel; inMipLevel!=state->endMipLevel; inMipLevel++)
 			{
@@ -93,6 +125,9 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 			if (!validate(state))
 				return false;
 
+			if (usesFusedMode(state))
+				return executeFused(std::forward<ExecutionPolicy>(policy),state);
+
 			for (auto inMipLevel=state->startMipLevel; inMipLevel!=state->endMipLevel; inMipLevel++)
 			{
 				auto blit = buildBlitState(state, inMipLevel);
@@ -107,6 +142,396 @@ class CMipMapGenerationImageFilter : public CImageFilter<CMipMapGenerationImageF
 		}
 
 	protected:
+		static inline bool usesFusedMode(const state_type* state)
+		{
+			return FusionSupported && state->mode==EM_FUSED;
+		}
+
+		// source texels per axis which a single task of the fused mode works on, by image type
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t FusedTileSize[3] = {4096u,256u,32u};
+		// a box footprint of a ratio below 3 overlaps at most 4 texels
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxFootprint = 4u;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t CoverageHistogramBins = 2048u;
+
+		//! Levels `srcLevel+1` to `srcLevel+levelCount` computed together
+		struct SFusedPass
+		{
+			uint32_t srcLevel;
+			uint32_t levelCount;
+			core::vectorSIMDu32 tileExtent; // in texels of the last level of the pass
+			core::vectorSIMDu32 tileCount;
+		};
+		//! Input texels (relative to the start of the input range) an output texel averages
+		struct SFootprint
+		{
+			uint32_t first;
+			uint32_t count;
+			float weights[MaxFootprint];
+		};
+		//! Float texels of a range of a level, X is the fastest changing coordinate
+		struct SFusedTile
+		{
+			inline void resize(const core::vectorSIMDu32& _begin, const core::vectorSIMDu32& _end)
+			{
+				begin = _begin;
+				extent = _end-_begin;
+				texels.resize(size_t(extent.x)*extent.y*extent.z*4ull);
+			}
+			inline float* operator()(const uint32_t x, const uint32_t y, const uint32_t z)
+			{
+				return texels.data()+((size_t(z)*extent.y+y)*extent.x+x)*4ull;
+			}
+
+			core::vectorSIMDu32 begin;
+			core::vectorSIMDu32 extent;
+			core::vector<float> texels;
+		};
+
+		//! Integer downsampling ratios line texels of consecutive levels up, so as many of those as a tile can hold get fused into one pass,
+		//! a level with a fractional ratio (odd NPOT extent) is a pass of its own
+		static inline core::vector<SFusedPass> planFusedPasses(const state_type* state)
+		{
+			const auto* image = state->inOutImage;
+			const uint32_t tileSize = FusedTileSize[image->getCreationParameters().type];
+
+			core::vector<SFusedPass> passes;
+			for (uint32_t srcLevel=state->startMipLevel-1u; srcLevel+1u<state->endMipLevel;)
+			{
+				SFusedPass& pass = passes.emplace_back();
+				pass.srcLevel = srcLevel;
+				pass.levelCount = 0u;
+				const auto srcExtent = image->getMipSize(srcLevel);
+				for (auto level=srcLevel; level+1u<state->endMipLevel; level++)
+				{
+					const auto inExtent = image->getMipSize(level);
+					const auto outExtent = image->getMipSize(level+1u);
+					const bool integral = inExtent.x%outExtent.x==0u && inExtent.y%outExtent.y==0u && inExtent.z%outExtent.z==0u;
+					if (!integral && pass.levelCount)
+						break;
+					pass.levelCount++;
+					// the tile would get too big for the cache
+					if (!integral || getMaxRatio(srcExtent,outExtent)>=tileSize)
+						break;
+				}
+				srcLevel += pass.levelCount;
+
+				const auto lastExtent = image->getMipSize(srcLevel);
+				for (auto i=0; i<3; i++)
+				{
+					const uint32_t ratio = (srcExtent[i]+lastExtent[i]-1u)/lastExtent[i];
+					pass.tileExtent[i] = core::min(core::max(tileSize/ratio,1u),lastExtent[i]);
+					pass.tileCount[i] = (lastExtent[i]+pass.tileExtent[i]-1u)/pass.tileExtent[i];
+				}
+			}
+			return passes;
+		}
+
+		static inline uint32_t getMaxRatio(const core::vectorSIMDu32& inExtent, const core::vectorSIMDu32& outExtent)
+		{
+			uint32_t retval = 1u;
+			for (auto i=0; i<3; i++)
+				retval = core::max((inExtent[i]+outExtent[i]-1u)/outExtent[i],retval);
+			return retval;
+		}
+		// input texels needed to compute the output texels `[outBegin,outEnd)` along an axis
+		static inline uint32_t footprintBegin(const uint32_t outBegin, const uint32_t inSize, const uint32_t outSize)
+		{
+			return (uint64_t(outBegin)*inSize)/outSize;
+		}
+		static inline uint32_t footprintEnd(const uint32_t outEnd, const uint32_t inSize, const uint32_t outSize)
+		{
+			return (uint64_t(outEnd)*inSize+outSize-1ull)/outSize;
+		}
+		static inline void computeFootprints(const uint32_t inBegin, const uint32_t inSize, const uint32_t outBegin, const uint32_t outEnd, const uint32_t outSize, core::vector<SFootprint>& footprints)
+		{
+			footprints.resize(outEnd-outBegin);
+			const double ratio = double(inSize)/double(outSize);
+			for (auto o=outBegin; o!=outEnd; o++)
+			{
+				auto& footprint = footprints[o-outBegin];
+				const double lo = double(o)*ratio;
+				const double hi = double(o+1u)*ratio;
+				const uint32_t first = footprintBegin(o,inSize,outSize);
+				footprint.first = first-inBegin;
+				footprint.count = footprintEnd(o+1u,inSize,outSize)-first;
+				assert(footprint.count<=MaxFootprint);
+				for (uint32_t i=0u; i<footprint.count; i++)
+					footprint.weights[i] = (core::min(double(first+i+1u),hi)-core::max(double(first+i),lo))/ratio;
+			}
+		}
+		// area weighted box downsampling along one axis
+		static inline void downsampleAxis(SFusedTile& src, SFusedTile& dst, const uint32_t axis, const core::vector<SFootprint>& footprints)
+		{
+			const auto& extent = dst.extent;
+			for (uint32_t z=0u; z<extent.z; z++)
+			for (uint32_t y=0u; y<extent.y; y++)
+			for (uint32_t x=0u; x<extent.x; x++)
+			{
+				uint32_t coord[3] = {x,y,z};
+				const auto& footprint = footprints[coord[axis]];
+				float* const out = dst(x,y,z);
+				std::fill_n(out,4u,0.f);
+				coord[axis] = footprint.first;
+				for (uint32_t i=0u; i<footprint.count; i++,coord[axis]++)
+				{
+					const float* const in = src(coord[0],coord[1],coord[2]);
+					for (auto c=0; c<4; c++)
+						out[c] += in[c]*footprint.weights[i];
+				}
+			}
+		}
+		// finding the region every single texel is slow, consecutive texels tend to be in the same one
+		static inline void* getTexelBlockData(ICPUImage* image, const uint32_t level, const core::vectorSIMDu32& coord, const IImage::SBufferCopy*& region, core::vectorSIMDu32& outBlockCoord)
+		{
+			auto contains = [&coord](const IImage::SBufferCopy* _region) -> bool
+			{
+				if (coord.w<_region->imageSubresource.baseArrayLayer || coord.w>=_region->imageSubresource.baseArrayLayer+_region->imageSubresource.layerCount)
+					return false;
+				for (auto i=0; i<3; i++)
+				{
+					const auto _min = (&_region->imageOffset.x)[i];
+					if (coord[i]<_min || coord[i]>=_min+(&_region->imageExtent.width)[i])
+						return false;
+				}
+				return true;
+			};
+			if (!region || region->imageSubresource.mipLevel!=level || !contains(region))
+				region = image->getRegion(level,coord);
+			if (!region)
+				return nullptr;
+			const core::vectorSIMDu32 inRegionCoord = coord-core::vectorSIMDu32(region->imageOffset.x,region->imageOffset.y,region->imageOffset.z,region->imageSubresource.baseArrayLayer);
+			return image->getTexelBlockData(region,inRegionCoord,outBlockCoord);
+		}
+
+		//! Fused mip chain generation
+		/**
+			Every pass (see `planFusedPasses`) splits its last level into tiles, for every tile and layer one task gathers
+			the texels of the source level in float, then keeps downsampling them in place and encodes each level it computes.
+			Only the last level of a pass is kept as floats for the next pass, the source level of the first pass is the only one ever decoded.
+
+			The downsampling is an area weighted box, hence exact for any ratio and axis wrap modes don't matter.
+			Unlike the per level blit, the swizzle is only applied when decoding the source level.
+
+			For `EAS_REFERENCE_OR_COVERAGE` the alpha of every level gets scaled so that the coverage matches the one of the source level,
+			which takes an extra sweep over every pass to histogram the alpha values before anything gets encoded.
+		*/
+		template<class ExecutionPolicy>
+		static inline bool executeFused(ExecutionPolicy&& policy, state_type* state)
+		{
+			auto* const image = state->inOutImage;
+			const E_FORMAT format = image->getCreationParameters().format;
+			const uint32_t firstLevel = state->startMipLevel-1u;
+			const uint32_t layerCount = state->layerCount;
+			const bool linearize = state->gammaCorrect && !isSRGBFormat(format);
+			const bool nonPremultBlendSemantic = state->alphaSemantic==state_base_t::EAS_SEPARATE_BLEND;
+			const bool coverageSemantic = state->alphaSemantic==state_base_t::EAS_REFERENCE_OR_COVERAGE;
+			const uint32_t alphaChannel = state->alphaChannel;
+			const double alphaRefValue = state->alphaRefValue;
+
+			auto decode = [&](const core::vectorSIMDu32& coord, const IImage::SBufferCopy*& region, float* out) -> void
+			{
+				core::vectorSIMDu32 blockCoord(0u);
+				const void* srcPix[] = {getTexelBlockData(image,firstLevel,coord,region,blockCoord),nullptr,nullptr,nullptr};
+				double decodeBuffer[4] = {0.0,0.0,0.0,0.0};
+				double sample[4] = {0.0,0.0,0.0,0.0};
+				if (srcPix[0])
+					swizzle_base_t::template onDecode<double,double>(format,state,srcPix,decodeBuffer,sample,blockCoord.x,blockCoord.y);
+				for (uint32_t c=0u; c<4u; c++)
+				{
+					if (linearize && c!=alphaChannel && c<3u)
+						sample[c] = core::srgb2lin(sample[c]);
+					if (nonPremultBlendSemantic && c!=alphaChannel)
+						sample[c] *= sample[alphaChannel];
+					out[c] = sample[c];
+				}
+			};
+			auto encode = [&](const uint32_t level, const core::vectorSIMDu32& coord, const IImage::SBufferCopy*& region, const float* in, const double alphaScale) -> void
+			{
+				core::vectorSIMDu32 blockCoord(0u);
+				void* const dstPix = getTexelBlockData(image,level,coord,region,blockCoord);
+				if (!dstPix)
+					return;
+				double sample[4];
+				std::copy_n(in,4u,sample);
+				sample[alphaChannel] *= alphaScale;
+				for (uint32_t c=0u; c<4u; c++)
+				{
+					if (nonPremultBlendSemantic && c!=alphaChannel && sample[alphaChannel]>FLT_MIN*1024.0*512.0)
+						sample[c] /= sample[alphaChannel];
+					if (linearize && c!=alphaChannel && c<3u)
+						sample[c] = core::lin2srgb(sample[c]);
+				}
+				swizzle_base_t::onEncode(format,state,dstPix,sample,coord,blockCoord.x,blockCoord.y,4u);
+			};
+			auto histogramBin = [](const float alpha) -> uint32_t
+			{
+				return core::clamp<int32_t,int32_t>(alpha*float(CoverageHistogramBins),0,int32_t(CoverageHistogramBins)-1);
+			};
+
+			// the fraction of texels at or under the reference alpha in the source level, per layer
+			core::vector<double> inverseCoverage(layerCount,0.0);
+			if (coverageSemantic)
+			{
+				const auto extent = image->getMipSize(firstLevel);
+				core::vector<uint32_t> rows(extent.y*extent.z*layerCount);
+				std::iota(rows.begin(),rows.end(),0u);
+				core::vector<std::atomic_uint32_t> underRef(layerCount);
+				std::for_each(policy,rows.begin(),rows.end(),[&](const uint32_t row) -> void
+				{
+					const uint32_t layer = row/(extent.y*extent.z);
+					core::vectorSIMDu32 coord(0u,row%extent.y,(row/extent.y)%extent.z,state->baseLayer+layer);
+					const IImage::SBufferCopy* region = nullptr;
+					uint32_t count = 0u;
+					for (coord.x=0u; coord.x<extent.x; coord.x++)
+					{
+						float sample[4];
+						decode(coord,region,sample);
+						if (sample[alphaChannel]<=alphaRefValue)
+							count++;
+					}
+					underRef[layer] += count;
+				});
+				for (uint32_t layer=0u; layer<layerCount; layer++)
+					inverseCoverage[layer] = double(underRef[layer])/double(extent.x*extent.y*extent.z);
+			}
+
+			const auto passes = planFusedPasses(state);
+			SFusedTile carry[2]; // last level of the previous pass and of the current one, all layers stacked along Z
+			for (const auto& pass : passes)
+			{
+				const auto lastLevel = pass.srcLevel+pass.levelCount;
+				const auto lastExtent = image->getMipSize(lastLevel);
+				const bool keepLast = lastLevel+1u<state->endMipLevel;
+				if (keepLast)
+					carry[1].resize(core::vectorSIMDu32(0u),lastExtent*core::vectorSIMDu32(1u,1u,layerCount,1u));
+
+				struct STask
+				{
+					uint32_t layer;
+					core::vectorSIMDu32 tile;
+				};
+				core::vector<STask> tasks;
+				tasks.reserve(layerCount*pass.tileCount.x*pass.tileCount.y*pass.tileCount.z);
+				for (uint32_t layer=0u; layer<layerCount; layer++)
+				for (uint32_t z=0u; z<pass.tileCount.z; z++)
+				for (uint32_t y=0u; y<pass.tileCount.y; y++)
+				for (uint32_t x=0u; x<pass.tileCount.x; x++)
+					tasks.push_back({layer,core::vectorSIMDu32(x,y,z)});
+
+				core::vector<std::atomic_uint32_t> histograms(coverageSemantic ? pass.levelCount*layerCount*CoverageHistogramBins:0u);
+				core::vector<double> alphaScales(pass.levelCount*layerCount,1.0);
+				auto runTasks = [&](const bool histogramOnly) -> void
+				{
+					std::for_each(policy,tasks.begin(),tasks.end(),[&](const STask& task) -> void
+					{
+						// texel ranges of every level of the pass, from the last one backwards
+						core::vector<core::vectorSIMDu32> begin(pass.levelCount+1u), end(pass.levelCount+1u);
+						begin[pass.levelCount] = task.tile*pass.tileExtent;
+						end[pass.levelCount] = core::min(begin[pass.levelCount]+pass.tileExtent,lastExtent);
+						for (auto j=pass.levelCount; j; j--)
+						{
+							const auto inExtent = image->getMipSize(pass.srcLevel+j-1u);
+							const auto outExtent = image->getMipSize(pass.srcLevel+j);
+							for (auto i=0; i<3; i++)
+							{
+								begin[j-1u][i] = footprintBegin(begin[j][i],inExtent[i],outExtent[i]);
+								end[j-1u][i] = footprintEnd(end[j][i],inExtent[i],outExtent[i]);
+							}
+						}
+
+						SFusedTile tile, scratch;
+						tile.resize(begin[0],end[0]);
+						const IImage::SBufferCopy* region = nullptr;
+						for (uint32_t z=0u; z<tile.extent.z; z++)
+						for (uint32_t y=0u; y<tile.extent.y; y++)
+						for (uint32_t x=0u; x<tile.extent.x; x++)
+						{
+							const core::vectorSIMDu32 coord(begin[0].x+x,begin[0].y+y,begin[0].z+z,state->baseLayer+task.layer);
+							if (pass.srcLevel==firstLevel)
+								decode(coord,region,tile(x,y,z));
+							else
+								std::copy_n(carry[0](coord.x,coord.y,coord.z+task.layer*image->getMipSize(pass.srcLevel).z),4u,tile(x,y,z));
+						}
+
+						core::vector<SFootprint> footprints;
+						core::vector<uint32_t> histogram(histogramOnly ? CoverageHistogramBins:0u);
+						for (uint32_t j=1u; j<=pass.levelCount; j++)
+						{
+							const auto level = pass.srcLevel+j;
+							const auto inExtent = image->getMipSize(level-1u);
+							const auto outExtent = image->getMipSize(level);
+							for (uint32_t axis=0u; axis<3u; axis++)
+							{
+								if (inExtent[axis]==outExtent[axis])
+									continue;
+								auto scratchEnd = tile.begin+tile.extent;
+								scratchEnd[axis] = end[j][axis];
+								auto scratchBegin = tile.begin;
+								scratchBegin[axis] = begin[j][axis];
+								scratch.resize(scratchBegin,scratchEnd);
+								computeFootprints(tile.begin[axis],inExtent[axis],begin[j][axis],end[j][axis],outExtent[axis],footprints);
+								downsampleAxis(tile,scratch,axis,footprints);
+								std::swap(tile,scratch);
+							}
+
+							const auto scaleIx = (j-1u)*layerCount+task.layer;
+							if (histogramOnly)
+								std::fill(histogram.begin(),histogram.end(),0u);
+							for (uint32_t z=0u; z<tile.extent.z; z++)
+							for (uint32_t y=0u; y<tile.extent.y; y++)
+							for (uint32_t x=0u; x<tile.extent.x; x++)
+							{
+								const float* const texel = tile(x,y,z);
+								if (histogramOnly)
+								{
+									histogram[histogramBin(texel[alphaChannel])]++;
+									continue;
+								}
+								const core::vectorSIMDu32 coord(begin[j].x+x,begin[j].y+y,begin[j].z+z,state->baseLayer+task.layer);
+								encode(level,coord,region,texel,alphaScales[scaleIx]);
+								if (j==pass.levelCount && keepLast)
+									std::copy_n(texel,4u,carry[1](coord.x,coord.y,coord.z+task.layer*outExtent.z));
+							}
+							if (histogramOnly)
+							for (uint32_t b=0u; b<CoverageHistogramBins; b++)
+							if (histogram[b])
+								histograms[scaleIx*CoverageHistogramBins+b] += histogram[b];
+						}
+					});
+				};
+
+				if (coverageSemantic)
+				{
+					runTasks(true);
+					// same trick as the blit, find the alpha value at the rank of the reference value in the source level
+					for (uint32_t j=1u; j<=pass.levelCount; j++)
+					{
+						const auto extent = image->getMipSize(pass.srcLevel+j);
+						const uint64_t texelCount = uint64_t(extent.x)*extent.y*extent.z;
+						for (uint32_t layer=0u; layer<layerCount; layer++)
+						{
+							const auto scaleIx = (j-1u)*layerCount+layer;
+							const auto* histogram = histograms.data()+scaleIx*CoverageHistogramBins;
+							const int64_t rankIndex = core::max<int64_t>(int64_t(inverseCoverage[layer]*double(texelCount))-1ll,0ll);
+							uint64_t count = 0u;
+							uint32_t bin = 0u;
+							for (; bin<CoverageHistogramBins-1u; bin++)
+							{
+								count += histogram[bin];
+								if (count>uint64_t(rankIndex))
+									break;
+							}
+							const double nth = (double(bin)+0.5)/double(CoverageHistogramBins);
+							alphaScales[scaleIx] = alphaRefValue/nth;
+						}
+					}
+				}
+				runTasks(false);
+				std::swap(carry[0],carry[1]);
+			}
+			return true;
+		}
+
 		static inline auto buildBlitState(const state_type* state, uint32_t inMipLevel)
 		{
 			const auto prevLevel = inMipLevel-1u;
@@ -109,22 +109,27 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 						++i;
 					}
 				}
+				// the slabs get filled in one parallel job so they must not overlap, y ones leave out the x slabs and z ones leave out both
 				//y-
 				if (reloffset.y)
 				{
 					extent = paddedExtent;
+					extent.x = state->extentLayerCount.x;
 					extent.y = reloffset.y;
 					memcpy(&borderRegions[i].extent.width, &extent.x, 3u*sizeof(uint32_t));
 					offset = state->outOffsetBaseLayer;
+					offset.x += reloffset.x;
 					memcpy(&borderRegions[i].offset.x, &offset.x, 3u*sizeof(uint32_t));
 					++i;
 				}
 				//y+
 				extent = paddedExtent;
+				extent.x = state->extentLayerCount.x;
 				extent.y -= state->extentLayerCount.y + reloffset.y;
 				if (extent.y)
 				{
 					offset = core::vector3du32_SIMD(0u);
+					offset.x = reloffset.x;
 					offset.y = reloffset.y + state->extent.height;
 					memcpy(&borderRegions[i].extent.width, &extent.x, 3u*sizeof(uint32_t));
 					if (offset.y < paddedExtent.y)
@@ -138,17 +143,26 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 				if (reloffset.z)
 				{
 					extent = paddedExtent;
+					extent.x = state->extentLayerCount.x;
+					extent.y = state->extentLayerCount.y;
 					extent.z = reloffset.z;
 					memcpy(&borderRegions[i].extent.width, &extent.x, 3u*sizeof(uint32_t));
-					borderRegions[i].offset = {0u,0u,0u};
+					offset = state->outOffsetBaseLayer;
+					offset.x += reloffset.x;
+					offset.y += reloffset.y;
+					memcpy(&borderRegions[i].offset.x, &offset.x, 3u*sizeof(uint32_t));
 					++i;
 				}
 				//z+
 				extent = paddedExtent;
+				extent.x = state->extentLayerCount.x;
+				extent.y = state->extentLayerCount.y;
 				extent.z -= state->extentLayerCount.z + reloffset.z;
 				if (extent.z)
 				{
 					offset = core::vector3du32_SIMD(0u);
+					offset.x = reloffset.x;
+					offset.y = reloffset.y;
 					offset.z = reloffset.z + state->extent.depth;
 					memcpy(&borderRegions[i].extent.width, &extent.x, 3u*sizeof(uint32_t));
 					if (offset.z < paddedExtent.z)
@@ -199,6 +213,8 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 					}
 				}
 			};
+			// the border slabs are thin and disjoint, so fill all of them as one job instead of one after the other
+			core::vector<IImage::SBufferCopy> clippedRegions;
 			for (const auto& outreg : state->outImage->getRegions(state->outMipLevel))
 			{
 				for (uint32_t i = 0u; i < borderRegionCount; ++i)
@@ -207,9 +223,10 @@ class CPaddedCopyImageFilter : public CImageFilter<CPaddedCopyImageFilter>, publ
 					clip_region_functor_t clip(subresource, borderRegions[i], state->outImage->getCreationParameters().format);
 					IImage::SBufferCopy clipped_reg = outreg;
 					if (clip(clipped_reg, &outreg))
-						executePerBlock<ExecutionPolicy>(policy,state->outImage,clipped_reg,perBlock);
+						clippedRegions.push_back(clipped_reg);
 				}
 			}
+			executePerBlock<ExecutionPolicy>(policy,state->outImage,clippedRegions.data(),clippedRegions.data()+clippedRegions.size(),perBlock);
 
 			return true;
 		}
@@ -0,0 +1,337 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_STREAM_SOA_H_INCLUDED__
+#define __NBL_ASSET_STREAM_SOA_H_INCLUDED__
+
+#include <type_traits>
+#include <cstdint>
+#include <cstring>
+
+#include "nbl/core/declarations.h"
+#include "nbl/asset/format/EFormat.h"
+
+/*! \file streamSoA.h
+	\brief Bulk conversion of strided (and optionally indexed) attribute streams to and from structure-of-arrays float channels.
+
+	Unlike `decodePixels`/`encodePixels` which go through a runtime format switch and `double` for every element,
+	the format is resolved once per stream and every format with a kernel here is processed 4 elements at a time in SSE registers.
+	Formats without a kernel make the functions return false, so that the caller can fall back to the per-element path.
+*/
+
+namespace nbl
+{
+namespace asset
+{
+	namespace impl
+	{
+		//! Per-format kernels converting one element to/from an XYZW register, missing channels decode as (0,0,0,1) same as in `decodePixels`
+		template<E_FORMAT fmt>
+		struct SStreamSoAKernel;
+
+		template<>
+		struct SStreamSoAKernel<EF_R32_SFLOAT>
+		{
+			static inline __m128 decode(const uint8_t* src)
+			{
+				return _mm_setr_ps(reinterpret_cast<const float*>(src)[0],0.f,0.f,1.f);
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				_mm_store_ss(reinterpret_cast<float*>(dst),v);
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_R32G32_SFLOAT>
+		{
+			static inline __m128 decode(const uint8_t* src)
+			{
+				const __m128 xy = _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(src)));
+				return _mm_movelh_ps(xy,_mm_setr_ps(0.f,1.f,0.f,0.f));
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst),v);
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_R32G32B32_SFLOAT>
+		{
+			// cannot do an unaligned 16 byte load, the last element in the buffer would read out of bounds
+			static inline __m128 decode(const uint8_t* src)
+			{
+				const float* f = reinterpret_cast<const float*>(src);
+				return _mm_setr_ps(f[0],f[1],f[2],1.f);
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				_mm_storel_pi(reinterpret_cast<__m64*>(dst),v);
+				_mm_store_ss(reinterpret_cast<float*>(dst)+2,_mm_movehl_ps(v,v));
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_R32G32B32A32_SFLOAT>
+		{
+			static inline __m128 decode(const uint8_t* src)
+			{
+				return _mm_loadu_ps(reinterpret_cast<const float*>(src));
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				_mm_storeu_ps(reinterpret_cast<float*>(dst),v);
+			}
+		};
+		template<uint32_t chCnt>
+		struct SStreamSoAKernelf16
+		{
+			// no F16C guarantee on our SSE4.2 baseline, so the conversion itself stays scalar
+			static inline __m128 decode(const uint8_t* src)
+			{
+				const uint16_t* h = reinterpret_cast<const uint16_t*>(src);
+				alignas(16) float out[4] = {0.f,0.f,0.f,1.f};
+				for (uint32_t i=0u; i<chCnt; i++)
+					out[i] = core::Float16Compressor::decompress(h[i]);
+				return _mm_load_ps(out);
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				alignas(16) float in[4];
+				_mm_store_ps(in,v);
+				uint16_t* h = reinterpret_cast<uint16_t*>(dst);
+				for (uint32_t i=0u; i<chCnt; i++)
+					h[i] = core::Float16Compressor::compress(in[i]);
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_R16G16_SFLOAT> : SStreamSoAKernelf16<2u> {};
+		template<>
+		struct SStreamSoAKernel<EF_R16G16B16A16_SFLOAT> : SStreamSoAKernelf16<4u> {};
+		//! Scales and truncates in double precision like `encodePixels` does, a float multiply would round differently at the truncation boundaries
+		inline __m128i scaleAndTruncate(__m128 v, __m128d scaleXY, __m128d scaleZW)
+		{
+			const __m128i xy = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(v),scaleXY));
+			const __m128i zw = _mm_cvttpd_epi32(_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(v,v)),scaleZW));
+			return _mm_unpacklo_epi64(xy,zw);
+		}
+
+		template<bool isSigned>
+		struct SStreamSoAKernel8888
+		{
+			_NBL_STATIC_INLINE_CONSTEXPR float scale = isSigned ? 127.f:255.f;
+
+			static inline __m128 decode(const uint8_t* src)
+			{
+				int32_t packed;
+				memcpy(&packed,src,sizeof(packed));
+				const __m128i bytes = _mm_cvtsi32_si128(packed);
+				const __m128i ints = isSigned ? _mm_cvtepi8_epi32(bytes):_mm_cvtepu8_epi32(bytes);
+				return _mm_div_ps(_mm_cvtepi32_ps(ints),_mm_set1_ps(scale));
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				const __m128i ints = scaleAndTruncate(v,_mm_set1_pd(scale),_mm_set1_pd(scale));
+				const __m128i bytes = _mm_shuffle_epi8(ints,_mm_setr_epi8(0,4,8,12,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1,-1));
+				const int32_t packed = _mm_cvtsi128_si32(bytes);
+				memcpy(dst,&packed,sizeof(packed));
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_R8G8B8A8_UNORM> : SStreamSoAKernel8888<false> {};
+		template<>
+		struct SStreamSoAKernel<EF_R8G8B8A8_SNORM> : SStreamSoAKernel8888<true> {};
+		template<bool isSigned>
+		struct SStreamSoAKernel2101010
+		{
+			_NBL_STATIC_INLINE_CONSTEXPR float scale = isSigned ? 511.f:1023.f;
+			_NBL_STATIC_INLINE_CONSTEXPR float alphaScale = isSigned ? 1.f:3.f;
+
+			static inline __m128 decode(const uint8_t* src)
+			{
+				uint32_t packed;
+				memcpy(&packed,src,sizeof(packed));
+				// move every field to the top of its lane, then a single shift by 22 sign (or zero) extends all of them at once
+				__m128i fields = _mm_mullo_epi32(_mm_set1_epi32(packed),_mm_setr_epi32(0x1<<22,0x1<<12,0x1<<2,0x1));
+				fields = _mm_and_si128(fields,_mm_setr_epi32(-1,-1,-1,0xc0000000));
+				fields = isSigned ? _mm_srai_epi32(fields,22):_mm_srli_epi32(fields,22);
+				// the alpha field ended up pre-multiplied by 256
+				return _mm_div_ps(_mm_cvtepi32_ps(fields),_mm_setr_ps(scale,scale,scale,alphaScale*256.f));
+			}
+			static inline void encode(__m128 v, uint8_t* dst)
+			{
+				__m128i fields = scaleAndTruncate(v,_mm_set1_pd(scale),_mm_setr_pd(scale,alphaScale));
+				fields = _mm_and_si128(fields,_mm_setr_epi32(0x3ff,0x3ff,0x3ff,0x3));
+				fields = _mm_mullo_epi32(fields,_mm_setr_epi32(0x1,0x1<<10,0x1<<20,0x1<<30));
+				// fields are disjoint, so OR-reduce the lanes
+				fields = _mm_or_si128(fields,_mm_shuffle_epi32(fields,_MM_SHUFFLE(1,0,3,2)));
+				fields = _mm_or_si128(fields,_mm_shuffle_epi32(fields,_MM_SHUFFLE(2,3,0,1)));
+				const int32_t packed = _mm_cvtsi128_si32(fields);
+				memcpy(dst,&packed,sizeof(packed));
+			}
+		};
+		template<>
+		struct SStreamSoAKernel<EF_A2B10G10R10_UNORM_PACK32> : SStreamSoAKernel2101010<false> {};
+		template<>
+		struct SStreamSoAKernel<EF_A2B10G10R10_SNORM_PACK32> : SStreamSoAKernel2101010<true> {};
+
+
+		template<typename IndexT>
+		inline size_t getStreamElementOffset(const IndexT* indices, size_t i, size_t stride)
+		{
+			if constexpr (std::is_void_v<IndexT>)
+				return i*stride;
+			else
+				return static_cast<size_t>(indices[i])*stride;
+		}
+
+		template<E_FORMAT fmt, typename IndexT>
+		inline void decodeStreamSoA(const uint8_t* src, size_t stride, size_t count, float* const out[4], const IndexT* indices)
+		{
+			using kernel_t = SStreamSoAKernel<fmt>;
+			size_t i=0u;
+			for (; i+4u<=count; i+=4u)
+			{
+				__m128 r0 = kernel_t::decode(src+getStreamElementOffset(indices,i+0u,stride));
+				__m128 r1 = kernel_t::decode(src+getStreamElementOffset(indices,i+1u,stride));
+				__m128 r2 = kernel_t::decode(src+getStreamElementOffset(indices,i+2u,stride));
+				__m128 r3 = kernel_t::decode(src+getStreamElementOffset(indices,i+3u,stride));
+				_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+				if (out[0])
+					_mm_storeu_ps(out[0]+i,r0);
+				if (out[1])
+					_mm_storeu_ps(out[1]+i,r1);
+				if (out[2])
+					_mm_storeu_ps(out[2]+i,r2);
+				if (out[3])
+					_mm_storeu_ps(out[3]+i,r3);
+			}
+			for (; i<count; i++)
+			{
+				alignas(16) float tmp[4];
+				_mm_store_ps(tmp,kernel_t::decode(src+getStreamElementOffset(indices,i,stride)));
+				for (uint32_t c=0u; c<4u; c++)
+				if (out[c])
+					out[c][i] = tmp[c];
+			}
+		}
+
+		template<E_FORMAT fmt, typename IndexT>
+		inline void encodeStreamSoA(uint8_t* dst, size_t stride, size_t count, const float* const in[4], const IndexT* indices)
+		{
+			using kernel_t = SStreamSoAKernel<fmt>;
+			const float defaults[4] = {0.f,0.f,0.f,1.f};
+			size_t i=0u;
+			for (; i+4u<=count; i+=4u)
+			{
+				__m128 r0 = in[0] ? _mm_loadu_ps(in[0]+i):_mm_set1_ps(defaults[0]);
+				__m128 r1 = in[1] ? _mm_loadu_ps(in[1]+i):_mm_set1_ps(defaults[1]);
+				__m128 r2 = in[2] ? _mm_loadu_ps(in[2]+i):_mm_set1_ps(defaults[2]);
+				__m128 r3 = in[3] ? _mm_loadu_ps(in[3]+i):_mm_set1_ps(defaults[3]);
+				_MM_TRANSPOSE4_PS(r0,r1,r2,r3);
+				kernel_t::encode(r0,dst+getStreamElementOffset(indices,i+0u,stride));
+				kernel_t::encode(r1,dst+getStreamElementOffset(indices,i+1u,stride));
+				kernel_t::encode(r2,dst+getStreamElementOffset(indices,i+2u,stride));
+				kernel_t::encode(r3,dst+getStreamElementOffset(indices,i+3u,stride));
+			}
+			for (; i<count; i++)
+			{
+				alignas(16) float tmp[4];
+				for (uint32_t c=0u; c<4u; c++)
+					tmp[c] = in[c] ? in[c][i]:defaults[c];
+				kernel_t::encode(_mm_load_ps(tmp),dst+getStreamElementOffset(indices,i,stride));
+			}
+		}
+	}
+
+	//! Whether `decodeStreamSoA` has a kernel for the format
+	inline bool isStreamSoADecodable(E_FORMAT format)
+	{
+		switch (format)
+		{
+			case EF_R32_SFLOAT:
+			case EF_R32G32_SFLOAT:
+			case EF_R32G32B32_SFLOAT:
+			case EF_R32G32B32A32_SFLOAT:
+			case EF_R16G16_SFLOAT:
+			case EF_R16G16B16A16_SFLOAT:
+			case EF_R8G8B8A8_UNORM:
+			case EF_R8G8B8A8_SNORM:
+			case EF_A2B10G10R10_UNORM_PACK32:
+			case EF_A2B10G10R10_SNORM_PACK32:
+				return true;
+			default:
+				break;
+		}
+		return false;
+	}
+	//! Whether `encodeStreamSoA` has a kernel for the format
+	inline bool isStreamSoAEncodable(E_FORMAT format)
+	{
+		return isStreamSoADecodable(format);
+	}
+
+	//! Decodes `count` elements of a strided stream into up to 4 float channel arrays.
+	/**
+	@param[in] src Pointer to the first element (or the element index 0 refers to, when `indices` are given).
+	@param[in] stride Byte distance between consecutive elements.
+	@param[out] out Channel arrays of at least `count` floats each, any may be `nullptr` to skip that channel.
+	@param[in] indices If not `nullptr` the i-th output element is read from element `indices[i]`, must be `uint16_t`, `uint32_t` or `void` (sequential).
+	@returns false if there's no kernel for the format, nothing is written then.
+	*/
+	template<typename IndexT=void>
+	inline bool decodeStreamSoA(E_FORMAT format, const void* src, size_t stride, size_t count, float* const out[4], const IndexT* indices=nullptr)
+	{
+		static_assert(std::is_void_v<IndexT>||std::is_same_v<IndexT,uint16_t>||std::is_same_v<IndexT,uint32_t>);
+		const uint8_t* ptr = reinterpret_cast<const uint8_t*>(src);
+		switch (format)
+		{
+			case EF_R32_SFLOAT: impl::decodeStreamSoA<EF_R32_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R32G32_SFLOAT: impl::decodeStreamSoA<EF_R32G32_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R32G32B32_SFLOAT: impl::decodeStreamSoA<EF_R32G32B32_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R32G32B32A32_SFLOAT: impl::decodeStreamSoA<EF_R32G32B32A32_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R16G16_SFLOAT: impl::decodeStreamSoA<EF_R16G16_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R16G16B16A16_SFLOAT: impl::decodeStreamSoA<EF_R16G16B16A16_SFLOAT>(ptr,stride,count,out,indices); return true;
+			case EF_R8G8B8A8_UNORM: impl::decodeStreamSoA<EF_R8G8B8A8_UNORM>(ptr,stride,count,out,indices); return true;
+			case EF_R8G8B8A8_SNORM: impl::decodeStreamSoA<EF_R8G8B8A8_SNORM>(ptr,stride,count,out,indices); return true;
+			case EF_A2B10G10R10_UNORM_PACK32: impl::decodeStreamSoA<EF_A2B10G10R10_UNORM_PACK32>(ptr,stride,count,out,indices); return true;
+			case EF_A2B10G10R10_SNORM_PACK32: impl::decodeStreamSoA<EF_A2B10G10R10_SNORM_PACK32>(ptr,stride,count,out,indices); return true;
+			default:
+				break;
+		}
+		return false;
+	}
+
+	//! Encodes `count` elements from up to 4 float channel arrays into a strided stream.
+	/**
+	@param[out] dst Pointer to the first element (or the element index 0 refers to, when `indices` are given).
+	@param[in] stride Byte distance between consecutive elements.
+	@param[in] in Channel arrays of at least `count` floats each, a `nullptr` channel encodes as 0 (or 1 for the 4th channel).
+	@param[in] indices If not `nullptr` the i-th input element is written to element `indices[i]`, must be `uint16_t`, `uint32_t` or `void` (sequential).
+	@returns false if there's no kernel for the format, nothing is written then.
+	*/
+	template<typename IndexT=void>
+	inline bool encodeStreamSoA(E_FORMAT format, void* dst, size_t stride, size_t count, const float* const in[4], const IndexT* indices=nullptr)
+	{
+		static_assert(std::is_void_v<IndexT>||std::is_same_v<IndexT,uint16_t>||std::is_same_v<IndexT,uint32_t>);
+		uint8_t* ptr = reinterpret_cast<uint8_t*>(dst);
+		switch (format)
+		{
+			case EF_R32_SFLOAT: impl::encodeStreamSoA<EF_R32_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R32G32_SFLOAT: impl::encodeStreamSoA<EF_R32G32_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R32G32B32_SFLOAT: impl::encodeStreamSoA<EF_R32G32B32_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R32G32B32A32_SFLOAT: impl::encodeStreamSoA<EF_R32G32B32A32_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R16G16_SFLOAT: impl::encodeStreamSoA<EF_R16G16_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R16G16B16A16_SFLOAT: impl::encodeStreamSoA<EF_R16G16B16A16_SFLOAT>(ptr,stride,count,in,indices); return true;
+			case EF_R8G8B8A8_UNORM: impl::encodeStreamSoA<EF_R8G8B8A8_UNORM>(ptr,stride,count,in,indices); return true;
+			case EF_R8G8B8A8_SNORM: impl::encodeStreamSoA<EF_R8G8B8A8_SNORM>(ptr,stride,count,in,indices); return true;
+			case EF_A2B10G10R10_UNORM_PACK32: impl::encodeStreamSoA<EF_A2B10G10R10_UNORM_PACK32>(ptr,stride,count,in,indices); return true;
+			case EF_A2B10G10R10_SNORM_PACK32: impl::encodeStreamSoA<EF_A2B10G10R10_SNORM_PACK32>(ptr,stride,count,in,indices); return true;
+			default:
+				break;
+		}
+		return false;
+	}
+}
+}
+
+#endif
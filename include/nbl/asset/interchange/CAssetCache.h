@@ -0,0 +1,283 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_ASSET_CACHE_H_INCLUDED__
+#define __NBL_ASSET_C_ASSET_CACHE_H_INCLUDED__
+
+#include <list>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+#include "nbl/system/SReadWriteSpinLock.h"
+#include "nbl/asset/interchange/SAssetBundle.h"
+
+namespace nbl::asset
+{
+
+//! Path-keyed cache of SAssetBundles of a single asset type with a memory budget and least recently used eviction
+/**
+	The keys are not stored in the cache, the index is keyed by the 64bit hash of the key
+	and the only copy of the key string is the one every SAssetBundle keeps anyway, which also resolves hash collisions.
+
+	Every entry is accounted with the bytes of data it keeps alive (see `estimateByteSize`), whenever an insertion
+	makes the total exceed the budget, the least recently used entries get evicted until it fits again.
+	Lookups count as use. Pinned entries (the builtins) never get evicted.
+
+	The recency list always stays ordered from the most to the least recently used, so eviction just pops its back. Lookups only take the shared lock,
+	they move the entries they find to the front under `m_recencyLock` which guards nothing but the links of the list,
+	no other reader walks the list. Pinned entries live in a list of their own, eviction never has to step over them.
+
+	`core::LRUCache` has a fixed entry capacity and one value per key, whereas here many bundles can share a key
+	and the limit is in bytes, so the recency list is kept right here instead.
+*/
+class CAssetCache final
+{
+	public:
+		using greet_func_t = std::function<void(SAssetBundle&)>;
+
+		_NBL_STATIC_INLINE_CONSTEXPR size_t UnlimitedBudget = ~0ull;
+
+		struct SStatistics
+		{
+			size_t entries = 0u;
+			size_t bytes = 0u;
+			size_t budget = UnlimitedBudget;
+			//! lookups which found at least one bundle
+			uint64_t hits = 0u;
+			uint64_t insertions = 0u;
+			uint64_t evictions = 0u;
+			uint64_t evictedBytes = 0u;
+		};
+
+		CAssetCache(greet_func_t&& _greet, greet_func_t&& _dispose) : m_greet(std::move(_greet)), m_dispose(std::move(_dispose)) {}
+		CAssetCache(const CAssetCache&) = delete;
+		CAssetCache& operator=(const CAssetCache&) = delete;
+		~CAssetCache()
+		{
+			clear();
+		}
+
+		//! Bytes of data an asset keeps alive which eviction could release, buffers and images dominate so that's what gets counted
+		static size_t estimateByteSize(const IAsset* _asset);
+		static inline size_t estimateByteSize(const SAssetBundle& _bundle)
+		{
+			size_t retval = 0u;
+			for (const auto& asset : _bundle.getContents())
+				retval += estimateByteSize(asset.get());
+			return retval;
+		}
+
+		//! Returns false if the same bundle is already cached under the key
+		inline bool insert(const std::string& _key, const SAssetBundle& _bundle, const bool _pinned=false)
+		{
+			auto lk = lock_write();
+			const uint64_t hash = hashKey(_key);
+			if (find(hash,_key,_bundle)!=m_index.end())
+				return false;
+
+			auto& list = _pinned ? m_pinned:m_entries;
+			list.emplace_front(hash,_bundle,estimateByteSize(_bundle),_pinned);
+			auto& entry = list.front();
+			entry.bundle.setNewCacheKey(_key);
+			m_greet(entry.bundle);
+			m_index.emplace(hash,list.begin());
+			m_bytes += entry.bytes;
+			m_insertions++;
+
+			evictOverBudget();
+			return true;
+		}
+
+		//! Same semantics as `core::CMultiObjectCache::findAndStoreRange`, the found entries become the most recently used
+		inline bool findAndStoreRange(const std::string& _key, size_t& _inOutStorageSize, SAssetBundle* _out)
+		{
+			auto lk = lock_read();
+			const uint64_t hash = hashKey(_key);
+			auto range = m_index.equal_range(hash);
+			size_t found = 0u;
+			std::unique_lock recency(m_recencyLock,std::defer_lock);
+			for (auto it=range.first; it!=range.second; it++)
+			{
+				if (it->second->bundle.getCacheKey()!=_key)
+					continue;
+				if (_out && found<_inOutStorageSize)
+					_out[found] = it->second->bundle;
+				found++;
+				if (it->second->pinned)
+					continue;
+				if (!recency.owns_lock())
+					recency.lock();
+				// relinks the node, the iterators in `m_index` stay valid
+				m_entries.splice(m_entries.begin(),m_entries,it->second);
+			}
+			if (found)
+				m_hits.fetch_add(1u,std::memory_order_relaxed);
+
+			if (!_out)
+			{
+				_inOutStorageSize = found;
+				return false;
+			}
+			const bool res = _inOutStorageSize<=found;
+			_inOutStorageSize = core::min(_inOutStorageSize,found);
+			return res;
+		}
+
+		inline bool removeObject(const SAssetBundle& _bundle, const std::string& _key)
+		{
+			auto lk = lock_write();
+			auto found = find(hashKey(_key),_key,_bundle);
+			if (found==m_index.end())
+				return false;
+			erase(found->second,true);
+			return true;
+		}
+
+		//! Doesn't greet or dispose, the bundle stays cached
+		inline bool changeObjectKey(const SAssetBundle& _bundle, const std::string& _key, const std::string& _newKey)
+		{
+			auto lk = lock_write();
+			auto found = find(hashKey(_key),_key,_bundle);
+			if (found==m_index.end())
+				return false;
+			const auto entry = found->second;
+			m_index.erase(found);
+			entry->keyHash = hashKey(_newKey);
+			entry->bundle.setNewCacheKey(_newKey);
+			m_index.emplace(entry->keyHash,entry);
+			return true;
+		}
+
+		inline size_t getSize() const
+		{
+			auto lk = lock_read();
+			// lookups change the size of `m_entries` while splicing, the index holds every entry exactly once
+			return m_index.size();
+		}
+
+		inline void clear()
+		{
+			auto lk = lock_write();
+			for (auto* list : {&m_entries,&m_pinned})
+			{
+				for (auto& entry : *list)
+					m_dispose(entry.bundle);
+				list->clear();
+			}
+			m_index.clear();
+			m_bytes = 0u;
+		}
+
+		//! Takes effect immediately, evicting as much as needed
+		inline void setBudget(const size_t _bytes)
+		{
+			auto lk = lock_write();
+			m_budget = _bytes;
+			evictOverBudget();
+		}
+		inline size_t getBudget() const
+		{
+			auto lk = lock_read();
+			return m_budget;
+		}
+
+		inline SStatistics getStatistics() const
+		{
+			auto lk = lock_read();
+			SStatistics retval;
+			retval.entries = m_index.size();
+			retval.bytes = m_bytes;
+			retval.budget = m_budget;
+			retval.hits = m_hits.load(std::memory_order_relaxed);
+			retval.insertions = m_insertions;
+			retval.evictions = m_evictions;
+			retval.evictedBytes = m_evictedBytes;
+			return retval;
+		}
+
+		inline system::SReadWriteSpinLock::SStatistics getLockStatistics() const
+		{
+			return m_lock.getStatistics();
+		}
+
+	private:
+		struct SEntry
+		{
+			SEntry(const uint64_t _keyHash, const SAssetBundle& _bundle, const size_t _bytes, const bool _pinned)
+				: keyHash(_keyHash), bundle(_bundle), bytes(_bytes), pinned(_pinned) {}
+
+			uint64_t keyHash;
+			SAssetBundle bundle;
+			size_t bytes;
+			//! whether it lives in `m_pinned` rather than `m_entries`
+			bool pinned;
+		};
+		using list_t = std::list<SEntry>;
+		using index_t = std::unordered_multimap<uint64_t,list_t::iterator>;
+
+		static inline uint64_t hashKey(const std::string& _key) { return std::hash<std::string_view>()(_key); }
+
+		inline index_t::iterator find(const uint64_t _hash, const std::string& _key, const SAssetBundle& _bundle)
+		{
+			auto range = m_index.equal_range(_hash);
+			for (auto it=range.first; it!=range.second; it++)
+			if (it->second->bundle==_bundle && it->second->bundle.getCacheKey()==_key)
+				return it;
+			return m_index.end();
+		}
+		inline void eraseFromIndex(const list_t::iterator _entry)
+		{
+			auto range = m_index.equal_range(_entry->keyHash);
+			for (auto it=range.first; it!=range.second; it++)
+			if (it->second==_entry)
+			{
+				m_index.erase(it);
+				return;
+			}
+		}
+		inline void erase(const list_t::iterator _entry, const bool _dispose)
+		{
+			eraseFromIndex(_entry);
+			if (_dispose)
+				m_dispose(_entry->bundle);
+			m_bytes -= _entry->bytes;
+			(_entry->pinned ? m_pinned:m_entries).erase(_entry);
+		}
+		inline void evictOverBudget()
+		{
+			// the most recently inserted or used entry is at the front and never gets evicted,
+			// so an asset larger than the whole budget still stays cached until the next insertion
+			while (m_bytes>m_budget && m_entries.size()>1u)
+			{
+				const auto victim = std::prev(m_entries.end());
+				m_evictions++;
+				m_evictedBytes += victim->bytes;
+				erase(victim,true);
+			}
+		}
+
+		inline system::read_lock_guard<> lock_read() const { return system::read_lock_guard<>(m_lock); }
+		inline system::write_lock_guard<> lock_write() const { return system::write_lock_guard<>(m_lock); }
+
+		greet_func_t m_greet, m_dispose;
+		list_t m_entries; // front is the most recently used
+		list_t m_pinned;
+		//! only guards the links of `m_entries` while lookups hold the shared lock, whoever holds the exclusive lock needn't take it
+		std::mutex m_recencyLock;
+		index_t m_index;
+		size_t m_bytes = 0u;
+		size_t m_budget = UnlimitedBudget;
+		std::atomic<uint64_t> m_hits = 0u;
+		uint64_t m_insertions = 0u;
+		uint64_t m_evictions = 0u;
+		uint64_t m_evictedBytes = 0u;
+		mutable system::SReadWriteSpinLock m_lock{system::SReadWriteSpinLock::EP_WRITERS};
+};
+
+}
+
+#endif
@@ -0,0 +1,72 @@
+// Copyright (C) 2020 AnastaZIuk
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in Nabla.h
+
+#ifndef __NBL_ASSET_C_MESH_WRITER_GLTF__
+#define __NBL_ASSET_C_MESH_WRITER_GLTF__
+
+#include "BuildConfigOptions.h"
+
+#ifdef _NBL_COMPILE_WITH_GLTF_WRITER_
+
+#include "nbl/system/ISystem.h"
+#include "nbl/system/IFile.h"
+#include "nbl/asset/ICPUMesh.h"
+#include "nbl/asset/interchange/IAssetWriter.h"
+
+namespace nbl
+{
+	namespace asset
+	{
+		//! glTF Writer capable of writing .gltf files and binary .glb containers
+		/*
+			glTF bridges the gap between 3D content creation tools and modern 3D applications
+			by providing an efficient, extensible, interoperable format for the transmission and loading of 3D content.
+
+			The mesh becomes one glTF mesh with a primitive per meshbuffer, instanced once by the only node of the only scene.
+			Vertex bindings which glTF can address as they are get streamed from the `ICPUBuffer`s into the binary data without a copy,
+			only the attributes with a format or an interleaving glTF doesn't allow get repacked. Buffer views with identical contents
+			are written once, found by their XXHash_256. Materials and skins are not written.
+
+			A .glb file name or `EWF_BINARY` gives a GLB, otherwise the binary data goes to a .bin file next to the .gltf,
+			which `IAssetWriterOverride::getExtraFilePaths` can redirect.
+		*/
+
+		class CGLTFWriter final : public asset::IAssetWriter
+		{
+			protected:
+				virtual ~CGLTFWriter() {}
+
+			public:
+				//! Can be passed through `IAssetWriter::SAssetWriteParams::userData`
+				struct SParams
+				{
+					//! Attributes written as TEXCOORD_0 and COLOR_0, the defaults are the layout of `IGeometryCreator` and the other mesh loaders, `CGLTFLoader` puts UVs at 1 and colors at 2
+					uint32_t uvAttributeIx = 2u;
+					uint32_t colorAttributeIx = 1u;
+				};
+
+				explicit CGLTFWriter(core::smart_refctd_ptr<system::ISystem>&& _system) : m_system(std::move(_system)) {}
+
+				virtual const char** getAssociatedFileExtensions() const override
+				{
+					static const char* extensions[]{ "gltf", "glb", nullptr };
+					return extensions;
+				}
+
+				uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_MESH; }
+
+				uint32_t getSupportedFlags() override { return asset::EWF_BINARY; }
+
+				uint32_t getForcedFlags() override { return asset::EWF_NONE; }
+
+				bool writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+
+			private:
+				core::smart_refctd_ptr<system::ISystem> m_system;
+		};
+	}
+}
+
+#endif // _NBL_COMPILE_WITH_GLTF_WRITER_
+#endif // __NBL_ASSET_C_MESH_WRITER_GLTF__
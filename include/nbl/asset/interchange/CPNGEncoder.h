@@ -0,0 +1,173 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_ASSET_C_PNG_ENCODER_H_INCLUDED_
+#define _NBL_ASSET_C_PNG_ENCODER_H_INCLUDED_
+
+#include <optional>
+
+#include "nbl/core/execution.h"
+#include "nbl/system/IFile.h"
+
+#include "nbl/asset/ICPUImageView.h"
+
+namespace nbl::asset
+{
+
+//! PNG encoder behind `CImageWriterPNG`, which deflates horizontal stripes of the image concurrently
+/**
+	Every stripe gets row filtered and deflated on its own, primed with the last 32 KiB of the stripe above as the dictionary
+	like pigz does, and ends on a byte boundary with a sync flush. So the stripes just get concatenated into one zlib stream,
+	one IDAT chunk per stripe, with the Adler-32 of the whole image combined from the stripes' ones. The output only depends on
+	the `SParams`, never on the thread count, and a single stripe gives the same stream as a plain single threaded encoder.
+
+	`writeBatch` encodes the next image while the ISystem thread writes the previous one to disk.
+
+	An encoder keeps its scratch memory between images, one encoder can't be used from many threads at once.
+*/
+class CPNGEncoder final
+{
+	public:
+		//! PNG row filter types, `EF_ADAPTIVE` picks the one with the smallest sum of absolute differences for every row like libpng does
+		enum E_FILTER : uint8_t
+		{
+			EF_NONE = 0,
+			EF_SUB,
+			EF_UP,
+			EF_AVERAGE,
+			EF_PAETH,
+			EF_ADAPTIVE
+		};
+		//! zlib `Z_DEFAULT_STRATEGY`, `Z_FILTERED`, `Z_RLE` and `Z_HUFFMAN_ONLY`
+		enum E_STRATEGY : uint8_t
+		{
+			ES_DEFAULT = 0,
+			ES_FILTERED,
+			ES_RLE,
+			ES_HUFFMAN_ONLY
+		};
+
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t DefaultStripeSize = 0x1u<<18u;
+		//! zlib's default level
+		_NBL_STATIC_INLINE_CONSTEXPR int32_t DefaultCompressionLevel = -1;
+
+		//! Can be passed to `CImageWriterPNG` through `IAssetWriter::SAssetWriteParams::userData`
+		struct SParams
+		{
+			//! 0 stores, 1 is the fastest and 9 the smallest, `CImageWriterPNG` derives it from the asset compression level with `EWF_COMPRESSED`
+			int32_t compressionLevel = DefaultCompressionLevel;
+			E_FILTER filter = EF_ADAPTIVE;
+			E_STRATEGY strategy = ES_DEFAULT;
+			//! filtered bytes per stripe, rounded to whole rows, 0 makes the entire image one stripe
+			uint32_t stripeSize = DefaultStripeSize;
+		};
+		//! 8 bit rows with 1 (gray), 2 (gray and alpha), 3 (RGB) or 4 (RGBA) channels, top to bottom
+		struct SImage
+		{
+			const uint8_t* data = nullptr;
+			uint32_t width = 0u;
+			uint32_t height = 0u;
+			uint32_t channelCount = 0u;
+			//! in bytes, 0 means tightly packed
+			size_t rowPitch = 0ull;
+		};
+		struct SBatchItem
+		{
+			system::IFile* file = nullptr;
+			const ICPUImageView* imageView = nullptr;
+			//! output, whether the whole file got written
+			bool written = false;
+		};
+
+		//! Converts the first layer and mip level of `imageView` to 8 bit sRGB with 1, 3 or 4 channels, as `CImageWriterPNG` stores them
+		static core::smart_refctd_ptr<ICPUImage> convertForWriting(const ICPUImageView* imageView, const system::logger_opt_ptr logger);
+		//! The rows of an image made by `convertForWriting`
+		static SImage getImage(const ICPUImage* convertedImage);
+
+		//! Encodes `image` into a whole PNG file in `out`, returns false if the image or the parameters are invalid
+		template<class ExecutionPolicy>
+		inline bool encode(ExecutionPolicy&& policy, const SImage& image, const SParams& params, core::vector<uint8_t>& out)
+		{
+			if (!prepare(image,params))
+				return false;
+			// the dictionary of a stripe are the filtered rows of the one above, so all rows get filtered first
+			core::for_each(policy,m_stripes.begin(),m_stripes.end(),[&](SStripe& stripe) -> void {filterStripe(image,params,stripe);});
+			core::for_each(policy,m_stripes.begin(),m_stripes.end(),[&](SStripe& stripe) -> void {compressStripe(params,stripe);});
+			return assemble(image,params,out);
+		}
+		inline bool encode(const SImage& image, const SParams& params, core::vector<uint8_t>& out)
+		{
+			return encode(core::execution::par_unseq,image,params,out);
+		}
+
+		//! Writes every image view to its file from offset 0, returns how many got written
+		/** The next image gets converted and encoded while the ISystem thread writes the previous one, only the write of the one before that gets waited for. */
+		template<class ExecutionPolicy>
+		inline uint32_t writeBatch(ExecutionPolicy&& policy, SBatchItem* begin, SBatchItem* end, const SParams& params, const system::logger_opt_ptr logger=nullptr)
+		{
+			core::vector<uint8_t> files[2];
+			std::optional<system::ISystem::future_t<size_t>> pending[2];
+			SBatchItem* pendingItems[2] = {nullptr,nullptr};
+			uint32_t writtenCount = 0u;
+			auto wait = [&](const uint32_t slot) -> void
+			{
+				if (!pending[slot])
+					return;
+				pendingItems[slot]->written = pending[slot]->get()==files[slot].size();
+				writtenCount += pendingItems[slot]->written;
+				pending[slot].reset();
+			};
+
+			uint32_t slot = 0u;
+			for (auto* item=begin; item!=end; item++,slot^=1u)
+			{
+				wait(slot);
+				item->written = false;
+				if (!item->file || !item->imageView)
+					continue;
+				const auto converted = convertForWriting(item->imageView,logger);
+				if (!converted || !encode(policy,getImage(converted.get()),params,files[slot]))
+				{
+					logger.log("CPNGEncoder: Could not encode %s", system::ILogger::ELL_ERROR, item->file->getFileName().string().c_str());
+					continue;
+				}
+				pending[slot].emplace();
+				pendingItems[slot] = item;
+				item->file->write(*pending[slot],files[slot].data(),0ull,files[slot].size());
+			}
+			wait(0u);
+			wait(1u);
+			return writtenCount;
+		}
+		inline uint32_t writeBatch(SBatchItem* begin, SBatchItem* end, const SParams& params, const system::logger_opt_ptr logger=nullptr)
+		{
+			return writeBatch(core::execution::par_unseq,begin,end,params,logger);
+		}
+
+	private:
+		struct SStripe
+		{
+			uint32_t firstRow;
+			uint32_t rowCount;
+			//! the whole IDAT chunk, length, type and CRC included
+			core::vector<uint8_t> chunk;
+			uint32_t adler;
+			bool failed;
+		};
+
+		//! validates and splits the image into stripes
+		bool prepare(const SImage& image, const SParams& params);
+		void filterStripe(const SImage& image, const SParams& params, SStripe& stripe);
+		void compressStripe(const SParams& params, SStripe& stripe);
+		bool assemble(const SImage& image, const SParams& params, core::vector<uint8_t>& out) const;
+
+		//! filter type byte and filtered bytes of every row
+		core::vector<uint8_t> m_filtered;
+		size_t m_filteredRowSize = 0ull;
+		core::vector<SStripe> m_stripes;
+};
+
+}
+
+#endif
@@ -129,6 +129,38 @@ public:
         system::logger_opt_ptr logger;
     };
 
+    //! The first bytes of a file, read once by the IAssetManager and shared by the signature checks of all loaders
+    struct SFileHeader
+    {
+        _NBL_STATIC_INLINE_CONSTEXPR size_t MaxSize = 128u;
+
+        SFileHeader() = default;
+        explicit SFileHeader(system::IFile* _file)
+        {
+            if (!_file)
+                return;
+            fileSize = _file->getSize();
+            const size_t toRead = core::min(fileSize, MaxSize);
+            system::IFile::success_t success;
+            _file->read(success, data, 0u, toRead);
+            if (success)
+                size = toRead;
+        }
+
+        uint8_t data[MaxSize] = {};
+        //! how many bytes of `data` are valid, less than `MaxSize` if the file is shorter
+        size_t size = 0u;
+        size_t fileSize = 0u;
+    };
+
+    //! Magic bytes which must be present at `offset` in a file for the loader to be able to load it
+    struct SFileSignature
+    {
+        const char* bytes;
+        uint32_t offset;
+        uint32_t size;
+    };
+
     //! Struct for keeping the state of the current loadoperation for safe threading
     struct SAssetLoadContext
     {
@@ -296,6 +328,29 @@ public:
 	//! Returns an array of string literals terminated by nullptr
 	virtual const char** getAssociatedFileExtensions() const = 0;
 
+	//! Returns an array of signatures terminated by one with `size==0`, a file needs to match any of them to be probed with isALoadableFileFormat
+	/** The default of nullptr means the format has no magic number and every file needs to be probed. */
+	virtual const SFileSignature* getFileSignatures() const { return nullptr; }
+
+	//! Cheap rejection of files based on their first bytes, so that potentially expensive isALoadableFileFormat calls only happen on likely candidates
+	/** The default implementation checks getFileSignatures(), override for formats which need a little more logic than a magic number.
+	Must never return false for a file which isALoadableFileFormat would accept. */
+	virtual bool matchesFileHeader(const SFileHeader& _header) const
+	{
+		const SFileSignature* signature = getFileSignatures();
+		if (!signature)
+			return true;
+		for (; signature->size; signature++)
+		{
+			// can't tell from the header, let the probe decide
+			if (signature->offset+signature->size>SFileHeader::MaxSize)
+				return true;
+			if (signature->offset+signature->size<=_header.size && memcmp(_header.data+signature->offset,signature->bytes,signature->size)==0)
+				return true;
+		}
+		return false;
+	}
+
 	//! Returns the assets loaded by the loader
 	/** Bits of the returned value correspond to each IAsset::E_TYPE
 	enumeration member, and the return value cannot be 0. */
@@ -98,6 +98,7 @@ class SAssetBundle
 
 	private:
 		friend class IAssetManager;
+		friend class CAssetCache;
 
 		inline void setNewCacheKey(const std::string& newKey) { m_cacheKey = newKey; }
 		inline void setNewCacheKey(std::string&& newKey) { m_cacheKey = std::move(newKey); }
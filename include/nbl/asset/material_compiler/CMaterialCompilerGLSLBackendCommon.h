@@ -649,11 +649,13 @@ public:
 			{
 				vt->shrink();
 
-				bool success = true;
-				for (commit_t& cm : pendingCommits)
-					success &= commit(cm);
+				core::vector<asset::ICPUVirtualTexture::SPendingCommit> commits;
+				commits.reserve(pendingCommits.size());
+				for (const commit_t& cm : pendingCommits)
+					commits.push_back({cm.addr,cm.image.get(),cm.subresource,cm.uwrap,cm.vwrap,cm.border});
+				const auto stats = vt->commit(core::execution::par_unseq,commits.data(),commits.data()+commits.size());
 				pendingCommits.clear();
-				return success;
+				return stats.failed==0u;
 			}
 
 			core::vector<commit_t> pendingCommits;
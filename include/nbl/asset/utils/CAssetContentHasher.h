@@ -0,0 +1,95 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_ASSET_CONTENT_HASHER_H_INCLUDED__
+#define __NBL_ASSET_C_ASSET_CONTENT_HASHER_H_INCLUDED__
+
+#include "nbl/core/declarations.h"
+
+#include <array>
+
+#include "nbl/asset/IAsset.h"
+
+namespace nbl::asset
+{
+
+//! Content based (Merkle) hashing of ICPU asset DAGs
+/**
+	The hash of an asset is the `core::XXHash_256` of its own parameters followed by the hashes of its children,
+	so two assets hash the same if they and everything they reference have the same contents, no matter where they were loaded from.
+	Buffer payloads are hashed once per buffer and in parallel before the DAG is walked, big ones as a `core::CXXHash256Tree` so their blocks get spread over the cores too.
+
+	Hashes are cached by pointer, the hasher keeps every asset it has hashed alive until `clear()` or its destruction.
+	Modifying an asset invalidates the cached hashes of it and all of its parents, call `clear()` if you do.
+
+	Asset types the hasher doesn't understand hash by identity, so they never compare equal to anything but themselves.
+*/
+class CAssetContentHasher final
+{
+	public:
+		using hash_t = std::array<uint64_t,4>;
+
+		struct SDeduplicationStats
+		{
+			//! distinct assets reachable from the roots before deduplication
+			uint32_t visitedAssets = 0u;
+			//! assets which turned out to be content-equal to an earlier one
+			uint32_t duplicateAssets = 0u;
+			//! parent to child references that were redirected to the first equal asset
+			uint32_t rewiredReferences = 0u;
+			//! sum of the sizes of the duplicate buffers, the memory gets freed once nothing else references them
+			uint64_t duplicateBufferBytes = 0ull;
+			//! sizes of the distinct buffers reachable from the roots before and after, the difference is what the roots stop holding on to
+			//! (a duplicate still referenced from a parent without a setter counts in both), it's freed once the hasher is cleared
+			uint64_t reachableBufferBytesBefore = 0ull;
+			uint64_t reachableBufferBytesAfter = 0ull;
+		};
+
+		//! Returns the content hash of `asset`, a null asset hashes to all zeroes
+		const hash_t& hash(const IAsset* asset);
+
+		//! Makes all content-equal assets in the DAGs rooted at [begin,end) share a single instance
+		/**
+			The roots themselves are replaced by their first equal, children are redirected in their parents wherever the parent
+			is mutable and exposes a setter for the reference (meshes, meshbuffers, pipelines, images and descriptor sets).
+			Image views, pipeline layouts, specialized shaders and descriptor set layouts keep their original children.
+		*/
+		SDeduplicationStats deduplicate(core::smart_refctd_ptr<IAsset>* const begin, core::smart_refctd_ptr<IAsset>* const end);
+
+		//! Drops all cached hashes and the references to the hashed assets
+		inline void clear()
+		{
+			m_hashes.clear();
+			m_payloadHashes.clear();
+		}
+
+		//! Appends the direct children of `asset` in a fixed order, null children included
+		static void getChildren(const IAsset* asset, core::vector<const IAsset*>& children);
+
+	private:
+		struct SCachedHash
+		{
+			core::smart_refctd_ptr<const IAsset> asset;
+			hash_t hash;
+		};
+		struct SHashHasher
+		{
+			inline size_t operator()(const hash_t& h) const { return h[0]; }
+		};
+
+		void hashPayloads(const IAsset* const* roots, const size_t rootCount);
+		static uint64_t getReachableBufferBytes(const core::smart_refctd_ptr<IAsset>* const begin, const core::smart_refctd_ptr<IAsset>* const end);
+		//! expects the payloads to already be hashed
+		const hash_t& merkleHash(const IAsset* asset);
+		void appendParams(const IAsset* asset, core::vector<uint8_t>& record) const;
+		core::smart_refctd_ptr<IAsset> deduplicate(IAsset* asset, core::unordered_map<const IAsset*,core::smart_refctd_ptr<IAsset>>& canonical,
+			core::unordered_map<hash_t,core::smart_refctd_ptr<IAsset>,SHashHasher>& firstOfHash, SDeduplicationStats& stats);
+
+		core::unordered_map<const IAsset*,SCachedHash> m_hashes;
+		core::unordered_map<const IAsset*,hash_t> m_payloadHashes;
+};
+
+}
+
+#endif
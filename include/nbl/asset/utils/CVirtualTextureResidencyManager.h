@@ -0,0 +1,334 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_VIRTUAL_TEXTURE_RESIDENCY_MANAGER_H_INCLUDED__
+#define __NBL_ASSET_C_VIRTUAL_TEXTURE_RESIDENCY_MANAGER_H_INCLUDED__
+
+#include "nbl/core/containers/LRUCache.h"
+
+#include "nbl/asset/ICPUImage.h"
+#include "nbl/asset/utils/IVirtualTexture.h"
+
+namespace nbl::asset
+{
+
+//! Streams the pages of an `IVirtualTexture` in and out of a fixed budget of physical pages
+/**
+    Instead of committing whole textures, only `alloc()` them (that's just page table space), hand them over with `addTexture`
+    and feed the manager with the pages the renderer asked for, usually read back from a feedback buffer. Resident pages are tracked by a `core::LRUCache`,
+    a request for a page which is not resident takes one of the budgeted physical pages or evicts the least recently used page.
+
+    Every call to `processFeedback` produces a batch of page uploads for the streamer and of page table texels to patch,
+    evicted pages get their texels invalidated so lookups fall back to whatever the shader does for non-resident pages.
+    Pages requested in the same batch never evict each other, what doesn't fit into the budget gets dropped until the next batch.
+
+    The physical pages are taken from the resident storage of one format class up-front, through the same allocator commits use,
+    so streamed and committed textures can share a storage. All requests must address page table layers of that format class.
+    The page table texels of a handed over texture point to the manager's pages, so the virtual texture refuses to commit or free it
+    until `removeTexture` hands it back with all of its pages evicted.
+    Not thread-safe.
+*/
+template<class virtual_texture_t>
+class CVirtualTextureResidencyManager final : public core::IReferenceCounted
+{
+    public:
+        using texture_data_t = typename virtual_texture_t::SMasterTextureData;
+
+        struct SPageRequest
+        {
+            uint8_t pgTabLayer;
+            uint8_t mip;
+            //! coordinates of the page table texel at `mip`
+            uint16_t x, y;
+
+            inline uint64_t key() const
+            {
+                return (uint64_t(pgTabLayer)<<40ull)|(uint64_t(mip)<<32ull)|(uint64_t(y)<<16ull)|uint64_t(x);
+            }
+            static inline SPageRequest fromKey(uint64_t _key)
+            {
+                return {static_cast<uint8_t>(_key>>40ull),static_cast<uint8_t>(_key>>32ull),static_cast<uint16_t>(_key),static_cast<uint16_t>(_key>>16ull)};
+            }
+        };
+        //! The streamer has to fill physical page `physPgAddr` (as encoded in the page table) with the texels of the virtual page
+        struct SPageUpload
+        {
+            SPageRequest page;
+            uint32_t physPgAddr;
+        };
+        //! New value for the lower half of the page table texel, the miptail address in the upper half is left alone
+        struct SPageTablePatch
+        {
+            SPageRequest page;
+            uint32_t physPgAddr;
+        };
+        struct SUpdateBatch
+        {
+            core::vector<SPageUpload> uploads;
+            //! sorted by layer, mip and then row, evictions and uploads of the same batch never patch the same texel
+            core::vector<SPageTablePatch> patches;
+
+            inline void clear()
+            {
+                uploads.clear();
+                patches.clear();
+            }
+        };
+        struct SStatistics
+        {
+            //! unique pages requested, a page requested twice in the same batch counts once
+            uint64_t requests = 0ull;
+            uint64_t hits = 0ull;
+            uint64_t misses = 0ull;
+            uint64_t evictions = 0ull;
+            //! misses which could not be serviced because every resident page was requested in the same batch
+            uint64_t dropped = 0ull;
+            //! requests outside of the page table
+            uint64_t invalid = 0ull;
+
+            inline double getHitRate() const
+            {
+                return requests ? double(hits)/double(requests):1.0;
+            }
+        };
+
+        //! Reserves up to `_pageBudget` physical pages from the storage of `_formatClass`, returns nullptr if it doesn't exist or is full
+        static core::smart_refctd_ptr<CVirtualTextureResidencyManager> create(core::smart_refctd_ptr<virtual_texture_t>&& _vt, E_FORMAT_CLASS _formatClass, uint32_t _pageBudget)
+        {
+            if (!_vt || !_vt->getPageTable())
+                return nullptr;
+            auto* storage = _vt->getStorageForFormatClass(_formatClass);
+            if (!storage)
+                return nullptr;
+
+            core::vector<uint32_t> pages(core::min<uint32_t>(_pageBudget,storage->tileAlctr.get_free_size()));
+            storage->allocTiles(pages.size(), pages.data());
+            pages.erase(std::remove(pages.begin(), pages.end(), SPhysPgOffset::invalid_addr), pages.end());
+            // LRUCache needs a capacity of at least 2
+            if (pages.size()<2u)
+            {
+                storage->freeTiles(pages.size(), pages.data());
+                return nullptr;
+            }
+
+            auto* mgr = new CVirtualTextureResidencyManager(std::move(_vt), storage, std::move(pages));
+            return core::smart_refctd_ptr<CVirtualTextureResidencyManager>(mgr, core::dont_grab);
+        }
+
+        //! The manager takes over the physical pages of the texture, which must not be committed
+        bool addTexture(const texture_data_t& _addr)
+        {
+            if (!m_vt->m_streamedTextures.insert(virtual_texture_t::addrToKey(_addr)).second)
+                return false;
+            m_textures.push_back(_addr);
+            return true;
+        }
+
+        //! Evicts every resident page of the texture and hands it back, the virtual texture can free it once the patches are applied
+        bool removeTexture(const texture_data_t& _addr, SUpdateBatch& _outBatch)
+        {
+            auto found = std::find_if(m_textures.begin(), m_textures.end(), [&_addr](const texture_data_t& _tex) {return virtual_texture_t::addrToKey(_tex)==virtual_texture_t::addrToKey(_addr);});
+            if (found==m_textures.end())
+                return false;
+            evictAll(_addr, _outBatch);
+            m_vt->m_streamedTextures.erase(virtual_texture_t::addrToKey(_addr));
+            m_textures.erase(found);
+            return true;
+        }
+
+        //! Marks the resident pages among the requests as used and makes the others resident, appending the work to `_outBatch`
+        void processFeedback(const SPageRequest* _begin, const SPageRequest* _end, SUpdateBatch& _outBatch)
+        {
+            m_keys.clear();
+            for (auto it = _begin; it != _end; ++it)
+            {
+                if (!isValid(*it))
+                {
+                    m_stats.invalid++;
+                    continue;
+                }
+                m_keys.push_back(it->key());
+            }
+            std::sort(m_keys.begin(), m_keys.end());
+            m_keys.erase(std::unique(m_keys.begin(), m_keys.end()), m_keys.end());
+            m_stats.requests += m_keys.size();
+
+            const size_t firstPatch = _outBatch.patches.size();
+            // hits first, so the misses of this batch can only evict pages which weren't requested
+            uint32_t touched = 0u;
+            m_misses.clear();
+            for (const uint64_t key : m_keys)
+            {
+                if (m_cache.get(key))
+                    touched++;
+                else
+                    m_misses.push_back(key);
+            }
+            m_stats.hits += touched;
+
+            for (const uint64_t key : m_misses)
+            {
+                // every resident page is the most recently used now, evicting any would thrash
+                if (touched == m_capacity)
+                {
+                    m_stats.dropped++;
+                    continue;
+                }
+
+                uint32_t physPgAddr;
+                if (m_freePages.size())
+                {
+                    physPgAddr = m_freePages.back();
+                    m_freePages.pop_back();
+                    m_cache.insert(key, physPgAddr);
+                }
+                else
+                {
+                    // the cache is full exactly when the free pages run out, so the insertion evicts the least recently used page
+                    m_cache.insert(key, SPhysPgOffset::invalid_addr);
+                    assert(m_evictedKey != InvalidKey);
+                    physPgAddr = m_evictedPhysPgAddr;
+                    *m_cache.peek(key) = physPgAddr;
+                    _outBatch.patches.push_back({SPageRequest::fromKey(m_evictedKey), SPhysPgOffset::invalid_addr});
+                    m_evictedKey = InvalidKey;
+                    m_stats.evictions++;
+                }
+
+                const auto page = SPageRequest::fromKey(key);
+                _outBatch.uploads.push_back({page, physPgAddr});
+                _outBatch.patches.push_back({page, physPgAddr});
+                m_stats.misses++;
+                touched++;
+            }
+
+            std::sort(_outBatch.patches.begin()+firstPatch, _outBatch.patches.end(), [](const SPageTablePatch& lhs, const SPageTablePatch& rhs) {return lhs.page.key()<rhs.page.key();});
+        }
+
+        //! Makes the page non-resident (e.g. because the texture got freed), returns false if it wasn't resident
+        bool evict(const SPageRequest& _page, SUpdateBatch& _outBatch)
+        {
+            if (!isValid(_page))
+                return false;
+            const uint64_t key = _page.key();
+            const uint32_t* physPgAddr = m_cache.peek(key);
+            if (!physPgAddr)
+                return false;
+
+            m_freePages.push_back(*physPgAddr);
+            // erasing goes through the disposal function too
+            m_cache.erase(key);
+            m_evictedKey = InvalidKey;
+            _outBatch.patches.push_back({_page, SPhysPgOffset::invalid_addr});
+            return true;
+        }
+
+        //! Writes the patches into a CPU page table, the page table of an `IGPUVirtualTexture` needs them uploaded instead
+        static void applyPageTablePatches(ICPUImage* _pageTable, const SPageTablePatch* _begin, const SPageTablePatch* _end)
+        {
+            uint8_t* const bufptr = reinterpret_cast<uint8_t*>(_pageTable->getBuffer()->getPointer());
+            const auto texelBlockInfo = _pageTable->getTexelBlockInfo();
+            for (auto it = _begin; it != _end; ++it)
+            {
+                const auto texelPos = core::vectorSIMDu32(it->page.x, it->page.y, 0u, it->page.pgTabLayer);
+                const auto* region = _pageTable->getRegion(it->page.mip, texelPos);
+                uint32_t& texel = reinterpret_cast<uint32_t*>(bufptr+region->getByteOffset(texelPos, region->getByteStrides(texelBlockInfo)))[0];
+                texel = (texel&~SPhysPgOffset::PAGE_ADDR_MASK)|it->physPgAddr;
+            }
+        }
+
+        //! Physical page the request is resident in, or `SPhysPgOffset::invalid_addr`, doesn't count as use
+        uint32_t getResidentPage(const SPageRequest& _page) const
+        {
+            const uint32_t* physPgAddr = m_cache.peek(_page.key());
+            return physPgAddr ? *physPgAddr:SPhysPgOffset::invalid_addr;
+        }
+
+        uint32_t getPageBudget() const { return m_capacity; }
+        uint32_t getResidentPageCount() const { return m_capacity-m_freePages.size(); }
+        const SStatistics& getStatistics() const { return m_stats; }
+        void resetStatistics() { m_stats = {}; }
+
+    protected:
+        using SPhysPgOffset = typename virtual_texture_t::SPhysPgOffset;
+        using storage_t = typename virtual_texture_t::IVTResidentStorage;
+
+        _NBL_STATIC_INLINE_CONSTEXPR uint64_t InvalidKey = ~0ull;
+
+        CVirtualTextureResidencyManager(core::smart_refctd_ptr<virtual_texture_t>&& _vt, storage_t* _storage, core::vector<uint32_t>&& _pages) :
+            m_vt(std::move(_vt)), m_storage(_storage), m_capacity(_pages.size()), m_reservedPages(std::move(_pages)),
+            m_cache(m_capacity, [this](std::pair<uint64_t,uint32_t>& evicted) {m_evictedKey = evicted.first; m_evictedPhysPgAddr = evicted.second;})
+        {
+            // popped from the back, so pages get used in allocation order
+            m_freePages.assign(m_reservedPages.rbegin(), m_reservedPages.rend());
+            const auto& params = m_vt->getPageTable()->getCreationParameters();
+            m_pgTabExtent = params.extent.width;
+            m_pgTabLayers = params.arrayLayers;
+            m_pgTabMips = params.mipLevels;
+        }
+        ~CVirtualTextureResidencyManager()
+        {
+            // the textures go back to the virtual texture without any pages, a CPU page table gets patched right here, any other has to be thrown away
+            SUpdateBatch batch;
+            for (const auto& texture : m_textures)
+            {
+                evictAll(texture, batch);
+                m_vt->m_streamedTextures.erase(virtual_texture_t::addrToKey(texture));
+            }
+            if constexpr (std::is_same_v<std::remove_pointer_t<decltype(m_vt->getPageTable())>,ICPUImage>)
+                applyPageTablePatches(m_vt->getPageTable(), batch.patches.data(), batch.patches.data()+batch.patches.size());
+            // resident or not, all the pages go back to the storage
+            m_storage->freeTiles(m_reservedPages.size(), m_reservedPages.data());
+        }
+
+        //! Evicts the pages of every level of the texture which takes at least a whole page, the miptail is never streamed
+        inline void evictAll(const texture_data_t& _addr, SUpdateBatch& _outBatch)
+        {
+            const VkExtent3D extent = {static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u};
+            const uint32_t levelCount = core::min<uint32_t>(m_vt->countLevelsTakingAtLeastOnePage(extent), m_pgTabMips);
+            for (uint32_t i = 0u; i < levelCount; ++i)
+            {
+                const uint32_t w = m_vt->neededPageCountForSide(extent.width, i);
+                const uint32_t h = m_vt->neededPageCountForSide(extent.height, i);
+                for (uint32_t y = 0u; y < h; ++y)
+                for (uint32_t x = 0u; x < w; ++x)
+                {
+                    const SPageRequest page = {
+                        static_cast<uint8_t>(_addr.pgTab_layer), static_cast<uint8_t>(i),
+                        static_cast<uint16_t>((_addr.pgTab_x>>i)+x), static_cast<uint16_t>((_addr.pgTab_y>>i)+y)
+                    };
+                    evict(page, _outBatch);
+                }
+            }
+        }
+
+        inline bool isValid(const SPageRequest& _page) const
+        {
+            if (_page.pgTabLayer >= m_pgTabLayers || _page.mip >= m_pgTabMips)
+                return false;
+            const uint32_t extent = m_pgTabExtent>>_page.mip;
+            return _page.x < extent && _page.y < extent;
+        }
+
+        using cache_t = core::LRUCache<uint64_t,uint32_t>;
+
+        core::smart_refctd_ptr<virtual_texture_t> m_vt;
+        storage_t* const m_storage;
+        const uint32_t m_capacity;
+        uint32_t m_pgTabExtent, m_pgTabLayers, m_pgTabMips;
+        // the budget as allocated from the storage, the free ones are a stack
+        const core::vector<uint32_t> m_reservedPages;
+        core::vector<uint32_t> m_freePages;
+        uint64_t m_evictedKey = InvalidKey;
+        uint32_t m_evictedPhysPgAddr = SPhysPgOffset::invalid_addr;
+        cache_t m_cache;
+        SStatistics m_stats;
+        // handed over by `addTexture`
+        core::vector<texture_data_t> m_textures;
+        // scratch
+        core::vector<uint64_t> m_keys, m_misses;
+};
+
+}
+
+#endif
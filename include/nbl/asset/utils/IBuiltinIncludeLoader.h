@@ -6,10 +6,12 @@
 #define __NBL_ASSET_I_BUILTIN_INCLUDE_LOADER_H_INCLUDED__
 
 #include <functional>
-#include <regex>
+#include <mutex>
+#include <string_view>
 
 
 #include "nbl/core/IReferenceCounted.h"
+#include "nbl/system/SReadWriteSpinLock.h"
 
 namespace nbl
 {
@@ -21,20 +23,67 @@ class IBuiltinIncludeLoader : public core::IReferenceCounted
 	protected:
 		using HandleFunc_t = std::function<std::string(const std::string&)>;
 
-		virtual core::vector<std::pair<std::regex, HandleFunc_t>> getBuiltinNamesToFunctionMapping() const = 0;
+		//! A builtin path is matched by a literal prefix followed by exactly `numericArgs` "/<decimal number>" path components
+		struct SBuiltinPattern
+		{
+			//! `numericArgs` value which matches anything after the prefix
+			_NBL_STATIC_INLINE_CONSTEXPR uint32_t AnySuffix = ~0u;
+
+			std::string prefix;
+			uint32_t numericArgs;
+			HandleFunc_t handler;
+			//! whether the handler's result can be remembered for the lifetime of the loader, false for anything read from disk which could get edited
+			bool memoize = true;
+
+			inline bool matches(const std::string_view _name) const
+			{
+				if (_name.substr(0ull,prefix.size())!=prefix)
+					return false;
+				if (numericArgs==AnySuffix)
+					return true;
+
+				auto it = _name.begin()+prefix.size();
+				for (uint32_t i=0u; i<numericArgs; i++)
+				{
+					if (it==_name.end() || *(it++)!='/')
+						return false;
+					const auto digitsBegin = it;
+					while (it!=_name.end() && *it>='0' && *it<='9')
+						it++;
+					if (it==digitsBegin)
+						return false;
+				}
+				return it==_name.end();
+			}
+		};
+
+		//! Patterns are tried in order, gets called only once per loader
+		virtual core::vector<SBuiltinPattern> getBuiltinNamesToFunctionMapping() const = 0;
 
 	public:
 		virtual ~IBuiltinIncludeLoader() = default;
 
 		//! @param _name must be path relative to /nbl/builtin/
+		/** Includes resolved by patterns with `memoize` set are remembered, any other gets resolved again every time. */
 		virtual std::string getBuiltinInclude(const std::string& _name) const
 		{
-			core::vector<std::pair<std::regex, HandleFunc_t>> builtinNames = getBuiltinNamesToFunctionMapping();
+			{
+				system::read_lock_guard<> lock(m_resolvedLock);
+				auto found = m_resolved.find(_name);
+				if (found!=m_resolved.end())
+					return found->second;
+			}
 
-			for (const auto& pattern : builtinNames)
-				if (std::regex_match(_name, pattern.first))
+			std::call_once(m_patternsInit,[this]() -> void {m_patterns = getBuiltinNamesToFunctionMapping();});
+			for (const auto& pattern : m_patterns)
+				if (pattern.matches(_name))
 				{
-					auto a = pattern.second(_name);
+					auto a = pattern.handler(_name);
+					if (pattern.memoize && !a.empty())
+					{
+						system::write_lock_guard<> lock(m_resolvedLock);
+						m_resolved.emplace(_name,a);
+					}
 					return a;
 				}
 
@@ -43,6 +92,12 @@ class IBuiltinIncludeLoader : public core::IReferenceCounted
 
 		//! @returns Path relative to /nbl/builtin/
 		virtual const char* getVirtualDirectoryName() const = 0;
+
+	private:
+		mutable std::once_flag m_patternsInit;
+		mutable core::vector<SBuiltinPattern> m_patterns;
+		mutable system::SReadWriteSpinLock m_resolvedLock;
+		mutable core::unordered_map<std::string,std::string> m_resolved;
 };
 
 }
@@ -5,6 +5,12 @@
 #ifndef __NBL_ASSET_I_CPU_VIRTUAL_TEXTURE_H_INCLUDED__
 #define __NBL_ASSET_I_CPU_VIRTUAL_TEXTURE_H_INCLUDED__
 
+#include <atomic>
+#include <numeric>
+#include <optional>
+
+#include "nbl/core/xxHash256.h"
+
 #include <nbl/asset/utils/IVirtualTexture.h>
 #include <nbl/asset/ICPUImageView.h>
 #include <nbl/asset/ICPUDescriptorSet.h>
@@ -155,6 +161,12 @@ public:
 
     //! Always call this before commit()
     static std::pair<core::smart_refctd_ptr<asset::ICPUImage>, asset::VkExtent3D> createPoTPaddedSquareImageWithMipLevels(const ICPUImage* _img, ISampler::E_TEXTURE_CLAMP _wrapu, ISampler::E_TEXTURE_CLAMP _wrapv, ISampler::E_TEXTURE_BORDER_COLOR _borderColor)
+    {
+        return createPoTPaddedSquareImageWithMipLevels(core::execution::par_unseq, _img, _wrapu, _wrapv, _borderColor);
+    }
+    //! Pass a sequential policy when padding many images in parallel yourself
+    template<class ExecutionPolicy>
+    static std::pair<core::smart_refctd_ptr<asset::ICPUImage>, asset::VkExtent3D> createPoTPaddedSquareImageWithMipLevels(ExecutionPolicy&& policy, const ICPUImage* _img, ISampler::E_TEXTURE_CLAMP _wrapu, ISampler::E_TEXTURE_CLAMP _wrapv, ISampler::E_TEXTURE_BORDER_COLOR _borderColor)
     {
         if (!_img)
             return { nullptr, asset::VkExtent3D{0u,0u,0u} };
@@ -211,7 +223,7 @@ public:
         copy.inImage = _img;
         copy.outImage = paddedImg.get();
 
-        asset::CPaddedCopyImageFilter::execute(core::execution::par_unseq,&copy);
+        asset::CPaddedCopyImageFilter::execute(policy,&copy);
 
         using mip_gen_filter_t = asset::CMipMapGenerationImageFilter<
             VoidSwizzle,IdentityDither,void/*TODO: whitenoise*/,false,
@@ -233,7 +245,7 @@ public:
             genmips.axisWraps[1] = _wrapv;
             genmips.axisWraps[2] = asset::ISampler::ETC_CLAMP_TO_EDGE;
             genmips.borderColor = _borderColor;
-            mip_gen_filter_t::execute(core::execution::par_unseq,&genmips);
+            mip_gen_filter_t::execute(policy,&genmips);
             _NBL_ALIGNED_FREE(genmips.scratchMemory);
         }
 
@@ -266,8 +278,262 @@ public:
 
     }
 
-    // TODO: thread safe commits?
+    //! Same as the batched `commit` for a single texture, which has to be already padded with `createPoTPaddedSquareImageWithMipLevels`
     bool commit(const SMasterTextureData& _addr, const ICPUImage* _img, const IImage::SSubresourceRange& _subres, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor) override 
+    {
+        if (isStreamed(_addr))
+            return false;
+        // the contents are unknown from now on, the next incremental commit at this address must not be skipped
+        m_committedHashes.erase(addrToKey(_addr));
+
+        STextureCommit texture;
+        texture.owner = 0u;
+        core::vector<SPageCopy> copies;
+        if (!preparePageCopies(_addr, _img, _subres, _uwrap, _vwrap, _borderColor, texture, copies))
+            return false;
+
+        std::atomic_bool success = true;
+        executePageCopies(core::execution::par_unseq, copies.data(), copies.data()+copies.size(), [&success](uint32_t) {success = false;});
+        assert(success);
+        if (!success)
+            freePhysicalPages(_addr);
+        return success;
+    }
+
+    //! Texture to commit in a batch, unlike the single texture `commit` the image must NOT be padded yet
+    struct SPendingCommit
+    {
+        SMasterTextureData addr;
+        const ICPUImage* image;
+        IImage::SSubresourceRange subresource;
+        ISampler::E_TEXTURE_CLAMP uwrap;
+        ISampler::E_TEXTURE_CLAMP vwrap;
+        ISampler::E_TEXTURE_BORDER_COLOR border;
+    };
+    struct SCommitStatistics
+    {
+        uint32_t committed = 0u;
+        //! skipped by an incremental commit because neither the image nor the commit parameters changed since the last commit at the same address
+        uint32_t unchanged = 0u;
+        uint32_t failed = 0u;
+    };
+    //! Pads, mip-maps and commits a batch of textures allocated with `alloc()`
+    /**
+        Every stage runs in parallel across the whole batch, the padding and mip-mapping of each image, the page allocation
+        and page table writes of each texture (physical pages come from a thread-safe allocator) and finally the padded copies of all pages.
+
+        With `_incremental` the contents of every texture are hashed and a texture which hashes the same as when it was last committed
+        to the same address gets skipped, so the first commit at an address has to be incremental too for the later ones to be able to skip it.
+        Recommitting to an address frees the physical pages it occupied before, so does a failed commit.
+        Not thread-safe with respect to `alloc()`, `free()` and other commits.
+    */
+    template<class ExecutionPolicy>
+    SCommitStatistics commit(ExecutionPolicy&& policy, const SPendingCommit* _begin, const SPendingCommit* _end, const bool _incremental = false)
+    {
+        SCommitStatistics stats;
+        const uint32_t count = std::distance(_begin, _end);
+        if (count == 0u)
+            return stats;
+
+        core::vector<uint32_t> ix(count);
+        std::iota(ix.begin(), ix.end(), 0u);
+        // hashing reads every texel, so it's only worth it when something can get skipped
+        core::vector<std::optional<hash_t>> hashes(count);
+        if (_incremental)
+            std::for_each(policy, ix.begin(), ix.end(), [&](uint32_t i) {hashes[i] = hashCommit(_begin[i]);});
+
+        core::vector<uint32_t> pending;
+        pending.reserve(count);
+        for (uint32_t i = 0u; i < count; ++i)
+        {
+            if (isStreamed(_begin[i].addr))
+            {
+                stats.failed++;
+                continue;
+            }
+            auto found = m_committedHashes.find(addrToKey(_begin[i].addr));
+            if (found != m_committedHashes.end())
+            {
+                if (_incremental && found->second.has_value() && found->second == hashes[i])
+                {
+                    stats.unchanged++;
+                    continue;
+                }
+                freePhysicalPages(_begin[i].addr);
+                m_committedHashes.erase(found);
+            }
+            pending.push_back(i);
+        }
+
+        // a pending texture can fail at any stage, so the flag has to be atomic for the last one
+        core::vector<std::atomic_bool> failed(pending.size());
+        core::vector<core::smart_refctd_ptr<ICPUImage>> padded(pending.size());
+        core::vector<STextureCommit> textures(pending.size());
+        core::vector<core::vector<SPageCopy>> copies(pending.size());
+        ix.resize(pending.size());
+        std::for_each(policy, ix.begin(), ix.end(), [&](uint32_t j)
+        {
+            const SPendingCommit& cm = _begin[pending[j]];
+            padded[j] = createPoTPaddedSquareImageWithMipLevels(core::execution::seq, cm.image, cm.uwrap, cm.vwrap, cm.border).first;
+            textures[j].owner = j;
+            failed[j] = !padded[j] || !preparePageCopies(cm.addr, padded[j].get(), cm.subresource, cm.uwrap, cm.vwrap, cm.border, textures[j], copies[j]);
+        });
+
+        core::vector<SPageCopy> allCopies;
+        {
+            size_t copyCount = 0ull;
+            for (const auto& c : copies)
+                copyCount += c.size();
+            allCopies.reserve(copyCount);
+            for (auto& c : copies)
+            {
+                allCopies.insert(allCopies.end(), c.begin(), c.end());
+                core::vector<SPageCopy>().swap(c);
+            }
+        }
+        executePageCopies(policy, allCopies.data(), allCopies.data()+allCopies.size(), [&failed](uint32_t j) {failed[j] = true;});
+
+        for (uint32_t j = 0u; j < pending.size(); ++j)
+        {
+            if (failed[j])
+            {
+                // the pages are only allocated once the texture made it through validation
+                if (textures[j].physicalStorage)
+                    freePhysicalPages(_begin[pending[j]].addr);
+                stats.failed++;
+                continue;
+            }
+            m_committedHashes.insert({addrToKey(_begin[pending[j]].addr), hashes[pending[j]]});
+            stats.committed++;
+        }
+        return stats;
+    }
+
+    SViewAliasTextureData createAlias(const SMasterTextureData& _addr, E_FORMAT _viewingFormat, const IImage::SSubresourceRange& _subresRelativeToMaster) override
+    {
+        if (!validateAliasCreation(_addr, _viewingFormat, _subresRelativeToMaster))
+            return SViewAliasTextureData::invalid();
+
+        const VkExtent3D extent = {
+            static_cast<uint32_t>(_addr.origsize_x>>_subresRelativeToMaster.baseArrayLayer),
+            static_cast<uint32_t>(_addr.origsize_y>>_subresRelativeToMaster.baseArrayLayer),
+            1u};
+        SMasterTextureData aliasAddr = alloc(_viewingFormat, VkExtent3D{static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u}, _subresRelativeToMaster, ISampler::ETC_CLAMP_TO_BORDER, ISampler::ETC_CLAMP_TO_BORDER);
+        if (SMasterTextureData::is_invalid(aliasAddr))
+            return SViewAliasTextureData::invalid();
+        aliasAddr.wrap_x = _addr.wrap_x;
+        aliasAddr.wrap_y = _addr.wrap_y;
+
+        CCopyImageFilter::state_type copy;
+        copy.inImage = m_pageTable.get();
+        copy.outImage = m_pageTable.get();
+        copy.outBaseLayer = aliasAddr.pgTab_layer;
+        copy.inBaseLayer = _addr.pgTab_layer;
+        copy.layerCount = 1u;
+        for (uint32_t i = 0u; i < _subresRelativeToMaster.levelCount; ++i)
+        {
+            copy.inMipLevel = _subresRelativeToMaster.baseMipLevel+i;
+            copy.outMipLevel = i;
+            copy.extent = {std::max<uint32_t>(extent.width>>i,1u), std::max<uint32_t>(extent.height>>i,1u), 1u};
+            copy.inOffset = {static_cast<uint32_t>(_addr.pgTab_x>>(copy.inMipLevel)),static_cast<uint32_t>(_addr.pgTab_y>>(copy.inMipLevel)),0u};
+            copy.outOffset = {static_cast<uint32_t>(aliasAddr.pgTab_x>>i), static_cast<uint32_t>(aliasAddr.pgTab_y>>i), 0u};
+
+            CCopyImageFilter::execute(core::execution::par_unseq,&copy);
+        }
+
+        //nasty trick
+        return reinterpret_cast<SViewAliasTextureData*>(&aliasAddr)[0];
+    }
+
+    //! Fails for textures handed over to a `CVirtualTextureResidencyManager`, its pages aren't the virtual texture's to free
+    bool free(const SMasterTextureData& _addr) override
+    {
+        if (isStreamed(_addr))
+            return false;
+        m_committedHashes.erase(addrToKey(_addr));
+
+        //free physical pages
+        if (!freePhysicalPages(_addr))
+            return false;
+
+        //free entries in page table
+        if (!base_t::free(_addr))
+            return false;
+
+        return true;
+    }
+
+    auto getDSlayoutBindings(ICPUDescriptorSetLayout::SBinding* _outBindings, core::smart_refctd_ptr<ICPUSampler>* _outSamplers, uint32_t _pgtBinding = 0u, uint32_t _fsamplersBinding = 1u, uint32_t _isamplersBinding = 2u, uint32_t _usamplersBinding = 3u) const
+    {
+        return getDSlayoutBindings_internal<ICPUDescriptorSetLayout>(_outBindings, _outSamplers, _pgtBinding, _fsamplersBinding, _isamplersBinding, _usamplersBinding);
+    }
+
+    auto getDescriptorSetWrites(ICPUDescriptorSet::SWriteDescriptorSet* _outWrites, ICPUDescriptorSet::SDescriptorInfo* _outInfo, ICPUDescriptorSet* _dstSet, uint32_t _pgtBinding = 0u, uint32_t _fsamplersBinding = 1u, uint32_t _isamplersBinding = 2u, uint32_t _usamplersBinding = 3u) const
+    {
+        return getDescriptorSetWrites_internal<ICPUDescriptorSet>(_outWrites, _outInfo, _dstSet, _pgtBinding, _fsamplersBinding, _isamplersBinding, _usamplersBinding);
+    }
+
+protected:
+    using hash_t = std::array<uint64_t,4>;
+
+    //! What the padded copies of all pages of a texture have in common
+    struct STextureCommit
+    {
+        const ICPUImage* image;
+        ICPUImage* physicalStorage;
+        VkExtent3D extent;
+        IImage::SSubresourceRange subresource;
+        ISampler::E_TEXTURE_CLAMP uwrap;
+        ISampler::E_TEXTURE_CLAMP vwrap;
+        ISampler::E_TEXTURE_BORDER_COLOR border;
+        //! index of the texture within the batch
+        uint32_t owner;
+    };
+    struct SPageCopy
+    {
+        const STextureCommit* texture;
+        //! texel offset of the padded tile (or miptail rectangle) in the physical storage, z is the layer
+        core::vector3du32_SIMD physPg;
+        uint32_t level;
+        uint32_t x, y;
+    };
+
+    //! Hashes everything the padding reads from the image plus the commit parameters
+    static hash_t hashCommit(const SPendingCommit& _commit)
+    {
+        core::vector<uint64_t> record;
+        if (const ICPUImage* img = _commit.image)
+        {
+            const auto& params = img->getCreationParameters();
+            record.insert(record.end(), {params.format,params.extent.width,params.extent.height,params.extent.depth,params.mipLevels,params.arrayLayers});
+            for (const auto& region : img->getRegions())
+                record.insert(record.end(), {
+                    region.bufferOffset,region.bufferRowLength,region.bufferImageHeight,
+                    region.imageSubresource.mipLevel,region.imageSubresource.baseArrayLayer,region.imageSubresource.layerCount,
+                    region.imageOffset.x,region.imageOffset.y,region.imageOffset.z,
+                    region.imageExtent.width,region.imageExtent.height,region.imageExtent.depth
+                });
+            if (const auto* buffer = img->getBuffer())
+            {
+                hash_t contents;
+                core::XXHash_256(buffer->getPointer(), buffer->getSize(), contents.data());
+                record.insert(record.end(), contents.begin(), contents.end());
+            }
+        }
+        record.insert(record.end(), {
+            _commit.subresource.baseMipLevel,_commit.subresource.levelCount,_commit.subresource.baseArrayLayer,_commit.subresource.layerCount,
+            static_cast<uint64_t>(_commit.uwrap),static_cast<uint64_t>(_commit.vwrap),static_cast<uint64_t>(_commit.border)
+        });
+
+        hash_t retval;
+        core::XXHash_256(record.data(), record.size()*sizeof(uint64_t), retval.data());
+        return retval;
+    }
+
+    //! Allocates all physical pages of the texture at once, fills its page table entries and appends the copies which fill the pages to `_outCopies`
+    //! Textures own disjoint parts of the page table, so this can run concurrently for different textures
+    //! `_outTexture` must outlive the appended copies
+    bool preparePageCopies(const SMasterTextureData& _addr, const ICPUImage* _img, const IImage::SSubresourceRange& _subres, ISampler::E_TEXTURE_CLAMP _uwrap, ISampler::E_TEXTURE_CLAMP _vwrap, ISampler::E_TEXTURE_BORDER_COLOR _borderColor, STextureCommit& _outTexture, core::vector<SPageCopy>& _outCopies)
     {
         if (!validateCommit(_addr, _subres, _uwrap, _vwrap))
             return false;
@@ -276,7 +542,6 @@ public:
 
         ICPUVTResidentStorage* storage = nullptr;
         {
-            uint32_t layer = pgtOffset.z;
             E_FORMAT format = getFormatInLayer(pgtOffset.z);
             E_FORMAT_CLASS fc = getFormatClass(format);
             auto found = m_storage.find(fc);
@@ -289,26 +554,26 @@ public:
 
         const uint32_t levelsTakingAtLeastOnePageCount = countLevelsTakingAtLeastOnePage(extent);
         const uint32_t levelsToPack = std::min<uint32_t>(_subres.levelCount, m_pageTable->getCreationParameters().mipLevels+m_pgSzxy_log2);
+        const bool hasMiptail = levelsTakingAtLeastOnePageCount < _subres.levelCount;
 
-        uint32_t miptailPgAddr = SPhysPgOffset::invalid_addr;
-
-        using phys_pg_addr_alctr_t = ICPUVTResidentStorage::phys_pg_addr_alctr_t;
-
-        if (levelsTakingAtLeastOnePageCount < _subres.levelCount)
-        {
-            uint32_t miptailPgAddr_tmp = phys_pg_addr_alctr_t::invalid_address;
-            const uint32_t szAndAlignment = 1u;
-            core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(storage->tileAlctr, 1u, &miptailPgAddr_tmp, &szAndAlignment, &szAndAlignment, nullptr);
-            miptailPgAddr_tmp = (miptailPgAddr_tmp == phys_pg_addr_alctr_t::invalid_address) ? SPhysPgOffset::invalid_addr : storage->encodePageAddress(miptailPgAddr_tmp);
-
-            miptailPgAddr = miptailPgAddr_tmp;
-        }
+        // take the allocator's lock once per texture, the miptail page comes first
+        core::vector<uint32_t> physPgAddrs(hasMiptail ? 1u:0u);
+        for (uint32_t i = 0u; i < std::min(levelsToPack,levelsTakingAtLeastOnePageCount); ++i)
+            physPgAddrs.resize(physPgAddrs.size()+neededPageCountForSide(extent.width,i)*neededPageCountForSide(extent.height,i));
+        storage->allocTiles(physPgAddrs.size(), physPgAddrs.data());
+        const uint32_t miptailPgAddr = hasMiptail ? physPgAddrs.front():SPhysPgOffset::invalid_addr;
+        auto nextPgAddr = physPgAddrs.begin()+(hasMiptail ? 1u:0u);
 
         const bool wholeTexGoesToMiptailPage = (levelsTakingAtLeastOnePageCount == 0u);
 
-        //TODO up to this line, it's kinda common code for CPU and GPU, refactor later
+        _outTexture.image = _img;
+        _outTexture.physicalStorage = storage->image.get();
+        _outTexture.extent = extent;
+        _outTexture.subresource = _subres;
+        _outTexture.uwrap = _uwrap;
+        _outTexture.vwrap = _vwrap;
+        _outTexture.border = _borderColor;
 
-        // TODO: parallelize over all 3 for loops
         for (uint32_t i = 0u; i < levelsToPack; ++i)
         {
             const uint32_t w = neededPageCountForSide(extent.width, i);
@@ -317,20 +582,13 @@ public:
             for (uint32_t y = 0u; y < h; ++y)
                 for (uint32_t x = 0u; x < w; ++x)
                 {
-                    uint32_t physPgAddr = phys_pg_addr_alctr_t::invalid_address;
+                    uint32_t physPgAddr = SPhysPgOffset::invalid_addr;
                     if (i>=levelsTakingAtLeastOnePageCount) // this `if` always executes in case of whole texture going into miptail page
                         physPgAddr = miptailPgAddr;
                     else
-                    {
-                        const uint32_t szAndAlignment = 1u;
-                        core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_alloc_addr(storage->tileAlctr, 1u, &physPgAddr, &szAndAlignment, &szAndAlignment, nullptr);
-                        if (physPgAddr == phys_pg_addr_alctr_t::invalid_address)
-                            physPgAddr = SPhysPgOffset::invalid_addr;
-                        else
-                            physPgAddr = storage->encodePageAddress(physPgAddr);
-                    }
+                        physPgAddr = *(nextPgAddr++);
 
-                    if (i==(levelsTakingAtLeastOnePageCount-1u) && levelsTakingAtLeastOnePageCount<_subres.levelCount)
+                    if (i==(levelsTakingAtLeastOnePageCount-1u) && hasMiptail)
                     {
                         assert(w==1u && h==1u);
      
@@ -360,44 +618,7 @@ public:
                     const core::vector2du32_SIMD miptailOffset = (i>=levelsTakingAtLeastOnePageCount) ? core::vector2du32_SIMD(m_miptailOffsets[i-levelsTakingAtLeastOnePageCount].x,m_miptailOffsets[i-levelsTakingAtLeastOnePageCount].y) : core::vector2du32_SIMD(0u,0u);
                     physPg += miptailOffset;
 
-                    CPaddedCopyImageFilter::state_type copy;
-                    copy.outOffsetBaseLayer = (physPg).xyzz();/*physPg.z is layer*/ copy.outOffset.z = 0u;
-                    copy.inOffsetBaseLayer = core::vector2du32_SIMD(x,y)*m_pgSzxy;
-                    copy.extentLayerCount = core::vectorSIMDu32(m_pgSzxy, m_pgSzxy, 1u, 1u);
-                    copy.relativeOffset = {0u,0u,0u};
-                    if (x == w-1u)
-                        copy.extentLayerCount.x = std::max<uint32_t>(extent.width>>i,1u)-copy.inOffsetBaseLayer.x;
-                    if (y == h-1u)
-                        copy.extentLayerCount.y = std::max<uint32_t>(extent.height>>i,1u)-copy.inOffsetBaseLayer.y;
-                    memcpy(&copy.paddedExtent.width,(copy.extentLayerCount+core::vectorSIMDu32(2u*m_tilePadding)).pointer, 2u*sizeof(uint32_t));
-                    copy.paddedExtent.depth = 1u;
-                    if (w>1u)
-                        copy.extentLayerCount.x += m_tilePadding;
-                    if (x>0u && x<w-1u)
-                        copy.extentLayerCount.x += m_tilePadding;
-                    if (h>1u)
-                        copy.extentLayerCount.y += m_tilePadding;
-                    if (y>0u && y<h-1u)
-                        copy.extentLayerCount.y += m_tilePadding;
-                    if (x == 0u)
-                        copy.relativeOffset.x = m_tilePadding;
-                    else
-                        copy.inOffsetBaseLayer.x -= m_tilePadding;
-                    if (y == 0u)
-                        copy.relativeOffset.y = m_tilePadding;
-                    else
-                        copy.inOffsetBaseLayer.y -= m_tilePadding;
-                    copy.inOffsetBaseLayer.w = _subres.baseArrayLayer;
-                    copy.inMipLevel = _subres.baseMipLevel + i;
-                    copy.outMipLevel = 0u;
-                    copy.inImage = _img;
-                    copy.outImage = storage->image.get();
-                    copy.axisWraps[0] = _uwrap;
-                    copy.axisWraps[1] = _vwrap;
-                    copy.axisWraps[2] = ISampler::ETC_CLAMP_TO_EDGE;
-                    copy.borderColor = _borderColor;
-                    if (!CPaddedCopyImageFilter::execute(core::execution::par_unseq,&copy))
-                        assert(false);
+                    _outCopies.push_back({&_outTexture,physPg,i,x,y});
                 }
         }
 
@@ -416,68 +637,22 @@ public:
         return true;
     }
 
-    SViewAliasTextureData createAlias(const SMasterTextureData& _addr, E_FORMAT _viewingFormat, const IImage::SSubresourceRange& _subresRelativeToMaster) override
-    {
-        if (!validateAliasCreation(_addr, _viewingFormat, _subresRelativeToMaster))
-            return SViewAliasTextureData::invalid();
-
-        const VkExtent3D extent = {
-            static_cast<uint32_t>(_addr.origsize_x>>_subresRelativeToMaster.baseArrayLayer),
-            static_cast<uint32_t>(_addr.origsize_y>>_subresRelativeToMaster.baseArrayLayer),
-            1u};
-        SMasterTextureData aliasAddr = alloc(_viewingFormat, VkExtent3D{static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u}, _subresRelativeToMaster, ISampler::ETC_CLAMP_TO_BORDER, ISampler::ETC_CLAMP_TO_BORDER);
-        if (SMasterTextureData::is_invalid(aliasAddr))
-            return SViewAliasTextureData::invalid();
-        aliasAddr.wrap_x = _addr.wrap_x;
-        aliasAddr.wrap_y = _addr.wrap_y;
-
-        CCopyImageFilter::state_type copy;
-        copy.inImage = m_pageTable.get();
-        copy.outImage = m_pageTable.get();
-        copy.outBaseLayer = aliasAddr.pgTab_layer;
-        copy.inBaseLayer = _addr.pgTab_layer;
-        copy.layerCount = 1u;
-        for (uint32_t i = 0u; i < _subresRelativeToMaster.levelCount; ++i)
-        {
-            copy.inMipLevel = _subresRelativeToMaster.baseMipLevel+i;
-            copy.outMipLevel = i;
-            copy.extent = {std::max<uint32_t>(extent.width>>i,1u), std::max<uint32_t>(extent.height>>i,1u), 1u};
-            copy.inOffset = {static_cast<uint32_t>(_addr.pgTab_x>>(copy.inMipLevel)),static_cast<uint32_t>(_addr.pgTab_y>>(copy.inMipLevel)),0u};
-            copy.outOffset = {static_cast<uint32_t>(aliasAddr.pgTab_x>>i), static_cast<uint32_t>(aliasAddr.pgTab_y>>i), 0u};
-
-            CCopyImageFilter::execute(core::execution::par_unseq,&copy);
-        }
-
-        //nasty trick
-        return reinterpret_cast<SViewAliasTextureData*>(&aliasAddr)[0];
-    }
-
-    bool free(const SMasterTextureData& _addr) override
+    //! Frees the physical pages the page table entries of the texture point to and invalidates the entries, so freeing twice is harmless
+    bool freePhysicalPages(const SMasterTextureData& _addr)
     {
         const E_FORMAT format = getFormatInLayer(_addr.pgTab_layer);
         ICPUVTResidentStorage* storage = static_cast<ICPUVTResidentStorage*>(getStorageForFormatClass(getFormatClass(format)));
         if (!storage)
             return false;
 
-        //free physical pages
         VkExtent3D extent = {static_cast<uint32_t>(_addr.origsize_x), static_cast<uint32_t>(_addr.origsize_y), 1u};
 
-#ifdef _NBL_DEBUG
-        CFillImageFilter::state_type fill;
-        fill.outImage = m_pageTable.get();
-        fill.subresource.aspectMask = static_cast<IImage::E_ASPECT_FLAGS>(0);
-        fill.subresource.baseArrayLayer = _addr.pgTab_layer;
-        fill.subresource.layerCount = 1u;
-        fill.fillValue.asUint.x = SPhysPgOffset::invalid_addr;
-#endif
-
-        using phys_pg_addr_alctr_t = ICPUVTResidentStorage::phys_pg_addr_alctr_t;
-
         uint32_t addrsOffset = 0u;
-        std::fill(m_addrsArray->begin(), m_addrsArray->end(), IVTResidentStorage::phys_pg_addr_alctr_t::invalid_address);
+        std::fill(m_addrsArray->begin(), m_addrsArray->end(), SPhysPgOffset::invalid_addr);
 
         auto* const bufptr = reinterpret_cast<uint8_t*>(m_pageTable->getBuffer()->getPointer());
-        auto levelCount = core::max(_addr.maxMip,1u);
+        // same level count as the commit, `maxMip` is one too few for non-PoT textures
+        const uint32_t levelCount = core::max(countLevelsTakingAtLeastOnePage(extent),1u);
         for (uint32_t i=0u; i<levelCount; ++i)
         {
             const uint32_t w = neededPageCountForSide(extent.width, i);
@@ -498,37 +673,77 @@ public:
                         assert(i==levelCount-1u && w==1u && h==1u);
                         (*m_addrsArray)[addrsOffset + y*w + x + 1u] = physPgOffset.mipTailAddr().addr;
                     }
+                    *texelptr = SPhysPgOffset::invalid_addr|(SPhysPgOffset::invalid_addr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH);
                 }
 
             addrsOffset += w*h;
-#ifdef _NBL_DEBUG
-            fill.subresource.mipLevel = i;
-            fill.outRange.offset = {static_cast<uint32_t>(_addr.pgTab_x>>i),static_cast<uint32_t>(_addr.pgTab_y>>i),0u};
-            fill.outRange.extent = {w,h,1u};
-            CFillImageFilter::execute(&fill);
-#endif
         }
 
-        core::address_allocator_traits<phys_pg_addr_alctr_t>::multi_free_addr(storage->tileAlctr, m_addrsArray->size(), m_addrsArray->data(), m_addrsArray->data());
-
-        //free entries in page table
-        if (!base_t::free(_addr))
-            return false;
-
+        storage->freeTiles(m_addrsArray->size(), m_addrsArray->data());
         return true;
     }
 
-    auto getDSlayoutBindings(ICPUDescriptorSetLayout::SBinding* _outBindings, core::smart_refctd_ptr<ICPUSampler>* _outSamplers, uint32_t _pgtBinding = 0u, uint32_t _fsamplersBinding = 1u, uint32_t _isamplersBinding = 2u, uint32_t _usamplersBinding = 3u) const
+
+    void fillPageCopyState(const SPageCopy& _pageCopy, CPaddedCopyImageFilter::state_type& copy) const
     {
-        return getDSlayoutBindings_internal<ICPUDescriptorSetLayout>(_outBindings, _outSamplers, _pgtBinding, _fsamplersBinding, _isamplersBinding, _usamplersBinding);
+        const STextureCommit& texture = *_pageCopy.texture;
+        const VkExtent3D& extent = texture.extent;
+        const uint32_t i = _pageCopy.level;
+        const uint32_t x = _pageCopy.x;
+        const uint32_t y = _pageCopy.y;
+        const uint32_t w = neededPageCountForSide(extent.width, i);
+        const uint32_t h = neededPageCountForSide(extent.height, i);
+
+        copy.outOffsetBaseLayer = (_pageCopy.physPg).xyzz();/*physPg.z is layer*/ copy.outOffset.z = 0u;
+        copy.inOffsetBaseLayer = core::vector2du32_SIMD(x,y)*m_pgSzxy;
+        copy.extentLayerCount = core::vectorSIMDu32(m_pgSzxy, m_pgSzxy, 1u, 1u);
+        copy.relativeOffset = {0u,0u,0u};
+        if (x == w-1u)
+            copy.extentLayerCount.x = std::max<uint32_t>(extent.width>>i,1u)-copy.inOffsetBaseLayer.x;
+        if (y == h-1u)
+            copy.extentLayerCount.y = std::max<uint32_t>(extent.height>>i,1u)-copy.inOffsetBaseLayer.y;
+        memcpy(&copy.paddedExtent.width,(copy.extentLayerCount+core::vectorSIMDu32(2u*m_tilePadding)).pointer, 2u*sizeof(uint32_t));
+        copy.paddedExtent.depth = 1u;
+        if (w>1u)
+            copy.extentLayerCount.x += m_tilePadding;
+        if (x>0u && x<w-1u)
+            copy.extentLayerCount.x += m_tilePadding;
+        if (h>1u)
+            copy.extentLayerCount.y += m_tilePadding;
+        if (y>0u && y<h-1u)
+            copy.extentLayerCount.y += m_tilePadding;
+        if (x == 0u)
+            copy.relativeOffset.x = m_tilePadding;
+        else
+            copy.inOffsetBaseLayer.x -= m_tilePadding;
+        if (y == 0u)
+            copy.relativeOffset.y = m_tilePadding;
+        else
+            copy.inOffsetBaseLayer.y -= m_tilePadding;
+        copy.inOffsetBaseLayer.w = texture.subresource.baseArrayLayer;
+        copy.inMipLevel = texture.subresource.baseMipLevel + i;
+        copy.outMipLevel = 0u;
+        copy.inImage = texture.image;
+        copy.outImage = texture.physicalStorage;
+        copy.axisWraps[0] = texture.uwrap;
+        copy.axisWraps[1] = texture.vwrap;
+        copy.axisWraps[2] = ISampler::ETC_CLAMP_TO_EDGE;
+        copy.borderColor = texture.border;
     }
 
-    auto getDescriptorSetWrites(ICPUDescriptorSet::SWriteDescriptorSet* _outWrites, ICPUDescriptorSet::SDescriptorInfo* _outInfo, ICPUDescriptorSet* _dstSet, uint32_t _pgtBinding = 0u, uint32_t _fsamplersBinding = 1u, uint32_t _isamplersBinding = 2u, uint32_t _usamplersBinding = 3u) const
+    //! Every copy fills its own tile (or its own rectangle of a miptail tile) so all of them can run concurrently, even across textures
+    template<class ExecutionPolicy, typename OnFailure>
+    void executePageCopies(ExecutionPolicy&& policy, const SPageCopy* _begin, const SPageCopy* _end, OnFailure&& _onFailure) const
     {
-        return getDescriptorSetWrites_internal<ICPUDescriptorSet>(_outWrites, _outInfo, _dstSet, _pgtBinding, _fsamplersBinding, _isamplersBinding, _usamplersBinding);
+        std::for_each(policy, _begin, _end, [this,&_onFailure](const SPageCopy& pageCopy)
+        {
+            CPaddedCopyImageFilter::state_type copy;
+            fillPageCopyState(pageCopy, copy);
+            if (!CPaddedCopyImageFilter::execute(core::execution::seq,&copy))
+                _onFailure(pageCopy.texture->owner);
+        });
     }
 
-protected:
     core::smart_refctd_ptr<ICPUImageView> createPageTableView() const override
     {
         return ICPUImageView::create(createPageTableViewCreationParams());
@@ -549,6 +764,9 @@ protected:
     {
         return core::make_smart_refctd_ptr<ICPUSampler>(_params);
     }
+
+    //! content hashes of the textures committed by the batched `commit`, keyed by their `SMasterTextureData`, empty if the commit wasn't incremental
+    core::unordered_map<uint64_t,std::optional<hash_t>> m_committedHashes;
 };
 
 }}
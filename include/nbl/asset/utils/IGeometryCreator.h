@@ -115,6 +115,39 @@ class IGeometryCreator : public core::IReferenceCounted
 
 		virtual return_type createIcoSphere(float radius = 1.0f, uint32_t subdivision = 1, bool smooth = false) const = 0;
 
+		//! Cached counterparts of the create methods above
+		/**
+			Only the first call with given parameters generates the geometry, every later one gives back the very same `ICPUBuffer`s.
+			They are `IAsset::EM_IMMUTABLE` like any other asset in the asset manager's cache, clone them before modifying anything.
+			The cached results are kept until `clearCache` or the destruction of the creator. The cached methods are safe to call from many threads
+			and alongside anything else, the results get generated one at a time with a normal quantization cache of the creator's own.
+		*/
+		virtual return_type getCachedCubeMesh(const core::vector3df& size=core::vector3df(5.f,5.f,5.f)) const =0;
+
+		virtual return_type getCachedArrowMesh(const uint32_t tesselationCylinder = 4,
+				const uint32_t tesselationCone = 8, const float height = 1.f,
+				const float cylinderHeight = 0.6f, const float widthCylinder = 0.05f,
+				const float widthCone = 0.3f, const video::SColor colorCylinder = 0xFFFFFFFF,
+				const video::SColor colorCone = 0xFFFFFFFF) const =0;
+
+		virtual return_type getCachedSphereMesh(float radius = 5.f, uint32_t polyCountX = 16, uint32_t polyCountY = 16) const =0;
+
+		virtual return_type getCachedCylinderMesh(float radius, float length, uint32_t tesselation, const video::SColor& color=video::SColor(0xffffffff)) const =0;
+
+		virtual return_type getCachedConeMesh(float radius, float length, uint32_t tesselation,
+				const video::SColor& colorTop=video::SColor(0xffffffff),
+				const video::SColor& colorBottom=video::SColor(0xffffffff),
+				float oblique=0.f) const =0;
+
+		virtual return_type getCachedRectangleMesh(const core::vector2df_SIMD& size = core::vector2df_SIMD(0.5f, 0.5f)) const = 0;
+
+		virtual return_type getCachedDiskMesh(float radius, uint32_t tesselation) const = 0;
+
+		virtual return_type getCachedIcoSphere(float radius = 1.0f, uint32_t subdivision = 1, bool smooth = false) const = 0;
+
+		//! Drops the references to every cached result, buffers still in use elsewhere stay alive
+		virtual void clearCache() const = 0;
+
 };
 
 } // end namespace asset
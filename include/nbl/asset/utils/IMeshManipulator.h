@@ -378,6 +378,59 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 
 			if (indexCountOverride==0u)
       { indexCountOverride = meshbuffer->getIndexCount(); }
+			if (!indexBufferOverride)
+				indexBufferOverride = meshbuffer->getIndices();
+			if (indexTypeOverride>EIT_UNKNOWN)
+				indexTypeOverride = meshbuffer->getIndexType();
+
+			// without skinning the positions can be decoded in bulk through the index buffer and reduced 4 at a time
+			auto streamImpl = [meshbuffer,posAttrId,&aabb,indexCountOverride,indexBufferOverride,indexTypeOverride]() -> bool
+			{
+				constexpr uint32_t BatchSize = 1024u;
+				float positions[3][BatchSize];
+				float* const outChannels[4] = {positions[0],positions[1],positions[2],nullptr};
+				const void* indices = indexTypeOverride!=EIT_UNKNOWN ? indexBufferOverride:nullptr;
+				const uint32_t indexSize = indexTypeOverride==EIT_32BIT ? sizeof(uint32_t):sizeof(uint16_t);
+
+				core::vectorSIMDf minPt[3] = {core::vectorSIMDf(FLT_MAX),core::vectorSIMDf(FLT_MAX),core::vectorSIMDf(FLT_MAX)};
+				core::vectorSIMDf maxPt[3] = {core::vectorSIMDf(-FLT_MAX),core::vectorSIMDf(-FLT_MAX),core::vectorSIMDf(-FLT_MAX)};
+				for (uint32_t j=0u; j<indexCountOverride; j+=BatchSize)
+				{
+					const uint32_t count = core::min(BatchSize,indexCountOverride-j);
+					bool success;
+					if (indices)
+						success = meshbuffer->getAttributeStream(outChannels,posAttrId,count,reinterpret_cast<const uint8_t*>(indices)+size_t(j)*indexSize,indexTypeOverride);
+					else
+						success = meshbuffer->getAttributeStream(outChannels,posAttrId,count,nullptr,EIT_UNKNOWN,j);
+					if (!success)
+						return false;
+					// pad with duplicates, they don't change the extremes
+					const uint32_t paddedCount = core::roundUp(count,4u);
+					for (uint32_t c=0u; c<3u; c++)
+					{
+						std::fill(positions[c]+count,positions[c]+paddedCount,positions[c][0]);
+						for (uint32_t i=0u; i<paddedCount; i+=4u)
+						{
+							const core::vectorSIMDf v(positions[c]+i);
+							minPt[c] = core::min(minPt[c],v);
+							maxPt[c] = core::max(maxPt[c],v);
+						}
+					}
+				}
+				for (uint32_t i=0u; i<4u; i++)
+				{
+					aabb.addInternalPoint(minPt[0].pointer[i],minPt[1].pointer[i],minPt[2].pointer[i]);
+					aabb.addInternalPoint(maxPt[0].pointer[i],maxPt[1].pointer[i],maxPt[2].pointer[i]);
+				}
+				return true;
+			};
+			if (!computeJointAABBs && indexCountOverride)
+			{
+				if (streamImpl())
+					return aabb;
+				// some vertex could not be decoded, let the per-vertex path deal with it
+				aabb = core::aabbox3df(FLT_MAX,FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX,-FLT_MAX);
+			}
 
 			auto impl = [meshbuffer,computeJointAABBs,&aabb,indexCountOverride](const auto* indexPtr, auto* jointAABBs) -> void
 			{
@@ -427,10 +480,6 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 				}
 			};
 
-			if (!indexBufferOverride)
-				indexBufferOverride = meshbuffer->getIndices();
-			if (indexTypeOverride>EIT_UNKNOWN)
-				indexTypeOverride = meshbuffer->getIndexType();
 			void* void_null = nullptr;
 			switch (indexTypeOverride)
 			{
@@ -469,11 +518,23 @@ class IMeshManipulator : public virtual core::IReferenceCounted
     {
       auto vtxCount = meshBuffer->getIndexCount();
 
-      std::vector<core::vectorSIMDf> vtxList;
-      vtxList.reserve(vtxCount);
+      std::vector<core::vectorSIMDf> vtxList(vtxCount,core::vectorSIMDf(0.f,0.f,0.f,1.f));
 
-      for(auto i = 0u; i < vtxCount; i++)
-      { vtxList.push_back(meshBuffer->getPosition(i)); }
+      // decode through the index buffer in bulk, an unindexed meshbuffer gets the vertices in order
+      {
+        core::vector<float> positions(size_t(vtxCount)*3u);
+        float* const outChannels[4] = {positions.data(),positions.data()+vtxCount,positions.data()+2u*vtxCount,nullptr};
+        if(meshBuffer->getAttributeStream(outChannels,meshBuffer->getPositionAttributeIx(),vtxCount,meshBuffer->getIndices(),meshBuffer->getIndexType()))
+        {
+          for(auto i = 0u; i < vtxCount; i++)
+          { vtxList[i] = core::vectorSIMDf(outChannels[0][i],outChannels[1][i],outChannels[2][i],1.f); }
+        }
+        else
+        {
+          for(auto i = 0u; i < vtxCount; i++)
+          { vtxList[i] = meshBuffer->getPosition(meshBuffer->getIndexValue(i)); }
+        }
+      }
 
       core::KDOP kDOP(vtxList, vtxCount);
       core::OBB obb;
@@ -495,14 +556,13 @@ class IMeshManipulator : public virtual core::IReferenceCounted
 		which were previously shared are now duplicated. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> createMeshBufferUniquePrimitives(ICPUMeshBuffer* inbuffer, bool _makeIndexBuf = false);
 
-		//
+		//! Calculates smooth normals of a mesh with unique primitives
+		/** Vertices closer than `epsilon` are averaged (weighted by angle) if `vxcmp` says they are connected.
+		An empty `vxcmp` connects vertices whose faces are less than 45 degrees apart, evaluated inline without any indirect call, and the vertices get processed in parallel.
+		A custom `vxcmp` is called from one thread in vertex order, unless `concurrentVxcmp` says it's safe to call concurrently. */
 		static core::smart_refctd_ptr<ICPUMeshBuffer> calculateSmoothNormals(ICPUMeshBuffer* inbuffer, bool makeNewMesh = false, float epsilon = 1.525e-5f,
 				uint32_t normalAttrID = 3u, 
-				VxCmpFunction vxcmp = [](const IMeshManipulator::SSNGVertexData& v0, const IMeshManipulator::SSNGVertexData& v1, ICPUMeshBuffer* buffer) 
-				{ 
-					static constexpr float cosOf45Deg = 0.70710678118f;
-					return dot(v0.parentTriangleFaceNormal,v1.parentTriangleFaceNormal)[0] > cosOf45Deg;
-				});
+				VxCmpFunction vxcmp = nullptr, const bool concurrentVxcmp = false);
 
 		//! Creates a copy of a mesh with vertices welded
 		/** \param mesh Input mesh
@@ -6,6 +6,7 @@
 #define __NBL_ASSET_I_VIRTUAL_TEXTURE_H_INCLUDED__
 
 #include <functional>
+#include <mutex>
 
 #include "nbl/core/math/morton.h"
 #include "nbl/core/memory/memory.h"
@@ -41,10 +42,15 @@ public:
     using physical_tiles_per_dim_log2_callback_t = std::function<uint32_t(E_FORMAT_CLASS)>;
 };
 
+template<class virtual_texture_t>
+class CVirtualTextureResidencyManager;
+
 template <typename image_view_t, typename sampler_t>
 class IVirtualTexture : public core::IReferenceCounted, public IVirtualTextureBase
 {
     using this_type = IVirtualTexture<image_view_t, sampler_t>;
+    template<class virtual_texture_t>
+    friend class CVirtualTextureResidencyManager;
 protected:
     //! SPhysPgOffset is what is stored in texels of page table!
     struct SPhysPgOffset
@@ -184,6 +190,13 @@ protected:
     static SMasterTextureData createMasterTextureData() { return SMasterTextureData(); }
     static SViewAliasTextureData createAliasTextureData() { return SViewAliasTextureData(); }
 
+    static uint64_t addrToKey(const SMasterTextureData& _addr)
+    {
+        uint64_t key;
+        memcpy(&key, &_addr, sizeof(key));
+        return key;
+    }
+
     using image_t = typename decltype(image_view_t::SCreationParams::image)::pointee;
 
     using page_tab_offset_t = core::vector3du32_SIMD;
@@ -385,10 +398,9 @@ protected:
                 bufOffset += regionSz;
             }
             auto buf = core::make_smart_refctd_ptr<ICPUBuffer>(bufOffset);
-#ifdef _NBL_DEBUG
+            // no page and no miptail page, so that freeing a texture which never got committed frees nothing
             uint32_t* bufptr = reinterpret_cast<uint32_t*>(buf->getPointer());
-            std::fill(bufptr, bufptr+bufOffset/sizeof(uint32_t), SPhysPgOffset::invalid_addr);
-#endif
+            std::fill(bufptr, bufptr+bufOffset/sizeof(uint32_t), SPhysPgOffset::invalid_addr|(SPhysPgOffset::invalid_addr<<SPhysPgOffset::PAGE_ADDR_BITLENGTH));
             pgtab->setBufferAndRegions(std::move(buf), regions);
         } 
         return pgtab;
@@ -412,6 +424,8 @@ protected:
     mutable core::smart_refctd_ptr<sampler_t> m_pageTableSampler;
     mutable core::smart_refctd_ptr<sampler_t> m_physicalStorageFloatSampler;
     mutable core::smart_refctd_ptr<sampler_t> m_physicalStorageNonFloatSampler;
+    //! textures whose physical pages belong to a `CVirtualTextureResidencyManager`, keyed by `addrToKey`
+    core::unordered_set<uint64_t> m_streamedTextures;
 
     using pg_tab_addr_alctr_t = core::GeneralpurposeAddressAllocator<uint32_t>;
     std::array<pg_tab_addr_alctr_t, MAX_PAGE_TABLE_LAYERS> m_pageTableLayerAllocators;
@@ -542,6 +556,11 @@ protected:
 
             return x | (y<<SPhysPgOffset::PAGE_ADDR_X_BITS) | (layer<<SPhysPgOffset::PAGE_ADDR_LAYER_SHIFT);
         }
+        uint32_t decodePageAddress(uint32_t _encoded) const
+        {
+            const SPhysPgOffset offset(_encoded);
+            return offset.x() | (offset.y()<<(m_decodeAddr_layerShift>>1)) | (offset.layer()<<m_decodeAddr_layerShift);
+        }
 
         core::smart_refctd_ptr<image_view_t> createView(E_FORMAT _format) const
         {
@@ -573,6 +592,30 @@ protected:
             return coords;
         }
 
+        //! Allocates `_count` physical pages at once and writes their encoded addresses (or `SPhysPgOffset::invalid_addr`) to `_outAddrs`
+        //! Thread-safe, so textures can get committed in parallel
+        void allocTiles(uint32_t _count, uint32_t* _outAddrs)
+        {
+            if (_count==0u)
+                return;
+            std::fill(_outAddrs, _outAddrs+_count, phys_pg_addr_alctr_t::invalid_address);
+            {
+                std::lock_guard<std::mutex> lock(m_tileAlctrMutex);
+                for (uint32_t i=0u; i<_count; ++i)
+                    _outAddrs[i] = tileAlctr.alloc_addr(1u, 1u);
+            }
+            for (uint32_t i=0u; i<_count; ++i)
+                _outAddrs[i] = (_outAddrs[i]==phys_pg_addr_alctr_t::invalid_address) ? SPhysPgOffset::invalid_addr:encodePageAddress(_outAddrs[i]);
+        }
+        //! Thread-safe counterpart of `allocTiles`, takes encoded addresses as stored in the page table and skips invalid ones
+        void freeTiles(uint32_t _count, const uint32_t* _addrs)
+        {
+            std::lock_guard<std::mutex> lock(m_tileAlctrMutex);
+            for (uint32_t i=0u; i<_count; ++i)
+            if (SPhysPgOffset(_addrs[i]&SPhysPgOffset::PAGE_ADDR_MASK).valid())
+                tileAlctr.free_addr(decodePageAddress(_addrs[i]), 1u);
+        }
+
         void incrTileCounter(uint32_t tiles)
         {
             m_tileCounter += tiles;
@@ -596,6 +639,7 @@ protected:
 
     private:
         mutable core::unordered_map<E_FORMAT, core::smart_refctd_ptr<image_view_t>> m_viewsCache;
+        std::mutex m_tileAlctrMutex;
     };
     //since c++14 std::hash specialization for all enum types are given by standard
     core::unordered_map<E_FORMAT_CLASS, core::smart_refctd_ptr<IVTResidentStorage>> m_storage;
@@ -952,6 +996,8 @@ public:
 
     virtual bool free(const SMasterTextureData& _addr)
     {
+        if (isStreamed(_addr))
+            return false;
         const E_FORMAT format = getFormatInLayer(_addr.pgTab_layer);
         IVTResidentStorage* storage = getStorageForFormatClass(getFormatClass(format));
         if (!storage)
@@ -994,6 +1040,8 @@ public:
     }
 
     image_t* getPageTable() const { return m_pageTable.get(); }
+    //! Whether the pages of the texture are handed over to a `CVirtualTextureResidencyManager`, such a texture can't be committed or freed until the manager hands it back
+    bool isStreamed(const SMasterTextureData& _addr) const { return m_streamedTextures.find(addrToKey(_addr))!=m_streamedTextures.end(); }
     uint32_t getPageTableExtent_log2() const { return m_pgSzxy_log2; }
     uint32_t getPageExtent() const { return m_pgSzxy; }
     uint32_t getPageExtent_log2() const { return core::findLSB(m_pgSzxy); }
@@ -6,11 +6,18 @@
 #define __NBL_CORE_RADIX_SORT_H_INCLUDED__
 
 #include <algorithm>
+#include <bit>
 #include <bitset>
 #include <cstdint>
+#include <iterator>
 #include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include "nbl/macros.h"
+#include "nbl/core/execution.h"
 
 namespace nbl
 {
@@ -20,16 +27,39 @@ namespace core
 namespace impl
 {
 
+template<size_t byte_size> struct unsigned_of_size;
+template<> struct unsigned_of_size<1ull> { using type = uint8_t; };
+template<> struct unsigned_of_size<2ull> { using type = uint16_t; };
+template<> struct unsigned_of_size<4ull> { using type = uint32_t; };
+template<> struct unsigned_of_size<8ull> { using type = uint64_t; };
+
+//! Key accessor for plain arithmetic values, signed integers and floats get their bits remapped so they sort as unsigned integers
 template<typename T>
 struct KeyAdaptor
 {
-	static_assert(std::is_integral_v<T>&&std::is_unsigned_v<T>,"Need to use your own key value accessor.");
+	static_assert(std::is_arithmetic_v<T>,"Need to use your own key value accessor.");
+	using bits_t = typename unsigned_of_size<sizeof(T)>::type;
 	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = sizeof(T)*8u;
 
+	static inline bits_t toOrderedBits(const T& item)
+	{
+		constexpr bits_t sign = bits_t(0x1u)<<bits_t(key_bit_count-1ull);
+		if constexpr (std::is_floating_point_v<T>)
+		{
+			// negative floats order backwards, so flip all their bits, positives just need to go above them
+			const bits_t bits = std::bit_cast<bits_t>(item);
+			return (bits&sign) ? ~bits:(bits|sign);
+		}
+		else if constexpr (std::is_signed_v<T>)
+			return static_cast<bits_t>(item)^sign;
+		else
+			return item;
+	}
+
 	template<auto bit_offset, auto radix_mask>
 	inline decltype(radix_mask) operator()(const T& item) const
 	{
-		return static_cast<decltype(radix_mask)>(item>>static_cast<T>(bit_offset))&radix_mask;
+		return static_cast<decltype(radix_mask)>(toOrderedBits(item)>>static_cast<bits_t>(bit_offset))&radix_mask;
 	}
 };
 
@@ -45,10 +75,13 @@ constexpr int8_t find_msb(const T& a_variable)
     {
         if (variable_bitset[msb] == 1)
             return msb;
-    }        
+    }
     return -1;
 }
 
+//! Stand-in for the value iterator when only keys get sorted
+struct NoValues {};
+
 template<size_t key_bit_count, typename histogram_t>
 struct RadixSorter
 {
@@ -61,11 +94,17 @@ struct RadixSorter
 		template<class RandomIt, class KeyAccessor>
 		inline RandomIt operator()(RandomIt input, RandomIt output, const histogram_t rangeSize, const KeyAccessor& comp)
 		{
-			return pass<RandomIt,KeyAccessor,0ull>(input,output,rangeSize,comp);
+			return pass<RandomIt,NoValues,KeyAccessor,0ull>(input,output,NoValues{},NoValues{},rangeSize,comp).first;
+		}
+		//! Values move along with their keys
+		template<class KeyIt, class ValueIt, class KeyAccessor>
+		inline std::pair<KeyIt,ValueIt> operator()(KeyIt input, KeyIt output, ValueIt values, ValueIt valuesOut, const histogram_t rangeSize, const KeyAccessor& comp)
+		{
+			return pass<KeyIt,ValueIt,KeyAccessor,0ull>(input,output,values,valuesOut,rangeSize,comp);
 		}
 	private:
-		template<class RandomIt, class KeyAccessor, size_t pass_ix>
-		inline RandomIt pass(RandomIt input, RandomIt output, const histogram_t rangeSize, const KeyAccessor& comp)
+		template<class KeyIt, class ValueIt, class KeyAccessor, size_t pass_ix>
+		inline std::pair<KeyIt,ValueIt> pass(KeyIt input, KeyIt output, ValueIt values, ValueIt valuesOut, const histogram_t rangeSize, const KeyAccessor& comp)
 		{
 			// clear
 			std::fill_n(histogram,histogram_size,static_cast<histogram_t>(0u));
@@ -73,24 +112,204 @@ struct RadixSorter
 			constexpr histogram_t shift = static_cast<histogram_t>(radix_bits*pass_ix);
 			for (histogram_t i=0u; i<rangeSize; i++)
 				++histogram[comp.template operator()<shift,radix_mask>(input[i])];
-			// prefix sum
-			std::inclusive_scan(histogram,histogram+histogram_size,histogram);
-			// scatter
-			for (histogram_t i=rangeSize; i!=0u;)
+			// when all keys share the digit the pass would be a plain copy, skip it
+			const bool skip = rangeSize==0u || histogram[comp.template operator()<shift,radix_mask>(input[0])]==rangeSize;
+			if (!skip)
 			{
-				i--;
-				output[--histogram[comp.template operator()<shift,radix_mask>(input[i])]] = input[i];
+				// prefix sum
+				std::inclusive_scan(histogram,histogram+histogram_size,histogram);
+				// scatter
+				for (histogram_t i=rangeSize; i!=0u;)
+				{
+					i--;
+					const histogram_t dst = --histogram[comp.template operator()<shift,radix_mask>(input[i])];
+					output[dst] = input[i];
+					if constexpr (!std::is_same_v<ValueIt,NoValues>)
+						valuesOut[dst] = values[i];
+				}
 			}
 
 			if constexpr (pass_ix != last_pass)
-				return pass<RandomIt,KeyAccessor,pass_ix+1ull>(output,input,rangeSize,comp);
+			{
+				if (skip)
+					return pass<KeyIt,ValueIt,KeyAccessor,pass_ix+1ull>(input,output,values,valuesOut,rangeSize,comp);
+				return pass<KeyIt,ValueIt,KeyAccessor,pass_ix+1ull>(output,input,valuesOut,values,rangeSize,comp);
+			}
+			else if (skip)
+				return {input,values};
 			else
-				return output;
+				return {output,valuesOut};
 		}
-	
+
 		alignas(sizeof(histogram_t)) histogram_t histogram[histogram_size];
 };
 
+//! LSD sort of equal chunks in parallel, each chunk counts into its own histogram and scatters to its own offsets, stable like the serial one
+/**
+	Digits are narrower than the serial sorter's, every thread writes to as many places at once as there are buckets
+	and those have to stay in cache.
+*/
+template<size_t key_bit_count>
+struct ParallelRadixSorter
+{
+		_NBL_STATIC_INLINE_CONSTEXPR uint8_t radix_bits = 8u;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t histogram_size = 0x1ull<<radix_bits;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t last_pass = (key_bit_count-1ull)/size_t(radix_bits);
+		_NBL_STATIC_INLINE_CONSTEXPR uint16_t radix_mask = (1u<<radix_bits)-1u;
+		//! smaller chunks don't pay for the synchronization
+		_NBL_STATIC_INLINE_CONSTEXPR size_t min_chunk_size = 0x1ull<<15ull;
+
+		template<class ExecutionPolicy, class KeyIt, class ValueIt, class KeyAccessor>
+		inline std::pair<KeyIt,ValueIt> operator()(ExecutionPolicy&& policy, KeyIt input, KeyIt output, ValueIt values, ValueIt valuesOut, const size_t rangeSize, const KeyAccessor& comp)
+		{
+			const size_t threadCount = std::max<size_t>(std::thread::hardware_concurrency(),1ull);
+			m_rangeSize = rangeSize;
+			m_chunks.resize(std::clamp<size_t>(rangeSize/min_chunk_size,1ull,threadCount));
+			std::iota(m_chunks.begin(),m_chunks.end(),0u);
+			m_histograms.resize(m_chunks.size()*histogram_size);
+			return pass<ExecutionPolicy,KeyIt,ValueIt,KeyAccessor,0ull>(policy,input,output,values,valuesOut,comp);
+		}
+	private:
+		inline size_t chunkBegin(const uint32_t chunk) const { return m_rangeSize*chunk/m_chunks.size(); }
+
+		template<class ExecutionPolicy, class KeyIt, class ValueIt, class KeyAccessor, size_t pass_ix>
+		inline std::pair<KeyIt,ValueIt> pass(ExecutionPolicy& policy, KeyIt input, KeyIt output, ValueIt values, ValueIt valuesOut, const KeyAccessor& comp)
+		{
+			constexpr size_t shift = radix_bits*pass_ix;
+			// count
+			core::for_each(policy,m_chunks.begin(),m_chunks.end(),[&](const uint32_t chunk) -> void
+			{
+				size_t* const histogram = m_histograms.data()+chunk*histogram_size;
+				std::fill_n(histogram,histogram_size,0ull);
+				const size_t end = chunkBegin(chunk+1u);
+				for (size_t i=chunkBegin(chunk); i<end; i++)
+					++histogram[comp.template operator()<shift,radix_mask>(input[i])];
+			});
+			// exclusive prefix sum, digits major and chunks minor, so every chunk scatters after the previous chunks' keys of the same digit
+			bool skip = false;
+			size_t sum = 0ull;
+			for (size_t digit=0ull; digit<histogram_size; digit++)
+			{
+				const size_t digitBegin = sum;
+				for (size_t chunk=0ull; chunk<m_chunks.size(); chunk++)
+				{
+					size_t& offset = m_histograms[chunk*histogram_size+digit];
+					const size_t count = offset;
+					offset = sum;
+					sum += count;
+				}
+				if (sum-digitBegin==m_rangeSize)
+					skip = true;
+			}
+			// scatter
+			if (!skip)
+			core::for_each(policy,m_chunks.begin(),m_chunks.end(),[&](const uint32_t chunk) -> void
+			{
+				size_t* const offsets = m_histograms.data()+chunk*histogram_size;
+				const size_t end = chunkBegin(chunk+1u);
+				for (size_t i=chunkBegin(chunk); i<end; i++)
+				{
+					const size_t dst = offsets[comp.template operator()<shift,radix_mask>(input[i])]++;
+					output[dst] = input[i];
+					if constexpr (!std::is_same_v<ValueIt,NoValues>)
+						valuesOut[dst] = values[i];
+				}
+			});
+
+			if constexpr (pass_ix != last_pass)
+			{
+				if (skip)
+					return pass<ExecutionPolicy,KeyIt,ValueIt,KeyAccessor,pass_ix+1ull>(policy,input,output,values,valuesOut,comp);
+				return pass<ExecutionPolicy,KeyIt,ValueIt,KeyAccessor,pass_ix+1ull>(policy,output,input,valuesOut,values,comp);
+			}
+			else if (skip)
+				return {input,values};
+			else
+				return {output,valuesOut};
+		}
+
+		size_t m_rangeSize;
+		std::vector<uint32_t> m_chunks;
+		std::vector<size_t> m_histograms;
+};
+
+//! MSD "American flag" sort, permutes the range in place by swapping every element directly into its bucket, not stable
+template<size_t key_bit_count>
+struct InPlaceRadixSorter
+{
+		_NBL_STATIC_INLINE_CONSTEXPR uint8_t radix_bits = 8u;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t histogram_size = 0x1ull<<radix_bits;
+		_NBL_STATIC_INLINE_CONSTEXPR size_t digit_count = (key_bit_count+radix_bits-1ull)/size_t(radix_bits);
+		_NBL_STATIC_INLINE_CONSTEXPR uint16_t radix_mask = (1u<<radix_bits)-1u;
+		//! buckets this small get insertion sorted
+		_NBL_STATIC_INLINE_CONSTEXPR size_t insertion_sort_threshold = 32ull;
+
+		template<class RandomIt, class KeyAccessor>
+		static inline void sort(RandomIt begin, const size_t rangeSize, const KeyAccessor& comp)
+		{
+			pass<RandomIt,KeyAccessor,0ull>(begin,rangeSize,comp);
+		}
+	private:
+		// digits get counted from the most significant one
+		template<size_t digit_ix>
+		static inline constexpr size_t shift = radix_bits*(digit_count-1ull-digit_ix);
+
+		template<class T, class KeyAccessor, size_t digit_ix>
+		static inline bool less(const T& lhs, const T& rhs, const KeyAccessor& comp)
+		{
+			const auto lhsDigit = comp.template operator()<shift<digit_ix>,radix_mask>(lhs);
+			const auto rhsDigit = comp.template operator()<shift<digit_ix>,radix_mask>(rhs);
+			if constexpr (digit_ix+1ull<digit_count)
+			{
+				if (lhsDigit!=rhsDigit)
+					return lhsDigit<rhsDigit;
+				return less<T,KeyAccessor,digit_ix+1ull>(lhs,rhs,comp);
+			}
+			else
+				return lhsDigit<rhsDigit;
+		}
+
+		template<class RandomIt, class KeyAccessor, size_t digit_ix>
+		static inline void pass(RandomIt begin, const size_t rangeSize, const KeyAccessor& comp)
+		{
+			if (rangeSize<=insertion_sort_threshold)
+			{
+				// the digits above `digit_ix` are equal already
+				for (size_t i=1ull; i<rangeSize; i++)
+				for (size_t j=i; j!=0ull && less<std::decay_t<decltype(*begin)>,KeyAccessor,digit_ix>(begin[j],begin[j-1ull],comp); j--)
+					std::iter_swap(begin+j,begin+j-1ull);
+				return;
+			}
+
+			size_t heads[histogram_size] = {};
+			for (size_t i=0ull; i<rangeSize; i++)
+				++heads[comp.template operator()<shift<digit_ix>,radix_mask>(begin[i])];
+			size_t ends[histogram_size];
+			std::inclusive_scan(heads,heads+histogram_size,ends);
+			std::exclusive_scan(heads,heads+histogram_size,heads,0ull);
+
+			for (size_t bucket=0ull; bucket<histogram_size; bucket++)
+			while (heads[bucket]<ends[bucket])
+			{
+				// follow the cycle of misplaced elements until one belonging here turns up
+				auto value = std::move(begin[heads[bucket]]);
+				for (auto digit=comp.template operator()<shift<digit_ix>,radix_mask>(value); digit!=bucket; digit=comp.template operator()<shift<digit_ix>,radix_mask>(value))
+					std::swap(value,begin[heads[digit]++]);
+				begin[heads[bucket]++] = std::move(value);
+			}
+
+			if constexpr (digit_ix+1ull<digit_count)
+			{
+				size_t bucketBegin = 0ull;
+				for (size_t bucket=0ull; bucket<histogram_size; bucket++)
+				{
+					pass<RandomIt,KeyAccessor,digit_ix+1ull>(begin+bucketBegin,ends[bucket]-bucketBegin,comp);
+					bucketBegin = ends[bucket];
+				}
+			}
+		}
+};
+
 }
 
 template<class RandomIt, class KeyAccessor>
@@ -98,22 +317,79 @@ inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeS
 {
 	assert(std::abs(std::distance(input,scratch))>=rangeSize);
 
-	if (rangeSize<static_cast<decltype(rangeSize)>(0x1ull<<16ull))
+	if (rangeSize<static_cast<std::remove_cv_t<decltype(rangeSize)>>(0x1ull<<16ull))
 		return impl::RadixSorter<KeyAccessor::key_bit_count,uint16_t>()(input,scratch,static_cast<uint16_t>(rangeSize),comp);
-	if (rangeSize<static_cast<decltype(rangeSize)>(0x1ull<<32ull))
+	if (rangeSize<static_cast<std::remove_cv_t<decltype(rangeSize)>>(0x1ull<<32ull))
 		return impl::RadixSorter<KeyAccessor::key_bit_count,uint32_t>()(input,scratch,static_cast<uint32_t>(rangeSize),comp);
 	else
 		return impl::RadixSorter<KeyAccessor::key_bit_count,size_t>()(input,scratch,rangeSize,comp);
 }
 
 //! Because Radix Sort needs O(2n) space and a number of passes dependant on the key length, the final sorted range can be either in `input` or `scratch`
+/**
+	Passes where every key has the same digit get skipped, so e.g. small values in wide integers only cost the passes they need.
+	Signed integers and floats can be sorted directly, with the default key accessor.
+*/
 template<class RandomIt>
 inline RandomIt radix_sort(RandomIt input, RandomIt scratch, const size_t rangeSize)
 {
-	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<decltype(*input)>());
+	return radix_sort<RandomIt>(input,scratch,rangeSize,impl::KeyAdaptor<std::iter_value_t<RandomIt>>());
+}
+
+//! Parallel version of the above, splits the range into a chunk per thread (unless there's too few keys) and runs each pass over all the chunks with `policy`
+template<class ExecutionPolicy, class RandomIt, class KeyAccessor>
+inline RandomIt radix_sort(ExecutionPolicy&& policy, RandomIt input, RandomIt scratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	assert(std::abs(std::distance(input,scratch))>=rangeSize);
+	return impl::ParallelRadixSorter<KeyAccessor::key_bit_count>()(policy,input,scratch,impl::NoValues{},impl::NoValues{},rangeSize,comp).first;
+}
+template<class ExecutionPolicy, class RandomIt>
+inline RandomIt radix_sort(ExecutionPolicy&& policy, RandomIt input, RandomIt scratch, const size_t rangeSize)
+{
+	return radix_sort(policy,input,scratch,rangeSize,impl::KeyAdaptor<std::iter_value_t<RandomIt>>());
+}
+
+//! Sorts separate key and value arrays, the sorted pair of ranges is either (`keys`,`values`) or (`keyScratch`,`valueScratch`)
+/**
+	Sorting indices (or any small payload) next to compact keys moves far less memory than sorting structs by one of their members.
+*/
+template<class KeyIt, class ValueIt, class KeyAccessor>
+inline std::pair<KeyIt,ValueIt> radix_sort_pairs(KeyIt keys, KeyIt keyScratch, ValueIt values, ValueIt valueScratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	assert(std::abs(std::distance(keys,keyScratch))>=rangeSize && std::abs(std::distance(values,valueScratch))>=rangeSize);
+
+	if (rangeSize<static_cast<std::remove_cv_t<decltype(rangeSize)>>(0x1ull<<16ull))
+		return impl::RadixSorter<KeyAccessor::key_bit_count,uint16_t>()(keys,keyScratch,values,valueScratch,static_cast<uint16_t>(rangeSize),comp);
+	if (rangeSize<static_cast<std::remove_cv_t<decltype(rangeSize)>>(0x1ull<<32ull))
+		return impl::RadixSorter<KeyAccessor::key_bit_count,uint32_t>()(keys,keyScratch,values,valueScratch,static_cast<uint32_t>(rangeSize),comp);
+	else
+		return impl::RadixSorter<KeyAccessor::key_bit_count,size_t>()(keys,keyScratch,values,valueScratch,rangeSize,comp);
+}
+template<class KeyIt, class ValueIt>
+inline std::pair<KeyIt,ValueIt> radix_sort_pairs(KeyIt keys, KeyIt keyScratch, ValueIt values, ValueIt valueScratch, const size_t rangeSize)
+{
+	return radix_sort_pairs(keys,keyScratch,values,valueScratch,rangeSize,impl::KeyAdaptor<std::iter_value_t<KeyIt>>());
+}
+template<class ExecutionPolicy, class KeyIt, class ValueIt, class KeyAccessor>
+inline std::pair<KeyIt,ValueIt> radix_sort_pairs(ExecutionPolicy&& policy, KeyIt keys, KeyIt keyScratch, ValueIt values, ValueIt valueScratch, const size_t rangeSize, const KeyAccessor& comp)
+{
+	assert(std::abs(std::distance(keys,keyScratch))>=rangeSize && std::abs(std::distance(values,valueScratch))>=rangeSize);
+	return impl::ParallelRadixSorter<KeyAccessor::key_bit_count>()(policy,keys,keyScratch,values,valueScratch,rangeSize,comp);
+}
+
+//! Sorts without any scratch memory, but isn't stable and only runs on one thread
+template<class RandomIt, class KeyAccessor>
+inline void radix_sort_in_place(RandomIt begin, const size_t rangeSize, const KeyAccessor& comp)
+{
+	impl::InPlaceRadixSorter<KeyAccessor::key_bit_count>::sort(begin,rangeSize,comp);
+}
+template<class RandomIt>
+inline void radix_sort_in_place(RandomIt begin, const size_t rangeSize)
+{
+	radix_sort_in_place(begin,rangeSize,impl::KeyAdaptor<std::iter_value_t<RandomIt>>());
 }
 
 }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,101 @@
+#ifndef __NBL_C_MPSC_RING_BUFFER_H_INCLUDED__
+#define __NBL_C_MPSC_RING_BUFFER_H_INCLUDED__
+
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/math/intutil.h"
+
+#include <atomic>
+#include <memory>
+
+namespace nbl::core
+{
+
+//! Lock-free bounded ring buffer for any number of producer threads and exactly one consumer thread
+/**
+    Every element has a sequence number telling whether it's free for the producer which claimed its position
+    or published for the consumer, so producers only contend on a single compare-exchange of the head.
+    Elements are never constructed or destroyed after the buffer is, producers and the consumer get a reference to fill and drain,
+    which lets a `T` holding memory (e.g. a `std::string`) be swapped in and out and keep its allocation.
+    A producer which stalls between claiming and publishing an element holds back the consumer, not the other producers.
+*/
+template <typename T>
+class CMPSCRingBuffer
+{
+    static inline constexpr size_t CacheLineSize = 64ull;
+
+public:
+    explicit CMPSCRingBuffer(const size_t _capacity) : m_cells(std::make_unique<SCell[]>(_capacity)), m_capacity(_capacity)
+    {
+        assert(core::isPoT(_capacity));
+        for (size_t i=0ull; i<m_capacity; i++)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    CMPSCRingBuffer(const CMPSCRingBuffer&) = delete;
+    CMPSCRingBuffer& operator=(const CMPSCRingBuffer&) = delete;
+
+    inline size_t capacity() const { return m_capacity; }
+
+    //! Any thread, calls `_fill(T&)` on a free element and publishes it, returns false without calling it when the buffer is full
+    template <typename F>
+    inline bool tryPush(F&& _fill)
+    {
+        uint64_t pos = m_head.load(std::memory_order_relaxed);
+        while (true)
+        {
+            SCell& cell = m_cells[pos&(m_capacity-1ull)];
+            const int64_t diff = static_cast<int64_t>(cell.sequence.load(std::memory_order_acquire)-pos);
+            if (diff==0ll)
+            {
+                if (m_head.compare_exchange_weak(pos, pos+1ull, std::memory_order_relaxed))
+                {
+                    _fill(cell.value);
+                    cell.sequence.store(pos+1ull, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (diff<0ll) // the consumer hasn't released the element from the previous lap yet
+                return false;
+            else // another producer claimed it
+                pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+
+    //! Consumer only, calls `_func(T&)` on the published elements in order and releases them, stops at the first one still being filled
+    template <typename F>
+    inline size_t consumeAll(F&& _func)
+    {
+        const uint64_t begin = m_tail.load(std::memory_order_relaxed);
+        uint64_t tail = begin;
+        for (; ; tail++)
+        {
+            SCell& cell = m_cells[tail&(m_capacity-1ull)];
+            if (cell.sequence.load(std::memory_order_acquire)!=tail+1ull)
+                break;
+            _func(cell.value);
+            cell.sequence.store(tail+m_capacity, std::memory_order_release);
+        }
+        m_tail.store(tail, std::memory_order_release);
+        return tail-begin;
+    }
+
+    //! Elements claimed by producers since creation, published or not
+    inline uint64_t getPushedCount() const { return m_head.load(std::memory_order_acquire); }
+    //! Elements released by the consumer since creation
+    inline uint64_t getConsumedCount() const { return m_tail.load(std::memory_order_acquire); }
+
+private:
+    struct alignas(CacheLineSize) SCell
+    {
+        std::atomic_uint64_t sequence;
+        T value;
+    };
+
+    std::unique_ptr<SCell[]> m_cells;
+    const size_t m_capacity;
+    alignas(CacheLineSize) std::atomic_uint64_t m_head = 0ull;
+    alignas(CacheLineSize) std::atomic_uint64_t m_tail = 0ull;
+};
+
+}
+
+#endif
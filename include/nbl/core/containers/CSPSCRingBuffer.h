@@ -0,0 +1,113 @@
+#ifndef __NBL_C_SPSC_RING_BUFFER_H_INCLUDED__
+#define __NBL_C_SPSC_RING_BUFFER_H_INCLUDED__
+
+#include "nbl/core/decl/Types.h"
+#include "nbl/core/memory/memory.h"
+#include "nbl/core/math/intutil.h"
+
+#include <atomic>
+#include <type_traits>
+
+namespace nbl::core
+{
+
+//! Wait-free ring buffer for exactly one producer thread and exactly one consumer thread
+/**
+    Unlike CCircularBuffer it never overwrites, `tryPush` fails when the buffer is full and the producer decides what to do.
+    The producer and consumer indices live on separate cache lines and each side keeps a cached copy of the other side's index,
+    so the cache line of the other side only gets touched when the cached copy says the buffer is full or empty.
+*/
+template <typename T>
+class CSPSCRingBuffer
+{
+    static_assert(std::is_trivially_copyable_v<T> && std::is_trivially_destructible_v<T>, "Elements are copied around with no construction or destruction");
+
+    static inline constexpr size_t CacheLineSize = 64ull;
+
+public:
+    explicit CSPSCRingBuffer(const size_t _capacity) : m_storage(nullptr), m_capacity(_capacity)
+    {
+        assert(core::isPoT(_capacity));
+        m_storage = reinterpret_cast<T*>(_NBL_ALIGNED_MALLOC(sizeof(T)*m_capacity, alignof(T)));
+    }
+    ~CSPSCRingBuffer()
+    {
+        _NBL_ALIGNED_FREE(m_storage);
+    }
+    CSPSCRingBuffer(const CSPSCRingBuffer&) = delete;
+    CSPSCRingBuffer& operator=(const CSPSCRingBuffer&) = delete;
+
+    inline size_t capacity() const { return m_capacity; }
+
+    //! Safe to call from any thread, but only exact when called from the producer or consumer while the other side is idle
+    inline size_t size() const
+    {
+        const uint64_t tail = m_consumer.tail.load(std::memory_order_acquire);
+        return m_producer.head.load(std::memory_order_acquire)-tail;
+    }
+    inline bool empty() const { return size()==0ull; }
+
+    //! Producer only, returns false and leaves the buffer untouched when it's full
+    inline bool tryPush(const T& _value)
+    {
+        const uint64_t head = m_producer.head.load(std::memory_order_relaxed);
+        if (head-m_producer.cachedTail>=m_capacity)
+        {
+            m_producer.cachedTail = m_consumer.tail.load(std::memory_order_acquire);
+            if (head-m_producer.cachedTail>=m_capacity)
+                return false;
+        }
+        m_storage[head&(m_capacity-1ull)] = _value;
+        m_producer.head.store(head+1ull, std::memory_order_release);
+        return true;
+    }
+
+    //! Consumer only, calls `_func(const T&)` on every element pushed so far and releases them all at once, returns how many there were
+    template <typename F>
+    inline size_t consumeAll(F&& _func)
+    {
+        const uint64_t tail = m_consumer.tail.load(std::memory_order_relaxed);
+        m_consumer.cachedHead = m_producer.head.load(std::memory_order_acquire);
+        const uint64_t count = m_consumer.cachedHead-tail;
+        for (uint64_t i=tail; i!=m_consumer.cachedHead; i++)
+            _func(m_storage[i&(m_capacity-1ull)]);
+        if (count)
+            m_consumer.tail.store(m_consumer.cachedHead, std::memory_order_release);
+        return count;
+    }
+
+    //! Consumer only, copies out up to `_maxCount` elements, returns how many got copied
+    inline size_t pop(T* _out, const size_t _maxCount)
+    {
+        const uint64_t tail = m_consumer.tail.load(std::memory_order_relaxed);
+        if (m_consumer.cachedHead-tail<_maxCount)
+            m_consumer.cachedHead = m_producer.head.load(std::memory_order_acquire);
+        const uint64_t count = core::min<uint64_t>(m_consumer.cachedHead-tail,_maxCount);
+        for (uint64_t i=0ull; i<count; i++)
+            _out[i] = m_storage[(tail+i)&(m_capacity-1ull)];
+        if (count)
+            m_consumer.tail.store(tail+count, std::memory_order_release);
+        return count;
+    }
+
+private:
+    struct alignas(CacheLineSize) SProducerSide
+    {
+        std::atomic_uint64_t head = 0ull;
+        uint64_t cachedTail = 0ull;
+    };
+    struct alignas(CacheLineSize) SConsumerSide
+    {
+        std::atomic_uint64_t tail = 0ull;
+        uint64_t cachedHead = 0ull;
+    };
+
+    T* m_storage;
+    const size_t m_capacity;
+    SProducerSide m_producer;
+    SConsumerSide m_consumer;
+};
+
+}
+
+#endif
@@ -109,11 +109,8 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 			if (m_back == invalid_iterator)
 				return;
 
-			auto backNode = getBack();
-			if (backNode->prev != invalid_iterator)
-				get(backNode->prev)->next = invalid_iterator;
 			uint32_t temp = m_back;
-			m_back = backNode->prev;
+			common_detach(getBack());
 			common_delete(temp);
 		}
 
@@ -152,13 +149,12 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		{
 			if (m_begin == nodeAddr || nodeAddr == invalid_iterator)
 				return;
-			
-			getBegin()->prev = nodeAddr;
 
 			auto node = get(nodeAddr);
 			common_detach(node);
 			node->next = m_begin;
 			node->prev = invalid_iterator;
+			getBegin()->prev = nodeAddr;
 			m_begin = nodeAddr;
 		}
 		//Constructor, capacity determines the amount of allocated space
@@ -173,16 +169,9 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 		}
 		~FixedCapacityDoublyLinkedList()
 		{
-			if (m_dispose_f && m_begin != invalid_iterator)
-			{
-				auto* begin = getBegin();
-				auto* back = getBack();
-				do 
-				{
-					m_dispose_f(begin->data);
-					begin = get(begin->next);
-				} while (begin != back);
-			}
+			if (m_dispose_f)
+			for (uint32_t addr = m_begin; addr != invalid_iterator; addr = get(addr)->next)
+				m_dispose_f(get(addr)->data);
 			_NBL_ALIGNED_FREE(m_reservedSpace);
 		}
 
@@ -228,12 +217,17 @@ class FixedCapacityDoublyLinkedList : private impl::FixedCapacityDoublyLinkedLis
 			alloc.free_addr(address, 1u);
 		}
 
+		//unlink the node from its neighbours, or from the ends of the list if it was the first or the last one
 		inline void common_detach(node_t* node)
 		{
 			if (node->next != invalid_iterator)
 				get(node->next)->prev = node->prev;
+			else
+				m_back = node->prev;
 			if (node->prev != invalid_iterator)
 				get(node->prev)->next = node->next;
+			else
+				m_begin = node->next;
 		}
 };
 
@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <cstring>
+#include <algorithm>
 
 namespace nbl::core
 {
@@ -54,84 +55,197 @@ namespace nbl::core
     v1: the strong hash is faster and stronger, it obsoletes the fast one
 */
 
-//! Super-fast function for checksuming purposes. Designed for large (>1KB) inputs.
-/** @param[in] input Pointer to data being the input for hasing algorithm.
-@param[in] len Size in bytes of data pointed by `input`.
-@param[out] out Pointer to 8byte memory to which result will be written.
-*/
-inline void XXHash_256(const void* input, size_t len, uint64_t* out)
+namespace impl
 {
-	//**************************************
-	// Macros
-	//**************************************
-	#define _rotl(x,r) ((x << r) | (x >> (64 - r)))
-
-	//**************************************
-	// Constants
-	//**************************************
-    const uint64_t PRIME = 11400714819323198393ULL;
-
-    const uint8_t* p = (uint8_t*)input;
-    const uint8_t* const bEnd = p + len;
-    uint64_t v1 = len * PRIME;
-    uint64_t v2 = v1;
-    uint64_t v3 = v1;
-    uint64_t v4 = v1;
-
-    const size_t big_loop_step = 4 * 4 * sizeof(uint64_t);
-    const size_t small_loop_step = 4 * sizeof(uint64_t);
-    // Set the big loop limit early enough, so the well-mixing small loop can be executed twice after it
-    const uint8_t* const big_loop_limit   = bEnd - big_loop_step - 2 * small_loop_step;
-    const uint8_t* const small_loop_limit = bEnd - small_loop_step;
-
-    while (p < big_loop_limit)
+    constexpr uint64_t xxHash256Prime = 11400714819323198393ULL;
+    //! bytes eaten by one round of the big and the small loop
+    constexpr size_t xxHash256BigStep = 4 * 4 * sizeof(uint64_t);
+    constexpr size_t xxHash256SmallStep = 4 * sizeof(uint64_t);
+
+    inline uint64_t xxHash256Rotl(const uint64_t x, const int r)
     {
-        v1 = _rotl(v1, 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 = _rotl(v2, 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 = _rotl(v3, 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 = _rotl(v4, 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v1 += v2 *= PRIME;
-        v1 = _rotl(v1, 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 = _rotl(v2, 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 = _rotl(v3, 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 = _rotl(v4, 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 += v3 *= PRIME;
-        v1 = _rotl(v1, 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 = _rotl(v2, 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 = _rotl(v3, 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 = _rotl(v4, 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 += v4 *= PRIME;
-        v1 = _rotl(v1, 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 = _rotl(v2, 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 = _rotl(v3, 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 = _rotl(v4, 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 += v1 *= PRIME;
+        return (x << r) | (x >> (64 - r));
     }
 
-    while (p < small_loop_limit)
+    inline void xxHash256BigRound(uint64_t* v, const uint8_t* p)
     {
-        v1 = _rotl(v1, 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v2 += v1 *= PRIME;
-        v2 = _rotl(v2, 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v3 += v2 *= PRIME;
-        v3 = _rotl(v3, 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v4 += v3 *= PRIME;
-        v4 = _rotl(v4, 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
-        v1 += v4 *= PRIME;
+        const uint64_t PRIME = xxHash256Prime;
+        v[0] = xxHash256Rotl(v[0], 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] = xxHash256Rotl(v[1], 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] = xxHash256Rotl(v[2], 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] = xxHash256Rotl(v[3], 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[0] += v[1] *= PRIME;
+        v[0] = xxHash256Rotl(v[0], 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] = xxHash256Rotl(v[1], 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] = xxHash256Rotl(v[2], 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] = xxHash256Rotl(v[3], 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] += v[2] *= PRIME;
+        v[0] = xxHash256Rotl(v[0], 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] = xxHash256Rotl(v[1], 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] = xxHash256Rotl(v[2], 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] = xxHash256Rotl(v[3], 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] += v[3] *= PRIME;
+        v[0] = xxHash256Rotl(v[0], 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] = xxHash256Rotl(v[1], 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] = xxHash256Rotl(v[2], 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] = xxHash256Rotl(v[3], 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] += v[0] *= PRIME;
     }
-#undef _rotl
-    size_t leftOverBytes = bEnd - p;
-    memcpy(out, p, leftOverBytes);
-    for (uint8_t* leftOverZeroP = reinterpret_cast<uint8_t*>(out)+leftOverBytes; leftOverZeroP<reinterpret_cast<uint8_t*>(out+4); leftOverZeroP++)
-        *leftOverZeroP = 0;
 
+    inline void xxHash256SmallRound(uint64_t* v, const uint8_t* p)
+    {
+        const uint64_t PRIME = xxHash256Prime;
+        v[0] = xxHash256Rotl(v[0], 29) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[1] += v[0] *= PRIME;
+        v[1] = xxHash256Rotl(v[1], 31) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[2] += v[1] *= PRIME;
+        v[2] = xxHash256Rotl(v[2], 33) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[3] += v[2] *= PRIME;
+        v[3] = xxHash256Rotl(v[3], 35) + (*(uint64_t*)p); p+=sizeof(uint64_t);
+        v[0] += v[3] *= PRIME;
+    }
+
+    //! Where the big loop and then the small loop stop for an input of `len` bytes, what's left after the small loop is at most one small step
+    /** The big loop stops early enough so the well-mixing small loop can be executed twice after it. */
+    inline void xxHash256LoopEnds(const size_t len, size_t& bigEnd, size_t& smallEnd)
+    {
+        const size_t bigTail = xxHash256BigStep + 2 * xxHash256SmallStep;
+        bigEnd = len>bigTail ? (len - bigTail + xxHash256BigStep - 1) / xxHash256BigStep * xxHash256BigStep : 0;
+        const size_t rest = len - bigEnd;
+        smallEnd = bigEnd + (rest>xxHash256SmallStep ? (rest - 1) / xxHash256SmallStep * xxHash256SmallStep : 0);
+    }
 
-    out[0] += v1;
-    out[1] += v2;
-    out[2] += v3;
-	out[3] += v4;
+    //! The leftover bytes zero padded to 32, plus the accumulators
+    inline void xxHash256Finalize(const uint64_t* v, const uint8_t* leftOver, const size_t leftOverBytes, uint64_t* out)
+    {
+        memcpy(out, leftOver, leftOverBytes);
+        for (uint8_t* leftOverZeroP = reinterpret_cast<uint8_t*>(out)+leftOverBytes; leftOverZeroP<reinterpret_cast<uint8_t*>(out+4); leftOverZeroP++)
+            *leftOverZeroP = 0;
+
+        out[0] += v[0];
+        out[1] += v[1];
+        out[2] += v[2];
+        out[3] += v[3];
+    }
 }
 
+//! Super-fast function for checksuming purposes. Designed for large (>1KB) inputs.
+/** @param[in] input Pointer to data being the input for hasing algorithm.
+@param[in] len Size in bytes of data pointed by `input`.
+@param[out] out Pointer to 32byte memory to which result will be written.
+*/
+inline void XXHash_256(const void* input, size_t len, uint64_t* out)
+{
+    const uint8_t* const begin = reinterpret_cast<const uint8_t*>(input);
+    uint64_t v[4];
+    v[0] = v[1] = v[2] = v[3] = len * impl::xxHash256Prime;
+
+    size_t bigEnd, smallEnd;
+    impl::xxHash256LoopEnds(len, bigEnd, smallEnd);
+    size_t offset = 0;
+    for (; offset<bigEnd; offset+=impl::xxHash256BigStep)
+        impl::xxHash256BigRound(v, begin+offset);
+    for (; offset<smallEnd; offset+=impl::xxHash256SmallStep)
+        impl::xxHash256SmallRound(v, begin+offset);
+
+    impl::xxHash256Finalize(v, begin+offset, len-offset, out);
+}
+
+//! Incremental version of `XXHash_256` for data which arrives in pieces, such as successive `IFile` reads
+/**
+    The output is exactly that of `XXHash_256` over the concatenation of everything passed to `update`, however it was split up.
+    The algorithm seeds itself with the total length, so that needs to be known upfront, and the rounds need the input
+    in 32 or 128 byte pieces, so at most 128 bytes get staged between the calls, the rest is hashed straight from the caller's memory.
+*/
+class CXXHash256
+{
+    public:
+        inline CXXHash256(const size_t totalLength)
+        {
+            reset(totalLength);
+        }
+
+        //! Starts over for a new input of `totalLength` bytes
+        inline void reset(const size_t totalLength)
+        {
+            m_length = totalLength;
+            m_v[0] = m_v[1] = m_v[2] = m_v[3] = totalLength * impl::xxHash256Prime;
+            impl::xxHash256LoopEnds(totalLength, m_bigEnd, m_smallEnd);
+            m_hashed = 0;
+            m_staged = 0;
+        }
+
+        //! Feeds the next `size` bytes, returns false (and consumes nothing) if that would go past the length given to `reset`
+        inline bool update(const void* data, size_t size)
+        {
+            if (size>m_length-m_hashed-m_staged)
+                return false;
+
+            const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+            while (size)
+            {
+                const size_t step = m_hashed<m_bigEnd ? impl::xxHash256BigStep:(m_hashed<m_smallEnd ? impl::xxHash256SmallStep:0);
+                // the leftover bytes only get used by `finalize`
+                if (!step)
+                {
+                    memcpy(m_staging+m_staged, p, size);
+                    m_staged += size;
+                    break;
+                }
+
+                if (!m_staged && size>=step)
+                {
+                    const uint8_t* const end = p+std::min<size_t>(size/step*step, (step==impl::xxHash256BigStep ? m_bigEnd:m_smallEnd)-m_hashed);
+                    const size_t consumed = end-p;
+                    if (step==impl::xxHash256BigStep)
+                        for (; p<end; p+=step)
+                            impl::xxHash256BigRound(m_v, p);
+                    else
+                        for (; p<end; p+=step)
+                            impl::xxHash256SmallRound(m_v, p);
+                    m_hashed += consumed;
+                    size -= consumed;
+                    continue;
+                }
+
+                const size_t copied = std::min<size_t>(step-m_staged, size);
+                memcpy(m_staging+m_staged, p, copied);
+                m_staged += copied;
+                p += copied;
+                size -= copied;
+                if (m_staged==step)
+                {
+                    if (step==impl::xxHash256BigStep)
+                        impl::xxHash256BigRound(m_v, m_staging);
+                    else
+                        impl::xxHash256SmallRound(m_v, m_staging);
+                    m_hashed += step;
+                    m_staged = 0;
+                }
+            }
+            return true;
+        }
+
+        //! Writes the 32 byte hash to `out`, fails if fewer bytes than the total length were fed
+        inline bool finalize(uint64_t* out) const
+        {
+            if (m_hashed+m_staged!=m_length)
+                return false;
+            impl::xxHash256Finalize(m_v, m_staging, m_staged, out);
+            return true;
+        }
+
+        inline size_t getTotalLength() const { return m_length; }
+        inline size_t getBytesFed() const { return m_hashed+m_staged; }
+
+    private:
+        uint64_t m_v[4];
+        size_t m_length, m_bigEnd, m_smallEnd;
+        //! bytes which went through the rounds
+        size_t m_hashed;
+        size_t m_staged;
+        alignas(uint64_t) uint8_t m_staging[impl::xxHash256BigStep];
+};
 
 }
 
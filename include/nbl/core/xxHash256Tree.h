@@ -0,0 +1,124 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_CORE_XXHASH256_TREE_H_INCLUDED__
+#define __NBL_CORE_XXHASH256_TREE_H_INCLUDED__
+
+#include <array>
+#include <vector>
+
+#include "nbl/core/execution.h"
+#include "nbl/core/xxHash256.h"
+
+namespace nbl::core
+{
+
+//! Two level hash tree over `XXHash_256`, for inputs large enough to be worth hashing on many cores
+/**
+    The input is split into fixed size blocks which get hashed independently and in parallel, the root hash is
+    the `XXHash_256` of the input length, the block size and all the block hashes. So it differs from the flat `XXHash_256`
+    of the same data (and between block sizes), but it's just as deterministic.
+
+    The block hashes are kept, so after modifying a range of the input only the blocks overlapping it have to be rehashed.
+*/
+class CXXHash256Tree
+{
+    public:
+        using hash_t = std::array<uint64_t,4>;
+
+        //! Big enough for a block to amortize the task overhead, small enough that a multi-megabyte input keeps all the cores busy
+        static constexpr size_t DefaultBlockSize = 0x1ull<<20;
+
+        inline CXXHash256Tree(const size_t blockSize=DefaultBlockSize) : m_blockSize(blockSize), m_length(0), m_root{}
+        {
+            combine();
+        }
+
+        //! Hashes all of `input`, the blocks in parallel unless a sequential `policy` is given
+        template<class ExecutionPolicy>
+        inline const hash_t& hash(ExecutionPolicy&& policy, const void* input, const size_t len)
+        {
+            m_length = len;
+            m_blocks.resize(getBlockCount(len));
+            hashBlocks(policy, reinterpret_cast<const uint8_t*>(input), 0, m_blocks.size());
+            combine();
+            return m_root;
+        }
+        inline const hash_t& hash(const void* input, const size_t len)
+        {
+            return hash(core::execution::par_unseq, input, len);
+        }
+
+        //! Rehashes only the blocks of `input` overlapping [dirtyOffset,dirtyOffset+dirtySize)
+        /**
+            Everything outside of the range must be the same as in the last `hash` or `update`, except that the input may
+            have grown or shrunk to `len` bytes, in which case the blocks from the old end onwards get rehashed too.
+        */
+        template<class ExecutionPolicy>
+        inline const hash_t& update(ExecutionPolicy&& policy, const void* input, const size_t len, const size_t dirtyOffset, const size_t dirtySize)
+        {
+            const size_t oldLength = m_length;
+            m_length = len;
+            m_blocks.resize(getBlockCount(len));
+
+            const size_t blockCount = m_blocks.size();
+            size_t firstBlock = dirtySize ? dirtyOffset/m_blockSize:blockCount;
+            size_t lastBlock = dirtySize ? std::min<size_t>((dirtyOffset+dirtySize-1)/m_blockSize+1,blockCount):0;
+            // the last block was shorter or is now
+            if (len!=oldLength)
+            {
+                firstBlock = std::min<size_t>(firstBlock,std::min(oldLength,len)/m_blockSize);
+                lastBlock = blockCount;
+            }
+            if (firstBlock<lastBlock)
+                hashBlocks(policy, reinterpret_cast<const uint8_t*>(input), firstBlock, lastBlock);
+            combine();
+            return m_root;
+        }
+        inline const hash_t& update(const void* input, const size_t len, const size_t dirtyOffset, const size_t dirtySize)
+        {
+            return update(core::execution::par_unseq, input, len, dirtyOffset, dirtySize);
+        }
+
+        inline const hash_t& getHash() const { return m_root; }
+        inline const std::vector<hash_t>& getBlockHashes() const { return m_blocks; }
+        inline size_t getBlockSize() const { return m_blockSize; }
+        inline size_t getLength() const { return m_length; }
+
+    private:
+        inline size_t getBlockCount(const size_t len) const
+        {
+            return (len+m_blockSize-1)/m_blockSize;
+        }
+
+        template<class ExecutionPolicy>
+        inline void hashBlocks(ExecutionPolicy&& policy, const uint8_t* input, const size_t firstBlock, const size_t lastBlock)
+        {
+            core::for_each(policy, m_blocks.begin()+firstBlock, m_blocks.begin()+lastBlock, [&](hash_t& blockHash) -> void
+            {
+                const size_t offset = (&blockHash-m_blocks.data())*m_blockSize;
+                XXHash_256(input+offset, std::min(m_blockSize,m_length-offset), blockHash.data());
+            });
+        }
+
+        inline void combine()
+        {
+            // the block hashes are contiguous, so hash the header first and the blocks straight from the vector
+            const uint64_t header[2] = {m_length,m_blockSize};
+            const size_t blockBytes = m_blocks.size()*sizeof(hash_t);
+            CXXHash256 hasher(sizeof(header)+blockBytes);
+            hasher.update(header, sizeof(header));
+            hasher.update(m_blocks.data(), blockBytes);
+            hasher.finalize(m_root.data());
+        }
+
+        const size_t m_blockSize;
+        size_t m_length;
+        std::vector<hash_t> m_blocks;
+        hash_t m_root;
+};
+
+}
+
+#endif
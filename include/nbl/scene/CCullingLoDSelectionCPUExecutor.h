@@ -0,0 +1,402 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SCENE_C_CULLING_LOD_SELECTION_CPU_EXECUTOR_H_INCLUDED_
+#define _NBL_SCENE_C_CULLING_LOD_SELECTION_CPU_EXECUTOR_H_INCLUDED_
+
+#include "nbl/core/execution.h"
+
+#include "nbl/scene/CLevelOfDetailLibrary.h"
+#include "nbl/scene/ICullingLoDSelectionSystem.h"
+
+namespace nbl::scene
+{
+
+//! CPU counterpart of `ICullingLoDSelectionSystem::processInstancesAndFillIndirectDraws`
+/**
+	Reads host copies of the `ILevelOfDetailLibrary` buffers and the same instance list, and fills the same draw indirect
+	commands, per view per instance data and instance redirects as the GPU would, for CPU bound platforms and for testing
+	LoD decisions without a device.
+
+	The stages are the shaders' own: instance frustum cull and LoD choice, an inclusive scan of the drawcall counts of the
+	potentially visible instances, the per drawcall frustum cull, an exclusive scan of the draw instance counts into
+	the base instances and the scatter of the instance redirects. Instances get culled 4 at a time and the drawcalls
+	of an instance 4 at a time, with the planes and AABBs in SoA SSE registers, the parallel stages run in chunks over the threads.
+
+	Where the GPU uses atomics, this compacts in order, so the output is deterministic and the same for any thread count,
+	but the order of potentially visible instances and draw instances can differ from the GPU's. The drawcall cull only does
+	the plane test, the second test of `nbl_glsl_fastFrustumCullAABB` doesn't depend on the drawcall AABB so it isn't repeated.
+
+	`PerViewPerInstance` is the C++ version of `nbl_glsl_PerViewPerInstance_t` and needs a `core::matrix4SIMD mvp` member.
+*/
+template<typename PerViewPerInstance, typename LoDChoiceParams=ILevelOfDetailLibrary::DefaultLoDChoiceParams>
+class CCullingLoDSelectionCPUExecutor final
+{
+	public:
+		using LoDTableInfo = ILevelOfDetailLibrary::LoDTableInfo;
+		using LoDInfo = typename CLevelOfDetailLibrary<LoDChoiceParams>::LoDInfo;
+		using DrawcallInfo = ILevelOfDetailLibrary::DrawcallInfo;
+		using InstanceToCull = ICullingLoDSelectionSystem::InstanceToCull;
+		using PotentiallyVisibleInstanceDraw = ICullingLoDSelectionSystem::PotentiallyVisisbleInstanceDraw;
+		//! an `uvec2` of the potentially visible instance buffer
+		struct PotentiallyVisibleInstance
+		{
+			uint32_t instanceGUID;
+			uint32_t lodInfoUvec2Offset;
+		};
+		//! an `uvec2` of the instance redirect buffer
+		struct InstanceRedirect
+		{
+			uint32_t instanceGUID;
+			uint32_t perViewPerInstanceID;
+		};
+
+		static inline constexpr uint32_t invalid = ILevelOfDetailLibrary::invalid;
+		//! instances or potentially visible instances processed by one task
+		static inline constexpr uint32_t ChunkSize = 1024u;
+
+		//! Host copies of the buffers of an `ILevelOfDetailLibrary`, addressed with the same offsets as on the GPU
+		struct SLoDLibrary
+		{
+			inline const LoDTableInfo& getTable(const uint32_t lodTableUvec4Offset) const
+			{
+				return *reinterpret_cast<const LoDTableInfo*>(reinterpret_cast<const uint8_t*>(lodTableInfos)+lodTableUvec4Offset*alignof(LoDTableInfo));
+			}
+			inline const LoDInfo& getLoD(const uint32_t lodInfoUvec2Offset) const
+			{
+				return *reinterpret_cast<const LoDInfo*>(reinterpret_cast<const uint8_t*>(lodInfos)+lodInfoUvec2Offset*alignof(DrawcallInfo));
+			}
+
+			const void* lodTableInfos = nullptr;
+			const void* lodInfos = nullptr;
+		};
+
+		//! Host pointers to what `ICullingLoDSelectionSystem::Params` and its descriptor sets point at
+		struct SParams
+		{
+			SLoDLibrary lodLibrary;
+			const InstanceToCull* instances = nullptr;
+			uint32_t instanceCount = 0u;
+			//! DWORD offsets of all the draws the LoDs can reference, the highest bit is set for non-indexed draws
+			const uint32_t* drawcallsToScan = nullptr;
+			uint32_t drawcallCount = 0u;
+			//! contents of the draw indirect buffer, the instance counts and base instances get overwritten
+			uint32_t* drawCalls = nullptr;
+			//! needs room for `instanceCount` elements
+			PerViewPerInstance* perViewPerInstance = nullptr;
+			InstanceRedirect* perInstanceRedirectAttribs = nullptr;
+			uint32_t maxTotalVisibleDrawcallInstances = 0u;
+		};
+
+		//! Culls the instances, chooses their LoDs and fills the draws, returns the number of visible drawcall instances
+		/**
+			At most `maxTotalVisibleDrawcallInstances` get written, the rest are dropped from the ends of the draws they overflow
+			(in `drawcallsToScan` order) and their instance counts are clamped to match.
+
+			`callbacks` stands in for the functions `instance_cull_and_lod_select.comp` needs defined, and gets called from many threads at once:
+			- `void initializePerViewPerInstanceData(PerViewPerInstance& pvpi, const uint32_t instanceGUID)` must set `pvpi.mvp`
+			- `uint32_t chooseLoD(PerViewPerInstance& pvpi, const uint32_t instanceGUID, const uint32_t lodTableUvec4Offset, const uint32_t lodCount)`
+			returns the uvec2 offset of the LoD or `invalid` to skip the instance, `chooseDefaultLoD` implements the usual distance based choice.
+			Unlike the shader which has globals, `pvpi` is the place to keep anything `finalizePerViewPerInstanceData` needs.
+			- `void finalizePerViewPerInstanceData(PerViewPerInstance& pvpi, const uint32_t instanceGUID, const uint32_t lodInfoUvec2Offset)`
+		*/
+		template<class ExecutionPolicy, class Callbacks>
+		inline uint32_t processInstancesAndFillIndirectDraws(ExecutionPolicy&& policy, const SParams& params, Callbacks& callbacks)
+		{
+			// instance cull and LoD selection, every chunk packs its survivors at its start
+			const uint32_t instanceChunkCount = getChunkCount(params.instanceCount);
+			m_chunkPVSInstances.resize(params.instanceCount);
+			m_perViewPerInstance.resize(params.instanceCount);
+			m_chunkOffsets.resize(instanceChunkCount+1u);
+			m_chunkOffsets[0] = 0u;
+			core::for_each(policy,m_chunkIDs.begin(),m_chunkIDs.begin()+instanceChunkCount,[&](const uint32_t chunk) -> void
+			{
+				m_chunkOffsets[chunk+1u] = cullAndSelectLoDs(params,callbacks,chunk);
+			});
+			std::inclusive_scan(m_chunkOffsets.begin(),m_chunkOffsets.end(),m_chunkOffsets.begin());
+
+			// concatenate the survivors of the chunks
+			const uint32_t pvsInstanceCount = m_chunkOffsets.back();
+			m_pvsInstances.resize(pvsInstanceCount);
+			m_lodDrawcallInclusiveCounts.resize(pvsInstanceCount);
+			core::for_each(policy,m_chunkIDs.begin(),m_chunkIDs.begin()+instanceChunkCount,[&](const uint32_t chunk) -> void
+			{
+				for (uint32_t outIx=m_chunkOffsets[chunk],inIx=chunk*ChunkSize; outIx<m_chunkOffsets[chunk+1u]; outIx++,inIx++)
+				{
+					m_pvsInstances[outIx] = m_chunkPVSInstances[inIx];
+					m_lodDrawcallInclusiveCounts[outIx] = params.lodLibrary.getLoD(m_pvsInstances[outIx].lodInfoUvec2Offset).drawcallInfoCount;
+					params.perViewPerInstance[outIx] = m_perViewPerInstance[inIx];
+				}
+			});
+			core::inclusive_scan(policy,m_lodDrawcallInclusiveCounts.begin(),m_lodDrawcallInclusiveCounts.end(),m_lodDrawcallInclusiveCounts.begin());
+
+			// drawcall cull of every potentially visible instance
+			const uint32_t drawInstanceCount = pvsInstanceCount ? m_lodDrawcallInclusiveCounts.back():0u;
+			m_drawInstanceVisible.resize(drawInstanceCount);
+			const uint32_t pvsChunkCount = getChunkCount(pvsInstanceCount);
+			core::for_each(policy,m_chunkIDs.begin(),m_chunkIDs.begin()+pvsChunkCount,[&](const uint32_t chunk) -> void
+			{
+				for (uint32_t pvInstanceID=chunk*ChunkSize; pvInstanceID<core::min((chunk+1u)*ChunkSize,pvsInstanceCount); pvInstanceID++)
+					cullDrawcalls(params,pvInstanceID);
+			});
+
+			// count the instances of every draw in order, the shader does it with atomics
+			for (uint32_t i=0u; i<params.drawcallCount; i++)
+				params.drawCalls[(params.drawcallsToScan[i]&0x7fffffffu)+1u] = 0u;
+			m_pvsInstanceDraws.clear();
+			for (uint32_t pvInstanceID=0u; pvInstanceID<pvsInstanceCount; pvInstanceID++)
+			{
+				const auto& lod = params.lodLibrary.getLoD(m_pvsInstances[pvInstanceID].lodInfoUvec2Offset);
+				const uint32_t firstDrawInstance = pvInstanceID ? m_lodDrawcallInclusiveCounts[pvInstanceID-1u]:0u;
+				for (uint32_t drawcallID=0u; drawcallID<lod.drawcallInfoCount; drawcallID++)
+				if (m_drawInstanceVisible[firstDrawInstance+drawcallID])
+				{
+					const uint32_t drawcallDWORDOffsetAndFlag = lod.drawcallInfos[drawcallID].getDrawcallDWORDOffset();
+					const uint32_t drawcallDWORDOffset = drawcallDWORDOffsetAndFlag&0x7fffffffu;
+					PotentiallyVisibleInstanceDraw draw;
+					draw.perViewPerInstanceID = pvInstanceID;
+					draw.drawBaseInstanceDWORDOffset = drawcallDWORDOffset+4u-(drawcallDWORDOffsetAndFlag>>31u);
+					draw.instanceID = params.drawCalls[drawcallDWORDOffset+1u]++;
+					m_pvsInstanceDraws.push_back(draw);
+				}
+			}
+
+			// base instances are the exclusive scan of the instance counts in `drawcallsToScan` order,
+			// the counts get clamped so no draw reaches past `maxTotalVisibleDrawcallInstances`
+			uint32_t baseInstance = 0u;
+			for (uint32_t i=0u; i<params.drawcallCount; i++)
+			{
+				const uint32_t drawcallDWORDOffset = params.drawcallsToScan[i]&0x7fffffffu;
+				params.drawCalls[drawcallDWORDOffset+4u-(params.drawcallsToScan[i]>>31u)] = baseInstance;
+				auto& instanceCount = params.drawCalls[drawcallDWORDOffset+1u];
+				instanceCount = core::min(instanceCount,params.maxTotalVisibleDrawcallInstances-baseInstance);
+				baseInstance += instanceCount;
+			}
+
+			// scatter the instance redirects, the ones clamped off above land past the end and get dropped
+			const uint32_t visibleDrawInstanceCount = static_cast<uint32_t>(m_pvsInstanceDraws.size());
+			const uint32_t drawInstanceChunkCount = getChunkCount(visibleDrawInstanceCount);
+			core::for_each(policy,m_chunkIDs.begin(),m_chunkIDs.begin()+drawInstanceChunkCount,[&](const uint32_t chunk) -> void
+			{
+				for (uint32_t i=chunk*ChunkSize; i<core::min((chunk+1u)*ChunkSize,visibleDrawInstanceCount); i++)
+				{
+					const auto& draw = m_pvsInstanceDraws[i];
+					const uint32_t instanceIndex = params.drawCalls[draw.drawBaseInstanceDWORDOffset]+draw.instanceID;
+					if (instanceIndex<params.maxTotalVisibleDrawcallInstances)
+						params.perInstanceRedirectAttribs[instanceIndex] = {m_pvsInstances[draw.perViewPerInstanceID].instanceGUID,draw.perViewPerInstanceID};
+				}
+			});
+			assert(baseInstance==core::min(visibleDrawInstanceCount,params.maxTotalVisibleDrawcallInstances));
+			return baseInstance;
+		}
+		template<class Callbacks>
+		inline uint32_t processInstancesAndFillIndirectDraws(const SParams& params, Callbacks& callbacks)
+		{
+			return processInstancesAndFillIndirectDraws(core::execution::par_unseq,params,callbacks);
+		}
+
+		//! The LoD choice of `examples_tests/11.LoDSystem`, the last LoD whose threshold scaled by `ILevelOfDetailLibrary::DefaultLoDChoiceParams::getFoVDilationFactor` is at least `distanceSq`
+		static inline uint32_t chooseDefaultLoD(const SLoDLibrary& lodLibrary, const uint32_t lodTableUvec4Offset, const float distanceSq, const float fovDilationFactor, uint32_t* lodID=nullptr)
+		{
+			const auto& table = lodLibrary.getTable(lodTableUvec4Offset);
+			uint32_t lodInfoUvec2Offset = invalid;
+			uint32_t i = 0u;
+			for (; i<table.levelCount; i++)
+			{
+				const uint32_t nextLoD = table.leveInfoUvec2Offsets[i];
+				if (distanceSq>lodLibrary.getLoD(nextLoD).choiceParams.distanceSqAtReferenceFoV*fovDilationFactor)
+					break;
+				lodInfoUvec2Offset = nextLoD;
+			}
+			if (lodID)
+				*lodID = i-1u;
+			return lodInfoUvec2Offset;
+		}
+
+		//! the instances which survived the instance cull, in instance list order
+		inline const core::vector<PotentiallyVisibleInstance>& getPotentiallyVisibleInstances() const {return m_pvsInstances;}
+		//! the draw instances which survived the drawcall cull
+		inline const core::vector<PotentiallyVisibleInstanceDraw>& getPotentiallyVisibleInstanceDraws() const {return m_pvsInstanceDraws;}
+
+	private:
+		//! `nbl_glsl_shapes_Frustum_t` of 4 instances, `planes[p][c]` holds component `c` of the `p`-th plane for every lane
+		struct SFrustums
+		{
+			__m128 planes[6][4];
+		};
+		struct SAABBs
+		{
+			__m128 minVx[3];
+			__m128 maxVx[3];
+		};
+
+		//! `nbl_glsl_shapes_Frustum_extract` with the NDC bounds of `nbl_glsl_fastestFrustumCullAABB`
+		static inline void extractPlanes(const core::matrix4SIMD& mvp, __m128 (&planes)[6])
+		{
+			const __m128 r3 = mvp.rows[3].getAsRegister();
+			const float ndcMin[3] = {-1.f,-1.f,0.f};
+			for (uint32_t i=0u; i<3u; i++)
+			{
+				const __m128 r = mvp.rows[i].getAsRegister();
+				planes[i] = _mm_sub_ps(r,_mm_mul_ps(r3,_mm_set1_ps(ndcMin[i])));
+				planes[i+3u] = _mm_sub_ps(_mm_mul_ps(r3,_mm_set1_ps(1.f)),r);
+			}
+		}
+		static inline void extractFrustums(const core::matrix4SIMD* const (&mvps)[4], SFrustums& frustums)
+		{
+			__m128 planes[4][6];
+			for (uint32_t lane=0u; lane<4u; lane++)
+				extractPlanes(*mvps[lane],planes[lane]);
+			for (uint32_t p=0u; p<6u; p++)
+			{
+				auto& soa = frustums.planes[p];
+				soa[0] = planes[0][p];
+				soa[1] = planes[1][p];
+				soa[2] = planes[2][p];
+				soa[3] = planes[3][p];
+				_MM_TRANSPOSE4_PS(soa[0],soa[1],soa[2],soa[3]);
+			}
+		}
+		static inline void broadcastFrustum(const core::matrix4SIMD& mvp, SFrustums& frustums)
+		{
+			__m128 planes[6];
+			extractPlanes(mvp,planes);
+			for (uint32_t p=0u; p<6u; p++)
+			{
+				frustums.planes[p][0] = _mm_shuffle_ps(planes[p],planes[p],_MM_SHUFFLE(0,0,0,0));
+				frustums.planes[p][1] = _mm_shuffle_ps(planes[p],planes[p],_MM_SHUFFLE(1,1,1,1));
+				frustums.planes[p][2] = _mm_shuffle_ps(planes[p],planes[p],_MM_SHUFFLE(2,2,2,2));
+				frustums.planes[p][3] = _mm_shuffle_ps(planes[p],planes[p],_MM_SHUFFLE(3,3,3,3));
+			}
+		}
+		//! `nbl_glsl_shapes_Frustum_fastestDoesNotIntersectAABB` for 4 lanes, returns a bitmask of the culled ones
+		static inline uint32_t cullMask(const SFrustums& frustums, const SAABBs& aabbs)
+		{
+			const __m128 zero = _mm_setzero_ps();
+			__m128 culled = zero;
+			for (const auto& plane : frustums.planes)
+			{
+				// dot of the farthest point in front of the plane with the normal, plus the offset
+				__m128 dp;
+				for (uint32_t c=0u; c<3u; c++)
+				{
+					const __m128 negative = _mm_cmplt_ps(plane[c],zero);
+					const __m128 farthest = _mm_or_ps(_mm_and_ps(negative,aabbs.minVx[c]),_mm_andnot_ps(negative,aabbs.maxVx[c]));
+					dp = c ? _mm_add_ps(dp,_mm_mul_ps(farthest,plane[c])):_mm_mul_ps(farthest,plane[c]);
+				}
+				culled = _mm_or_ps(culled,_mm_cmple_ps(_mm_add_ps(dp,plane[3]),zero));
+			}
+			return static_cast<uint32_t>(_mm_movemask_ps(culled));
+		}
+
+		inline uint32_t getChunkCount(const uint32_t count)
+		{
+			const uint32_t chunkCount = (count+ChunkSize-1u)/ChunkSize;
+			for (auto i=static_cast<uint32_t>(m_chunkIDs.size()); i<chunkCount; i++)
+				m_chunkIDs.push_back(i);
+			return chunkCount;
+		}
+
+		//! `instance_cull_and_lod_select.comp` for a chunk, returns the number of instances with a LoD packed at the start of the chunk
+		template<class Callbacks>
+		inline uint32_t cullAndSelectLoDs(const SParams& params, Callbacks& callbacks, const uint32_t chunk)
+		{
+			uint32_t survivors = 0u;
+			const uint32_t end = core::min((chunk+1u)*ChunkSize,params.instanceCount);
+			for (uint32_t first=chunk*ChunkSize; first<end; first+=4u)
+			{
+				// a partial batch repeats its last instance
+				const uint32_t batchSize = core::min(end-first,4u);
+				PerViewPerInstance batch[4];
+				const core::matrix4SIMD* mvps[4];
+				alignas(16) float aabbs[2][3][4];
+				for (uint32_t lane=0u; lane<4u; lane++)
+				{
+					const uint32_t instanceID = first+core::min(lane,batchSize-1u);
+					if (lane<batchSize)
+						callbacks.initializePerViewPerInstanceData(batch[lane],params.instances[instanceID].instanceGUID);
+					mvps[lane] = &batch[core::min(lane,batchSize-1u)].mvp;
+					const auto& table = params.lodLibrary.getTable(params.instances[instanceID].lodTableUvec4Offset);
+					for (uint32_t c=0u; c<3u; c++)
+					{
+						aabbs[0][c][lane] = table.aabbMin[c];
+						aabbs[1][c][lane] = table.aabbMax[c];
+					}
+				}
+				SFrustums frustums;
+				extractFrustums(mvps,frustums);
+				SAABBs soa;
+				for (uint32_t c=0u; c<3u; c++)
+				{
+					soa.minVx[c] = _mm_load_ps(aabbs[0][c]);
+					soa.maxVx[c] = _mm_load_ps(aabbs[1][c]);
+				}
+				const uint32_t culled = cullMask(frustums,soa);
+
+				for (uint32_t lane=0u; lane<batchSize; lane++)
+				{
+					if (culled&(0x1u<<lane))
+						continue;
+					const auto& instance = params.instances[first+lane];
+					auto& pvpi = batch[lane];
+					const uint32_t lodInfoUvec2Offset = callbacks.chooseLoD(pvpi,instance.instanceGUID,instance.lodTableUvec4Offset,params.lodLibrary.getTable(instance.lodTableUvec4Offset).levelCount);
+					if (lodInfoUvec2Offset==invalid)
+						continue;
+					callbacks.finalizePerViewPerInstanceData(pvpi,instance.instanceGUID,lodInfoUvec2Offset);
+					const uint32_t outIx = chunk*ChunkSize+(survivors++);
+					m_chunkPVSInstances[outIx] = {instance.instanceGUID,lodInfoUvec2Offset};
+					m_perViewPerInstance[outIx] = pvpi;
+				}
+			}
+			return survivors;
+		}
+
+		//! the AABB test of `instance_draw_cull.comp` for all drawcalls of a potentially visible instance
+		inline void cullDrawcalls(const SParams& params, const uint32_t pvInstanceID)
+		{
+			const auto& lod = params.lodLibrary.getLoD(m_pvsInstances[pvInstanceID].lodInfoUvec2Offset);
+			uint8_t* const visible = m_drawInstanceVisible.data()+(pvInstanceID ? m_lodDrawcallInclusiveCounts[pvInstanceID-1u]:0u);
+
+			SFrustums frustum;
+			broadcastFrustum(params.perViewPerInstance[pvInstanceID].mvp,frustum);
+			const uint32_t drawcallCount = lod.drawcallInfoCount;
+			for (uint32_t first=0u; first<drawcallCount; first+=4u)
+			{
+				const uint32_t batchSize = core::min(drawcallCount-first,4u);
+				alignas(16) float aabbs[2][3][4];
+				for (uint32_t lane=0u; lane<4u; lane++)
+				{
+					const auto aabb = lod.drawcallInfos[first+core::min(lane,batchSize-1u)].getAABB().decompress();
+					for (uint32_t c=0u; c<3u; c++)
+					{
+						aabbs[0][c][lane] = (&aabb.MinEdge.X)[c];
+						aabbs[1][c][lane] = (&aabb.MaxEdge.X)[c];
+					}
+				}
+				SAABBs soa;
+				for (uint32_t c=0u; c<3u; c++)
+				{
+					soa.minVx[c] = _mm_load_ps(aabbs[0][c]);
+					soa.maxVx[c] = _mm_load_ps(aabbs[1][c]);
+				}
+				const uint32_t culled = cullMask(frustum,soa);
+				for (uint32_t lane=0u; lane<batchSize; lane++)
+					visible[first+lane] = !(culled&(0x1u<<lane));
+			}
+		}
+
+		//! the survivors of every chunk, packed at the chunk's start
+		core::vector<PotentiallyVisibleInstance> m_chunkPVSInstances;
+		core::vector<PerViewPerInstance> m_perViewPerInstance;
+		core::vector<uint32_t> m_chunkIDs;
+		core::vector<uint32_t> m_chunkOffsets;
+		core::vector<PotentiallyVisibleInstance> m_pvsInstances;
+		core::vector<uint32_t> m_lodDrawcallInclusiveCounts;
+		core::vector<uint8_t> m_drawInstanceVisible;
+		core::vector<PotentiallyVisibleInstanceDraw> m_pvsInstanceDraws;
+};
+
+}
+
+#endif
@@ -0,0 +1,124 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef _NBL_SCENE_C_TRANSFORM_TREE_CPU_EXECUTOR_H_INCLUDED_
+#define _NBL_SCENE_C_TRANSFORM_TREE_CPU_EXECUTOR_H_INCLUDED_
+
+#include "nbl/core/execution.h"
+
+#include "nbl/scene/ITransformTreeManager.h"
+
+namespace nbl::scene
+{
+
+//! CPU counterpart of `ITransformTreeManager::updateLocalTransforms` and `ITransformTreeManager::recomputeGlobalTransforms`
+/**
+	Works on host arrays laid out like the node property pool of an `ITransformTree`, those can be mapped pool buffers
+	or mirrors you upload with the `CPropertyPoolHandler` afterwards. Meant for headless simulation, for validating the GPU path
+	and for trees so small that a dispatch costs more than the work.
+
+	Instead of every node walking up to its root like an invocation of the shader does, `schedule` sorts the nodes to recompute
+	and all of their ancestors into levels by depth once, then `recomputeGlobalTransforms` runs level after level with every level
+	split into chunks over the threads. Within a level the nodes are ascending, so the property arrays get walked forwards.
+	The schedule stays valid until the hierarchy or the set of nodes to recompute changes.
+
+	The arithmetic is the shaders' own, in the same order and without fused multiply-adds, so the relative and global transforms
+	are bit-identical to the GPU's as long as its compiler doesn't contract them either. Normal matrices use the same formula,
+	but GPUs may divide less precisely and round `packSnorm2x16` ties differently, so they can differ in the last bit.
+	Unlike the shader, which gives up on nodes deeper than `MaxGPUDepth`, any depth works.
+*/
+class CTransformTreeCPUExecutor final
+{
+	public:
+		using node_t = ITransformTree::node_t;
+		using ModificationRequestRange = ITransformTreeManager::ModificationRequestRange;
+		using RelativeTransformModificationRequest = ITransformTreeManager::RelativeTransformModificationRequest;
+		using normal_matrix_t = ITransformTreeWithNormalMatrices::normal_matrix_t;
+
+		//! `NBL_GLSL_TRANSFORM_TREE_MAX_DEPTH`
+		static inline constexpr uint32_t MaxGPUDepth = 13u;
+		//! nodes of a level processed by one task
+		static inline constexpr uint32_t ChunkSize = 2048u;
+
+		//! Host side node properties, every array is indexed by `node_t` and has room for `capacity` nodes
+		struct SNodeProperties
+		{
+			ITransformTree::parent_t* parents = nullptr;
+			ITransformTree::relative_transform_t* relativeTransforms = nullptr;
+			ITransformTree::modified_stamp_t* modifiedTimestamps = nullptr;
+			ITransformTree::global_transform_t* globalTransforms = nullptr;
+			ITransformTree::recomputed_stamp_t* recomputedTimestamps = nullptr;
+			//! optional, only for trees with normal matrices
+			normal_matrix_t* normalMatrices = nullptr;
+			uint32_t capacity = 0u;
+		};
+
+		//! Applies the modification requests of every range to its node's relative transform and stamps the node with the range's `newTimestamp`
+		/** Every range needs to be for a different node, like in the GPU version. */
+		template<class ExecutionPolicy>
+		static inline void updateLocalTransforms(ExecutionPolicy&& policy, const SNodeProperties& nodes, const ModificationRequestRange* rangesBegin, const ModificationRequestRange* rangesEnd, const RelativeTransformModificationRequest* requests)
+		{
+			core::for_each(policy,rangesBegin,rangesEnd,[&](const ModificationRequestRange& range) -> void {updateLocalTransform(nodes,range,requests);});
+		}
+		static inline void updateLocalTransforms(const SNodeProperties& nodes, const ModificationRequestRange* rangesBegin, const ModificationRequestRange* rangesEnd, const RelativeTransformModificationRequest* requests)
+		{
+			updateLocalTransforms(core::execution::par_unseq,nodes,rangesBegin,rangesEnd,requests);
+		}
+
+		//! Sorts [nodesBegin,nodesEnd) and all their ancestors into levels, only `nodes.parents` gets read
+		void schedule(const SNodeProperties& nodes, const node_t* nodesBegin, const node_t* nodesEnd);
+
+		//! Recomputes the global transforms (and normal matrices, if present) of the scheduled nodes whose recomputed timestamp is out of date
+		template<class ExecutionPolicy>
+		inline void recomputeGlobalTransforms(ExecutionPolicy&& policy, const SNodeProperties& nodes) const
+		{
+			assert(nodes.capacity==m_capacity);
+			// every level only reads the levels above it
+			for (uint32_t level=0u; level<getLevelCount(); level++)
+			{
+				const auto* const chunksBegin = m_chunks.data()+m_levelChunkOffsets[level];
+				const auto* const chunksEnd = m_chunks.data()+m_levelChunkOffsets[level+1u];
+				core::for_each(policy,chunksBegin,chunksEnd,[&](const SChunk& chunk) -> void {recomputeChunk(nodes,chunk,level);});
+			}
+		}
+		inline void recomputeGlobalTransforms(const SNodeProperties& nodes) const
+		{
+			recomputeGlobalTransforms(core::execution::par_unseq,nodes);
+		}
+
+		//!
+		inline uint32_t getLevelCount() const {return static_cast<uint32_t>(m_levelChunkOffsets.size())-1u;}
+		//! requested nodes and their ancestors, each once
+		inline uint32_t getScheduledNodeCount() const {return static_cast<uint32_t>(m_order.size());}
+
+		//! `nbl_glsl_pseudoMul4x3with4x3`, unlike `matrix3x4SIMD::concatenateBFollowedByA` it leaves the first 3 columns alone after the products
+		static core::matrix3x4SIMD concatenate(const core::matrix3x4SIMD& parent, const core::matrix3x4SIMD& relative);
+		//! `nbl_glsl_transform_tree_relative_transform_modification_t_apply`
+		static core::matrix3x4SIMD applyModification(const core::matrix3x4SIMD& relative, const RelativeTransformModificationRequest& request);
+		//! `nbl_glsl_sub3x3TransposeCofactors` followed by `nbl_glsl_CompressedNormalMatrix_t_encode`
+		static normal_matrix_t encodeNormalMatrix(const core::matrix3x4SIMD& globalTransform);
+
+	private:
+		struct SChunk
+		{
+			uint32_t begin,end;
+		};
+
+		static void updateLocalTransform(const SNodeProperties& nodes, const ModificationRequestRange& range, const RelativeTransformModificationRequest* requests);
+		void recomputeChunk(const SNodeProperties& nodes, const SChunk& chunk, const uint32_t level) const;
+
+		uint32_t m_capacity = 0u;
+		//! scheduled nodes, level after level
+		core::vector<node_t> m_order;
+		core::vector<SChunk> m_chunks;
+		//! one past the last level is the end
+		core::vector<uint32_t> m_levelChunkOffsets = {0u};
+		//! scratch of `schedule`
+		core::vector<uint32_t> m_levels;
+		core::vector<node_t> m_stack;
+};
+
+}
+
+#endif
@@ -30,6 +30,8 @@ class ICullingLoDSelectionSystem : public virtual core::IReferenceCounted
 			uint32_t instanceGUID;
 			uint32_t lodTableUvec4Offset;
 		};
+		#include "nbl/builtin/glsl/culling_lod_selection/potentially_visible_instance_draw_struct.glsl"
+		using PotentiallyVisisbleInstanceDraw = nbl_glsl_culling_lod_selection_PotentiallyVisibleInstanceDraw_t;
 
 		//
 		static core::smart_refctd_ptr<video::IGPUBuffer> createDispatchIndirectBuffer(video::IUtilities* utils, video::IGPUQueue* queue)
@@ -548,9 +550,6 @@ class ICullingLoDSelectionSystem : public virtual core::IReferenceCounted
 				m_workgroupSize(workgroupSize)
 		{
 		}
-		
-		#include "nbl/builtin/glsl/culling_lod_selection/potentially_visible_instance_draw_struct.glsl"
-		using PotentiallyVisisbleInstanceDraw = nbl_glsl_culling_lod_selection_PotentiallyVisibleInstanceDraw_t;
 
 		core::smart_refctd_ptr<video::CScanner> m_scanner;
 		core::smart_refctd_ptr<video::IGPUPipelineLayout> m_instanceCullAndLoDSelectLayout,m_instanceDrawCullLayout,m_instanceRefCountingSortPipelineLayout;
@@ -108,6 +108,10 @@ class ILevelOfDetailLibrary : public virtual core::IReferenceCounted
 				DrawcallInfo(const uint32_t _drawcallDWORDOffset, const core::aabbox3df& _aabb)
 					: aabb(_aabb), drawcallDWORDOffset(_drawcallDWORDOffset) {}
 
+				inline const core::CompressedAABB& getAABB() const {return aabb;}
+				// highest bit is set for non-indexed draws
+				inline uint32_t getDrawcallDWORDOffset() const {return drawcallDWORDOffset;}
+
 			private:
 				core::CompressedAABB aabb;
 				uint32_t drawcallDWORDOffset; // only really need 27 bits for this
@@ -8,8 +8,10 @@
 //
 #include "nbl/scene/CLevelOfDetailLibrary.h"
 #include "nbl/scene/ITransformTreeManager.h"
+#include "nbl/scene/CTransformTreeCPUExecutor.h"
 
 #include "nbl/scene/ICullingLoDSelectionSystem.h"
+#include "nbl/scene/CCullingLoDSelectionCPUExecutor.h"
 
 #if 0 // not buildable on criss/vulkan branch
 //
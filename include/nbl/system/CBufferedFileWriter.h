@@ -0,0 +1,196 @@
+#ifndef _NBL_SYSTEM_C_BUFFERED_FILE_WRITER_H_INCLUDED_
+#define _NBL_SYSTEM_C_BUFFERED_FILE_WRITER_H_INCLUDED_
+
+#include <charconv>
+#include <memory>
+#include <optional>
+#include <string_view>
+
+#include "nbl/system/IFile.h"
+
+namespace nbl::system
+{
+
+//! Write-combining output stream on top of an `IFile`, for writers which produce a file in many small pieces
+/**
+	Every `IFile::write` of an unmapped file is a round-trip to the ISystem dispatcher thread, so writing a mesh
+	one vertex component or one "\n" at a time costs a future wait each. This collects the writes in large buffers
+	and submits a full buffer without waiting for it, while the dispatcher writes one buffer the caller fills the other.
+	Only reusing a buffer which is still in flight waits.
+
+	Text goes straight into the buffer through `std::to_chars`, no streams or temporary strings.
+
+	Errors are sticky, `flush()` reports whether everything got written. The destructor flushes but can't report.
+	Not thread-safe.
+*/
+class CBufferedFileWriter final
+{
+	public:
+		_NBL_STATIC_INLINE_CONSTEXPR size_t DefaultBufferSize = 0x1ull<<20ull;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t BufferCount = 2u;
+		//! enough for any number `writeText` formats
+		_NBL_STATIC_INLINE_CONSTEXPR size_t MaxNumberTextSize = 64ull;
+
+		CBufferedFileWriter(IFile* _file, size_t _offset=0ull, size_t _bufferSize=DefaultBufferSize) :
+			m_file(_file), m_bufferSize(core::max(_bufferSize,MaxNumberTextSize)), m_offset(_offset)
+		{
+			for (auto& buffer : m_buffers)
+				buffer.data = std::make_unique<char[]>(m_bufferSize);
+		}
+		CBufferedFileWriter(const CBufferedFileWriter&) = delete;
+		CBufferedFileWriter& operator=(const CBufferedFileWriter&) = delete;
+		~CBufferedFileWriter()
+		{
+			flush();
+		}
+
+		inline void write(const void* _data, size_t _size)
+		{
+			if (m_used+_size<=m_bufferSize)
+			{
+				memcpy(m_buffers[m_current].data.get()+m_used,_data,_size);
+				m_used += _size;
+			}
+			else
+				writeUncombined(_data,_size);
+		}
+		//! Writes the bytes of a trivially copyable value
+		template<typename T>
+		inline void writeValue(const T& _value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			write(&_value,sizeof(T));
+		}
+
+		inline void writeText(const std::string_view& _str) { write(_str.data(),_str.size()); }
+		inline void writeText(const char _c) { write(&_c,1ull); }
+		//! Same text as `std::ostream` would produce with default settings for integers, shortest round-trip representation for floats
+		template<typename T> requires (std::is_arithmetic_v<T> && !std::is_same_v<T,char> && !std::is_same_v<T,bool>)
+		inline void writeText(const T _value)
+		{
+			char* const out = reserve(MaxNumberTextSize);
+			commit(std::to_chars(out,out+MaxNumberTextSize,_value).ptr-out);
+		}
+		//! `printf`-like formatting of floats, `std::chars_format::general` with precision 6 matches the `std::ostream` default
+		template<typename T> requires std::is_floating_point_v<T>
+		inline void writeText(const T _value, const std::chars_format _fmt, const int _precision)
+		{
+			char* const out = reserve(MaxNumberTextSize);
+			const auto result = std::to_chars(out,out+MaxNumberTextSize,_value,_fmt,_precision);
+			// only huge numbers in fixed notation can overflow, fall back to the exponent
+			if (result.ec!=std::errc())
+				commit(std::to_chars(out,out+MaxNumberTextSize,_value,std::chars_format::scientific,_precision).ptr-out);
+			else
+				commit(result.ptr-out);
+		}
+
+		//! Space for formatting up to `_size` bytes (at most the buffer size) in place, has to be followed by `commit`
+		inline char* reserve(const size_t _size)
+		{
+			assert(_size<=m_bufferSize);
+			if (m_used+_size>m_bufferSize)
+				submit();
+			return m_buffers[m_current].data.get()+m_used;
+		}
+		//! `_size` can be less than what got reserved
+		inline void commit(const size_t _size)
+		{
+			assert(m_used+_size<=m_bufferSize);
+			m_used += _size;
+		}
+
+		//! File offset of the next byte to be written
+		inline size_t getOffset() const { return m_offset+m_used; }
+		//! Continues writing at `_offset`, for formats which patch a header or a table after writing the rest
+		inline void seek(const size_t _offset)
+		{
+			if (_offset==getOffset())
+				return;
+			flush();
+			m_offset = _offset;
+		}
+
+		//! Submits what's buffered and waits for all the writes, returns false if any of them since the creation failed
+		inline bool flush()
+		{
+			submit();
+			for (auto& buffer : m_buffers)
+				wait(buffer);
+			return !m_failed;
+		}
+		inline bool good() const { return !m_failed; }
+
+		inline IFile* getFile() const { return m_file; }
+
+	private:
+		struct SBuffer
+		{
+			std::unique_ptr<char[]> data;
+			std::optional<ISystem::future_t<size_t>> pending;
+			size_t pendingSize = 0ull;
+		};
+
+		inline void wait(SBuffer& _buffer)
+		{
+			if (!_buffer.pending)
+				return;
+			if (_buffer.pending->get()!=_buffer.pendingSize)
+				m_failed = true;
+			_buffer.pending.reset();
+		}
+		//! hands the current buffer over to the file and makes the next one current, waiting if it's still being written
+		inline void submit()
+		{
+			if (!m_used)
+				return;
+			auto& buffer = m_buffers[m_current];
+			buffer.pending.emplace();
+			buffer.pendingSize = m_used;
+			m_file->write(*buffer.pending,buffer.data.get(),m_offset,m_used);
+			m_offset += m_used;
+			m_used = 0ull;
+
+			m_current = (m_current+1u)%BufferCount;
+			wait(m_buffers[m_current]);
+		}
+		inline void writeUncombined(const void* _data, size_t _size)
+		{
+			const auto* bytes = reinterpret_cast<const char*>(_data);
+			// top up the current buffer so it goes out full
+			const size_t fill = m_bufferSize-m_used;
+			memcpy(m_buffers[m_current].data.get()+m_used,bytes,fill);
+			m_used += fill;
+			bytes += fill;
+			_size -= fill;
+			submit();
+
+			// large writes skip the copy, but we don't own the memory so have to wait
+			if (_size>=m_bufferSize)
+			{
+				ISystem::future_t<size_t> future;
+				m_file->write(future,bytes,m_offset,_size);
+				if (future.get()!=_size)
+					m_failed = true;
+				m_offset += _size;
+			}
+			else
+			{
+				memcpy(m_buffers[m_current].data.get(),bytes,_size);
+				m_used = _size;
+			}
+		}
+
+		IFile* const m_file;
+		const size_t m_bufferSize;
+		SBuffer m_buffers[BufferCount];
+		uint32_t m_current = 0u;
+		//! bytes in the current buffer
+		size_t m_used = 0ull;
+		//! file offset the current buffer will be written at
+		size_t m_offset;
+		bool m_failed = false;
+};
+
+}
+
+#endif
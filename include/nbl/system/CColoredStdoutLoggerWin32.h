@@ -20,10 +20,10 @@ class CColoredStdoutLoggerWin32 : public IThreadsafeLogger
 		}
 
 	private:
-		virtual void threadsafeLog_impl(const std::string_view& fmt, E_LOG_LEVEL logLevel, va_list args) override
+		virtual void threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel) override
 		{
 			SetConsoleTextAttribute(m_native_console, getConsoleColor(logLevel));
-			printf(constructLogString(fmt, logLevel, args).data());
+			fwrite(line.data(), 1, line.size(), stdout);
 			fflush(stdout);
 			SetConsoleTextAttribute(m_native_console, 15); // restore to white
 		}
@@ -1,28 +1,32 @@
 #ifndef _NBL_SYSTEM_C_FILE_LOGGER_INCLUDED_
 #define _NBL_SYSTEM_C_FILE_LOGGER_INCLUDED_
 
-#include "nbl/system/IThreadsafeLogger.h"
+#include "nbl/system/IAsyncLogger.h"
 #include "nbl/system/IFile.h"
 
 namespace nbl::system
 {
 
-class CFileLogger : public IThreadsafeLogger
+//! Appends the log to a file, one write per batch of lines from the flusher thread
+class CFileLogger : public IAsyncLogger
 {
 	public:
-		CFileLogger(core::smart_refctd_ptr<IFile>&& _file, const bool append, const core::bitflag<E_LOG_LEVEL> logLevelMask=ILogger::defaultLogMask())
-			: IThreadsafeLogger(logLevelMask), m_file(std::move(_file)), m_pos(append ? m_file->getSize():0ull)
+		CFileLogger(core::smart_refctd_ptr<IFile>&& _file, const bool append, const core::bitflag<E_LOG_LEVEL> logLevelMask=ILogger::defaultLogMask(), const SCreationParams& params={})
+			: IAsyncLogger(logLevelMask,params), m_file(std::move(_file)), m_pos(append ? m_file->getSize():0ull)
 		{
+			startFlusher();
 		}
 
 	protected:
-		~CFileLogger() = default;
+		~CFileLogger()
+		{
+			stopFlusher();
+		}
 
-		virtual void threadsafeLog_impl(const std::string_view& fmt, E_LOG_LEVEL logLevel, va_list args) override
+		virtual void writeBatch(const std::string_view& batch) override
 		{
-			const auto str = constructLogString(fmt, logLevel, args);
 			ISystem::future_t<size_t> future;
-			m_file->write(future,str.data(),m_pos,str.length());
+			m_file->write(future,batch.data(),m_pos,batch.size());
 			m_pos += future.get(); // need to use the future to make sure op is actually executed :(
 		}
 
@@ -32,4 +36,4 @@ class CFileLogger : public IThreadsafeLogger
 
 }
 
-#endif
\ No newline at end of file
+#endif
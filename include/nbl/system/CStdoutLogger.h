@@ -13,9 +13,9 @@ class CStdoutLogger : public IThreadsafeLogger
 		CStdoutLogger(core::bitflag<E_LOG_LEVEL> logLevelMask = ILogger::defaultLogMask()) : IThreadsafeLogger(logLevelMask) {}
 
 	protected:
-		virtual void threadsafeLog_impl(const std::string_view& fmt, E_LOG_LEVEL logLevel, va_list args) override
+		virtual void threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel) override
 		{
-			printf(constructLogString(fmt, logLevel, args).data());
+			fwrite(line.data(), 1, line.size(), stdout);
 			fflush(stdout);
 		}
 
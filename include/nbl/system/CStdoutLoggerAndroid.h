@@ -13,7 +13,7 @@ class CStdoutLoggerAndroid : public IThreadsafeLogger
 		CStdoutLoggerAndroid(core::bitflag<E_LOG_LEVEL> logLevelMask = ILogger::defaultLogMask()) : IThreadsafeLogger(logLevelMask) {}
 
 	private:
-		void threadsafeLog_impl(const std::string_view& fmt, E_LOG_LEVEL logLevel, va_list args) override;
+		void threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel) override;
 };
 #endif
 
@@ -0,0 +1,302 @@
+#ifndef _NBL_SYSTEM_I_ASYNC_LOGGER_INCLUDED_
+#define _NBL_SYSTEM_I_ASYNC_LOGGER_INCLUDED_
+
+#include "nbl/core/containers/CMPSCRingBuffer.h"
+
+#include "nbl/system/ILogger.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace nbl::system
+{
+
+//! Logger which formats on the calling thread and leaves the output to a background flusher thread
+/**
+	Every thread formats its lines into its own buffer without any lock and swaps the buffer into a lock-free queue,
+	the strings circulate between the threads and the queue so once warmed up logging doesn't allocate.
+	The flusher wakes up every `flushInterval` (or when asked) and hands everything queued to `writeBatch` at once,
+	so a sink such as a file sees one write per batch instead of one per line.
+
+	Levels in `flushLevelMask` (errors by default) are never dropped and `log` only returns once they're written,
+	so the last words before a crash make it into the log.
+
+	Derived classes have to call `startFlusher` at the end of their constructor and `stopFlusher` in their destructor,
+	the flusher calls `writeBatch` which must not run while the derived object is only partially constructed or destroyed.
+	When the flusher can't make progress, because it's stopping or because `writeBatch` itself logs, a line which would have to wait
+	gets written right away by the logging thread instead, out of order with whatever is still queued.
+	A line which makes it into the queue after the flusher's last round gets written by the thread which logged it.
+*/
+class IAsyncLogger : public ILogger
+{
+	public:
+		enum E_OVERFLOW_POLICY : uint8_t
+		{
+			//! logging waits until the flusher makes space in the queue
+			EOP_BLOCK,
+			//! the line gets dropped, the log gets a note how many were lost
+			EOP_DROP
+		};
+		struct SCreationParams
+		{
+			//! lines in flight, must be a power of two
+			uint32_t queueCapacity = 4096u;
+			E_OVERFLOW_POLICY overflowPolicy = EOP_BLOCK;
+			//! longest time a line waits in the queue
+			std::chrono::milliseconds flushInterval = std::chrono::milliseconds(20);
+			//! lines of these levels are written out before `log` returns
+			core::bitflag<E_LOG_LEVEL> flushLevelMask = ELL_ERROR;
+		};
+		struct SStatistics
+		{
+			uint64_t lines = 0u;
+			uint64_t dropped = 0u;
+			//! times logging had to wait for space in the queue
+			uint64_t stalls = 0u;
+			uint64_t batches = 0u;
+			uint64_t bytes = 0u;
+		};
+
+		//! Waits until every line logged (by any thread) before the call is written, returns right away when called from `writeBatch`
+		inline void flush()
+		{
+			if (cantWaitForFlusher())
+				return;
+			const uint64_t ticket = m_queue.getPushedCount();
+			std::unique_lock lk(m_mutex);
+			while (m_flusherRunning && m_queue.getConsumedCount()<ticket)
+			{
+				m_flushRequested = true;
+				m_wakeup.notify_one();
+				// a flusher round may stop early at a line another thread is still copying in, then ask again
+				m_drained.wait(lk, [this]() -> bool {return !m_flushRequested;});
+			}
+		}
+
+		inline SStatistics getStatistics() const
+		{
+			SStatistics retval;
+			retval.lines = m_lines.load(std::memory_order_relaxed);
+			retval.dropped = m_droppedTotal.load(std::memory_order_relaxed);
+			retval.stalls = m_stalls.load(std::memory_order_relaxed);
+			retval.batches = m_batches.load(std::memory_order_relaxed);
+			retval.bytes = m_bytes.load(std::memory_order_relaxed);
+			return retval;
+		}
+
+		inline const SCreationParams& getCreationParameters() const { return m_params; }
+
+	protected:
+		IAsyncLogger(const core::bitflag<E_LOG_LEVEL> logLevelMask, const SCreationParams& params)
+			: ILogger(logLevelMask), m_params(params), m_queue(params.queueCapacity) {}
+		~IAsyncLogger()
+		{
+			assert(!m_flusher.joinable()); // derived class forgot `stopFlusher`
+		}
+
+		inline void startFlusher()
+		{
+			std::unique_lock lk(m_mutex);
+			m_flusherRunning = true;
+			m_flusher = std::thread(&IAsyncLogger::flusherMain, this);
+		}
+		//! Writes out everything logged so far and joins the flusher, nothing may log afterwards
+		inline void stopFlusher()
+		{
+			if (!m_flusher.joinable())
+				return;
+			{
+				std::unique_lock lk(m_mutex);
+				m_quit = true;
+				m_flusherRunning = false;
+				m_wakeup.notify_one();
+				// loggers stalled on the queue won't get another round
+				m_drained.notify_all();
+			}
+			m_flusher.join();
+			m_flusherID.store(std::thread::id(), std::memory_order_relaxed);
+		}
+
+		//! `batch` is one or more complete lines, called by the flusher thread or by a thread writing its line right away, never by two at once
+		//! A log from within it which has to be written right away calls it recursively on the flusher thread
+		virtual void writeBatch(const std::string_view& batch) = 0;
+
+	private:
+		void log_impl(const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list args) override final
+		{
+			// swapped with an empty string of the queue, which keeps the capacity of a line consumed earlier
+			thread_local std::string line;
+			line.clear();
+			constructLogString(line, fmtString, logLevel, args);
+
+			const bool urgent = m_params.flushLevelMask.value&logLevel;
+			auto fill = [](std::string& slot) -> void {slot.swap(line);};
+			// nothing is going to drain the queue
+			if (!m_flusherRunning.load(std::memory_order_acquire))
+			{
+				writeInline(line);
+				return;
+			}
+			if (!m_queue.tryPush(fill))
+			{
+				if (m_params.overflowPolicy==EOP_DROP && !urgent)
+				{
+					m_dropped.fetch_add(1u, std::memory_order_relaxed);
+					m_droppedTotal.fetch_add(1u, std::memory_order_relaxed);
+					return;
+				}
+				m_stalls.fetch_add(1u, std::memory_order_relaxed);
+				// waiting for the flusher from within `writeBatch` would never end
+				bool writeNow = cantWaitForFlusher();
+				while (!writeNow && !m_queue.tryPush(fill))
+				{
+					std::unique_lock lk(m_mutex);
+					// nobody is going to make space anymore
+					if (!m_flusherRunning)
+					{
+						writeNow = true;
+						break;
+					}
+					m_flushRequested = true;
+					m_wakeup.notify_one();
+					m_drained.wait(lk, [this]() -> bool {return !m_flushRequested||!m_flusherRunning;});
+				}
+				if (writeNow)
+				{
+					writeInline(line);
+					return;
+				}
+			}
+			m_lines.fetch_add(1u, std::memory_order_relaxed);
+
+			// pairs with the fence of the flusher's last round, either it sees the line or we see it stopped
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			if (!m_flusherRunning.load(std::memory_order_relaxed))
+			{
+				std::string batch;
+				drain(batch);
+				return;
+			}
+			if (urgent)
+				flush();
+		}
+
+		inline bool onFlusherThread() const
+		{
+			return std::this_thread::get_id()==m_flusherID.load(std::memory_order_relaxed);
+		}
+		//! on the flusher or within a `writeBatch` of this logger, the flusher would wait for us
+		inline bool cantWaitForFlusher() const
+		{
+			return onFlusherThread() || t_writer==this;
+		}
+		//! writes the calling thread's `line` outside of the flusher's rounds
+		inline void writeInline(std::string& line)
+		{
+			// `writeBatch` may log, which would refill the thread's line while it's being written
+			std::string inlineLine;
+			inlineLine.swap(line);
+			write(inlineLine);
+			m_lines.fetch_add(1u, std::memory_order_relaxed);
+		}
+		//! `writeBatch` behind `m_writeMutex`, unless this thread already holds it further up the stack
+		inline void write(const std::string_view& batch)
+		{
+			if (t_writer==this)
+			{
+				writeBatch(batch);
+				return;
+			}
+			std::unique_lock lk(m_writeMutex);
+			const IAsyncLogger* const outer = t_writer;
+			t_writer = this;
+			writeBatch(batch);
+			t_writer = outer;
+		}
+
+		inline void flusherMain()
+		{
+			m_flusherID.store(std::this_thread::get_id(), std::memory_order_relaxed);
+			std::string batch;
+			std::unique_lock lk(m_mutex);
+			bool quit = false;
+			while (!quit)
+			{
+				m_wakeup.wait_for(lk, m_params.flushInterval, [this]() -> bool {return m_flushRequested||m_quit;});
+				quit = m_quit;
+				lk.unlock();
+				// pairs with the fence after a push, see `log_impl`
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				drain(batch);
+				lk.lock();
+				m_flushRequested = false;
+				m_drained.notify_all();
+			}
+		}
+		//! the flusher's rounds, and threads whose line got queued after the last one
+		inline void drain(std::string& batch)
+		{
+			batch.clear();
+			{
+				// the queue has a single consumer
+				std::unique_lock lk(m_consumeMutex);
+				m_queue.consumeAll([&batch](std::string& line) -> void
+				{
+					batch += line;
+					line.clear();
+				});
+			}
+			if (const uint64_t dropped = m_dropped.exchange(0u, std::memory_order_relaxed))
+				appendNote(batch, "%llu log messages were dropped, the queue was full", static_cast<unsigned long long>(dropped));
+			if (batch.empty())
+				return;
+
+			write(batch);
+			m_batches.fetch_add(1u, std::memory_order_relaxed);
+			m_bytes.fetch_add(batch.size(), std::memory_order_relaxed);
+		}
+		inline void appendNote(std::string& batch, const char* fmt, ...)
+		{
+			va_list args;
+			va_start(args, fmt);
+			constructLogString(batch, fmt, ELL_WARNING, args);
+			va_end(args);
+		}
+
+		const SCreationParams m_params;
+		core::CMPSCRingBuffer<std::string> m_queue;
+
+		std::mutex m_mutex;
+		//! flusher waits on it
+		std::condition_variable m_wakeup;
+		//! `flush` and stalled loggers wait on it
+		std::condition_variable m_drained;
+		bool m_flushRequested = false;
+		bool m_quit = false;
+		//! between `startFlusher` and `stopFlusher`, only changes under `m_mutex`
+		std::atomic_bool m_flusherRunning = false;
+		//! only contended by lines written inline
+		std::mutex m_writeMutex;
+		//! only contended once the flusher stopped
+		std::mutex m_consumeMutex;
+		//! the logger whose `writeBatch` the thread is in
+		static inline thread_local const IAsyncLogger* t_writer = nullptr;
+		std::atomic<std::thread::id> m_flusherID;
+
+		//! since the last batch
+		std::atomic_uint64_t m_dropped = 0u;
+		std::atomic_uint64_t m_droppedTotal = 0u;
+		std::atomic_uint64_t m_lines = 0u;
+		std::atomic_uint64_t m_stalls = 0u;
+		std::atomic_uint64_t m_batches = 0u;
+		std::atomic_uint64_t m_bytes = 0u;
+
+		// last, so everything above exists by the time the thread starts
+		std::thread m_flusher;
+};
+
+}
+
+#endif
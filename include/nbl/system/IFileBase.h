@@ -20,6 +20,7 @@ class IFileBase : public core::IReferenceCounted
 			ECF_READ = 0b0001,
 			ECF_WRITE = 0b0010,
 			ECF_READ_WRITE = 0b0011,
+			//! A mapping of a file opened without ECF_WRITE is copy-on-write, writes through it never reach the file
 			ECF_MAPPABLE = 0b0100,
 			//! Implies ECF_MAPPABLE
 			ECF_COHERENT = 0b1100
@@ -13,6 +13,9 @@
 #include <iomanip>
 #include <regex>
 #include <cstdarg>
+#include <cstdio>
+#include <ctime>
+#include <algorithm>
 
 
 namespace nbl::system
@@ -53,57 +56,82 @@ class ILogger : public core::IReferenceCounted
 		ILogger(core::bitflag<E_LOG_LEVEL> logLevelMask) : m_logLevelMask(logLevelMask) {}
 
 		virtual void log_impl(const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list args) = 0;
-		virtual std::string constructLogString(const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list l)
+		//! Appends the formatted line to `out`, override to change the format of the lines
+		/** Loggers reuse `out` between lines, so the default doesn't allocate once `out` has the capacity. */
+		virtual void constructLogString(std::string& out, const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list l)
 		{
-			using namespace std::literals;
+			appendLogString(out, fmtString, logLevel, l);
+		}
+
+		//! Timestamp, level and message of a line followed by a newline
+		static void appendLogString(std::string& out, const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list l)
+		{
+			const std::string_view messageTypeStr = getLogLevelString(logLevel);
+			if (messageTypeStr.empty())
+				return;
+
 			using namespace std::chrono;
-			auto currentTime = std::chrono::system_clock::now();
-			const std::time_t t = std::chrono::system_clock::to_time_t(currentTime);
-			
-			// Since there is no real way in c++ to get current time with microseconds, this is my weird approach
-			auto time_since_epoch = duration_cast<microseconds>(system_clock::now().time_since_epoch());
-			auto time_since_epoch_s = duration_cast<seconds>(system_clock::now().time_since_epoch());
-			time_since_epoch -= duration_cast<microseconds>(time_since_epoch_s);
-
-			// This while is for the microseconds which are less that 6 digits long to be aligned with the others
-			while (time_since_epoch.count() / 100000 == 0) time_since_epoch *= 10;
-
-			auto time = std::localtime(&t);
-
-			constexpr size_t DATE_STR_LENGTH = 28;
-			std::string timeStr(DATE_STR_LENGTH, '\0');
-			sprintf(timeStr.data(), "[%02d.%02d.%d %02d:%02d:%02d:%d]", time->tm_mday, time->tm_mon + 1, 1900 + time->tm_year, time->tm_hour, time->tm_min, time->tm_sec, (int)time_since_epoch.count());
-			
-			std::string messageTypeStr;
+			const auto currentTime = system_clock::now();
+			const std::time_t t = system_clock::to_time_t(currentTime);
+			const auto microsecondsPart = duration_cast<microseconds>(currentTime.time_since_epoch()).count()%1000000ll;
+
+			// the date only changes once a second, so every thread formats it once a second
+			struct STimePrefix
+			{
+				std::time_t second = -1;
+				char str[32];
+				int length = 0;
+			};
+			thread_local STimePrefix prefix;
+			if (t != prefix.second)
+			{
+				std::tm time;
+#ifdef _NBL_PLATFORM_WINDOWS_
+				localtime_s(&time, &t);
+#else
+				localtime_r(&t, &time);
+#endif
+				prefix.length = snprintf(prefix.str, sizeof(prefix.str), "[%02d.%02d.%d %02d:%02d:%02d:", time.tm_mday, time.tm_mon + 1, 1900 + time.tm_year, time.tm_hour, time.tm_min, time.tm_sec);
+				prefix.second = t;
+			}
+			char microsecondsStr[16];
+			const int microsecondsLength = snprintf(microsecondsStr, sizeof(microsecondsStr), "%06d]", static_cast<int>(microsecondsPart));
+			out.append(prefix.str, prefix.length).append(microsecondsStr, microsecondsLength).append(messageTypeStr).append(": ");
+
+			// most messages fit in a guess, so usually there's a single formatting pass
+			constexpr size_t GuessedMessageLength = 256ull;
+			const size_t begin = out.size();
+			out.resize(begin + GuessedMessageLength);
+			va_list retry;
+			va_copy(retry, l);
+			const int length = vsnprintf(out.data() + begin, GuessedMessageLength, fmtString.data(), l);
+			if (length >= static_cast<int>(GuessedMessageLength))
+			{
+				out.resize(begin + length + 1);
+				vsnprintf(out.data() + begin, length + 1, fmtString.data(), retry);
+			}
+			va_end(retry);
+			out.resize(begin + std::max(length, 0));
+			out += '\n';
+		}
+
+		static inline std::string_view getLogLevelString(E_LOG_LEVEL logLevel)
+		{
 			switch (logLevel)
 			{
 			case ELL_DEBUG:
-				messageTypeStr = "[DEBUG]";
-				break;
+				return "[DEBUG]";
 			case ELL_INFO:
-				messageTypeStr = "[INFO]";
-				break;
+				return "[INFO]";
 			case ELL_WARNING:
-				messageTypeStr = "[WARNING]";
-				break;
+				return "[WARNING]";
 			case ELL_PERFORMANCE:
-				messageTypeStr = "[PERFORMANCE]";
-				break;
+				return "[PERFORMANCE]";
 			case ELL_ERROR:
-				messageTypeStr = "[ERROR]";
-				break;
-			case ELL_NONE:
+				return "[ERROR]";
+			default:
 				return "";
 			}
-
-			size_t newSize = vsnprintf(nullptr, 0, fmtString.data(), l) + 1;
-			std::string message(newSize, '\0'); 
-			vsnprintf(message.data(), newSize, fmtString.data(), l);
-			
-			std::string out_str(timeStr.length() + messageTypeStr.length() + message.length() + 3, '\0');
-			sprintf(out_str.data(), "%s%s: %s\n", timeStr.data(), messageTypeStr.data(), message.data());
- 			return out_str;
-			return "";
 		}
 
 	private:
@@ -15,11 +15,16 @@ public:
 	// Inherited via ILogger
 	void log_impl(const std::string_view& fmtString, E_LOG_LEVEL logLevel, va_list args) override final
 	{
+		// formatting doesn't need the lock, only the output does
+		thread_local std::string line;
+		line.clear();
+		constructLogString(line, fmtString, logLevel, args);
 		auto l = lock();
-		threadsafeLog_impl(fmtString, logLevel, args);
+		threadsafeLog_impl(line, logLevel);
 	}
 private:
-	virtual void threadsafeLog_impl(const std::string_view&, E_LOG_LEVEL logLevel, va_list args) = 0;
+	//! `line` is fully formatted, newline included
+	virtual void threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel) = 0;
 	
 	std::unique_lock<std::mutex> lock() const
 	{
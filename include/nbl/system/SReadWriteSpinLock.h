@@ -4,6 +4,7 @@
 #include <atomic>
 #include <thread>
 #include <mutex> // for std::adopt_lock_t
+#include <cstdint>
 
 namespace nbl::system
 {
@@ -15,9 +16,16 @@ namespace impl
     {
     public:
         static inline constexpr uint32_t LockWriteVal = (1u << 31);
+        // bits [ReaderBits,31) count the writers waiting to get preferred over new readers
+        static inline constexpr uint32_t ReaderBits = 20u;
+        static inline constexpr uint32_t ReaderMask = (1u << ReaderBits) - 1u;
+        static inline constexpr uint32_t WaitingWriterVal = (1u << ReaderBits);
+        static inline constexpr uint32_t WaitingWriterMask = LockWriteVal - WaitingWriterVal;
 
         // TODO atomic_unsigned_lock_free? since C++20
         std::atomic_uint32_t m_lock = 0u;
+        // threads sleeping in `m_lock.wait`, lets unlocking skip the notify when nobody sleeps
+        std::atomic_uint32_t m_sleepers = 0u;
     };
 
 }
@@ -27,21 +35,17 @@ class read_lock_guard;
 template <std::memory_order, std::memory_order>
 class write_lock_guard;
 
+//! Reader-writer lock which spins for a short while and then sleeps on the lock word with `std::atomic::wait` (a futex on Linux)
+/**
+    With `EP_WRITERS` preference a writer which has to wait stops any new readers from getting the lock,
+    so writers can't starve under a constant stream of readers. The price is that a thread already holding
+    a read lock must not take another one, because a writer waiting in between would deadlock it.
+
+    Contention statistics are only updated when a lock can't be taken straight away, so they cost nothing when uncontended.
+*/
 class SReadWriteSpinLock : protected impl::SReadWriteSpinLockBase
 {
-    static inline constexpr uint32_t SpinsBeforeYield = 5000u;
-
-    void lock_write_impl(const uint32_t _expected, std::memory_order rmw_order)
-    {
-        uint32_t expected = _expected;
-        uint32_t i = 0u;
-        while (!m_lock.compare_exchange_strong(expected, impl::SReadWriteSpinLockBase::LockWriteVal, rmw_order))
-        {
-            expected = _expected;
-            if (i++ >= SpinsBeforeYield)
-                std::this_thread::yield();
-        }
-    }
+    static inline constexpr uint32_t SpinsBeforeSleep = 128u;
 
 public:
     template <std::memory_order, std::memory_order>
@@ -49,31 +53,142 @@ public:
     template <std::memory_order, std::memory_order>
     friend class write_lock_guard;
 
+    enum E_PREFERENCE : uint8_t
+    {
+        EP_READERS,
+        EP_WRITERS
+    };
+
+    struct SStatistics
+    {
+        //! acquisitions which could not be done right away
+        uint64_t contendedReads = 0u;
+        uint64_t contendedWrites = 0u;
+        //! times a thread went to sleep waiting for the lock
+        uint64_t sleeps = 0u;
+    };
+
+    explicit SReadWriteSpinLock(const E_PREFERENCE _preference = EP_READERS) : m_preference(_preference) {}
+
     void lock_read(std::memory_order rmw_order = std::memory_order_seq_cst, std::memory_order ld_order = std::memory_order_seq_cst)
     {
-        if (m_lock.fetch_add(1u, rmw_order) > (LockWriteVal-1u))
-        {
-            uint32_t i = 0u;
-            while (m_lock.load(ld_order) >= LockWriteVal)
-                if (i++ >= SpinsBeforeYield)
-                    std::this_thread::yield();
-        }
+        const uint32_t blockingMask = m_preference==EP_WRITERS ? (LockWriteVal|WaitingWriterMask):LockWriteVal;
+        auto isFree = [blockingMask](const uint32_t state) -> bool {return (state&blockingMask)==0u;};
+        auto locked = [](const uint32_t state) -> uint32_t {return state+1u;};
+
+        uint32_t state = m_lock.load(ld_order);
+        if (isFree(state) && m_lock.compare_exchange_strong(state, locked(state), rmw_order, ld_order))
+            return;
+        m_contendedReads.fetch_add(1u, std::memory_order_relaxed);
+        lock_contended(isFree, locked, rmw_order, ld_order);
     }
 
     void unlock_read(std::memory_order rmw_order = std::memory_order_seq_cst)
     {
-        m_lock.fetch_sub(1u, rmw_order);
+        // only writers and read-to-write upgrades ever wait for readers, they can proceed once at most one reader is left
+        if ((m_lock.fetch_sub(1u, rmw_order)&ReaderMask) <= 2u)
+            wake();
     }
 
     void lock_write(std::memory_order rmw_order = std::memory_order_seq_cst)
     {
-        lock_write_impl(0u, rmw_order);
+        uint32_t expected = 0u;
+        if (m_lock.compare_exchange_strong(expected, LockWriteVal, rmw_order, std::memory_order_relaxed))
+            return;
+        m_contendedWrites.fetch_add(1u, std::memory_order_relaxed);
+
+        const uint32_t waitingVal = m_preference==EP_WRITERS ? WaitingWriterVal:0u;
+        if (waitingVal)
+            m_lock.fetch_add(waitingVal, std::memory_order_relaxed);
+        lock_contended(
+            [](const uint32_t state) -> bool {return (state&(LockWriteVal|ReaderMask))==0u;},
+            [waitingVal](const uint32_t state) -> uint32_t {return (state-waitingVal)|LockWriteVal;},
+            rmw_order, std::memory_order_relaxed
+        );
     }
 
     void unlock_write(std::memory_order rmw_order = std::memory_order_seq_cst)
     {
         m_lock.fetch_sub(LockWriteVal, rmw_order);
+        wake();
+    }
+
+    inline SStatistics getStatistics() const
+    {
+        SStatistics retval;
+        retval.contendedReads = m_contendedReads.load(std::memory_order_relaxed);
+        retval.contendedWrites = m_contendedWrites.load(std::memory_order_relaxed);
+        retval.sleeps = m_sleeps.load(std::memory_order_relaxed);
+        return retval;
+    }
+    inline void resetStatistics()
+    {
+        m_contendedReads.store(0u, std::memory_order_relaxed);
+        m_contendedWrites.store(0u, std::memory_order_relaxed);
+        m_sleeps.store(0u, std::memory_order_relaxed);
+    }
+
+private:
+    // `isFree` tells whether the lock can be taken given its state, `locked` gives the state after taking it
+    template <typename IsFree, typename Locked>
+    void lock_contended(IsFree&& isFree, Locked&& locked, const std::memory_order rmw_order, const std::memory_order ld_order)
+    {
+        uint32_t state = m_lock.load(ld_order);
+        for (uint32_t i = 0u; ; i++)
+        {
+            if (isFree(state))
+            {
+                if (m_lock.compare_exchange_weak(state, locked(state), rmw_order, ld_order))
+                    return;
+                continue;
+            }
+            if (i < SpinsBeforeSleep)
+            {
+                state = m_lock.load(ld_order);
+                continue;
+            }
+            // only ever sleep on a state which blocks us, otherwise nobody might come to wake us up
+            // pairs with the fence in `wake`, either the unlocking thread sees us sleeping or we see the new state and don't sleep
+            m_sleepers.fetch_add(1u, std::memory_order_seq_cst);
+            m_lock.wait(state, std::memory_order_seq_cst);
+            m_sleepers.fetch_sub(1u, std::memory_order_relaxed);
+            m_sleeps.fetch_add(1u, std::memory_order_relaxed);
+            state = m_lock.load(ld_order);
+            i = 0u;
+        }
     }
+
+    void wake()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_sleepers.load(std::memory_order_relaxed))
+            m_lock.notify_all();
+    }
+
+    // the calling thread must hold a read lock
+    void upgrade_read_to_write(std::memory_order rmw_order)
+    {
+        auto isFree = [](const uint32_t state) -> bool {return (state&ReaderMask)==1u;};
+        auto locked = [](const uint32_t state) -> uint32_t {return (state-1u)|LockWriteVal;};
+
+        uint32_t state = m_lock.load(std::memory_order_relaxed);
+        if (isFree(state) && m_lock.compare_exchange_strong(state, locked(state), rmw_order, std::memory_order_relaxed))
+            return;
+        m_contendedWrites.fetch_add(1u, std::memory_order_relaxed);
+        lock_contended(isFree, locked, rmw_order, std::memory_order_relaxed);
+    }
+
+    // the calling thread must hold the write lock
+    void downgrade_write_to_read(std::memory_order rmw_order)
+    {
+        m_lock.fetch_sub(LockWriteVal - 1u, rmw_order);
+        wake();
+    }
+
+    const E_PREFERENCE m_preference;
+    std::atomic_uint64_t m_contendedReads = 0u;
+    std::atomic_uint64_t m_contendedWrites = 0u;
+    std::atomic_uint64_t m_sleeps = 0u;
 };
 
 namespace impl
@@ -142,13 +257,13 @@ public:
 template <std::memory_order LoadOrder, std::memory_order ReadModWriteOrder>
 inline read_lock_guard<LoadOrder, ReadModWriteOrder>::read_lock_guard(write_lock_guard<LoadOrder, ReadModWriteOrder>&& wl) : impl::rw_lock_guard_base(std::move(wl))
 {
-    m_lock->m_lock.fetch_sub(impl::SReadWriteSpinLockBase::LockWriteVal - 1u, ReadModWriteOrder);
+    m_lock->downgrade_write_to_read(ReadModWriteOrder);
 }
 
 template <std::memory_order LoadOrder, std::memory_order ReadModWriteOrder>
 inline write_lock_guard<LoadOrder, ReadModWriteOrder>::write_lock_guard(read_lock_guard<LoadOrder, ReadModWriteOrder>&& rl) : impl::rw_lock_guard_base(std::move(rl))
 {
-    m_lock->lock_write_impl(1u, ReadModWriteOrder);
+    m_lock->upgrade_read_to_write(ReadModWriteOrder);
 }
 
 }
@@ -1,10 +1,14 @@
 #ifndef __NBL_I_INPUT_EVENT_CHANNEL_H_INCLUDED__
 #define __NBL_I_INPUT_EVENT_CHANNEL_H_INCLUDED__
 
-#include <mutex>
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <mutex>
+#include "nbl/core/decl/Types.h"
 #include "nbl/core/IReferenceCounted.h"
 #include "nbl/core/containers/CCircularBuffer.h"
+#include "nbl/core/containers/CSPSCRingBuffer.h"
 #include "nbl/core/SRange.h"
 #include "nbl/ui/KeyCodes.h"
 #include "nbl/ui/SInputEvent.h"
@@ -39,28 +43,81 @@ namespace impl
     template <typename EventType>
     class IEventChannelBase : public IInputEventChannel
     {
+    public:
+        enum E_OVERFLOW_POLICY : uint8_t
+        {
+            //! events which don't fit into the background buffer are held back until the next getEvents, past another buffer's worth
+            //! the oldest held back ones get overwritten, so like with the circular buffer this used to be only older events get lost
+            //! and the latest ones (such as a key or button release) always arrive
+            EOP_OVERWRITE_OLDEST,
+            //! events which don't fit into the background buffer get dropped, the newest are the ones lost
+            EOP_DROP,
+            //! the first event which doesn't fit is held back and the following ones get merged into it where the channel knows how
+            //! (relative mouse movement, scrolling), the rest get dropped, the held back event comes out of the next getEvents at the latest
+            EOP_COALESCE
+        };
+
+        struct SStatistics
+        {
+            uint64_t pushed = 0ull;
+            uint64_t dropped = 0ull;
+            uint64_t coalesced = 0ull;
+        };
+
     protected:
+        // one OS event thread produces and one consumer drains, no locking needed
+        using bg_t = core::CSPSCRingBuffer<EventType>;
         using cb_t = core::CConstantRuntimeSizedCircularBuffer<EventType>;
         using iterator_t = typename cb_t::iterator;
 
-        std::mutex m_bgEventBufMtx;
-        cb_t m_bgEventBuf;
+        bg_t m_bgEventBuf;
         cb_t m_frontEventBuf;
+
+        //! Merge `_ev` into the last held back `_pending` event if they're the same kind, only used with `EOP_COALESCE`
+        virtual bool coalesce(EventType& _pending, const EventType& _ev) const { return false; }
+
     public:
         //
-        inline size_t getBackgroundBufferCapacity() const {return m_frontEventBuf.capacity();}
+        inline size_t getBackgroundBufferCapacity() const {return m_bgEventBuf.capacity();}
         inline size_t getFrontBufferCapacity() const {return m_frontEventBuf.capacity();}
 
-        // Lock while working with background event buffer
-        std::unique_lock<std::mutex> lockBackgroundBuffer()
+        //! Should be set before events start flowing
+        inline void setOverflowPolicy(const E_OVERFLOW_POLICY _policy) {m_overflowPolicy = _policy;}
+        inline E_OVERFLOW_POLICY getOverflowPolicy() const {return m_overflowPolicy;}
+
+        inline SStatistics getStatistics() const
         {
-            return std::unique_lock<std::mutex>(m_bgEventBufMtx);
+            SStatistics retval;
+            retval.pushed = m_pushed.load(std::memory_order_relaxed);
+            retval.dropped = m_dropped.load(std::memory_order_relaxed);
+            retval.coalesced = m_coalesced.load(std::memory_order_relaxed);
+            return retval;
         }
 
         // Use this within OS-specific impl (Windows callback/XNextEvent loop thread/etc...)
+        // Must always be called from the same thread, events held back on overflow get published with the next push or getEvents.
         void pushIntoBackground(EventType&& ev)
         {
-            m_bgEventBuf.push_back(std::move(ev));
+            // lock free unless something is held back
+            if (!m_hasPending.load(std::memory_order_acquire) && m_bgEventBuf.tryPush(ev))
+            {
+                m_pushed.fetch_add(1ull,std::memory_order_relaxed);
+                return;
+            }
+
+            std::unique_lock lock(m_pendingMutex);
+            // whatever overflowed before goes first, to keep the order
+            while (!m_pending.empty() && m_bgEventBuf.tryPush(m_pending.front()))
+            {
+                m_pending.pop_front();
+                m_pushed.fetch_add(1ull,std::memory_order_relaxed);
+            }
+            if (m_pending.empty())
+                m_hasPending.store(false,std::memory_order_release);
+            if (m_pending.empty() && m_bgEventBuf.tryPush(ev))
+                m_pushed.fetch_add(1ull,std::memory_order_relaxed);
+            else
+                overflow(ev);
         }
 
         // WARNING: Access to getEvents() must be externally synchronized to be safe!
@@ -83,19 +140,66 @@ namespace impl
     private:
         void downloadFromBackgroundIntoFront()
         {
-            auto lk = lockBackgroundBuffer();
+            // drains everything the producer managed to push in one go
+            m_bgEventBuf.consumeAll([this](const EventType& ev) -> void {m_frontEventBuf.push_back(ev);});
+            if (!m_hasPending.load(std::memory_order_acquire))
+                return;
+            // the held back events are younger than anything in the background buffer, which has to be drained again while the producer can't push
+            std::unique_lock lock(m_pendingMutex);
+            m_bgEventBuf.consumeAll([this](const EventType& ev) -> void {m_frontEventBuf.push_back(ev);});
+            for (const auto& ev : m_pending)
+                m_frontEventBuf.push_back(ev);
+            m_pushed.fetch_add(m_pending.size(),std::memory_order_relaxed);
+            m_pending.clear();
+            m_hasPending.store(false,std::memory_order_release);
+        }
 
-            while (m_bgEventBuf.size() > 0ull)
+        void overflow(const EventType& ev)
+        {
+            switch (m_overflowPolicy)
             {
-                auto ev = m_bgEventBuf.pop_front();
-                m_frontEventBuf.push_back(std::move(ev));
+                case EOP_OVERWRITE_OLDEST:
+                    if (m_pending.size()>=m_bgEventBuf.capacity())
+                    {
+                        m_pending.pop_front();
+                        m_dropped.fetch_add(1ull,std::memory_order_relaxed);
+                    }
+                    m_pending.push_back(ev);
+                    m_hasPending.store(true,std::memory_order_release);
+                    return;
+                case EOP_COALESCE:
+                    if (m_pending.empty())
+                    {
+                        m_pending.push_back(ev);
+                        m_hasPending.store(true,std::memory_order_release);
+                        return;
+                    }
+                    if (coalesce(m_pending.back(),ev))
+                    {
+                        m_coalesced.fetch_add(1ull,std::memory_order_relaxed);
+                        return;
+                    }
+                    break;
+                default:
+                    break;
             }
+            m_dropped.fetch_add(1ull,std::memory_order_relaxed);
         }
 
+        E_OVERFLOW_POLICY m_overflowPolicy = EOP_OVERWRITE_OLDEST;
+        // the producer only takes the mutex on overflow, the consumer only while something is held back
+        std::mutex m_pendingMutex;
+        //! a single event with `EOP_COALESCE`, at most the background buffer's capacity with `EOP_OVERWRITE_OLDEST`
+        core::deque<EventType> m_pending;
+        std::atomic_bool m_hasPending = false;
+        std::atomic_uint64_t m_pushed = 0ull;
+        std::atomic_uint64_t m_dropped = 0ull;
+        std::atomic_uint64_t m_coalesced = 0ull;
+
     public:
         bool empty() const override final
         {
-            return m_bgEventBuf.size() == 0ull;
+            return m_bgEventBuf.empty() && !m_hasPending.load(std::memory_order_acquire);
         }
     };
 }
@@ -118,6 +222,32 @@ public:
     { 
         return ET_MOUSE;
     }
+
+protected:
+    bool coalesce(SMouseEvent& _pending, const SMouseEvent& _ev) const override
+    {
+        if (_pending.type!=_ev.type || _pending.window!=_ev.window)
+            return false;
+        auto accumulate = [](int16_t& _dst, const int16_t _delta) -> void
+        {
+            _dst = static_cast<int16_t>(std::clamp<int32_t>(int32_t(_dst)+_delta,INT16_MIN,INT16_MAX));
+        };
+        switch (_ev.type)
+        {
+            case SMouseEvent::EET_MOVEMENT:
+                accumulate(_pending.movementEvent.relativeMovementX,_ev.movementEvent.relativeMovementX);
+                accumulate(_pending.movementEvent.relativeMovementY,_ev.movementEvent.relativeMovementY);
+                break;
+            case SMouseEvent::EET_SCROLL:
+                accumulate(_pending.scrollEvent.verticalScroll,_ev.scrollEvent.verticalScroll);
+                accumulate(_pending.scrollEvent.horizontalScroll,_ev.scrollEvent.horizontalScroll);
+                break;
+            default:
+                return false;
+        }
+        _pending.timeStamp = _ev.timeStamp;
+        return true;
+    }
 };
 
 // TODO left/right shift/ctrl/alt kb flags
@@ -0,0 +1,40 @@
+#ifndef __NBL_C_NULL_CONNECTION_H_INCLUDED__
+#define __NBL_C_NULL_CONNECTION_H_INCLUDED__
+
+#include "nbl/video/IAPIConnection.h"
+
+namespace nbl::video
+{
+
+//! Headless connection which needs no GPU, driver or window system
+/**
+    Exposes a single physical device whose logical devices create ordinary engine objects backed by host memory and execute nothing.
+    Use it to test and benchmark the CPU side of the engine, i.e. the asset to GPU object converter, staging through `IUtilities`,
+    descriptor updates and command recording, on machines without a GPU.
+*/
+class CNullConnection final : public IAPIConnection
+{
+    public:
+        static core::smart_refctd_ptr<CNullConnection> create(core::smart_refctd_ptr<system::ISystem>&& sys, uint32_t appVer, const char* appName, core::smart_refctd_ptr<system::ILogger>&& logger);
+
+        E_API_TYPE getAPIType() const override { return EAT_NULL; }
+
+        IDebugCallback* getDebugCallback() const override;
+
+    protected:
+        explicit CNullConnection(core::smart_refctd_ptr<system::ILogger>&& logger);
+        virtual ~CNullConnection();
+
+    private:
+        // nothing ever reports anything, its only there so the logger can be retrieved the same way as on the other backends
+        class CDebugCallback final : public IDebugCallback
+        {
+            public:
+                explicit CDebugCallback(core::smart_refctd_ptr<system::ILogger>&& _logger) : IDebugCallback(std::move(_logger)) {}
+        };
+        std::unique_ptr<CDebugCallback> m_debugCallback;
+};
+
+}
+
+#endif
@@ -11,7 +11,8 @@ enum E_API_TYPE : uint32_t
 {
     EAT_OPENGL,
     EAT_OPENGL_ES,
-    EAT_VULKAN
+    EAT_VULKAN,
+    EAT_NULL //!< host-only backend which executes nothing, for testing and benchmarking the CPU side of the engine
 };
 
 }
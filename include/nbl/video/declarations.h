@@ -23,6 +23,7 @@
 // platform and API specific stuff
 #include "nbl/video/COpenGL_Connection.h"
 #include "nbl/video/CVulkanConnection.h"
+#include "nbl/video/CNullConnection.h"
 #include "nbl/video/surface/CSurfaceGL.h"
 #include "nbl/video/surface/CSurfaceVulkan.h"
 
@@ -6,18 +6,36 @@
 #define _NBL_VIDEO_C_SUBPASS_KILN_H_INCLUDED_
 
 
+#include "nbl/core/algorithm/radix_sort.h"
+
+#include "nbl/system/ILogger.h"
+
 #include "nbl/video/IGPUMeshBuffer.h"
+#include "nbl/video/IGPUCommandBuffer.h"
 #include "nbl/video/utilities/IDrawIndirectAllocator.h"
 
+#include <array>
 #include <functional>
+#include <string_view>
 
 
 namespace nbl::video
 {
     
+//! Sorts drawcalls to minimize state changes and records them into commandbuffers
+/**
+    With the default order every drawcall is reduced to a 128 bit `SortKey` made of small interned IDs of its state, and those
+    keys get radix sorted together with the drawcall indices, the drawcalls themselves never move.
+    `modifyDrawcalls` lets you change some drawcalls in place, then only those get their keys recomputed and the order only
+    gets re-sorted if a key actually changed. `bakeSecondaries` goes a step further and keeps a secondary commandbuffer per chunk
+    of each subpass' drawcalls, only the chunks whose drawcalls changed get re-recorded, optionally in parallel.
+*/
 class CSubpassKiln
 {
     public:
+        //! the logger gets told about drawcalls which can't be baked
+        CSubpassKiln(system::logger_opt_smart_ptr&& logger=nullptr) : m_logger(std::move(logger)) {}
+
         // for finding upper and lower bounds of subpass drawcalls
         struct SearchObject
         {
@@ -38,7 +56,58 @@ class CSubpassKiln
             uint32_t drawCallOffset;
             uint32_t drawMaxCount = 0u;
         };
-        // 
+        //! IDs of the state of a drawcall, packed so that the state which is the most expensive to change is in the most significant bits
+        /**
+            IDs are handed out in first-seen order, when there are more distinct states than an ID has bits the last ID gets shared,
+            which only costs some redundant state changes because the recording compares the actual state anyway.
+            The renderpass and subpass ID is the one exception, it has to be exact as it's used to find a subpass' drawcalls.
+        */
+        struct SortKey
+        {
+            // `hi`
+            static inline constexpr uint32_t PassIDBits = 16u;
+            static inline constexpr uint32_t PassIDShift = 48u;
+            //! compatible pipeline layouts share an ID, so the push constants and descriptor sets don't need rebinding between them
+            static inline constexpr uint32_t LayoutIDBits = 12u;
+            static inline constexpr uint32_t LayoutIDShift = 36u;
+            static inline constexpr uint32_t PipelineIDBits = 16u;
+            static inline constexpr uint32_t PipelineIDShift = 20u;
+            static inline constexpr uint32_t DescriptorSetsIDBits = 20u;
+            static inline constexpr uint32_t DescriptorSetsIDShift = 0u;
+            // `lo`
+            static inline constexpr uint32_t VertexBindingsIDBits = 24u;
+            static inline constexpr uint32_t VertexBindingsIDShift = 40u;
+            static inline constexpr uint32_t IndexBindingIDBits = 20u;
+            static inline constexpr uint32_t IndexBindingIDShift = 20u;
+
+            inline bool operator==(const SortKey& other) const {return hi==other.hi && lo==other.lo;}
+            inline bool operator!=(const SortKey& other) const {return !operator==(other);}
+
+            inline uint32_t getPassID() const {return static_cast<uint32_t>(hi>>PassIDShift);}
+
+            //! for `core::radix_sort`
+            struct Accessor
+            {
+                static inline constexpr size_t key_bit_count = 128ull;
+
+                template<auto bit_offset, auto radix_mask>
+                inline decltype(radix_mask) operator()(const SortKey& key) const
+                {
+                    using digit_t = decltype(radix_mask);
+                    constexpr uint32_t shift = static_cast<uint32_t>(bit_offset);
+                    if constexpr (shift>=64u)
+                        return static_cast<digit_t>(key.hi>>(shift-64u))&radix_mask;
+                    else if constexpr (shift==0u)
+                        return static_cast<digit_t>(key.lo)&radix_mask;
+                    else // digit straddles the two halves
+                        return static_cast<digit_t>((key.lo>>shift)|(key.hi<<(64u-shift)))&radix_mask;
+                }
+            };
+
+            uint64_t hi = 0ull;
+            uint64_t lo = 0ull;
+        };
+        //! `bake` sorts by `SortKey` for this order, which groups state in the same priority as `less`, the comparators are for your own use
         struct DefaultOrder
         {
             public:
@@ -124,7 +193,7 @@ class CSubpassKiln
                                     {
                                         if (lhs.vertexBufferBindings[i].buffer==rhs.vertexBufferBindings[i].buffer)
                                         {
-                                            if (lhs.vertexBufferBindings[i].offset,rhs.vertexBufferBindings[i].offset)
+                                            if (lhs.vertexBufferBindings[i].offset==rhs.vertexBufferBindings[i].offset)
                                                 continue;
                                             return Cmp<uint64_t>()(lhs.vertexBufferBindings[i].offset,rhs.vertexBufferBindings[i].offset);
                                         }
@@ -166,7 +235,7 @@ class CSubpassKiln
                 }
         };
 
-        //
+        //! Any change made through the vector makes the next `bake` recompute the keys of all drawcalls and re-record everything
         inline auto& getDrawcallMetadataVector()
         {
             m_needsSorting = DefaultOrder::invalidTypeID;
@@ -174,6 +243,29 @@ class CSubpassKiln
         }
         inline const auto& getDrawcallMetadataVector() const {return m_drawCallMetadataStorage;}
 
+        //! Write access to the drawcalls [begin,end) in place, the next `bake` only recomputes their keys
+        /**
+            Indices are the ones in `getDrawcallMetadataVector()`, they stay valid until you bake with an order other than `DefaultOrder`
+            (which sorts the vector itself). Only the `DefaultOrder` can re-key a few drawcalls, if the last bake used another order
+            any modification makes the next bake sort everything again. To add or remove drawcalls use `getDrawcallMetadataVector()`.
+        */
+        inline core::SRange<DrawcallInfo> modifyDrawcalls(const uint32_t begin, const uint32_t end)
+        {
+            assert(begin<=end && end<=m_drawCallMetadataStorage.size());
+            if (begin!=end)
+            {
+                if (m_needsSorting==DefaultOrder::typeID)
+                    m_dirtyRanges.emplace_back(begin,end);
+                else
+                    m_needsSorting = DefaultOrder::invalidTypeID;
+            }
+            DrawcallInfo* const data = m_drawCallMetadataStorage.data();
+            return {data+begin,data+end};
+        }
+
+        //! The sort keys, in the order of `getDrawcallMetadataVector()`, valid after a `bake` with the `DefaultOrder`
+        inline const auto& getSortKeys() const {return m_sortKeys;}
+
         // commandbuffer must have the subpass already begun
         // by setting `drawCountBuffer=nullptr` you disable the use of count buffers
         // (commands are still sorted as if it was used, if you want to ignore draw counts, set `DrawcallInfo::drawCountOffset` on all elements to invalid)
@@ -181,18 +273,152 @@ class CSubpassKiln
         void bake(IGPUCommandBuffer* cmdbuf, const IGPURenderpass* renderpass, const uint32_t subpassIndex, const IGPUBuffer* drawIndirectBuffer, const IGPUBuffer* drawCountBuffer)
         {
             assert(cmdbuf&&renderpass&&subpassIndex<renderpass->getSubpasses().size()&&drawIndirectBuffer);
-            if (m_needsSorting!=draw_call_order_t::typeID)
+            if constexpr (std::is_same_v<draw_call_order_t,DefaultOrder>)
             {
-                std::sort(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(), typename draw_call_order_t::less());
-                m_needsSorting = draw_call_order_t::typeID;
+                updateSortOrder();
+                const auto range = getSortedRange(renderpass,subpassIndex);
+                if (range.first==range.second)
+                    return;
+
+                const uint32_t* const sortedIndices = m_sortedIndices.data();
+                record(cmdbuf,indexed_iterator{m_drawCallMetadataStorage.data(),sortedIndices+range.first},indexed_iterator{m_drawCallMetadataStorage.data(),sortedIndices+range.second},drawIndirectBuffer,drawCountBuffer);
             }
+            else
+            {
+                if (m_needsSorting!=draw_call_order_t::typeID)
+                {
+                    std::sort(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(), typename draw_call_order_t::less());
+                    m_needsSorting = draw_call_order_t::typeID;
+                    // the indices of modifications made before the sort don't point at the same drawcalls anymore
+                    m_dirtyRanges.clear();
+                }
 
-            const SearchObject searchObj = {renderpass,subpassIndex};
-            const auto begin = std::lower_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
-            const auto end = std::upper_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
-            if (begin==end)
-                return;
+                const SearchObject searchObj = {renderpass,subpassIndex};
+                const auto begin = std::lower_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
+                const auto end = std::upper_bound(m_drawCallMetadataStorage.begin(),m_drawCallMetadataStorage.end(),searchObj, typename draw_call_order_t::renderpass_subpass_comp());
+                if (begin==end)
+                    return;
 
+                record(cmdbuf,call_iterator(begin),call_iterator(end),drawIndirectBuffer,drawCountBuffer);
+            }
+        }
+
+        struct SSecondaryBakeParams
+        {
+            core::smart_refctd_ptr<const IGPURenderpass> renderpass;
+            uint32_t subpassIndex = 0u;
+            //! optional, but lets the driver know the attachments while recording
+            core::smart_refctd_ptr<const IGPUFramebuffer> framebuffer = nullptr;
+            const IGPUBuffer* drawIndirectBuffer = nullptr;
+            //! same as in `bake`
+            const IGPUBuffer* drawCountBuffer = nullptr;
+            //! drawcalls per secondary commandbuffer, the granularity of the re-recording
+            uint32_t drawcallsPerCommandBuffer = 4096u;
+            //! Called when a chunk has no commandbuffer yet or its old one can't be reset, must return a secondary commandbuffer
+            /**
+                With a parallel policy this gets called from many threads at once. Commandpools are externally synchronized, so the
+                commandbuffers of different chunks must come from different pools (for example a pool per chunk index), and so must
+                the commandbuffers you record in the meantime. Pools need `ECF_RESET_COMMAND_BUFFER_BIT` for the commandbuffers to get reused.
+            */
+            std::function<core::smart_refctd_ptr<IGPUCommandBuffer>(const uint32_t chunk)> createCommandBuffer;
+        };
+        //! Keeps the drawcalls of a subpass recorded in secondary commandbuffers, re-records only the stale ones and executes them all in `primary`
+        /**
+            `primary` must have begun the subpass with `ESC_SECONDARY_COMMAND_BUFFERS` contents. The secondaries of a subpass get reused
+            across bakes, so none of them may be pending when you bake again (they're recorded with `EU_SIMULTANEOUS_USE_BIT` so they can
+            be executed by many primaries, but not re-recorded while one of those is in flight).
+            @returns how many secondary commandbuffers got (re-)recorded.
+        */
+        template<class ExecutionPolicy>
+        uint32_t bakeSecondaries(ExecutionPolicy&& policy, IGPUCommandBuffer* primary, const SSecondaryBakeParams& params)
+        {
+            assert(primary&&params.renderpass&&params.subpassIndex<params.renderpass->getSubpasses().size()&&params.drawIndirectBuffer);
+            assert(params.drawcallsPerCommandBuffer&&params.createCommandBuffer);
+            updateSortOrder();
+            const auto range = getSortedRange(params.renderpass.get(),params.subpassIndex);
+
+            auto& secondaries = m_secondaries[{params.renderpass.get(),params.subpassIndex}];
+            // a different set of buffers, chunk size or framebuffer invalidates everything
+            if (secondaries.drawIndirectBuffer!=params.drawIndirectBuffer || secondaries.drawCountBuffer!=params.drawCountBuffer ||
+                secondaries.framebuffer!=params.framebuffer.get() || secondaries.drawcallsPerCommandBuffer!=params.drawcallsPerCommandBuffer)
+            {
+                for (auto& chunk : secondaries.chunks)
+                    chunk.draws.clear();
+                secondaries.drawIndirectBuffer = params.drawIndirectBuffer;
+                secondaries.drawCountBuffer = params.drawCountBuffer;
+                secondaries.framebuffer = params.framebuffer.get();
+                secondaries.drawcallsPerCommandBuffer = params.drawcallsPerCommandBuffer;
+            }
+
+            // a chunk is stale if its drawcalls moved or any of them got modified since it was recorded
+            const uint32_t drawCount = range.second-range.first;
+            const uint32_t chunkCount = (drawCount+params.drawcallsPerCommandBuffer-1u)/params.drawcallsPerCommandBuffer;
+            secondaries.chunks.resize(chunkCount);
+            m_staleChunks.clear();
+            for (uint32_t i=0u; i<chunkCount; i++)
+            {
+                auto& chunk = secondaries.chunks[i];
+                const uint32_t* const draws = m_sortedIndices.data()+range.first+i*params.drawcallsPerCommandBuffer;
+                const uint32_t count = std::min(drawCount-i*params.drawcallsPerCommandBuffer,params.drawcallsPerCommandBuffer);
+                const bool upToDate = chunk.cmdbuf && chunk.draws.size()==count && std::equal(draws,draws+count,chunk.draws.begin()) &&
+                    std::all_of(draws,draws+count,[&](const uint32_t draw) -> bool {return m_modifiedEpoch[draw]<=chunk.recordedEpoch;});
+                if (upToDate)
+                    continue;
+                chunk.draws.assign(draws,draws+count);
+                m_staleChunks.push_back(i);
+            }
+
+            const IGPUCommandBuffer::SInheritanceInfo inheritanceInfo = {params.renderpass,params.subpassIndex,params.framebuffer,false,video::IQueryPool::E_QUERY_CONTROL_FLAGS::EQCF_NONE};
+            core::for_each(policy,m_staleChunks.begin(),m_staleChunks.end(),[&](const uint32_t i) -> void
+            {
+                auto& chunk = secondaries.chunks[i];
+                if (!chunk.cmdbuf || !chunk.cmdbuf->canReset() || !chunk.cmdbuf->reset(0u))
+                    chunk.cmdbuf = params.createCommandBuffer(i);
+                assert(chunk.cmdbuf && chunk.cmdbuf->getLevel()==IGPUCommandBuffer::EL_SECONDARY);
+                chunk.cmdbuf->begin(IGPUCommandBuffer::EU_RENDER_PASS_CONTINUE_BIT|IGPUCommandBuffer::EU_SIMULTANEOUS_USE_BIT,&inheritanceInfo);
+                const DrawcallInfo* const data = m_drawCallMetadataStorage.data();
+                record(chunk.cmdbuf.get(),indexed_iterator{data,chunk.draws.data()},indexed_iterator{data,chunk.draws.data()+chunk.draws.size()},params.drawIndirectBuffer,params.drawCountBuffer);
+                chunk.cmdbuf->end();
+                chunk.recordedEpoch = m_epoch;
+            });
+
+            if (chunkCount)
+            {
+                core::vector<IGPUCommandBuffer*> cmdbufs(chunkCount);
+                for (uint32_t i=0u; i<chunkCount; i++)
+                    cmdbufs[i] = secondaries.chunks[i].cmdbuf.get();
+                primary->executeCommands(chunkCount,cmdbufs.data());
+            }
+            return static_cast<uint32_t>(m_staleChunks.size());
+        }
+        //! Records the stale secondaries one after the other
+        inline uint32_t bakeSecondaries(IGPUCommandBuffer* primary, const SSecondaryBakeParams& params)
+        {
+            return bakeSecondaries(core::execution::seq,primary,params);
+        }
+
+    protected:
+        system::logger_opt_smart_ptr m_logger;
+        core::vector<DrawcallInfo> m_drawCallMetadataStorage;
+        uint64_t m_needsSorting = DefaultOrder::invalidTypeID;
+
+        using call_iterator = typename decltype(m_drawCallMetadataStorage)::const_iterator;
+        //! walks the drawcalls in the sorted order without moving them
+        struct indexed_iterator
+        {
+            const DrawcallInfo* drawcalls;
+            const uint32_t* index;
+
+            inline const DrawcallInfo* operator->() const {return drawcalls+*index;}
+            inline indexed_iterator& operator++() {index++; return *this;}
+            inline indexed_iterator operator++(int) {indexed_iterator retval = *this; index++; return retval;}
+            inline bool operator==(const indexed_iterator& other) const {return index==other.index;}
+            inline bool operator!=(const indexed_iterator& other) const {return index!=other.index;}
+        };
+
+        template<class Iterator>
+        static inline void record(IGPUCommandBuffer* cmdbuf, const Iterator begin, const Iterator end, const IGPUBuffer* drawIndirectBuffer, const IGPUBuffer* drawCountBuffer)
+        {
             const auto& features = cmdbuf->getOriginDevice()->getPhysicalDevice()->getFeatures();
             const bool drawCountEnabled = features.drawIndirectCount;
 
@@ -202,11 +428,6 @@ class CSubpassKiln
                 bake_impl<false>(drawCountEnabled,drawIndirectBuffer,drawCountBuffer)(cmdbuf,begin,end);
         }
 
-    protected:
-        core::vector<DrawcallInfo> m_drawCallMetadataStorage;
-        uint64_t m_needsSorting = DefaultOrder::invalidTypeID;
-
-        using call_iterator = typename decltype(m_drawCallMetadataStorage)::const_iterator;
         template<bool multiDrawEnabled>
         struct bake_impl
         {
@@ -214,7 +435,8 @@ class CSubpassKiln
                 bake_impl(const bool _drawCountEnabled, const IGPUBuffer* _drawIndirectBuffer, const IGPUBuffer* _drawCountBuffer)
                     : drawCountEnabled(_drawCountEnabled), drawIndirectBuffer(_drawIndirectBuffer), drawCountBuffer(_drawCountBuffer) {}
 
-                inline void operator()(IGPUCommandBuffer* cmdbuf, const call_iterator begin, const call_iterator end)
+                template<class Iterator>
+                inline void operator()(IGPUCommandBuffer* cmdbuf, const Iterator begin, const Iterator end)
                 {
                     for (auto it=begin; it!=end;)
                     {
@@ -348,6 +570,197 @@ class CSubpassKiln
                 asset::E_INDEX_TYPE indexType = asset::EIT_UNKNOWN;
                 const IGPUBuffer* indexBuffer = nullptr;
         };
+
+        // the interned state tuples
+        using descriptor_sets_t = std::array<const IGPUDescriptorSet*,IGPUPipelineLayout::DESCRIPTOR_SET_COUNT>;
+        struct SVertexBinding
+        {
+            const IGPUBuffer* buffer;
+            uint64_t offset;
+
+            inline bool operator==(const SVertexBinding& other) const {return buffer==other.buffer && offset==other.offset;}
+        };
+        using vertex_bindings_t = std::array<SVertexBinding,IGPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT>;
+        using index_binding_t = std::pair<const IGPUBuffer*,uint64_t>;
+        struct STupleHash
+        {
+            template<typename T>
+            inline size_t operator()(const T& tuple) const
+            {
+                return std::hash<std::string_view>()(std::string_view(reinterpret_cast<const char*>(&tuple),sizeof(T)));
+            }
+        };
+        struct SInternedPipeline
+        {
+            //! keeps the pipeline alive so its address can't be reused by one with a different renderpass
+            core::smart_refctd_ptr<const IGPUGraphicsPipeline> pipeline;
+            //! pass, layout and pipeline IDs already in place
+            uint64_t hiBits;
+        };
+        struct SChunk
+        {
+            core::smart_refctd_ptr<IGPUCommandBuffer> cmdbuf;
+            core::vector<uint32_t> draws;
+            uint64_t recordedEpoch = 0ull;
+        };
+        struct SSubpassSecondaries
+        {
+            core::vector<SChunk> chunks;
+            const IGPUBuffer* drawIndirectBuffer = nullptr;
+            const IGPUBuffer* drawCountBuffer = nullptr;
+            const IGPUFramebuffer* framebuffer = nullptr;
+            uint32_t drawcallsPerCommandBuffer = 0u;
+        };
+
+        template<class Map>
+        static inline uint64_t intern(Map& map, const typename Map::key_type& key, const uint32_t bits)
+        {
+            // the size is taken before the insertion
+            const auto found = map.try_emplace(key,static_cast<uint32_t>(map.size())).first;
+            return std::min<uint64_t>(found->second,(0x1ull<<bits)-1ull);
+        }
+        inline uint64_t internPipeline(const core::smart_refctd_ptr<const IGPUGraphicsPipeline>& pipeline)
+        {
+            const auto found = m_pipelines.find(pipeline.get());
+            if (found!=m_pipelines.end())
+                return found->second.hiBits;
+
+            const uint64_t passID = intern(m_passIDs,{pipeline->getRenderpass(),pipeline->getSubpassIndex()},SortKey::PassIDBits);
+            // the search for a subpass' drawcalls relies on unique pass IDs, `getSortedRange` won't find the ones sharing the last ID
+            if (passID==InvalidPassID)
+                m_logger.log("CSubpassKiln: more than %d renderpass and subpass combinations, the drawcalls of pipeline %p won't be baked!",system::ILogger::ELL_ERROR,InvalidPassID,pipeline.get());
+            // layouts which wouldn't need the push constants or any descriptor set rebound get the same ID
+            const auto* layout = pipeline->getRenderpassIndependentPipeline()->getLayout();
+            constexpr auto LastSet = IGPUPipelineLayout::DESCRIPTOR_SET_COUNT-1u;
+            uint64_t layoutID = 0ull;
+            for (; layoutID<m_layoutClasses.size(); layoutID++)
+            {
+                const auto* other = m_layoutClasses[layoutID];
+                if (other==layout || other->isCompatibleForPushConstants(layout) && other->isCompatibleUpToSet(LastSet,layout)==LastSet)
+                    break;
+            }
+            if (layoutID==m_layoutClasses.size())
+                m_layoutClasses.push_back(layout);
+            layoutID = std::min<uint64_t>(layoutID,(0x1ull<<SortKey::LayoutIDBits)-1ull);
+            const uint64_t pipelineID = std::min<uint64_t>(m_pipelines.size(),(0x1ull<<SortKey::PipelineIDBits)-1ull);
+
+            const uint64_t hiBits = (passID<<SortKey::PassIDShift)|(layoutID<<SortKey::LayoutIDShift)|(pipelineID<<SortKey::PipelineIDShift);
+            m_pipelines.emplace(pipeline.get(),SInternedPipeline{pipeline,hiBits});
+            return hiBits;
+        }
+        inline SortKey computeSortKey(const DrawcallInfo& draw)
+        {
+            descriptor_sets_t descriptorSets;
+            for (auto i=0u; i<IGPUPipelineLayout::DESCRIPTOR_SET_COUNT; i++)
+                descriptorSets[i] = draw.descriptorSets[i].get();
+            vertex_bindings_t vertexBindings;
+            for (auto i=0u; i<IGPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+                vertexBindings[i] = {draw.vertexBufferBindings[i].buffer.get(),draw.vertexBufferBindings[i].offset};
+
+            SortKey key;
+            key.hi = internPipeline(draw.pipeline)|(intern(m_descriptorSetIDs,descriptorSets,SortKey::DescriptorSetsIDBits)<<SortKey::DescriptorSetsIDShift);
+            key.lo = (intern(m_vertexBindingIDs,vertexBindings,SortKey::VertexBindingsIDBits)<<SortKey::VertexBindingsIDShift)|
+                (intern(m_indexBindingIDs,{draw.indexBufferBinding.get(),draw.indexType},SortKey::IndexBindingIDBits)<<SortKey::IndexBindingIDShift);
+            return key;
+        }
+
+        //! Brings the sorted order up to date with all the changes made since the last bake
+        inline void updateSortOrder()
+        {
+            const uint32_t drawCount = static_cast<uint32_t>(m_drawCallMetadataStorage.size());
+            if (m_needsSorting!=DefaultOrder::typeID)
+            {
+                // IDs only ever get handed out, start afresh so stale state doesn't use up the ID space
+                m_pipelines.clear();
+                m_passIDs.clear();
+                m_layoutClasses.clear();
+                m_descriptorSetIDs.clear();
+                m_vertexBindingIDs.clear();
+                m_indexBindingIDs.clear();
+
+                m_sortKeys.resize(drawCount);
+                for (uint32_t i=0u; i<drawCount; i++)
+                    m_sortKeys[i] = computeSortKey(m_drawCallMetadataStorage[i]);
+                m_modifiedEpoch.assign(drawCount,++m_epoch);
+                m_dirtyRanges.clear();
+                sortKeys();
+                m_needsSorting = DefaultOrder::typeID;
+                return;
+            }
+            if (m_dirtyRanges.empty())
+                return;
+
+            m_epoch++;
+            bool reorder = false;
+            for (const auto& range : m_dirtyRanges)
+            for (uint32_t i=range.first; i<range.second; i++)
+            {
+                const SortKey key = computeSortKey(m_drawCallMetadataStorage[i]);
+                reorder = reorder || key!=m_sortKeys[i];
+                m_sortKeys[i] = key;
+                m_modifiedEpoch[i] = m_epoch;
+            }
+            m_dirtyRanges.clear();
+            // the order of drawcalls with equal keys is their index, so it only changes if a key does
+            if (reorder)
+                sortKeys();
+        }
+        inline void sortKeys()
+        {
+            const size_t drawCount = m_sortKeys.size();
+            m_sortedKeys = m_sortKeys;
+            m_sortedIndices.resize(drawCount);
+            std::iota(m_sortedIndices.begin(),m_sortedIndices.end(),0u);
+            m_keyScratch.resize(drawCount);
+            m_indexScratch.resize(drawCount);
+            const auto sorted = core::radix_sort_pairs(core::execution::par_unseq,m_sortedKeys.data(),m_keyScratch.data(),m_sortedIndices.data(),m_indexScratch.data(),drawCount,SortKey::Accessor());
+            if (sorted.first!=m_sortedKeys.data())
+            {
+                std::swap(m_sortedKeys,m_keyScratch);
+                std::swap(m_sortedIndices,m_indexScratch);
+            }
+        }
+        //! [first,second) of the sorted order which belongs to the subpass
+        inline std::pair<uint32_t,uint32_t> getSortedRange(const IGPURenderpass* renderpass, const uint32_t subpassIndex) const
+        {
+            const auto found = m_passIDs.find({renderpass,subpassIndex});
+            if (found==m_passIDs.end())
+                return {0u,0u};
+            const uint32_t passID = found->second;
+            if (passID>=InvalidPassID)
+                return {0u,0u};
+            const auto range = std::equal_range(m_sortedKeys.begin(),m_sortedKeys.end(),passID,SPassIDLess());
+            return {static_cast<uint32_t>(range.first-m_sortedKeys.begin()),static_cast<uint32_t>(range.second-m_sortedKeys.begin())};
+        }
+        struct SPassIDLess
+        {
+            inline bool operator()(const SortKey& lhs, const uint32_t rhs) const {return lhs.getPassID()<rhs;}
+            inline bool operator()(const uint32_t lhs, const SortKey& rhs) const {return lhs<rhs.getPassID();}
+        };
+
+        //! shared by all the passes past the ones a `SortKey` can tell apart
+        static inline constexpr uint32_t InvalidPassID = (0x1u<<SortKey::PassIDBits)-1u;
+        // interned state, the IDs stay the same until a full rebuild
+        core::unordered_map<const IGPUGraphicsPipeline*,SInternedPipeline> m_pipelines;
+        core::map<std::pair<const IGPURenderpass*,uint32_t>,uint32_t> m_passIDs;
+        core::vector<const IGPUPipelineLayout*> m_layoutClasses;
+        core::unordered_map<descriptor_sets_t,uint32_t,STupleHash> m_descriptorSetIDs;
+        core::unordered_map<vertex_bindings_t,uint32_t,STupleHash> m_vertexBindingIDs;
+        core::unordered_map<index_binding_t,uint32_t,STupleHash> m_indexBindingIDs;
+        // per drawcall, in the order of `m_drawCallMetadataStorage`
+        core::vector<SortKey> m_sortKeys;
+        core::vector<uint64_t> m_modifiedEpoch;
+        core::vector<std::pair<uint32_t,uint32_t>> m_dirtyRanges;
+        //! bumped by every bake that changed something
+        uint64_t m_epoch = 0ull;
+        // the sorted order
+        core::vector<SortKey> m_sortedKeys;
+        core::vector<uint32_t> m_sortedIndices;
+        core::vector<SortKey> m_keyScratch;
+        core::vector<uint32_t> m_indexScratch;
+        // the recorded secondaries of every subpass baked with `bakeSecondaries`
+        core::map<std::pair<const IGPURenderpass*,uint32_t>,SSubpassSecondaries> m_secondaries;
+        core::vector<uint32_t> m_staleChunks;
 };
 
 }
@@ -27,6 +27,10 @@
 //#include "nbl/asset/bawformat/CBAWMeshFileLoader.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_NBC_LOADER_
+#include "nbl/asset/interchange/CNBCLoader.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_GLTF_LOADER_
 #include "nbl/asset/interchange/CGLTFLoader.h"
 #endif
@@ -63,6 +67,10 @@
 //#include "nbl/asset/bawformat/CBAWMeshWriter.h"
 #endif
 
+#ifdef _NBL_COMPILE_WITH_NBC_WRITER_
+#include "nbl/asset/interchange/CNBCWriter.h"
+#endif
+
 #ifdef _NBL_COMPILE_WITH_GLTF_WRITER_
 #include "nbl/asset/interchange/CGLTFWriter.h"
 #endif
@@ -120,7 +128,7 @@ std::function<void(SAssetBundle&)> nbl::asset::makeAssetDisposeFunc(const IAsset
 void IAssetManager::initializeMeshTools()
 {
 	m_meshManipulator = core::make_smart_refctd_ptr<CMeshManipulator>();
-    m_geometryCreator = core::make_smart_refctd_ptr<CGeometryCreator>(m_meshManipulator.get());
+    m_geometryCreator = core::make_smart_refctd_ptr<CGeometryCreator>(m_meshManipulator.get(),[this](IAsset* asset) {setAssetMutability(asset,IAsset::EM_IMMUTABLE);});
     m_glslCompiler = core::make_smart_refctd_ptr<IGLSLCompiler>(m_system.get());
 }
 
@@ -151,6 +159,9 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_BAW_LOADER_
 	//addAssetLoader(core::make_smart_refctd_ptr<asset::CBAWMeshFileLoader>(this));
 #endif
+#ifdef _NBL_COMPILE_WITH_NBC_LOADER_
+	addAssetLoader(core::make_smart_refctd_ptr<asset::CNBCLoader>(core::smart_refctd_ptr<system::ISystem>(m_system)));
+#endif
 #ifdef _NBL_COMPILE_WITH_GLTF_LOADER_
     addAssetLoader(core::make_smart_refctd_ptr<asset::CGLTFLoader>(this));
 #endif
@@ -176,8 +187,11 @@ void IAssetManager::addLoadersAndWriters()
 #ifdef _NBL_COMPILE_WITH_BAW_WRITER_
 	//addAssetWriter(core::make_smart_refctd_ptr<asset::CBAWMeshWriter>(getFileSystem()));
 #endif
+#ifdef _NBL_COMPILE_WITH_NBC_WRITER_
+	addAssetWriter(core::make_smart_refctd_ptr<asset::CNBCWriter>());
+#endif
 #ifdef _NBL_COMPILE_WITH_GLTF_WRITER_
-    addAssetWriter(core::make_smart_refctd_ptr<asset::CGLTFWriter>());
+    addAssetWriter(core::make_smart_refctd_ptr<asset::CGLTFWriter>(core::smart_refctd_ptr<system::ISystem>(m_system)));
 #endif
 #ifdef _NBL_COMPILE_WITH_PLY_WRITER_
 	addAssetWriter(core::make_smart_refctd_ptr<asset::CPLYMeshWriter>());
@@ -0,0 +1,59 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/interchange/CAssetCache.h"
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/ICPUBufferView.h"
+#include "nbl/asset/ICPUMesh.h"
+
+using namespace nbl;
+using namespace asset;
+
+
+static inline size_t bufferSize(const ICPUBuffer* _buffer)
+{
+	return _buffer ? _buffer->getSize():0ull;
+}
+static inline size_t imageSize(const ICPUImage* _image)
+{
+	return _image ? (_image->conservativeSizeEstimate()+bufferSize(_image->getBuffer())):0ull;
+}
+
+size_t CAssetCache::estimateByteSize(const IAsset* _asset)
+{
+	if (!_asset)
+		return 0ull;
+
+	size_t retval = _asset->conservativeSizeEstimate();
+	switch (_asset->getAssetType())
+	{
+		case IAsset::ET_BUFFER_VIEW:
+			retval += bufferSize(static_cast<const ICPUBufferView*>(_asset)->getUnderlyingBuffer());
+			break;
+		case IAsset::ET_IMAGE:
+			retval = imageSize(static_cast<const ICPUImage*>(_asset));
+			break;
+		case IAsset::ET_IMAGE_VIEW:
+			retval += imageSize(static_cast<const ICPUImageView*>(_asset)->getCreationParameters().image.get());
+			break;
+		case IAsset::ET_MESH:
+		{
+			// meshbuffers very often share one vertex buffer, count it once
+			core::unordered_set<const ICPUBuffer*> buffers;
+			for (const auto* meshbuffer : static_cast<const ICPUMesh*>(_asset)->getMeshBuffers())
+			{
+				retval += meshbuffer->conservativeSizeEstimate();
+				for (size_t i=0ull; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+					buffers.insert(meshbuffer->getVertexBufferBindings()[i].buffer.get());
+				buffers.insert(meshbuffer->getIndexBufferBinding().buffer.get());
+			}
+			for (const auto* buffer : buffers)
+				retval += bufferSize(buffer);
+			break;
+		}
+		default:
+			break;
+	}
+	return retval;
+}
@@ -34,6 +34,17 @@ class CGLILoader final : public asset::IAssetLoader
 			return extensions;
 		}
 
+		const SFileSignature* getFileSignatures() const override
+		{
+			static const SFileSignature signatures[]{
+				{"DDS ",0u,4u},
+				{"\xABKTX 11\xBB\r\n\x1A\n",0u,12u},
+				{"UUUUUUUUUUUUUUUU",0u,16u},
+				{}
+			};
+			return signatures;
+		}
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -52,6 +52,15 @@ class CGLSLLoader final : public asset::IAssetLoader
 			return ext;
 		}
 
+		//! Nothing but whitespace and comments may precede the `#version` directive
+		bool matchesFileHeader(const SFileHeader& _header) const override
+		{
+			for (size_t i=0u; i<_header.size; i++)
+			if (!isspace(_header.data[i]))
+				return _header.data[i]=='#' || _header.data[i]=='/';
+			return _header.size==SFileHeader::MaxSize;
+		}
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_SPECIALIZED_SHADER; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -34,6 +34,12 @@ using namespace nbl::asset;
 			_NBL_STATIC_INLINE_CONSTEXPR uint8_t WEIGHTS_ATTRIBUTE_LAYOUT_ID = 5;
 		}
 
+		//! GLB is a little endian header of the magic, the version and the file length, followed by chunks of a length, a type and the data
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t GLBMagic = 0x46546C67u; // "glTF"
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t GLBVersion = 2u;
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t GLBChunkJSON = 0x4E4F534Au; // "JSON"
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t GLBChunkBIN = 0x004E4942u; // "BIN\0"
+
 		/*
 			Each glTF asset must have an asset property. 
 			In fact, it's the only required top-level property
@@ -98,32 +104,58 @@ using namespace nbl::asset;
 			IRenderpassIndependentPipelineLoader::initialize();
 		}
 		
-		bool CGLTFLoader::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+		bool CGLTFLoader::matchesFileHeader(const SFileHeader& _header) const
 		{
-			simdjson::dom::parser parser;
-
-			auto jsonBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(_file->getSize());
+			if (_header.size>=sizeof(GLBMagic) && memcmp(_header.data,&GLBMagic,sizeof(GLBMagic))==0)
+				return true;
+			size_t i = 0u;
+			// UTF-8 BOM
+			if (_header.size>=3u && memcmp(_header.data,"\xEF\xBB\xBF",3u)==0)
+				i = 3u;
+			// a glTF document is a non-empty object, so the `{` has to be followed by the first key's quote
+			char expected = '{';
+			for (; i<_header.size; i++)
 			{
-				system::IFile::success_t success;
-				_file->read(success, jsonBuffer->getPointer(), 0u, jsonBuffer->getSize());
-				if (!success)
+				if (isspace(_header.data[i]))
+					continue;
+				if (_header.data[i]!=expected)
 					return false;
+				if (expected=='"')
+					return true;
+				expected = '"';
 			}
+			return _header.size==SFileHeader::MaxSize;
+		}
 
-			simdjson::dom::object tweets;
-			auto error = parser.parse(reinterpret_cast<uint8_t*>(jsonBuffer->getPointer()), jsonBuffer->getSize()).get(tweets);
-
-			if (error)
-			{
-				logger.log("Could not parse '" + _file->getFileName().string() + "' file!");
+		/*
+			A full parse here would have to be repeated by `loadAsset`, so past the header only the `"asset"` key every glTF
+			needs gets searched for. `loadAndGetGLTF` does the actual validation and `loadAsset` fails gracefully on anything else.
+		*/
+		bool CGLTFLoader::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+		{
+			if (!_file)
 				return false;
-			}
+			const SFileHeader header(_file);
+			if (!matchesFileHeader(header))
+				return false;
+			if (header.size>=sizeof(GLBMagic) && memcmp(header.data,&GLBMagic,sizeof(GLBMagic))==0)
+				return true;
 
-			simdjson::dom::element element;
-			if (tweets.at_key("asset").get(element) == simdjson::error_code::SUCCESS)
-				if (element.at_key("version").get(element) == simdjson::error_code::SUCCESS)
+			std::string json(_file->getSize(),'\0');
+			system::IFile::success_t success;
+			_file->read(success, json.data(), 0u, json.size());
+			if (!success)
+				return false;
+			constexpr std::string_view AssetKey = "\"asset\"";
+			for (auto pos=json.find(AssetKey); pos!=std::string::npos; pos=json.find(AssetKey,pos+1u))
+			{
+				auto next = pos+AssetKey.size();
+				while (next<json.size() && isspace(json[next]))
+					next++;
+				// a key and not a value
+				if (next<json.size() && json[next]==':')
 					return true;
-
+			}
 			return false;
 		}
 
@@ -145,6 +177,14 @@ using namespace nbl::asset;
 			core::vector<core::smart_refctd_ptr<ICPUBuffer>> cpuBuffers;
 			for (auto& glTFBuffer : glTF.buffers)
 			{
+				// the BIN chunk of a GLB got read straight into its own buffer
+				if (!glTFBuffer.uri.has_value())
+				{
+					if (&glTFBuffer!=glTF.buffers.data() || !glTF.binaryChunk)
+						return {};
+					cpuBuffers.emplace_back() = glTF.binaryChunk;
+					continue;
+				}
 				// FarFuture TODO: handle buffer embedded in glTF
 				auto buffer_bundle = interm_getAssetInHierarchy(assetManager,glTFBuffer.uri.value(),context.loadContext.params,_hierarchyLevel+ICPUMesh::BUFFER_HIERARCHYLEVELS_BELOW,_override);
 				if (buffer_bundle.getContents().empty())
@@ -692,7 +732,7 @@ using namespace nbl::asset;
 
 							auto handleAccessor = [&](SGLTF::SGLTFAccessor& glTFAccessor, const std::optional<uint32_t> queryAttributeId = {}) -> bool
 							{
-								const E_FORMAT format = SGLTF::SGLTFAccessor::getFormat(glTFAccessor.componentType.value(), glTFAccessor.type.value());
+								const E_FORMAT format = SGLTF::SGLTFAccessor::getFormat(glTFAccessor.componentType.value(), glTFAccessor.type.value(), glTFAccessor.normalized.value_or(false));
 								if (format == EF_UNKNOWN)
 								{
 									context.loadContext.params.logger.log("GLTF: COULD NOT SPECIFY NABLA FORMAT!",system::ILogger::ELL_ERROR);
@@ -741,8 +781,6 @@ using namespace nbl::asset;
 									case SGLTFBufferView::SGLTFT_ELEMENT_ARRAY_BUFFER:
 									{
 										// TODO: make sure glTF data has validated index type
-
-										bufferBinding.offset += relativeOffsetInBufferViewAttribute;
 										cpuMeshBuffer->setIndexBufferBinding(std::move(bufferBinding));
 									} break;
 									}
@@ -769,7 +807,7 @@ using namespace nbl::asset;
 									case SGLTFPrimitive::SGLTFPT_TRIANGLE_STRIP:
 										return EPT_TRIANGLE_STRIP;
 									case SGLTFPrimitive::SGLTFPT_TRIANGLE_FAN:
-										return EPT_TRIANGLE_STRIP_WITH_ADJACENCY; // check it
+										return EPT_TRIANGLE_FAN;
 									default:
 										break;
 								}
@@ -1636,16 +1674,67 @@ using namespace nbl::asset;
 			simdjson::dom::parser parser;
 			auto* _file = context.loadContext.mainFile;
 
-			auto jsonBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(_file->getSize());
+			// a GLB's JSON chunk and BIN chunk get read into separate buffers, so the binary data never needs a copy
+			size_t jsonOffset = 0ull;
+			size_t jsonSize = _file->getSize();
+			uint32_t header[5];
+			if (jsonSize>=sizeof(header))
+			{
+				system::IFile::success_t success;
+				_file->read(success, header, 0u, sizeof(header));
+				if (!success)
+					return false;
+			}
+			if (jsonSize>=sizeof(header) && header[0]==GLBMagic)
+			{
+				if (header[1]!=GLBVersion || header[2]>_file->getSize() || header[4]!=GLBChunkJSON || sizeof(header)+header[3]>header[2])
+				{
+					context.loadContext.params.logger.log("GLTF: '" + _file->getFileName().string() + "' is not a valid GLB version 2 file!",system::ILogger::ELL_ERROR);
+					return false;
+				}
+				jsonOffset = sizeof(header);
+				jsonSize = header[3];
+
+				// the BIN chunk is optional and has to come right after the JSON one, any chunks after it are extensions
+				const size_t binOffset = jsonOffset+core::roundUp<size_t>(jsonSize,4ull);
+				uint32_t binHeader[2];
+				if (binOffset+sizeof(binHeader)<=header[2])
+				{
+					system::IFile::success_t success;
+					_file->read(success, binHeader, binOffset, sizeof(binHeader));
+					if (!success)
+						return false;
+					if (binHeader[1]==GLBChunkBIN && binHeader[0] && binOffset+sizeof(binHeader)+binHeader[0]<=header[2])
+					{
+						glTF.binaryChunk = core::make_smart_refctd_ptr<ICPUBuffer>(binHeader[0]);
+						_file->read(success, glTF.binaryChunk->getPointer(), binOffset+sizeof(binHeader), binHeader[0]);
+						if (!success)
+							return false;
+					}
+				}
+			}
+
+			auto jsonBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(jsonSize);
 			{
 				system::IFile::success_t success;
-				_file->read(success, jsonBuffer->getPointer(), 0u, jsonBuffer->getSize());
+				_file->read(success, jsonBuffer->getPointer(), jsonOffset, jsonBuffer->getSize());
 				if (!success)
 					return false;
 			}
 
-			simdjson::dom::object tweets = parser.parse(reinterpret_cast<uint8_t*>(jsonBuffer->getPointer()), jsonBuffer->getSize());
+			simdjson::dom::object tweets;
+			if (parser.parse(reinterpret_cast<uint8_t*>(jsonBuffer->getPointer()), jsonBuffer->getSize()).get(tweets))
+			{
+				context.loadContext.params.logger.log("Could not parse '" + _file->getFileName().string() + "' file!");
+				return false;
+			}
 			simdjson::dom::element element;
+			// the `asset` object with a `version` is the only thing required of a glTF file
+			if (tweets.at_key("asset").get(element) != simdjson::error_code::SUCCESS || element.at_key("version").get(element) != simdjson::error_code::SUCCESS)
+			{
+				context.loadContext.params.logger.log("'" + _file->getFileName().string() + "' is JSON, but not glTF!");
+				return false;
+			}
 
 			//std::filesystem::path filePath(_file->getFileName().c_str());
 			//const std::string rootAssetDirectory = std::filesystem::absolute(filePath.remove_filename()).u8string();
@@ -17,7 +17,7 @@
 namespace nbl::asset
 {
 
-//! glTF Loader capable of loading .gltf files
+//! glTF Loader capable of loading .gltf files and binary .glb containers
 /*
 	glTF bridges the gap between 3D content creation tools and modern 3D applications 
 	by providing an efficient, extensible, interoperable format for the transmission and loading of 3D content.
@@ -31,10 +31,13 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 
 		const char** getAssociatedFileExtensions() const override
 		{
-			static const char* extensions[]{ "gltf", nullptr };
+			static const char* extensions[]{ "gltf", "glb", nullptr };
 			return extensions;
 		}
 
+		//! GLB has a magic, but glTF has none, the best that can be done without a parse is checking that the file starts like a non-empty JSON object
+		bool matchesFileHeader(const SFileHeader& _header) const override;
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_MESH; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -392,6 +395,35 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 					return true;
 				}
 
+				//! normalized integers become UNORM and SNORM formats
+				static inline E_FORMAT getFormat(SCompomentType componentType, SGLTFType type, const bool normalized)
+				{
+					const E_FORMAT format = getFormat(componentType,type);
+					if (!normalized)
+						return format;
+					switch (format)
+					{
+						case EF_R8_UINT: return EF_R8_UNORM;
+						case EF_R8G8_UINT: return EF_R8G8_UNORM;
+						case EF_R8G8B8_UINT: return EF_R8G8B8_UNORM;
+						case EF_R8G8B8A8_UINT: return EF_R8G8B8A8_UNORM;
+						case EF_R8_SINT: return EF_R8_SNORM;
+						case EF_R8G8_SINT: return EF_R8G8_SNORM;
+						case EF_R8G8B8_SINT: return EF_R8G8B8_SNORM;
+						case EF_R8G8B8A8_SINT: return EF_R8G8B8A8_SNORM;
+						case EF_R16_UINT: return EF_R16_UNORM;
+						case EF_R16G16_UINT: return EF_R16G16_UNORM;
+						case EF_R16G16B16_UINT: return EF_R16G16B16_UNORM;
+						case EF_R16G16B16A16_UINT: return EF_R16G16B16A16_UNORM;
+						case EF_R16_SINT: return EF_R16_SNORM;
+						case EF_R16G16_SINT: return EF_R16G16_SNORM;
+						case EF_R16G16B16_SINT: return EF_R16G16B16_SNORM;
+						case EF_R16G16B16A16_SINT: return EF_R16G16B16A16_SNORM;
+						default:
+							break;
+					}
+					return EF_UNKNOWN;
+				}
 				static inline E_FORMAT getFormat(SCompomentType componentType, SGLTFType type)
 				{
 					switch (componentType)
@@ -809,6 +841,9 @@ class CGLTFLoader final : public IRenderpassIndependentPipelineLoader
 			std::vector<SGLTFMaterial> materials;
 			std::vector<SGLTFSkin> skins;
 			std::vector<SGLTFAnimation> animations;
+
+			//! BIN chunk of a GLB, the data of the first buffer, which has no `uri`
+			core::smart_refctd_ptr<ICPUBuffer> binaryChunk;
 		};
 
 		bool loadAndGetGLTF(SGLTF& glTF, SContext& context);
@@ -2,18 +2,736 @@
 // This file is part of the "Nabla Engine".
 // For conditions of distribution and use, see copyright notice in irrlicht.h
 
-#include "CGLTFWriter.h"
-	 
+#include "nbl/asset/interchange/CGLTFWriter.h"
+
 #ifdef _NBL_COMPILE_WITH_GLTF_WRITER_
 
+#include "nbl/core/execution.h"
+#include "nbl/core/xxHash256.h"
+#include "nbl/system/CBufferedFileWriter.h"
+#include "nbl/asset/utils/IMeshManipulator.h"
+
 namespace nbl
 {
 	namespace asset
 	{
+		namespace
+		{
+			constexpr uint32_t GLBMagic = 0x46546C67u; // "glTF"
+			constexpr uint32_t GLBVersion = 2u;
+			constexpr uint32_t GLBChunkJSON = 0x4E4F534Au; // "JSON"
+			constexpr uint32_t GLBChunkBIN = 0x004E4942u; // "BIN\0"
+			constexpr size_t GLBHeaderSize = 12ull;
+			constexpr size_t GLBChunkHeaderSize = 8ull;
+			//! buffer views, vertex elements and GLB chunks all start 4 byte aligned
+			constexpr uint32_t Alignment = 4u;
+			constexpr uint32_t MaxByteStride = 252u;
+
+			enum E_TARGET : uint32_t
+			{
+				ET_ARRAY_BUFFER = 34962u,
+				ET_ELEMENT_ARRAY_BUFFER = 34963u
+			};
+			enum E_COMPONENT_TYPE : uint32_t
+			{
+				ECT_BYTE = 5120u,
+				ECT_UNSIGNED_BYTE = 5121u,
+				ECT_SHORT = 5122u,
+				ECT_UNSIGNED_SHORT = 5123u,
+				ECT_UNSIGNED_INT = 5125u,
+				ECT_FLOAT = 5126u
+			};
+			//! core glTF only allows a few formats for the standard semantics
+			enum E_SEMANTIC : uint8_t
+			{
+				ES_POSITION,
+				ES_NORMAL,
+				ES_TEXCOORD,
+				ES_COLOR,
+				ES_CUSTOM
+			};
+
+			struct SAccessorType
+			{
+				E_COMPONENT_TYPE componentType = ECT_FLOAT;
+				bool normalized = false;
+				//! 0 if the format has no glTF equivalent
+				uint32_t components = 0u;
+
+				inline auto operator<=>(const SAccessorType&) const = default;
+			};
+			SAccessorType getAccessorType(const E_FORMAT format)
+			{
+				const uint32_t components = getFormatChannelCount(format);
+				switch (format)
+				{
+					case EF_R8_UNORM: case EF_R8G8_UNORM: case EF_R8G8B8_UNORM: case EF_R8G8B8A8_UNORM:
+						return {ECT_UNSIGNED_BYTE,true,components};
+					case EF_R8_SNORM: case EF_R8G8_SNORM: case EF_R8G8B8_SNORM: case EF_R8G8B8A8_SNORM:
+						return {ECT_BYTE,true,components};
+					case EF_R8_UINT: case EF_R8G8_UINT: case EF_R8G8B8_UINT: case EF_R8G8B8A8_UINT:
+						return {ECT_UNSIGNED_BYTE,false,components};
+					case EF_R8_SINT: case EF_R8G8_SINT: case EF_R8G8B8_SINT: case EF_R8G8B8A8_SINT:
+						return {ECT_BYTE,false,components};
+					case EF_R16_UNORM: case EF_R16G16_UNORM: case EF_R16G16B16_UNORM: case EF_R16G16B16A16_UNORM:
+						return {ECT_UNSIGNED_SHORT,true,components};
+					case EF_R16_SNORM: case EF_R16G16_SNORM: case EF_R16G16B16_SNORM: case EF_R16G16B16A16_SNORM:
+						return {ECT_SHORT,true,components};
+					case EF_R16_UINT: case EF_R16G16_UINT: case EF_R16G16B16_UINT: case EF_R16G16B16A16_UINT:
+						return {ECT_UNSIGNED_SHORT,false,components};
+					case EF_R16_SINT: case EF_R16G16_SINT: case EF_R16G16B16_SINT: case EF_R16G16B16A16_SINT:
+						return {ECT_SHORT,false,components};
+					case EF_R32_UINT: case EF_R32G32_UINT: case EF_R32G32B32_UINT: case EF_R32G32B32A32_UINT:
+						return {ECT_UNSIGNED_INT,false,components};
+					case EF_R32_SFLOAT: case EF_R32G32_SFLOAT: case EF_R32G32B32_SFLOAT: case EF_R32G32B32A32_SFLOAT:
+						return {ECT_FLOAT,false,components};
+					default:
+						break;
+				}
+				return {};
+			}
+			//! whether the attribute can be written verbatim, otherwise it gets converted to floats
+			bool isAllowed(const E_SEMANTIC semantic, const SAccessorType& type)
+			{
+				if (!type.components)
+					return false;
+				const bool floatOrUnorm = type.componentType==ECT_FLOAT || type.normalized && (type.componentType==ECT_UNSIGNED_BYTE || type.componentType==ECT_UNSIGNED_SHORT);
+				switch (semantic)
+				{
+					case ES_POSITION:
+					case ES_NORMAL:
+						return type.componentType==ECT_FLOAT && type.components==3u;
+					case ES_TEXCOORD:
+						return floatOrUnorm && type.components==2u;
+					case ES_COLOR:
+						return floatOrUnorm && type.components>=3u;
+					default:
+						break;
+				}
+				// only indices can be 32 bit integers
+				return type.componentType!=ECT_UNSIGNED_INT;
+			}
+			uint32_t getConvertedComponents(const E_SEMANTIC semantic, const E_FORMAT format)
+			{
+				switch (semantic)
+				{
+					case ES_POSITION:
+					case ES_NORMAL:
+						return 3u;
+					case ES_TEXCOORD:
+						return 2u;
+					case ES_COLOR:
+						return getFormatChannelCount(format)==4u ? 4u:3u;
+					default:
+						break;
+				}
+				return getFormatChannelCount(format);
+			}
+			const char* getTypeName(const uint32_t components)
+			{
+				constexpr const char* names[] = {"SCALAR","VEC2","VEC3","VEC4"};
+				return names[components-1u];
+			}
+			//! ~0u for the topologies glTF doesn't have
+			uint32_t getMode(const E_PRIMITIVE_TOPOLOGY topology)
+			{
+				switch (topology)
+				{
+					case EPT_POINT_LIST:
+						return 0u;
+					case EPT_LINE_LIST:
+						return 1u;
+					case EPT_LINE_STRIP:
+						return 3u;
+					case EPT_TRIANGLE_LIST:
+						return 4u;
+					case EPT_TRIANGLE_STRIP:
+						return 5u;
+					case EPT_TRIANGLE_FAN:
+						return 6u;
+					default:
+						break;
+				}
+				return ~0u;
+			}
+
+			//! Emits JSON in a single pass straight into the file, only keeps track of where the commas go
+			class CJSONWriter
+			{
+				public:
+					CJSONWriter(system::CBufferedFileWriter& _out) : m_out(_out) {}
+
+					inline void beginObject() { separate(); m_out.writeText('{'); m_first = true; }
+					inline void endObject() { m_out.writeText('}'); m_first = false; }
+					inline void beginArray() { separate(); m_out.writeText('['); m_first = true; }
+					inline void endArray() { m_out.writeText(']'); m_first = false; }
+
+					inline void key(const std::string_view& _key)
+					{
+						separate();
+						string(_key);
+						m_out.writeText(':');
+						m_afterKey = true;
+					}
+					template<typename T> requires std::is_arithmetic_v<T>
+					inline void value(const T _value) { separate(); m_out.writeText(_value); m_first = false; }
+					inline void value(const bool _value) { separate(); m_out.writeText(_value ? "true":"false"); m_first = false; }
+					inline void value(const std::string_view& _value) { separate(); string(_value); m_first = false; }
+					//! otherwise literals would pick the `bool` overload
+					inline void value(const char* _value) { value(std::string_view(_value)); }
+
+					template<typename T>
+					inline void member(const std::string_view& _key, const T& _value)
+					{
+						key(_key);
+						value(_value);
+					}
+
+				private:
+					inline void separate()
+					{
+						if (m_afterKey)
+							m_afterKey = false;
+						else if (!m_first)
+							m_out.writeText(',');
+					}
+					inline void string(const std::string_view& _str)
+					{
+						m_out.writeText('"');
+						for (const char c : _str)
+						{
+							if (c=='"' || c=='\\')
+							{
+								m_out.writeText('\\');
+								m_out.writeText(c);
+							}
+							else if (static_cast<uint8_t>(c)<0x20u)
+							{
+								char escaped[7];
+								snprintf(escaped,sizeof(escaped),"\\u%04x",c);
+								m_out.writeText(std::string_view(escaped,6ull));
+							}
+							else
+								m_out.writeText(c);
+						}
+						m_out.writeText('"');
+					}
+
+					system::CBufferedFileWriter& m_out;
+					bool m_first = true;
+					bool m_afterKey = false;
+			};
+
+			//! Everything the JSON refers to, gathered before any of it gets written
+			class CDocument
+			{
+				public:
+					//! Adds the meshbuffer as a primitive, returns false if it had to be skipped
+					bool addMeshBuffer(const ICPUMeshBuffer* meshbuffer, const CGLTFWriter::SParams& params, const system::logger_opt_ptr logger)
+					{
+						const auto* pipeline = meshbuffer->getPipeline();
+						if (!pipeline)
+							return false;
+
+						SPrimitive primitive;
+						primitive.mode = getMode(pipeline->getPrimitiveAssemblyParams().primitiveType);
+						if (primitive.mode==~0u)
+						{
+							logger.log("GLTF WRITER: Topology %d has no glTF equivalent, skipping meshbuffer", system::ILogger::ELL_WARNING, pipeline->getPrimitiveAssemblyParams().primitiveType);
+							return false;
+						}
+						const uint32_t vertexCount = IMeshManipulator::upperBoundVertexID(meshbuffer);
+						if (!vertexCount || !meshbuffer->isAttributeEnabled(meshbuffer->getPositionAttributeIx()))
+							return false;
+
+						const auto indexType = meshbuffer->getIndexType();
+						if (indexType!=EIT_UNKNOWN && meshbuffer->getIndexBufferBinding().buffer)
+						{
+							const auto& binding = meshbuffer->getIndexBufferBinding();
+							const size_t size = meshbuffer->getIndexCount()*(indexType==EIT_16BIT ? sizeof(uint16_t):sizeof(uint32_t));
+							if (binding.offset+size>binding.buffer->getSize())
+							{
+								logger.log("GLTF WRITER: Index buffer out of bounds, skipping meshbuffer", system::ILogger::ELL_ERROR);
+								return false;
+							}
+							const uint32_t view = addView(reinterpret_cast<const uint8_t*>(meshbuffer->getIndices()),size,0u,ET_ELEMENT_ARRAY_BUFFER);
+							primitive.indices = addAccessor(view,0u,{indexType==EIT_16BIT ? ECT_UNSIGNED_SHORT:ECT_UNSIGNED_INT,false,1u},meshbuffer->getIndexCount());
+						}
+
+						struct SAttribute
+						{
+							std::string name;
+							E_SEMANTIC semantic;
+							E_FORMAT format;
+							SAccessorType type;
+							uint32_t relativeOffset;
+						};
+						const auto& inputParams = pipeline->getVertexInputParams();
+						core::vector<SAttribute> bindingAttributes[ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT];
+						for (uint32_t attrId=0u; attrId<ICPUMeshBuffer::MAX_VERTEX_ATTRIB_COUNT; attrId++)
+						{
+							if (!meshbuffer->isAttributeEnabled(attrId))
+								continue;
+							const uint32_t binding = inputParams.attributes[attrId].binding;
+							if (!meshbuffer->isVertexAttribBufferBindingEnabled(binding) || !meshbuffer->getVertexBufferBindings()[binding].buffer)
+								continue;
+							if (inputParams.bindings[binding].inputRate!=EVIR_PER_VERTEX)
+							{
+								logger.log("GLTF WRITER: Skipping per instance attribute %d", system::ILogger::ELL_WARNING, attrId);
+								continue;
+							}
+
+							SAttribute attribute;
+							if (attrId==meshbuffer->getPositionAttributeIx())
+								attribute = {"POSITION",ES_POSITION};
+							else if (attrId==meshbuffer->getNormalAttributeIx())
+								attribute = {"NORMAL",ES_NORMAL};
+							else if (attrId==params.uvAttributeIx)
+								attribute = {"TEXCOORD_0",ES_TEXCOORD};
+							else if (attrId==params.colorAttributeIx)
+								attribute = {"COLOR_0",ES_COLOR};
+							else // application specific semantics have to start with an underscore
+								attribute = {"_ATTRIBUTE_"+std::to_string(attrId),ES_CUSTOM};
+							attribute.format = static_cast<E_FORMAT>(inputParams.attributes[attrId].format);
+							attribute.type = getAccessorType(attribute.format);
+							attribute.relativeOffset = inputParams.attributes[attrId].relativeOffset;
+							bindingAttributes[binding].push_back(std::move(attribute));
+						}
+
+						for (uint32_t b=0u; b<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; b++)
+						{
+							const auto& attributes = bindingAttributes[b];
+							if (attributes.empty())
+								continue;
+
+							const auto& binding = meshbuffer->getVertexBufferBindings()[b];
+							const uint32_t stride = inputParams.bindings[b].stride;
+							// a binding glTF can address as it is becomes one interleaved buffer view
+							bool verbatim = stride%Alignment==0u && stride>=Alignment && stride<=MaxByteStride;
+							uint32_t vertexEnd = 0u;
+							for (const auto& attribute : attributes)
+							{
+								const uint32_t end = attribute.relativeOffset+getTexelOrBlockBytesize(attribute.format);
+								vertexEnd = core::max(vertexEnd,end);
+								verbatim = verbatim && isAllowed(attribute.semantic,attribute.type) && attribute.relativeOffset%Alignment==0u && end<=stride;
+							}
+							const int64_t begin = static_cast<int64_t>(binding.offset)+static_cast<int64_t>(meshbuffer->getBaseVertex())*stride;
+							const size_t size = static_cast<size_t>(stride)*(vertexCount-1u)+vertexEnd;
+							if (begin<0ll || begin+size>binding.buffer->getSize())
+							{
+								logger.log("GLTF WRITER: Vertex buffer binding %d out of bounds, skipping meshbuffer", system::ILogger::ELL_ERROR, b);
+								return false;
+							}
+							const uint8_t* data = reinterpret_cast<const uint8_t*>(binding.buffer->getPointer())+begin;
+
+							if (verbatim)
+							{
+								const uint32_t view = addView(data,size,stride,ET_ARRAY_BUFFER);
+								for (const auto& attribute : attributes)
+								{
+									const uint32_t accessor = addAccessor(view,attribute.relativeOffset,attribute.type,vertexCount);
+									if (attribute.semantic==ES_POSITION)
+										computeBounds(m_accessors[accessor],data+attribute.relativeOffset,stride);
+									primitive.attributes.emplace_back(attribute.name,accessor);
+								}
+								continue;
+							}
+
+							// anything else gets repacked, every attribute on its own
+							for (const auto& attribute : attributes)
+							{
+								const uint8_t* src = data+attribute.relativeOffset;
+								const bool copy = isAllowed(attribute.semantic,attribute.type);
+								core::vectorSIMDf decoded;
+								if (!copy && !ICPUMeshBuffer::getAttribute(decoded,src,attribute.format))
+								{
+									logger.log("GLTF WRITER: Format %d of %s can't be converted, skipping attribute", system::ILogger::ELL_WARNING, attribute.format, attribute.name.c_str());
+									continue;
+								}
+								const SAccessorType type = copy ? attribute.type:SAccessorType{ECT_FLOAT,false,getConvertedComponents(attribute.semantic,attribute.format)};
+								const uint32_t elementSize = copy ? getTexelOrBlockBytesize(attribute.format):type.components*sizeof(float);
+								const uint32_t repackedStride = core::roundUp(elementSize,Alignment);
+
+								// zero initialized, so the padding hashes the same every time
+								auto& repacked = m_repacked.emplace_back(std::make_unique<uint8_t[]>(static_cast<size_t>(repackedStride)*vertexCount));
+								uint8_t* dst = repacked.get();
+								for (uint32_t i=0u; i<vertexCount; i++,src+=stride,dst+=repackedStride)
+								{
+									if (copy)
+									{
+										memcpy(dst,src,elementSize);
+										continue;
+									}
+									decoded = core::vectorSIMDf(0.f,0.f,0.f,1.f);
+									ICPUMeshBuffer::getAttribute(decoded,src,attribute.format);
+									memcpy(dst,decoded.pointer,elementSize);
+								}
+
+								const uint32_t view = addView(repacked.get(),static_cast<size_t>(repackedStride)*vertexCount,repackedStride,ET_ARRAY_BUFFER);
+								const uint32_t accessor = addAccessor(view,0u,type,vertexCount);
+								if (attribute.semantic==ES_POSITION)
+									computeBounds(m_accessors[accessor],repacked.get(),repackedStride);
+								primitive.attributes.emplace_back(attribute.name,accessor);
+							}
+						}
+
+						m_primitives.push_back(std::move(primitive));
+						return true;
+					}
+
+					//! Merges the buffer views with the same contents and then the accessors which became the same, lays out the binary data
+					void deduplicate()
+					{
+						core::for_each(core::execution::par_unseq,m_views.begin(),m_views.end(),[](SBufferView& view) -> void
+						{
+							core::XXHash_256(view.data,view.size,view.hash);
+						});
+						core::vector<uint32_t> viewRemap(m_views.size());
+						{
+							core::vector<SBufferView> unique;
+							core::unordered_multimap<uint64_t,uint32_t> byHash;
+							for (uint32_t i=0u; i<m_views.size(); i++)
+							{
+								const auto& view = m_views[i];
+								uint32_t found = ~0u;
+								for (auto [it,end]=byHash.equal_range(view.hash[0]); it!=end; it++)
+								{
+									const auto& other = unique[it->second];
+									// a hash match alone would silently corrupt the mesh on a collision, so the bytes have the final say
+									if (other.size==view.size && other.byteStride==view.byteStride && other.target==view.target && memcmp(other.hash,view.hash,sizeof(view.hash))==0 && memcmp(other.data,view.data,view.size)==0)
+									{
+										found = it->second;
+										break;
+									}
+								}
+								if (found==~0u)
+								{
+									found = unique.size();
+									byHash.emplace(view.hash[0],found);
+									unique.push_back(view);
+								}
+								viewRemap[i] = found;
+							}
+							m_views = std::move(unique);
+						}
+						m_binSize = 0ull;
+						for (auto& view : m_views)
+						{
+							view.byteOffset = m_binSize;
+							m_binSize = core::roundUp<size_t>(m_binSize+view.size,Alignment);
+						}
+
+						core::vector<uint32_t> accessorRemap(m_accessors.size());
+						{
+							core::vector<SAccessor> unique;
+							core::map<std::tuple<uint32_t,uint32_t,SAccessorType,uint32_t>,uint32_t> byContents;
+							for (uint32_t i=0u; i<m_accessors.size(); i++)
+							{
+								auto accessor = m_accessors[i];
+								accessor.bufferView = viewRemap[accessor.bufferView];
+								const auto [found,inserted] = byContents.try_emplace({accessor.bufferView,accessor.byteOffset,accessor.type,accessor.count},unique.size());
+								if (inserted)
+									unique.push_back(accessor);
+								accessorRemap[i] = found->second;
+							}
+							m_accessors = std::move(unique);
+						}
+						for (auto& primitive : m_primitives)
+						{
+							if (primitive.indices!=~0u)
+								primitive.indices = accessorRemap[primitive.indices];
+							for (auto& attribute : primitive.attributes)
+								attribute.second = accessorRemap[attribute.second];
+						}
+					}
+
+					//! `uri` of the external binary data, nullptr for GLB
+					void writeJSON(system::CBufferedFileWriter& out, const std::string* uri) const
+					{
+						CJSONWriter json(out);
+						json.beginObject();
+						{
+							json.key("asset");
+							json.beginObject();
+							json.member("version","2.0");
+							json.member("generator","Nabla");
+							json.endObject();
+						}
+						json.member("scene",0u);
+						{
+							json.key("scenes");
+							json.beginArray();
+							json.beginObject();
+							json.key("nodes");
+							json.beginArray();
+							json.value(0u);
+							json.endArray();
+							json.endObject();
+							json.endArray();
+						}
+						{
+							json.key("nodes");
+							json.beginArray();
+							json.beginObject();
+							json.member("mesh",0u);
+							json.endObject();
+							json.endArray();
+						}
+						{
+							json.key("meshes");
+							json.beginArray();
+							json.beginObject();
+							json.key("primitives");
+							json.beginArray();
+							for (const auto& primitive : m_primitives)
+							{
+								json.beginObject();
+								json.key("attributes");
+								json.beginObject();
+								for (const auto& [name,accessor] : primitive.attributes)
+									json.member(name,accessor);
+								json.endObject();
+								if (primitive.indices!=~0u)
+									json.member("indices",primitive.indices);
+								json.member("mode",primitive.mode);
+								json.endObject();
+							}
+							json.endArray();
+							json.endObject();
+							json.endArray();
+						}
+						{
+							json.key("accessors");
+							json.beginArray();
+							for (const auto& accessor : m_accessors)
+							{
+								json.beginObject();
+								json.member("bufferView",accessor.bufferView);
+								if (accessor.byteOffset)
+									json.member("byteOffset",accessor.byteOffset);
+								json.member("componentType",static_cast<uint32_t>(accessor.type.componentType));
+								if (accessor.type.normalized)
+									json.member("normalized",true);
+								json.member("count",accessor.count);
+								json.member("type",getTypeName(accessor.type.components));
+								if (accessor.hasBounds)
+								{
+									json.key("min");
+									json.beginArray();
+									for (const auto bound : accessor.min)
+										json.value(bound);
+									json.endArray();
+									json.key("max");
+									json.beginArray();
+									for (const auto bound : accessor.max)
+										json.value(bound);
+									json.endArray();
+								}
+								json.endObject();
+							}
+							json.endArray();
+						}
+						{
+							json.key("bufferViews");
+							json.beginArray();
+							for (const auto& view : m_views)
+							{
+								json.beginObject();
+								json.member("buffer",0u);
+								if (view.byteOffset)
+									json.member("byteOffset",view.byteOffset);
+								json.member("byteLength",view.size);
+								if (view.byteStride)
+									json.member("byteStride",view.byteStride);
+								json.member("target",static_cast<uint32_t>(view.target));
+								json.endObject();
+							}
+							json.endArray();
+						}
+						{
+							json.key("buffers");
+							json.beginArray();
+							json.beginObject();
+							json.member("byteLength",m_binSize);
+							if (uri)
+								json.member("uri",*uri);
+							json.endObject();
+							json.endArray();
+						}
+						json.endObject();
+					}
+					//! The views go out straight from the `ICPUBuffer`s, `CBufferedFileWriter` only combines the small ones
+					void writeBIN(system::CBufferedFileWriter& out) const
+					{
+						constexpr uint8_t Padding[Alignment] = {};
+						const size_t base = out.getOffset();
+						for (const auto& view : m_views)
+						{
+							out.write(Padding,base+view.byteOffset-out.getOffset());
+							out.write(view.data,view.size);
+						}
+						out.write(Padding,base+m_binSize-out.getOffset());
+					}
+
+					inline bool empty() const { return m_primitives.empty(); }
+					inline size_t getBinSize() const { return m_binSize; }
+
+				private:
+					struct SBufferView
+					{
+						const uint8_t* data;
+						size_t size;
+						//! 0 for indices
+						uint32_t byteStride;
+						E_TARGET target;
+						uint64_t hash[4];
+						size_t byteOffset;
+					};
+					struct SAccessor
+					{
+						uint32_t bufferView;
+						uint32_t byteOffset;
+						SAccessorType type;
+						uint32_t count;
+						//! only POSITION needs them
+						bool hasBounds = false;
+						float min[3];
+						float max[3];
+					};
+					struct SPrimitive
+					{
+						uint32_t mode;
+						uint32_t indices = ~0u;
+						core::vector<std::pair<std::string,uint32_t>> attributes;
+					};
+
+					uint32_t addView(const uint8_t* data, const size_t size, const uint32_t byteStride, const E_TARGET target)
+					{
+						// meshbuffers sharing a binding don't even need their contents hashed
+						const auto [found,inserted] = m_viewsByRange.try_emplace({data,size,byteStride,target},m_views.size());
+						if (inserted)
+							m_views.push_back({data,size,byteStride,target});
+						return found->second;
+					}
+					uint32_t addAccessor(const uint32_t bufferView, const uint32_t byteOffset, const SAccessorType& type, const uint32_t count)
+					{
+						m_accessors.push_back({bufferView,byteOffset,type,count});
+						return m_accessors.size()-1u;
+					}
+					//! POSITION is always 3 floats by now
+					static void computeBounds(SAccessor& accessor, const uint8_t* data, const uint32_t stride)
+					{
+						std::fill_n(accessor.min,3u,FLT_MAX);
+						std::fill_n(accessor.max,3u,-FLT_MAX);
+						for (uint32_t i=0u; i<accessor.count; i++,data+=stride)
+						{
+							float position[3];
+							memcpy(position,data,sizeof(position));
+							for (uint32_t c=0u; c<3u; c++)
+							if (std::isfinite(position[c]))
+							{
+								accessor.min[c] = core::min(accessor.min[c],position[c]);
+								accessor.max[c] = core::max(accessor.max[c],position[c]);
+							}
+						}
+						// not a single finite value, but JSON has no infinities
+						for (uint32_t c=0u; c<3u; c++)
+						if (accessor.min[c]>accessor.max[c])
+							accessor.min[c] = accessor.max[c] = 0.f;
+						accessor.hasBounds = true;
+					}
+
+					core::vector<SBufferView> m_views;
+					core::map<std::tuple<const uint8_t*,size_t,uint32_t,E_TARGET>,uint32_t> m_viewsByRange;
+					core::vector<SAccessor> m_accessors;
+					core::vector<SPrimitive> m_primitives;
+					//! attributes glTF can't take as they are
+					core::vector<std::unique_ptr<uint8_t[]>> m_repacked;
+					size_t m_binSize = 0ull;
+			};
+		}
+
 		bool CGLTFWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
 		{
-			// TODO: implementation
-			return false;
+			if (!_override)
+				getDefaultOverride(_override);
+
+			SAssetWriteContext ctx{_params,_file};
+			const auto* mesh = IAsset::castDown<const ICPUMesh>(_params.rootAsset);
+			if (!mesh)
+				return false;
+
+			system::IFile* file = _override->getOutputFile(_file,ctx,{mesh,0u});
+			if (!file)
+				return false;
+
+			const auto& logger = _params.logger;
+			const SParams defaultParams;
+			const auto& params = _params.userData ? *reinterpret_cast<const SParams*>(_params.userData):defaultParams;
+
+			CDocument document;
+			for (const auto* meshbuffer : mesh->getMeshBuffers())
+				document.addMeshBuffer(meshbuffer,params,logger);
+			if (document.empty())
+			{
+				logger.log("GLTF WRITER: No meshbuffer of %s could be written", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+				return false;
+			}
+			document.deduplicate();
+
+			const auto extension = file->getFileName().extension().string();
+			const bool binary = (_override->getAssetWritingFlags(ctx,mesh,0u)&EWF_BINARY) || core::strcmpi(extension.c_str(),".glb")==0;
+			if (binary)
+			{
+				system::CBufferedFileWriter out(file);
+				// the header and the JSON chunk's get filled in once the lengths are known
+				constexpr uint8_t Placeholder[GLBHeaderSize+GLBChunkHeaderSize] = {};
+				out.write(Placeholder,sizeof(Placeholder));
+				document.writeJSON(out,nullptr);
+				while (out.getOffset()%Alignment)
+					out.writeText(' ');
+				const size_t jsonLength = out.getOffset()-sizeof(Placeholder);
+
+				out.writeValue(static_cast<uint32_t>(document.getBinSize()));
+				out.writeValue(GLBChunkBIN);
+				document.writeBIN(out);
+				const size_t totalLength = out.getOffset();
+				if (totalLength>std::numeric_limits<uint32_t>::max())
+				{
+					logger.log("GLTF WRITER: %s would be over 4 GiB, which GLB can't address", system::ILogger::ELL_ERROR, file->getFileName().string().c_str());
+					return false;
+				}
+
+				out.seek(0ull);
+				out.writeValue(GLBMagic);
+				out.writeValue(GLBVersion);
+				out.writeValue(static_cast<uint32_t>(totalLength));
+				out.writeValue(static_cast<uint32_t>(jsonLength));
+				out.writeValue(GLBChunkJSON);
+				return out.flush();
+			}
+
+			std::string binPath = system::path(file->getFileName()).replace_extension(".bin").string();
+			std::string uri = system::path(binPath).filename().string();
+			_override->getExtraFilePaths(binPath,uri,ctx,{mesh,0u});
+
+			system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+			m_system->createFile(future,binPath,system::IFile::ECF_WRITE);
+			const auto binFile = future.get();
+			if (!binFile)
+			{
+				logger.log("GLTF WRITER: Could not create %s", system::ILogger::ELL_ERROR, binPath.c_str());
+				return false;
+			}
+			bool success;
+			{
+				system::CBufferedFileWriter out(binFile.get());
+				document.writeBIN(out);
+				success = out.flush();
+			}
+			system::CBufferedFileWriter out(file);
+			document.writeJSON(out,&uri);
+			return out.flush() && success;
 		}
 	}
 }
@@ -44,6 +44,22 @@ private:
             return ext;
         }
 
+        virtual const SFileSignature* getFileSignatures() const override
+        {
+            // every JPEG starts with the SOI marker followed by the first marker's 0xFF, the rest are what isALoadableFileFormat
+            // used to accept at offset 6 (the identifier of a leading APP0/APP1 segment) for files with a mangled SOI
+            static const SFileSignature signatures[]{
+                {"\xFF\xD8\xFF",0u,3u},
+                {"\xFF\xD8\xFF",6u,3u},
+                {"JFIF",6u,4u},
+                {"FIFJ",6u,4u},
+                {"Exif",6u,4u},
+                {"http",6u,4u},
+                {}
+            };
+            return signatures;
+        }
+
         virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE; }
 
         virtual asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -33,6 +33,12 @@ class CImageLoaderOpenEXR final : public IImageLoader
 			return extensions;
 		}
 
+		const SFileSignature* getFileSignatures() const override
+		{
+			static const SFileSignature signatures[]{ {"\x76\x2F\x31\x01",0u,4u}, {} };
+			return signatures;
+		}
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
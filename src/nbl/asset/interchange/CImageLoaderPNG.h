@@ -41,6 +41,12 @@ public:
         return ext;
     }
 
+    virtual const SFileSignature* getFileSignatures() const override
+    {
+        static const SFileSignature signatures[]{ {"\x89PNG\r\n\x1a\n",0u,8u}, {} };
+        return signatures;
+    }
+
     virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE; }
 
     virtual asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -7,6 +7,7 @@
 
 #include "nbl/system/IFile.h"
 #include "nbl/system/ISystem.h"
+#include "nbl/system/CBufferedFileWriter.h"
 
 #include "nbl/asset/compile_config.h"
 #include "nbl/asset/format/convertColor.h"
@@ -25,8 +26,8 @@ extern "C"
 	#include "jerror.h"
 }
 
-// The writer uses a 4k buffer and flushes to disk each time it's filled
-#define OUTPUT_BUF_SIZE 4096
+// libjpeg compresses straight into the write-combining buffer, this much at a time
+#define OUTPUT_BUF_SIZE 65536
 
 using namespace nbl;
 using namespace asset;	
@@ -35,9 +36,7 @@ struct mem_destination_mgr
 {
 	struct jpeg_destination_mgr pub;/* public fields */
 	system::ISystem* system;
-	system::IFile* file;		/* target file */
-	size_t filePos = 0;
-	JOCTET buffer[OUTPUT_BUF_SIZE];	/* image buffer */
+	system::CBufferedFileWriter* writer;	/* target file */
 };
 using mem_dest_ptr = mem_destination_mgr*;
 
@@ -45,27 +44,19 @@ using mem_dest_ptr = mem_destination_mgr*;
 static void jpeg_init_destination(j_compress_ptr cinfo)
 {
 	mem_dest_ptr dest = (mem_dest_ptr) cinfo->dest;
-	dest->pub.next_output_byte = dest->buffer;
+	dest->pub.next_output_byte = reinterpret_cast<JOCTET*>(dest->writer->reserve(OUTPUT_BUF_SIZE));
 	dest->pub.free_in_buffer = OUTPUT_BUF_SIZE;
 }
 
 
-// flush to disk and reset buffer
+// hand the filled space over to the writer and get more, file errors are reported by the final flush
 static boolean jpeg_empty_output_buffer(j_compress_ptr cinfo)
 {
 	mem_dest_ptr dest = (mem_dest_ptr) cinfo->dest;
 
-	// for now just exit upon file error
-	system::IFile::success_t success;
-	dest->file->write(success, dest->buffer, dest->filePos, OUTPUT_BUF_SIZE);
-	if (!success)
-	{
-		ERREXIT (cinfo, JERR_FILE_WRITE);
-	}
-
-	dest->pub.next_output_byte = dest->buffer;
+	dest->writer->commit(OUTPUT_BUF_SIZE);
+	dest->pub.next_output_byte = reinterpret_cast<JOCTET*>(dest->writer->reserve(OUTPUT_BUF_SIZE));
 	dest->pub.free_in_buffer = OUTPUT_BUF_SIZE;
-	dest->filePos += OUTPUT_BUF_SIZE;
 	return TRUE;
 }
 
@@ -73,21 +64,12 @@ static boolean jpeg_empty_output_buffer(j_compress_ptr cinfo)
 static void jpeg_term_destination(j_compress_ptr cinfo)
 {
 	mem_dest_ptr dest = (mem_dest_ptr) cinfo->dest;
-	const int32_t datacount = (int32_t)(OUTPUT_BUF_SIZE - dest->pub.free_in_buffer);
-	// for now just exit upon file error
-	system::IFile::success_t success;
-	dest->file->write(success, dest->buffer, dest->filePos, datacount);
-	if (!success)
-	{
-		ERREXIT (cinfo, JERR_FILE_WRITE);
-	}
-
-	dest->filePos += datacount;
+	dest->writer->commit(OUTPUT_BUF_SIZE - dest->pub.free_in_buffer);
 }
 
 
 // set up buffer data
-static void jpeg_file_dest(j_compress_ptr cinfo, system::IFile* file, system::ISystem* sys)
+static void jpeg_file_dest(j_compress_ptr cinfo, system::CBufferedFileWriter* writer, system::ISystem* sys)
 {
 	if (cinfo->dest == nullptr)
 	{ /* first time for this JPEG object? */
@@ -105,9 +87,8 @@ static void jpeg_file_dest(j_compress_ptr cinfo, system::IFile* file, system::IS
 	dest->pub.term_destination = jpeg_term_destination;
 
 	/* Initialize private member */
-	dest->file = file;
+	dest->writer = writer;
 	dest->system = sys;
-	dest->filePos = 0;
 }
 
 /* write_JPEG_memory: store JPEG compressed image into memory.
@@ -135,8 +116,9 @@ static bool writeJPEGFile(system::IFile* file, system::ISystem* sys, const asset
 	struct jpeg_error_mgr jerr;
 	cinfo.err = jpeg_std_error(&jerr);
 
+	system::CBufferedFileWriter writer(file);
 	jpeg_create_compress(&cinfo);
-	jpeg_file_dest(&cinfo, file, sys);
+	jpeg_file_dest(&cinfo, &writer, sys);
 	cinfo.image_width = dim.X;
 	cinfo.image_height = dim.Y;
 	cinfo.input_components = grayscale ? 1 : 3;
@@ -180,7 +162,7 @@ static bool writeJPEGFile(system::IFile* file, system::ISystem* sys, const asset
 	/* Step 7: Destroy */
 	jpeg_destroy_compress(&cinfo);
 
-	return (dest != 0);
+	return writer.flush() && (dest != 0);
 }
 #endif // _NBL_COMPILE_WITH_LIBJPEG_
 
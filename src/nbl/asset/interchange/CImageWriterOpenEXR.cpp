@@ -22,6 +22,8 @@ SOFTWARE.
 #include <string>
 #include <unordered_map>
 
+#include "nbl/system/CBufferedFileWriter.h"
+
 #include "nbl/asset/filters/CRegionBlockFunctorFilter.h"
 
 #include "CImageWriterOpenEXR.h"
@@ -52,7 +54,7 @@ namespace nbl::asset::impl
 	{
 		public:
 			nblOStream(system::IFile* _nblFile)
-				: IMF::OStream(getFileName(_nblFile).c_str()), nblFile(_nblFile) {}
+				: IMF::OStream(getFileName(_nblFile).c_str()), writer(_nblFile) {}
 			virtual ~nblOStream() {}
 
 			//----------------------------------------------------------
@@ -65,10 +67,7 @@ namespace nbl::asset::impl
 
 			virtual void write(const char c[/*n*/], int n) override
 			{
-				system::ISystem::future_t<size_t> future;
-				nblFile->write(future, c, fileOffset, n);
-				const auto bytesWritten = future.get();
-				fileOffset += bytesWritten;
+				writer.write(c, n);
 			}
 
 			//---------------------------------------------------------
@@ -80,7 +79,7 @@ namespace nbl::asset::impl
 
 			virtual IMF::Int64 tellp() override
 			{
-				return static_cast<IMF::Int64>(fileOffset);
+				return static_cast<IMF::Int64>(writer.getOffset());
 			}
 
 			//-------------------------------------------
@@ -90,12 +89,13 @@ namespace nbl::asset::impl
 
 			virtual void seekp(IMF::Int64 pos) override
 			{
-				fileOffset = static_cast<decltype(fileOffset)>(pos);
+				writer.seek(static_cast<size_t>(pos));
 			}
 
-			void resetFileOffset()
+			//! IlmImf reports nothing about the writes themselves, they are only known to have succeeded after this
+			bool flush()
 			{
-				fileOffset = 0u;
+				return writer.flush();
 			}
 
 		private:
@@ -106,8 +106,7 @@ namespace nbl::asset::impl
 				return filename.string() + extension.string();
 			}
 
-			system::IFile* nblFile;
-			size_t fileOffset = {};
+			system::CBufferedFileWriter writer;
 	};
 }
 
@@ -183,18 +182,19 @@ bool createAndWriteImage(std::array<ilmType*, availableChannels>& pixelsArrayIlm
 		);
 	}
 
-	IMF::OStream* nblOStream = _NBL_NEW(asset::impl::nblOStream, _file);
+	auto* nblOStream = _NBL_NEW(asset::impl::nblOStream, _file);
 	{ // brackets are needed because of OutputFile's destructor
 		OutputFile file(*nblOStream, header);
 		file.setFrameBuffer(frameBuffer);
 		file.writePixels(height);
 	}
+	const bool success = nblOStream->flush();
 
 	for (auto channelPixelsPtr : pixelsArrayIlm)
 		_NBL_DELETE_ARRAY(channelPixelsPtr, width * height);
 	_NBL_DELETE(nblOStream);
 
-	return true;
+	return success;
 }
 
 bool CImageWriterOpenEXR::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
@@ -11,23 +11,23 @@
 #ifdef _NBL_COMPILE_WITH_PNG_WRITER_
 
 #include "nbl/asset/interchange/IAssetWriter.h"
+#include "nbl/asset/interchange/CPNGEncoder.h"
 
 namespace nbl
 {
 namespace asset
 {
 
+//! Writes PNGs with a `CPNGEncoder`, so the stripes of an image get deflated in parallel
+/**
+	`SAssetWriteParams::userData` can point to a `CPNGEncoder::SParams` for the filter, zlib strategy and stripe size.
+	With `EWF_COMPRESSED` the asset compression level picks the zlib level, 0 being the fastest (1) and 1 the smallest (9),
+	otherwise the level of the `CPNGEncoder::SParams` is used. For many images use `CPNGEncoder::writeBatch` directly.
+*/
 class CImageWriterPNG : public asset::IAssetWriter
 {
     core::smart_refctd_ptr<system::ISystem> m_system;
 public:
-    struct SContext
-    {
-        SContext(system::ISystem* sys, const system::logger_opt_ptr log) : system(sys), logger(log) {}
-        system::ISystem* system;
-        size_t file_pos = 0;
-        system::logger_opt_ptr logger;
-    };
     //! constructor
     explicit CImageWriterPNG(core::smart_refctd_ptr<system::ISystem>&& sys);
     
@@ -39,7 +39,7 @@ public:
     
     virtual uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_IMAGE_VIEW; }
     
-    virtual uint32_t getSupportedFlags() override { return 0u; }
+    virtual uint32_t getSupportedFlags() override { return asset::EWF_COMPRESSED; }
     
     virtual uint32_t getForcedFlags() { return asset::EWF_BINARY; }
     
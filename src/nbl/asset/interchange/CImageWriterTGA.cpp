@@ -5,6 +5,7 @@
 
 
 #include "nbl/system/IFile.h"
+#include "nbl/system/CBufferedFileWriter.h"
 
 
 #include "nbl/asset/format/convertColor.h"
@@ -113,12 +114,8 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 		}
 	}
 
-	{
-		system::IFile::success_t success;
-		file->write(success, &imageHeader, 0, sizeof(imageHeader));
-		if (!success)
-			return false;
-	}
+	system::CBufferedFileWriter writer(file);
+	writer.writeValue(imageHeader);
 
 	uint8_t* scan_lines = (uint8_t*)convertedImage->getBuffer()->getPointer();
 	if (!scan_lines)
@@ -133,46 +130,24 @@ bool CImageWriterTGA::writeAsset(system::IFile* _file, const SAssetWriteParams&
 	// length of one output row in bytes
 	int32_t row_size = ((imageHeader.PixelDepth / 8) * imageHeader.ImageWidth);
 
-	// allocate a row do translate data into
-	auto rowPointerBuffer = core::make_smart_refctd_ptr<ICPUBuffer>(row_size);
-	auto row_pointer = reinterpret_cast<uint8_t*>(rowPointerBuffer->getPointer());
-
-	uint32_t y;
-	size_t offset = sizeof(imageHeader);
-	for (y = 0; y < imageHeader.ImageHeight; ++y)
-	{
-		memcpy(row_pointer, &scan_lines[y * row_stride], row_size);
-		
-		system::IFile::success_t success;
-		file->write(success, row_pointer, offset, row_size);
-		if (!success)
-			break;
-		offset += row_size;
-	}
+	for (uint32_t y = 0; y < imageHeader.ImageHeight; ++y)
+		writer.write(&scan_lines[y * row_stride], row_size);
 	
 	STGAExtensionArea extension;
 	extension.ExtensionSize = sizeof(extension);
 	extension.Gamma = isSRGBFormat(convertedFormat) ? ((100.0f / 30.0f) - 1.1f) : 1.0f;
 
-	{
-		system::IFile::success_t success;
-		file->write(success, &extension, offset, sizeof(extension));
-		if (!success)
-			return false;
-	}
-	offset += sizeof extension;
+	const size_t extensionOffset = writer.getOffset();
+	writer.writeValue(extension);
 
 	STGAFooter imageFooter;
-	imageFooter.ExtensionOffset = offset;
+	imageFooter.ExtensionOffset = extensionOffset;
 	imageFooter.DeveloperOffset = 0;
 	strncpy(imageFooter.Signature, "TRUEVISION-XFILE.", 18);
 
-	system::IFile::success_t success;
-	file->write(success, &extension, offset, sizeof(extension));
-	if (!success)
-		return false;
+	writer.writeValue(imageFooter);
 
-	return imageHeader.ImageHeight <= y;
+	return writer.flush();
 }
 
 } // namespace nbl::asset
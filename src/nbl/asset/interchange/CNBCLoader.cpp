@@ -0,0 +1,470 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/system/IFile.h"
+
+#include "CNBCLoader.h"
+
+#ifdef _NBL_COMPILE_WITH_NBC_LOADER_
+
+#include "lz4/lib/lz4.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace
+{
+
+//! Doesn't allocate anything, only keeps the mapped file alive for as long as the buffer using its memory
+class CFileMappingAllocator
+{
+	public:
+		using value_type = uint8_t;
+		using pointer = uint8_t*;
+
+		CFileMappingAllocator(core::smart_refctd_ptr<system::IFile>&& _file) : m_file(std::move(_file)) {}
+
+		inline void deallocate(pointer, size_t) { m_file = nullptr; }
+
+	private:
+		core::smart_refctd_ptr<system::IFile> m_file;
+};
+
+inline bool readFile(system::IFile* file, void* out, size_t offset, size_t size)
+{
+	if (!size)
+		return true;
+	system::IFile::success_t success;
+	file->read(success, out, offset, size);
+	return bool(success);
+}
+
+inline bool readHeader(system::IFile* file, nbc::SHeader& header)
+{
+	if (file->getSize()<sizeof(nbc::SHeader) || !readFile(file,&header,0ull,sizeof(nbc::SHeader)))
+		return false;
+	return memcmp(header.magic,nbc::Magic,sizeof(nbc::Magic))==0 && header.version==nbc::Version;
+}
+
+//! children are always written before their parents, so they must already be loaded
+template<class AssetType>
+inline core::smart_refctd_ptr<AssetType> getChild(const core::vector<core::smart_refctd_ptr<IAsset>>& assets, uint32_t index, bool& failed)
+{
+	if (index==nbc::InvalidIndex)
+		return nullptr;
+	if (index>=assets.size() || !assets[index] || assets[index]->getAssetType()!=AssetType::AssetType)
+	{
+		failed = true;
+		return nullptr;
+	}
+	return core::smart_refctd_ptr_static_cast<AssetType>(assets[index]);
+}
+
+inline core::aabbox3df readBoundingBox(nbc::CRecordReader& record)
+{
+	float extremes[6] = {};
+	record.read(extremes,sizeof(extremes));
+	return core::aabbox3df(extremes[0],extremes[1],extremes[2],extremes[3],extremes[4],extremes[5]);
+}
+
+}
+
+bool CNBCLoader::isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger) const
+{
+	nbc::SHeader header;
+	return _file && readHeader(_file,header);
+}
+
+SAssetBundle CNBCLoader::loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override, uint32_t _hierarchyLevel)
+{
+	const auto& logger = _params.logger;
+
+	nbc::SHeader header;
+	if (!_file || !readHeader(_file,header))
+	{
+		logger.log("LOAD NBC: not a valid NBC file", system::ILogger::ELL_ERROR);
+		return {};
+	}
+
+	SContext ctx = { _params, core::smart_refctd_ptr<system::IFile>(_file), reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(_file)->getMappedPointer()) };
+	if (!ctx.mapping && m_system)
+	{
+		system::ISystem::future_t<core::smart_refctd_ptr<system::IFile>> future;
+		m_system->createFile(future, _file->getFileName(), core::bitflag<system::IFile::E_CREATE_FLAGS>(system::IFile::ECF_READ)|system::IFile::ECF_MAPPABLE);
+		if (auto mappable = future.get(); mappable && mappable->getSize()==_file->getSize())
+		{
+			ctx.mapping = reinterpret_cast<const uint8_t*>(static_cast<const system::IFile*>(mappable.get())->getMappedPointer());
+			if (ctx.mapping)
+				ctx.file = std::move(mappable);
+		}
+	}
+	if (!ctx.mapping)
+		logger.log("LOAD NBC: could not map %s, falling back to reading every blob", system::ILogger::ELL_PERFORMANCE, _file->getFileName().string().c_str());
+
+	const size_t fileSize = ctx.file->getSize();
+	// written so that nothing can wrap around, whatever garbage the header holds
+	auto tableFits = [fileSize](const uint64_t offset, const uint64_t count, const size_t entrySize) -> bool
+	{
+		return offset<=fileSize && count<=(fileSize-offset)/entrySize;
+	};
+	if (!tableFits(header.blobTableOffset,header.blobCount,sizeof(nbc::SBlob)) || !tableFits(header.objectTableOffset,header.objectCount,sizeof(nbc::SObject)) || header.rootObject>=header.objectCount)
+	{
+		logger.log("LOAD NBC: %s is truncated or corrupt", system::ILogger::ELL_ERROR, _file->getFileName().string().c_str());
+		return {};
+	}
+	ctx.blobs.resize(header.blobCount);
+	ctx.objects.resize(header.objectCount);
+	if (!readFile(ctx.file.get(),ctx.blobs.data(),header.blobTableOffset,ctx.blobs.size()*sizeof(nbc::SBlob)) ||
+		!readFile(ctx.file.get(),ctx.objects.data(),header.objectTableOffset,ctx.objects.size()*sizeof(nbc::SObject)))
+		return {};
+
+	// objects are stored in dependency order, so a single linear pass resolves every reference
+	ctx.assets.reserve(ctx.objects.size());
+	for (const auto& object : ctx.objects)
+	{
+		auto asset = loadObject(ctx,object);
+		if (!asset)
+		{
+			logger.log("LOAD NBC: failed to load object %u of type %llu from %s", system::ILogger::ELL_ERROR, static_cast<uint32_t>(ctx.assets.size()), static_cast<unsigned long long>(object.type), _file->getFileName().string().c_str());
+			return {};
+		}
+		ctx.assets.push_back(std::move(asset));
+	}
+
+	return SAssetBundle(nullptr, { std::move(ctx.assets[header.rootObject]) });
+}
+
+core::smart_refctd_ptr<ICPUBuffer> CNBCLoader::loadBlob(SContext& ctx, uint32_t blobIx) const
+{
+	if (blobIx>=ctx.blobs.size())
+		return nullptr;
+	const auto& blob = ctx.blobs[blobIx];
+	const size_t fileSize = ctx.file->getSize();
+	if (blob.offset>fileSize || blob.storedSize>fileSize-blob.offset)
+		return nullptr;
+
+	switch (blob.compression)
+	{
+		case nbc::EBC_NONE:
+		{
+			if (blob.storedSize!=blob.size)
+				return nullptr;
+			if (ctx.mapping)
+			{
+				using buffer_t = CCustomAllocatorCPUBuffer<CFileMappingAllocator,true>;
+				// a read-only file's mapping is copy-on-write, so editing the buffer in place only copies the pages it touches
+				return core::make_smart_refctd_ptr<buffer_t>(blob.size, const_cast<uint8_t*>(ctx.mapping+blob.offset), core::adopt_memory, CFileMappingAllocator(core::smart_refctd_ptr(ctx.file)));
+			}
+			auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(blob.size);
+			if (!readFile(ctx.file.get(),buffer->getPointer(),blob.offset,blob.size))
+				return nullptr;
+			return buffer;
+		}
+		case nbc::EBC_LZ4:
+		{
+			if (blob.storedSize>LZ4_MAX_INPUT_SIZE || blob.size>std::numeric_limits<int>::max())
+				return nullptr;
+			const char* src = reinterpret_cast<const char*>(ctx.mapping+blob.offset);
+			core::vector<char> storage;
+			if (!ctx.mapping)
+			{
+				storage.resize(blob.storedSize);
+				if (!readFile(ctx.file.get(),storage.data(),blob.offset,blob.storedSize))
+					return nullptr;
+				src = storage.data();
+			}
+			auto buffer = core::make_smart_refctd_ptr<ICPUBuffer>(blob.size);
+			const int decompressed = LZ4_decompress_safe(src, reinterpret_cast<char*>(buffer->getPointer()), blob.storedSize, blob.size);
+			if (decompressed<0 || static_cast<uint64_t>(decompressed)!=blob.size)
+				return nullptr;
+			return buffer;
+		}
+		default:
+			break;
+	}
+	return nullptr;
+}
+
+core::smart_refctd_ptr<IAsset> CNBCLoader::loadObject(SContext& ctx, const nbc::SObject& object) const
+{
+	const auto recordBuffer = loadBlob(ctx,object.recordBlob);
+	if (!recordBuffer)
+		return nullptr;
+	nbc::CRecordReader record(recordBuffer->getPointer(),recordBuffer->getSize());
+
+	bool failed = false;
+	core::smart_refctd_ptr<IAsset> retval;
+	switch (object.type)
+	{
+		case IAsset::ET_BUFFER:
+		{
+			auto buffer = loadBlob(ctx,record.read<uint32_t>());
+			if (!buffer)
+				return nullptr;
+			buffer->setUsageFlags(static_cast<ICPUBuffer::E_USAGE_FLAGS>(record.read<uint32_t>()));
+			buffer->setCanUpdateSubRange(record.read<uint8_t>());
+			retval = std::move(buffer);
+			break;
+		}
+		case IAsset::ET_SAMPLER:
+		{
+			const auto params = record.read<ICPUSampler::SParams>();
+			if (!record.failed())
+				retval = core::make_smart_refctd_ptr<ICPUSampler>(params);
+			break;
+		}
+		case IAsset::ET_IMAGE:
+		{
+			auto buffer = getChild<ICPUBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+			ICPUImage::SCreationParams params = {};
+			params.flags = record.read<decltype(params.flags)>();
+			params.type = record.read<decltype(params.type)>();
+			params.format = record.read<decltype(params.format)>();
+			params.extent = record.read<decltype(params.extent)>();
+			params.mipLevels = record.read<decltype(params.mipLevels)>();
+			params.arrayLayers = record.read<decltype(params.arrayLayers)>();
+			params.samples = record.read<decltype(params.samples)>();
+			params.tiling = record.read<decltype(params.tiling)>();
+			params.usage = static_cast<IImage::E_USAGE_FLAGS>(record.read<uint32_t>());
+			params.initialLayout = record.read<decltype(params.initialLayout)>();
+			const uint32_t regionCount = record.read<uint32_t>();
+			if (failed || record.failed() || regionCount>record.remaining()/sizeof(IImage::SBufferCopy))
+				return nullptr;
+
+			auto image = ICPUImage::create(std::move(params));
+			if (!image)
+				return nullptr;
+			if (regionCount)
+			{
+				auto regions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(regionCount);
+				if (!record.read(regions->data(),regions->size()*sizeof(IImage::SBufferCopy)) || !image->setBufferAndRegions(std::move(buffer),regions))
+					return nullptr;
+			}
+			retval = std::move(image);
+			break;
+		}
+		case IAsset::ET_IMAGE_VIEW:
+		{
+			ICPUImageView::SCreationParams params = {};
+			params.image = getChild<ICPUImage>(ctx.assets,record.read<uint32_t>(),failed);
+			params.flags = record.read<decltype(params.flags)>();
+			params.viewType = record.read<decltype(params.viewType)>();
+			params.format = record.read<decltype(params.format)>();
+			params.components = record.read<decltype(params.components)>();
+			params.subresourceRange = record.read<decltype(params.subresourceRange)>();
+			if (failed || record.failed())
+				return nullptr;
+			retval = ICPUImageView::create(std::move(params));
+			break;
+		}
+		case IAsset::ET_SHADER:
+		{
+			auto code = getChild<ICPUBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+			const bool containsGLSL = record.read<uint8_t>();
+			const auto stage = record.read<IShader::E_SHADER_STAGE>();
+			std::string filepathHint = record.readString();
+			if (failed || record.failed() || !code)
+				return nullptr;
+			if (containsGLSL)
+				retval = core::make_smart_refctd_ptr<ICPUShader>(std::move(code),IShader::buffer_contains_glsl,stage,std::move(filepathHint));
+			else
+				retval = core::make_smart_refctd_ptr<ICPUShader>(std::move(code),stage,std::move(filepathHint));
+			break;
+		}
+		case IAsset::ET_SPECIALIZED_SHADER:
+		{
+			auto unspecialized = getChild<ICPUShader>(ctx.assets,record.read<uint32_t>(),failed);
+			auto backingBuffer = getChild<ICPUBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+			std::string entryPoint = record.readString();
+			const uint32_t entryCount = record.read<uint32_t>();
+			if (failed || record.failed() || entryCount>record.remaining()/sizeof(ISpecializedShader::SInfo::SMapEntry))
+				return nullptr;
+			core::smart_refctd_dynamic_array<ISpecializedShader::SInfo::SMapEntry> entries;
+			if (entryCount)
+			{
+				entries = core::make_refctd_dynamic_array<decltype(entries)>(entryCount);
+				record.read(entries->data(),entries->size()*sizeof(ISpecializedShader::SInfo::SMapEntry));
+			}
+			if (failed || record.failed() || !unspecialized)
+				return nullptr;
+			retval = core::make_smart_refctd_ptr<ICPUSpecializedShader>(std::move(unspecialized),ISpecializedShader::SInfo(std::move(entries),std::move(backingBuffer),entryPoint));
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET_LAYOUT:
+		{
+			const uint32_t bindingCount = record.read<uint32_t>();
+			// every binding takes up at least its fields and the immutable sampler flag
+			constexpr size_t MinBindingRecordSize = sizeof(ICPUDescriptorSetLayout::SBinding::binding)+sizeof(ICPUDescriptorSetLayout::SBinding::type)+
+				sizeof(ICPUDescriptorSetLayout::SBinding::count)+sizeof(ICPUDescriptorSetLayout::SBinding::stageFlags)+sizeof(uint8_t);
+			if (record.failed() || bindingCount>record.remaining()/MinBindingRecordSize)
+				return nullptr;
+			core::vector<ICPUDescriptorSetLayout::SBinding> bindings(bindingCount);
+			// the layout copies the immutable samplers, this only has to outlive the constructor
+			core::vector<core::vector<core::smart_refctd_ptr<ICPUSampler>>> samplers(bindingCount);
+			for (uint32_t b=0u; b<bindingCount && !record.failed(); b++)
+			{
+				auto& binding = bindings[b];
+				binding.binding = record.read<decltype(binding.binding)>();
+				binding.type = record.read<decltype(binding.type)>();
+				binding.count = record.read<decltype(binding.count)>();
+				binding.stageFlags = record.read<decltype(binding.stageFlags)>();
+				binding.samplers = nullptr;
+				if (record.read<uint8_t>())
+				{
+					if (binding.count>record.remaining()/sizeof(uint32_t))
+						return nullptr;
+					samplers[b].resize(binding.count);
+					for (auto& sampler : samplers[b])
+						sampler = getChild<ICPUSampler>(ctx.assets,record.read<uint32_t>(),failed);
+					binding.samplers = samplers[b].data();
+				}
+			}
+			if (failed || record.failed())
+				return nullptr;
+			retval = core::make_smart_refctd_ptr<ICPUDescriptorSetLayout>(bindings.data(),bindings.data()+bindings.size());
+			break;
+		}
+		case IAsset::ET_PIPELINE_LAYOUT:
+		{
+			core::smart_refctd_ptr<ICPUDescriptorSetLayout> dsLayouts[ICPUPipelineLayout::DESCRIPTOR_SET_COUNT];
+			for (auto& dsLayout : dsLayouts)
+				dsLayout = getChild<ICPUDescriptorSetLayout>(ctx.assets,record.read<uint32_t>(),failed);
+			const uint32_t rangeCount = record.read<uint32_t>();
+			if (failed || record.failed() || rangeCount>recordBuffer->getSize())
+				return nullptr;
+			core::vector<SPushConstantRange> ranges(rangeCount);
+			if (!record.read(ranges.data(),ranges.size()*sizeof(SPushConstantRange)))
+				return nullptr;
+			retval = core::make_smart_refctd_ptr<ICPUPipelineLayout>(
+				ranges.data(),ranges.data()+ranges.size(),
+				std::move(dsLayouts[0]),std::move(dsLayouts[1]),std::move(dsLayouts[2]),std::move(dsLayouts[3])
+			);
+			break;
+		}
+		case IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE:
+		{
+			auto layout = getChild<ICPUPipelineLayout>(ctx.assets,record.read<uint32_t>(),failed);
+			core::smart_refctd_ptr<ICPUSpecializedShader> shaders[ICPURenderpassIndependentPipeline::SHADER_STAGE_COUNT];
+			ICPUSpecializedShader* shadersRaw[ICPURenderpassIndependentPipeline::SHADER_STAGE_COUNT];
+			uint32_t shaderCount = 0u;
+			for (auto& shader : shaders)
+			{
+				shader = getChild<ICPUSpecializedShader>(ctx.assets,record.read<uint32_t>(),failed);
+				if (shader)
+					shadersRaw[shaderCount++] = shader.get();
+			}
+			const auto vertexInput = record.read<SVertexInputParams>();
+			const auto blend = record.read<SBlendParams>();
+			const auto primitiveAssembly = record.read<SPrimitiveAssemblyParams>();
+			const auto rasterization = record.read<SRasterizationParams>();
+			if (failed || record.failed())
+				return nullptr;
+			retval = core::make_smart_refctd_ptr<ICPURenderpassIndependentPipeline>(std::move(layout),shadersRaw,shadersRaw+shaderCount,vertexInput,blend,primitiveAssembly,rasterization);
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET:
+		{
+			auto layout = getChild<ICPUDescriptorSetLayout>(ctx.assets,record.read<uint32_t>(),failed);
+			const uint32_t bindingCount = record.read<uint32_t>();
+			if (failed || record.failed() || !layout)
+				return nullptr;
+
+			auto ds = core::make_smart_refctd_ptr<ICPUDescriptorSet>(std::move(layout));
+			const uint32_t expectedBindingCount = ds->getLayout()->getBindings().size() ? (ds->getMaxDescriptorBindingIndex()+1u):0u;
+			if (bindingCount!=expectedBindingCount)
+				return nullptr;
+			for (uint32_t b=0u; b<bindingCount; b++)
+			{
+				auto descriptors = ds->getDescriptors(b);
+				if (record.read<uint32_t>()!=descriptors.size())
+					return nullptr;
+				for (auto& info : descriptors)
+				{
+					const uint32_t descriptorObj = record.read<uint32_t>();
+					const uint32_t samplerObj = record.read<uint32_t>();
+					const auto offset = record.read<uint64_t>();
+					const auto size = record.read<uint64_t>();
+					const auto imageLayout = record.read<E_IMAGE_LAYOUT>();
+					if (descriptorObj==nbc::InvalidIndex || descriptorObj>=ctx.assets.size())
+						continue;
+
+					if (ctx.objects[descriptorObj].type==IAsset::ET_IMAGE_VIEW)
+					{
+						info.desc = getChild<ICPUImageView>(ctx.assets,descriptorObj,failed);
+						info.image.sampler = getChild<ICPUSampler>(ctx.assets,samplerObj,failed);
+						info.image.imageLayout = imageLayout;
+					}
+					else
+					{
+						info.desc = getChild<ICPUBuffer>(ctx.assets,descriptorObj,failed);
+						info.buffer.offset = offset;
+						info.buffer.size = size;
+					}
+				}
+			}
+			if (failed || record.failed())
+				return nullptr;
+			retval = std::move(ds);
+			break;
+		}
+		case IAsset::ET_SUB_MESH:
+		{
+			auto meshbuffer = core::make_smart_refctd_ptr<ICPUMeshBuffer>();
+			meshbuffer->setPipeline(getChild<ICPURenderpassIndependentPipeline>(ctx.assets,record.read<uint32_t>(),failed));
+			meshbuffer->setAttachedDescriptorSet(getChild<ICPUDescriptorSet>(ctx.assets,record.read<uint32_t>(),failed));
+			for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+			{
+				SBufferBinding<ICPUBuffer> binding;
+				binding.buffer = getChild<ICPUBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+				binding.offset = record.read<uint64_t>();
+				if (binding.buffer)
+					meshbuffer->setVertexBufferBinding(std::move(binding),i);
+			}
+			{
+				SBufferBinding<ICPUBuffer> binding;
+				binding.buffer = getChild<ICPUBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+				binding.offset = record.read<uint64_t>();
+				meshbuffer->setIndexBufferBinding(std::move(binding));
+			}
+			meshbuffer->setIndexType(record.read<E_INDEX_TYPE>());
+			meshbuffer->setIndexCount(record.read<uint32_t>());
+			meshbuffer->setInstanceCount(record.read<uint32_t>());
+			meshbuffer->setBaseVertex(record.read<int32_t>());
+			meshbuffer->setBaseInstance(record.read<uint32_t>());
+			meshbuffer->setPositionAttributeIx(record.read<uint32_t>());
+			meshbuffer->setNormalAttributeIx(record.read<uint32_t>());
+			meshbuffer->setBoundingBox(readBoundingBox(record));
+			if (failed || record.failed())
+				return nullptr;
+			retval = std::move(meshbuffer);
+			break;
+		}
+		case IAsset::ET_MESH:
+		{
+			auto mesh = core::make_smart_refctd_ptr<ICPUMesh>();
+			const uint32_t meshbufferCount = record.read<uint32_t>();
+			if (record.failed() || meshbufferCount>recordBuffer->getSize())
+				return nullptr;
+			auto& meshbuffers = mesh->getMeshBufferVector();
+			meshbuffers.reserve(meshbufferCount);
+			for (uint32_t i=0u; i<meshbufferCount; i++)
+			{
+				auto meshbuffer = getChild<ICPUMeshBuffer>(ctx.assets,record.read<uint32_t>(),failed);
+				if (meshbuffer)
+					meshbuffers.push_back(std::move(meshbuffer));
+			}
+			mesh->setBoundingBox(readBoundingBox(record));
+			if (failed || record.failed())
+				return nullptr;
+			retval = std::move(mesh);
+			break;
+		}
+		default:
+			ctx.params.logger.log("LOAD NBC: unsupported object type %llu", system::ILogger::ELL_ERROR, static_cast<unsigned long long>(object.type));
+			break;
+	}
+	return retval;
+}
+
+#endif // _NBL_COMPILE_WITH_NBC_LOADER_
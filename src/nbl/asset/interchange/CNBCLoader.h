@@ -0,0 +1,77 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_NBC_LOADER_H_INCLUDED__
+#define __NBL_ASSET_C_NBC_LOADER_H_INCLUDED__
+
+#include "nbl/system/ISystem.h"
+
+#include "nbl/asset/ICPUMesh.h"
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/ICPUDescriptorSet.h"
+#include "nbl/asset/interchange/IAssetLoader.h"
+
+#include "SNBCFormat.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Loads ICPU asset DAGs written by CNBCWriter
+/**
+	The file gets memory mapped (reopened as mappable through the ISystem if it wasn't already),
+	uncompressed buffer blobs are then used in-place without any copy and keep the file alive.
+	Such buffers alias a read-only mapping, so clone them before writing to their contents.
+	LZ4 compressed blobs, or all blobs if the file can't be mapped, get read into freshly allocated buffers.
+*/
+class CNBCLoader final : public asset::IAssetLoader
+{
+	public:
+		CNBCLoader(core::smart_refctd_ptr<system::ISystem>&& _system) : m_system(std::move(_system)) {}
+
+		bool isALoadableFileFormat(system::IFile* _file, const system::logger_opt_ptr logger = nullptr) const override;
+
+		const char** getAssociatedFileExtensions() const override
+		{
+			static const char* ext[]{ "nbc", nullptr };
+			return ext;
+		}
+
+		const SFileSignature* getFileSignatures() const override
+		{
+			static const SFileSignature signatures[]{ {nbc::Magic,0u,sizeof(nbc::Magic)}, {} };
+			return signatures;
+		}
+
+		uint64_t getSupportedAssetTypesBitfield() const override
+		{
+			return IAsset::ET_BUFFER|IAsset::ET_SAMPLER|IAsset::ET_IMAGE|IAsset::ET_IMAGE_VIEW|IAsset::ET_DESCRIPTOR_SET|IAsset::ET_DESCRIPTOR_SET_LAYOUT|
+				IAsset::ET_PIPELINE_LAYOUT|IAsset::ET_SHADER|IAsset::ET_SPECIALIZED_SHADER|IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE|IAsset::ET_SUB_MESH|IAsset::ET_MESH;
+		}
+
+		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
+
+	private:
+		struct SContext
+		{
+			const SAssetLoadParams& params;
+			//! might differ from the file passed to `loadAsset` if we had to reopen it as mappable
+			core::smart_refctd_ptr<system::IFile> file;
+			const uint8_t* mapping;
+			core::vector<nbc::SBlob> blobs;
+			core::vector<nbc::SObject> objects;
+			core::vector<core::smart_refctd_ptr<IAsset>> assets;
+		};
+
+		core::smart_refctd_ptr<ICPUBuffer> loadBlob(SContext& ctx, uint32_t blobIx) const;
+		core::smart_refctd_ptr<IAsset> loadObject(SContext& ctx, const nbc::SObject& object) const;
+
+		core::smart_refctd_ptr<system::ISystem> m_system;
+};
+
+} // end namespace
+} // end namespace
+
+#endif
@@ -0,0 +1,318 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/system/ISystem.h"
+#include "nbl/system/IFile.h"
+
+#include "CNBCWriter.h"
+
+#ifdef _NBL_COMPILE_WITH_NBC_WRITER_
+
+#include "lz4/lib/lz4.h"
+#include "lz4/lib/lz4hc.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+bool CNBCWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override)
+{
+	if (!_override)
+		getDefaultOverride(_override);
+
+	SAssetWriteContext inCtx{_params, _file};
+	system::IFile* file = _override->getOutputFile(_file, inCtx, {_params.rootAsset, 0u});
+	if (!file)
+		return false;
+
+	SContext ctx = { SAssetWriteContext{inCtx.params, file}, _override, system::CBufferedFileWriter(file, sizeof(nbc::SHeader)) };
+
+	_params.logger.log("WRITING NBC: writing the file %s", system::ILogger::ELL_INFO, file->getFileName().string().c_str());
+
+	nbc::SHeader header = {};
+	memcpy(header.magic, nbc::Magic, sizeof(nbc::Magic));
+	header.version = nbc::Version;
+	header.rootObject = writeObject(ctx, _params.rootAsset, 0u);
+	if (header.rootObject == nbc::InvalidIndex || !ctx.writer.good())
+		return false;
+
+	// tables go after all the blobs, the header last once we know where they are
+	ctx.writer.seek(core::roundUp<size_t>(ctx.writer.getOffset(), nbc::BlobAlignment));
+	header.blobCount = ctx.blobs.size();
+	header.blobTableOffset = ctx.writer.getOffset();
+	writeToFile(ctx, ctx.blobs.data(), ctx.blobs.size()*sizeof(nbc::SBlob));
+	header.objectCount = ctx.objects.size();
+	header.objectTableOffset = ctx.writer.getOffset();
+	writeToFile(ctx, ctx.objects.data(), ctx.objects.size()*sizeof(nbc::SObject));
+	ctx.writer.seek(0ull);
+	writeToFile(ctx, &header, sizeof(header));
+
+	return ctx.writer.flush();
+}
+
+void CNBCWriter::writeToFile(SContext& ctx, const void* data, size_t size) const
+{
+	// the many small records and padding get combined, blobs larger than the buffer go straight to the file
+	ctx.writer.write(data, size);
+}
+
+uint32_t CNBCWriter::writeBlob(SContext& ctx, const void* data, size_t size, bool allowCompression, const IAsset* owner, uint32_t hierarchyLevel) const
+{
+	// padding is whatever was in the file before, so write explicit zeroes to keep the output deterministic
+	static constexpr uint8_t zeroes[nbc::BlobAlignment] = {};
+	const size_t alignedOffset = core::roundUp<size_t>(ctx.writer.getOffset(), nbc::BlobAlignment);
+	writeToFile(ctx, zeroes, alignedOffset-ctx.writer.getOffset());
+
+	nbc::SBlob blob = {};
+	blob.offset = ctx.writer.getOffset();
+	blob.size = size;
+	blob.storedSize = size;
+	blob.compression = nbc::EBC_NONE;
+
+	const bool compress = allowCompression && size >= MinCompressedBlobSize && size <= LZ4_MAX_INPUT_SIZE &&
+		(ctx.override->getAssetWritingFlags(ctx.writeContext, owner, hierarchyLevel) & EWF_COMPRESSED);
+	if (compress)
+	{
+		const int bound = LZ4_compressBound(size);
+		core::vector<char> compressed(bound);
+
+		const float level = ctx.override->getAssetCompressionLevel(ctx.writeContext, owner, hierarchyLevel);
+		int compressedSize;
+		if (level > 0.f)
+		{
+			const int hcLevel = core::clamp<int,int>(static_cast<int>(level*LZ4HC_CLEVEL_MAX), LZ4HC_CLEVEL_MIN, LZ4HC_CLEVEL_MAX);
+			compressedSize = LZ4_compress_HC(reinterpret_cast<const char*>(data), compressed.data(), size, bound, hcLevel);
+		}
+		else
+			compressedSize = LZ4_compress_default(reinterpret_cast<const char*>(data), compressed.data(), size, bound);
+
+		// keep it uncompressed if it barely shrinks, the mapping can then use it without any copy
+		if (compressedSize > 0 && static_cast<size_t>(compressedSize) < size-size/8ull)
+		{
+			blob.storedSize = compressedSize;
+			blob.compression = nbc::EBC_LZ4;
+			writeToFile(ctx, compressed.data(), compressedSize);
+		}
+		else
+			writeToFile(ctx, data, size);
+	}
+	else
+		writeToFile(ctx, data, size);
+
+	ctx.blobs.push_back(blob);
+	return ctx.blobs.size()-1u;
+}
+
+static inline void writeBoundingBox(nbc::CRecordWriter& record, const core::aabbox3df& box)
+{
+	const float extremes[6] = {box.MinEdge.X,box.MinEdge.Y,box.MinEdge.Z,box.MaxEdge.X,box.MaxEdge.Y,box.MaxEdge.Z};
+	record.write(extremes);
+}
+
+uint32_t CNBCWriter::writeObject(SContext& ctx, const IAsset* asset, uint32_t hierarchyLevel) const
+{
+	if (!asset)
+		return nbc::InvalidIndex;
+
+	auto found = ctx.objectIndices.find(asset);
+	if (found != ctx.objectIndices.end())
+		return found->second;
+
+	const auto& logger = ctx.writeContext.params.logger;
+	const uint32_t childLevel = hierarchyLevel+1u;
+	nbc::CRecordWriter record;
+	switch (asset->getAssetType())
+	{
+		case IAsset::ET_BUFFER:
+		{
+			const auto* buffer = static_cast<const ICPUBuffer*>(asset);
+			record.write<uint32_t>(writeBlob(ctx, buffer->getPointer(), buffer->getSize(), true, asset, hierarchyLevel));
+			record.write<uint32_t>(buffer->getUsageFlags().value);
+			record.write<uint8_t>(buffer->getCanUpdateSubRange());
+			break;
+		}
+		case IAsset::ET_SAMPLER:
+		{
+			record.write(static_cast<const ICPUSampler*>(asset)->getParams());
+			break;
+		}
+		case IAsset::ET_IMAGE:
+		{
+			const auto* image = static_cast<const ICPUImage*>(asset);
+			const auto& params = image->getCreationParameters();
+			record.write<uint32_t>(writeObject(ctx, image->getBuffer(), childLevel));
+			record.write(params.flags);
+			record.write(params.type);
+			record.write(params.format);
+			record.write(params.extent);
+			record.write(params.mipLevels);
+			record.write(params.arrayLayers);
+			record.write(params.samples);
+			record.write(params.tiling);
+			record.write<uint32_t>(params.usage.value);
+			record.write(params.initialLayout);
+			const auto regions = image->getRegions();
+			record.write<uint32_t>(regions.size());
+			record.write(regions.begin(), regions.size()*sizeof(IImage::SBufferCopy));
+			break;
+		}
+		case IAsset::ET_IMAGE_VIEW:
+		{
+			const auto& params = static_cast<const ICPUImageView*>(asset)->getCreationParameters();
+			record.write<uint32_t>(writeObject(ctx, params.image.get(), childLevel));
+			record.write(params.flags);
+			record.write(params.viewType);
+			record.write(params.format);
+			record.write(params.components);
+			record.write(params.subresourceRange);
+			break;
+		}
+		case IAsset::ET_SHADER:
+		{
+			const auto* shader = static_cast<const ICPUShader*>(asset);
+			record.write<uint32_t>(writeObject(ctx, shader->getSPVorGLSL(), childLevel));
+			record.write<uint8_t>(shader->containsGLSL());
+			record.write(shader->getStage());
+			record.writeString(shader->getFilepathHint());
+			break;
+		}
+		case IAsset::ET_SPECIALIZED_SHADER:
+		{
+			const auto* shader = static_cast<const ICPUSpecializedShader*>(asset);
+			const auto& info = shader->getSpecializationInfo();
+			record.write<uint32_t>(writeObject(ctx, shader->getUnspecialized(), childLevel));
+			record.write<uint32_t>(writeObject(ctx, info.getBackingBuffer(), childLevel));
+			record.writeString(info.entryPoint);
+			const auto* entries = info.getEntries();
+			record.write<uint32_t>(entries ? entries->size():0u);
+			if (entries)
+				record.write(entries->data(), entries->size()*sizeof(ISpecializedShader::SInfo::SMapEntry));
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET_LAYOUT:
+		{
+			const auto bindings = static_cast<const ICPUDescriptorSetLayout*>(asset)->getBindings();
+			record.write<uint32_t>(bindings.size());
+			for (const auto& binding : bindings)
+			{
+				record.write(binding.binding);
+				record.write(binding.type);
+				record.write(binding.count);
+				record.write(binding.stageFlags);
+				record.write<uint8_t>(binding.samplers!=nullptr);
+				if (binding.samplers)
+				for (uint32_t s=0u; s<binding.count; s++)
+					record.write<uint32_t>(writeObject(ctx, binding.samplers[s].get(), childLevel));
+			}
+			break;
+		}
+		case IAsset::ET_PIPELINE_LAYOUT:
+		{
+			const auto* layout = static_cast<const ICPUPipelineLayout*>(asset);
+			for (uint32_t i=0u; i<ICPUPipelineLayout::DESCRIPTOR_SET_COUNT; i++)
+				record.write<uint32_t>(writeObject(ctx, layout->getDescriptorSetLayout(i), childLevel));
+			const auto ranges = layout->getPushConstantRanges();
+			record.write<uint32_t>(ranges.size());
+			record.write(ranges.begin(), ranges.size()*sizeof(SPushConstantRange));
+			break;
+		}
+		case IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE:
+		{
+			const auto* pipeline = static_cast<const ICPURenderpassIndependentPipeline*>(asset);
+			record.write<uint32_t>(writeObject(ctx, pipeline->getLayout(), childLevel));
+			for (uint32_t i=0u; i<ICPURenderpassIndependentPipeline::SHADER_STAGE_COUNT; i++)
+				record.write<uint32_t>(writeObject(ctx, pipeline->getShaderAtIndex(i), childLevel));
+			record.write(pipeline->getVertexInputParams());
+			record.write(pipeline->getBlendParams());
+			record.write(pipeline->getPrimitiveAssemblyParams());
+			record.write(pipeline->getRasterizationParams());
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET:
+		{
+			const auto* ds = static_cast<const ICPUDescriptorSet*>(asset);
+			record.write<uint32_t>(writeObject(ctx, ds->getLayout(), childLevel));
+			const uint32_t bindingCount = ds->getLayout()->getBindings().size() ? (ds->getMaxDescriptorBindingIndex()+1u):0u;
+			record.write(bindingCount);
+			for (uint32_t b=0u; b<bindingCount; b++)
+			{
+				const auto descriptors = ds->getDescriptors(b);
+				record.write<uint32_t>(descriptors.size());
+				for (const auto& info : descriptors)
+				{
+					const IAsset* descriptor = nullptr;
+					if (info.desc)
+					switch (info.desc->getTypeCategory())
+					{
+						case IDescriptor::EC_BUFFER:
+							descriptor = static_cast<const ICPUBuffer*>(info.desc.get());
+							break;
+						case IDescriptor::EC_IMAGE:
+							descriptor = static_cast<const ICPUImageView*>(info.desc.get());
+							break;
+						default:
+							logger.log("WRITING NBC: buffer view and acceleration structure descriptors are not supported, skipping", system::ILogger::ELL_WARNING);
+							break;
+					}
+					record.write<uint32_t>(writeObject(ctx, descriptor, childLevel));
+					const bool isImage = descriptor && descriptor->getAssetType()==IAsset::ET_IMAGE_VIEW;
+					record.write<uint32_t>(isImage ? writeObject(ctx, info.image.sampler.get(), childLevel):nbc::InvalidIndex);
+					record.write<uint64_t>(isImage ? 0ull:info.buffer.offset);
+					record.write<uint64_t>(isImage ? 0ull:info.buffer.size);
+					record.write(isImage ? info.image.imageLayout:EIL_UNDEFINED);
+				}
+			}
+			break;
+		}
+		case IAsset::ET_SUB_MESH:
+		{
+			const auto* meshbuffer = static_cast<const ICPUMeshBuffer*>(asset);
+			if (meshbuffer->getJointCount())
+				logger.log("WRITING NBC: skinning data of meshbuffers is not supported yet, it will be dropped", system::ILogger::ELL_WARNING);
+			record.write<uint32_t>(writeObject(ctx, meshbuffer->getPipeline(), childLevel));
+			record.write<uint32_t>(writeObject(ctx, meshbuffer->getAttachedDescriptorSet(), childLevel));
+			for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+			{
+				const auto& binding = meshbuffer->getVertexBufferBindings()[i];
+				record.write<uint32_t>(writeObject(ctx, binding.buffer.get(), childLevel));
+				record.write<uint64_t>(binding.offset);
+			}
+			const auto& indexBinding = meshbuffer->getIndexBufferBinding();
+			record.write<uint32_t>(writeObject(ctx, indexBinding.buffer.get(), childLevel));
+			record.write<uint64_t>(indexBinding.offset);
+			record.write(meshbuffer->getIndexType());
+			record.write<uint32_t>(meshbuffer->getIndexCount());
+			record.write<uint32_t>(meshbuffer->getInstanceCount());
+			record.write<int32_t>(meshbuffer->getBaseVertex());
+			record.write<uint32_t>(meshbuffer->getBaseInstance());
+			record.write<uint32_t>(meshbuffer->getPositionAttributeIx());
+			record.write<uint32_t>(meshbuffer->getNormalAttributeIx());
+			writeBoundingBox(record, meshbuffer->getBoundingBox());
+			break;
+		}
+		case IAsset::ET_MESH:
+		{
+			const auto* mesh = static_cast<const ICPUMesh*>(asset);
+			const auto meshbuffers = mesh->getMeshBuffers();
+			record.write<uint32_t>(meshbuffers.size());
+			for (const auto* meshbuffer : meshbuffers)
+				record.write<uint32_t>(writeObject(ctx, meshbuffer, childLevel));
+			writeBoundingBox(record, mesh->getBoundingBox());
+			break;
+		}
+		default:
+			logger.log("WRITING NBC: asset type %llu is not supported, writing a null reference instead", system::ILogger::ELL_WARNING, static_cast<unsigned long long>(asset->getAssetType()));
+			return nbc::InvalidIndex;
+	}
+
+	nbc::SObject object = {};
+	object.type = asset->getAssetType();
+	object.recordBlob = writeBlob(ctx, record.getData().data(), record.getData().size(), false, asset, hierarchyLevel);
+	ctx.objects.push_back(object);
+
+	const uint32_t index = ctx.objects.size()-1u;
+	ctx.objectIndices.insert({asset, index});
+	return index;
+}
+
+#endif // _NBL_COMPILE_WITH_NBC_WRITER_
@@ -0,0 +1,77 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_C_NBC_WRITER_H_INCLUDED__
+#define __NBL_ASSET_C_NBC_WRITER_H_INCLUDED__
+
+#include "nbl/asset/ICPUMesh.h"
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/ICPUDescriptorSet.h"
+#include "nbl/asset/interchange/IAssetWriter.h"
+
+#include "nbl/system/CBufferedFileWriter.h"
+
+#include "SNBCFormat.h"
+
+namespace nbl
+{
+namespace asset
+{
+
+//! Writes an ICPU asset DAG into the NBC (Nabla Binary Cache) format
+/**
+	Every asset reachable from the root is written once, no matter how many parents reference it.
+	With `EWF_COMPRESSED` the buffer contents are LZ4 compressed (LZ4HC if the compression level is above 0),
+	but only blobs which shrink by at least an eighth stay compressed, the rest are kept as-is so they can be mapped.
+*/
+class CNBCWriter : public asset::IAssetWriter
+{
+	protected:
+		virtual ~CNBCWriter() = default;
+
+	public:
+		CNBCWriter() = default;
+
+		virtual const char** getAssociatedFileExtensions() const override
+		{
+			static const char* ext[]{ "nbc", nullptr };
+			return ext;
+		}
+
+		virtual uint64_t getSupportedAssetTypesBitfield() const override
+		{
+			return IAsset::ET_BUFFER|IAsset::ET_SAMPLER|IAsset::ET_IMAGE|IAsset::ET_IMAGE_VIEW|IAsset::ET_DESCRIPTOR_SET|IAsset::ET_DESCRIPTOR_SET_LAYOUT|
+				IAsset::ET_PIPELINE_LAYOUT|IAsset::ET_SHADER|IAsset::ET_SPECIALIZED_SHADER|IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE|IAsset::ET_SUB_MESH|IAsset::ET_MESH;
+		}
+
+		virtual uint32_t getSupportedFlags() override { return asset::EWF_BINARY|asset::EWF_COMPRESSED; }
+
+		virtual uint32_t getForcedFlags() override { return asset::EWF_BINARY; }
+
+		virtual bool writeAsset(system::IFile* _file, const SAssetWriteParams& _params, IAssetWriterOverride* _override = nullptr) override;
+
+	private:
+		//! blobs smaller than that are never compressed
+		_NBL_STATIC_INLINE_CONSTEXPR size_t MinCompressedBlobSize = 4096ull;
+
+		struct SContext
+		{
+			SAssetWriteContext writeContext;
+			IAssetWriterOverride* override;
+			//! starts right after the header, which gets written last
+			system::CBufferedFileWriter writer;
+			core::unordered_map<const IAsset*,uint32_t> objectIndices;
+			core::vector<nbc::SBlob> blobs;
+			core::vector<nbc::SObject> objects;
+		};
+
+		uint32_t writeObject(SContext& ctx, const IAsset* asset, uint32_t hierarchyLevel) const;
+		uint32_t writeBlob(SContext& ctx, const void* data, size_t size, bool allowCompression, const IAsset* owner, uint32_t hierarchyLevel) const;
+		void writeToFile(SContext& ctx, const void* data, size_t size) const;
+};
+
+} // end namespace
+} // end namespace
+
+#endif
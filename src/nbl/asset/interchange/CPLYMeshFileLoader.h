@@ -50,6 +50,12 @@ public:
         return ext;
     }
 
+    virtual const SFileSignature* getFileSignatures() const override
+    {
+        static const SFileSignature signatures[]{ {"ply",0u,3u}, {} };
+        return signatures;
+    }
+
     virtual uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_MESH; }
 
 	//! creates/loads an animated mesh from the file.
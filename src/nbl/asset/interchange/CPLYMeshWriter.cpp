@@ -74,7 +74,7 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
 	if (!file || !mesh)
 		return false;
 
-    SContext context = { SAssetWriteContext{ inCtx.params, file} };
+    SContext context = { SAssetWriteContext{ inCtx.params, file}, system::CBufferedFileWriter(file) };
     
     if (meshbuffers.size() > 1)
     {
@@ -211,12 +211,7 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
         faceCount = 0u;
     header += "end_header\n";
 
-    {
-        system::ISystem::future_t<size_t> future;
-        file->write(future, header.c_str(), context.fileOffset, header.size());
-        const auto bytesWritten = future.get();
-        context.fileOffset += bytesWritten;
-    }
+    context.writer.writeText(header);
  
     if (flags & asset::EWF_BINARY)
         writeBinary(rawCopyMeshBuffer, vertexCount, faceCount, idxT, indices, forceFaces, vaidToWrite, context);
@@ -225,7 +220,7 @@ bool CPLYMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
 
     _NBL_ALIGNED_FREE(const_cast<void*>(indices));
 
-	return true;
+	return context.writer.flush();
 }
 
 void CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCount, size_t _fcCount, asset::E_INDEX_TYPE _idxType, void* const _indices, bool _forceFaces, const bool _vaidToWrite[4], SContext& context) const
@@ -278,19 +273,8 @@ void CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtx
         uint32_t* ind = (uint32_t*)indices;
         for (size_t i = 0u; i < _fcCount; ++i)
         {
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, &listSize, context.fileOffset, sizeof(listSize));
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
-
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, ind, context.fileOffset, listSize * 4);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.writeValue(listSize);
+            context.writer.write(ind, listSize * 4);
 
             ind += listSize;
         }
@@ -300,19 +284,8 @@ void CPLYMeshWriter::writeBinary(const asset::ICPUMeshBuffer* _mbuf, size_t _vtx
         uint16_t* ind = (uint16_t*)indices;
         for (size_t i = 0u; i < _fcCount; ++i)
         {
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, &listSize, context.fileOffset, sizeof(listSize));
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
-
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, ind, context.fileOffset, listSize * 2);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.writeValue(listSize);
+            context.writer.write(ind, listSize * 2);
             
             ind += listSize;
         }
@@ -378,12 +351,7 @@ void CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCo
             writefunc(3, i, 3u);
         }
 
-        {
-            system::ISystem::future_t<size_t> future;
-            context.writeContext.outputFile->write(future, "\n", context.fileOffset, 1);
-            const auto bytesWritten = future.get();
-            context.fileOffset += bytesWritten;
-        }
+        context.writer.writeText('\n');
     }
 
     const char* listSize = "3 ";
@@ -407,21 +375,9 @@ void CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCo
         uint32_t* ind = (uint32_t*)indices;
         for (size_t i = 0u; i < _fcCount; ++i)
         {
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, listSize, context.fileOffset, 2);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
-
+            context.writer.writeText(listSize);
             writeVectorAsText(context, ind, 3);
-
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, "\n", context.fileOffset, 1);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.writeText('\n');
 
             ind += 3;
         }
@@ -431,21 +387,9 @@ void CPLYMeshWriter::writeText(const asset::ICPUMeshBuffer* _mbuf, size_t _vtxCo
         uint16_t* ind = (uint16_t*)indices;
         for (size_t i = 0u; i < _fcCount; ++i)
         {
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, listSize, context.fileOffset, 2);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
-
+            context.writer.writeText(listSize);
             writeVectorAsText(context, ind, 3);
-
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, "\n", context.fileOffset, 1);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.writeText('\n');
 
             ind += 3;
         }
@@ -474,12 +418,7 @@ void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer*
             for (uint32_t k = 0u; k < _cpa; ++k)
                 a[k] = ui[k];
 
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, a, context.fileOffset, _cpa);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.write(a, _cpa);
         }
         else if (bytesPerCh == 2u)
         {
@@ -487,21 +426,11 @@ void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer*
             for (uint32_t k = 0u; k < _cpa; ++k)
                 a[k] = ui[k];
 
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, a, context.fileOffset, 2 * _cpa);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.write(a, 2 * _cpa);
         }
         else if (bytesPerCh == 4u)
         {
-            {
-                system::ISystem::future_t<size_t> future;
-                context.writeContext.outputFile->write(future, ui, context.fileOffset, 4 * _cpa);
-                const auto bytesWritten = future.get();
-                context.fileOffset += bytesWritten;
-            }
+            context.writer.write(ui, 4 * _cpa);
         }
     }
     else
@@ -510,12 +439,7 @@ void CPLYMeshWriter::writeAttribBinary(SContext& context, asset::ICPUMeshBuffer*
         if (flipAttribute)
             f[0] = -f[0];
 
-        {
-            system::ISystem::future_t<size_t> future;
-            context.writeContext.outputFile->write(future, f.pointer, context.fileOffset, 4 * _cpa);
-            const auto bytesWritten = future.get();
-            context.fileOffset += bytesWritten;
-        }
+        context.writer.write(f.pointer, 4 * _cpa);
     }
 }
 
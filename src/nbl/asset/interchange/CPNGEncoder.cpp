@@ -0,0 +1,286 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/asset/interchange/CPNGEncoder.h"
+#include "nbl/asset/interchange/IImageAssetHandlerBase.h"
+
+#include <zlib/zlib.h>
+
+using namespace nbl;
+using namespace asset;
+
+
+namespace
+{
+constexpr uint8_t Signature[8] = {0x89u,'P','N','G','\r','\n',0x1au,'\n'};
+//! deflate can't reference anything further back
+constexpr size_t WindowSize = 0x1ull<<15ull;
+//! so a stripe always fits in `z_stream::avail_in`
+constexpr size_t MaxStripeSize = 0x1ull<<30ull;
+
+inline void writeBigEndian(uint8_t* out, const uint32_t value)
+{
+	out[0] = value>>24u;
+	out[1] = value>>16u;
+	out[2] = value>>8u;
+	out[3] = value;
+}
+//! fills in the length, type and CRC around the `dataSize` bytes at `chunk+8`
+inline void finalizeChunk(uint8_t* chunk, const char type[4], const uint32_t dataSize)
+{
+	writeBigEndian(chunk,dataSize);
+	memcpy(chunk+4,type,4u);
+	writeBigEndian(chunk+8+dataSize,crc32(crc32(0ul,nullptr,0u),chunk+4,dataSize+4u));
+}
+
+inline int resolveLevel(const int32_t compressionLevel)
+{
+	return compressionLevel==CPNGEncoder::DefaultCompressionLevel ? Z_DEFAULT_COMPRESSION:compressionLevel;
+}
+
+//! distances to `a+b-c` with the common terms cancelled, so the selects compile to conditional moves
+inline uint8_t paethPredictor(const int a, const int b, const int c)
+{
+	const int pa = std::abs(b-c);
+	const int pb = std::abs(a-c);
+	const int pc = std::abs(a+b-2*c);
+	const int ab = pb<=pc ? b:c;
+	return pa<=pb && pa<=pc ? a:ab;
+}
+//! `prev` is the unfiltered row above, all zeroes for the first row
+void filterRow(const CPNGEncoder::E_FILTER type, const uint8_t* row, const uint8_t* prev, const size_t size, const uint32_t bpp, uint8_t* out)
+{
+	switch (type)
+	{
+		case CPNGEncoder::EF_SUB:
+			memcpy(out,row,bpp);
+			for (size_t i=bpp; i<size; i++)
+				out[i] = row[i]-row[i-bpp];
+			break;
+		case CPNGEncoder::EF_UP:
+			for (size_t i=0u; i<size; i++)
+				out[i] = row[i]-prev[i];
+			break;
+		case CPNGEncoder::EF_AVERAGE:
+			for (size_t i=0u; i<bpp; i++)
+				out[i] = row[i]-(prev[i]>>1u);
+			for (size_t i=bpp; i<size; i++)
+				out[i] = row[i]-((uint32_t(row[i-bpp])+prev[i])>>1u);
+			break;
+		case CPNGEncoder::EF_PAETH:
+			for (size_t i=0u; i<bpp; i++)
+				out[i] = row[i]-prev[i];
+			for (size_t i=bpp; i<size; i++)
+				out[i] = row[i]-paethPredictor(row[i-bpp],prev[i],prev[i-bpp]);
+			break;
+		default:
+			memcpy(out,row,size);
+			break;
+	}
+}
+//! the heuristic of libpng, bytes count as signed
+inline uint64_t sumOfAbsoluteDifferences(const uint8_t* filtered, const size_t size)
+{
+	uint64_t sum = 0ull;
+	for (size_t i=0u; i<size; i++)
+		sum += std::abs(static_cast<int8_t>(filtered[i]));
+	return sum;
+}
+}
+
+core::smart_refctd_ptr<ICPUImage> CPNGEncoder::convertForWriting(const ICPUImageView* imageView, const system::logger_opt_ptr logger)
+{
+	const auto channelCount = asset::getFormatChannelCount(imageView->getCreationParameters().format);
+	if (channelCount==1)
+		return IImageAssetHandlerBase::createImageDataForCommonWriting<asset::EF_R8_SRGB>(imageView,logger);
+	else if (channelCount==2 || channelCount==3)
+		return IImageAssetHandlerBase::createImageDataForCommonWriting<asset::EF_R8G8B8_SRGB>(imageView,logger);
+	return IImageAssetHandlerBase::createImageDataForCommonWriting<asset::EF_R8G8B8A8_SRGB>(imageView,logger);
+}
+
+CPNGEncoder::SImage CPNGEncoder::getImage(const ICPUImage* convertedImage)
+{
+	const auto& region = *convertedImage->getRegions().begin();
+	assert(region.bufferRowLength && region.bufferImageHeight); //Detected changes in createImageDataForCommonWriting!
+
+	SImage image;
+	image.data = reinterpret_cast<const uint8_t*>(convertedImage->getBuffer()->getPointer())+region.bufferOffset;
+	image.width = region.imageExtent.width;
+	image.height = region.imageExtent.height;
+	image.channelCount = asset::getFormatChannelCount(convertedImage->getCreationParameters().format);
+	image.rowPitch = size_t(region.bufferRowLength)*image.channelCount;
+	return image;
+}
+
+bool CPNGEncoder::prepare(const SImage& image, const SParams& params)
+{
+	if (!image.data || !image.width || !image.height || image.width>0x7fffffffu || image.height>0x7fffffffu)
+		return false;
+	if (image.channelCount<1u || image.channelCount>4u)
+		return false;
+	if (params.compressionLevel<DefaultCompressionLevel || params.compressionLevel>9 || params.filter>EF_ADAPTIVE || params.strategy>ES_HUFFMAN_ONLY)
+		return false;
+	const size_t rowSize = size_t(image.width)*image.channelCount;
+	if (image.rowPitch && image.rowPitch<rowSize)
+		return false;
+
+	m_filteredRowSize = rowSize+1ull;
+	m_filtered.resize(m_filteredRowSize*image.height);
+
+	const size_t stripeSize = core::min<size_t>(params.stripeSize ? params.stripeSize:MaxStripeSize,MaxStripeSize);
+	const uint32_t rowsPerStripe = static_cast<uint32_t>(core::clamp<size_t,size_t>(stripeSize/m_filteredRowSize,1ull,image.height));
+	m_stripes.resize((image.height-1u)/rowsPerStripe+1u);
+	for (uint32_t i=0u; i<m_stripes.size(); i++)
+	{
+		m_stripes[i].firstRow = i*rowsPerStripe;
+		m_stripes[i].rowCount = core::min(rowsPerStripe,image.height-m_stripes[i].firstRow);
+	}
+	return true;
+}
+
+void CPNGEncoder::filterStripe(const SImage& image, const SParams& params, SStripe& stripe)
+{
+	const size_t rowSize = m_filteredRowSize-1ull;
+	const size_t rowPitch = image.rowPitch ? image.rowPitch:rowSize;
+	const uint32_t bpp = image.channelCount;
+	// the first row is predicted from zeroes, adaptive filtering tries every filter into its own row
+	core::vector<uint8_t> scratch((stripe.firstRow ? 0ull:rowSize)+(params.filter==EF_ADAPTIVE ? (rowSize*EF_ADAPTIVE):0ull),0u);
+	const uint8_t* const zeroes = scratch.data();
+	uint8_t* const candidates = scratch.data()+(stripe.firstRow ? 0ull:rowSize);
+
+	for (uint32_t y=stripe.firstRow; y<stripe.firstRow+stripe.rowCount; y++)
+	{
+		const uint8_t* row = image.data+y*rowPitch;
+		const uint8_t* prev = y ? (row-rowPitch):zeroes;
+		uint8_t* out = m_filtered.data()+y*m_filteredRowSize;
+		if (params.filter!=EF_ADAPTIVE)
+		{
+			out[0] = params.filter;
+			filterRow(params.filter,row,prev,rowSize,bpp,out+1);
+			continue;
+		}
+
+		uint8_t best = EF_NONE;
+		uint64_t bestSum = ~0ull;
+		for (uint8_t type=EF_NONE; type<EF_ADAPTIVE; type++)
+		{
+			uint8_t* candidate = candidates+type*rowSize;
+			filterRow(static_cast<E_FILTER>(type),row,prev,rowSize,bpp,candidate);
+			const uint64_t sum = sumOfAbsoluteDifferences(candidate,rowSize);
+			if (sum<bestSum)
+			{
+				best = type;
+				bestSum = sum;
+			}
+		}
+		out[0] = best;
+		memcpy(out+1,candidates+best*rowSize,rowSize);
+	}
+}
+
+void CPNGEncoder::compressStripe(const SParams& params, SStripe& stripe)
+{
+	stripe.failed = true;
+	const bool first = stripe.firstRow==0u;
+	const bool last = &stripe==&m_stripes.back();
+	const size_t offset = stripe.firstRow*m_filteredRowSize;
+	const uint8_t* const src = m_filtered.data()+offset;
+	const size_t size = stripe.rowCount*m_filteredRowSize;
+	stripe.adler = adler32(adler32(0ul,nullptr,0u),src,static_cast<uInt>(size));
+
+	constexpr int strategies[] = {Z_DEFAULT_STRATEGY,Z_FILTERED,Z_RLE,Z_HUFFMAN_ONLY};
+	const int level = resolveLevel(params.compressionLevel);
+	z_stream stream = {};
+	// raw deflate, the zlib header goes in front of the first stripe and the checksum after the last
+	if (deflateInit2(&stream,level,Z_DEFLATED,-15,8,strategies[params.strategy])!=Z_OK)
+		return;
+	if (!first)
+	{
+		const size_t dictionarySize = core::min(offset,WindowSize);
+		deflateSetDictionary(&stream,src-dictionarySize,static_cast<uInt>(dictionarySize));
+	}
+
+	const size_t headerSize = first ? 2ull:0ull;
+	size_t capacity = deflateBound(&stream,static_cast<uLong>(size))+16ull;
+	stripe.chunk.resize(8ull+headerSize+capacity+4ull);
+	stream.next_in = const_cast<Bytef*>(src);
+	stream.avail_in = static_cast<uInt>(size);
+	// a sync flush ends the stripe on a byte boundary without marking the last block
+	const int flush = last ? Z_FINISH:Z_SYNC_FLUSH;
+	size_t produced = 0ull;
+	int result;
+	for (;;)
+	{
+		stream.next_out = stripe.chunk.data()+8ull+headerSize+produced;
+		stream.avail_out = static_cast<uInt>(capacity-produced);
+		result = deflate(&stream,flush);
+		produced = capacity-stream.avail_out;
+		if (result==Z_STREAM_ERROR || (last ? result==Z_STREAM_END:stream.avail_out!=0u))
+			break;
+		capacity *= 2ull;
+		stripe.chunk.resize(8ull+headerSize+capacity+4ull);
+	}
+	deflateEnd(&stream);
+	if (result==Z_STREAM_ERROR || stream.avail_in)
+		return;
+
+	if (first)
+	{
+		// 32 KiB window, and the level in the FLEVEL bits like zlib puts it
+		constexpr uint32_t CMF = 0x78u;
+		const int resolvedLevel = level==Z_DEFAULT_COMPRESSION ? 6:level;
+		const uint32_t flevel = resolvedLevel<2 ? 0u:(resolvedLevel<6 ? 1u:(resolvedLevel==6 ? 2u:3u));
+		uint32_t header = (CMF<<8u)|(flevel<<6u);
+		header += 31u-(header%31u);
+		stripe.chunk[8] = header>>8u;
+		stripe.chunk[9] = header;
+	}
+	const uint32_t dataSize = static_cast<uint32_t>(headerSize+produced);
+	stripe.chunk.resize(8ull+dataSize+4ull);
+	finalizeChunk(stripe.chunk.data(),"IDAT",dataSize);
+	stripe.failed = false;
+}
+
+bool CPNGEncoder::assemble(const SImage& image, const SParams& params, core::vector<uint8_t>& out) const
+{
+	constexpr size_t IHDRSize = 13ull;
+	size_t size = sizeof(Signature)+(12ull+IHDRSize)+(12ull+4ull)+12ull;
+	for (const auto& stripe : m_stripes)
+	{
+		if (stripe.failed)
+			return false;
+		size += stripe.chunk.size();
+	}
+	out.resize(size);
+	uint8_t* it = out.data();
+
+	memcpy(it,Signature,sizeof(Signature));
+	it += sizeof(Signature);
+	{
+		constexpr uint8_t ColorTypes[4] = {0u,4u,2u,6u};
+		writeBigEndian(it+8,image.width);
+		writeBigEndian(it+12,image.height);
+		it[16] = 8u;
+		it[17] = ColorTypes[image.channelCount-1u];
+		// deflate, adaptive filtering (the only method), no interlacing
+		it[18] = it[19] = it[20] = 0u;
+		finalizeChunk(it,"IHDR",IHDRSize);
+		it += 12ull+IHDRSize;
+	}
+
+	uLong adler = adler32(0ul,nullptr,0u);
+	for (const auto& stripe : m_stripes)
+	{
+		memcpy(it,stripe.chunk.data(),stripe.chunk.size());
+		it += stripe.chunk.size();
+		adler = adler32_combine(adler,stripe.adler,static_cast<z_off_t>(stripe.rowCount*m_filteredRowSize));
+	}
+	// the zlib stream ends with the checksum of all the filtered rows
+	writeBigEndian(it+8,static_cast<uint32_t>(adler));
+	finalizeChunk(it,"IDAT",4u);
+	it += 16ull;
+
+	finalizeChunk(it,"IEND",0u);
+	return true;
+}
@@ -30,6 +30,12 @@ class CSPVLoader final : public asset::IAssetLoader
 			return ext;
 		}
 
+		const SFileSignature* getFileSignatures() const override
+		{
+			static const SFileSignature signatures[]{ {reinterpret_cast<const char*>(&SPV_MAGIC_NUMBER),0u,sizeof(SPV_MAGIC_NUMBER)}, {} };
+			return signatures;
+		}
+
 		inline uint64_t getSupportedAssetTypesBitfield() const override { return asset::IAsset::ET_SHADER; }
 
 		asset::SAssetBundle loadAsset(system::IFile* _file, const asset::IAssetLoader::SAssetLoadParams& _params, asset::IAssetLoader::IAssetLoaderOverride* _override = nullptr, uint32_t _hierarchyLevel = 0u) override;
@@ -34,6 +34,18 @@ class CSTLMeshFileLoader final : public IRenderpassIndependentPipelineLoader
 			return ext;
 		}
 
+		//! ASCII STL starts with "solid ", binary has no magic but its size is fully determined by the triangle count at byte 80
+		bool matchesFileHeader(const SFileHeader& _header) const override
+		{
+			if (_header.size>=6u && memcmp(_header.data,"solid ",6u)==0)
+				return true;
+			if (_header.size<84u)
+				return false;
+			uint32_t triangleCount;
+			memcpy(&triangleCount,_header.data+80u,sizeof(triangleCount));
+			return _header.fileSize==50ull*triangleCount+84ull;
+		}
+
 		uint64_t getSupportedAssetTypesBitfield() const override { return IAsset::ET_MESH; }
 
 	private:
@@ -50,26 +50,78 @@ bool CSTLMeshWriter::writeAsset(system::IFile* _file, const SAssetWriteParams& _
 	if (!file)
 		return false;
 
-	SContext context = { SAssetWriteContext{ inCtx.params, file} };
+	SContext context = { SAssetWriteContext{ inCtx.params, file}, system::CBufferedFileWriter(file) };
 
 	_params.logger.log("WRITING STL: writing the file %s", system::ILogger::ELL_INFO, file->getFileName().string().c_str());
 
     const asset::E_WRITER_FLAGS flags = _override->getAssetWritingFlags(context.writeContext, mesh, 0u);
-	if (flags & asset::EWF_BINARY)
-		return writeMeshBinary(mesh, &context);
-	else
-		return writeMeshASCII(mesh, &context);
+	const bool success = (flags & asset::EWF_BINARY) ? writeMeshBinary(mesh, &context):writeMeshASCII(mesh, &context);
+	return context.writer.flush() && success;
 }
 
 namespace
 {
+//! Decodes the positions of consecutive triangle corners in batches, instead of one `getPosition` per corner
+class CTrianglePositionReader
+{
+	public:
+		CTrianglePositionReader(const asset::ICPUMeshBuffer* _buffer) : buffer(_buffer), indexCount(_buffer->getIndexCount())
+		{
+			indexType = buffer->getIndexBufferBinding().buffer ? buffer->getIndexType():asset::EIT_UNKNOWN;
+		}
+
+		//! `j` must be the index of the triangle's first corner and triangles have to be read in order
+		inline void get(uint32_t j, core::vectorSIMDf (&v)[3])
+		{
+			const uint32_t batchOffset = j%BatchSize;
+			if (batchOffset==0u)
+				decodeBatch(j);
+			for (uint32_t i=0u; i<3u; ++i)
+			{
+				if (decoded)
+					v[i] = core::vectorSIMDf(positions[0][batchOffset+i],positions[1][batchOffset+i],positions[2][batchOffset+i],1.f);
+				else
+					v[i] = buffer->getPosition(buffer->getIndexValue(j+i));
+			}
+		}
+
+	private:
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t BatchSize = 3u*256u;
+
+		inline void decodeBatch(uint32_t j)
+		{
+			const uint32_t count = core::min(BatchSize,indexCount-j);
+			float* const outChannels[4] = {positions[0],positions[1],positions[2],nullptr};
+			const uint32_t posAttrId = buffer->getPositionAttributeIx();
+			switch (indexType)
+			{
+				case asset::EIT_16BIT:
+					decoded = buffer->getAttributeStream(outChannels,posAttrId,count,reinterpret_cast<const uint16_t*>(buffer->getIndices())+j,indexType);
+					break;
+				case asset::EIT_32BIT:
+					decoded = buffer->getAttributeStream(outChannels,posAttrId,count,reinterpret_cast<const uint32_t*>(buffer->getIndices())+j,indexType);
+					break;
+				default:
+					decoded = buffer->getAttributeStream(outChannels,posAttrId,count,nullptr,asset::EIT_UNKNOWN,j);
+					break;
+			}
+		}
+
+		const asset::ICPUMeshBuffer* buffer;
+		const uint32_t indexCount;
+		asset::E_INDEX_TYPE indexType;
+		bool decoded = false;
+		float positions[3][BatchSize];
+};
+
 template <class I>
-inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& noIndices, system::IFile* file, uint32_t _colorVaid, IAssetWriter::SAssetWriteContext* context, size_t* fileOffset)
+inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& noIndices, system::CBufferedFileWriter& writer, uint32_t _colorVaid, IAssetWriter::SAssetWriteContext* context)
 {
 	auto& inputParams = buffer->getPipeline()->getVertexInputParams();
 	bool hasColor = inputParams.enabledAttribFlags & core::createBitmask({ COLOR_ATTRIBUTE });
     const asset::E_FORMAT colorType = static_cast<asset::E_FORMAT>(hasColor ? inputParams.attributes[COLOR_ATTRIBUTE].format : asset::EF_UNKNOWN);
 
+    CTrianglePositionReader positionReader(buffer);
     const uint32_t indexCount = buffer->getIndexCount();
     for (uint32_t j = 0u; j < indexCount; j += 3u)
     {
@@ -83,8 +135,7 @@ inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& no
         }
 
         core::vectorSIMDf v[3];
-        for (uint32_t i = 0u; i < 3u; ++i)
-            v[i] = buffer->getPosition(idx[i]);
+        positionReader.get(j, v);
 
         uint16_t color = 0u;
         if (hasColor)
@@ -130,95 +181,41 @@ inline void writeFacesBinary(const asset::ICPUMeshBuffer* buffer, const bool& no
 		if (!(context->params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
 			flipVectors();
 
-		{
-			system::ISystem::future_t<size_t> future;
-			file->write(future, &normal, *fileOffset, 12);
-			const auto bytesWritten = future.get();
-			*fileOffset += bytesWritten;
-		}
-
-		{
-			system::ISystem::future_t<size_t> future;
-			file->write(future, &vertex1, *fileOffset, 12);
-			const auto bytesWritten = future.get();
-			*fileOffset += bytesWritten;
-		}
-
-		{
-			system::ISystem::future_t<size_t> future;
-			file->write(future, &vertex2, *fileOffset, 12);
-			const auto bytesWritten = future.get();
-			*fileOffset += bytesWritten;
-		}
-
-		{
-			system::ISystem::future_t<size_t> future;
-			file->write(future, &vertex3, *fileOffset, 12);
-			const auto bytesWritten = future.get();
-			*fileOffset += bytesWritten;
-		}
-
-		{
-			system::ISystem::future_t<size_t> future;
-			file->write(future, &color, *fileOffset, 2); // saving color using non-standard VisCAM/SolidView trick
-			const auto bytesWritten = future.get();
-			*fileOffset += bytesWritten;
-		}
+		writer.write(&normal, 12);
+		writer.write(&vertex1, 12);
+		writer.write(&vertex2, 12);
+		writer.write(&vertex3, 12);
+		writer.writeValue(color); // saving color using non-standard VisCAM/SolidView trick
     }
 }
 }
 
 bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* context)
 {
+	auto& writer = context->writer;
+
 	// write STL MESH header
     const char headerTxt[] = "Irrlicht-baw Engine";
     constexpr size_t HEADER_SIZE = 80u;
 
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, headerTxt, context->fileOffset, sizeof(headerTxt));
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	writer.write(headerTxt, sizeof(headerTxt));
 
 	const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string(); // TODO: check it
 	const int32_t sizeleft = HEADER_SIZE - sizeof(headerTxt) - name.size();
 
 	if (sizeleft < 0)
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, name.c_str(), context->fileOffset, HEADER_SIZE - sizeof(headerTxt));
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+		writer.write(name.c_str(), HEADER_SIZE - sizeof(headerTxt));
 	else
 	{
 		const char buf[80] = {0};
-
-		{
-			system::ISystem::future_t<size_t> future;
-			context->writeContext.outputFile->write(future, name.c_str(), context->fileOffset, name.size());
-			const auto bytesWritten = future.get();
-			context->fileOffset += bytesWritten;
-		}
-
-		{
-			system::ISystem::future_t<size_t> future;
-			context->writeContext.outputFile->write(future, buf, context->fileOffset, sizeleft);
-			const auto bytesWritten = future.get();
-			context->fileOffset += bytesWritten;
-		}
+		writer.write(name.c_str(), name.size());
+		writer.write(buf, sizeleft);
 	}
 
 	uint32_t facenum = 0;
 	for (auto& mb : mesh->getMeshBuffers())
 		facenum += mb->getIndexCount()/3;
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, &facenum, context->fileOffset, sizeof(facenum));
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	writer.writeValue(facenum);
 	// write mesh buffers
 
 	for (auto& buffer : mesh->getMeshBuffers())
@@ -229,137 +226,63 @@ bool CSTLMeshWriter::writeMeshBinary(const asset::ICPUMesh* mesh, SContext* cont
             type = asset::EIT_UNKNOWN;
 
 		if (type== asset::EIT_16BIT)
-            writeFacesBinary<uint16_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
+            writeFacesBinary<uint16_t>(buffer, false, writer, COLOR_ATTRIBUTE, &context->writeContext);
 		else if (type== asset::EIT_32BIT)
-            writeFacesBinary<uint32_t>(buffer, false, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset);
+            writeFacesBinary<uint32_t>(buffer, false, writer, COLOR_ATTRIBUTE, &context->writeContext);
 		else
-            writeFacesBinary<uint16_t>(buffer, true, context->writeContext.outputFile, COLOR_ATTRIBUTE, &context->writeContext, &context->fileOffset); //template param doesn't matter if there's no indices
+            writeFacesBinary<uint16_t>(buffer, true, writer, COLOR_ATTRIBUTE, &context->writeContext); //template param doesn't matter if there's no indices
 	}
 	return true;
 }
 
 bool CSTLMeshWriter::writeMeshASCII(const asset::ICPUMesh* mesh, SContext* context)
 {
+	auto& writer = context->writer;
+
 	// write STL MESH header
     const char headerTxt[] = "Irrlicht-baw Engine ";
 
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "solid ", context->fileOffset, 6);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, headerTxt, context->fileOffset, sizeof(headerTxt) - 1);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	writer.writeText("solid ");
+	writer.write(headerTxt, sizeof(headerTxt) - 1);
 
 	const std::string name = context->writeContext.outputFile->getFileName().filename().replace_extension().string();
 
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, name.c_str(), context->fileOffset, name.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "\n", context->fileOffset, 1);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	writer.writeText(name);
+	writer.writeText('\n');
 
 	// write mesh buffers
 	for (auto& buffer : mesh->getMeshBuffers())
 	if (buffer)
 	{
-        asset::E_INDEX_TYPE type = buffer->getIndexType();
-		if (!buffer->getIndexBufferBinding().buffer)
-            type = asset::EIT_UNKNOWN;
 		const uint32_t indexCount = buffer->getIndexCount();
-		if (type==asset::EIT_16BIT)
+		CTrianglePositionReader positionReader(buffer);
+		for (uint32_t j=0; j<indexCount; j+=3)
 		{
-            //os::Printer::log("Writing mesh with 16bit indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j]),
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j+1]),
-                    buffer->getPosition(((uint16_t*)buffer->getIndices())[j+2]),
-					context
-                );
-            }
-		}
-		else if (type==asset::EIT_32BIT)
-		{
-            //os::Printer::log("Writing mesh with 32bit indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j]),
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j+1]),
-                    buffer->getPosition(((uint32_t*)buffer->getIndices())[j+2]),
-					context
-                );
-            }
+			core::vectorSIMDf v[3];
+			positionReader.get(j, v);
+			writeFaceText(v[0], v[1], v[2], context);
 		}
-		else
-        {
-            //os::Printer::log("Writing mesh with no indices");
-            for (uint32_t j=0; j<indexCount; j+=3)
-            {
-                writeFaceText(
-                    buffer->getPosition(j),
-                    buffer->getPosition(j+1ul),
-                    buffer->getPosition(j+2ul),
-					context
-                );
-            }
-        }
 
-		{
-			system::ISystem::future_t<size_t> future;
-			context->writeContext.outputFile->write(future, "\n", context->fileOffset, 1);
-			const auto bytesWritten = future.get();
-			context->fileOffset += bytesWritten;
-		}
+		writer.writeText('\n');
 	}
 
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "endsolid ", context->fileOffset, 9);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, headerTxt, context->fileOffset, sizeof(headerTxt) - 1);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, name.c_str(), context->fileOffset, name.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	writer.writeText("endsolid ");
+	writer.write(headerTxt, sizeof(headerTxt) - 1);
+	writer.writeText(name);
 
 	return true;
 }
 
-void CSTLMeshWriter::getVectorAsStringLine(const core::vectorSIMDf& v, std::string& s) const
+void CSTLMeshWriter::writeVectorAsTextLine(const core::vectorSIMDf& v, SContext* context)
 {
-    std::ostringstream tmp;
-    tmp << v.X << " " << v.Y << " " << v.Z << "\n";
-    s = std::string(tmp.str().c_str());
+	// same text as the default `std::ostream` float formatting
+	auto& writer = context->writer;
+	writer.writeText(v.X, std::chars_format::general, 6);
+	writer.writeText(' ');
+	writer.writeText(v.Y, std::chars_format::general, 6);
+	writer.writeText(' ');
+	writer.writeText(v.Z, std::chars_format::general, 6);
+	writer.writeText('\n');
 }
 
 void CSTLMeshWriter::writeFaceText(
@@ -372,7 +295,6 @@ void CSTLMeshWriter::writeFaceText(
 	core::vectorSIMDf vertex2 = v2;
 	core::vectorSIMDf vertex3 = v1;
 	core::vectorSIMDf normal = core::plane3dSIMDf(vertex1, vertex2, vertex3).getNormal();
-	std::string tmp;
 
 	auto flipVectors = [&]()
 	{
@@ -384,91 +306,19 @@ void CSTLMeshWriter::writeFaceText(
 	
 	if (!(context->writeContext.params.flags & E_WRITER_FLAGS::EWF_MESH_IS_RIGHT_HANDED))
 		flipVectors();
-	
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "facet normal ", context->fileOffset, 13);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
 
-	getVectorAsStringLine(normal, tmp);
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, tmp.c_str(), context->fileOffset, tmp.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "  outer loop\n", context->fileOffset, 13);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "    vertex ", context->fileOffset, 11);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	getVectorAsStringLine(vertex1, tmp);
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, tmp.c_str(), context->fileOffset, tmp.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "    vertex ", context->fileOffset, 11);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	getVectorAsStringLine(vertex2, tmp);
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, tmp.c_str(), context->fileOffset, tmp.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "    vertex ", context->fileOffset, 11);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	getVectorAsStringLine(vertex3, tmp);
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, tmp.c_str(), context->fileOffset, tmp.size());
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "  endloop\n", context->fileOffset, 10);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
-
-	{
-		system::ISystem::future_t<size_t> future;
-		context->writeContext.outputFile->write(future, "endfacet\n", context->fileOffset, 9);
-		const auto bytesWritten = future.get();
-		context->fileOffset += bytesWritten;
-	}
+	auto& writer = context->writer;
+	writer.writeText("facet normal ");
+	writeVectorAsTextLine(normal, context);
+	writer.writeText("  outer loop\n");
+	writer.writeText("    vertex ");
+	writeVectorAsTextLine(vertex1, context);
+	writer.writeText("    vertex ");
+	writeVectorAsTextLine(vertex2, context);
+	writer.writeText("    vertex ");
+	writeVectorAsTextLine(vertex3, context);
+	writer.writeText("  endloop\n");
+	writer.writeText("endfacet\n");
 }
 
-#endif
+#endif
\ No newline at end of file
@@ -6,6 +6,8 @@
 #ifndef __NBL_ASSET_STL_MESH_WRITER_H_INCLUDED__
 #define __NBL_ASSET_STL_MESH_WRITER_H_INCLUDED__
 
+#include "nbl/system/CBufferedFileWriter.h"
+
 #include "nbl/asset/ICPUMesh.h"
 #include "nbl/asset/interchange/IAssetWriter.h"
 
@@ -42,7 +44,7 @@ class CSTLMeshWriter : public asset::IAssetWriter
         struct SContext
         {
             SAssetWriteContext writeContext;
-            size_t fileOffset;
+            system::CBufferedFileWriter writer;
         };
 
         // write binary format
@@ -51,8 +53,8 @@ class CSTLMeshWriter : public asset::IAssetWriter
         // write text format
         bool writeMeshASCII(const asset::ICPUMesh* mesh, SContext* context);
 
-        // create vector output with line end into string
-        void getVectorAsStringLine(const core::vectorSIMDf& v, std::string& s) const;
+        // write vector with line end
+        static void writeVectorAsTextLine(const core::vectorSIMDf& v, SContext* context);
 
         // write face information to file
         void writeFaceText(const core::vectorSIMDf& v1,
@@ -0,0 +1,153 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#ifndef __NBL_ASSET_S_NBC_FORMAT_H_INCLUDED__
+#define __NBL_ASSET_S_NBC_FORMAT_H_INCLUDED__
+
+#include "nbl/core/declarations.h"
+
+#include <cstring>
+#include <string>
+
+/**
+	NBC (Nabla Binary Cache) is the successor of the BAW format, a cache of already loaded ICPU asset DAGs.
+
+	Layout of the file:
+	- `SHeader` at offset 0
+	- blobs, every one starting at a multiple of `BlobAlignment` so uncompressed ones can be used straight out of a file mapping
+	- the blob table, `SHeader::blobCount` entries of `SBlob`
+	- the object table, `SHeader::objectCount` entries of `SObject`
+
+	Every object has a record blob with its type specific parameters, children are referenced by object index and
+	always come before their parents. Bulk payloads (buffer contents) get their own blobs which can be LZ4 compressed.
+*/
+namespace nbl::asset::nbc
+{
+
+_NBL_STATIC_INLINE_CONSTEXPR char Magic[8] = {'N','B','L','C','A','C','H','E'};
+_NBL_STATIC_INLINE_CONSTEXPR uint32_t Version = 1u;
+_NBL_STATIC_INLINE_CONSTEXPR uint64_t BlobAlignment = 64ull;
+_NBL_STATIC_INLINE_CONSTEXPR uint32_t InvalidIndex = 0xffffffffu;
+
+struct SHeader
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t objectCount;
+	uint32_t blobCount;
+	uint32_t rootObject;
+	uint64_t blobTableOffset;
+	uint64_t objectTableOffset;
+	uint8_t padding[24];
+};
+static_assert(sizeof(SHeader)==BlobAlignment);
+
+enum E_BLOB_COMPRESSION : uint32_t
+{
+	EBC_NONE = 0u,
+	EBC_LZ4 = 1u
+};
+
+struct SBlob
+{
+	uint64_t offset;
+	//! size of the blob in the file
+	uint64_t storedSize;
+	//! size after decompression
+	uint64_t size;
+	E_BLOB_COMPRESSION compression;
+	uint32_t padding;
+};
+
+struct SObject
+{
+	//! `IAsset::E_TYPE`
+	uint64_t type;
+	uint32_t recordBlob;
+	uint32_t padding;
+};
+
+//! Builds the type specific record of an object
+class CRecordWriter
+{
+	public:
+		template<typename T>
+		inline void write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			write(&value,sizeof(T));
+		}
+		inline void write(const void* data, size_t size)
+		{
+			const size_t oldSize = m_data.size();
+			m_data.resize(oldSize+size);
+			if (size)
+				memcpy(m_data.data()+oldSize,data,size);
+		}
+		inline void writeString(const std::string_view str)
+		{
+			write<uint32_t>(str.size());
+			write(str.data(),str.size());
+		}
+
+		inline const core::vector<uint8_t>& getData() const {return m_data;}
+
+	private:
+		core::vector<uint8_t> m_data;
+};
+
+//! Bounds checked reading of a record, once any read fails all subsequent ones do too
+class CRecordReader
+{
+	public:
+		CRecordReader(const void* data, size_t size) : m_data(reinterpret_cast<const uint8_t*>(data)), m_size(size), m_offset(0ull), m_failed(false) {}
+
+		template<typename T>
+		inline T read()
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			T retval = {};
+			read(&retval,sizeof(T));
+			return retval;
+		}
+		inline bool read(void* out, size_t size)
+		{
+			if (m_failed || m_offset+size>m_size)
+			{
+				m_failed = true;
+				return false;
+			}
+			if (size)
+				memcpy(out,m_data+m_offset,size);
+			m_offset += size;
+			return true;
+		}
+		inline std::string readString()
+		{
+			const uint32_t length = read<uint32_t>();
+			if (m_failed || m_offset+length>m_size)
+			{
+				m_failed = true;
+				return {};
+			}
+			std::string retval(length,'\0');
+			if (!read(retval.data(),retval.size()))
+				return {};
+			return retval;
+		}
+
+		inline bool failed() const {return m_failed;}
+		//! bytes left to read, check counts read from the record against it before allocating for them
+		inline size_t remaining() const {return m_failed ? 0ull:(m_size-m_offset);}
+
+	private:
+		const uint8_t* m_data;
+		size_t m_size;
+		size_t m_offset;
+		bool m_failed;
+};
+
+}
+
+#endif
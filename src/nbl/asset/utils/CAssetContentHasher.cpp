@@ -0,0 +1,665 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
+#include "nbl/core/xxHash256Tree.h"
+
+#include "nbl/asset/ICPUMesh.h"
+#include "nbl/asset/ICPUImageView.h"
+#include "nbl/asset/ICPUBufferView.h"
+#include "nbl/asset/ICPUDescriptorSet.h"
+#include "nbl/asset/ICPUComputePipeline.h"
+#include "nbl/asset/utils/CAssetContentHasher.h"
+
+using namespace nbl;
+using namespace nbl::asset;
+
+namespace
+{
+
+//! payloads bigger than this get hashed as a `core::CXXHash256Tree`
+constexpr size_t TreeHashMinSize = 4ull*core::CXXHash256Tree::DefaultBlockSize;
+
+template<typename T>
+inline void append(core::vector<uint8_t>& record, const T& value)
+{
+	static_assert(std::is_trivially_copyable_v<T>);
+	const auto* bytes = reinterpret_cast<const uint8_t*>(&value);
+	record.insert(record.end(), bytes, bytes+sizeof(T));
+}
+inline void append(core::vector<uint8_t>& record, const void* data, size_t size)
+{
+	const auto* bytes = reinterpret_cast<const uint8_t*>(data);
+	record.insert(record.end(), bytes, bytes+size);
+}
+inline void appendBoundingBox(core::vector<uint8_t>& record, const core::aabbox3df& box)
+{
+	const float extremes[6] = {box.MinEdge.X,box.MinEdge.Y,box.MinEdge.Z,box.MaxEdge.X,box.MaxEdge.Y,box.MaxEdge.Z};
+	append(record, extremes);
+}
+
+// the parameter structs below have bitfields and padding whose bits are never written, so they get appended field by field
+inline void appendSamplerParams(core::vector<uint8_t>& record, const ICPUSampler::SParams& params)
+{
+	append<uint8_t>(record, params.TextureWrapU);
+	append<uint8_t>(record, params.TextureWrapV);
+	append<uint8_t>(record, params.TextureWrapW);
+	append<uint8_t>(record, params.BorderColor);
+	append<uint8_t>(record, params.MinFilter);
+	append<uint8_t>(record, params.MaxFilter);
+	append<uint8_t>(record, params.MipmapMode);
+	append<uint8_t>(record, params.AnisotropicFilter);
+	append<uint8_t>(record, params.CompareEnable);
+	append<uint8_t>(record, params.CompareFunc);
+	append(record, params.LodBias);
+	append(record, params.MinLod);
+	append(record, params.MaxLod);
+}
+inline void appendBufferCopy(core::vector<uint8_t>& record, const IImage::SBufferCopy& region)
+{
+	append<uint64_t>(record, region.bufferOffset);
+	append(record, region.bufferRowLength);
+	append(record, region.bufferImageHeight);
+	append(record, region.imageSubresource.aspectMask);
+	append(record, region.imageSubresource.mipLevel);
+	append(record, region.imageSubresource.baseArrayLayer);
+	append(record, region.imageSubresource.layerCount);
+	append(record, region.imageOffset.x);
+	append(record, region.imageOffset.y);
+	append(record, region.imageOffset.z);
+	append(record, region.imageExtent.width);
+	append(record, region.imageExtent.height);
+	append(record, region.imageExtent.depth);
+}
+inline void appendVertexInputParams(core::vector<uint8_t>& record, const SVertexInputParams& params)
+{
+	append(record, params.enabledAttribFlags);
+	append(record, params.enabledBindingFlags);
+	for (const auto& attribute : params.attributes)
+	{
+		append<uint32_t>(record, attribute.binding);
+		append<uint32_t>(record, attribute.format);
+		append<uint32_t>(record, attribute.relativeOffset);
+	}
+	for (const auto& binding : params.bindings)
+	{
+		append(record, binding.stride);
+		append(record, binding.inputRate);
+	}
+}
+inline void appendBlendParams(core::vector<uint8_t>& record, const SBlendParams& params)
+{
+	append<uint8_t>(record, params.logicOpEnable);
+	append<uint8_t>(record, params.logicOp);
+	for (const auto& attachment : params.blendParams)
+	{
+		append<uint8_t>(record, attachment.blendEnable);
+		append<uint8_t>(record, attachment.srcColorFactor);
+		append<uint8_t>(record, attachment.dstColorFactor);
+		append<uint8_t>(record, attachment.colorBlendOp);
+		append<uint8_t>(record, attachment.srcAlphaFactor);
+		append<uint8_t>(record, attachment.dstAlphaFactor);
+		append<uint8_t>(record, attachment.alphaBlendOp);
+		append<uint8_t>(record, attachment.colorWriteMask);
+	}
+}
+inline void appendPrimitiveAssemblyParams(core::vector<uint8_t>& record, const SPrimitiveAssemblyParams& params)
+{
+	append(record, params.primitiveType);
+	append(record, params.primitiveRestartEnable);
+	append(record, params.tessPatchVertCount);
+}
+inline void appendStencilOpParams(core::vector<uint8_t>& record, const SStencilOpParams& params)
+{
+	append(record, params.failOp);
+	append(record, params.passOp);
+	append(record, params.depthFailOp);
+	append(record, params.compareOp);
+	append(record, params.writeMask);
+	append(record, params.reference);
+}
+inline void appendRasterizationParams(core::vector<uint8_t>& record, const SRasterizationParams& params)
+{
+	append(record, params.viewportCount);
+	append(record, params.polygonMode);
+	append(record, params.faceCullingMode);
+	append(record, params.depthCompareOp);
+	append(record, params.rasterizationSamplesHint);
+	append(record, params.sampleMask);
+	append(record, params.minSampleShading);
+	append(record, params.depthBiasSlopeFactor);
+	append(record, params.depthBiasConstantFactor);
+	appendStencilOpParams(record, params.frontStencilOps);
+	appendStencilOpParams(record, params.backStencilOps);
+	append<uint8_t>(record, params.depthClampEnable);
+	append<uint8_t>(record, params.rasterizerDiscard);
+	append<uint8_t>(record, params.frontFaceIsCCW);
+	append<uint8_t>(record, params.depthBiasEnable);
+	append<uint8_t>(record, params.sampleShadingEnable);
+	append<uint8_t>(record, params.alphaToCoverageEnable);
+	append<uint8_t>(record, params.alphaToOneEnable);
+	append<uint8_t>(record, params.depthTestEnable);
+	append<uint8_t>(record, params.depthWriteEnable);
+	append<uint8_t>(record, params.depthBoundsTestEnable);
+	append<uint8_t>(record, params.stencilTestEnable);
+}
+
+inline const IAsset* descriptorToAsset(const IDescriptor* descriptor)
+{
+	if (descriptor)
+	switch (descriptor->getTypeCategory())
+	{
+		case IDescriptor::EC_BUFFER:
+			return static_cast<const ICPUBuffer*>(descriptor);
+		case IDescriptor::EC_IMAGE:
+			return static_cast<const ICPUImageView*>(descriptor);
+		case IDescriptor::EC_BUFFER_VIEW:
+			return static_cast<const ICPUBufferView*>(descriptor);
+		default:
+			break;
+	}
+	return nullptr;
+}
+
+inline uint32_t getDescriptorSetBindingCount(const ICPUDescriptorSet* ds)
+{
+	return ds->getLayout()->getBindings().size() ? (ds->getMaxDescriptorBindingIndex()+1u):0u;
+}
+
+//! redirects the references of a mutable `asset` from `children` (as returned by `getChildren`) to `replacements`
+uint32_t rewireChildren(IAsset* asset, const core::vector<const IAsset*>& children, const core::vector<core::smart_refctd_ptr<IAsset>>& replacements)
+{
+	uint32_t rewired = 0u;
+	auto needsRewire = [&](const uint32_t ix) -> bool
+	{
+		if (!children[ix] || replacements[ix].get()==children[ix])
+			return false;
+		rewired++;
+		return true;
+	};
+	switch (asset->getAssetType())
+	{
+		case IAsset::ET_IMAGE:
+		{
+			auto* image = static_cast<ICPUImage*>(asset);
+			const auto regions = image->getRegions();
+			if (regions.size() && needsRewire(0u))
+			{
+				auto newRegions = core::make_refctd_dynamic_array<core::smart_refctd_dynamic_array<IImage::SBufferCopy>>(regions.size());
+				std::copy(regions.begin(), regions.end(), newRegions->begin());
+				image->setBufferAndRegions(core::smart_refctd_ptr_static_cast<ICPUBuffer>(replacements[0]), newRegions);
+			}
+			break;
+		}
+		case IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE:
+		{
+			auto* pipeline = static_cast<ICPURenderpassIndependentPipeline*>(asset);
+			if (needsRewire(0u))
+				pipeline->setLayout(core::smart_refctd_ptr_static_cast<ICPUPipelineLayout>(replacements[0]));
+			for (uint32_t i=0u; i<ICPURenderpassIndependentPipeline::SHADER_STAGE_COUNT; i++)
+			if (needsRewire(i+1u))
+				pipeline->setShaderAtIndex(i, static_cast<ICPUSpecializedShader*>(replacements[i+1u].get()));
+			break;
+		}
+		case IAsset::ET_COMPUTE_PIPELINE:
+		{
+			auto* pipeline = static_cast<ICPUComputePipeline*>(asset);
+			if (needsRewire(0u))
+				pipeline->setLayout(core::smart_refctd_ptr_static_cast<ICPUPipelineLayout>(replacements[0]));
+			if (needsRewire(1u))
+				pipeline->setShader(static_cast<ICPUSpecializedShader*>(replacements[1].get()));
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET:
+		{
+			auto* ds = static_cast<ICPUDescriptorSet*>(asset);
+			// child 0 is the layout, which can't be swapped out
+			uint32_t ix = 1u;
+			const uint32_t bindingCount = getDescriptorSetBindingCount(ds);
+			for (uint32_t b=0u; b<bindingCount; b++)
+			for (auto& info : ds->getDescriptors(b))
+			{
+				if (needsRewire(ix))
+				{
+					if (info.desc->getTypeCategory()==IDescriptor::EC_IMAGE)
+						info.desc = core::smart_refctd_ptr_static_cast<ICPUImageView>(replacements[ix]);
+					else if (info.desc->getTypeCategory()==IDescriptor::EC_BUFFER_VIEW)
+						info.desc = core::smart_refctd_ptr_static_cast<ICPUBufferView>(replacements[ix]);
+					else
+						info.desc = core::smart_refctd_ptr_static_cast<ICPUBuffer>(replacements[ix]);
+				}
+				if (needsRewire(ix+1u))
+					info.image.sampler = core::smart_refctd_ptr_static_cast<ICPUSampler>(replacements[ix+1u]);
+				ix += 2u;
+			}
+			break;
+		}
+		case IAsset::ET_SUB_MESH:
+		{
+			auto* meshbuffer = static_cast<ICPUMeshBuffer*>(asset);
+			if (needsRewire(0u))
+				meshbuffer->setPipeline(core::smart_refctd_ptr_static_cast<ICPURenderpassIndependentPipeline>(replacements[0]));
+			if (needsRewire(1u))
+				meshbuffer->setAttachedDescriptorSet(core::smart_refctd_ptr_static_cast<ICPUDescriptorSet>(replacements[1]));
+			for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+			if (needsRewire(i+2u))
+				meshbuffer->setVertexBufferBinding({meshbuffer->getVertexBufferBindings()[i].offset,core::smart_refctd_ptr_static_cast<ICPUBuffer>(replacements[i+2u])}, i);
+			if (needsRewire(ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT+2u))
+				meshbuffer->setIndexBufferBinding({meshbuffer->getIndexBufferBinding().offset,core::smart_refctd_ptr_static_cast<ICPUBuffer>(replacements[ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT+2u])});
+			// skinning buffers can only be set all at once together with the skeleton, leave them be
+			break;
+		}
+		case IAsset::ET_MESH:
+		{
+			auto& meshbuffers = static_cast<ICPUMesh*>(asset)->getMeshBufferVector();
+			for (uint32_t i=0u; i<meshbuffers.size(); i++)
+			if (needsRewire(i))
+				meshbuffers[i] = core::smart_refctd_ptr_static_cast<ICPUMeshBuffer>(replacements[i]);
+			break;
+		}
+		default:
+			break;
+	}
+	return rewired;
+}
+
+}
+
+void CAssetContentHasher::getChildren(const IAsset* asset, core::vector<const IAsset*>& children)
+{
+	switch (asset->getAssetType())
+	{
+		case IAsset::ET_BUFFER_VIEW:
+			children.push_back(static_cast<const ICPUBufferView*>(asset)->getUnderlyingBuffer());
+			break;
+		case IAsset::ET_IMAGE:
+			children.push_back(static_cast<const ICPUImage*>(asset)->getBuffer());
+			break;
+		case IAsset::ET_IMAGE_VIEW:
+			children.push_back(static_cast<const ICPUImageView*>(asset)->getCreationParameters().image.get());
+			break;
+		case IAsset::ET_SHADER:
+			children.push_back(static_cast<const ICPUShader*>(asset)->getSPVorGLSL());
+			break;
+		case IAsset::ET_SPECIALIZED_SHADER:
+		{
+			const auto* shader = static_cast<const ICPUSpecializedShader*>(asset);
+			children.push_back(shader->getUnspecialized());
+			children.push_back(shader->getSpecializationInfo().getBackingBuffer());
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET_LAYOUT:
+		{
+			for (const auto& binding : static_cast<const ICPUDescriptorSetLayout*>(asset)->getBindings())
+			if (binding.samplers)
+			for (uint32_t s=0u; s<binding.count; s++)
+				children.push_back(binding.samplers[s].get());
+			break;
+		}
+		case IAsset::ET_PIPELINE_LAYOUT:
+		{
+			const auto* layout = static_cast<const ICPUPipelineLayout*>(asset);
+			for (uint32_t i=0u; i<ICPUPipelineLayout::DESCRIPTOR_SET_COUNT; i++)
+				children.push_back(layout->getDescriptorSetLayout(i));
+			break;
+		}
+		case IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE:
+		{
+			const auto* pipeline = static_cast<const ICPURenderpassIndependentPipeline*>(asset);
+			children.push_back(pipeline->getLayout());
+			for (uint32_t i=0u; i<ICPURenderpassIndependentPipeline::SHADER_STAGE_COUNT; i++)
+				children.push_back(pipeline->getShaderAtIndex(i));
+			break;
+		}
+		case IAsset::ET_COMPUTE_PIPELINE:
+		{
+			const auto* pipeline = static_cast<const ICPUComputePipeline*>(asset);
+			children.push_back(pipeline->getLayout());
+			children.push_back(pipeline->getShader());
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET:
+		{
+			const auto* ds = static_cast<const ICPUDescriptorSet*>(asset);
+			children.push_back(ds->getLayout());
+			const uint32_t bindingCount = getDescriptorSetBindingCount(ds);
+			for (uint32_t b=0u; b<bindingCount; b++)
+			for (const auto& info : ds->getDescriptors(b))
+			{
+				const IAsset* descriptor = descriptorToAsset(info.desc.get());
+				children.push_back(descriptor);
+				const bool isImage = descriptor && descriptor->getAssetType()==IAsset::ET_IMAGE_VIEW;
+				children.push_back(isImage ? info.image.sampler.get():nullptr);
+			}
+			break;
+		}
+		case IAsset::ET_SUB_MESH:
+		{
+			const auto* meshbuffer = static_cast<const ICPUMeshBuffer*>(asset);
+			children.push_back(meshbuffer->getPipeline());
+			children.push_back(meshbuffer->getAttachedDescriptorSet());
+			for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+				children.push_back(meshbuffer->getVertexBufferBindings()[i].buffer.get());
+			children.push_back(meshbuffer->getIndexBufferBinding().buffer.get());
+			children.push_back(meshbuffer->getInverseBindPoseBufferBinding().buffer.get());
+			children.push_back(meshbuffer->getJointAABBBufferBinding().buffer.get());
+			break;
+		}
+		case IAsset::ET_MESH:
+		{
+			for (const auto* meshbuffer : static_cast<const ICPUMesh*>(asset)->getMeshBuffers())
+				children.push_back(meshbuffer);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void CAssetContentHasher::appendParams(const IAsset* asset, core::vector<uint8_t>& record) const
+{
+	append(record, asset->getAssetType());
+	switch (asset->getAssetType())
+	{
+		case IAsset::ET_BUFFER:
+		{
+			const auto* buffer = static_cast<const ICPUBuffer*>(asset);
+			append<uint64_t>(record, buffer->getSize());
+			append<uint32_t>(record, buffer->getUsageFlags().value);
+			append<uint8_t>(record, buffer->getCanUpdateSubRange());
+			append(record, m_payloadHashes.find(asset)->second);
+			break;
+		}
+		case IAsset::ET_BUFFER_VIEW:
+		{
+			const auto* view = static_cast<const ICPUBufferView*>(asset);
+			append(record, view->getFormat());
+			append<uint64_t>(record, view->getOffsetInBuffer());
+			append<uint64_t>(record, view->getByteSize());
+			break;
+		}
+		case IAsset::ET_SAMPLER:
+			appendSamplerParams(record, static_cast<const ICPUSampler*>(asset)->getParams());
+			break;
+		case IAsset::ET_IMAGE:
+		{
+			const auto* image = static_cast<const ICPUImage*>(asset);
+			const auto& params = image->getCreationParameters();
+			append(record, params.flags);
+			append(record, params.type);
+			append(record, params.format);
+			append(record, params.extent);
+			append(record, params.mipLevels);
+			append(record, params.arrayLayers);
+			append(record, params.samples);
+			append(record, params.tiling);
+			append<uint32_t>(record, params.usage.value);
+			append(record, params.initialLayout);
+			const auto regions = image->getRegions();
+			append<uint32_t>(record, regions.size());
+			for (const auto& region : regions)
+				appendBufferCopy(record, region);
+			break;
+		}
+		case IAsset::ET_IMAGE_VIEW:
+		{
+			const auto& params = static_cast<const ICPUImageView*>(asset)->getCreationParameters();
+			append(record, params.flags);
+			append(record, params.viewType);
+			append(record, params.format);
+			append(record, params.components);
+			append(record, params.subresourceRange);
+			break;
+		}
+		case IAsset::ET_SHADER:
+		{
+			const auto* shader = static_cast<const ICPUShader*>(asset);
+			append<uint8_t>(record, shader->containsGLSL());
+			append(record, shader->getStage());
+			// relative includes of GLSL are resolved against the path, SPIR-V doesn't care where it came from
+			if (shader->containsGLSL())
+			{
+				const auto hint = shader->getFilepathHint();
+				append(record, hint.data(), hint.size());
+			}
+			break;
+		}
+		case IAsset::ET_SPECIALIZED_SHADER:
+		{
+			const auto& info = static_cast<const ICPUSpecializedShader*>(asset)->getSpecializationInfo();
+			append<uint32_t>(record, info.entryPoint.size());
+			append(record, info.entryPoint.data(), info.entryPoint.size());
+			if (const auto* entries = info.getEntries())
+				append(record, entries->data(), entries->size()*sizeof(ISpecializedShader::SInfo::SMapEntry));
+			break;
+		}
+		case IAsset::ET_DESCRIPTOR_SET_LAYOUT:
+		{
+			for (const auto& binding : static_cast<const ICPUDescriptorSetLayout*>(asset)->getBindings())
+			{
+				append(record, binding.binding);
+				append(record, binding.type);
+				append(record, binding.count);
+				append(record, binding.stageFlags);
+				append<uint8_t>(record, binding.samplers!=nullptr);
+			}
+			break;
+		}
+		case IAsset::ET_PIPELINE_LAYOUT:
+		{
+			const auto ranges = static_cast<const ICPUPipelineLayout*>(asset)->getPushConstantRanges();
+			append(record, ranges.begin(), ranges.size()*sizeof(SPushConstantRange));
+			break;
+		}
+		case IAsset::ET_RENDERPASS_INDEPENDENT_PIPELINE:
+		{
+			const auto* pipeline = static_cast<const ICPURenderpassIndependentPipeline*>(asset);
+			appendVertexInputParams(record, pipeline->getVertexInputParams());
+			appendBlendParams(record, pipeline->getBlendParams());
+			appendPrimitiveAssemblyParams(record, pipeline->getPrimitiveAssemblyParams());
+			appendRasterizationParams(record, pipeline->getRasterizationParams());
+			break;
+		}
+		case IAsset::ET_COMPUTE_PIPELINE:
+			break;
+		case IAsset::ET_DESCRIPTOR_SET:
+		{
+			const auto* ds = static_cast<const ICPUDescriptorSet*>(asset);
+			const uint32_t bindingCount = getDescriptorSetBindingCount(ds);
+			append(record, bindingCount);
+			for (uint32_t b=0u; b<bindingCount; b++)
+			{
+				const auto descriptors = ds->getDescriptors(b);
+				append<uint32_t>(record, descriptors.size());
+				for (const auto& info : descriptors)
+				{
+					if (!info.desc)
+					{
+						append<uint32_t>(record, ~0u);
+						continue;
+					}
+					const auto category = info.desc->getTypeCategory();
+					append(record, category);
+					switch (category)
+					{
+						case IDescriptor::EC_BUFFER:
+							append<uint64_t>(record, info.buffer.offset);
+							append<uint64_t>(record, info.buffer.size);
+							break;
+						case IDescriptor::EC_IMAGE:
+							append(record, info.image.imageLayout);
+							break;
+						case IDescriptor::EC_BUFFER_VIEW:
+							break;
+						default:
+							// not an asset, so we can't look inside
+							append(record, info.desc.get());
+							break;
+					}
+				}
+			}
+			break;
+		}
+		case IAsset::ET_SUB_MESH:
+		{
+			const auto* meshbuffer = static_cast<const ICPUMeshBuffer*>(asset);
+			for (uint32_t i=0u; i<ICPUMeshBuffer::MAX_ATTR_BUF_BINDING_COUNT; i++)
+				append<uint64_t>(record, meshbuffer->getVertexBufferBindings()[i].offset);
+			append<uint64_t>(record, meshbuffer->getIndexBufferBinding().offset);
+			append<uint64_t>(record, meshbuffer->getInverseBindPoseBufferBinding().offset);
+			append<uint64_t>(record, meshbuffer->getJointAABBBufferBinding().offset);
+			append(record, meshbuffer->getIndexType());
+			append<uint32_t>(record, meshbuffer->getIndexCount());
+			append<uint32_t>(record, meshbuffer->getInstanceCount());
+			append<int32_t>(record, meshbuffer->getBaseVertex());
+			append<uint32_t>(record, meshbuffer->getBaseInstance());
+			append<uint32_t>(record, meshbuffer->getPositionAttributeIx());
+			append<uint32_t>(record, meshbuffer->getNormalAttributeIx());
+			append<uint32_t>(record, meshbuffer->getJointIDAttributeIx());
+			append<uint32_t>(record, meshbuffer->getJointWeightAttributeIx());
+			append<uint32_t>(record, meshbuffer->getJointCount());
+			append<uint32_t>(record, meshbuffer->getMaxJointsPerVertex());
+			appendBoundingBox(record, meshbuffer->getBoundingBox());
+			break;
+		}
+		case IAsset::ET_MESH:
+			appendBoundingBox(record, static_cast<const ICPUMesh*>(asset)->getBoundingBox());
+			break;
+		default:
+			// unknown types only ever equal themselves
+			append(record, asset);
+			break;
+	}
+}
+
+void CAssetContentHasher::hashPayloads(const IAsset* const* roots, const size_t rootCount)
+{
+	// gather every buffer we haven't hashed yet
+	core::vector<const ICPUBuffer*> buffers;
+	{
+		core::unordered_set<const IAsset*> visited;
+		core::vector<const IAsset*> stack(roots, roots+rootCount);
+		while (!stack.empty())
+		{
+			const IAsset* asset = stack.back();
+			stack.pop_back();
+			if (!asset || m_hashes.find(asset)!=m_hashes.end() || !visited.insert(asset).second)
+				continue;
+			if (asset->getAssetType()==IAsset::ET_BUFFER && m_payloadHashes.find(asset)==m_payloadHashes.end())
+				buffers.push_back(static_cast<const ICPUBuffer*>(asset));
+			getChildren(asset, stack);
+		}
+	}
+
+	// the payloads are the only part of the hashing that scales with the data size, so do them in parallel
+	core::vector<hash_t> hashes(buffers.size());
+	core::for_each(core::execution::par_unseq, buffers.begin(), buffers.end(), [&](const ICPUBuffer*& buffer) -> void
+	{
+		const size_t ix = &buffer-buffers.data();
+		// a single big buffer would otherwise keep one core busy while the rest idle
+		if (buffer->getSize()>TreeHashMinSize)
+			hashes[ix] = core::CXXHash256Tree().hash(buffer->getPointer(), buffer->getSize());
+		else
+			core::XXHash_256(buffer->getPointer(), buffer->getSize(), hashes[ix].data());
+	});
+	for (size_t i=0u; i<buffers.size(); i++)
+		m_payloadHashes.emplace(buffers[i], hashes[i]);
+}
+
+auto CAssetContentHasher::merkleHash(const IAsset* asset) -> const hash_t&
+{
+	static const hash_t nullHash = {};
+	if (!asset)
+		return nullHash;
+
+	auto found = m_hashes.find(asset);
+	if (found!=m_hashes.end())
+		return found->second.hash;
+
+	core::vector<uint8_t> record;
+	appendParams(asset, record);
+	core::vector<const IAsset*> children;
+	getChildren(asset, children);
+	for (const auto* child : children)
+		append(record, merkleHash(child));
+
+	SCachedHash entry = {core::smart_refctd_ptr<const IAsset>(asset)};
+	core::XXHash_256(record.data(), record.size(), entry.hash.data());
+	return m_hashes.emplace(asset, std::move(entry)).first->second.hash;
+}
+
+auto CAssetContentHasher::hash(const IAsset* asset) -> const hash_t&
+{
+	hashPayloads(&asset, 1u);
+	return merkleHash(asset);
+}
+
+core::smart_refctd_ptr<IAsset> CAssetContentHasher::deduplicate(IAsset* asset, core::unordered_map<const IAsset*,core::smart_refctd_ptr<IAsset>>& canonical,
+	core::unordered_map<hash_t,core::smart_refctd_ptr<IAsset>,SHashHasher>& firstOfHash, SDeduplicationStats& stats)
+{
+	if (!asset)
+		return nullptr;
+	auto found = canonical.find(asset);
+	if (found!=canonical.end())
+		return found->second;
+	stats.visitedAssets++;
+
+	// children first, so parents get rewired to already deduplicated children
+	core::vector<const IAsset*> children;
+	getChildren(asset, children);
+	core::vector<core::smart_refctd_ptr<IAsset>> replacements(children.size());
+	for (size_t i=0u; i<children.size(); i++)
+		replacements[i] = deduplicate(const_cast<IAsset*>(children[i]), canonical, firstOfHash, stats);
+	if (asset->isMutable())
+		stats.rewiredReferences += rewireChildren(asset, children, replacements);
+
+	// rewiring doesn't change the hash, equal children hash the same by definition
+	const auto& h = merkleHash(asset);
+	auto inserted = firstOfHash.emplace(h, core::smart_refctd_ptr<IAsset>(asset));
+	if (!inserted.second)
+	{
+		stats.duplicateAssets++;
+		if (asset->getAssetType()==IAsset::ET_BUFFER)
+			stats.duplicateBufferBytes += static_cast<const ICPUBuffer*>(asset)->getSize();
+	}
+	return canonical.emplace(asset, inserted.first->second).first->second;
+}
+
+auto CAssetContentHasher::deduplicate(core::smart_refctd_ptr<IAsset>* const begin, core::smart_refctd_ptr<IAsset>* const end) -> SDeduplicationStats
+{
+	core::vector<const IAsset*> roots;
+	for (auto it=begin; it!=end; it++)
+		roots.push_back(it->get());
+	hashPayloads(roots.data(), roots.size());
+
+	SDeduplicationStats stats;
+	stats.reachableBufferBytesBefore = getReachableBufferBytes(begin, end);
+	core::unordered_map<const IAsset*,core::smart_refctd_ptr<IAsset>> canonical;
+	core::unordered_map<hash_t,core::smart_refctd_ptr<IAsset>,SHashHasher> firstOfHash;
+	for (auto it=begin; it!=end; it++)
+		*it = deduplicate(it->get(), canonical, firstOfHash, stats);
+	stats.reachableBufferBytesAfter = getReachableBufferBytes(begin, end);
+	return stats;
+}
+
+uint64_t CAssetContentHasher::getReachableBufferBytes(const core::smart_refctd_ptr<IAsset>* const begin, const core::smart_refctd_ptr<IAsset>* const end)
+{
+	uint64_t bytes = 0ull;
+	core::unordered_set<const IAsset*> visited;
+	core::vector<const IAsset*> stack;
+	for (auto it=begin; it!=end; it++)
+		stack.push_back(it->get());
+	while (!stack.empty())
+	{
+		const IAsset* asset = stack.back();
+		stack.pop_back();
+		if (!asset || !visited.insert(asset).second)
+			continue;
+		if (asset->getAssetType()==IAsset::ET_BUFFER)
+			bytes += static_cast<const ICPUBuffer*>(asset)->getSize();
+		getChildren(asset, stack);
+	}
+	return bytes;
+}
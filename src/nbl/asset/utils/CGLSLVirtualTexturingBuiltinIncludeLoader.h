@@ -67,14 +67,13 @@ class CGLSLVirtualTexturingBuiltinIncludeLoader : public IGLSLEmbeddedIncludeLoa
 		}
 
 	protected:
-		core::vector<std::pair<std::regex, HandleFunc_t>> getBuiltinNamesToFunctionMapping() const override
+		core::vector<SBuiltinPattern> getBuiltinNamesToFunctionMapping() const override
 		{
 			auto retval = IGLSLEmbeddedIncludeLoader::getBuiltinNamesToFunctionMapping();
 
-			const std::string num = "[0-9]+";
 			retval.insert(retval.begin(),
 				{ 
-					std::regex{"glsl/virtual_texturing/functions\\.glsl/"+num+"/"+num},
+					"glsl/virtual_texturing/functions.glsl",2u,
 					&getVTfunctions
 				}
 			);
@@ -5,17 +5,57 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <numeric>
 
+#include "nbl/core/execution.h"
 #include "nbl/asset/utils/CGeometryCreator.h"
 #include "nbl/asset/utils/CQuantNormalCache.h"
+#include "nbl/asset/utils/CMeshManipulator.h"
 
 namespace nbl
 {
 namespace asset
 {
 
-CGeometryCreator::CGeometryCreator(IMeshManipulator* const _defaultMeshManipulator) 
-	: defaultMeshManipulator(_defaultMeshManipulator)
+namespace
+{
+//! cosines and sines of `(first+i)*step` for a whole ring, computed once for every shape instead of once for every vertex
+struct SRing
+{
+	SRing(const uint32_t count, const double step, const uint32_t first = 0u) : cos(count), sin(count)
+	{
+		for (uint32_t i = 0u; i < count; i++)
+		{
+			const double angle = double(first + i) * step;
+			cos[i] = std::cos(angle);
+			sin[i] = std::sin(angle);
+		}
+	}
+
+	core::vector<double> cos, sin;
+};
+
+//! below this many vertices the threads cost more than they save
+constexpr size_t ParallelVertexThreshold = 0x1u << 16u;
+
+//! calls `f` for every row, in parallel when the rows have `vertexCount` vertices between them
+template<typename F>
+void forEachRow(const uint32_t rowCount, const size_t vertexCount, F&& f)
+{
+	if (vertexCount < ParallelVertexThreshold)
+	{
+		for (uint32_t i = 0u; i < rowCount; i++)
+			f(i);
+		return;
+	}
+	core::vector<uint32_t> rows(rowCount);
+	std::iota(rows.begin(), rows.end(), 0u);
+	core::for_each(core::execution::par_unseq, rows.begin(), rows.end(), f);
+}
+}
+
+CGeometryCreator::CGeometryCreator(IMeshManipulator* const _defaultMeshManipulator, std::function<void(IAsset*)>&& _makeImmutable)
+	: defaultMeshManipulator(_defaultMeshManipulator), cacheMeshManipulator(core::make_smart_refctd_ptr<CMeshManipulator>()), makeImmutable(std::move(_makeImmutable))
 {
 	if (defaultMeshManipulator == nullptr)
 	{
@@ -166,8 +206,8 @@ CGeometryCreator::return_type CGeometryCreator::createArrowMesh(const uint32_t t
 {
     assert(height > cylinderHeight);
 
-    auto cylinder = createCylinderMesh(width0, cylinderHeight, tesselationCylinder, vtxColor0);
-    auto cone = createConeMesh(width1, height-cylinderHeight, tesselationCone, vtxColor1, vtxColor1);
+    auto cylinder = createCylinderMesh(width0, cylinderHeight, tesselationCylinder, vtxColor0, meshManipulatorOverride);
+    auto cone = createConeMesh(width1, height-cylinderHeight, tesselationCone, vtxColor1, vtxColor1, 0.f, meshManipulatorOverride);
 
 	auto cylinderVertices = reinterpret_cast<CylinderVertex*>(cylinder.bindings[0].buffer->getPointer());
 	auto coneVertices = reinterpret_cast<ConeVertex*>(cone.bindings[0].buffer->getPointer());
@@ -269,40 +309,84 @@ CGeometryCreator::return_type CGeometryCreator::createSphereMesh(float radius, u
 		polyCountY = 2;
 
 	const uint32_t polyCountXPitch = polyCountX + 1; // get to same vertex on next level
+	const size_t vertexCount = (polyCountXPitch * polyCountY) + 2;
 
 	retval.indexCount = (polyCountX * polyCountY) * 6;
 	auto indices = core::make_smart_refctd_ptr<asset::ICPUBuffer>(sizeof(uint32_t) * retval.indexCount);
+	auto vtxBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexCount * vertexSize);
+	uint32_t* indexPtr = reinterpret_cast<uint32_t*>(indices->getPointer());
+	SphereVertex* vertices = reinterpret_cast<SphereVertex*>(vtxBuf->getPointer());
 
-	// Create indices
+	// the trigonometry only depends on the column or on the ring, we don't start at 0
+	const SRing columns(polyCountX, 2.0 * core::PI<double>() / polyCountX);
+	const SRing rings(polyCountY, core::PI<double>() / polyCountY, 1u);
+
+	// every ring of vertices and the quads below it are independent of the others
+	auto generateRing = [&](const uint32_t y) -> void
 	{
-		uint32_t level = 0;
-		size_t indexAddIx = 0;
-		uint32_t* indexPtr = (uint32_t*)indices->getPointer();
-		for (uint32_t p1 = 0; p1 < polyCountY - 1; ++p1)
+		const double sinay = rings.sin[y];
+		const float cosay = static_cast<float>(rings.cos[y]);
+		// texture coordinates via sphere mapping, which pinches the poles to the middle
+		const bool pole = cosay == -1.f || cosay == 1.f;
+		const float tv = static_cast<float>(double(y + 1u) / polyCountY);
+
+		// calculate the necessary vertices without the doubled one
+		SphereVertex* ring = vertices + y * polyCountXPitch;
+		for (uint32_t xz = 0; xz < polyCountX; ++xz)
 		{
-			//main quads, top to bottom
-			for (uint32_t p2 = 0; p2 < polyCountX - 1; ++p2)
-			{
-				const uint32_t curr = level + p2;
-				indexPtr[indexAddIx++] = curr + polyCountXPitch;
-				indexPtr[indexAddIx++] = curr;
-				indexPtr[indexAddIx++] = curr + 1;
-				indexPtr[indexAddIx++] = curr + polyCountXPitch;
-				indexPtr[indexAddIx++] = curr + 1;
-				indexPtr[indexAddIx++] = curr + 1 + polyCountXPitch;
-			}
+			SphereVertex& vertex = ring[xz];
+			vertex.pos[0] = static_cast<float>(columns.cos[xz] * sinay) * radius;
+			vertex.pos[1] = cosay * radius;
+			vertex.pos[2] = static_cast<float>(columns.sin[xz] * sinay) * radius;
+			memset(vertex.color, 255, sizeof(vertex.color));
+			vertex.uv[0] = pole ? 0.5f : static_cast<float>(double(xz) / polyCountX);
+			vertex.uv[1] = tv;
+		}
+		// This is the doubled vertex on the initial position, it gets its normal with the others
+		ring[polyCountX] = ring[0];
+		ring[polyCountX].uv[0] = 1.f;
+
+		if (y + 1u == polyCountY)
+			return;
+		//main quads, top to bottom
+		const uint32_t level = y * polyCountXPitch;
+		uint32_t* rowIndices = indexPtr + size_t(y) * polyCountX * 6u;
+		for (uint32_t p2 = 0; p2 < polyCountX - 1; ++p2)
+		{
+			const uint32_t curr = level + p2;
+			*(rowIndices++) = curr + polyCountXPitch;
+			*(rowIndices++) = curr;
+			*(rowIndices++) = curr + 1;
+			*(rowIndices++) = curr + polyCountXPitch;
+			*(rowIndices++) = curr + 1;
+			*(rowIndices++) = curr + 1 + polyCountXPitch;
+		}
 
-			// the connectors from front to end
-			indexPtr[indexAddIx++] = level + polyCountX - 1 + polyCountXPitch;
-			indexPtr[indexAddIx++] = level + polyCountX - 1;
-			indexPtr[indexAddIx++] = level + polyCountX;
+		// the connectors from front to end
+		*(rowIndices++) = level + polyCountX - 1 + polyCountXPitch;
+		*(rowIndices++) = level + polyCountX - 1;
+		*(rowIndices++) = level + polyCountX;
 
-			indexPtr[indexAddIx++] = level + polyCountX - 1 + polyCountXPitch;
-			indexPtr[indexAddIx++] = level + polyCountX;
-			indexPtr[indexAddIx++] = level + polyCountX + polyCountXPitch;
-			level += polyCountXPitch;
-		}
+		*(rowIndices++) = level + polyCountX - 1 + polyCountXPitch;
+		*(rowIndices++) = level + polyCountX;
+		*(rowIndices++) = level + polyCountX + polyCountXPitch;
+	};
+	forEachRow(polyCountY, vertexCount, generateRing);
 
+	// the quantization cache is not thread safe, for spheres the normal is the position
+	for (uint32_t y = 0; y < polyCountY; ++y)
+	{
+		SphereVertex* ring = vertices + y * polyCountXPitch;
+		for (uint32_t xz = 0; xz < polyCountX; ++xz)
+			ring[xz].normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::vectorSIMDf(
+				static_cast<float>(columns.cos[xz] * rings.sin[y]), static_cast<float>(rings.cos[y]), static_cast<float>(columns.sin[xz] * rings.sin[y])
+			));
+		ring[polyCountX].normal = ring[0].normal;
+	}
+
+	// Create the indices of the caps
+	{
+		size_t indexAddIx = size_t(polyCountY - 1) * polyCountX * 6u;
 		const uint32_t polyCountSq = polyCountXPitch * polyCountY; // top point
 		const uint32_t polyCountSq1 = polyCountSq + 1; // bottom point
 		const uint32_t polyCountSqM1 = (polyCountY - 1) * polyCountXPitch; // last row's first vertex
@@ -337,115 +421,35 @@ CGeometryCreator::return_type CGeometryCreator::createSphereMesh(float radius, u
 	indices->setUsageFlags(indices->getUsageFlags() | asset::IBuffer::EUF_INDEX_BUFFER_BIT);
 	retval.indexBuffer = {0ull, std::move(indices)};
 
-	// handle vertices
+	// the vertices at the top and at the bottom of the sphere
 	{
-		size_t vertexSize = 3 * 4 + 4 + 2 * 4 + 4;
-		size_t vertexCount = (polyCountXPitch * polyCountY) + 2;
-		auto vtxBuf = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexCount * vertexSize);
-		auto* tmpMem = reinterpret_cast<uint8_t*>(vtxBuf->getPointer());
-		for (size_t i = 0; i < vertexCount; i++)
+		SphereVertex* top = vertices + polyCountXPitch * polyCountY;
+		SphereVertex* bottom = top + 1;
+		for (SphereVertex* vertex : {top, bottom})
 		{
-			tmpMem[i * vertexSize + 3 * 4 + 0] = 255;
-			tmpMem[i * vertexSize + 3 * 4 + 1] = 255;
-			tmpMem[i * vertexSize + 3 * 4 + 2] = 255;
-			tmpMem[i * vertexSize + 3 * 4 + 3] = 255;
+			vertex->pos[0] = 0.f;
+			vertex->pos[2] = 0.f;
+			memset(vertex->color, 255, sizeof(vertex->color));
+			vertex->uv[0] = 0.5f;
 		}
-		// calculate the angle which separates all points in a circle
-		const float AngleX = 2 * core::PI<float>() / polyCountX;
-		const float AngleY = core::PI<float>() / polyCountY;
-
-		double axz;
-
-		// we don't start at 0.
-
-		double ay = 0;//AngleY / 2;
-
-		using quant_normal_t = CQuantNormalCache::value_type_t<EF_A2B10G10R10_SNORM_PACK32>;
-		uint8_t* tmpMemPtr = tmpMem;
-		for (uint32_t y = 0; y < polyCountY; ++y)
-		{
-			ay += AngleY;
-			const double sinay = sin(ay);
-			axz = 0;
+		top->pos[1] = radius;
+		top->uv[1] = 0.f;
+		top->normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::vectorSIMDf(0.f, 1.f, 0.f));
+		bottom->pos[1] = -radius;
+		bottom->uv[1] = 1.f;
+		bottom->normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::vectorSIMDf(0.f, -1.f, 0.f));
+	}
 
-			// calculate the necessary vertices without the doubled one
-			uint8_t* oldTmpMemPtr = tmpMemPtr;
-			for (uint32_t xz = 0; xz < polyCountX; ++xz)
-			{
-				// calculate points position
-
-				core::vector3df pos(static_cast<float>(cos(axz) * sinay),
-					static_cast<float>(cos(ay)),
-					static_cast<float>(sin(axz) * sinay));
-				// for spheres the normal is the position
-				core::vectorSIMDf normal(&pos.X);
-				normal.makeSafe3D();
-				quant_normal_t quantizedNormal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(normal);
-				pos *= radius;
-
-				// calculate texture coordinates via sphere mapping
-				// tu is the same on each level, so only calculate once
-				float tu = 0.5f;
-				//if (y==0)
-				//{
-				if (normal.Y != -1.0f && normal.Y != 1.0f)
-					tu = static_cast<float>(acos(core::clamp(normal.X / sinay, -1.0, 1.0)) * 0.5 * core::RECIPROCAL_PI<double>());
-				if (normal.Z < 0.0f)
-					tu = 1 - tu;
-				//}
-				//else
-					//tu = ((float*)(tmpMem+(i-polyCountXPitch)*vertexSize))[4];
-
-				((float*)tmpMemPtr)[0] = pos.X;
-				((float*)tmpMemPtr)[1] = pos.Y;
-				((float*)tmpMemPtr)[2] = pos.Z;
-				((float*)tmpMemPtr)[4] = tu;
-				((float*)tmpMemPtr)[5] = static_cast<float>(ay * core::RECIPROCAL_PI<double>());
-				((quant_normal_t*)tmpMemPtr)[6] = quantizedNormal;
-				static_assert(sizeof(quant_normal_t)==4u);
-
-				tmpMemPtr += vertexSize;
-				axz += AngleX;
-			}
-			// This is the doubled vertex on the initial position
-
-			((float*)tmpMemPtr)[0] = ((float*)oldTmpMemPtr)[0];
-			((float*)tmpMemPtr)[1] = ((float*)oldTmpMemPtr)[1];
-			((float*)tmpMemPtr)[2] = ((float*)oldTmpMemPtr)[2];
-			((float*)tmpMemPtr)[4] = 1.f;
-			((float*)tmpMemPtr)[5] = ((float*)oldTmpMemPtr)[5];
-			((uint32_t*)tmpMemPtr)[6] = ((uint32_t*)oldTmpMemPtr)[6];
-			tmpMemPtr += vertexSize;
-		}
+	// recalculate bounding box
+	core::aabbox3df BoundingBox;
+	BoundingBox.reset(core::vector3df(radius));
+	BoundingBox.addInternalPoint(-radius, -radius, -radius);
 
-		// the vertex at the top of the sphere
-		((float*)tmpMemPtr)[0] = 0.f;
-		((float*)tmpMemPtr)[1] = radius;
-		((float*)tmpMemPtr)[2] = 0.f;
-		((float*)tmpMemPtr)[4] = 0.5f;
-		((float*)tmpMemPtr)[5] = 0.f;
-		((quant_normal_t*)tmpMemPtr)[6] = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::vectorSIMDf(0.f, 1.f, 0.f));
-
-		// the vertex at the bottom of the sphere
-		tmpMemPtr += vertexSize;
-		((float*)tmpMemPtr)[0] = 0.f;
-		((float*)tmpMemPtr)[1] = -radius;
-		((float*)tmpMemPtr)[2] = 0.f;
-		((float*)tmpMemPtr)[4] = 0.5f;
-		((float*)tmpMemPtr)[5] = 1.f;
-		((quant_normal_t*)tmpMemPtr)[6] = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::vectorSIMDf(0.f, -1.f, 0.f));
-
-		// recalculate bounding box
-		core::aabbox3df BoundingBox;
-		BoundingBox.reset(core::vector3df(radius));
-		BoundingBox.addInternalPoint(-radius, -radius, -radius);
-
-		// set vertex buffer
-		vtxBuf->setUsageFlags(vtxBuf->getUsageFlags() | asset::IBuffer::EUF_VERTEX_BUFFER_BIT);
-		retval.bindings[0] = { 0ull,std::move(vtxBuf) };
-		retval.indexType = asset::EIT_32BIT;
-		retval.bbox = BoundingBox;
-	}
+	// set vertex buffer
+	vtxBuf->setUsageFlags(vtxBuf->getUsageFlags() | asset::IBuffer::EUF_VERTEX_BUFFER_BIT);
+	retval.bindings[0] = { 0ull,std::move(vtxBuf) };
+	retval.indexType = asset::EIT_32BIT;
+	retval.bbox = BoundingBox;
 
 	return retval;
 }
@@ -477,15 +481,15 @@ CGeometryCreator::return_type CGeometryCreator::createCylinderMesh(float radius,
     color.toOpenGLColor(glcolor);
 
     const float tesselationRec = core::reciprocal_approxim<float>(tesselation);
-    const float step = 2.f*core::PI<float>()*tesselationRec;
+    const SRing ring(tesselation, 2.0*core::PI<double>()/tesselation);
     for (uint32_t i = 0u; i<tesselation; ++i)
     {
-        core::vectorSIMDf p(std::cos(i*step), std::sin(i*step), 0.f);
-        p *= radius;
-        const auto n = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(core::normalize(p));
+        // already of unit length
+        const core::vectorSIMDf n(static_cast<float>(ring.cos[i]), static_cast<float>(ring.sin[i]), 0.f);
+        const core::vectorSIMDf p = n*radius;
 
         memcpy(vertices[i].pos, p.pointer, 12u);
-        vertices[i].normal = n;
+        vertices[i].normal = quantNormalCache->quantize<EF_A2B10G10R10_SNORM_PACK32>(n);
         memcpy(vertices[i].color, glcolor, 4u);
         vertices[i].uv[0] = float(i) * tesselationRec;
 
@@ -537,14 +541,14 @@ CGeometryCreator::return_type CGeometryCreator::createConeMesh(	float radius, fl
     std::fill(vertices,vertices+vtxCnt, ConeVertex(core::vectorSIMDf(0.f),{},colorBottom));
 	CQuantNormalCache* const quantNormalCache = (meshManipulatorOverride == nullptr) ? defaultMeshManipulator->getQuantNormalCache() : meshManipulatorOverride->getQuantNormalCache();
 
-    const float step = (2.f*core::PI<float>()) / tesselation;
+    const SRing ring(tesselation, 2.0*core::PI<double>()/tesselation);
 
 	const core::vectorSIMDf apexVertexCoords(oblique, length, 0.0f);
 
 	//vertex positions
 	for (uint32_t i = 0u; i < tesselation; i++)
 	{
-		core::vectorSIMDf v(std::cos(i * step), 0.0f, std::sin(i * step), 0.0f);
+		core::vectorSIMDf v(static_cast<float>(ring.cos[i]), 0.0f, static_cast<float>(ring.sin[i]), 0.0f);
 		v *= radius;
 
 		memcpy(baseVertices[i].pos, v.pointer, sizeof(float) * 3);
@@ -676,13 +680,12 @@ CGeometryCreator::return_type CGeometryCreator::createDiskMesh(float radius, uin
 	const size_t vertexCount = 2u + tesselation;
 	retval.indexCount = vertexCount;
 
-	const float angle = 360.0f / static_cast<float>(tesselation);
+	const SRing ring(tesselation, 2.0*core::PI<double>()/tesselation);
 	
 	auto vertices = core::make_smart_refctd_ptr<asset::ICPUBuffer>(vertexCount * vertexSize);
 	DiskVertex* ptr = (DiskVertex*)vertices->getPointer();
 
 	const core::vectorSIMDf v0(0.0f, radius, 0.0f, 1.0f);
-	core::matrix3x4SIMD rotation;
 
 	//center
 	ptr[0] = DiskVertex(core::vector3df_SIMD(0.0f), video::SColor(0xFFFFFFFFu),
@@ -695,13 +698,10 @@ CGeometryCreator::return_type CGeometryCreator::createDiskMesh(float radius, uin
 	//vn
 	ptr[vertexCount - 1] = ptr[1];
 
-	//v1, v2, ..., vn-1
+	//v1, v2, ..., vn-1, v0 rotated around Z
 	for (int i = 2; i < vertexCount-1; i++)
 	{
-		core::vectorSIMDf vn;
-		core::matrix3x4SIMD rotMatrix;
-		rotMatrix.setRotation(core::quaternion(0.0f, 0.0f, core::radians((i-1)*angle)));
-		rotMatrix.transformVect(vn, v0);
+		const core::vectorSIMDf vn(-static_cast<float>(ring.sin[i-1])*radius, static_cast<float>(ring.cos[i-1])*radius, 0.0f, 1.0f);
 
 		ptr[i] = DiskVertex(vn, video::SColor(0xFFFFFFFFu),
 			core::vector2du32_SIMD(0u, 1u), core::vector3df_SIMD(0.0f, 0.0f, 1.0f));
@@ -1711,6 +1711,105 @@ CGeometryCreator::return_type CGeometryCreator::createIcoSphere(float radius, ui
 	return icosphereGeometry;
 }
 
+template<typename F>
+CGeometryCreator::return_type CGeometryCreator::getCached(const SCacheKey& key, F&& create) const
+{
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto found = cache.find(key);
+		if (found != cache.end())
+			return found->second;
+	}
+	// generation uses `cacheMeshManipulator`'s normal quantization cache which isn't thread safe, so only one thread generates at a time
+	std::lock_guard<std::mutex> generationLock(generationMutex);
+	{
+		std::lock_guard<std::mutex> lock(cacheMutex);
+		auto found = cache.find(key);
+		if (found != cache.end())
+			return found->second;
+	}
+	auto retval = create();
+	// results get handed out to every caller, nobody may write to them anymore
+	if (makeImmutable)
+	{
+		for (auto& binding : retval.bindings)
+			if (binding.buffer)
+				makeImmutable(binding.buffer.get());
+		if (retval.indexBuffer.buffer)
+			makeImmutable(retval.indexBuffer.buffer.get());
+	}
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	return cache.emplace(key, std::move(retval)).first->second;
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedCubeMesh(const core::vector3df& size) const
+{
+	return getCached({ ES_CUBE,{core::floatBitsToUint(float(size.X)),core::floatBitsToUint(float(size.Y)),core::floatBitsToUint(float(size.Z))} },
+		[&]() -> return_type {return createCubeMesh(size);});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedArrowMesh(	const uint32_t tesselationCylinder,
+																	const uint32_t tesselationCone,
+																	const float height,
+																	const float cylinderHeight,
+																	const float width0,
+																	const float width1,
+																	const video::SColor vtxColor0,
+																	const video::SColor vtxColor1) const
+{
+	const SCacheKey key = { ES_ARROW,{
+		tesselationCylinder,tesselationCone,core::floatBitsToUint(float(height)),core::floatBitsToUint(float(cylinderHeight)),
+		core::floatBitsToUint(float(width0)),core::floatBitsToUint(float(width1)),vtxColor0.color,vtxColor1.color
+	} };
+	return getCached(key, [&]() -> return_type {return createArrowMesh(tesselationCylinder, tesselationCone, height, cylinderHeight, width0, width1, vtxColor0, vtxColor1, cacheMeshManipulator.get());});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedSphereMesh(float radius, uint32_t polyCountX, uint32_t polyCountY) const
+{
+	return getCached({ ES_SPHERE,{core::floatBitsToUint(float(radius)),polyCountX,polyCountY} },
+		[&]() -> return_type {return createSphereMesh(radius, polyCountX, polyCountY, cacheMeshManipulator.get());});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedCylinderMesh(float radius, float length, uint32_t tesselation, const video::SColor& color) const
+{
+	return getCached({ ES_CYLINDER,{core::floatBitsToUint(float(radius)),core::floatBitsToUint(float(length)),tesselation,color.color} },
+		[&]() -> return_type {return createCylinderMesh(radius, length, tesselation, color, cacheMeshManipulator.get());});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedConeMesh(	float radius, float length, uint32_t tesselation,
+																	const video::SColor& colorTop,
+																	const video::SColor& colorBottom,
+																	float oblique) const
+{
+	const SCacheKey key = { ES_CONE,{
+		core::floatBitsToUint(float(radius)),core::floatBitsToUint(float(length)),tesselation,colorTop.color,colorBottom.color,core::floatBitsToUint(float(oblique))
+	} };
+	return getCached(key, [&]() -> return_type {return createConeMesh(radius, length, tesselation, colorTop, colorBottom, oblique, cacheMeshManipulator.get());});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedRectangleMesh(const core::vector2df_SIMD& _size) const
+{
+	return getCached({ ES_RECTANGLE,{core::floatBitsToUint(float(_size.x)),core::floatBitsToUint(float(_size.y))} },
+		[&]() -> return_type {return createRectangleMesh(_size);});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedDiskMesh(float radius, uint32_t tesselation) const
+{
+	return getCached({ ES_DISK,{core::floatBitsToUint(float(radius)),tesselation} },
+		[&]() -> return_type {return createDiskMesh(radius, tesselation);});
+}
+
+CGeometryCreator::return_type CGeometryCreator::getCachedIcoSphere(float radius, uint32_t subdivision, bool smooth) const
+{
+	return getCached({ ES_ICOSPHERE,{core::floatBitsToUint(float(radius)),subdivision,smooth} },
+		[&]() -> return_type {return createIcoSphere(radius, subdivision, smooth);});
+}
+
+void CGeometryCreator::clearCache() const
+{
+	std::lock_guard<std::mutex> lock(cacheMutex);
+	cache.clear();
+}
 
 } // end namespace asset
 } // end namespace nbl
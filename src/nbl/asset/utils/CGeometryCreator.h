@@ -5,6 +5,9 @@
 #ifndef __NBL_ASSET_C_GEOMETRY_CREATOR_H_INCLUDED__
 #define __NBL_ASSET_C_GEOMETRY_CREATOR_H_INCLUDED__
 
+#include <mutex>
+#include <functional>
+
 #include "nbl/asset/utils/IGeometryCreator.h"
 
 namespace nbl
@@ -34,7 +37,8 @@ class CGeometryCreator : public IGeometryCreator
 		} PACK_STRUCT;
 
 	public:
-		CGeometryCreator(IMeshManipulator* const _defaultMeshManipulator);
+		//! `_makeImmutable` is called on every buffer of a result before it goes into the cache, only the asset manager can change mutability
+		CGeometryCreator(IMeshManipulator* const _defaultMeshManipulator, std::function<void(IAsset*)>&& _makeImmutable);
 
 		private:
 		struct RectangleVertex
@@ -98,6 +102,47 @@ class CGeometryCreator : public IGeometryCreator
 		//smart_refctd_ptr?
 		IMeshManipulator* const defaultMeshManipulator;
 
+		enum E_SHAPE : uint32_t
+		{
+			ES_CUBE,
+			ES_ARROW,
+			ES_SPHERE,
+			ES_CYLINDER,
+			ES_CONE,
+			ES_RECTANGLE,
+			ES_DISK,
+			ES_ICOSPHERE
+		};
+		//! the shape and the bits of its parameters
+		struct SCacheKey
+		{
+			inline bool operator==(const SCacheKey& other) const = default;
+
+			E_SHAPE shape;
+			std::array<uint32_t,8u> params = {};
+		};
+		struct SCacheKeyHash
+		{
+			inline size_t operator()(const SCacheKey& key) const
+			{
+				size_t hash = key.shape;
+				for (const auto param : key.params)
+					hash = (hash^param)*0x100000001b3ull;
+				return hash;
+			}
+		};
+		// the asset manager hands out one creator to every thread
+		mutable std::mutex cacheMutex;
+		// held while generating a result for the cache, lookups only need `cacheMutex`
+		mutable std::mutex generationMutex;
+		// only ever used under `generationMutex`, so the cached path never touches the default manipulator's normal quantization cache other loaders share
+		core::smart_refctd_ptr<IMeshManipulator> cacheMeshManipulator;
+		std::function<void(IAsset*)> makeImmutable;
+		mutable core::unordered_map<SCacheKey,return_type,SCacheKeyHash> cache;
+
+		template<typename F>
+		return_type getCached(const SCacheKey& key, F&& create) const;
+
 	public:
 		return_type createCubeMesh(const core::vector3df& size) const override;
 
@@ -126,6 +171,31 @@ class CGeometryCreator : public IGeometryCreator
 
 		return_type createIcoSphere(float radius = 1.0f, uint32_t subdivision = 1, bool smooth = false) const override;
 
+		return_type getCachedCubeMesh(const core::vector3df& size) const override;
+
+		return_type getCachedArrowMesh(	const uint32_t tesselationCylinder,
+										const uint32_t tesselationCone, const float height,
+										const float cylinderHeight, const float width0,
+										const float width1, const video::SColor vtxColor0,
+										const video::SColor vtxColor1) const override;
+
+		return_type getCachedSphereMesh(float radius, uint32_t polyCountX, uint32_t polyCountY) const override;
+
+		return_type getCachedCylinderMesh(float radius, float length, uint32_t tesselation, const video::SColor& color=0xffffffff) const override;
+
+		return_type getCachedConeMesh(	float radius, float length, uint32_t tesselation,
+										const video::SColor& colorTop=0xffffffff,
+										const video::SColor& colorBottom=0xffffffff,
+										float oblique=0.f) const override;
+
+		return_type getCachedRectangleMesh(const core::vector2df_SIMD& _size = core::vector2df_SIMD(0.5f, 0.5f)) const override;
+
+		return_type getCachedDiskMesh(float radius, uint32_t tesselation) const override;
+
+		return_type getCachedIcoSphere(float radius = 1.0f, uint32_t subdivision = 1, bool smooth = false) const override;
+
+		void clearCache() const override;
+
 };
 
 } // end namespace asset
@@ -73,13 +73,14 @@ void COverdrawMeshOptimizer::createOptimized(asset::ICPUMeshBuffer* _outbuffer,
 	else
 		calcSortData(sortedData, inIndices32, idxCount, vertexPositions, softClusters, softClusterCount);
 
-	std::stable_sort(sortedData, sortedData+softClusterCount, std::greater<ClusterSortData>()); // TODO: use core::radix_sort
+	ClusterSortData* const sortScratch = (ClusterSortData*)_NBL_ALIGNED_MALLOC(softClusterCount*sizeof(ClusterSortData),_NBL_SIMD_ALIGNMENT);
+	const ClusterSortData* const sortedClusters = core::radix_sort(sortedData, sortScratch, softClusterCount, ClusterSortData::KeyAccessor());
 
 	auto reorderIndices = [&](auto* out, const auto* in)
 	{
 		for (size_t it = 0, jt = 0; it < softClusterCount; ++it)
 		{
-			const uint32_t cluster = sortedData[it].cluster;
+			const uint32_t cluster = sortedClusters[it].cluster;
 
 			size_t start = softClusters[cluster];
 			size_t end = (cluster+1<softClusterCount) ? softClusters[cluster+1]:idxCount/3;
@@ -102,6 +103,7 @@ void COverdrawMeshOptimizer::createOptimized(asset::ICPUMeshBuffer* _outbuffer,
 	_NBL_ALIGNED_FREE(hardClusters);
 	_NBL_ALIGNED_FREE(softClusters);
 	_NBL_ALIGNED_FREE(sortedData);
+	_NBL_ALIGNED_FREE(sortScratch);
 }
 
 template<typename IdxT>
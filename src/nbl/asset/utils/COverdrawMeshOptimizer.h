@@ -5,6 +5,8 @@
 #ifndef __NBL_ASSET_C_OVERDRAW_MESH_OPTIMIZER_H_INCLUDED__
 #define __NBL_ASSET_C_OVERDRAW_MESH_OPTIMIZER_H_INCLUDED__
 
+#include "nbl/core/algorithm/radix_sort.h"
+
 #include "nbl/asset/ICPUMeshBuffer.h"
 
 // Based on zeux's meshoptimizer (https://github.com/zeux/meshoptimizer) available under MIT license
@@ -23,11 +25,18 @@ class COverdrawMeshOptimizer
 			uint32_t cluster;
 			float dot;
 
-			bool operator>(const ClusterSortData& other) const
+			//! for `core::radix_sort`, sorts by descending `dot` and keeps the order of equal ones
+			struct KeyAccessor
 			{
+				_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = 32ull;
+
 				// high product = possible occluder, render early
-				return dot > other.dot;
-			}
+				template<auto bit_offset, auto radix_mask>
+				inline decltype(radix_mask) operator()(const ClusterSortData& item) const
+				{
+					return static_cast<decltype(radix_mask)>(~core::impl::KeyAdaptor<float>::toOrderedBits(item.dot)>>static_cast<uint32_t>(bit_offset))&radix_mask;
+				}
+			};
 		};
 
 		// private, undefined constructor
@@ -3,6 +3,7 @@
 // For conditions of distribution and use, see copyright notice in nabla.h
 
 #include "nbl/core/declarations.h"
+#include "nbl/core/execution.h"
 
 #include "CSmoothNormalGenerator.h"
 
@@ -15,58 +16,53 @@ namespace nbl
 namespace asset
 {
 
-static inline bool operator<(uint32_t lhs, const IMeshManipulator::SSNGVertexData& rhs)
+static inline bool compareVertexPosition(const core::vectorSIMDf& a, const core::vectorSIMDf& b, float epsilon)
 {
-	return lhs < rhs.hash;
+	const core::vectorSIMDf difference = core::abs(b - a);
+	return (difference.x <= epsilon && difference.y <= epsilon && difference.z <= epsilon);
 }
 
-static inline bool operator<(const IMeshManipulator::SSNGVertexData& lhs, uint32_t rhs)
+//same as `IMeshManipulator::calculateSmoothNormals` default comparison (face normals less than 45 degrees apart) fused with the position test, so both resolve to one movemask
+static inline bool compareVertexPositionAndDefaultAngle(const __m128 position, const __m128 faceNormal, const IMeshManipulator::SSNGVertexData& other, const __m128 epsilon)
 {
-	return lhs.hash < rhs;
-}
+	static constexpr float cosOf45Deg = 0.70710678118f;
 
-static inline bool compareVertexPosition(const core::vectorSIMDf& a, const core::vectorSIMDf& b, float epsilon)
-{
-	const core::vectorSIMDf difference = core::abs(b - a);
-	return (difference.x <= epsilon && difference.y <= epsilon && difference.z <= epsilon);
+	const __m128 absDiff = _mm_andnot_ps(_mm_set1_ps(-0.f), _mm_sub_ps(other.position.getAsRegister(), position));
+	const __m128 cosAngle = _mm_dp_ps(faceNormal, other.parentTriangleFaceNormal.getAsRegister(), 0x7f);
+	const __m128 pass = _mm_and_ps(_mm_cmple_ps(absDiff, epsilon), _mm_cmpgt_ps(cosAngle, _mm_set1_ps(cosOf45Deg)));
+	return (_mm_movemask_ps(pass) & 0x7) == 0x7;
 }
 
-static inline core::vector3df_SIMD getAngleWeight(const core::vector3df_SIMD & v1,
-	const core::vector3df_SIMD & v2,
-	const core::vector3df_SIMD & v3)
+//angle of the triangle at vertex `v`, where `v1` and `v2` are the other two vertices
+static inline float getAngleWeight(const core::vector3df_SIMD & v,
+	const core::vector3df_SIMD & v1,
+	const core::vector3df_SIMD & v2)
 {
-	// Calculate this triangle's weight for each of its three vertices
-	// start by calculating the lengths of its sides
-	const float a = core::distancesquared(v2,v3)[0];
-	const float asqrt = core::sqrt(a);
-	const float b = core::distancesquared(v1,v3)[0];
+	// use the lengths of the triangle's sides to find the angle
+	const float a = core::distancesquared(v1,v2)[0];
+	const float b = core::distancesquared(v,v2)[0];
 	const float bsqrt = core::sqrt(b);
-	const float c = core::distancesquared(v1,v2)[0];
+	const float c = core::distancesquared(v,v1)[0];
 	const float csqrt = core::sqrt(c);
 
-	// use them to find the angle at each vertex
-	return core::vector3df_SIMD(
-		acosf((b + c - a) / (2.f * bsqrt * csqrt)),
-		acosf((-b + c + a) / (2.f * asqrt * csqrt)),
-		acosf((b - c + a) / (2.f * bsqrt * asqrt)));
+	return acosf((b + c - a) / (2.f * bsqrt * csqrt));
 }
 
-core::smart_refctd_ptr<asset::ICPUMeshBuffer> nbl::asset::CSmoothNormalGenerator::calculateNormals(asset::ICPUMeshBuffer * buffer, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp)
+core::smart_refctd_ptr<asset::ICPUMeshBuffer> nbl::asset::CSmoothNormalGenerator::calculateNormals(asset::ICPUMeshBuffer * buffer, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp, const bool concurrentVxcmp)
 {
 	VertexHashMap vertexArray = setupData(buffer, epsilon);
-	processConnectedVertices(buffer, vertexArray, epsilon, normalAttrID, vxcmp);
+	processConnectedVertices(buffer, vertexArray, epsilon, normalAttrID, vxcmp, concurrentVxcmp);
 
 	return core::smart_refctd_ptr<asset::ICPUMeshBuffer>(buffer);
 }
 
 CSmoothNormalGenerator::VertexHashMap::VertexHashMap(size_t _vertexCount, uint32_t _hashTableMaxSize, float _cellSize)
-	:hashTableMaxSize(_hashTableMaxSize),
+	:vertices(_vertexCount),
+	hashTableMaxSize(_hashTableMaxSize),
 	cellSize(_cellSize)
 {
 	assert((core::isPoT(hashTableMaxSize)));
-
-	vertices.reserve(_vertexCount);
-	buckets.reserve(_hashTableMaxSize + 1);
+	assert(hashTableMaxSize <= (0x1u << MaxHashBits));
 }
 
 uint32_t CSmoothNormalGenerator::VertexHashMap::hash(const IMeshManipulator::SSNGVertexData & vertex) const
@@ -93,69 +89,45 @@ uint32_t CSmoothNormalGenerator::VertexHashMap::hash(const core::vector3du32_SIM
 		(position.z * primeNumber3))& (hashTableMaxSize - 1);
 }
 
-void CSmoothNormalGenerator::VertexHashMap::add(IMeshManipulator::SSNGVertexData && vertex)
-{
-	vertex.hash = hash(vertex);
-	vertices.push_back(vertex);
-}
-
-CSmoothNormalGenerator::VertexHashMap::BucketBounds CSmoothNormalGenerator::VertexHashMap::getBucketBoundsByHash(uint32_t hash)
-{
-	if (hash == invalidHash)
-		return { vertices.end(), vertices.end() };
-
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator begin = std::lower_bound(vertices.begin(), vertices.end(), hash);
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator end = std::upper_bound(vertices.begin(), vertices.end(), hash);
-
-	//bucket missing
-	if (begin == vertices.end())
-		return { vertices.end(), vertices.end() };
-
-	//bucket missing
-	if (begin->hash != hash)
-		return { vertices.end(), vertices.end() };
-
-	return { begin, end };
-}
-
+template<size_t HashBits>
 struct KeyAccessor
 {
-	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = 32ull;
+	_NBL_STATIC_INLINE_CONSTEXPR size_t key_bit_count = HashBits;
 
+	//the key is the cell hash in the upper 32 bits, the vertex it belongs to in the lower
 	template<auto bit_offset, auto radix_mask>
-	inline decltype(radix_mask) operator()(const IMeshManipulator::SSNGVertexData& item) const
+	inline decltype(radix_mask) operator()(const uint64_t& item) const
 	{
-		return static_cast<decltype(radix_mask)>(item.hash>>static_cast<uint32_t>(bit_offset))&radix_mask;
+		return static_cast<decltype(radix_mask)>(item>>(32ull+static_cast<uint64_t>(bit_offset)))&radix_mask;
 	}
 };
 void CSmoothNormalGenerator::VertexHashMap::validate()
 {
-	const auto oldSize = vertices.size();
-	vertices.resize(oldSize*2u);
-	// TODO: maybe use counting sort (or big radix) and use the histogram directly for the buckets
-	auto finalSortedOutput = core::radix_sort(vertices.data(),vertices.data()+oldSize,oldSize,KeyAccessor());
-	// TODO: optimize out the erase
-	if (finalSortedOutput!=vertices.data())
-		vertices.erase(vertices.begin(),vertices.begin()+oldSize);
-	else
-		vertices.erase(vertices.begin()+oldSize,vertices.end());
-
-	// TODO: are `buckets` even begin USED!?
-	uint16_t prevHash = vertices[0].hash;
-	core::vector<IMeshManipulator::SSNGVertexData>::iterator prevBegin = vertices.begin();
-	buckets.push_back(prevBegin);
-
-	while (true)
+	// sort compact (hash,vertex) keys instead of the whole vertices, then gather the vertices once
+	const size_t vertexCount = vertices.size();
+	core::vector<uint64_t> keys(vertexCount*2u);
+	core::for_each(core::execution::par_unseq, vertices.begin(), vertices.end(), [&](IMeshManipulator::SSNGVertexData& vertex) -> void
 	{
-		core::vector<IMeshManipulator::SSNGVertexData>::iterator next = std::upper_bound(prevBegin, vertices.end(), prevHash);
-		buckets.push_back(next);
-
-		if (next == vertices.end())
-			break;
-
-		prevBegin = next;
-		prevHash = next->hash;
-	}
+		const size_t i = &vertex - vertices.data();
+		vertex.hash = hash(vertex);
+		keys[i] = (static_cast<uint64_t>(vertex.hash) << 32ull) | static_cast<uint64_t>(i);
+	});
+	const uint64_t* sortedKeys = core::radix_sort(keys.data(), keys.data() + vertexCount, vertexCount, KeyAccessor<MaxHashBits>());
+
+	// the cell ranges are just the histogram of the hashes, prefix summed
+	bucketOffsets.resize(hashTableMaxSize + 1u);
+	std::fill(bucketOffsets.begin(), bucketOffsets.end(), 0u);
+	for (size_t i = 0u; i < vertexCount; i++)
+		bucketOffsets[(sortedKeys[i] >> 32ull) + 1u]++;
+	std::inclusive_scan(bucketOffsets.begin(), bucketOffsets.end(), bucketOffsets.begin());
+
+	core::vector<IMeshManipulator::SSNGVertexData> sortedVertices(vertexCount);
+	core::for_each(core::execution::par_unseq, sortedVertices.begin(), sortedVertices.end(), [&](IMeshManipulator::SSNGVertexData& vertex) -> void
+	{
+		const size_t i = &vertex - sortedVertices.data();
+		vertex = vertices[static_cast<uint32_t>(sortedKeys[i])];
+	});
+	vertices = std::move(sortedVertices);
 }
 
 CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const asset::ICPUMeshBuffer* buffer, float epsilon)
@@ -163,75 +135,101 @@ CSmoothNormalGenerator::VertexHashMap CSmoothNormalGenerator::setupData(const as
 	const size_t idxCount = buffer->getIndexCount();
 	_NBL_DEBUG_BREAK_IF((idxCount % 3));
 
-	VertexHashMap vertices(idxCount, std::min(16u * 1024u, core::roundUpToPoT<unsigned int>(idxCount * 1.0f / 32.0f)), epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
-
-	core::vector3df_SIMD faceNormal;
+	const uint32_t hashTableSize = std::min(0x1u << VertexHashMap::MaxHashBits, core::roundUpToPoT<uint32_t>(std::max<uint32_t>(idxCount / 2u, 1u)));
+	VertexHashMap vertices(idxCount, hashTableSize, epsilon == 0.0f ? 0.00001f : epsilon * 1.00001f);
 
-	for (uint32_t i = 0; i < idxCount; i += 3)
+	//decode all positions in one go, through the index buffer if there is one
+	core::vector<float> positions(idxCount*3u);
+	float* const outChannels[4] = { positions.data(), positions.data() + idxCount, positions.data() + 2u * idxCount, nullptr };
+	const bool decoded = buffer->getAttributeStream(outChannels, buffer->getPositionAttributeIx(), idxCount, buffer->getIndices(), buffer->getIndexType());
+	auto getPosition = [&](uint32_t i) -> core::vectorSIMDf
 	{
-		const uint32_t ix[3]{
-			buffer->getIndexValue(i),
-			buffer->getIndexValue(i + 1),
-			buffer->getIndexValue(i + 2)
-		};
-		//calculate face normal of parent triangle
-		core::vectorSIMDf v1 = buffer->getPosition(ix[0]);
-		core::vectorSIMDf v2 = buffer->getPosition(ix[1]);
-		core::vectorSIMDf v3 = buffer->getPosition(ix[2]);
+		if (decoded)
+			return core::vectorSIMDf(outChannels[0][i], outChannels[1][i], outChannels[2][i], 1.f);
+		return buffer->getPosition(buffer->getIndexValue(i));
+	};
+
+	//every vertex only needs its own triangle, so they can all be set up independently
+	auto& vertexData = vertices.getVertices();
+	core::for_each(core::execution::par_unseq, vertexData.begin(), vertexData.end(), [&](IMeshManipulator::SSNGVertexData& vertex) -> void
+	{
+		const uint32_t i = &vertex - vertexData.data();
+		const uint32_t triangleBegin = i - i % 3u;
+
+		core::vectorSIMDf v[3];
+		for (uint32_t j = 0u; j < 3u; j++)
+			v[j] = getPosition(triangleBegin + j);
 
-		faceNormal = core::cross(v2 - v1, v3 - v1);
+		//calculate face normal of parent triangle
+		core::vector3df_SIMD faceNormal = core::cross(v[1] - v[0], v[2] - v[0]);
 		faceNormal = core::normalize(faceNormal);
 
-		//set data for vertices
-		core::vector3df_SIMD angleWages = getAngleWeight(v1, v2, v3);
-
-		vertices.add({ i,		0,	angleWages.x,	v1,		faceNormal });
-		vertices.add({ i + 1,	0,	angleWages.y,	v2,		faceNormal });
-		vertices.add({ i + 2,	0,	angleWages.z,	v3,		faceNormal });
-	}
+		const uint32_t corner = i - triangleBegin;
+		vertex = { i, 0, getAngleWeight(v[corner], v[(corner + 1u) % 3u], v[(corner + 2u) % 3u]), v[corner], faceNormal };
+	});
 
 	vertices.validate();
 
 	return vertices;
 }
 
-void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, VertexHashMap & vertexHashMap, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp)
+void CSmoothNormalGenerator::processConnectedVertices(asset::ICPUMeshBuffer * buffer, VertexHashMap & vertexHashMap, float epsilon, uint32_t normalAttrID, const IMeshManipulator::VxCmpFunction& vxcmp, const bool concurrentVxcmp)
 {
-	for (uint32_t cell = 0; cell < vertexHashMap.getBucketCount() - 1; cell++)
+	//gather the normals and encode them all at once at the end, 4th channel stays 0 like the normalized vector's
+	const size_t idxCount = buffer->getIndexCount();
+	core::vector<float> normals(idxCount*4u, 0.f);
+	float* const normalChannels[4] = { normals.data(), normals.data() + idxCount, normals.data() + 2u * idxCount, normals.data() + 3u * idxCount };
+
+	//vertices are sorted by cell, so neighbouring work items read the same few cells; each one only writes its own normal
+	auto& vertices = vertexHashMap.getVertices();
+	const __m128 epsilonVec = _mm_set1_ps(epsilon);
+	auto processVertex = [&](const IMeshManipulator::SSNGVertexData& processedVertex) -> void
 	{
-		VertexHashMap::BucketBounds processedBucket = vertexHashMap.getBucketBoundsById(cell);
+		std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(processedVertex);
+		core::vector3df_SIMD normal = processedVertex.parentTriangleFaceNormal * processedVertex.wage;
 
-		for (core::vector<IMeshManipulator::SSNGVertexData>::iterator processedVertex = processedBucket.begin; processedVertex != processedBucket.end; processedVertex++)
+		const __m128 position = processedVertex.position.getAsRegister();
+		const __m128 faceNormal = processedVertex.parentTriangleFaceNormal.getAsRegister();
+		//iterate among all neighboring cells
+		for (int i = 0; i < 8; i++)
 		{
-			std::array<uint32_t, 8> neighboringCells = vertexHashMap.getNeighboringCellHashes(*processedVertex);
-			core::vector3df_SIMD normal = processedVertex->parentTriangleFaceNormal * processedVertex->wage;
-
-			//iterate among all neighboring cells
-			for (int i = 0; i < 8; i++)
+			VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
+			for (; bounds.begin != bounds.end; bounds.begin++)
 			{
-				VertexHashMap::BucketBounds bounds = vertexHashMap.getBucketBoundsByHash(neighboringCells[i]);
-				for (; bounds.begin != bounds.end; bounds.begin++)
+				if (&processedVertex == bounds.begin)
+					continue;
+
+				const bool connected = vxcmp ?
+					(compareVertexPosition(processedVertex.position, bounds.begin->position, epsilon) && vxcmp(processedVertex, *bounds.begin, buffer)):
+					compareVertexPositionAndDefaultAngle(position, faceNormal, *bounds.begin, epsilonVec);
+				if (connected)
 				{
-					if (processedVertex != bounds.begin)
-						if (compareVertexPosition(processedVertex->position, bounds.begin->position, epsilon) &&
-							vxcmp(*processedVertex, *bounds.begin, buffer))
-						{
-							//TODO: better mean calculation algorithm
-							normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
-						}
+					//TODO: better mean calculation algorithm
+					normal += bounds.begin->parentTriangleFaceNormal * bounds.begin->wage;
 				}
 			}
+		}
 
+		normal = core::normalize(core::vectorSIMDf(normal));
+		for (uint32_t c = 0u; c < 3u; c++)
+			normalChannels[c][processedVertex.indexOffset] = normal.pointer[c];
+	};
+	// comparators written before this went parallel may keep state
+	if (vxcmp && !concurrentVxcmp)
+		std::for_each(vertices.begin(), vertices.end(), processVertex);
+	else
+		core::for_each(core::execution::par, vertices.begin(), vertices.end(), processVertex);
 
-			normal = core::normalize(core::vectorSIMDf(normal));
-			buffer->setAttribute(normal, normalAttrID, buffer->getIndexValue(processedVertex->indexOffset));
-		}
+	const float* const inChannels[4] = { normalChannels[0], normalChannels[1], normalChannels[2], normalChannels[3] };
+	if (!buffer->setAttributeStream(inChannels, normalAttrID, idxCount, buffer->getIndices(), buffer->getIndexType()))
+	{
+		for (uint32_t i = 0u; i < idxCount; i++)
+			buffer->setAttribute(core::vectorSIMDf(normalChannels[0][i], normalChannels[1][i], normalChannels[2][i]), normalAttrID, buffer->getIndexValue(i));
 	}
 
-
 }
 
-std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex)
+std::array<uint32_t, 8> CSmoothNormalGenerator::VertexHashMap::getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData & vertex) const
 {
 	std::array<uint32_t, 8> neighbourhood;
 
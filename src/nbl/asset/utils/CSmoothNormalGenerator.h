@@ -8,6 +8,7 @@
 
 #include <iostream>
 #include <functional>
+#include <array>
 
 #include "nbl/core/math/glslFunctions.h"
 
@@ -23,44 +24,49 @@ namespace asset
 class CSmoothNormalGenerator
 {
 public:
-	static core::smart_refctd_ptr<asset::ICPUMeshBuffer> calculateNormals(asset::ICPUMeshBuffer* buffer, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction function);
+	static core::smart_refctd_ptr<asset::ICPUMeshBuffer> calculateNormals(asset::ICPUMeshBuffer* buffer, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction function, const bool concurrentVxcmp);
 
 	CSmoothNormalGenerator() = delete;
 	~CSmoothNormalGenerator() = delete;
 
 private:
+	//! Vertices sorted by the hash of the grid cell they fall into, with a direct lookup table of cell ranges
 	class VertexHashMap
 	{
 	public:
+		//! hash table size is capped so the cell ranges stay cheap and the radix sort only needs two passes
+		_NBL_STATIC_INLINE_CONSTEXPR uint32_t MaxHashBits = 22u;
+
 		struct BucketBounds
 		{
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator begin;
-			core::vector<IMeshManipulator::SSNGVertexData>::iterator end;
+			IMeshManipulator::SSNGVertexData* begin;
+			IMeshManipulator::SSNGVertexData* end;
 		};
 
 	public:
 		VertexHashMap(size_t _vertexCount, uint32_t _hashTableMaxSize, float _cellSize);
 
-		//inserts vertex into hash table
-		void add(IMeshManipulator::SSNGVertexData&& vertex);
-
-		//sorts hashtable and sets iterators at beginnings of bucktes
+		//computes the hashes of the already filled vertices, sorts them by cell and fills the cell ranges
 		void validate();
 
 		//
-		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex);
+		std::array<uint32_t, 8> getNeighboringCellHashes(const IMeshManipulator::SSNGVertexData& vertex) const;
 
-		inline uint32_t getBucketCount() const { return buckets.size(); }
-		inline BucketBounds getBucketBoundsById(uint32_t index) { return { buckets[index], buckets[index + 1] }; }
-		BucketBounds getBucketBoundsByHash(uint32_t hash);
+		inline core::vector<IMeshManipulator::SSNGVertexData>& getVertices() { return vertices; }
+		inline BucketBounds getBucketBoundsByHash(uint32_t hash)
+		{
+			if (hash == invalidHash)
+				return { nullptr, nullptr };
+			return { vertices.data() + bucketOffsets[hash], vertices.data() + bucketOffsets[hash + 1u] };
+		}
 
 	private:
 		static constexpr uint32_t invalidHash = 0xFFFFFFFF;
 
 	private:
-		//holds iterators pointing to beginning of each bucket, last iterator points to vertices.end()
-		core::vector<core::vector<IMeshManipulator::SSNGVertexData>::iterator> buckets;
 		core::vector<IMeshManipulator::SSNGVertexData> vertices;
+		//offsets of the first vertex in each cell, with one extra entry equal to the vertex count at the end
+		core::vector<uint32_t> bucketOffsets;
 		const uint32_t hashTableMaxSize;
 		const float cellSize;
 
@@ -72,7 +78,7 @@ private:
 
 private:
 	static VertexHashMap setupData(const asset::ICPUMeshBuffer* buffer, float epsilon);
-	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, VertexHashMap& vertices, float epsilon, uint32_t normalAttrID, IMeshManipulator::VxCmpFunction vxcmp);
+	static void processConnectedVertices(asset::ICPUMeshBuffer* buffer, VertexHashMap& vertices, float epsilon, uint32_t normalAttrID, const IMeshManipulator::VxCmpFunction& vxcmp, const bool concurrentVxcmp);
 
 };
 
@@ -8,7 +8,7 @@
 #include "nbl/asset/utils/CGLSLVirtualTexturingBuiltinIncludeLoader.h"
 
 #include <sstream>
-#include <regex>
+#include <string_view>
 #include <iterator>
 
 
@@ -118,25 +118,116 @@ namespace nbl::asset::impl
     static constexpr const char* PREPROC_GL__ENABLER = PREPROC_GL__DISABLER;
     static constexpr const char* PREPROC_LINE_CONTINUATION_DISABLER = "_this_is_a_line_continuation_\n";
     static constexpr const char* PREPROC_LINE_CONTINUATION_ENABLER = "_this_is_a_line_continuation_";
+    static inline bool isPreprocWhitespace(const char c)
+    {
+        return c==' ' || c=='\t' || c=='\r' || c=='\n' || c=='\v' || c=='\f';
+    }
+    // Single pass equivalent of what used to be three `std::regex_replace` passes:
+    //  "#(?!(include|version|pragma shader_stage|line))" -> PREPROC_DIRECTIVE_DISABLER
+    //  "[ \t\r\n\v\f]GL_" -> PREPROC_GL__DISABLER
+    //  "\\[ \t\r\n\v\f]*\n" -> PREPROC_LINE_CONTINUATION_DISABLER (applied to the output of the previous replacement)
+    // Each pass ran on the output of the previous one, so a disabled `#` right after `GL` reads as `GL_` to the second pass.
     static void disableAllDirectivesExceptIncludes(std::string& _glslCode)
     {
         // TODO: replace this with a proper-ish proprocessor and includer one day
-        std::regex directive("#(?!(include|version|pragma shader_stage|line))");//all # not followed by "include" nor "version" nor "pragma shader_stage"
         //`#pragma shader_stage(...)` is needed for determining shader stage when `_stage` param of IGLSLCompiler functions is set to ESS_UNKNOWN
-        auto result = std::regex_replace(_glslCode,directive,PREPROC_DIRECTIVE_DISABLER);
-        std::regex glMacro("[ \t\r\n\v\f]GL_");
-        result = std::regex_replace(result, glMacro, PREPROC_GL__DISABLER);
-        std::regex lineContinuation("\\\\[ \t\r\n\v\f]*\n");
-        _glslCode = std::regex_replace(result, lineContinuation, PREPROC_LINE_CONTINUATION_DISABLER);
+        constexpr std::string_view KeptDirectives[] = {"include","version","pragma shader_stage","line"};
+        constexpr std::string_view GLPrefix = "GL_";
+
+        const std::string_view in = _glslCode;
+        auto isDisabledHash = [&](const size_t pos) -> bool
+        {
+            if (pos>=in.size() || in[pos]!='#')
+                return false;
+            const auto rest = in.substr(pos+1ull);
+            return std::none_of(std::begin(KeptDirectives),std::end(KeptDirectives),[rest](const std::string_view d){return rest.substr(0ull,d.size())==d;});
+        };
+        // whether the first pass' output has a `GL_` at `pos`
+        auto isGLPrefix = [&](const size_t pos) -> bool
+        {
+            return in.substr(pos,GLPrefix.size())==GLPrefix || (in.substr(pos,2ull)=="GL" && isDisabledHash(pos+2ull));
+        };
+
+        std::string out;
+        out.reserve(in.size()+in.size()/8ull);
+        for (size_t i=0ull; i<in.size(); i++)
+        {
+            const char c = in[i];
+            if (c=='#')
+            {
+                if (isDisabledHash(i))
+                    out += PREPROC_DIRECTIVE_DISABLER;
+                else
+                    out += c;
+            }
+            else if (c=='\\')
+            {
+                size_t wsEnd = i+1ull;
+                while (wsEnd<in.size() && isPreprocWhitespace(in[wsEnd]))
+                    wsEnd++;
+                // the last whitespace before a `GL_` belongs to the GL_ replacement which used to run first
+                if (wsEnd>i+1ull && isGLPrefix(wsEnd))
+                    wsEnd--;
+                const size_t lastNewline = in.substr(i+1ull,wsEnd-i-1ull).rfind('\n');
+                if (lastNewline!=std::string_view::npos)
+                {
+                    out += PREPROC_LINE_CONTINUATION_DISABLER;
+                    i += lastNewline+1ull;
+                }
+                else
+                    out += c;
+            }
+            else if (isPreprocWhitespace(c) && isGLPrefix(i+1ull))
+            {
+                out += PREPROC_GL__DISABLER;
+                // the `_` of `GL_` was the start of the disabled `#`, the rest of its marker follows
+                if (in[i+3ull]=='#')
+                    out += PREPROC_DIRECTIVE_DISABLER+1;
+                i += GLPrefix.size();
+            }
+            else
+                out += c;
+        }
+        _glslCode = std::move(out);
     }
+    // Undoes the above in the order of the three `std::regex_replace` passes it used to take, the `_` ending the `GL_`
+    // put back by the second pass is the start of a directive marker for the third pass if the rest of it follows.
     static void reenableDirectives(std::string& _glslCode)
     {
-        std::regex lineContinuation(PREPROC_LINE_CONTINUATION_ENABLER);
-        auto result = std::regex_replace(_glslCode, lineContinuation, " \\");
-        std::regex glMacro(PREPROC_GL__ENABLER);
-        result = std::regex_replace(result,glMacro," GL_");
-        std::regex directive(PREPROC_DIRECTIVE_ENABLER);
-        _glslCode = std::regex_replace(result, directive, "#");
+        const std::string_view DirectiveMarkerRest = PREPROC_DIRECTIVE_ENABLER+1;
+        constexpr std::string_view MarkerPrefix = "_this_is_a_";
+        const std::pair<std::string_view,std::string_view> replacements[] = {
+            {PREPROC_LINE_CONTINUATION_ENABLER," \\"},
+            {PREPROC_GL__ENABLER," GL_"},
+            {PREPROC_DIRECTIVE_ENABLER,"#"}
+        };
+
+        const std::string_view in = _glslCode;
+        std::string out;
+        out.reserve(in.size());
+        size_t i = 0ull;
+        for (size_t found; (found=in.find(MarkerPrefix,i))!=std::string_view::npos; )
+        {
+            out += in.substr(i,found-i);
+            i = found;
+            for (const auto& [marker,replacement] : replacements)
+            if (in.substr(found,marker.size())==marker)
+            {
+                i += marker.size();
+                if (marker==PREPROC_GL__ENABLER && in.substr(i,DirectiveMarkerRest.size())==DirectiveMarkerRest)
+                {
+                    out += " GL#";
+                    i += DirectiveMarkerRest.size();
+                }
+                else
+                    out += replacement;
+                break;
+            }
+            if (i==found)
+                out += in[i++];
+        }
+        out += in.substr(i);
+        _glslCode = std::move(out);
     }
     static std::string encloseWithinExtraInclGuards(std::string&& _glslCode, uint32_t _maxInclusions, const char* _identifier)
     {
@@ -17,14 +17,18 @@ class IGLSLEmbeddedIncludeLoader : public IBuiltinIncludeLoader
 	protected:
 		virtual ~IGLSLEmbeddedIncludeLoader() = default;
 
-		inline core::vector<std::pair<std::regex,HandleFunc_t>> getBuiltinNamesToFunctionMapping() const override
+		inline core::vector<SBuiltinPattern> getBuiltinNamesToFunctionMapping() const override
 		{
-			std::string pattern(getVirtualDirectoryName());
-			pattern += ".*";
 			HandleFunc_t tmp = [this](const std::string& _name) -> std::string {
 				return getFromDiskOrEmbedding(_name);
 			};
-			return {{std::regex{pattern},std::move(tmp)}};
+			// without embedded resources the includes come from disk, so edits to them have to show up on the next compile
+		#ifdef _NBL_EMBED_BUILTIN_RESOURCES_
+			constexpr bool memoize = true;
+		#else
+			constexpr bool memoize = false;
+		#endif
+			return {{getVirtualDirectoryName(),SBuiltinPattern::AnySuffix,std::move(tmp),memoize}};
 		}
 		
 		static core::vector<std::string> parseArgumentsFromPath(const std::string& _path)
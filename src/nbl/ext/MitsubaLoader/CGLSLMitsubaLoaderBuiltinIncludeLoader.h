@@ -34,14 +34,13 @@ class CGLSLMitsubaLoaderBuiltinIncludeLoader : public asset::IGLSLEmbeddedInclud
 		}
 
 	protected:
-		core::vector<std::pair<std::regex, HandleFunc_t>> getBuiltinNamesToFunctionMapping() const override
+		core::vector<SBuiltinPattern> getBuiltinNamesToFunctionMapping() const override
 		{
 			auto retval = IGLSLEmbeddedIncludeLoader::getBuiltinNamesToFunctionMapping();
 
-			const std::string num = "[0-9]+";
 			retval.insert(retval.begin(),
 				{ 
-					std::regex{"glsl/ext/MitsubaLoader/material_compiler_compatibility\\.glsl/"+num},
+					"glsl/ext/MitsubaLoader/material_compiler_compatibility.glsl",1u,
 					&getMaterialCompilerStuff
 				}
 			);
@@ -0,0 +1,206 @@
+// Copyright (C) 2018-2020 - DevSH Graphics Programming Sp. z O.O.
+// This file is part of the "Nabla Engine".
+// For conditions of distribution and use, see copyright notice in nabla.h
+
+#include "nbl/scene/CTransformTreeCPUExecutor.h"
+
+
+using namespace nbl;
+using namespace scene;
+
+
+core::matrix3x4SIMD CTransformTreeCPUExecutor::concatenate(const core::matrix3x4SIMD& parent, const core::matrix3x4SIMD& relative)
+{
+	const __m128 r0 = relative.rows[0].getAsRegister();
+	const __m128 r1 = relative.rows[1].getAsRegister();
+	const __m128 r2 = relative.rows[2].getAsRegister();
+	// `matrix3x4SIMD::concatenateBFollowedByA` adds (0,0,0,a.w) which turns negative zeroes positive, the shader only adds to the last column
+	const __m128 lastColumn = _mm_castsi128_ps(_mm_setr_epi32(0,0,0,-1));
+
+	core::matrix3x4SIMD out;
+	for (uint32_t i=0u; i<3u; i++)
+	{
+		const __m128 a = parent.rows[i].getAsRegister();
+		// same evaluation order as `lhs[0]*rhs[i][0]+lhs[1]*rhs[i][1]+lhs[2]*rhs[i][2]`
+		__m128 res = _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(0,0,0,0)),r0);
+		res = _mm_add_ps(res,_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(1,1,1,1)),r1));
+		res = _mm_add_ps(res,_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,2,2,2)),r2));
+		const __m128 translated = _mm_add_ps(res,a);
+		out.rows[i] = _mm_or_ps(_mm_andnot_ps(lastColumn,res),_mm_and_ps(lastColumn,translated));
+	}
+	return out;
+}
+
+core::matrix3x4SIMD CTransformTreeCPUExecutor::applyModification(const core::matrix3x4SIMD& relative, const RelativeTransformModificationRequest& request)
+{
+	// the type bits stay in the matrix, just like in the shader
+	const auto& delta = *reinterpret_cast<const core::matrix3x4SIMD*>(request.data);
+	switch (request.getType())
+	{
+		case RelativeTransformModificationRequest::ET_CONCATENATE_AFTER:
+			return concatenate(delta,relative);
+		case RelativeTransformModificationRequest::ET_CONCATENATE_BEFORE:
+			return concatenate(relative,delta);
+		case RelativeTransformModificationRequest::ET_WEIGHTED_ACCUMULATE:
+		{
+			core::matrix3x4SIMD sum;
+			for (uint32_t i=0u; i<3u; i++)
+				sum.rows[i] = _mm_add_ps(relative.rows[i].getAsRegister(),delta.rows[i].getAsRegister());
+			return sum;
+		}
+		default:
+			break;
+	}
+	return delta;
+}
+
+namespace
+{
+struct SColumn
+{
+	float x,y,z;
+};
+// GLSL's `cross` and `dot`, spelled out so the compiler can't reassociate them
+inline SColumn cross(const SColumn& a, const SColumn& b)
+{
+	return {a.y*b.z-b.y*a.z,a.z*b.x-b.z*a.x,a.x*b.y-b.x*a.y};
+}
+inline float dot(const SColumn& a, const SColumn& b)
+{
+	return a.x*b.x+a.y*b.y+a.z*b.z;
+}
+// `packSnorm2x16`
+inline uint32_t packSnorm2x16(const float x, const float y)
+{
+	auto pack = [](const float v) -> uint32_t
+	{
+		return static_cast<uint16_t>(static_cast<int16_t>(std::nearbyint(core::clamp(v,-1.f,1.f)*32767.f)));
+	};
+	return pack(x)|(pack(y)<<16u);
+}
+}
+
+CTransformTreeCPUExecutor::normal_matrix_t CTransformTreeCPUExecutor::encodeNormalMatrix(const core::matrix3x4SIMD& globalTransform)
+{
+	SColumn sub3x3[3];
+	for (uint32_t i=0u; i<3u; i++)
+		sub3x3[i] = {globalTransform.rows[0][i],globalTransform.rows[1][i],globalTransform.rows[2][i]};
+	SColumn m[3] = {cross(sub3x3[1],sub3x3[2]),cross(sub3x3[2],sub3x3[0]),cross(sub3x3[0],sub3x3[1])};
+	const uint32_t signFlipMask = core::IR(dot(sub3x3[0],m[0]))&0x80000000u;
+
+	float scale = 0.f;
+	for (const auto& column : m)
+		scale = core::max(scale,core::max(core::max(std::abs(column.x),std::abs(column.y)),std::abs(column.z)));
+	const float divisor = core::FR(core::IR(scale)^signFlipMask);
+	for (auto& column : m)
+	{
+		column.x /= divisor;
+		column.y /= divisor;
+		column.z /= divisor;
+	}
+
+	normal_matrix_t compr;
+	compr.compressedComponents[0] = packSnorm2x16(m[0].y,m[0].z)&0xFFFCFFFCu;
+	compr.compressedComponents[1] = packSnorm2x16(m[1].x,m[1].y)&0xFFFCFFFCu;
+	compr.compressedComponents[2] = packSnorm2x16(m[1].z,m[2].x)&0xFFFCFFFCu;
+	compr.compressedComponents[3] = packSnorm2x16(m[2].y,m[2].z)&0xFFFCFFFCu;
+	// the 14 bits of the first component get spread over the 2 bits cleared in every other
+	const uint32_t firstComp = packSnorm2x16(m[0].x,0.f);
+	const uint32_t firstCompParted = (firstComp<<8u)|firstComp;
+	compr.compressedComponents[0] |= firstCompParted&0x00030000u;
+	compr.compressedComponents[1] |= (firstCompParted>>2u)&0x00030003u;
+	compr.compressedComponents[2] |= (firstCompParted>>4u)&0x00030003u;
+	compr.compressedComponents[3] |= (firstCompParted>>6u)&0x00030003u;
+	return compr;
+}
+
+void CTransformTreeCPUExecutor::updateLocalTransform(const SNodeProperties& nodes, const ModificationRequestRange& range, const RelativeTransformModificationRequest* requests)
+{
+	nodes.modifiedTimestamps[range.nodeID] = range.newTimestamp;
+	const auto* request = requests+range.requestsBegin;
+	const auto* const requestsEnd = requests+range.requestsEnd;
+	if (request==requestsEnd)
+		return;
+
+	auto& relative = nodes.relativeTransforms[range.nodeID];
+	core::matrix3x4SIMD updated = relative;
+	// an overwrite first means the old value doesn't matter
+	if (request->getType()==RelativeTransformModificationRequest::ET_OVERWRITE)
+		updated = *reinterpret_cast<const core::matrix3x4SIMD*>((request++)->data);
+	for (; request!=requestsEnd; request++)
+		updated = applyModification(updated,*request);
+	relative = updated;
+}
+
+void CTransformTreeCPUExecutor::schedule(const SNodeProperties& nodes, const node_t* nodesBegin, const node_t* nodesEnd)
+{
+	constexpr uint32_t Unscheduled = ~0u;
+	m_capacity = nodes.capacity;
+	m_levels.assign(m_capacity,Unscheduled);
+
+	// walk up only until an ancestor with a known level, so every node gets visited once
+	uint32_t levelCount = 0u;
+	for (auto it=nodesBegin; it!=nodesEnd; it++)
+	{
+		node_t node = *it;
+		while (node!=ITransformTree::invalid_node && m_levels[node]==Unscheduled)
+		{
+			m_stack.push_back(node);
+			node = nodes.parents[node];
+		}
+		// roots overflow to level 0
+		uint32_t level = node!=ITransformTree::invalid_node ? m_levels[node]:Unscheduled;
+		for (; !m_stack.empty(); m_stack.pop_back())
+			m_levels[m_stack.back()] = ++level;
+		levelCount = core::max(levelCount,level+1u);
+	}
+
+	// counting sort by level, iterating over the nodes in order keeps every level ascending
+	core::vector<uint32_t> levelOffsets(levelCount+1u,0u);
+	for (const auto level : m_levels)
+	if (level!=Unscheduled)
+		levelOffsets[level+1u]++;
+	std::inclusive_scan(levelOffsets.begin(),levelOffsets.end(),levelOffsets.begin());
+	m_order.resize(levelOffsets.back());
+	{
+		auto cursors = levelOffsets;
+		for (node_t node=0u; node<m_capacity; node++)
+		if (m_levels[node]!=Unscheduled)
+			m_order[cursors[m_levels[node]]++] = node;
+	}
+
+	m_chunks.clear();
+	m_levelChunkOffsets.resize(levelCount+1u);
+	m_levelChunkOffsets[0] = 0u;
+	for (uint32_t level=0u; level<levelCount; level++)
+	{
+		for (uint32_t begin=levelOffsets[level]; begin<levelOffsets[level+1u]; begin+=ChunkSize)
+			m_chunks.push_back({begin,core::min(begin+ChunkSize,levelOffsets[level+1u])});
+		m_levelChunkOffsets[level+1u] = static_cast<uint32_t>(m_chunks.size());
+	}
+}
+
+void CTransformTreeCPUExecutor::recomputeChunk(const SNodeProperties& nodes, const SChunk& chunk, const uint32_t level) const
+{
+	for (uint32_t i=chunk.begin; i<chunk.end; i++)
+	{
+		const node_t node = m_order[i];
+		const auto expectedTimestamp = nodes.modifiedTimestamps[node];
+		// already up to date, any children will read the global transform
+		if (nodes.recomputedTimestamps[node]==expectedTimestamp)
+			continue;
+
+		auto& global = nodes.globalTransforms[node];
+		if (level)
+		{
+			// the shader starts from the relative transform of the root even if its global transform is up to date
+			const node_t parent = nodes.parents[node];
+			global = concatenate(level>1u ? nodes.globalTransforms[parent]:nodes.relativeTransforms[parent],nodes.relativeTransforms[node]);
+		}
+		else
+			global = nodes.relativeTransforms[node];
+		nodes.recomputedTimestamps[node] = expectedTimestamp;
+		if (nodes.normalMatrices)
+			nodes.normalMatrices[node] = encodeNormalMatrix(global);
+	}
+}
@@ -5,7 +5,7 @@ using namespace nbl::system;
 #ifdef _NBL_PLATFORM_ANDROID_
 #include <android/log.h>
 
-void CStdoutLoggerAndroid::threadsafeLog_impl(const std::string_view& fmt, E_LOG_LEVEL logLevel, va_list args)
+void CStdoutLoggerAndroid::threadsafeLog_impl(const std::string_view& line, E_LOG_LEVEL logLevel)
 {
 	auto nativeLogLevel = ANDROID_LOG_UNKNOWN;
 	switch (logLevel)
@@ -29,6 +29,6 @@ void CStdoutLoggerAndroid::threadsafeLog_impl(const std::string_view& fmt, E_LOG
 			assert(false);
 			break;
 	}
-	(void)__android_log_print(nativeLogLevel, "Nabla Engine: ", "%s", constructLogString(fmt,logLevel,args).c_str());
+	(void)__android_log_print(nativeLogLevel, "Nabla Engine: ", "%.*s", static_cast<int>(line.size()), line.data());
 }
 #endif
\ No newline at end of file
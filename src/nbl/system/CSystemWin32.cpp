@@ -70,7 +70,8 @@ core::smart_refctd_ptr<ISystemFile> CSystemWin32::CCaller::createFile(const std:
         For now it equals the size of a file so it'll work fine for archive reading, but if we try to
         write outside those boungs, things will go bad.
         */
-        _fileMappingObj = CreateFileMappingA(_native,nullptr,writeAccess ? PAGE_READWRITE:PAGE_READONLY, 0, 0, filename.string().c_str());
+        // a read-only file still gets a writable copy-on-write view, so the memory can be handed out as mutable data
+        _fileMappingObj = CreateFileMappingA(_native,nullptr,writeAccess ? PAGE_READWRITE:PAGE_WRITECOPY, 0, 0, filename.string().c_str());
         if (!_fileMappingObj)
         {
             CloseHandle(_native);
@@ -79,7 +80,7 @@ core::smart_refctd_ptr<ISystemFile> CSystemWin32::CCaller::createFile(const std:
         switch (flags.value&IFile::ECF_READ_WRITE)
         {
             case IFile::ECF_READ:
-                _mappedPtr = MapViewOfFile(_fileMappingObj,FILE_MAP_READ,0,0,_size);
+                _mappedPtr = MapViewOfFile(_fileMappingObj,FILE_MAP_COPY,0,0,_size);
                 break;
             case IFile::ECF_WRITE:
                 _mappedPtr = MapViewOfFile(_fileMappingObj,FILE_MAP_WRITE,0,0,_size);
@@ -62,7 +62,8 @@ core::smart_refctd_ptr<ISystemFile> ISystemPOSIX::CCaller::createFile(const std:
 	void* _mappedPtr = nullptr;
 	if (_flags.value & ECF_MAPPABLE)
 	{
-		const int mappingFlags = ((flags.value&IFile::ECF_READ) ? PROT_READ:0)|(writeAccess ? PROT_WRITE:0);
+		// a read-only file still gets a writable copy-on-write mapping, so the memory can be handed out as mutable data
+		const int mappingFlags = ((flags.value&IFile::ECF_READ) ? (PROT_READ|PROT_WRITE):0)|(writeAccess ? PROT_WRITE:0);
 		_mappedPtr = mmap((caddr_t)0, _size, mappingFlags, MAP_PRIVATE, _native, 0);
 		if (_mappedPtr==MAP_FAILED)
 		{
@@ -247,7 +247,6 @@ namespace nbl::ui
 						event.movementEvent.relativeMovementX = rawMouse.lLastX;
 						event.movementEvent.relativeMovementY = rawMouse.lLastY;
 						event.window = window;
-						auto lk = inputChannel->lockBackgroundBuffer();
 						inputChannel->pushIntoBackground(std::move(event));
 					}
 				}
@@ -260,7 +259,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				else if (rawMouse.usButtonFlags & RI_MOUSE_LEFT_BUTTON_UP)
@@ -272,7 +270,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				if (rawMouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_DOWN)
@@ -284,7 +281,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				else if (rawMouse.usButtonFlags & RI_MOUSE_RIGHT_BUTTON_UP)
@@ -296,7 +292,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				if (rawMouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_DOWN)
@@ -308,7 +303,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				else if (rawMouse.usButtonFlags & RI_MOUSE_MIDDLE_BUTTON_UP)
@@ -320,7 +314,6 @@ namespace nbl::ui
 					auto mousePos = window->getCursorControl()->getPosition();
 					event.clickEvent.clickPosX = mousePos.x;
 					event.clickEvent.clickPosY = mousePos.y;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				// TODO other mouse buttons
@@ -332,7 +325,6 @@ namespace nbl::ui
 					event.scrollEvent.verticalScroll = wheelDelta;
 					event.scrollEvent.horizontalScroll = 0;
 					event.window = window;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				else if (rawMouse.usButtonFlags & RI_MOUSE_HWHEEL)
@@ -342,7 +334,6 @@ namespace nbl::ui
 					event.scrollEvent.verticalScroll = 0;
 					event.scrollEvent.horizontalScroll = wheelDelta;
 					event.window = window;
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 				}
 				break;
@@ -360,7 +351,6 @@ namespace nbl::ui
 					event.action = SKeyboardEvent::ECA_PRESSED;
 					event.window = window;
 					event.keyCode = getNablaKeyCodeFromNative(rawKeyboard.VKey);
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 					break;
 				}
@@ -371,7 +361,6 @@ namespace nbl::ui
 					event.action = SKeyboardEvent::ECA_RELEASED;
 					event.window = window;
 					event.keyCode = getNablaKeyCodeFromNative(rawKeyboard.VKey);
-					auto lk = inputChannel->lockBackgroundBuffer();
 					inputChannel->pushIntoBackground(std::move(event));
 					break;
 				}
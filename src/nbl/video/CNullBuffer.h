@@ -0,0 +1,63 @@
+#ifndef __NBL_C_NULL_BUFFER_H_INCLUDED__
+#define __NBL_C_NULL_BUFFER_H_INCLUDED__
+
+#include "nbl/video/IGPUBuffer.h"
+
+namespace nbl::video
+{
+
+//! Buffer backed by plain host memory, just like on OpenGL the buffer is its own dedicated allocation
+class CNullBuffer final : public IGPUBuffer, public IDriverMemoryAllocation
+{
+    protected:
+        ~CNullBuffer()
+        {
+            _NBL_ALIGNED_FREE(m_storage);
+        }
+
+    public:
+        CNullBuffer(
+            core::smart_refctd_ptr<const ILogicalDevice>&& dev,
+            const IDriverMemoryBacked::SDriverMemoryRequirements& mreqs,
+            const IGPUBuffer::SCachedCreationParams& cachedCreationParams
+        ) : IGPUBuffer(std::move(dev),mreqs,cachedCreationParams), IDriverMemoryAllocation(getOriginDevice())
+        {
+            const size_t alignment = core::max<size_t>(cachedMemoryReqs.vulkanReqs.alignment,_NBL_SIMD_ALIGNMENT);
+            m_storage = reinterpret_cast<uint8_t*>(_NBL_ALIGNED_MALLOC(core::max<size_t>(cachedMemoryReqs.vulkanReqs.size,1ull),alignment));
+        }
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+
+        //! The host memory the buffer lives in, what `mapMemory` hands out
+        inline uint8_t* getStorage() {return m_storage;}
+        inline const uint8_t* getStorage() const {return m_storage;}
+
+        //! Returns the allocation which is bound to the resource
+        inline IDriverMemoryAllocation* getBoundMemory() override {return this;}
+
+        //! Constant version
+        inline const IDriverMemoryAllocation* getBoundMemory() const override {return this;}
+
+        //! Returns the offset in the allocation at which it is bound to the resource
+        inline size_t getBoundMemoryOffset() const override {return 0ull;}
+
+        //! the buffer is the allocation
+        inline size_t getAllocationSize() const override {return IGPUBuffer::getSize();}
+
+        //!
+        inline E_SOURCE_MEMORY_TYPE getType() const override {return static_cast<E_SOURCE_MEMORY_TYPE>(cachedMemoryReqs.memoryHeapLocation);}
+
+        //! host memory is always coherent, but we report what was asked for so the flushes still happen like they would on a real device
+        inline E_MAPPING_CAPABILITY_FLAGS getMappingCaps() const override {return static_cast<E_MAPPING_CAPABILITY_FLAGS>(cachedMemoryReqs.mappingCapability);}
+
+        //! Whether the allocation was made for a specific resource and is supposed to only be bound to that resource.
+        inline bool isDedicated() const override {return true;}
+
+    private:
+        uint8_t* m_storage;
+};
+
+}
+
+#endif
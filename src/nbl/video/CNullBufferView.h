@@ -0,0 +1,30 @@
+#ifndef __NBL_C_NULL_BUFFER_VIEW_H_INCLUDED__
+#define __NBL_C_NULL_BUFFER_VIEW_H_INCLUDED__
+
+#include "nbl/video/IGPUBufferView.h"
+#include "nbl/video/IGPUSampler.h"
+
+namespace nbl::video
+{
+
+class CNullBufferView final : public IGPUBufferView
+{
+    public:
+        using IGPUBufferView::IGPUBufferView;
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+};
+
+class CNullSampler final : public IGPUSampler
+{
+    public:
+        CNullSampler(core::smart_refctd_ptr<const ILogicalDevice>&& dev, const SParams& params) : IGPUSampler(std::move(dev),params) {}
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+};
+
+}
+
+#endif
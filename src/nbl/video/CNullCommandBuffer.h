@@ -0,0 +1,307 @@
+#ifndef __NBL_C_NULL_COMMAND_BUFFER_H_INCLUDED__
+#define __NBL_C_NULL_COMMAND_BUFFER_H_INCLUDED__
+
+#include "nbl/video/IGPUCommandBuffer.h"
+#include "nbl/video/IGPUMeshBuffer.h"
+
+namespace nbl::video
+{
+
+//! Records nothing but does everything a real backend does on the CPU: validates the arguments and keeps the referenced resources alive until reset
+/**
+    Every successfully recorded command bumps a counter, so benchmarks and tests can check how much work a renderer would have sent to the GPU.
+*/
+class CNullCommandBuffer final : public IGPUCommandBuffer
+{
+    public:
+        CNullCommandBuffer(core::smart_refctd_ptr<const ILogicalDevice>&& dev, E_LEVEL level, core::smart_refctd_ptr<IGPUCommandPool>&& commandPool)
+            : IGPUCommandBuffer(std::move(dev),level,std::move(commandPool)) {}
+
+        bool begin(uint32_t recordingFlags, const SInheritanceInfo* inheritanceInfo=nullptr) override
+        {
+            if (inheritanceInfo)
+            {
+                if (!inheritanceInfo->renderpass || !inheritanceInfo->renderpass->isCompatibleDevicewise(this))
+                    return false;
+                if (inheritanceInfo->framebuffer && !inheritanceInfo->framebuffer->isCompatibleDevicewise(this))
+                    return false;
+            }
+            if (!IGPUCommandBuffer::begin(recordingFlags,inheritanceInfo))
+                return false;
+            releaseResources();
+            if (inheritanceInfo)
+            {
+                m_resources.emplace_back(inheritanceInfo->renderpass);
+                if (inheritanceInfo->framebuffer)
+                    m_resources.emplace_back(inheritanceInfo->framebuffer);
+            }
+            return true;
+        }
+
+        bool reset(uint32_t _flags) override
+        {
+            if (!IGPUCommandBuffer::reset(_flags))
+                return false;
+            releaseResources();
+            return true;
+        }
+
+        //! Amount of commands recorded since the last `begin` or `reset`
+        inline uint64_t getRecordedCommandCount() const {return m_commandCount;}
+        //! Amount of resource references the command buffer is holding on to
+        inline size_t getReferencedResourceCount() const {return m_resources.size();}
+
+        bool bindIndexBuffer(const buffer_t* buffer, size_t offset, asset::E_INDEX_TYPE indexType) override
+        {
+            // unbinding is allowed, just like in `drawMeshBuffer`
+            if (buffer && !reference(buffer))
+                return false;
+            return record();
+        }
+
+        bool draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override {return record();}
+        bool drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, int32_t vertexOffset, uint32_t firstInstance) override {return record();}
+
+        bool drawIndirect(const buffer_t* buffer, size_t offset, uint32_t drawCount, uint32_t stride) override
+        {
+            return reference(buffer) && record();
+        }
+        bool drawIndexedIndirect(const buffer_t* buffer, size_t offset, uint32_t drawCount, uint32_t stride) override
+        {
+            return reference(buffer) && record();
+        }
+        bool drawIndirectCount(const buffer_t* buffer, size_t offset, const buffer_t* countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride) override
+        {
+            return reference(buffer) && reference(countBuffer) && record();
+        }
+        bool drawIndexedIndirectCount(const buffer_t* buffer, size_t offset, const buffer_t* countBuffer, size_t countBufferOffset, uint32_t maxDrawCount, uint32_t stride) override
+        {
+            return reference(buffer) && reference(countBuffer) && record();
+        }
+
+        bool drawMeshBuffer(const IGPUMeshBuffer::base_t* meshBuffer) override
+        {
+            if (!meshBuffer || !meshBuffer->getInstanceCount())
+                return false;
+
+            auto vertexBufferBindings = meshBuffer->getVertexBufferBindings();
+            auto indexBufferBinding = meshBuffer->getIndexBufferBinding();
+            const auto indexType = meshBuffer->getIndexType();
+
+            const IGPUBuffer* gpuBufferBindings[asset::SVertexInputParams::MAX_ATTR_BUF_BINDING_COUNT];
+            size_t bufferBindingsOffsets[asset::SVertexInputParams::MAX_ATTR_BUF_BINDING_COUNT];
+            for (size_t i=0; i<asset::SVertexInputParams::MAX_ATTR_BUF_BINDING_COUNT; ++i)
+            {
+                gpuBufferBindings[i] = vertexBufferBindings[i].buffer.get();
+                bufferBindingsOffsets[i] = vertexBufferBindings[i].offset;
+            }
+
+            if (!bindVertexBuffers(0,asset::SVertexInputParams::MAX_ATTR_BUF_BINDING_COUNT,gpuBufferBindings,bufferBindingsOffsets))
+                return false;
+            if (!bindIndexBuffer(indexBufferBinding.buffer.get(),indexBufferBinding.offset,indexType))
+                return false;
+
+            const uint32_t instanceCount = meshBuffer->getInstanceCount();
+            const uint32_t firstInstance = meshBuffer->getBaseInstance();
+            const int32_t firstVertex = meshBuffer->getBaseVertex();
+            if (indexType!=asset::EIT_UNKNOWN)
+                return drawIndexed(meshBuffer->getIndexCount(),instanceCount,0u,firstVertex,firstInstance);
+            else
+                return draw(meshBuffer->getIndexCount(),instanceCount,firstVertex,firstInstance);
+        }
+
+        bool setViewport(uint32_t firstViewport, uint32_t viewportCount, const asset::SViewport* pViewports) override {return pViewports && record();}
+        bool setLineWidth(float lineWidth) override {return record();}
+        bool setDepthBias(float depthBiasConstantFactor, float depthBiasClamp, float depthBiasSlopeFactor) override {return record();}
+        bool setBlendConstants(const float blendConstants[4]) override {return record();}
+
+        bool copyBuffer(const buffer_t* srcBuffer, buffer_t* dstBuffer, uint32_t regionCount, const asset::SBufferCopy* pRegions) override
+        {
+            if (!pRegions || regionCount==0u)
+                return false;
+            return reference(srcBuffer) && reference(dstBuffer) && record();
+        }
+        bool copyImage(const image_t* srcImage, asset::E_IMAGE_LAYOUT srcImageLayout, image_t* dstImage, asset::E_IMAGE_LAYOUT dstImageLayout, uint32_t regionCount, const asset::IImage::SImageCopy* pRegions) override
+        {
+            if (!pRegions || regionCount==0u)
+                return false;
+            return reference(srcImage) && reference(dstImage) && record();
+        }
+        bool copyBufferToImage(const buffer_t* srcBuffer, image_t* dstImage, asset::E_IMAGE_LAYOUT dstImageLayout, uint32_t regionCount, const asset::IImage::SBufferCopy* pRegions) override
+        {
+            if (!pRegions || regionCount==0u)
+                return false;
+            return reference(srcBuffer) && reference(dstImage) && record();
+        }
+        bool copyImageToBuffer(const image_t* srcImage, asset::E_IMAGE_LAYOUT srcImageLayout, buffer_t* dstBuffer, uint32_t regionCount, const asset::IImage::SBufferCopy* pRegions) override
+        {
+            if (!pRegions || regionCount==0u)
+                return false;
+            return reference(srcImage) && reference(dstBuffer) && record();
+        }
+        bool blitImage(const image_t* srcImage, asset::E_IMAGE_LAYOUT srcImageLayout, image_t* dstImage, asset::E_IMAGE_LAYOUT dstImageLayout, uint32_t regionCount, const asset::SImageBlit* pRegions, asset::ISampler::E_TEXTURE_FILTER filter) override
+        {
+            if (!IGPUCommandBuffer::blitImage(srcImage,srcImageLayout,dstImage,dstImageLayout,regionCount,pRegions,filter))
+                return false;
+            return reference(srcImage) && reference(dstImage) && record();
+        }
+        bool resolveImage(const image_t* srcImage, asset::E_IMAGE_LAYOUT srcImageLayout, image_t* dstImage, asset::E_IMAGE_LAYOUT dstImageLayout, uint32_t regionCount, const asset::SImageResolve* pRegions) override
+        {
+            return reference(srcImage) && reference(dstImage) && record();
+        }
+
+        bool bindVertexBuffers(uint32_t firstBinding, uint32_t bindingCount, const buffer_t* const *const pBuffers, const size_t* pOffsets) override
+        {
+            for (uint32_t i=0u; i<bindingCount; ++i)
+            if (pBuffers[i] && !reference(pBuffers[i]))
+                return false;
+            return record();
+        }
+
+        bool setScissor(uint32_t firstScissor, uint32_t scissorCount, const VkRect2D* pScissors) override {return pScissors && record();}
+        bool setDepthBounds(float minDepthBounds, float maxDepthBounds) override {return record();}
+        bool setStencilCompareMask(asset::E_STENCIL_FACE_FLAGS faceMask, uint32_t compareMask) override {return record();}
+        bool setStencilWriteMask(asset::E_STENCIL_FACE_FLAGS faceMask, uint32_t writeMask) override {return record();}
+        bool setStencilReference(asset::E_STENCIL_FACE_FLAGS faceMask, uint32_t reference) override {return record();}
+
+        bool dispatch(uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override {return record();}
+        bool dispatchIndirect(const buffer_t* buffer, size_t offset) override
+        {
+            return reference(buffer) && record();
+        }
+        bool dispatchBase(uint32_t baseGroupX, uint32_t baseGroupY, uint32_t baseGroupZ, uint32_t groupCountX, uint32_t groupCountY, uint32_t groupCountZ) override {return record();}
+
+        bool setEvent(event_t* event, const SDependencyInfo& depInfo) override
+        {
+            return reference(event) && referenceBarriers(depInfo.bufBarrierCount,depInfo.bufBarriers,depInfo.imgBarrierCount,depInfo.imgBarriers) && record();
+        }
+        bool resetEvent(event_t* event, asset::E_PIPELINE_STAGE_FLAGS stageMask) override
+        {
+            return reference(event) && record();
+        }
+        bool waitEvents(uint32_t eventCount, event_t*const *const pEvents, const SDependencyInfo* depInfos) override
+        {
+            for (uint32_t i=0u; i<eventCount; ++i)
+            if (!reference(pEvents[i]) || !referenceBarriers(depInfos[i].bufBarrierCount,depInfos[i].bufBarriers,depInfos[i].imgBarrierCount,depInfos[i].imgBarriers))
+                return false;
+            return record();
+        }
+
+        bool pipelineBarrier(core::bitflag<asset::E_PIPELINE_STAGE_FLAGS> srcStageMask, core::bitflag<asset::E_PIPELINE_STAGE_FLAGS> dstStageMask,
+            core::bitflag<asset::E_DEPENDENCY_FLAGS> dependencyFlags,
+            uint32_t memoryBarrierCount, const asset::SMemoryBarrier* pMemoryBarriers,
+            uint32_t bufferMemoryBarrierCount, const SBufferMemoryBarrier* pBufferMemoryBarriers,
+            uint32_t imageMemoryBarrierCount, const SImageMemoryBarrier* pImageMemoryBarriers) override
+        {
+            return referenceBarriers(bufferMemoryBarrierCount,pBufferMemoryBarriers,imageMemoryBarrierCount,pImageMemoryBarriers) && record();
+        }
+
+        bool beginRenderPass(const SRenderpassBeginInfo* pRenderPassBegin, asset::E_SUBPASS_CONTENTS content) override
+        {
+            if (!pRenderPassBegin)
+                return false;
+            return reference(pRenderPassBegin->renderpass.get()) && reference(pRenderPassBegin->framebuffer.get()) && record();
+        }
+        bool nextSubpass(asset::E_SUBPASS_CONTENTS contents) override {return record();}
+        bool endRenderPass() override {return record();}
+
+        bool bindGraphicsPipeline(const graphics_pipeline_t* pipeline) override
+        {
+            return reference(pipeline) && record();
+        }
+        bool bindComputePipeline(const compute_pipeline_t* pipeline) override
+        {
+            return reference(pipeline) && record();
+        }
+
+        bool bindDescriptorSets(asset::E_PIPELINE_BIND_POINT pipelineBindPoint,
+            const pipeline_layout_t* layout, uint32_t firstSet, uint32_t descriptorSetCount,
+            const descriptor_set_t* const* const pDescriptorSets,
+            const uint32_t dynamicOffsetCount=0u, const uint32_t* dynamicOffsets=nullptr
+        ) override
+        {
+            if (firstSet+descriptorSetCount>IGPUPipelineLayout::DESCRIPTOR_SET_COUNT || !reference(layout))
+                return false;
+            for (uint32_t i=0u; i<descriptorSetCount; ++i)
+            if (pDescriptorSets[i] && !reference(pDescriptorSets[i]))
+                return false;
+            return record();
+        }
+        bool pushConstants(const pipeline_layout_t* layout, core::bitflag<asset::IShader::E_SHADER_STAGE> stageFlags, uint32_t offset, uint32_t size, const void* pValues) override
+        {
+            if ((offset&0x03u) || (size&0x03u) || !pValues)
+                return false;
+            return reference(layout) && record();
+        }
+
+        bool clearColorImage(image_t* image, asset::E_IMAGE_LAYOUT imageLayout, const asset::SClearColorValue* pColor, uint32_t rangeCount, const asset::IImage::SSubresourceRange* pRanges) override
+        {
+            return pColor && reference(image) && record();
+        }
+        bool clearDepthStencilImage(image_t* image, asset::E_IMAGE_LAYOUT imageLayout, const asset::SClearDepthStencilValue* pDepthStencil, uint32_t rangeCount, const asset::IImage::SSubresourceRange* pRanges) override
+        {
+            return pDepthStencil && reference(image) && record();
+        }
+        bool clearAttachments(uint32_t attachmentCount, const asset::SClearAttachment* pAttachments, uint32_t rectCount, const asset::SClearRect* pRects) override {return record();}
+
+        bool fillBuffer(buffer_t* dstBuffer, size_t dstOffset, size_t size, uint32_t data) override
+        {
+            return reference(dstBuffer) && record();
+        }
+        bool updateBuffer(buffer_t* dstBuffer, size_t dstOffset, size_t dataSize, const void* pData) override
+        {
+            if (!validate_updateBuffer(dstBuffer,dstOffset,dataSize,pData))
+                return false;
+            return reference(dstBuffer) && record();
+        }
+
+        bool executeCommands(uint32_t count, cmdbuf_t* const* const cmdbufs) override
+        {
+            if (!IGPUCommandBuffer::executeCommands(count,cmdbufs))
+                return false;
+            for (uint32_t i=0u; i<count; ++i)
+            if (!reference(cmdbufs[i]))
+                return false;
+            return record();
+        }
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+
+    private:
+        template<class T>
+        inline bool reference(const T* obj)
+        {
+            if (!obj || !obj->isCompatibleDevicewise(this))
+                return false;
+            m_resources.emplace_back(core::smart_refctd_ptr<const T>(obj));
+            return true;
+        }
+        inline bool referenceBarriers(uint32_t bufferBarrierCount, const SBufferMemoryBarrier* bufferBarriers, uint32_t imageBarrierCount, const SImageMemoryBarrier* imageBarriers)
+        {
+            for (uint32_t i=0u; i<bufferBarrierCount; ++i)
+            if (!reference(bufferBarriers[i].buffer.get()))
+                return false;
+            for (uint32_t i=0u; i<imageBarrierCount; ++i)
+            if (!reference(imageBarriers[i].image.get()))
+                return false;
+            return true;
+        }
+        inline bool record()
+        {
+            m_commandCount++;
+            return true;
+        }
+        inline void releaseResources()
+        {
+            m_resources.clear();
+            m_commandCount = 0ull;
+        }
+
+        core::vector<core::smart_refctd_ptr<const core::IReferenceCounted>> m_resources;
+        uint64_t m_commandCount = 0ull;
+};
+
+}
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef __NBL_C_NULL_COMMAND_POOL_H_INCLUDED__
+#define __NBL_C_NULL_COMMAND_POOL_H_INCLUDED__
+
+#include "nbl/video/IGPUCommandPool.h"
+
+namespace nbl::video
+{
+
+class CNullCommandPool final : public IGPUCommandPool
+{
+    public:
+        CNullCommandPool(core::smart_refctd_ptr<const ILogicalDevice>&& dev, core::bitflag<E_CREATE_FLAGS> _flags, uint32_t _familyIx)
+            : IGPUCommandPool(std::move(dev),_flags,_familyIx) {}
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+};
+
+}
+
+#endif
@@ -0,0 +1,33 @@
+#include "nbl/video/CNullConnection.h"
+
+#include "nbl/video/CNullPhysicalDevice.h"
+
+namespace nbl::video
+{
+
+core::smart_refctd_ptr<CNullConnection> CNullConnection::create(core::smart_refctd_ptr<system::ISystem>&& sys, uint32_t appVer, const char* appName, core::smart_refctd_ptr<system::ILogger>&& logger)
+{
+    if (!sys)
+        return nullptr;
+
+    auto* api = new CNullConnection(std::move(logger));
+    auto glslc = core::make_smart_refctd_ptr<asset::IGLSLCompiler>(sys.get());
+    api->m_physicalDevices.push_back(std::make_unique<CNullPhysicalDevice>(std::move(sys),std::move(glslc),api));
+    return core::smart_refctd_ptr<CNullConnection>(api,core::dont_grab);
+}
+
+CNullConnection::CNullConnection(core::smart_refctd_ptr<system::ILogger>&& logger)
+    : IAPIConnection(), m_debugCallback(std::make_unique<CDebugCallback>(std::move(logger)))
+{
+}
+
+CNullConnection::~CNullConnection()
+{
+}
+
+IDebugCallback* CNullConnection::getDebugCallback() const
+{
+    return m_debugCallback.get();
+}
+
+}
@@ -0,0 +1,64 @@
+#ifndef __NBL_C_NULL_DESCRIPTOR_SET_H_INCLUDED__
+#define __NBL_C_NULL_DESCRIPTOR_SET_H_INCLUDED__
+
+#include "nbl/video/IGPUDescriptorSet.h"
+
+namespace nbl::video
+{
+
+//! Stores the descriptors the same way the ICPU and OpenGL descriptor sets do, so writes and copies cost what they would on the CPU side of a real backend
+class CNullDescriptorSet final : public IGPUDescriptorSet, protected asset::impl::IEmulatedDescriptorSet<const IGPUDescriptorSetLayout>
+{
+	public:
+		CNullDescriptorSet(core::smart_refctd_ptr<const ILogicalDevice>&& dev, core::smart_refctd_ptr<const IGPUDescriptorSetLayout>&& _layout)
+			: IGPUDescriptorSet(std::move(dev),std::move(_layout)), asset::impl::IEmulatedDescriptorSet<const IGPUDescriptorSetLayout>(m_layout.get()) {}
+
+		inline void writeDescriptorSet(const SWriteDescriptorSet& _write)
+		{
+			assert(_write.dstSet==static_cast<decltype(_write.dstSet)>(this));
+			assert(_write.binding<m_bindingInfo->size());
+			assert(_write.descriptorType==m_bindingInfo->operator[](_write.binding).descriptorType);
+			assert(getDescriptors(_write.binding)+_write.arrayElement+_write.count<=m_descriptors->end());
+
+			auto* output = getDescriptors(_write.binding)+_write.arrayElement;
+			for (uint32_t i=0u; i<_write.count; i++)
+				output[i] = _write.info[i];
+		}
+		inline void copyDescriptorSet(const SCopyDescriptorSet& _copy)
+		{
+			assert(_copy.dstSet==static_cast<decltype(_copy.dstSet)>(this));
+			const auto* srcSet = static_cast<const CNullDescriptorSet*>(_copy.srcSet);
+			assert(_copy.srcBinding<srcSet->m_bindingInfo->size() && _copy.dstBinding<m_bindingInfo->size());
+			assert(srcSet->m_bindingInfo->operator[](_copy.srcBinding).descriptorType==m_bindingInfo->operator[](_copy.dstBinding).descriptorType);
+
+			const auto* input = srcSet->getDescriptors(_copy.srcBinding)+_copy.srcArrayElement;
+			auto* output = getDescriptors(_copy.dstBinding)+_copy.dstArrayElement;
+			// If srcSet is equal to dstSet, then the source and destination ranges of descriptors must not overlap
+			assert(this!=srcSet || input+_copy.count<=output || output+_copy.count<=input);
+			std::copy_n(input,_copy.count,output);
+		}
+
+		//! The descriptors of a binding, for tests which need to check what got written
+		inline core::SRange<const SDescriptorInfo> getDescriptorRange(uint32_t binding) const
+		{
+			if (binding>=m_bindingInfo->size())
+				return {nullptr,nullptr};
+			const auto* begin = getDescriptors(binding);
+			const auto* end = binding+1u!=m_bindingInfo->size() ? getDescriptors(binding+1u):m_descriptors->end();
+			return {begin,end};
+		}
+
+	protected:
+		inline SDescriptorInfo* getDescriptors(uint32_t index)
+		{
+			return m_descriptors->begin()+m_bindingInfo->operator[](index).offset;
+		}
+		inline const SDescriptorInfo* getDescriptors(uint32_t index) const
+		{
+			return m_descriptors->begin()+m_bindingInfo->operator[](index).offset;
+		}
+};
+
+}
+
+#endif
@@ -0,0 +1,42 @@
+#ifndef __NBL_C_NULL_FENCE_H_INCLUDED__
+#define __NBL_C_NULL_FENCE_H_INCLUDED__
+
+#include "nbl/video/IGPUFence.h"
+#include "nbl/video/IGPUSemaphore.h"
+
+#include <atomic>
+
+namespace nbl::video
+{
+
+//! Nothing ever runs asynchronously on the null device, so a fence is just a flag which `CNullQueue::submit` sets
+class CNullFence final : public IGPUFence
+{
+    public:
+        CNullFence(core::smart_refctd_ptr<const ILogicalDevice>&& dev, E_CREATE_FLAGS _flags)
+            : IGPUFence(std::move(dev),_flags), m_signalled((_flags&ECF_SIGNALED_BIT)!=0) {}
+
+        //! Null: nullptr, there is no API object
+        inline void* getNativeHandle() override {return nullptr;}
+
+        inline bool isSignalled() const {return m_signalled.load(std::memory_order_acquire);}
+        inline void signal() {m_signalled.store(true,std::memory_order_release);}
+        inline void reset() {m_signalled.store(false,std::memory_order_release);}
+
+    private:
+        std::atomic_bool m_signalled;
+};
+
+class CNullSemaphore final : public IGPUSemaphore
+{
+    public:
+        CNullSemaphore(core::smart_refctd_ptr<const ILogicalDevice>&& dev) : IGPUSemaphore(std::move(dev)) {}
+
+    protected:
+        //! Null: nullptr, there is no API object
+        inline void* getNativeHandle() override {return nullptr;}
+};
+
+}
+
+#endif
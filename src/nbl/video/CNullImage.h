@@ -0,0 +1,40 @@
+#ifndef __NBL_C_NULL_IMAGE_H_INCLUDED__
+#define __NBL_C_NULL_IMAGE_H_INCLUDED__
+
+#include "nbl/video/IGPUImage.h"
+#include "nbl/video/IGPUImageView.h"
+
+namespace nbl::video
+{
+
+//! Images can't be mapped, so unlike CNullBuffer there's no point in backing them with any memory
+class CNullImage final : public IGPUImage, public IDriverMemoryAllocation
+{
+	public:
+		CNullImage(core::smart_refctd_ptr<const ILogicalDevice>&& dev, IGPUImage::SCreationParams&& _params, const IDriverMemoryBacked::SDriverMemoryRequirements& reqs)
+			: IGPUImage(std::move(dev),std::move(_params),reqs), IDriverMemoryAllocation(getOriginDevice()) {}
+
+		//! Null: nullptr, there is no API object
+		inline const void* getNativeHandle() const override {return nullptr;}
+
+		inline size_t getAllocationSize() const override { return this->getImageDataSizeInBytes(); }
+		inline IDriverMemoryAllocation* getBoundMemory() override { return this; }
+		inline const IDriverMemoryAllocation* getBoundMemory() const override { return this; }
+		inline size_t getBoundMemoryOffset() const override { return 0ull; }
+
+		inline E_SOURCE_MEMORY_TYPE getType() const override { return ESMT_DEVICE_LOCAL; }
+		inline bool isDedicated() const override { return true; }
+};
+
+class CNullImageView final : public IGPUImageView
+{
+	public:
+		CNullImageView(core::smart_refctd_ptr<const ILogicalDevice>&& dev, SCreationParams&& _params) : IGPUImageView(std::move(dev),std::move(_params)) {}
+
+		//! Null: nullptr, there is no API object
+		inline const void* getNativeHandle() const override {return nullptr;}
+};
+
+}
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef __NBL_C_NULL_LOGICAL_DEVICE_H_INCLUDED__
+#define __NBL_C_NULL_LOGICAL_DEVICE_H_INCLUDED__
+
+#include "nbl/video/ILogicalDevice.h"
+#include "nbl/video/IPhysicalDevice.h"
+
+#include "nbl/video/CNullBuffer.h"
+#include "nbl/video/CNullBufferView.h"
+#include "nbl/video/CNullImage.h"
+#include "nbl/video/CNullShader.h"
+#include "nbl/video/CNullDescriptorSet.h"
+#include "nbl/video/CNullFence.h"
+#include "nbl/video/CNullQueue.h"
+#include "nbl/video/CNullCommandPool.h"
+#include "nbl/video/CNullCommandBuffer.h"
+
+namespace nbl::video
+{
+
+//! Logical device which creates real engine objects but never talks to a GPU
+/**
+    Buffers live in host memory and can be mapped, images and everything else only exist as their CPU-side bookkeeping,
+    submits validate and retire command buffers immediately and signal the fence on the spot.
+    This makes it possible to run and time the CPU-side of asset conversion, staging and command recording on machines without a GPU (CI, profilers, sanitizers).
+
+    GLSL is not compiled to SPIR-V when specializing shaders, so shader compilation cost is not part of any measurement made with this device.
+*/
+class CNullLogicalDevice final : public ILogicalDevice
+{
+    public:
+        CNullLogicalDevice(core::smart_refctd_ptr<IAPIConnection>&& api, IPhysicalDevice* physicalDevice, const SCreationParams& params)
+            : ILogicalDevice(std::move(api),physicalDevice,params)
+        {
+            for (uint32_t i=0u; i<params.queueParamsCount; ++i)
+            {
+                const auto& qci = params.queueParams[i];
+                const uint32_t offset = (*m_offsets)[qci.familyIndex];
+                for (uint32_t j=0u; j<qci.count; ++j)
+                    (*m_queues)[offset+j] = new CThreadSafeGPUQueueAdapter(this,new CNullQueue(this,qci.familyIndex,qci.flags,qci.priorities[j]));
+            }
+        }
+
+        core::smart_refctd_ptr<IGPUSemaphore> createSemaphore() override
+        {
+            return core::make_smart_refctd_ptr<CNullSemaphore>(core::smart_refctd_ptr<const ILogicalDevice>(this));
+        }
+
+        core::smart_refctd_ptr<IGPUEvent> createEvent(IGPUEvent::E_CREATE_FLAGS flags) override
+        {
+            return core::make_smart_refctd_ptr<IGPUEvent>(core::smart_refctd_ptr<const ILogicalDevice>(this),flags);
+        }
+        // only device-only events exist, the host can't touch them
+        IGPUEvent::E_STATUS getEventStatus(const IGPUEvent* _event) override {return IGPUEvent::ES_FAILURE;}
+        IGPUEvent::E_STATUS resetEvent(IGPUEvent* _event) override {return IGPUEvent::ES_FAILURE;}
+        IGPUEvent::E_STATUS setEvent(IGPUEvent* _event) override {return IGPUEvent::ES_FAILURE;}
+
+        core::smart_refctd_ptr<IGPUFence> createFence(IGPUFence::E_CREATE_FLAGS _flags) override
+        {
+            return core::make_smart_refctd_ptr<CNullFence>(core::smart_refctd_ptr<const ILogicalDevice>(this),_flags);
+        }
+        IGPUFence::E_STATUS getFenceStatus(IGPUFence* _fence) override
+        {
+            const auto* fence = IBackendObject::device_compatibility_cast<const CNullFence*>(_fence,this);
+            if (!fence)
+                return IGPUFence::ES_ERROR;
+            return fence->isSignalled() ? IGPUFence::ES_SUCCESS:IGPUFence::ES_NOT_READY;
+        }
+        bool resetFences(uint32_t _count, IGPUFence*const * _fences) override
+        {
+            for (uint32_t i=0u; i<_count; ++i)
+            {
+                auto* fence = IBackendObject::device_compatibility_cast<CNullFence*>(_fences[i],this);
+                if (!fence)
+                    return false;
+                fence->reset();
+            }
+            return true;
+        }
+        //! Work completes during `submit`, so a fence which is not signalled by now never will be and we report a timeout without waiting for it
+        IGPUFence::E_STATUS waitForFences(uint32_t _count, IGPUFence* const* _fences, bool _waitAll, uint64_t _timeout) override
+        {
+            bool anySignalled = false;
+            for (uint32_t i=0u; i<_count; ++i)
+            {
+                const auto* fence = IBackendObject::device_compatibility_cast<const CNullFence*>(_fences[i],this);
+                if (!fence)
+                    return IGPUFence::ES_ERROR;
+                if (fence->isSignalled())
+                    anySignalled = true;
+                else if (_waitAll)
+                    return IGPUFence::ES_TIMEOUT;
+            }
+            return anySignalled||_count==0u ? IGPUFence::ES_SUCCESS:IGPUFence::ES_TIMEOUT;
+        }
+
+        core::smart_refctd_ptr<IDeferredOperation> createDeferredOperation() override
+        {
+            return nullptr;
+        }
+
+        core::smart_refctd_ptr<IGPUCommandPool> createCommandPool(uint32_t _familyIx, core::bitflag<IGPUCommandPool::E_CREATE_FLAGS> flags) override
+        {
+            return core::make_smart_refctd_ptr<CNullCommandPool>(core::smart_refctd_ptr<const ILogicalDevice>(this),flags,_familyIx);
+        }
+        core::smart_refctd_ptr<IDescriptorPool> createDescriptorPool(IDescriptorPool::E_CREATE_FLAGS flags, uint32_t maxSets, uint32_t poolSizeCount, const IDescriptorPool::SDescriptorPoolSize* poolSizes) override
+        {
+            return core::make_smart_refctd_ptr<IDescriptorPool>(core::smart_refctd_ptr<const ILogicalDevice>(this),maxSets);
+        }
+
+        core::smart_refctd_ptr<IGPURenderpass> createGPURenderpass(const IGPURenderpass::SCreationParams& params) override
+        {
+            return core::make_smart_refctd_ptr<IGPURenderpass>(core::smart_refctd_ptr<const ILogicalDevice>(this),params);
+        }
+
+        //! All memory is host memory, flushes and invalidates have nothing to do
+        void flushMappedMemoryRanges(core::SRange<const video::IDriverMemoryAllocation::MappedMemoryRange> ranges) override {}
+        void invalidateMappedMemoryRanges(core::SRange<const video::IDriverMemoryAllocation::MappedMemoryRange> ranges) override {}
+
+        core::smart_refctd_ptr<IGPUBuffer> createGPUBufferOnDedMem(const IGPUBuffer::SCreationParams& creationParams, const IDriverMemoryBacked::SDriverMemoryRequirements& initialMreqs) override
+        {
+            IGPUBuffer::SCachedCreationParams cachedCreationParams = creationParams;
+            cachedCreationParams.declaredSize = initialMreqs.vulkanReqs.size;
+            return core::make_smart_refctd_ptr<CNullBuffer>(core::smart_refctd_ptr<const ILogicalDevice>(this),initialMreqs,cachedCreationParams);
+        }
+
+        core::smart_refctd_ptr<IGPUShader> createGPUShader(core::smart_refctd_ptr<asset::ICPUShader>&& cpushader) override
+        {
+            auto source = cpushader->getSPVorGLSL();
+            auto clone = core::smart_refctd_ptr_static_cast<asset::ICPUBuffer>(source->clone(1u));
+            return core::make_smart_refctd_ptr<CNullShader>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(clone),cpushader->containsGLSL(),cpushader->getStage(),std::string(cpushader->getFilepathHint()));
+        }
+
+        core::smart_refctd_ptr<IGPUImage> createGPUImageOnDedMem(IGPUImage::SCreationParams&& params, const IDriverMemoryBacked::SDriverMemoryRequirements& initialMreqs) override
+        {
+            if (!asset::IImage::validateCreationParameters(params))
+                return nullptr;
+            return core::make_smart_refctd_ptr<CNullImage>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(params),initialMreqs);
+        }
+
+        void updateDescriptorSets(uint32_t descriptorWriteCount, const IGPUDescriptorSet::SWriteDescriptorSet* pDescriptorWrites, uint32_t descriptorCopyCount, const IGPUDescriptorSet::SCopyDescriptorSet* pDescriptorCopies) override
+        {
+            for (uint32_t i=0u; i<descriptorWriteCount; i++)
+                static_cast<CNullDescriptorSet*>(pDescriptorWrites[i].dstSet)->writeDescriptorSet(pDescriptorWrites[i]);
+            for (uint32_t i=0u; i<descriptorCopyCount; i++)
+                static_cast<CNullDescriptorSet*>(pDescriptorCopies[i].dstSet)->copyDescriptorSet(pDescriptorCopies[i]);
+        }
+
+        core::smart_refctd_ptr<IGPUSampler> createGPUSampler(const IGPUSampler::SParams& _params) override
+        {
+            return core::make_smart_refctd_ptr<CNullSampler>(core::smart_refctd_ptr<const ILogicalDevice>(this),_params);
+        }
+
+        core::smart_refctd_ptr<ISwapchain> createSwapchain(ISwapchain::SCreationParams&& params) override
+        {
+            return nullptr;
+        }
+
+        void waitIdle() override {}
+
+        void* mapMemory(const IDriverMemoryAllocation::MappedMemoryRange& memory, IDriverMemoryAllocation::E_MAPPING_CPU_ACCESS_FLAG accessHint = IDriverMemoryAllocation::EMCAF_READ_AND_WRITE) override
+        {
+            assert(accessHint!=IDriverMemoryAllocation::EMCAF_NO_MAPPING_ACCESS);
+            assert(!memory.memory->isCurrentlyMapped());
+            // images are the only other allocations and they can't be mapped
+            if (!memory.memory->isMappable() || memory.offset+memory.length>memory.memory->getAllocationSize())
+                return nullptr;
+
+            const auto access = static_cast<IDriverMemoryAllocation::E_MAPPING_CPU_ACCESS_FLAG>(accessHint&memory.memory->getMappingCaps());
+            void* retval = static_cast<CNullBuffer*>(memory.memory)->getStorage()+memory.offset;
+            post_mapMemory(memory.memory,retval,memory.range,access);
+            return retval;
+        }
+
+        void unmapMemory(IDriverMemoryAllocation* memory) override
+        {
+            assert(memory->isCurrentlyMapped());
+            post_unmapMemory(memory);
+        }
+
+        //! Null: nullptr, there is no API object
+        const void* getNativeHandle() const override {return nullptr;}
+
+    protected:
+        bool createCommandBuffers_impl(IGPUCommandPool* _cmdPool, IGPUCommandBuffer::E_LEVEL _level, uint32_t _count, core::smart_refctd_ptr<IGPUCommandBuffer>* _output) override
+        {
+            for (uint32_t i=0u; i<_count; ++i)
+                _output[i] = core::make_smart_refctd_ptr<CNullCommandBuffer>(core::smart_refctd_ptr<const ILogicalDevice>(this),_level,core::smart_refctd_ptr<IGPUCommandPool>(_cmdPool));
+            return true;
+        }
+        bool freeCommandBuffers_impl(IGPUCommandBuffer** _cmdbufs, uint32_t _count) override
+        {
+            return false; // same as OpenGL, command buffers free themselves when dropped
+        }
+        core::smart_refctd_ptr<IGPUFramebuffer> createGPUFramebuffer_impl(IGPUFramebuffer::SCreationParams&& params) override
+        {
+            return core::make_smart_refctd_ptr<IGPUFramebuffer>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(params));
+        }
+        core::smart_refctd_ptr<IGPUSpecializedShader> createGPUSpecializedShader_impl(const IGPUShader* _unspecialized, const asset::ISpecializedShader::SInfo& _specInfo, const asset::ISPIRVOptimizer* _spvopt) override
+        {
+            const auto* unspecialized = IBackendObject::device_compatibility_cast<const CNullShader*>(_unspecialized,this);
+            if (!unspecialized)
+                return nullptr;
+            return core::make_smart_refctd_ptr<CNullSpecializedShader>(core::smart_refctd_ptr<const ILogicalDevice>(this),core::smart_refctd_ptr<const CNullShader>(unspecialized),_specInfo);
+        }
+        core::smart_refctd_ptr<IGPUBufferView> createGPUBufferView_impl(IGPUBuffer* _underlying, asset::E_FORMAT _fmt, size_t _offset = 0ull, size_t _size = IGPUBufferView::whole_buffer) override
+        {
+            return core::make_smart_refctd_ptr<CNullBufferView>(core::smart_refctd_ptr<const ILogicalDevice>(this),core::smart_refctd_ptr<IGPUBuffer>(_underlying),_fmt,_offset,_size);
+        }
+        core::smart_refctd_ptr<IGPUImageView> createGPUImageView_impl(IGPUImageView::SCreationParams&& params) override
+        {
+            if (!IGPUImageView::validateCreationParameters(params))
+                return nullptr;
+            return core::make_smart_refctd_ptr<CNullImageView>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(params));
+        }
+        core::smart_refctd_ptr<IGPUDescriptorSet> createGPUDescriptorSet_impl(IDescriptorPool* pool, core::smart_refctd_ptr<const IGPUDescriptorSetLayout>&& layout) override
+        {
+            return core::make_smart_refctd_ptr<CNullDescriptorSet>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(layout));
+        }
+        core::smart_refctd_ptr<IGPUDescriptorSetLayout> createGPUDescriptorSetLayout_impl(const IGPUDescriptorSetLayout::SBinding* _begin, const IGPUDescriptorSetLayout::SBinding* _end) override
+        {
+            return core::make_smart_refctd_ptr<IGPUDescriptorSetLayout>(core::smart_refctd_ptr<const ILogicalDevice>(this),_begin,_end);
+        }
+        core::smart_refctd_ptr<IGPUAccelerationStructure> createGPUAccelerationStructure_impl(IGPUAccelerationStructure::SCreationParams&& params) override
+        {
+            return nullptr;
+        }
+        core::smart_refctd_ptr<IGPUPipelineLayout> createGPUPipelineLayout_impl(
+            const asset::SPushConstantRange* const _pcRangesBegin, const asset::SPushConstantRange* const _pcRangesEnd,
+            core::smart_refctd_ptr<IGPUDescriptorSetLayout>&& _layout0, core::smart_refctd_ptr<IGPUDescriptorSetLayout>&& _layout1,
+            core::smart_refctd_ptr<IGPUDescriptorSetLayout>&& _layout2, core::smart_refctd_ptr<IGPUDescriptorSetLayout>&& _layout3
+        ) override
+        {
+            return core::make_smart_refctd_ptr<IGPUPipelineLayout>(
+                core::smart_refctd_ptr<const ILogicalDevice>(this),
+                _pcRangesBegin,_pcRangesEnd,
+                std::move(_layout0),std::move(_layout1),
+                std::move(_layout2),std::move(_layout3)
+            );
+        }
+        core::smart_refctd_ptr<IGPUComputePipeline> createGPUComputePipeline_impl(
+            IGPUPipelineCache* _pipelineCache,
+            core::smart_refctd_ptr<IGPUPipelineLayout>&& _layout,
+            core::smart_refctd_ptr<IGPUSpecializedShader>&& _shader
+        ) override
+        {
+            return core::make_smart_refctd_ptr<IGPUComputePipeline>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(_layout),std::move(_shader));
+        }
+        bool createGPUComputePipelines_impl(
+            IGPUPipelineCache* pipelineCache,
+            core::SRange<const IGPUComputePipeline::SCreationParams> createInfos,
+            core::smart_refctd_ptr<IGPUComputePipeline>* output
+        ) override
+        {
+            for (const auto& ci : createInfos)
+            {
+                auto layout = ci.layout;
+                auto shader = ci.shader;
+                if (!(*(output++) = createGPUComputePipeline_impl(pipelineCache,std::move(layout),std::move(shader))))
+                    return false;
+            }
+            return true;
+        }
+        core::smart_refctd_ptr<IGPURenderpassIndependentPipeline> createGPURenderpassIndependentPipeline_impl(
+            IGPUPipelineCache* _pipelineCache,
+            core::smart_refctd_ptr<IGPUPipelineLayout>&& _layout,
+            IGPUSpecializedShader* const* _shaders, IGPUSpecializedShader* const* _shadersEnd,
+            const asset::SVertexInputParams& _vertexInputParams,
+            const asset::SBlendParams& _blendParams,
+            const asset::SPrimitiveAssemblyParams& _primAsmParams,
+            const asset::SRasterizationParams& _rasterParams
+        ) override
+        {
+            return core::make_smart_refctd_ptr<IGPURenderpassIndependentPipeline>(
+                core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(_layout),
+                _shaders,_shadersEnd,_vertexInputParams,_blendParams,_primAsmParams,_rasterParams
+            );
+        }
+        bool createGPURenderpassIndependentPipelines_impl(
+            IGPUPipelineCache* pipelineCache,
+            core::SRange<const IGPURenderpassIndependentPipeline::SCreationParams> createInfos,
+            core::smart_refctd_ptr<IGPURenderpassIndependentPipeline>* output
+        ) override
+        {
+            for (const auto& ci : createInfos)
+            {
+                IGPUSpecializedShader* shaders[IGPURenderpassIndependentPipeline::SHADER_STAGE_COUNT];
+                uint32_t shaderCount = 0u;
+                for (const auto& shader : ci.shaders)
+                if (shader)
+                    shaders[shaderCount++] = const_cast<IGPUSpecializedShader*>(shader.get());
+
+                auto layout = ci.layout;
+                if (!(*(output++) = createGPURenderpassIndependentPipeline_impl(pipelineCache,std::move(layout),shaders,shaders+shaderCount,ci.vertexInput,ci.blend,ci.primitiveAssembly,ci.rasterization)))
+                    return false;
+            }
+            return true;
+        }
+        core::smart_refctd_ptr<IGPUGraphicsPipeline> createGPUGraphicsPipeline_impl(IGPUPipelineCache* pipelineCache, IGPUGraphicsPipeline::SCreationParams&& params) override
+        {
+            return core::make_smart_refctd_ptr<IGPUGraphicsPipeline>(core::smart_refctd_ptr<const ILogicalDevice>(this),std::move(params));
+        }
+        bool createGPUGraphicsPipelines_impl(IGPUPipelineCache* pipelineCache, core::SRange<const IGPUGraphicsPipeline::SCreationParams> params, core::smart_refctd_ptr<IGPUGraphicsPipeline>* output) override
+        {
+            uint32_t i = 0u;
+            for (const auto& ci : params)
+            {
+                if (!(output[i++] = createGPUGraphicsPipeline(pipelineCache,IGPUGraphicsPipeline::SCreationParams(ci))))
+                    return false;
+            }
+            return true;
+        }
+};
+
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef __NBL_C_NULL_PHYSICAL_DEVICE_H_INCLUDED__
+#define __NBL_C_NULL_PHYSICAL_DEVICE_H_INCLUDED__
+
+#include "nbl/video/IPhysicalDevice.h"
+#include "nbl/video/CNullLogicalDevice.h"
+
+namespace nbl::video
+{
+
+//! A device with generous limits, every format usage and one queue family which can do everything
+/**
+    Features which would need hardware or a driver to emulate (ray tracing, acceleration structures, queries, swapchains) are reported as unsupported.
+*/
+class CNullPhysicalDevice final : public IPhysicalDevice
+{
+    public:
+        CNullPhysicalDevice(core::smart_refctd_ptr<system::ISystem>&& sys, core::smart_refctd_ptr<asset::IGLSLCompiler>&& glslc, IAPIConnection* api)
+            : IPhysicalDevice(std::move(sys),std::move(glslc)), m_api(api)
+        {
+            m_apiVersion.major = 1u;
+            m_apiVersion.minor = 2u;
+            m_apiVersion.patch = 0u;
+
+            // Limits
+            {
+                m_limits.UBOAlignment = 256u;
+                m_limits.SSBOAlignment = 64u;
+                m_limits.bufferViewAlignment = 64u;
+                m_limits.maxSamplerAnisotropyLog2 = 4.f;
+                m_limits.timestampPeriodInNanoSeconds = 1.f;
+
+                m_limits.maxUBOSize = 64u*1024u;
+                m_limits.maxSSBOSize = ~0u;
+                m_limits.maxBufferViewSizeTexels = 128u*1024u*1024u;
+                m_limits.maxBufferSize = ~0u;
+
+                m_limits.maxImageArrayLayers = 2048u;
+
+                m_limits.maxPerStageSSBOs = 1024u;
+                m_limits.maxSSBOs = 1024u;
+                m_limits.maxUBOs = 1024u;
+                m_limits.maxDynamicOffsetSSBOs = 16u;
+                m_limits.maxDynamicOffsetUBOs = 16u;
+                m_limits.maxTextures = 1024u*1024u;
+                m_limits.maxStorageImages = 1024u*1024u;
+
+                m_limits.maxTextureSize = 16384u;
+
+                m_limits.maxDrawIndirectCount = ~0u;
+
+                m_limits.pointSizeRange[0] = 1.f;
+                m_limits.pointSizeRange[1] = 64.f;
+                m_limits.lineWidthRange[0] = 1.f;
+                m_limits.lineWidthRange[1] = 64.f;
+
+                m_limits.maxViewports = 16u;
+                m_limits.maxViewportDims[0] = 16384u;
+                m_limits.maxViewportDims[1] = 16384u;
+
+                m_limits.maxWorkgroupSize[0] = 1024u;
+                m_limits.maxWorkgroupSize[1] = 1024u;
+                m_limits.maxWorkgroupSize[2] = 64u;
+                m_limits.subgroupSize = 32u;
+                m_limits.maxOptimallyResidentWorkgroupInvocations = 512u;
+                m_limits.maxResidentInvocations = 64u*1024u;
+                m_limits.subgroupOpsShaderStages = asset::IShader::ESS_ALL;
+
+                m_limits.nonCoherentAtomSize = 64ull;
+
+                m_limits.spirvVersion = asset::IGLSLCompiler::ESV_1_5;
+
+                m_limits.maxGeometryCount = 0ull;
+                m_limits.maxInstanceCount = 0ull;
+                m_limits.maxPrimitiveCount = 0ull;
+                m_limits.maxPerStageDescriptorAccelerationStructures = 0u;
+                m_limits.maxPerStageDescriptorUpdateAfterBindAccelerationStructures = 0u;
+                m_limits.maxDescriptorSetAccelerationStructures = 0u;
+                m_limits.maxDescriptorSetUpdateAfterBindAccelerationStructures = 0u;
+                m_limits.minAccelerationStructureScratchOffsetAlignment = 0u;
+
+                m_limits.shaderGroupHandleSize = 0u;
+                m_limits.maxRayRecursionDepth = 0u;
+                m_limits.maxShaderGroupStride = 0u;
+                m_limits.shaderGroupBaseAlignment = 0u;
+                m_limits.shaderGroupHandleCaptureReplaySize = 0u;
+                m_limits.maxRayDispatchInvocationCount = 0u;
+                m_limits.shaderGroupHandleAlignment = 0u;
+                m_limits.maxRayHitAttributeSize = 0u;
+            }
+
+            // Features
+            {
+                m_features.robustBufferAccess = true;
+                m_features.imageCubeArray = true;
+                m_features.logicOp = true;
+                m_features.multiViewport = true;
+                m_features.vertexAttributeDouble = true;
+                m_features.dispatchBase = true;
+                m_features.shaderSubgroupBasic = true;
+                m_features.shaderSubgroupVote = true;
+                m_features.shaderSubgroupArithmetic = true;
+                m_features.shaderSubgroupBallot = true;
+                m_features.shaderSubgroupShuffle = true;
+                m_features.shaderSubgroupShuffleRelative = true;
+                m_features.shaderSubgroupClustered = true;
+                m_features.shaderSubgroupQuad = true;
+                m_features.shaderSubgroupQuadAllStages = true;
+                m_features.drawIndirectCount = true;
+                m_features.multiDrawIndirect = true;
+                m_features.samplerAnisotropy = true;
+                m_features.geometryShader = true;
+            }
+
+            // Memory, a single heap which is both device local and host visible
+            {
+                m_memoryProperties.memoryHeapCount = 1u;
+                m_memoryProperties.memoryHeaps[0].size = 0x1ull<<34ull;
+                m_memoryProperties.memoryHeaps[0].flags = VK_MEMORY_HEAP_DEVICE_LOCAL_BIT;
+                m_memoryProperties.memoryTypeCount = 1u;
+                m_memoryProperties.memoryTypes[0].propertyFlags = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT|VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT|VK_MEMORY_PROPERTY_HOST_COHERENT_BIT|VK_MEMORY_PROPERTY_HOST_CACHED_BIT;
+                m_memoryProperties.memoryTypes[0].heapIndex = 0u;
+            }
+
+            // Queue Families
+            {
+                m_qfamProperties = core::make_refctd_dynamic_array<qfam_props_array_t>(1u);
+                auto& qfam = (*m_qfamProperties)[0];
+                qfam.queueFlags = core::bitflag<E_QUEUE_FLAGS>(EQF_GRAPHICS_BIT)|EQF_COMPUTE_BIT|EQF_TRANSFER_BIT;
+                qfam.queueCount = MaxQueues;
+                qfam.timestampValidBits = 64u;
+                qfam.minImageTransferGranularity = {1u,1u,1u};
+            }
+
+            // Formats, everything goes
+            for (uint32_t i=0u; i<asset::EF_UNKNOWN; ++i)
+            {
+                auto& bufferUsage = m_bufferUsages[i];
+                bufferUsage.isInitialized = 1u;
+                bufferUsage.vertexAttribute = 1u;
+                bufferUsage.bufferView = 1u;
+                bufferUsage.storageBufferView = 1u;
+                bufferUsage.storageBufferViewAtomic = 1u;
+                bufferUsage.accelerationStructureVertex = 0u;
+
+                SFormatImageUsage imageUsage = {};
+                imageUsage.isInitialized = 1u;
+                imageUsage.sampledImage = 1u;
+                imageUsage.storageImage = 1u;
+                imageUsage.storageImageAtomic = 1u;
+                imageUsage.attachment = 1u;
+                imageUsage.attachmentBlend = 1u;
+                imageUsage.blitSrc = 1u;
+                imageUsage.blitDst = 1u;
+                imageUsage.transferSrc = 1u;
+                imageUsage.transferDst = 1u;
+                imageUsage.log2MaxSamples = 6u;
+                m_linearTilingUsages[i] = imageUsage;
+                m_optimalTilingUsages[i] = imageUsage;
+            }
+
+            std::ostringstream pool;
+            addCommonGLSLDefines(pool,false);
+            finalizeGLSLDefinePool(std::move(pool));
+        }
+
+        inline E_API_TYPE getAPIType() const override { return EAT_NULL; }
+
+        inline const SFormatBufferUsage& getBufferFormatUsages(const asset::E_FORMAT format) override { return m_bufferUsages[format]; }
+        inline const SFormatImageUsage& getImageFormatUsagesLinear(const asset::E_FORMAT format) override { return m_linearTilingUsages[format]; }
+        inline const SFormatImageUsage& getImageFormatUsagesOptimal(const asset::E_FORMAT format) override { return m_optimalTilingUsages[format]; }
+
+        inline IDebugCallback* getDebugCallback() override { return m_api->getDebugCallback(); }
+
+        inline bool isSwapchainSupported() const override { return false; }
+
+        //! enough for one per thread in any benchmark we care about
+        static inline constexpr uint32_t MaxQueues = 16u;
+
+    protected:
+        core::smart_refctd_ptr<ILogicalDevice> createLogicalDevice_impl(const ILogicalDevice::SCreationParams& params) override
+        {
+            // none of the optional device features exist on the null device
+            if (params.requiredFeatureCount)
+                return nullptr;
+            return core::make_smart_refctd_ptr<CNullLogicalDevice>(core::smart_refctd_ptr<IAPIConnection>(m_api),this,params);
+        }
+
+    private:
+        IAPIConnection* m_api; // purposefully not refcounted to avoid circular ref
+};
+
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef __NBL_C_NULL_QUEUE_H_INCLUDED__
+#define __NBL_C_NULL_QUEUE_H_INCLUDED__
+
+#include "nbl/video/IGPUQueue.h"
+#include "nbl/video/CNullFence.h"
+
+namespace nbl::video
+{
+
+//! Validates submissions and retires them on the spot, command buffers go through the same state changes as they would on a real queue
+class CNullQueue final : public IGPUQueue
+{
+    public:
+        CNullQueue(ILogicalDevice* dev, uint32_t _famIx, E_CREATE_FLAGS _flags, float _priority)
+            : IGPUQueue(dev,_famIx,_flags,_priority) {}
+
+        inline bool submit(uint32_t _count, const SSubmitInfo* _submits, IGPUFence* _fence) override
+        {
+            if (!IGPUQueue::submit(_count,_submits,_fence))
+                return false;
+            if (_fence && _fence->getAPIType()!=EAT_NULL)
+                return false;
+
+            if (!markCommandBuffersAsPending(_count,_submits))
+                return false;
+            // this is where the work would get executed
+            if (!markCommandBuffersAsDone(_count,_submits))
+                return false;
+
+            if (_fence)
+                static_cast<CNullFence*>(_fence)->signal();
+            return true;
+        }
+
+        //! there are no swapchains on a headless device
+        inline ISwapchain::E_PRESENT_RESULT present(const SPresentInfo& info) override {return ISwapchain::EPR_ERROR;}
+
+        inline bool startCapture() override {return false;}
+        inline bool endCapture() override {return false;}
+
+        //! Null: nullptr, there is no API object
+        inline const void* getNativeHandle() const override {return nullptr;}
+};
+
+}
+
+#endif
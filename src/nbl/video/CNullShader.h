@@ -0,0 +1,44 @@
+#ifndef __NBL_C_NULL_SHADER_H_INCLUDED__
+#define __NBL_C_NULL_SHADER_H_INCLUDED__
+
+#include "nbl/video/IGPUShader.h"
+#include "nbl/video/IGPUSpecializedShader.h"
+
+namespace nbl::video
+{
+
+//! Holds on to a copy of the source just like the OpenGL shader does, so creation costs the same
+class CNullShader final : public IGPUShader
+{
+	public:
+		CNullShader(core::smart_refctd_ptr<const ILogicalDevice>&& dev, core::smart_refctd_ptr<asset::ICPUBuffer>&& _code, const bool _containsGLSL, const IShader::E_SHADER_STAGE _stage, std::string&& _filepathHint)
+			: IGPUShader(std::move(dev),_stage,std::move(_filepathHint)), m_code(std::move(_code)), m_containsGLSL(_containsGLSL) {}
+
+		inline const asset::ICPUBuffer* getSPVorGLSL() const { return m_code.get(); }
+		inline bool containsGLSL() const { return m_containsGLSL; }
+
+	private:
+		core::smart_refctd_ptr<asset::ICPUBuffer> m_code;
+		const bool m_containsGLSL;
+};
+
+//! Never compiles anything, only remembers what it was specialized from
+class CNullSpecializedShader final : public IGPUSpecializedShader
+{
+	public:
+		CNullSpecializedShader(core::smart_refctd_ptr<const ILogicalDevice>&& dev, core::smart_refctd_ptr<const CNullShader>&& _unspecialized, const asset::ISpecializedShader::SInfo& _specInfo)
+			: IGPUSpecializedShader(std::move(dev)), m_unspecialized(std::move(_unspecialized)), m_specInfo(_specInfo) {}
+
+		inline asset::IShader::E_SHADER_STAGE getStage() const override { return m_unspecialized->getStage(); }
+
+		inline const CNullShader* getUnspecialized() const { return m_unspecialized.get(); }
+		inline const asset::ISpecializedShader::SInfo& getSpecializationInfo() const { return m_specInfo; }
+
+	private:
+		core::smart_refctd_ptr<const CNullShader> m_unspecialized;
+		asset::ISpecializedShader::SInfo m_specInfo;
+};
+
+}
+
+#endif